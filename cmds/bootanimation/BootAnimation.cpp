@@ -34,6 +34,7 @@
 #include <cutils/atomic.h>
 #include <cutils/properties.h>
 
+#include <ETC1/etc1.h>
 #include <android/imagedecoder.h>
 #include <androidfw/AssetManager.h>
 #include <binder/IPCThreadState.h>
@@ -339,25 +340,131 @@ status_t BootAnimation::initTexture(Texture* texture, AssetManager& assets,
     return NO_ERROR;
 }
 
-status_t BootAnimation::initTexture(FileMap* map, int* width, int* height,
-    bool premultiplyAlpha) {
-    AndroidBitmapInfo bitmapInfo;
-    void* pixels = decodeImage(map->getDataPtr(), map->getDataLength(), &bitmapInfo,
-        premultiplyAlpha);
-    auto pixelDeleter = std::unique_ptr<void, decltype(free)*>{ pixels, free };
+struct BootAnimation::DecodedFrame {
+    AndroidBitmapInfo info;
+    std::unique_ptr<void, decltype(free)*> pixels{nullptr, free};
+    // Set instead of the pixels for ETC1 frames, which are uploaded as they are stored.
+    std::unique_ptr<FileMap> etc1Map;
+};
+
+class BootAnimation::FrameDecodeThread : public Thread {
+public:
+    explicit FrameDecodeThread(const Animation::Part& part) : Thread(false), mPart(part) {}
+
+    // Returns the next frame of the part, waiting for it to be decoded. Its pixels are null if
+    // it failed to decode.
+    DecodedFrame takeFrame() {
+        Mutex::Autolock _l(mLock);
+        while (mFrames.empty()) {
+            mCondition.wait(mLock);
+        }
+        DecodedFrame frame = std::move(mFrames.front());
+        mFrames.pop();
+        mCondition.broadcast();
+        return frame;
+    }
+
+    // Stops decoding and waits for the thread to exit.
+    void stop() {
+        requestExit();
+        {
+            Mutex::Autolock _l(mLock);
+            mCondition.broadcast();
+        }
+        join();
+    }
+
+private:
+    // Enough to ride out a frame that is slower to decode than the frame rate allows, without
+    // holding the pixels of much of the part.
+    static constexpr size_t kFramesAhead = 3;
+
+    virtual bool threadLoop() {
+        DecodedFrame frame;
+        // Set decoding option to alpha unpremultiplied so that the R, G, B channels
+        // of transparent pixels are preserved.
+        decodeFrame(mPart.frames[mNextFrame].map, false /* don't premultiply alpha */, &frame);
+
+        Mutex::Autolock _l(mLock);
+        mFrames.push(std::move(frame));
+        mCondition.broadcast();
+        while (mFrames.size() >= kFramesAhead && !exitPending()) {
+            mCondition.wait(mLock);
+        }
+        return ++mNextFrame < mPart.frames.size();
+    }
+
+    const Animation::Part& mPart;
+    size_t mNextFrame = 0;
+    Mutex mLock;
+    Condition mCondition;
+    std::queue<DecodedFrame> mFrames;
+};
+
+bool BootAnimation::decodeFrame(FileMap* map, bool premultiplyAlpha, DecodedFrame* outFrame) {
+    const etc1_byte* data = static_cast<const etc1_byte*>(map->getDataPtr());
+    if (map->getDataLength() >= ETC_PKM_HEADER_SIZE && etc1_pkm_is_valid(data)) {
+        const etc1_uint32 w = etc1_pkm_get_width(data);
+        const etc1_uint32 h = etc1_pkm_get_height(data);
+        if (map->getDataLength() < ETC_PKM_HEADER_SIZE + etc1_get_encoded_data_size(w, h)) {
+            SLOGE("ETC1 frame is truncated");
+            delete map;
+            return false;
+        }
+        outFrame->info = AndroidBitmapInfo{};
+        outFrame->info.width = w;
+        outFrame->info.height = h;
+        // The texture is uploaded from the packed resource, so it is kept until then.
+        outFrame->etc1Map.reset(map);
+        return true;
+    }
+
+    outFrame->pixels.reset(decodeImage(map->getDataPtr(), map->getDataLength(), &outFrame->info,
+        premultiplyAlpha));
 
     // FileMap memory is never released until application exit.
-    // Release it now as the texture is already loaded and the memory used for
+    // Release it now as the frame is decoded and the memory used for
     // the packed resource can be released.
     delete map;
 
-    if (!pixels) {
+    return outFrame->pixels != nullptr;
+}
+
+status_t BootAnimation::initTexture(FileMap* map, int* width, int* height,
+    bool premultiplyAlpha) {
+    DecodedFrame frame;
+    decodeFrame(map, premultiplyAlpha, &frame);
+    return initTexture(frame, width, height);
+}
+
+status_t BootAnimation::initTexture(const DecodedFrame& frame, int* width, int* height) {
+    const AndroidBitmapInfo& bitmapInfo = frame.info;
+    const void* pixels = frame.pixels.get();
+    if (!pixels && frame.etc1Map == nullptr) {
         return NO_INIT;
     }
 
     const int w = bitmapInfo.width;
     const int h = bitmapInfo.height;
 
+    if (frame.etc1Map != nullptr) {
+        if (!mUseEtc1Textures) {
+            SLOGE("ETC1 frames are not supported by this GPU");
+            return NO_INIT;
+        }
+        const etc1_byte* data = static_cast<const etc1_byte*>(frame.etc1Map->getDataPtr());
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_ETC1_RGB8_OES, w, h, 0,
+                etc1_get_encoded_data_size(w, h), data + ETC_PKM_HEADER_SIZE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        *width = w;
+        *height = h;
+        return NO_ERROR;
+    }
+
     int tw = 1 << (31 - __builtin_clz(w));
     int th = 1 << (31 - __builtin_clz(h));
     if (tw < w) tw <<= 1;
@@ -1352,6 +1459,7 @@ bool BootAnimation::movie() {
             (gl_extensions.find("GL_OES_texture_npot") != -1)) {
             mUseNpotTextures = true;
         }
+        mUseEtc1Textures = gl_extensions.find("GL_OES_compressed_ETC1_RGB8_texture") != -1;
     }
 
     // Blend required to draw time on top of animation frames.
@@ -1525,6 +1633,18 @@ bool BootAnimation::playAnimation(const Animation& animation) {
             bool displayProgress = animation.progressEnabled &&
                 (i == (pcount -1)) && currentProgress != 0;
 
+            // The first play of the part decodes its frames ahead of drawing them.
+            sp<FrameDecodeThread> decodeThread;
+            if (r == 0 && fcount > 0) {
+                decodeThread = new FrameDecodeThread(part);
+                if (decodeThread->run("BootAnimation::FrameDecodeThread", PRIORITY_DISPLAY)
+                        != NO_ERROR) {
+                    decodeThread = nullptr;
+                }
+            }
+            size_t drawnFrames = 0;
+            size_t lateFrames = 0;
+
             for (size_t j=0 ; j<fcount ; j++) {
                 if (shouldStopPlayingPart(part, fadedFramesCount, lastDisplayedProgress)) break;
 
@@ -1556,9 +1676,13 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                     glGenTextures(1, &frame.tid);
                     glBindTexture(GL_TEXTURE_2D, frame.tid);
                     int w, h;
-                    // Set decoding option to alpha unpremultiplied so that the R, G, B channels
-                    // of transparent pixels are preserved.
-                    initTexture(frame.map, &w, &h, false /* don't premultiply alpha */);
+                    if (decodeThread != nullptr) {
+                        initTexture(decodeThread->takeFrame(), &w, &h);
+                    } else {
+                        // Set decoding option to alpha unpremultiplied so that the R, G, B
+                        // channels of transparent pixels are preserved.
+                        initTexture(frame.map, &w, &h, false /* don't premultiply alpha */);
+                    }
                 }
 
                 const int trimWidth = frame.trimWidth * ratio_w;
@@ -1614,12 +1738,16 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                 handleViewport(frameDuration);
 
                 eglSwapBuffers(mDisplay, mSurface);
+                drawnFrames++;
 
                 nsecs_t now = systemTime();
                 nsecs_t delay = frameDuration - (now - lastFrame);
                 //SLOGD("%lld, %lld", ns2ms(now - lastFrame), ns2ms(delay));
                 lastFrame = now;
 
+                if (delay < 0) {
+                    lateFrames++;
+                }
                 if (delay > 0) {
                     struct timespec spec;
                     spec.tv_sec  = (now + delay) / 1000000000;
@@ -1633,6 +1761,12 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                 checkExit();
             }
 
+            if (decodeThread != nullptr) {
+                decodeThread->stop();
+            }
+            ALOGD("Played %s/%s: %zu of %zu frames late", animation.fileName.string(),
+                    part.path.string(), lateFrames, drawnFrames);
+
             usleep(part.pause * ns2us(frameDuration));
 
             if (exitPending() && !part.count && mCurrentInset >= mTargetInset &&
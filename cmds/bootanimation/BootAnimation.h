@@ -166,6 +166,11 @@ private:
         BootAnimation* mBootAnimation;
     };
 
+    // Decodes the frames of a part on its own thread, a few frames ahead of the one being drawn,
+    // so that drawing a frame the first time only uploads it.
+    struct DecodedFrame;
+    class FrameDecodeThread;
+
     // Display event handling
     class DisplayEventCallback;
     std::unique_ptr<DisplayEventReceiver> mDisplayEventReceiver;
@@ -177,6 +182,8 @@ private:
         bool premultiplyAlpha = true);
     status_t initTexture(FileMap* map, int* width, int* height,
         bool premultiplyAlpha = true);
+    status_t initTexture(const DecodedFrame& frame, int* width, int* height);
+    static bool decodeFrame(FileMap* map, bool premultiplyAlpha, DecodedFrame* outFrame);
     status_t initFont(Font* font, const char* fallback);
     void initShaders();
     bool android();
@@ -220,6 +227,7 @@ private:
     int         mCurrentInset;
     int         mTargetInset;
     bool        mUseNpotTextures = false;
+    bool        mUseEtc1Textures = false;
     EGLDisplay  mDisplay;
     EGLDisplay  mContext;
     EGLDisplay  mSurface;
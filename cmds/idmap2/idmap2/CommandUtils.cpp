@@ -35,6 +35,18 @@ using android::idmap2::Unit;
 Result<Unit> Verify(const std::string& idmap_path, const std::string& target_path,
                     const std::string& overlay_path, const std::string& overlay_name,
                     PolicyBitmask fulfilled_policies, bool enforce_overlayable) {
+  // Opening the target only reads the zip directory; its table is loaded if the header is read.
+  auto target = TargetResourceContainer::FromPath(target_path);
+  if (!target) {
+    return Error("failed to load target '%s'", target_path.c_str());
+  }
+  return Verify(idmap_path, **target, overlay_path, overlay_name, fulfilled_policies,
+                enforce_overlayable);
+}
+
+Result<Unit> Verify(const std::string& idmap_path, const TargetResourceContainer& target,
+                    const std::string& overlay_path, const std::string& overlay_name,
+                    PolicyBitmask fulfilled_policies, bool enforce_overlayable) {
   SYSTRACE << "Verify " << idmap_path;
   std::ifstream fin(idmap_path);
   const std::unique_ptr<const IdmapHeader> header = IdmapHeader::FromBinaryStream(fin);
@@ -43,17 +55,12 @@ Result<Unit> Verify(const std::string& idmap_path, const std::string& target_pat
     return Error("failed to parse idmap header");
   }
 
-  auto target = TargetResourceContainer::FromPath(target_path);
-  if (!target) {
-    return Error("failed to load target '%s'", target_path.c_str());
-  }
-
   auto overlay = OverlayResourceContainer::FromPath(overlay_path);
   if (!overlay) {
     return Error("failed to load overlay '%s'", overlay_path.c_str());
   }
 
-  const auto header_ok = header->IsUpToDate(**target, **overlay, overlay_name, fulfilled_policies,
+  const auto header_ok = header->IsUpToDate(target, **overlay, overlay_name, fulfilled_policies,
                                             enforce_overlayable);
   if (!header_ok) {
     return Error(header_ok.GetError(), "idmap not up to date");
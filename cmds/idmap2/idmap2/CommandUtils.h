@@ -20,10 +20,17 @@
 #include <string>
 
 #include "idmap2/PolicyUtils.h"
+#include "idmap2/ResourceContainer.h"
 #include "idmap2/Result.h"
 
 android::idmap2::Result<android::idmap2::Unit> Verify(
     const std::string& idmap_path, const std::string& target_path, const std::string& overlay_path,
     const std::string& overlay_name, PolicyBitmask fulfilled_policies, bool enforce_overlayable);
 
+// Same as above, against a target that is already loaded.
+android::idmap2::Result<android::idmap2::Unit> Verify(
+    const std::string& idmap_path, const android::idmap2::TargetResourceContainer& target,
+    const std::string& overlay_path, const std::string& overlay_name,
+    PolicyBitmask fulfilled_policies, bool enforce_overlayable);
+
 #endif  // IDMAP2_IDMAP2_COMMANDUTILS_H_
@@ -107,7 +107,7 @@ Result<Unit> CreateMultiple(const std::vector<std::string>& args) {
     }
 
     // TODO(b/175014391): Support multiple overlay tags in OverlayConfig
-    if (!Verify(idmap_path, target_apk_path, overlay_apk_path, "", fulfilled_policies,
+    if (!Verify(idmap_path, **target, overlay_apk_path, "", fulfilled_policies,
                 !ignore_overlayable)) {
       const auto overlay = OverlayResourceContainer::FromPath(overlay_apk_path);
       if (!overlay) {
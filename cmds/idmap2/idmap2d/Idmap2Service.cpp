@@ -19,6 +19,8 @@
 #include <sys/stat.h>   // umask
 #include <sys/types.h>  // umask
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstring>
 #include <filesystem>
@@ -26,6 +28,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -47,7 +50,9 @@ using android::idmap2::Idmap;
 using android::idmap2::IdmapHeader;
 using android::idmap2::OverlayResourceContainer;
 using android::idmap2::PrettyPrintVisitor;
+using android::idmap2::Result;
 using android::idmap2::TargetResourceContainer;
+using android::idmap2::Unit;
 using android::idmap2::utils::kIdmapCacheDir;
 using android::idmap2::utils::kIdmapFilePermissionMask;
 using android::idmap2::utils::RandomStringForPath;
@@ -72,6 +77,23 @@ PolicyBitmask ConvertAidlArgToPolicyBitmask(int32_t arg) {
   return static_cast<PolicyBitmask>(arg);
 }
 
+Result<Unit> WriteIdmap(const Idmap& idmap, const std::string& idmap_path) {
+  umask(kIdmapFilePermissionMask);
+  std::ofstream fout(idmap_path);
+  if (fout.fail()) {
+    return android::idmap2::Error("failed to open idmap path %s", idmap_path.c_str());
+  }
+
+  BinaryStreamVisitor visitor(fout);
+  idmap.accept(&visitor);
+  fout.close();
+  if (fout.fail()) {
+    unlink(idmap_path.c_str());
+    return android::idmap2::Error("failed to write to idmap path %s", idmap_path.c_str());
+  }
+  return Unit{};
+}
+
 }  // namespace
 
 namespace android::os {
@@ -185,21 +207,108 @@ Status Idmap2Service::createIdmap(const std::string& target_path, const std::str
     return error(idmap.GetErrorMessage());
   }
 
-  umask(kIdmapFilePermissionMask);
-  std::ofstream fout(idmap_path);
-  if (fout.fail()) {
-    return error("failed to open idmap path " + idmap_path);
+  const auto written = WriteIdmap(**idmap, idmap_path);
+  if (!written) {
+    return error(written.GetErrorMessage());
   }
 
-  BinaryStreamVisitor visitor(fout);
-  (*idmap)->accept(&visitor);
-  fout.close();
-  if (fout.fail()) {
-    unlink(idmap_path.c_str());
-    return error("failed to write to idmap path " + idmap_path);
+  *_aidl_return = idmap_path;
+  return ok();
+}
+
+Status Idmap2Service::createIdmaps(const std::string& target_path,
+                                   const std::vector<std::string>& overlay_paths,
+                                   const std::vector<std::string>& overlay_names,
+                                   int32_t fulfilled_policies, bool enforce_overlayable,
+                                   int32_t user_id ATTRIBUTE_UNUSED,
+                                   std::vector<std::string>* _aidl_return) {
+  assert(_aidl_return);
+  SYSTRACE << "Idmap2Service::createIdmaps " << target_path << " " << overlay_paths.size();
+  if (overlay_names.size() != overlay_paths.size()) {
+    return error(base::StringPrintf("got %zu overlay names for %zu overlays", overlay_names.size(),
+                                    overlay_paths.size()));
   }
+  _aidl_return->assign(overlay_paths.size(), "");
 
-  *_aidl_return = idmap_path;
+  const PolicyBitmask policy_bitmask = ConvertAidlArgToPolicyBitmask(fulfilled_policies);
+  const uid_t uid = IPCThreadState::self()->getCallingUid();
+
+  const auto target_ptr = GetTargetContainer(target_path);
+  if (!target_ptr) {
+    return error("failed to load target '" + target_path + "'");
+  }
+
+  // The target loads its resource table on first use. Load it before the overlays are mapped
+  // against it, after which the target is only read from.
+  const TargetResourceContainer& target = *GetPointer(*target_ptr);
+  if (const auto defines_overlayable = target.DefinesOverlayable(); !defines_overlayable) {
+    return error("failed to load target '" + target_path +
+                 "': " + defines_overlayable.GetErrorMessage());
+  }
+
+  std::vector<std::string> idmap_paths(overlay_paths.size());
+  std::vector<std::unique_ptr<const Idmap>> idmaps(overlay_paths.size());
+  std::atomic<size_t> next_overlay = 0;
+  auto map_overlays = [&]() {
+    for (size_t i = next_overlay++; i < overlay_paths.size(); i = next_overlay++) {
+      SYSTRACE << "Idmap2Service::createIdmaps " << overlay_paths[i];
+      const std::string idmap_path = Idmap::CanonicalIdmapPathFor(kIdmapCacheDir, overlay_paths[i]);
+      if (!UidHasWriteAccessToPath(uid, idmap_path)) {
+        LOG(WARNING) << "will not write to " << idmap_path << ": calling uid " << uid
+                     << " lacks write access";
+        continue;
+      }
+
+      const auto overlay = OverlayResourceContainer::FromPath(overlay_paths[i]);
+      if (!overlay) {
+        LOG(WARNING) << "failed to load overlay '" << overlay_paths[i] << "'";
+        continue;
+      }
+
+      std::ifstream fin(idmap_path);
+      const std::unique_ptr<const IdmapHeader> header = IdmapHeader::FromBinaryStream(fin);
+      fin.close();
+      if (header && header->IsUpToDate(target, **overlay, overlay_names[i], policy_bitmask,
+                                       enforce_overlayable)) {
+        idmap_paths[i] = idmap_path;
+        continue;
+      }
+
+      // As in createIdmap, the stale idmap is deleted first so that the overlay is no longer
+      // usable if its idmap can't be created.
+      unlink(idmap_path.c_str());
+      auto idmap = Idmap::FromContainers(target, **overlay, overlay_names[i], policy_bitmask,
+                                         enforce_overlayable);
+      if (!idmap) {
+        LOG(WARNING) << "failed to create idmap of '" << overlay_paths[i]
+                     << "': " << idmap.GetErrorMessage();
+        continue;
+      }
+      idmaps[i] = std::move(*idmap);
+      idmap_paths[i] = idmap_path;
+    }
+  };
+
+  const size_t thread_count =
+      std::min<size_t>(overlay_paths.size(), std::max(1U, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(map_overlays);
+  }
+  map_overlays();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < overlay_paths.size(); i++) {
+    if (idmaps[i] != nullptr) {
+      if (const auto written = WriteIdmap(*idmaps[i], idmap_paths[i]); !written) {
+        LOG(WARNING) << written.GetErrorMessage();
+        continue;
+      }
+    }
+    (*_aidl_return)[i] = std::move(idmap_paths[i]);
+  }
   return ok();
 }
 
@@ -280,6 +389,8 @@ Status Idmap2Service::createFabricatedOverlay(
     unlink(path.c_str());
     return error("failed to write to frro path " + path + ": " + result.GetErrorMessage());
   }
+  // Closed before the info is cached, so that the size and modification time cached are final.
+  fout.close();
   if (fout.fail()) {
     unlink(path.c_str());
     return error("failed to write to frro path " + path);
@@ -291,10 +402,48 @@ Status Idmap2Service::createFabricatedOverlay(
   out_info.targetPackageName = overlay.targetPackageName;
   out_info.targetOverlayable = overlay.targetOverlayable;
   out_info.path = path;
+  CacheFrroInfo(out_info);
   *_aidl_return = out_info;
   return ok();
 }
 
+std::optional<os::FabricatedOverlayInfo> Idmap2Service::FindCachedFrroInfo(
+    const std::filesystem::directory_entry& entry) {
+  std::error_code ec;
+  const auto file_size = entry.file_size(ec);
+  if (ec) {
+    return {};
+  }
+  const auto last_write_time = entry.last_write_time(ec);
+  if (ec) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(frro_infos_lock_);
+  auto it = frro_infos_.find(entry.path());
+  if (it == frro_infos_.end() || it->second.file_size != file_size ||
+      it->second.last_write_time != last_write_time) {
+    return {};
+  }
+  return it->second.info;
+}
+
+void Idmap2Service::CacheFrroInfo(const os::FabricatedOverlayInfo& info) {
+  const std::filesystem::directory_entry entry(info.path);
+  std::error_code ec;
+  const auto file_size = entry.file_size(ec);
+  if (ec) {
+    return;
+  }
+  const auto last_write_time = entry.last_write_time(ec);
+  if (ec) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(frro_infos_lock_);
+  frro_infos_[info.path] = CachedFrroInfo{file_size, last_write_time, info};
+}
+
 Status Idmap2Service::acquireFabricatedOverlayIterator() {
   if (frro_iter_.has_value()) {
     LOG(WARNING) << "active ffro iterator was not previously released";
@@ -322,7 +471,17 @@ Status Idmap2Service::nextFabricatedOverlayInfos(
   auto entry_iter_end = end(*frro_iter_);
   for (; entry_iter != entry_iter_end && count < kMaxEntryCount; ++entry_iter) {
     auto& entry = *entry_iter;
-    if (!entry.is_regular_file() || !android::IsFabricatedOverlay(entry.path())) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+
+    if (auto info = FindCachedFrroInfo(entry)) {
+      _aidl_return->emplace_back(std::move(*info));
+      count++;
+      continue;
+    }
+
+    if (!android::IsFabricatedOverlay(entry.path())) {
       continue;
     }
 
@@ -339,6 +498,7 @@ Status Idmap2Service::nextFabricatedOverlayInfos(
     out_info.targetPackageName = info.target_package;
     out_info.targetOverlayable = info.target_name;
     out_info.path = entry.path();
+    CacheFrroInfo(out_info);
     _aidl_return->emplace_back(std::move(out_info));
     count++;
   }
@@ -367,6 +527,10 @@ binder::Status Idmap2Service::deleteFabricatedOverlay(const std::string& overlay
     *_aidl_return = false;
     return error("failed to unlink " + overlay_path + ": " + strerror(errno));
   }
+  {
+    std::lock_guard<std::mutex> lock(frro_infos_lock_);
+    frro_infos_.erase(overlay_path);
+  }
 
   if (unlink(idmap_path.c_str()) != 0) {
     *_aidl_return = false;
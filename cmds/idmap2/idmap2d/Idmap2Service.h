@@ -26,7 +26,9 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace android::os {
@@ -53,6 +55,15 @@ class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
                              bool enforce_overlayable, int32_t user_id,
                              std::optional<std::string>* _aidl_return) override;
 
+  // Verifies the idmaps of several overlays of the same target, and creates those that are not up
+  // to date. The target is loaded once and the overlays are mapped against it in parallel. Returns
+  // the idmap path of each overlay, or an empty string for those whose idmap could not be created.
+  binder::Status createIdmaps(const std::string& target_path,
+                              const std::vector<std::string>& overlay_paths,
+                              const std::vector<std::string>& overlay_names,
+                              int32_t fulfilled_policies, bool enforce_overlayable,
+                              int32_t user_id, std::vector<std::string>* _aidl_return);
+
   binder::Status createFabricatedOverlay(
       const os::FabricatedOverlayInternal& overlay,
       std::optional<os::FabricatedOverlayInfo>* _aidl_return) override;
@@ -76,6 +87,21 @@ class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
 
   std::optional<std::filesystem::directory_iterator> frro_iter_;
 
+  // The infos of the fabricated overlays written or read, by path, along with the size and
+  // modification time of the file then. The fabricated overlays are listed each time the overlays
+  // are checked, such as on every theme change, and most are unchanged since they were last read.
+  struct CachedFrroInfo {
+    std::uintmax_t file_size;
+    std::filesystem::file_time_type last_write_time;
+    os::FabricatedOverlayInfo info;
+  };
+  std::mutex frro_infos_lock_;
+  std::unordered_map<std::string, CachedFrroInfo> frro_infos_;
+
+  std::optional<os::FabricatedOverlayInfo> FindCachedFrroInfo(
+      const std::filesystem::directory_entry& entry);
+  void CacheFrroInfo(const os::FabricatedOverlayInfo& info);
+
   template <typename T>
   using MaybeUniquePtr = std::variant<std::unique_ptr<T>, T*>;
 
@@ -17,7 +17,10 @@
 #include "idmap2/ResourceContainer.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -319,6 +322,19 @@ struct ApkResourceContainer : public TargetResourceContainer, public OverlayReso
 
   mutable std::variant<std::unique_ptr<ZipAssetsProvider>, ResState> state_;
   std::string path_;
+
+  // The compile-time IDs of the resources of the package by "type/entry" name. An overlay targets
+  // hundreds of resources by name, and looking each up through the asset manager searches the type
+  // and key string pools of the package. Built on the first lookup; safe to use from several
+  // threads once the state is loaded.
+  mutable std::once_flag name_index_once_;
+  mutable std::unordered_map<std::string, ResourceId> name_index_;
+
+  // The overlayable declaration of each resource of the package that has one. Checking the
+  // policies of every overlaid resource would otherwise search the ids of each overlayable policy
+  // of the package. Built on the first lookup, like `name_index_`.
+  mutable std::once_flag overlayable_index_once_;
+  mutable std::unordered_map<ResourceId, const android::OverlayableInfo*> overlayable_index_;
 };
 
 ApkResourceContainer::ApkResourceContainer(std::unique_ptr<ZipAssetsProvider> zip_assets,
@@ -372,7 +388,20 @@ Result<const android::OverlayableInfo*> ApkResourceContainer::GetOverlayableInfo
   if (!state) {
     return state.GetError();
   }
-  return (*state)->package->GetOverlayableInfo(id);
+
+  std::call_once(overlayable_index_once_, [&]() {
+    (*state)->package->ForEachOverlayable(
+        [&](const android::OverlayableInfo& info, const std::unordered_set<uint32_t>& ids) {
+          for (const uint32_t resid : ids) {
+            // The first policy that declares a resource wins, as in GetOverlayableInfo().
+            overlayable_index_.emplace(resid, &info);
+          }
+        });
+  });
+  if (auto it = overlayable_index_.find(id); it != overlayable_index_.end()) {
+    return it->second;
+  }
+  return nullptr;
 }
 
 Result<OverlayManifestInfo> ApkResourceContainer::FindOverlayInfo(const std::string& name) const {
@@ -405,6 +434,19 @@ Result<ResourceId> ApkResourceContainer::GetResourceId(const std::string& name)
   if (!state) {
     return state.GetError();
   }
+
+  std::call_once(name_index_once_, [&]() {
+    for (const ResourceId resid : *(*state)->package) {
+      if (auto entry_name = utils::ResToTypeEntryName(*(*state)->am, resid)) {
+        name_index_.emplace(std::move(*entry_name), resid);
+      }
+    }
+  });
+  if (auto it = name_index_.find(name); it != name_index_.end()) {
+    return it->second;
+  }
+
+  // Names with a package, and attributes kept as ^attr-private, are resolved by the asset manager.
   auto id = (*state)->am->GetResourceId(name, "", (*state)->package->GetPackageName());
   if (!id.has_value()) {
     return Error("failed to find resource '%s'", name.c_str());
@@ -20,6 +20,7 @@
 #include "R.h"
 #include "TestHelpers.h"
 #include "androidfw/ApkAssets.h"
+#include "androidfw/ResourceTypes.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "idmap2/ResourceContainer.h"
@@ -61,6 +62,53 @@ TEST_F(ResourceUtilsTests, ResToTypeEntryNameNoSuchResourceId) {
   ASSERT_FALSE(name);
 }
 
+TEST_F(ResourceUtilsTests, TargetResourceContainerGetResourceId) {
+  auto target = TargetResourceContainer::FromPath(GetTargetApkPath());
+  ASSERT_TRUE(target);
+
+  for (int i = 0; i < 2; i++) {
+    Result<ResourceId> id = (*target)->GetResourceId("integer/int1");
+    ASSERT_TRUE(id) << id.GetErrorMessage();
+    ASSERT_EQ(*id, R::target::integer::int1);
+  }
+
+  Result<ResourceId> id = (*target)->GetResourceId("test.target:string/str4");
+  ASSERT_TRUE(id) << id.GetErrorMessage();
+  ASSERT_EQ(*id, R::target::string::str4);
+
+  ASSERT_FALSE((*target)->GetResourceId("string/missing"));
+}
+
+TEST_F(ResourceUtilsTests, TargetResourceContainerGetOverlayableInfo) {
+  using PolicyFlags = ResTable_overlayable_policy_header::PolicyFlags;
+
+  auto target = TargetResourceContainer::FromPath(GetTargetApkPath());
+  ASSERT_TRUE(target);
+
+  // Repeated lookups are served from the index built by the first one.
+  for (int i = 0; i < 2; i++) {
+    auto info = (*target)->GetOverlayableInfo(R::target::string::policy_public);
+    ASSERT_TRUE(info) << info.GetErrorMessage();
+    ASSERT_THAT(*info, NotNull());
+    EXPECT_EQ("TestResources", (*info)->name);
+    EXPECT_NE(0U, (*info)->policy_flags & PolicyFlags::PUBLIC);
+  }
+
+  auto info = (*target)->GetOverlayableInfo(R::target::string::policy_system);
+  ASSERT_TRUE(info) << info.GetErrorMessage();
+  ASSERT_THAT(*info, NotNull());
+  EXPECT_NE(0U, (*info)->policy_flags & PolicyFlags::SYSTEM_PARTITION);
+
+  // Resources outside of any overlayable, or not in the package at all, have none.
+  info = (*target)->GetOverlayableInfo(R::target::string::not_overlayable);
+  ASSERT_TRUE(info) << info.GetErrorMessage();
+  EXPECT_EQ(nullptr, *info);
+
+  info = (*target)->GetOverlayableInfo(0x7f123456U);
+  ASSERT_TRUE(info) << info.GetErrorMessage();
+  EXPECT_EQ(nullptr, *info);
+}
+
 TEST_F(ResourceUtilsTests, InvalidValidOverlayNameInvalidAttributes) {
   auto overlay =
       OverlayResourceContainer::FromPath(GetTestDataPath() + "/overlay/overlay-invalid.apk");
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <strings.h>
 #include <unistd.h>
 
 bool isValidChar(char c) {
@@ -38,60 +39,84 @@ std::string trim(const std::string& s, const std::string& charset) {
     return s.substr(head, tail - head + 1);
 }
 
-static inline std::string toLowerStr(const std::string& s) {
-    std::string res(s);
-    std::transform(res.begin(), res.end(), res.begin(), ::tolower);
-    return res;
-}
-
 static inline std::string trimDefault(const std::string& s) {
     return trim(s, DEFAULT_WHITESPACE);
 }
 
-static inline std::string trimHeader(const std::string& s) {
-    return toLowerStr(trimDefault(s));
-}
-
 static inline bool isNumber(const std::string& s) {
     std::string::const_iterator it = s.begin();
     while (it != s.end() && std::isdigit(*it)) ++it;
     return !s.empty() && it == s.end();
 }
 
-// This is similiar to Split in android-base/file.h, but it won't add empty string
-static void split(const std::string& line, std::vector<std::string>& words,
-        const trans_func& func, const std::string& delimiters) {
-    words.clear();  // clear the buffer before split
+static inline bool isDefaultWhitespace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// Assigns line[begin, end) trimmed of the default whitespace to words[i], appending it if i is
+// the size of words. The string already in words[i] is reused, so its buffer is too.
+static void assignTrimmed(std::vector<std::string>* words, size_t i, const std::string& line,
+        size_t begin, size_t end) {
+    while (begin < end && isDefaultWhitespace(line[begin])) begin++;
+    while (end > begin && isDefaultWhitespace(line[end - 1])) end--;
+    if (i == words->size()) {
+        words->emplace_back();
+    }
+    (*words)[i].assign(line, begin, end - begin);
+}
+
+// This is similiar to Split in android-base/file.h, but it won't add empty string, and trims
+// each word of the default whitespace. The words already in the vector are overwritten in place,
+// so that splitting every line of a table into the same vector doesn't allocate.
+static void split(const std::string& line, std::vector<std::string>* words,
+        const std::string& delimiters, bool lowerCase) {
+    bool isDelimiter[256] = {};
+    for (char c : delimiters) {
+        isDelimiter[(uint8_t)c] = true;
+    }
 
-    size_t base = 0;
-    size_t found;
-    while (true) {
-        found = line.find_first_of(delimiters, base);
-        if (found != base) {
-            std::string word = (*func) (line.substr(base, found - base));
-            if (!word.empty()) {
-                words.push_back(word);
+    const size_t size = line.size();
+    size_t count = 0;
+    for (size_t base = 0; base <= size;) {
+        size_t found = base;
+        while (found < size && !isDelimiter[(uint8_t)line[found]]) found++;
+
+        size_t head = base;
+        size_t tail = found;
+        while (head < tail && isDefaultWhitespace(line[head])) head++;
+        if (head < tail) {
+            assignTrimmed(words, count, line, head, tail);
+            if (lowerCase) {
+                std::string& word = (*words)[count];
+                std::transform(word.begin(), word.end(), word.begin(), ::tolower);
             }
+            count++;
         }
-        if (found == line.npos) break;
         base = found + 1;
     }
+    words->resize(count);
 }
 
 header_t parseHeader(const std::string& line, const std::string& delimiters) {
     header_t header;
-    trans_func f = &trimHeader;
-    split(line, header, f, delimiters);
+    parseHeader(line, &header, delimiters);
     return header;
 }
 
+void parseHeader(const std::string& line, header_t* header, const std::string& delimiters) {
+    split(line, header, delimiters, true);
+}
+
 record_t parseRecord(const std::string& line, const std::string& delimiters) {
     record_t record;
-    trans_func f = &trimDefault;
-    split(line, record, f, delimiters);
+    parseRecord(line, &record, delimiters);
     return record;
 }
 
+void parseRecord(const std::string& line, record_t* record, const std::string& delimiters) {
+    split(line, record, delimiters, false);
+}
+
 bool getColumnIndices(std::vector<int>& indices, const char** headerNames, const std::string& line) {
     indices.clear();
 
@@ -114,6 +139,13 @@ bool getColumnIndices(std::vector<int>& indices, const char** headerNames, const
 
 record_t parseRecordByColumns(const std::string& line, const std::vector<int>& indices, const std::string& delimiters) {
     record_t record;
+    parseRecordByColumns(line, indices, &record, delimiters);
+    return record;
+}
+
+void parseRecordByColumns(const std::string& line, const std::vector<int>& indices,
+        record_t* record, const std::string& delimiters) {
+    size_t count = 0;
     int lastIndex = 0;
     int lastBeginning = 0;
     int lineSize = (int)line.size();
@@ -132,25 +164,25 @@ record_t parseRecordByColumns(const std::string& line, const std::vector<int>& i
             }
             // If we're past the end of the line AND we've already saved everything up to the end.
             fprintf(stderr, "index wrong: lastIndex: %d, idx: %d, lineSize: %d\n", lastIndex, idx, lineSize);
-            record.clear(); // The indices are wrong, return empty.
-            return record;
+            record->clear(); // The indices are wrong, return empty.
+            return;
         }
         while (idx < lineSize && delimiters.find(line[idx++]) == std::string::npos);
-        record.push_back(trimDefault(line.substr(lastIndex, idx - lastIndex)));
+        assignTrimmed(record, count++, line, lastIndex, idx);
         lastBeginning = lastIndex;
         lastIndex = idx;
     }
     if (lineSize - lastIndex > 0) {
         int beginning = lastIndex;
-        if (record.size() == indices.size() && !record.empty()) {
+        if (count == indices.size() && count != 0) {
             // We've already encountered all of the columns...put whatever is
             // left in the last column.
-            record.pop_back();
+            count--;
             beginning = lastBeginning;
         }
-        record.push_back(trimDefault(line.substr(beginning, lineSize - beginning)));
+        assignTrimmed(record, count++, line, beginning, lineSize);
     }
-    return record;
+    record->resize(count);
 }
 
 void printRecord(const record_t& record) {
@@ -237,24 +269,28 @@ double toDouble(const std::string& s) {
 Reader::Reader(const int fd)
 {
     mFile = fdopen(fd, "r");
-    mBuffer = new char[1024];
+    mBuffer = nullptr;
+    mBufferSize = 0;
     mStatus = mFile == nullptr ? "Invalid fd " + std::to_string(fd) : "";
 }
 
 Reader::~Reader()
 {
     if (mFile != nullptr) fclose(mFile);
-    delete[] mBuffer;
+    free(mBuffer); // allocated by getline
 }
 
 bool Reader::readLine(std::string* line) {
     if (mFile == nullptr) return false;
 
-    size_t len = 0;
-    ssize_t read = getline(&mBuffer, &len, mFile);
+    // getline reuses mBuffer, and only grows it for lines longer than any before.
+    ssize_t read = getline(&mBuffer, &mBufferSize, mFile);
     if (read != -1) {
-        std::string s(mBuffer);
-        line->assign(trim(s, DEFAULT_NEWLINE));
+        size_t head = 0;
+        size_t tail = strnlen(mBuffer, read);
+        while (head < tail && (mBuffer[head] == '\r' || mBuffer[head] == '\n')) head++;
+        while (tail > head && (mBuffer[tail - 1] == '\r' || mBuffer[tail - 1] == '\n')) tail--;
+        line->assign(mBuffer + head, tail - head);
         return true;
     }
     if (!feof(mFile)) {
@@ -311,9 +347,10 @@ Table::addEnumNameToValue(const char* enumName, const int enumValue)
 bool
 Table::insertField(ProtoOutputStream* proto, const std::string& name, const std::string& value)
 {
-    if (mFields.find(name) == mFields.end()) return false;
+    const auto field = mFields.find(name);
+    if (field == mFields.end()) return false;
 
-    uint64_t found = mFields[name];
+    uint64_t found = field->second;
     record_t repeats; // used for repeated fields
     switch ((found & FIELD_COUNT_MASK) | (found & FIELD_TYPE_MASK)) {
         case FIELD_COUNT_SINGLE | FIELD_TYPE_DOUBLE:
@@ -332,25 +369,27 @@ Table::insertField(ProtoOutputStream* proto, const std::string& name, const std:
             proto->write(found, toLongLong(value));
             break;
         case FIELD_COUNT_SINGLE | FIELD_TYPE_BOOL:
-            if (strcmp(toLowerStr(value).c_str(), "true") == 0 || strcmp(value.c_str(), "1") == 0) {
+            if (strcasecmp(value.c_str(), "true") == 0 || strcmp(value.c_str(), "1") == 0) {
                 proto->write(found, true);
                 break;
             }
-            if (strcmp(toLowerStr(value).c_str(), "false") == 0 || strcmp(value.c_str(), "0") == 0) {
+            if (strcasecmp(value.c_str(), "false") == 0 || strcmp(value.c_str(), "0") == 0) {
                 proto->write(found, false);
                 break;
             }
             return false;
         case FIELD_COUNT_SINGLE | FIELD_TYPE_ENUM:
             // if the field has its own enum mapping, use this, otherwise use general name to value mapping.
-            if (mEnums.find(name) != mEnums.end()) {
-                if (mEnums[name].find(value) != mEnums[name].end()) {
-                    proto->write(found, mEnums[name][value]);
+            if (const auto enu = mEnums.find(name); enu != mEnums.end()) {
+                const auto enumValue = enu->second.find(value);
+                if (enumValue != enu->second.end()) {
+                    proto->write(found, enumValue->second);
                 } else {
                     proto->write(found, 0); // TODO: should get the default enum value (Unknown)
                 }
-            } else if (mEnumValuesByName.find(value) != mEnumValuesByName.end()) {
-                proto->write(found, mEnumValuesByName[value]);
+            } else if (const auto enumValue = mEnumValuesByName.find(value);
+                    enumValue != mEnumValuesByName.end()) {
+                proto->write(found, enumValue->second);
             } else if (isNumber(value)) {
                 proto->write(found, toInt(value));
             } else {
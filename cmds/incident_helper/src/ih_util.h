@@ -57,6 +57,13 @@ std::string trim(const std::string& s, const std::string& charset);
 header_t parseHeader(const std::string& line, const std::string& delimiters = DEFAULT_WHITESPACE);
 record_t parseRecord(const std::string& line, const std::string& delimiters = DEFAULT_WHITESPACE);
 
+/**
+ * Same as above, but parses into the given vector, reusing its strings. Parsing every line of a
+ * table into the same record doesn't allocate once it holds the longest values.
+ */
+void parseHeader(const std::string& line, header_t* header, const std::string& delimiters = DEFAULT_WHITESPACE);
+void parseRecord(const std::string& line, record_t* record, const std::string& delimiters = DEFAULT_WHITESPACE);
+
 /**
  * Gets the list of end indices of each word in the line and places it in the given vector,
  * clearing out the vector beforehand. These indices can be used with parseRecordByColumns.
@@ -71,6 +78,8 @@ bool getColumnIndices(std::vector<int>& indices, const char* headerNames[], cons
  * At the same time, it still looks at the char at index, if it doesn't belong to delimiters, moves forward to find the delimiters.
  */
 record_t parseRecordByColumns(const std::string& line, const std::vector<int>& indices, const std::string& delimiters = DEFAULT_WHITESPACE);
+void parseRecordByColumns(const std::string& line, const std::vector<int>& indices, record_t* record,
+        const std::string& delimiters = DEFAULT_WHITESPACE);
 
 /** Prints record_t to stderr */
 void printRecord(const record_t& record);
@@ -118,6 +127,7 @@ public:
 private:
     FILE* mFile;
     char* mBuffer;
+    size_t mBufferSize;
     std::string mStatus;
 };
 
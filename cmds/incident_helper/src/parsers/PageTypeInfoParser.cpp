@@ -31,6 +31,8 @@ PageTypeInfoParser::Parse(const int in, const int out) const
     bool migrateTypeSession = false;
     int pageBlockOrder;
     header_t blockHeader;
+    record_t record;
+    record_t counts;
 
     ProtoOutputStream proto;
     Table table(PageTypeInfoProto::Block::_FIELD_NAMES,
@@ -62,7 +64,7 @@ PageTypeInfoParser::Parse(const int in, const int out) const
             continue;
         }
 
-        record_t record = parseRecord(line, COMMA_DELIMITER);
+        parseRecord(line, &record, COMMA_DELIMITER);
         if (migrateTypeSession && record.size() == 3) {
             uint64_t token = proto.start(PageTypeInfoProto::MIGRATE_TYPES);
             // expect part 0 starts with "Node"
@@ -78,11 +80,11 @@ PageTypeInfoParser::Parse(const int in, const int out) const
                 // An example looks like:
                 // header line:      type    0   1   2 3 4 5 6 7 8 9 10
                 // record line: Unmovable  426 279 226 1 1 1 0 0 2 2  0
-                record_t pageCounts = parseRecord(record[2]);
+                parseRecord(record[2], &counts);
 
-                proto.write(PageTypeInfoProto::MigrateType::TYPE, pageCounts[0]);
-                for (size_t i=1; i<pageCounts.size(); i++) {
-                    proto.write(PageTypeInfoProto::MigrateType::FREE_PAGES_COUNT, toInt(pageCounts[i]));
+                proto.write(PageTypeInfoProto::MigrateType::TYPE, counts[0]);
+                for (size_t i=1; i<counts.size(); i++) {
+                    proto.write(PageTypeInfoProto::MigrateType::FREE_PAGES_COUNT, toInt(counts[i]));
                 }
             } else return BAD_VALUE;
 
@@ -94,13 +96,13 @@ PageTypeInfoParser::Parse(const int in, const int out) const
             } else return BAD_VALUE;
 
             if (stripPrefix(&record[1], "zone")) {
-                record_t blockCounts = parseRecord(record[1]);
-                proto.write(PageTypeInfoProto::Block::ZONE, blockCounts[0]);
+                parseRecord(record[1], &counts);
+                proto.write(PageTypeInfoProto::Block::ZONE, counts[0]);
 
                 for (size_t i=0; i<blockHeader.size(); i++) {
-                    if (!table.insertField(&proto, blockHeader[i], blockCounts[i+1])) {
+                    if (!table.insertField(&proto, blockHeader[i], counts[i+1])) {
                         fprintf(stderr, "Header %s has bad data %s\n", blockHeader[i].c_str(),
-                            blockCounts[i+1].c_str());
+                            counts[i+1].c_str());
                     }
                 }
             } else return BAD_VALUE;
@@ -46,7 +46,7 @@ status_t PsParser::Parse(const int in, const int out) const {
         if (line.empty()) continue;
 
         if (nline++ == 0) {
-            header = parseHeader(line, DEFAULT_WHITESPACE);
+            parseHeader(line, &header, DEFAULT_WHITESPACE);
 
             const char* headerNames[] = { "LABEL", "USER", "PID", "TID", "PPID", "VSZ", "RSS", "WCHAN", "ADDR", "S", "PRI", "NI", "RTPRIO", "SCH", "PCY", "TIME", "CMD", nullptr };
             if (!getColumnIndices(columnIndices, headerNames, line)) {
@@ -56,7 +56,7 @@ status_t PsParser::Parse(const int in, const int out) const {
             continue;
         }
 
-        record = parseRecordByColumns(line, columnIndices);
+        parseRecordByColumns(line, columnIndices, &record);
 
         diff = record.size() - header.size();
         if (diff < 0) {
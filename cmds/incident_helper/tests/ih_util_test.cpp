@@ -64,6 +64,28 @@ TEST(IhUtilTest, ParseRecord) {
     EXPECT_TRUE(result.empty());
 }
 
+TEST(IhUtilTest, ParseRecordInPlace) {
+    record_t result, expected;
+    parseRecord(" a bb  ccc dddd", &result);
+    expected = { "a", "bb", "ccc", "dddd" };
+    EXPECT_EQ(expected, result);
+
+    // Fewer words than the previous line.
+    parseRecord("e, f ,", &result, COMMA_DELIMITER);
+    expected = { "e", "f" };
+    EXPECT_EQ(expected, result);
+
+    header_t header;
+    parseHeader("PID  Vss", &header);
+    expected = { "pid", "vss" };
+    EXPECT_EQ(expected, header);
+
+    std::vector<int> indices = { 3, 10 };
+    parseRecordByColumns("abc \t2345  6789 ", indices, &result);
+    expected = { "abc", "2345  6789" };
+    EXPECT_EQ(expected, result);
+}
+
 TEST(IhUtilTest, ParseRecordByColumns) {
     record_t result, expected;
     std::vector<int> indices = { 3, 10 };
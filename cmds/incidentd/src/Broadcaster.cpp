@@ -167,8 +167,17 @@ Broadcaster::broadcast_status_t Broadcaster::sendBroadcasts() {
     vector<sp<ReportFile>> files;
     mWorkDirectory->getReports(&files, 0); //lastSent);
 
-    // Don't send multiple broadcasts to the same receiver.
-    set<ReportId> reportReadyBroadcasts;
+    // The approvals that came in since the last pass are saved here, so that a burst of
+    // them costs one envelope write per file.
+    set<ReportId> approvals;
+    {
+        unique_lock<mutex> lock(mLock);
+        approvals = mPendingApprovals;
+    }
+
+    // Don't send multiple broadcasts to the same receiver.  The value is the ids of the
+    // reports that the broadcast is for.
+    map<pair<string,string>,vector<string>> reportReadyBroadcasts;
 
     for (const sp<ReportFile>& file: files) {
         err = file->loadEnvelope();
@@ -178,6 +187,10 @@ Broadcaster::broadcast_status_t Broadcaster::sendBroadcasts() {
             continue;
         }
 
+        if (!apply_pending_approvals(file, approvals)) {
+            continue;
+        }
+
         const ReportFileProto& envelope = file->getEnvelope();
 
         if (!envelope.completed()) {
@@ -212,8 +225,11 @@ Broadcaster::broadcast_status_t Broadcaster::sendBroadcasts() {
                             return BROADCASTS_BACKOFF;
                         }
                     } else {
-                        reportReadyBroadcasts.insert(ReportId(file->getId(), report.pkg(),
-                                    report.cls()));
+                        vector<string>& ids = reportReadyBroadcasts[make_pair(report.pkg(),
+                                report.cls())];
+                        if (ids.empty() || ids.back() != file->getId()) {
+                            ids.push_back(file->getId());
+                        }
                     }
                 }
             } else {
@@ -234,8 +250,17 @@ Broadcaster::broadcast_status_t Broadcaster::sendBroadcasts() {
         }
     }
 
-    for (const ReportId& report: reportReadyBroadcasts) {
-        err = send_report_ready_broadcasts(report.id, report.pkg, report.cls);
+    // The approvals of reports that are gone have nothing left to be saved to.
+    {
+        unique_lock<mutex> lock(mLock);
+        for (const ReportId& approval: approvals) {
+            mPendingApprovals.erase(approval);
+        }
+    }
+
+    for (const auto& broadcast: reportReadyBroadcasts) {
+        err = send_report_ready_broadcasts(broadcast.first.first, broadcast.first.second,
+                broadcast.second);
         if (err != NO_ERROR) {
             return BROADCASTS_BACKOFF;
         }
@@ -322,32 +347,45 @@ status_t Broadcaster::send_approval_broadcasts(const string& id, const string& p
 }
 
 void Broadcaster::report_approved(const ReportId& reportId) {
-    status_t err;
-
-    // Kick off broadcaster to do send the ready broadcasts.
+    // Kick off broadcaster to do send the ready broadcasts.  The approval is saved to
+    // the envelope by that pass, along with any other approval that comes in before it.
     ALOGI("The user approved the report, so kicking off another broadcast pass. %s %s/%s",
             reportId.id.c_str(), reportId.pkg.c_str(), reportId.cls.c_str());
-    sp<ReportFile> file = mWorkDirectory->getReport(reportId.pkg, reportId.cls, reportId.id,
-            nullptr);
-    if (file != nullptr) {
-        err = file->loadEnvelope();
-        if (err != NO_ERROR) {
-            return;
-        }
+    {
+        unique_lock<mutex> lock(mLock);
+        mPendingApprovals.insert(reportId);
+    }
+    mReportHandler->scheduleSendBacklog();
+}
 
-        err = file->markApproved(reportId.pkg, reportId.cls);
-        if (err != NO_ERROR) {
+bool Broadcaster::apply_pending_approvals(const sp<ReportFile>& file,
+        const set<ReportId>& approvals) {
+    const string id = file->getId();
+    vector<ReportId> applied;
+    for (set<ReportId>::const_iterator it = approvals.lower_bound(ReportId(id, "", ""));
+            it != approvals.end() && it->id == id; it++) {
+        if (file->markApproved(it->pkg, it->cls) != NO_ERROR) {
             ALOGI("Couldn't find report that was just approved: %s %s/%s",
-                    reportId.id.c_str(), reportId.pkg.c_str(), reportId.cls.c_str());
-            return;
+                    it->id.c_str(), it->pkg.c_str(), it->cls.c_str());
+            continue;
         }
+        applied.push_back(*it);
+    }
+    if (applied.empty()) {
+        return true;
+    }
 
-        file->saveEnvelope();
-        if (err != NO_ERROR) {
-            return;
-        }
+    status_t err = file->saveEnvelope();
+    if (err != NO_ERROR) {
+        // saveEnvelope() removed the report.
+        return false;
     }
-    mReportHandler->scheduleSendBacklog();
+
+    unique_lock<mutex> lock(mLock);
+    for (const ReportId& approval: applied) {
+        mPendingApprovals.erase(approval);
+    }
+    return true;
 }
 
 void Broadcaster::report_denied(const ReportId& reportId) {
@@ -361,14 +399,16 @@ void Broadcaster::report_denied(const ReportId& reportId) {
     }
 }
 
-status_t Broadcaster::send_report_ready_broadcasts(const string& id, const string& pkg,
-        const string& cls) {
+status_t Broadcaster::send_report_ready_broadcasts(const string& pkg, const string& cls,
+        const vector<string>& ids) {
     sp<IIncidentCompanion> ics = get_incident_companion();
     if (ics == nullptr) {
         return NAME_NOT_FOUND;
     }
 
-    ALOGI("send_report_ready_broadcasts for %s %s/%s", id.c_str(), pkg.c_str(), cls.c_str());
+    // The broadcast doesn't name the report, so one tells the receiver about all of them.
+    ALOGI("send_report_ready_broadcasts for %zu reports to %s/%s", ids.size(), pkg.c_str(),
+            cls.c_str());
 
     Status status = ics->sendReportReadyBroadcast(String16(pkg.c_str()), String16(cls.c_str()));
 
@@ -377,7 +417,9 @@ status_t Broadcaster::send_report_ready_broadcasts(const string& id, const strin
         return status.transactionError();
     }
 
-    set_ready_sent(id, pkg, cls);
+    for (const string& id: ids) {
+        set_ready_sent(id, pkg, cls);
+    }
 
     return NO_ERROR;
 }
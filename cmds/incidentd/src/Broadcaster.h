@@ -102,6 +102,7 @@ private:
     // protected by mLock
     mutex mLock;
     map<ReportId,ReportStatus> mHistory; // what we sent so we don't send it again
+    set<ReportId> mPendingApprovals; // approved, but not yet saved to the envelopes
     int64_t mLastSent;
 
     void set_last_sent(int64_t timestamp);
@@ -110,7 +111,9 @@ private:
     status_t send_approval_broadcasts(const string& id, const string& pkg, const string& cls);
     void report_approved(const ReportId& reportId);
     void report_denied(const ReportId& reportId);
-    status_t send_report_ready_broadcasts(const string& id, const string& pkg, const string& cls);
+    bool apply_pending_approvals(const sp<ReportFile>& file, const set<ReportId>& approvals);
+    status_t send_report_ready_broadcasts(const string& pkg, const string& cls,
+            const vector<string>& ids);
     status_t send_to_dropbox(const sp<ReportFile>& file, const IncidentReportArgs& args);
     bool was_approval_sent(const string& id, const string& pkg, const string& cls);
     void set_approval_sent(const string& id, const string& pkg, const string& cls,
@@ -24,7 +24,13 @@
 #include <android-base/file.h>
 #include <android/util/protobuf.h>
 #include <android/util/ProtoFileReader.h>
+#include <android/util/ProtoSpanReader.h>
 #include <log/log.h>
+#include <limits.h>
+#include <sys/uio.h>
+
+#include <memory>
+#include <vector>
 
 namespace android {
 namespace os {
@@ -78,17 +84,88 @@ void write_field_or_skip(ProtoOutputStream* out, const sp<ProtoReader>& in,
 }
 
 /**
- * Strip next field based on its private policy and request spec, then stores data in buf.
- * Return NO_ERROR if succeeds, otherwise BAD_VALUE is returned to indicate bad data in
- * FdBuffer.
+ * An output of strip_field, with the privacy spec that it is stripped to.
+ */
+struct StripOutput {
+    StripOutput(uint8_t privacyPolicy, const sp<EncodedBuffer>& buffer)
+            :spec(privacyPolicy),
+             proto(buffer) {
+    }
+
+    PrivacySpec spec;
+    ProtoOutputStream proto;
+};
+
+/**
+ * Write the field to the outputs whose bit is set in keep, iterator will point to next field.
+ * The field is read once however many outputs it is written to.
+ */
+static void write_field_to_outputs(const vector<unique_ptr<StripOutput>>& outputs, uint32_t keep,
+        const sp<ProtoReader>& in, uint32_t fieldTag) {
+    uint8_t wireType = read_wire_type(fieldTag);
+    size_t bytesToWrite = 0;
+    uint64_t varint = 0;
+
+    switch (wireType) {
+        case WIRE_TYPE_VARINT:
+            varint = in->readRawVarint();
+            for (size_t i = 0; i < outputs.size(); i++) {
+                if ((keep & (1 << i)) != 0) {
+                    outputs[i]->proto.writeRawVarint(fieldTag);
+                    outputs[i]->proto.writeRawVarint(varint);
+                }
+            }
+            return;
+        case WIRE_TYPE_FIXED64:
+            bytesToWrite = 8;
+            break;
+        case WIRE_TYPE_LENGTH_DELIMITED:
+            bytesToWrite = in->readRawVarint();
+            break;
+        case WIRE_TYPE_FIXED32:
+            bytesToWrite = 4;
+            break;
+    }
+    if (keep == 0) {
+        in->move(bytesToWrite);
+        return;
+    }
+
+    for (size_t i = 0; i < outputs.size(); i++) {
+        if ((keep & (1 << i)) != 0) {
+            if (wireType == WIRE_TYPE_LENGTH_DELIMITED) {
+                outputs[i]->proto.writeLengthDelimitedHeader(read_field_id(fieldTag),
+                        bytesToWrite);
+            } else {
+                outputs[i]->proto.writeRawVarint(fieldTag);
+            }
+        }
+    }
+    for (size_t b = 0; b < bytesToWrite; b++) {
+        uint8_t byte = in->next();
+        for (size_t i = 0; i < outputs.size(); i++) {
+            if ((keep & (1 << i)) != 0) {
+                outputs[i]->proto.writeRawByte(byte);
+            }
+        }
+    }
+}
+
+/**
+ * Strip next field based on its private policy and the spec of each output, then stores
+ * the data in the outputs. Return NO_ERROR if succeeds, otherwise BAD_VALUE is returned
+ * to indicate bad data in FdBuffer.
+ *
+ * The privacy of the field is looked up once for all of the outputs, and each output
+ * gets a bit in the mask of the outputs that keep the field.
  *
  * The iterator must point to the head of a protobuf formatted field for successful operation.
  * After exit with NO_ERROR, iterator points to the next protobuf field's head.
  *
  * depth is the depth of recursion, for debugging.
  */
-status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
-        const Privacy* parentPolicy, const PrivacySpec& spec, int depth) {
+status_t strip_field(const vector<unique_ptr<StripOutput>>& outputs, const sp<ProtoReader>& in,
+        const Privacy* parentPolicy, int depth) {
     if (!in->hasNext() || parentPolicy == NULL) {
         return BAD_VALUE;
     }
@@ -97,18 +174,25 @@ status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
     const Privacy* policy = lookup(parentPolicy, fieldId);
 
     if (policy == NULL || policy->children == NULL) {
-        bool skip = !spec.CheckPremission(policy, parentPolicy->policy);
+        uint32_t keep = 0;
+        for (size_t i = 0; i < outputs.size(); i++) {
+            if (outputs[i]->spec.CheckPremission(policy, parentPolicy->policy)) {
+                keep |= 1 << i;
+            }
+        }
         // iterator will point to head of next field
-        size_t currentAt = in->bytesRead();
-        write_field_or_skip(out, in, fieldTag, skip);
+        write_field_to_outputs(outputs, keep, in, fieldTag);
         return NO_ERROR;
     }
     // current field is message type and its sub-fields have extra privacy policies
     uint32_t msgSize = in->readRawVarint();
     size_t start = in->bytesRead();
-    uint64_t token = out->start(encode_field_id(policy));
+    vector<uint64_t> tokens;
+    for (const unique_ptr<StripOutput>& output : outputs) {
+        tokens.push_back(output->proto.start(encode_field_id(policy)));
+    }
     while (in->bytesRead() - start != msgSize) {
-        status_t err = strip_field(out, in, policy, spec, depth + 1);
+        status_t err = strip_field(outputs, in, policy, depth + 1);
         if (err != NO_ERROR) {
             ALOGW("Bad value when stripping id %d, wiretype %d, tag %#x, depth %d, size %d, "
                     "relative pos %zu, ", fieldId, read_wire_type(fieldTag), fieldTag, depth,
@@ -116,129 +200,188 @@ status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
             return err;
         }
     }
-    out->end(token);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        outputs[i]->proto.end(tokens[i]);
+    }
     return NO_ERROR;
 }
 
 // ================================================================================
 class FieldStripper {
 public:
-    FieldStripper(const Privacy* restrictions, const sp<ProtoReader>& data,
+    FieldStripper(const Privacy* restrictions, const sp<EncodedBuffer>& data,
             uint8_t bufferLevel);
 
     ~FieldStripper();
 
     /**
-     * Take the data that we have, and filter it down so that no fields
-     * are more sensitive than the given privacy policy.
+     * Take the data that we have, and filter it down so that no fields are more
+     * sensitive than each of the given privacy policies.  The data is read once,
+     * however many of the policies it has to be stripped to.
      */
-    status_t strip(uint8_t privacyPolicy);
+    status_t strip(const vector<uint8_t>& privacyPolicies);
 
     /**
-     * At the current filter level, how many bytes of data there is.
+     * At the given filter level, how many bytes of data there is.
      */
-    ssize_t dataSize() const { return mSize; }
+    ssize_t dataSize(uint8_t privacyPolicy) const;
 
     /**
-     * Write the data from the current filter level to the file descriptor.
+     * Write the header and the data from the given filter level to the file descriptor.
      */
-    status_t writeData(int fd);
+    status_t writeData(uint8_t privacyPolicy, int fd, uint8_t const* header, size_t headerSize);
 
 private:
+    struct Level {
+        uint8_t privacyPolicy;
+
+        // Either the unfiltered data, a pooled buffer with the stripped data, or
+        // NULL if the data couldn't be stripped.
+        sp<EncodedBuffer> data;
+        ssize_t size;
+        bool stripped;
+    };
+
+    const Level* findLevel(uint8_t privacyPolicy) const;
+
     /**
      * The global set of field --> required privacy level mapping.
      */
     const Privacy* mRestrictions;
 
     /**
-     * The current buffer.
+     * The unfiltered data.
      */
-    sp<ProtoReader> mData;
+    sp<EncodedBuffer> mSource;
 
     /**
-     * The current size of the buffer inside mData.
+     * The privacy policy that the unfiltered data is already filtered to.
      */
-    ssize_t mSize;
+    uint8_t mBufferLevel;
 
-    /**
-     * The current privacy policy that the data is filtered to, as an optimization
-     * so we don't always re-filter data that has already been filtered.
-     */
-    uint8_t mCurrentLevel;
-
-    sp<EncodedBuffer> mEncodedBuffer;
+    vector<Level> mLevels;
 };
 
-FieldStripper::FieldStripper(const Privacy* restrictions, const sp<ProtoReader>& data,
+FieldStripper::FieldStripper(const Privacy* restrictions, const sp<EncodedBuffer>& data,
             uint8_t bufferLevel)
         :mRestrictions(restrictions),
-         mData(data),
-         mSize(data->size()),
-         mCurrentLevel(bufferLevel),
-         mEncodedBuffer(get_buffer_from_pool()) {
-    if (mSize < 0) {
-        ALOGW("FieldStripper constructed with a ProtoReader that doesn't support size."
-                " Data will be missing.");
-    }
+         mSource(data),
+         mBufferLevel(bufferLevel),
+         mLevels() {
 }
 
 FieldStripper::~FieldStripper() {
-    return_buffer_to_pool(mEncodedBuffer);
+    for (const Level& level : mLevels) {
+        if (level.stripped && level.data != nullptr) {
+            return_buffer_to_pool(level.data);
+        }
+    }
 }
 
-status_t FieldStripper::strip(const uint8_t privacyPolicy) {
-    // If the current strip level is less (fewer fields retained) than what's already in the
-    // buffer, then we can skip it.
-    if (mCurrentLevel < privacyPolicy) {
+status_t FieldStripper::strip(const vector<uint8_t>& privacyPolicies) {
+    vector<unique_ptr<StripOutput>> outputs;
+    for (uint8_t privacyPolicy : privacyPolicies) {
         PrivacySpec spec(privacyPolicy);
-        mEncodedBuffer->clear();
-        ProtoOutputStream proto(mEncodedBuffer);
-
-        // Optimization when no strip happens.
-        if (mRestrictions == NULL || spec.RequireAll()) {
-            if (spec.CheckPremission(mRestrictions)) {
-                mSize = mData->size();
-            }
-            return NO_ERROR;
+        Level level{privacyPolicy, mSource, (ssize_t)mSource->size(), false};
+
+        // If the strip level is less (fewer fields retained) than what's already in the
+        // buffer, or if nothing would be stripped, then the unfiltered data is used.
+        if (mBufferLevel < privacyPolicy && mRestrictions != NULL && !spec.RequireAll()) {
+            level.data = get_buffer_from_pool();
+            level.stripped = true;
+            outputs.push_back(make_unique<StripOutput>(privacyPolicy, level.data));
         }
+        mLevels.push_back(level);
+    }
+    if (outputs.empty()) {
+        return NO_ERROR;
+    }
 
-        while (mData->hasNext()) {
-            status_t err = strip_field(&proto, mData, mRestrictions, spec, 0);
-            if (err != NO_ERROR) {
-                return err; // Error logged in strip_field.
-            }
-        }
+    sp<ProtoReader> reader = mSource->read();
+    status_t err = NO_ERROR;
+    while (err == NO_ERROR && reader->hasNext()) {
+        err = strip_field(outputs, reader, mRestrictions, 0); // Error logged in strip_field.
+    }
+    if (err == NO_ERROR && reader->bytesRead() != (size_t)reader->size()) {
+        ALOGW("Buffer corrupted: expect %zu bytes, read %zu bytes", reader->size(),
+                reader->bytesRead());
+        err = BAD_VALUE;
+    }
 
-        if (mData->bytesRead() != mData->size()) {
-            ALOGW("Buffer corrupted: expect %zu bytes, read %zu bytes", mData->size(),
-                    mData->bytesRead());
-            return BAD_VALUE;
+    size_t output = 0;
+    for (Level& level : mLevels) {
+        if (!level.stripped) {
+            continue;
         }
+        if (err != NO_ERROR) {
+            return_buffer_to_pool(level.data);
+            level.data = nullptr;
+            level.size = 0;
+        } else {
+            // Sizing the stream compacts it, so the buffer then holds the encoded data.
+            level.size = outputs[output]->proto.size();
+        }
+        output++;
+    }
+    return err;
+}
 
-        mData = proto.data();
-        mSize = proto.size();
-        mCurrentLevel = privacyPolicy;
+const FieldStripper::Level* FieldStripper::findLevel(uint8_t privacyPolicy) const {
+    for (const Level& level : mLevels) {
+        if (level.privacyPolicy == privacyPolicy) {
+            return &level;
+        }
     }
-    return NO_ERROR;
+    return nullptr;
 }
 
-status_t FieldStripper::writeData(int fd) {
-    status_t err = NO_ERROR;
-    sp<ProtoReader> reader = mData;
-    if (mData == nullptr) {
+ssize_t FieldStripper::dataSize(uint8_t privacyPolicy) const {
+    const Level* level = findLevel(privacyPolicy);
+    return level != nullptr ? level->size : 0;
+}
+
+status_t FieldStripper::writeData(uint8_t privacyPolicy, int fd, uint8_t const* header,
+        size_t headerSize) {
+    const Level* level = findLevel(privacyPolicy);
+    if (level == nullptr || level->data == nullptr) {
         // There had been an error processing the data. We won't write anything,
         // but we also won't return an error, because errors are fatal.
         return NO_ERROR;
     }
-    while (reader->readBuffer() != NULL) {
-        err = WriteFully(fd, reader->readBuffer(), reader->currentToRead()) ? NO_ERROR : -errno;
-        reader->move(reader->currentToRead());
-        if (err != NO_ERROR) return err;
+
+    // Hand the chunks of the buffer to the kernel as they are, together with the
+    // header, rather than with a write for each of them.
+    sp<ProtoReader> reader = level->data->read();
+    struct iovec iov[IOV_MAX];
+    int iovcnt = 0;
+    iov[iovcnt++] = {const_cast<uint8_t*>(header), headerSize};
+    while (iovcnt > 0 || reader->hasNext()) {
+        while (iovcnt < IOV_MAX && reader->hasNext()) {
+            size_t amt = reader->currentToRead();
+            iov[iovcnt++] = {const_cast<uint8_t*>(reader->readBuffer()), amt};
+            reader->move(amt);
+        }
+
+        ssize_t amt = TEMP_FAILURE_RETRY(writev(fd, iov, iovcnt));
+        if (amt < 0) {
+            return -errno;
+        }
+
+        // Drop what was written, and keep the rest of a partially written chunk.
+        int written = 0;
+        while (written < iovcnt && (size_t)amt >= iov[written].iov_len) {
+            amt -= iov[written++].iov_len;
+        }
+        if (written < iovcnt) {
+            iov[written].iov_base = (uint8_t*)iov[written].iov_base + amt;
+            iov[written].iov_len -= amt;
+        }
+        iovcnt -= written;
+        memmove(iov, iov + written, iovcnt * sizeof(struct iovec));
     }
     return NO_ERROR;
 }
 
-
 // ================================================================================
 FilterFd::FilterFd(uint8_t privacyPolicy, int fd)
         :mPrivacyPolicy(privacyPolicy),
@@ -277,30 +420,29 @@ status_t PrivacyFilter::writeData(const FdBuffer& buffer, uint8_t bufferLevel,
             return a->getPrivacyPolicy() < b->getPrivacyPolicy();
         });
 
-    uint8_t privacyPolicy = PRIVACY_POLICY_LOCAL; // a.k.a. no filtering
-    FieldStripper fieldStripper(mRestrictions, buffer.data()->read(), bufferLevel);
+    // Strip the data to all of the privacy policies of the outputs in one pass.
+    vector<uint8_t> privacyPolicies;
     for (const sp<FilterFd>& output: mOutputs) {
-        // Do another level of filtering if necessary
-        if (privacyPolicy != output->getPrivacyPolicy()) {
-            privacyPolicy = output->getPrivacyPolicy();
-            err = fieldStripper.strip(privacyPolicy);
-            if (err != NO_ERROR) {
-                // We can't successfully strip this data.  We will skip
-                // the rest of this section.
-                return NO_ERROR;
-            }
+        if (privacyPolicies.empty() || privacyPolicies.back() != output->getPrivacyPolicy()) {
+            privacyPolicies.push_back(output->getPrivacyPolicy());
         }
+    }
+    FieldStripper fieldStripper(mRestrictions, buffer.data(), bufferLevel);
+    err = fieldStripper.strip(privacyPolicies);
+    if (err != NO_ERROR) {
+        // We can't successfully strip this data.  The outputs that needed it
+        // stripped will skip this section.
+        ALOGW("Failed to strip section %d: %s", mSectionId, strerror(-err));
+    }
 
+    for (const sp<FilterFd>& output: mOutputs) {
         // Write the resultant buffer to the fd, along with the header.
-        ssize_t dataSize = fieldStripper.dataSize();
+        ssize_t dataSize = fieldStripper.dataSize(output->getPrivacyPolicy());
         if (dataSize > 0) {
-            err = write_section_header(output->getFd(), mSectionId, dataSize);
-            if (err != NO_ERROR) {
-                output->onWriteError(err);
-                continue;
-            }
-
-            err = fieldStripper.writeData(output->getFd());
+            uint8_t header[20];
+            uint8_t* headerEnd = write_length_delimited_tag_header(header, mSectionId, dataSize);
+            err = fieldStripper.writeData(output->getPrivacyPolicy(), output->getFd(), header,
+                    headerEnd - header);
             if (err != NO_ERROR) {
                 output->onWriteError(err);
                 continue;
@@ -339,11 +481,9 @@ void ReadbackFilterFd::onWriteError(status_t err) {
 }
 
 // ================================================================================
-status_t filter_and_write_report(int to, int from, uint8_t bufferLevel,
-        const IncidentReportArgs& args) {
+static status_t filter_and_write_sections(int to, const sp<ProtoReader>& reader,
+        uint8_t bufferLevel, const IncidentReportArgs& args) {
     status_t err;
-    sp<ProtoFileReader> reader = new ProtoFileReader(from);
-
     while (reader->hasNext()) {
         uint64_t fieldTag = reader->readRawVarint();
         uint32_t fieldId = read_field_id(fieldTag);
@@ -376,10 +516,30 @@ status_t filter_and_write_report(int to, int from, uint8_t bufferLevel,
             write_field_or_skip(NULL, reader, fieldTag, true);
         }
     }
+    return NO_ERROR;
+}
+
+status_t filter_and_write_report(int to, int from, uint8_t bufferLevel,
+        const IncidentReportArgs& args) {
+    status_t err;
+
+    // Read the report in place when it can be mapped, and through a buffer otherwise.
+    sp<ProtoSpanReader> mappedReader = ProtoSpanReader::mapFile(from);
+    if (mappedReader != nullptr) {
+        err = filter_and_write_sections(to, mappedReader, bufferLevel, args);
+        if (err == NO_ERROR) {
+            err = mappedReader->getError();
+        }
+    } else {
+        sp<ProtoFileReader> fileReader = new ProtoFileReader(from);
+        err = filter_and_write_sections(to, fileReader, bufferLevel, args);
+        if (err == NO_ERROR) {
+            err = fileReader->getError();
+        }
+    }
     clear_buffer_pool();
-    err = reader->getError();
     if (err != NO_ERROR) {
-        ALOGW("filter_and_write_report reader had an error: %s", strerror(-err));
+        ALOGW("filter_and_write_report had an error: %s", strerror(-err));
         return err;
     }
 
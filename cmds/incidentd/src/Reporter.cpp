@@ -32,13 +32,17 @@
 #include <private/android_filesystem_config.h>
 #include <utils/SystemClock.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/prctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <time.h>
 #include <wait.h>
 
@@ -53,6 +57,10 @@ using namespace android::util;
  *      frameworks/base/core/proto/android/os/incident.proto
  */
 const int FIELD_ID_METADATA = 2;
+
+// The number of sections that are executed at the same time.
+const size_t MAX_PARALLEL_SECTIONS = 4;
+
 // Args for exec gzip
 static const char* GZIP[] = {"/system/bin/gzip", NULL};
 
@@ -385,10 +393,16 @@ void ReportBatch::removeRequest(const sp<ReportRequest>& request) {
 ReportWriter::ReportWriter(const sp<ReportBatch>& batch)
         :mBatch(batch),
          mPersistedFile(),
-         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET) {
+         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET),
+         mMaxSectionDataFilteredSize(0),
+         mDeferWrites(false),
+         mDeferredData() {
 }
 
 ReportWriter::~ReportWriter() {
+    if (mDeferredData != nullptr) {
+        return_buffer_to_pool(mDeferredData);
+    }
 }
 
 void ReportWriter::setPersistedFile(sp<ReportFile> file) {
@@ -399,6 +413,10 @@ void ReportWriter::setMaxPersistedPrivacyPolicy(uint8_t privacyPolicy) {
     mMaxPersistedPrivacyPolicy = privacyPolicy;
 }
 
+void ReportWriter::setDeferWrites(bool deferWrites) {
+    mDeferWrites = deferWrites;
+}
+
 void ReportWriter::startSection(int sectionId) {
     mCurrentSectionId = sectionId;
     mSectionStartTimeMs = uptimeMillis();
@@ -493,6 +511,18 @@ void ReportWriter::vflog(const Section* section, status_t err, int level, const
 
 // Reads data from FdBuffer and writes it to the requests file descriptor.
 status_t ReportWriter::writeSection(const FdBuffer& buffer) {
+    cache_section_data(mCurrentSectionId, buffer);
+
+    if (mDeferWrites) {
+        // The buffer goes back to the pool when the section returns, so keep a copy.
+        if (mDeferredData == nullptr) {
+            mDeferredData = get_buffer_from_pool();
+        }
+        mDeferredData->clear();
+        mMaxSectionDataFilteredSize = 0;
+        return mDeferredData->writeRaw(buffer.data()->read());
+    }
+
     PrivacyFilter filter(mCurrentSectionId, get_privacy_of_section(mCurrentSectionId));
 
     // Add the fd for the persisted requests
@@ -514,6 +544,23 @@ status_t ReportWriter::writeSection(const FdBuffer& buffer) {
     return filter.writeData(buffer, PRIVACY_POLICY_LOCAL, &mMaxSectionDataFilteredSize);
 }
 
+status_t ReportWriter::writeDeferredSection(ReportWriter* deferred, size_t* reportSizeBytes) {
+    *reportSizeBytes = 0;
+    if (deferred->mDeferredData == nullptr) {
+        // The section didn't write anything, e.g. because it timed out.
+        return NO_ERROR;
+    }
+
+    // The buffer is handed back to the pool when it goes out of scope.
+    FdBuffer buffer(deferred->mDeferredData, /* isBufferPooled= */ true);
+    deferred->mDeferredData = nullptr;
+
+    mCurrentSectionId = deferred->mCurrentSectionId;
+    status_t err = writeSection(buffer);
+    *reportSizeBytes = mMaxSectionDataFilteredSize;
+    return err;
+}
+
 
 // ================================================================================
 Reporter::Reporter(const sp<WorkDirectory>& workDirectory,
@@ -635,10 +682,8 @@ void Reporter::runReport(size_t* reportByteSize) {
 
     // For each of the report fields, see if we need it, and if so, execute the command
     // and report to those that care that we're doing it.
-    for (const Section** section = SECTION_LIST; *section; section++) {
-        if (execute_section(*section, &metadata, reportByteSize) != NO_ERROR) {
-            goto DONE;
-        }
+    if (execute_sections_in_parallel(SECTION_LIST, &metadata, reportByteSize) != NO_ERROR) {
+        goto DONE;
     }
 
     for (const Section* section : mRegisteredSections) {
@@ -702,6 +747,22 @@ DONE:
     ALOGI("Done taking incident report err=%s", strerror(-err));
 }
 
+/**
+ * Executes the section, or writes the data it wrote for a previous report if that data is
+ * still in the cache.
+ */
+static status_t execute_or_write_cached(const Section* section, ReportWriter* writer) {
+    sp<EncodedBuffer> cached = get_cached_section_data(section->id);
+    if (cached == nullptr) {
+        return section->Execute(writer);
+    }
+
+    ALOGD("Section %d '%s' is cached", section->id, section->name.string());
+    FdBuffer buffer(cached, /* isBufferPooled= */ false);
+    writer->setSectionStats(buffer);
+    return writer->writeSection(buffer);
+}
+
 status_t Reporter::execute_section(const Section* section, IncidentMetadata* metadata,
         size_t* reportByteSize) {
     const int sectionId = section->id;
@@ -722,9 +783,119 @@ status_t Reporter::execute_section(const Section* section, IncidentMetadata* met
 
     // Go get the data and write it into the file descriptors.
     mWriter.startSection(sectionId);
-    status_t err = section->Execute(&mWriter);
+    status_t err = execute_or_write_cached(section, &mWriter);
     mWriter.endSection(sectionMetadata);
 
+    return finish_section(section, err, sectionMetadata, reportByteSize);
+}
+
+/**
+ * A section executed on a worker thread, with the writer that keeps its data until
+ * it is written to the report.
+ */
+struct ParallelSection {
+    ParallelSection(const Section* section, const sp<ReportBatch>& batch)
+            :section(section),
+             writer(batch),
+             stats(),
+             err(NO_ERROR),
+             done(false) {
+        writer.setDeferWrites(true);
+    }
+
+    const Section* section;
+    ReportWriter writer;
+    IncidentMetadata::SectionStats stats;
+    status_t err;
+    bool done;
+};
+
+status_t Reporter::execute_sections_in_parallel(const Section** sections,
+        IncidentMetadata* metadata, size_t* reportByteSize) {
+    // Most sections spend their time waiting for another process or for the disk, so
+    // a few of them are executed at a time.  Each still has its own timeout.
+    vector<unique_ptr<ParallelSection>> parallel;
+    for (const Section** section = sections; *section; section++) {
+        if (mBatch->containsSection((*section)->id)) {
+            parallel.push_back(make_unique<ParallelSection>(*section, mBatch));
+        }
+    }
+
+    // The workers only touch their own ParallelSection.  The batch, the listeners and
+    // the file descriptors are only used from this thread, in the order of the sections.
+    std::mutex lock;
+    std::condition_variable doneCondition;
+    std::atomic<size_t> next(0);
+    std::atomic<bool> stopped(false);
+    auto work = [&]() {
+        for (size_t i = next++; i < parallel.size() && !stopped; i = next++) {
+            ParallelSection* p = parallel[i].get();
+            p->writer.startSection(p->section->id);
+            status_t err = execute_or_write_cached(p->section, &p->writer);
+            p->writer.endSection(&p->stats);
+            {
+                std::scoped_lock<std::mutex> l(lock);
+                p->err = err;
+                p->done = true;
+            }
+            doneCondition.notify_all();
+        }
+    };
+    vector<std::thread> workers;
+    for (size_t i = 0; i < MAX_PARALLEL_SECTIONS && i < parallel.size(); i++) {
+        workers.emplace_back(work);
+    }
+
+    status_t err = NO_ERROR;
+    for (const unique_ptr<ParallelSection>& p : parallel) {
+        const Section* section = p->section;
+        const int sectionId = section->id;
+
+        // The requests that wanted this section may have failed in the meantime.
+        if (!mBatch->containsSection(sectionId)) {
+            continue;
+        }
+
+        ALOGD("Start incident report section %d '%s'", sectionId, section->name.string());
+        IncidentMetadata::SectionStats* sectionMetadata = metadata->add_sections();
+
+        // Notify listener of starting
+        mBatch->forEachListener(sectionId, [sectionId](const auto& listener) {
+            listener->onReportSectionStatus(
+                    sectionId, IIncidentReportStatusListener::STATUS_STARTING);
+        });
+
+        {
+            std::unique_lock<std::mutex> l(lock);
+            doneCondition.wait(l, [&p]() { return p->done; });
+        }
+
+        size_t reportSizeBytes = 0;
+        err = p->err;
+        if (err == NO_ERROR) {
+            err = mWriter.writeDeferredSection(&p->writer, &reportSizeBytes);
+        }
+        *sectionMetadata = p->stats;
+        sectionMetadata->set_report_size_bytes(reportSizeBytes);
+
+        err = finish_section(section, err, sectionMetadata, reportByteSize);
+        if (err != NO_ERROR) {
+            break;
+        }
+    }
+
+    // Sections that are already executing run until they are done or time out.
+    stopped = true;
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return err;
+}
+
+status_t Reporter::finish_section(const Section* section, status_t err,
+        IncidentMetadata::SectionStats* sectionMetadata, size_t* reportByteSize) {
+    const int sectionId = section->id;
+
     // Sections returning errors are fatal. Most errors should not be fatal.
     if (err != NO_ERROR) {
         mWriter.error(section, err, "Section failed. Stopping report.");
@@ -207,6 +207,20 @@ public:
 
     status_t writeSection(const FdBuffer& buffer);
 
+    /**
+     * Keep the data of the sections instead of writing it to the file descriptors,
+     * so that a section can be executed on another thread than the one writing the
+     * report.  The data is written later with writeDeferredSection.
+     */
+    void setDeferWrites(bool deferWrites);
+
+    /**
+     * Write the data kept by a deferring writer for its last section, as if the
+     * section had written it to this writer.  The size of the largest filtered copy
+     * is returned in reportSizeBytes.
+     */
+    status_t writeDeferredSection(ReportWriter* deferred, size_t* reportSizeBytes);
+
 private:
     // Data about all requests
     sp<ReportBatch> mBatch;
@@ -251,6 +265,12 @@ private:
     string mSectionErrors;
     size_t mMaxSectionDataFilteredSize;
 
+    /**
+     * Whether writeSection keeps the data in mDeferredData instead of writing it.
+     */
+    bool mDeferWrites;
+    sp<EncodedBuffer> mDeferredData;
+
     void vflog(const Section* section, status_t err, int level, const char* levelText,
         const char* format, va_list args);
 };
@@ -277,6 +297,12 @@ private:
     status_t execute_section(const Section* section, IncidentMetadata* metadata,
         size_t* reportByteSize);
 
+    status_t execute_sections_in_parallel(const Section** sections, IncidentMetadata* metadata,
+        size_t* reportByteSize);
+
+    status_t finish_section(const Section* section, status_t err,
+        IncidentMetadata::SectionStats* sectionMetadata, size_t* reportByteSize);
+
     void cancel_and_remove_failed_requests();
 };
 
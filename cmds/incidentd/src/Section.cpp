@@ -36,6 +36,7 @@
 #include <log/logprint.h>
 #include <private/android_logger.h>
 #include <sys/mman.h>
+#include <utils/SystemClock.h>
 
 #include "FdBuffer.h"
 #include "Privacy.h"
@@ -75,6 +76,67 @@ bool section_requires_specific_mention(int sectionId) {
     }
 }
 
+int64_t section_cache_ttl_ms(int sectionId) {
+    switch (sectionId) {
+        case 1000: // system_properties
+            return 60 * 1000; // 1 minute
+        case 1002: // kernel_version
+        case 1100: // event_log_tag_map
+            return 24 * 60 * 60 * 1000; // 1 day, they only change with the build
+        case 2006: // battery_type
+            return 60 * 60 * 1000; // 1 hour
+        default:
+            return 0;
+    }
+}
+
+struct CachedSectionData {
+    int64_t timeMs;
+    sp<EncodedBuffer> data;
+};
+
+static std::mutex gSectionCacheLock;
+static std::map<int, CachedSectionData> gSectionCache;
+
+static bool is_cached_section_data_fresh(int sectionId, int64_t nowMs) {
+    auto it = gSectionCache.find(sectionId);
+    return it != gSectionCache.end()
+            && nowMs - it->second.timeMs < section_cache_ttl_ms(sectionId);
+}
+
+sp<EncodedBuffer> get_cached_section_data(int sectionId) {
+    if (section_cache_ttl_ms(sectionId) <= 0) {
+        return nullptr;
+    }
+    std::scoped_lock<std::mutex> lock(gSectionCacheLock);
+    if (!is_cached_section_data_fresh(sectionId, elapsedRealtime())) {
+        gSectionCache.erase(sectionId);
+        return nullptr;
+    }
+    return gSectionCache[sectionId].data;
+}
+
+void cache_section_data(int sectionId, const FdBuffer& buffer) {
+    if (section_cache_ttl_ms(sectionId) <= 0 || buffer.timedOut() || buffer.truncated()) {
+        return;
+    }
+    const int64_t nowMs = elapsedRealtime();
+    {
+        std::scoped_lock<std::mutex> lock(gSectionCacheLock);
+        if (is_cached_section_data_fresh(sectionId, nowMs)) {
+            return;
+        }
+    }
+
+    // Not from the pool: the pool is cleared after each report, and this outlives it.
+    sp<EncodedBuffer> data = new EncodedBuffer();
+    if (data->writeRaw(buffer.data()->read()) != NO_ERROR) {
+        return;
+    }
+    std::scoped_lock<std::mutex> lock(gSectionCacheLock);
+    gSectionCache[sectionId] = CachedSectionData{nowMs, data};
+}
+
 // ================================================================================
 Section::Section(int i, int64_t timeoutMs)
     : id(i),
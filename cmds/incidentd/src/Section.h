@@ -217,6 +217,24 @@ private:
  */
 bool section_requires_specific_mention(int sectionId);
 
+/**
+ * How long the data of a section can be reused by the following reports instead of executing
+ * the section again, or 0 if it can't be.  These sections hardly change between reports.
+ */
+int64_t section_cache_ttl_ms(int sectionId);
+
+/**
+ * Returns the data that the section wrote less than its cache ttl ago, or NULL.  The data is
+ * not filtered, so it can be served to requests of any privacy policy.
+ */
+sp<EncodedBuffer> get_cached_section_data(int sectionId);
+
+/**
+ * Keeps a copy of the complete data of a section that can be cached.  Does nothing if the data
+ * cached for the section hasn't expired yet.
+ */
+void cache_section_data(int sectionId, const FdBuffer& buffer);
+
 }  // namespace incidentd
 }  // namespace os
 }  // namespace android
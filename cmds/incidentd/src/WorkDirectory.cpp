@@ -91,23 +91,42 @@ static status_t read_proto(MessageLite* msg, const string& filename) {
 }
 
 /**
- * Write a protobuf to disk.
+ * Write a protobuf to disk.  The proto is written next to the file and renamed over it,
+ * so that readers never see a partially written file.
  */
 static status_t write_proto(const MessageLite& msg, const string& filename) {
-    int fd = open(filename.c_str(), O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0660);
+    // The leading dot keeps the temporary file out of the directory listings.
+    const size_t slash = filename.rfind('/');
+    const size_t nameStart = slash == string::npos ? 0 : slash + 1;
+    const string tempFilename = filename.substr(0, nameStart) + "."
+            + filename.substr(nameStart) + ".tmp";
+
+    int fd = open(tempFilename.c_str(), O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0660);
     if (fd < 0) {
         return -errno;
     }
 
     FileOutputStream stream(fd);
-    stream.SetCloseOnDelete(fd);
+    stream.SetCloseOnDelete(true);
 
     if (!msg.SerializeToZeroCopyStream(&stream)) {
-        ALOGW("write_proto: error writing to %s", filename.c_str());
+        ALOGW("write_proto: error writing to %s", tempFilename.c_str());
+        unlink(tempFilename.c_str());
         return BAD_VALUE;
     }
+    if (!stream.Close()) {
+        status_t err = -stream.GetErrno();
+        unlink(tempFilename.c_str());
+        return err;
+    }
 
-    return stream.GetErrno();
+    if (rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        status_t err = -errno;
+        ALOGW("write_proto: error renaming %s to %s", tempFilename.c_str(), filename.c_str());
+        unlink(tempFilename.c_str());
+        return err;
+    }
+    return NO_ERROR;
 }
 
 static string strip_extension(const string& filename) {
@@ -218,27 +237,22 @@ void log_envelope(const ReportFileProto& envelope) {
 }
 
 // ================================================================================
-struct WorkDirectoryEntry {
-    WorkDirectoryEntry();
-    explicit WorkDirectoryEntry(const WorkDirectoryEntry& that);
-    ~WorkDirectoryEntry();
-
-    string envelope;
-    string data;
-    int64_t timestampNs;
-    off_t size;
-};
-
 WorkDirectoryEntry::WorkDirectoryEntry()
         :envelope(),
          data(),
-         size(0) {
+         timestampNs(0),
+         size(0),
+         pkgsKnown(false),
+         pkgs() {
 }
 
 WorkDirectoryEntry::WorkDirectoryEntry(const WorkDirectoryEntry& that)
         :envelope(that.envelope),
          data(that.data),
-         size(that.size) {
+         timestampNs(that.timestampNs),
+         size(that.size),
+         pkgsKnown(that.pkgsKnown),
+         pkgs(that.pkgs) {
 }
 
 WorkDirectoryEntry::~WorkDirectoryEntry() {
@@ -369,7 +383,7 @@ status_t ReportFile::tryLoadEnvelope() {
     return load_envelope_impl(false);
 }
 
-const ReportFileProto& ReportFile::getEnvelope() {
+const ReportFileProto& ReportFile::getEnvelope() const {
     return mEnvelope;
 }
 
@@ -509,6 +523,7 @@ status_t ReportFile::save_envelope_impl(bool cleanup) {
         }
         return err;
     }
+    mWorkDirectory->updateIndex(*this);
     return NO_ERROR;
 }
 
@@ -522,6 +537,7 @@ status_t ReportFile::load_envelope_impl(bool cleanup) {
         }
         return err;
     }
+    mWorkDirectory->updateIndex(*this);
     return NO_ERROR;
 }
 
@@ -533,15 +549,17 @@ status_t ReportFile::load_envelope_impl(bool cleanup) {
 WorkDirectory::WorkDirectory()
         :mDirectory("/data/misc/incidents"),
          mMaxFileCount(100),
-         mMaxDiskUsageBytes(400 * 1024 * 1024) {  // Incident reports can take up to 400MB on disk.
+         mMaxDiskUsageBytes(400 * 1024 * 1024),  // Incident reports can take up to 400MB on disk.
                                                  // TODO: Should be a flag.
+         mIndexLoaded(false) {
     create_directory(mDirectory.c_str());
 }
 
 WorkDirectory::WorkDirectory(const string& dir, int maxFileCount, long maxDiskUsageBytes)
         :mDirectory(dir),
          mMaxFileCount(maxFileCount),
-         mMaxDiskUsageBytes(maxDiskUsageBytes) {
+         mMaxDiskUsageBytes(maxDiskUsageBytes),
+         mIndexLoaded(false) {
     create_directory(mDirectory.c_str());
 }
 
@@ -575,9 +593,9 @@ status_t WorkDirectory::getReports(vector<sp<ReportFile>>* result, int64_t after
         ALOGD("WorkDirectory::getReports");
     }
 
-    map<string,WorkDirectoryEntry> files;
+    map<int64_t,WorkDirectoryEntry> files;
     get_directory_contents_locked(&files, after);
-    for (map<string,WorkDirectoryEntry>::iterator it = files.begin();
+    for (map<int64_t,WorkDirectoryEntry>::iterator it = files.begin();
             it != files.end(); it++) {
         sp<ReportFile> reportFile = new ReportFile(this, it->second.timestampNs,
                 it->second.envelope, it->second.data);
@@ -629,7 +647,7 @@ sp<ReportFile> WorkDirectory::getReport(const string& pkg, const string& cls, co
 bool WorkDirectory::hasMore(int64_t after) {
     unique_lock<mutex> lock(mLock);
 
-    map<string,WorkDirectoryEntry> files;
+    map<int64_t,WorkDirectoryEntry> files;
     get_directory_contents_locked(&files, after);
     return files.size() > 0;
 }
@@ -654,11 +672,16 @@ void WorkDirectory::commitAll(const string& pkg) {
 
     unique_lock<mutex> lock(mLock);
 
-    map<string,WorkDirectoryEntry> files;
+    map<int64_t,WorkDirectoryEntry> files;
     get_directory_contents_locked(&files, 0);
 
-    for (map<string,WorkDirectoryEntry>::iterator it = files.begin();
+    for (map<int64_t,WorkDirectoryEntry>::iterator it = files.begin();
             it != files.end(); it++) {
+        // Skip the envelopes that are known to have no reports for pkg.
+        if (it->second.pkgsKnown && it->second.pkgs.count(pkg) == 0) {
+            continue;
+        }
+
         sp<ReportFile> reportFile = new ReportFile(this, it->second.timestampNs,
                 it->second.envelope, it->second.data);
 
@@ -679,9 +702,35 @@ void WorkDirectory::remove(const sp<ReportFile>& report) {
     if (DO_UNLINK) {
         unlink(report->getDataFileName().c_str());
         unlink(report->getEnvelopeFileName().c_str());
+        remove_from_index(report->getTimestampNs());
     }
 }
 
+void WorkDirectory::updateIndex(const ReportFile& report) {
+    unique_lock<mutex> lock(mIndexLock);
+    if (!mIndexLoaded) {
+        // The report will be found when the directory is first listed.
+        return;
+    }
+
+    const ReportFileProto& envelope = report.getEnvelope();
+    WorkDirectoryEntry& entry = mIndex[report.getTimestampNs()];
+    entry.envelope = report.getEnvelopeFileName();
+    entry.data = report.getDataFileName();
+    entry.timestampNs = report.getTimestampNs();
+    entry.size = envelope.ByteSize() + envelope.data_file_size();
+    entry.pkgsKnown = true;
+    entry.pkgs.clear();
+    for (const ReportFileProto_Report& r : envelope.report()) {
+        entry.pkgs.insert(r.pkg());
+    }
+}
+
+void WorkDirectory::remove_from_index(int64_t timestampNs) {
+    unique_lock<mutex> lock(mIndexLock);
+    mIndex.erase(timestampNs);
+}
+
 int64_t WorkDirectory::make_timestamp_ns_locked() {
     // Guarantee that we don't have duplicate timestamps.
     // This is a little bit lame, but since reports are created on the
@@ -721,8 +770,29 @@ string WorkDirectory::make_filename(int64_t timestampNs, const string& extension
     return result.str();
 }
 
-off_t WorkDirectory::get_directory_contents_locked(map<string,WorkDirectoryEntry>* files,
+off_t WorkDirectory::get_directory_contents_locked(map<int64_t,WorkDirectoryEntry>* files,
         int64_t after) {
+    if (!mIndexLoaded) {
+        map<int64_t,WorkDirectoryEntry> scanned;
+        if (scan_directory_locked(&scanned) < 0) {
+            return -1;
+        }
+        unique_lock<mutex> lock(mIndexLock);
+        mIndex.swap(scanned);
+        mIndexLoaded = true;
+    }
+
+    unique_lock<mutex> lock(mIndexLock);
+    off_t totalSize = 0;
+    for (map<int64_t,WorkDirectoryEntry>::const_iterator it = mIndex.upper_bound(after);
+            it != mIndex.end(); it++) {
+        files->emplace(it->first, it->second);
+        totalSize += it->second.size;
+    }
+    return totalSize;
+}
+
+off_t WorkDirectory::scan_directory_locked(map<int64_t,WorkDirectoryEntry>* files) {
     DIR* dir;
     struct dirent* entry;
 
@@ -757,26 +827,24 @@ off_t WorkDirectory::get_directory_contents_locked(map<string,WorkDirectoryEntry
                 continue;
             }
 
-            if (after == 0 || timestampNs > after) {
-                struct stat st;
-                if (stat(filename.c_str(), &st) != 0) {
-                    ALOGE("Unable to stat file %s", filename.c_str());
-                    continue;
-                }
-                if (!S_ISREG(st.st_mode)) {
-                    continue;
-                }
+            struct stat st;
+            if (stat(filename.c_str(), &st) != 0) {
+                ALOGE("Unable to stat file %s", filename.c_str());
+                continue;
+            }
+            if (!S_ISREG(st.st_mode)) {
+                continue;
+            }
 
-                WorkDirectoryEntry& entry = (*files)[timestamp];
-                if (isEnvelope) {
-                    entry.envelope = filename;
-                } else if (isData) {
-                    entry.data = filename;
-                }
-                entry.timestampNs = timestampNs;
-                entry.size += st.st_size;
-                totalSize += st.st_size;
+            WorkDirectoryEntry& entry = (*files)[timestampNs];
+            if (isEnvelope) {
+                entry.envelope = filename;
+            } else if (isData) {
+                entry.data = filename;
             }
+            entry.timestampNs = timestampNs;
+            entry.size += st.st_size;
+            totalSize += st.st_size;
         }
     }
 
@@ -787,7 +855,7 @@ off_t WorkDirectory::get_directory_contents_locked(map<string,WorkDirectoryEntry
     // a cleaning.
 
     if (DO_UNLINK) {
-        map<string,WorkDirectoryEntry>::iterator it = files->begin();
+        map<int64_t,WorkDirectoryEntry>::iterator it = files->begin();
         while (it != files->end()) {
             if (it->second.envelope.length() == 0) {
                 unlink(it->second.data.c_str());
@@ -806,9 +874,8 @@ void WorkDirectory::clean_directory_locked() {
     struct dirent* entry;
     struct stat st;
 
-    // Map of filename without extension to the entries about it.  Conveniently,
-    // this also keeps the list sorted by filename, which is a timestamp.
-    map<string,WorkDirectoryEntry> files;
+    // Map of timestamp to the entries about it, sorted from the oldest.
+    map<int64_t,WorkDirectoryEntry> files;
     off_t totalSize = get_directory_contents_locked(&files, 0);
     if (totalSize < 0) {
         return;
@@ -822,12 +889,13 @@ void WorkDirectory::clean_directory_locked() {
 
     // Remove files until we're under our limits.
     if (DO_UNLINK) {
-        for (map<string, WorkDirectoryEntry>::const_iterator it = files.begin();
+        for (map<int64_t, WorkDirectoryEntry>::const_iterator it = files.begin();
                 it != files.end() && (totalSize >= mMaxDiskUsageBytes
                     || totalCount >= mMaxFileCount);
                 it++) {
             unlink(it->second.envelope.c_str());
             unlink(it->second.data.c_str());
+            remove_from_index(it->first);
             totalSize -= it->second.size;
             totalCount--;
         }
@@ -840,6 +908,7 @@ void WorkDirectory::delete_files_for_report_if_necessary(const sp<ReportFile>& r
         if (DO_UNLINK) {
             unlink(report->getDataFileName().c_str());
             unlink(report->getEnvelopeFileName().c_str());
+            remove_from_index(report->getTimestampNs());
         }
     }
 }
@@ -23,9 +23,13 @@
 
 #include <utils/RefBase.h>
 
+#include <map>
 #include <mutex>
+#include <set>
 #include <string>
 
+#include <sys/types.h>
+
 namespace android {
 namespace os {
 namespace incidentd {
@@ -37,7 +41,24 @@ using namespace std;
 extern const ComponentName DROPBOX_SENTINEL;
 
 class WorkDirectory;
-struct WorkDirectoryEntry;
+
+/**
+ * The files of a report in the WorkDirectory.
+ */
+struct WorkDirectoryEntry {
+    WorkDirectoryEntry();
+    explicit WorkDirectoryEntry(const WorkDirectoryEntry& that);
+    ~WorkDirectoryEntry();
+
+    string envelope;
+    string data;
+    int64_t timestampNs;
+    off_t size;
+
+    // The packages of the reports in the envelope, if it has been read or written.
+    bool pkgsKnown;
+    set<string> pkgs;
+};
 
 void get_args_from_report(IncidentReportArgs* out, const ReportFileProto_Report& report);
 
@@ -119,7 +140,7 @@ public:
     /**
      * Get the envelope information.
      */
-    const ReportFileProto& getEnvelope();
+    const ReportFileProto& getEnvelope() const;
 
     /**
      * Open the file that will contain the contents of the incident report.  Call
@@ -250,7 +271,13 @@ public:
      * more pending readers or broadcasts, for example in response to an error.
      */
     void remove(const sp<ReportFile>& report);
-    
+
+    /**
+     * Record the sizes and the packages of the envelope of report, after it has
+     * been saved or loaded.
+     */
+    void updateIndex(const ReportFile& report);
+
 private:
     string mDirectory;
     int mMaxFileCount;
@@ -260,9 +287,19 @@ private:
     // the directory consistent.
     mutex mLock;
 
+    // Index of the reports in the directory by timestamp, so that the directory is only
+    // listed once.  All of the changes to the directory go through this class, which
+    // keeps it up to date.  mIndexLock may be taken while holding mLock, but not the
+    // other way around.
+    mutex mIndexLock;
+    bool mIndexLoaded;
+    map<int64_t,WorkDirectoryEntry> mIndex;
+
     int64_t make_timestamp_ns_locked();
     bool file_exists_locked(int64_t timestampNs);    
-    off_t get_directory_contents_locked(map<string,WorkDirectoryEntry>* files, int64_t after);
+    off_t get_directory_contents_locked(map<int64_t,WorkDirectoryEntry>* files, int64_t after);
+    off_t scan_directory_locked(map<int64_t,WorkDirectoryEntry>* files);
+    void remove_from_index(int64_t timestampNs);
     void clean_directory_locked();
     void delete_files_for_report_if_necessary(const sp<ReportFile>& report);
 
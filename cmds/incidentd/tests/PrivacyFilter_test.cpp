@@ -300,3 +300,69 @@ TEST_F(PrivacyFilterTest, AutoMessage) {
 }
 
 #endif
+
+class TestFilterFd : public FilterFd {
+public:
+    TestFilterFd(uint8_t privacyPolicy, int fd) : FilterFd(privacyPolicy, fd), error(NO_ERROR) {}
+
+    virtual void onWriteError(status_t err) { error = err; }
+
+    status_t error;
+};
+
+TEST(PrivacyFilterWriteTest, WritesSectionToEveryFd) {
+    TemporaryFile first, second;
+    std::string data = STRING_FIELD_2 + VARINT_FIELD_1;
+    FdBuffer buffer;
+    ASSERT_EQ(NO_ERROR, buffer.write((uint8_t const*)data.data(), data.size()));
+
+    // Both fds get the same data, which is only read once out of the buffer.
+    sp<TestFilterFd> firstFd = new TestFilterFd(PRIVACY_POLICY_LOCAL, first.fd);
+    sp<TestFilterFd> secondFd = new TestFilterFd(PRIVACY_POLICY_LOCAL, second.fd);
+    PrivacyFilter filter(1, NULL);
+    filter.addFd(firstFd);
+    filter.addFd(secondFd);
+
+    size_t maxSize = 0;
+    ASSERT_EQ(NO_ERROR, filter.writeData(buffer, PRIVACY_POLICY_LOCAL, &maxSize));
+    EXPECT_EQ(data.size(), maxSize);
+    EXPECT_EQ(NO_ERROR, firstFd->error);
+    EXPECT_EQ(NO_ERROR, secondFd->error);
+
+    // The section header is the tag of field 1 and the size of the data.
+    std::string expected = "\x0a" + std::string(1, (char)data.size()) + data;
+    for (TemporaryFile* file : {&first, &second}) {
+        std::string result;
+        ASSERT_TRUE(ReadFileToString(file->path, &result));
+        EXPECT_EQ(expected, result);
+    }
+}
+
+TEST(PrivacyFilterWriteTest, StripsSectionToEveryPolicy) {
+    TemporaryFile local, explicitFile, automatic;
+    std::string data = VARINT_FIELD_1 + STRING_FIELD_2;
+    FdBuffer buffer;
+    ASSERT_EQ(NO_ERROR, buffer.write((uint8_t const*)data.data(), data.size()));
+
+    Privacy field1{1, OTHER_TYPE, NULL, PRIVACY_POLICY_LOCAL, NULL};
+    Privacy field2{2, STRING_TYPE, NULL, PRIVACY_POLICY_AUTOMATIC, NULL};
+    Privacy* fields[] = {&field1, &field2, NULL};
+    Privacy section{1, MESSAGE_TYPE, fields, PRIVACY_POLICY_UNSET, NULL};
+
+    PrivacyFilter filter(1, &section);
+    filter.addFd(new TestFilterFd(PRIVACY_POLICY_AUTOMATIC, automatic.fd));
+    filter.addFd(new TestFilterFd(PRIVACY_POLICY_LOCAL, local.fd));
+    filter.addFd(new TestFilterFd(PRIVACY_POLICY_EXPLICIT, explicitFile.fd));
+
+    size_t maxSize = 0;
+    ASSERT_EQ(NO_ERROR, filter.writeData(buffer, PRIVACY_POLICY_LOCAL, &maxSize));
+    EXPECT_EQ(data.size(), maxSize);
+
+    std::string result;
+    ASSERT_TRUE(ReadFileToString(local.path, &result));
+    EXPECT_EQ("\x0a" + std::string(1, (char)data.size()) + data, result);
+    ASSERT_TRUE(ReadFileToString(explicitFile.path, &result));
+    EXPECT_EQ("\x0a" + std::string(1, (char)STRING_FIELD_2.size()) + STRING_FIELD_2, result);
+    ASSERT_TRUE(ReadFileToString(automatic.path, &result));
+    EXPECT_EQ("\x0a" + std::string(1, (char)STRING_FIELD_2.size()) + STRING_FIELD_2, result);
+}
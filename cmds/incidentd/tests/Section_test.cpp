@@ -396,3 +396,21 @@ TEST_F(SectionTest, TestMultipleRequestsBySpec) {
     EXPECT_THAT(content, StrEq(string("\x02") + c + STRING_FIELD_2));
 }
 */
+
+TEST_F(SectionTest, CachedSectionData) {
+    const int KERNEL_VERSION_SECTION = 1002;
+    FdBuffer buffer;
+    ASSERT_EQ(NO_ERROR, buffer.write((const uint8_t*)STRING_FIELD_2.c_str(),
+                STRING_FIELD_2.size()));
+
+    // Only the sections with a cache ttl are cached.
+    EXPECT_EQ(0, section_cache_ttl_ms(REVERSE_PARSER));
+    cache_section_data(REVERSE_PARSER, buffer);
+    EXPECT_EQ(nullptr, get_cached_section_data(REVERSE_PARSER));
+
+    EXPECT_GT(section_cache_ttl_ms(KERNEL_VERSION_SECTION), 0);
+    cache_section_data(KERNEL_VERSION_SECTION, buffer);
+    sp<EncodedBuffer> cached = get_cached_section_data(KERNEL_VERSION_SECTION);
+    ASSERT_NE(nullptr, cached);
+    EXPECT_EQ(STRING_FIELD_2.size(), cached->size());
+}
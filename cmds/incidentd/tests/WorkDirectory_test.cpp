@@ -0,0 +1,137 @@
+// Copyright (C) 2022 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#define DEBUG false
+#include "Log.h"
+
+#include "WorkDirectory.h"
+
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+
+using namespace android;
+using namespace android::os;
+using namespace android::os::incidentd;
+using namespace std;
+
+class WorkDirectoryTest : public testing::Test {
+public:
+    sp<WorkDirectory> makeWorkDirectory(int maxFileCount = 100) {
+        return new WorkDirectory(td.path, maxFileCount, 400 * 1024 * 1024);
+    }
+
+    sp<ReportFile> makeReport(const sp<WorkDirectory>& workDirectory, const string& pkg,
+                              const string& cls) {
+        sp<ReportFile> report = workDirectory->createReportFile();
+        if (report == nullptr) {
+            return nullptr;
+        }
+        IncidentReportArgs args;
+        args.setReceiverPkg(pkg);
+        args.setReceiverCls(cls);
+        report->addReport(args);
+        if (report->saveEnvelope() != NO_ERROR) {
+            return nullptr;
+        }
+        return report;
+    }
+
+    // The ids of the reports the WorkDirectory lists from its index.
+    static vector<string> getIds(const sp<WorkDirectory>& workDirectory) {
+        vector<sp<ReportFile>> reports;
+        workDirectory->getReports(&reports, 0);
+        vector<string> ids;
+        for (const sp<ReportFile>& report : reports) {
+            ids.push_back(report->getId());
+        }
+        return ids;
+    }
+
+    // The ids of the reports on disk, as listed by a WorkDirectory that has not indexed them yet.
+    vector<string> getIdsOnDisk() { return getIds(makeWorkDirectory()); }
+
+protected:
+    TemporaryDir td;
+};
+
+TEST_F(WorkDirectoryTest, SavedReportIsIndexed) {
+    sp<WorkDirectory> workDirectory = makeWorkDirectory();
+    // List the directory once, so that later changes go through the index.
+    EXPECT_TRUE(getIds(workDirectory).empty());
+    EXPECT_FALSE(workDirectory->hasMore(0));
+
+    sp<ReportFile> report = makeReport(workDirectory, "pkg", "cls");
+    ASSERT_NE(nullptr, report);
+
+    vector<string> ids = getIds(workDirectory);
+    ASSERT_EQ(1u, ids.size());
+    EXPECT_EQ(report->getId(), ids[0]);
+    EXPECT_TRUE(workDirectory->hasMore(0));
+    EXPECT_FALSE(workDirectory->hasMore(report->getTimestampNs()));
+    EXPECT_EQ(getIdsOnDisk(), ids);
+}
+
+TEST_F(WorkDirectoryTest, RemovedReportIsDropped) {
+    sp<WorkDirectory> workDirectory = makeWorkDirectory();
+    sp<ReportFile> first = makeReport(workDirectory, "pkg", "cls");
+    sp<ReportFile> second = makeReport(workDirectory, "pkg", "cls");
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    EXPECT_EQ(2u, getIds(workDirectory).size());
+
+    workDirectory->remove(first);
+    vector<string> ids = getIds(workDirectory);
+    ASSERT_EQ(1u, ids.size());
+    EXPECT_EQ(second->getId(), ids[0]);
+    EXPECT_EQ(getIdsOnDisk(), ids);
+}
+
+TEST_F(WorkDirectoryTest, CommittedReportIsDropped) {
+    sp<WorkDirectory> workDirectory = makeWorkDirectory();
+    sp<ReportFile> report = makeReport(workDirectory, "pkg", "cls");
+    sp<ReportFile> other = makeReport(workDirectory, "other", "cls");
+    ASSERT_NE(nullptr, report);
+    ASSERT_NE(nullptr, other);
+    EXPECT_EQ(2u, getIds(workDirectory).size());
+
+    workDirectory->commit(report, "pkg", "cls");
+    vector<string> ids = getIds(workDirectory);
+    ASSERT_EQ(1u, ids.size());
+    EXPECT_EQ(other->getId(), ids[0]);
+
+    // The index knows that no remaining envelope has reports for pkg.
+    workDirectory->commitAll("pkg");
+    EXPECT_EQ(ids, getIds(workDirectory));
+
+    workDirectory->commitAll("other");
+    EXPECT_TRUE(getIds(workDirectory).empty());
+    EXPECT_TRUE(getIdsOnDisk().empty());
+}
+
+TEST_F(WorkDirectoryTest, CleanedUpReportsAreDropped) {
+    sp<WorkDirectory> workDirectory = makeWorkDirectory(2);
+    sp<ReportFile> first = makeReport(workDirectory, "pkg", "cls");
+    sp<ReportFile> second = makeReport(workDirectory, "pkg", "cls");
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+
+    // Creating a report when there are as many as allowed deletes the oldest first.
+    sp<ReportFile> third = makeReport(workDirectory, "pkg", "cls");
+    ASSERT_NE(nullptr, third);
+
+    vector<string> ids = getIds(workDirectory);
+    ASSERT_EQ(2u, ids.size());
+    EXPECT_EQ(second->getId(), ids[0]);
+    EXPECT_EQ(third->getId(), ids[1]);
+    EXPECT_EQ(getIdsOnDisk(), ids);
+}
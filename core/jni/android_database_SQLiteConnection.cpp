@@ -29,6 +29,7 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <vector>
 
 #include <androidfw/CursorWindow.h>
 
@@ -367,12 +368,18 @@ static jlong nativePrepareStatement(JNIEnv* env, jclass clazz, jlong connectionP
         jstring sqlString) {
     SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
 
+    // The SQL is copied out rather than compiled in a critical section: compiling may have to
+    // read the schema, and so wait out the busy timeout for another connection's lock.
     jsize sqlLength = env->GetStringLength(sqlString);
-    const jchar* sql = env->GetStringCritical(sqlString, NULL);
+    std::vector<jchar> sql(sqlLength);
+    env->GetStringRegion(sqlString, 0, sqlLength, sql.data());
+
+    // SQLiteConnection.java keeps prepared statements in its statement cache, so tell SQLite
+    // they are long lived. Their memory then comes from the heap rather than from lookaside
+    // slots, which are left to the short lived allocations of running the statements.
     sqlite3_stmt* statement;
-    int err = sqlite3_prepare16_v2(connection->db,
-            sql, sqlLength * sizeof(jchar), &statement, NULL);
-    env->ReleaseStringCritical(sqlString, sql);
+    int err = sqlite3_prepare16_v3(connection->db,
+            sql.data(), sqlLength * sizeof(jchar), SQLITE_PREPARE_PERSISTENT, &statement, NULL);
 
     if (err != SQLITE_OK) {
         // Error messages like 'near ")": syntax error' are not
@@ -657,96 +664,60 @@ enum CopyRowResult {
 };
 
 static CopyRowResult copyRow(JNIEnv* env, CursorWindow* window,
-        sqlite3_stmt* statement, int numColumns, int startPos, int addedRows) {
-    // Allocate a new field directory for the row.
-    status_t status = window->allocRow();
-    if (status) {
-        LOG_WINDOW("Failed allocating fieldDir at startPos %d row %d, error=%d",
-                startPos, addedRows, status);
-        return CPR_FULL;
-    }
-
-    // Pack the row into the window.
-    CopyRowResult result = CPR_OK;
+        sqlite3_stmt* statement, int numColumns, int startPos, int addedRows,
+        std::vector<CursorWindow::Field>& fields) {
+    // Gather the whole row first so that it is stored into the window with a single allocation.
+    fields.resize(numColumns);
     for (int i = 0; i < numColumns; i++) {
+        CursorWindow::Field& field = fields[i];
         int type = sqlite3_column_type(statement, i);
         if (type == SQLITE_TEXT) {
             // TEXT data
-            const char* text = reinterpret_cast<const char*>(
-                    sqlite3_column_text(statement, i));
+            field.type = CursorWindow::FIELD_TYPE_STRING;
+            field.value.buffer.data = sqlite3_column_text(statement, i);
             // SQLite does not include the NULL terminator in size, but does
             // ensure all strings are NULL terminated, so increase size by
             // one to make sure we store the terminator.
-            size_t sizeIncludingNull = sqlite3_column_bytes(statement, i) + 1;
-            status = window->putString(addedRows, i, text, sizeIncludingNull);
-            if (status) {
-                LOG_WINDOW("Failed allocating %zu bytes for text at %d,%d, error=%d",
-                        sizeIncludingNull, startPos + addedRows, i, status);
-                result = CPR_FULL;
-                break;
-            }
+            field.value.buffer.size = sqlite3_column_bytes(statement, i) + 1;
             LOG_WINDOW("%d,%d is TEXT with %zu bytes",
-                    startPos + addedRows, i, sizeIncludingNull);
+                    startPos + addedRows, i, field.value.buffer.size);
         } else if (type == SQLITE_INTEGER) {
             // INTEGER data
-            int64_t value = sqlite3_column_int64(statement, i);
-            status = window->putLong(addedRows, i, value);
-            if (status) {
-                LOG_WINDOW("Failed allocating space for a long in column %d, error=%d",
-                        i, status);
-                result = CPR_FULL;
-                break;
-            }
-            LOG_WINDOW("%d,%d is INTEGER %" PRId64, startPos + addedRows, i, value);
+            field.type = CursorWindow::FIELD_TYPE_INTEGER;
+            field.value.l = sqlite3_column_int64(statement, i);
+            LOG_WINDOW("%d,%d is INTEGER %" PRId64, startPos + addedRows, i, field.value.l);
         } else if (type == SQLITE_FLOAT) {
             // FLOAT data
-            double value = sqlite3_column_double(statement, i);
-            status = window->putDouble(addedRows, i, value);
-            if (status) {
-                LOG_WINDOW("Failed allocating space for a double in column %d, error=%d",
-                        i, status);
-                result = CPR_FULL;
-                break;
-            }
-            LOG_WINDOW("%d,%d is FLOAT %lf", startPos + addedRows, i, value);
+            field.type = CursorWindow::FIELD_TYPE_FLOAT;
+            field.value.d = sqlite3_column_double(statement, i);
+            LOG_WINDOW("%d,%d is FLOAT %lf", startPos + addedRows, i, field.value.d);
         } else if (type == SQLITE_BLOB) {
             // BLOB data
-            const void* blob = sqlite3_column_blob(statement, i);
-            size_t size = sqlite3_column_bytes(statement, i);
-            status = window->putBlob(addedRows, i, blob, size);
-            if (status) {
-                LOG_WINDOW("Failed allocating %zu bytes for blob at %d,%d, error=%d",
-                        size, startPos + addedRows, i, status);
-                result = CPR_FULL;
-                break;
-            }
+            field.type = CursorWindow::FIELD_TYPE_BLOB;
+            field.value.buffer.data = sqlite3_column_blob(statement, i);
+            field.value.buffer.size = sqlite3_column_bytes(statement, i);
             LOG_WINDOW("%d,%d is Blob with %zu bytes",
-                    startPos + addedRows, i, size);
+                    startPos + addedRows, i, field.value.buffer.size);
         } else if (type == SQLITE_NULL) {
             // NULL field
-            status = window->putNull(addedRows, i);
-            if (status) {
-                LOG_WINDOW("Failed allocating space for a null in column %d, error=%d",
-                        i, status);
-                result = CPR_FULL;
-                break;
-            }
-
+            field.type = CursorWindow::FIELD_TYPE_NULL;
             LOG_WINDOW("%d,%d is NULL", startPos + addedRows, i);
         } else {
             // Unknown data
             ALOGE("Unknown column type when filling database window");
             throw_sqlite3_exception(env, "Unknown column type when filling window");
-            result = CPR_ERROR;
-            break;
+            return CPR_ERROR;
         }
     }
 
-    // Free the last row if if was not successfully copied.
-    if (result != CPR_OK) {
-        window->freeLastRow();
+    // Pack the row into the window. The window is left untouched if the row does not fit.
+    status_t status = window->putRow(fields.data(), numColumns);
+    if (status) {
+        LOG_WINDOW("Failed allocating row at startPos %d row %d, error=%d",
+                startPos, addedRows, status);
+        return CPR_FULL;
     }
-    return result;
+    return CPR_OK;
 }
 
 static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
@@ -774,6 +745,7 @@ static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
         return 0;
     }
 
+    std::vector<CursorWindow::Field> fields;
     int retryCount = 0;
     int totalRows = 0;
     int addedRows = 0;
@@ -791,7 +763,8 @@ static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
                 continue;
             }
 
-            CopyRowResult cpr = copyRow(env, window, statement, numColumns, startPos, addedRows);
+            CopyRowResult cpr = copyRow(env, window, statement, numColumns, startPos, addedRows,
+                    fields);
             if (cpr == CPR_FULL && addedRows && startPos + addedRows <= requiredPos) {
                 // We filled the window before we got to the one row that we really wanted.
                 // Clear the window and start filling it again from here.
@@ -800,7 +773,8 @@ static jlong nativeExecuteForCursorWindow(JNIEnv* env, jclass clazz,
                 window->setNumColumns(numColumns);
                 startPos += addedRows;
                 addedRows = 0;
-                cpr = copyRow(env, window, statement, numColumns, startPos, addedRows);
+                cpr = copyRow(env, window, statement, numColumns, startPos, addedRows,
+                        fields);
             }
 
             if (cpr == CPR_OK) {
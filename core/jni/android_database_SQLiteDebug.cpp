@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <utils/Log.h>
 
+#include <androidfw/CursorWindow.h>
 #include <sqlite3.h>
 
 #include "core_jni_helpers.h"
@@ -36,8 +37,30 @@ static struct {
     jfieldID memoryUsed;
     jfieldID pageCacheOverflow;
     jfieldID largestMemAlloc;
+
+    // Statistics of the CursorWindow region pool. These fields are optional and only
+    // filled in when PagerStats declares them.
+    jfieldID cursorWindowPoolHits;
+    jfieldID cursorWindowPoolMisses;
+    jfieldID cursorWindowPoolRecycled;
+    jfieldID cursorWindowPoolDiscarded;
+    jfieldID cursorWindowPoolBytes;
 } gSQLiteDebugPagerStatsClassInfo;
 
+static jfieldID getOptionalFieldID(JNIEnv* env, jclass clazz, const char* name, const char* sig) {
+    jfieldID field = env->GetFieldID(clazz, name, sig);
+    if (field == nullptr) {
+        env->ExceptionClear();
+    }
+    return field;
+}
+
+static void setOptionalLongField(JNIEnv* env, jobject obj, jfieldID field, uint64_t value) {
+    if (field != nullptr) {
+        env->SetLongField(obj, field, static_cast<jlong>(value));
+    }
+}
+
 static void nativeGetPagerStats(JNIEnv *env, jobject clazz, jobject statsObj)
 {
     int memoryUsed;
@@ -52,6 +75,18 @@ static void nativeGetPagerStats(JNIEnv *env, jobject clazz, jobject statsObj)
     env->SetIntField(statsObj, gSQLiteDebugPagerStatsClassInfo.pageCacheOverflow,
             pageCacheOverflow);
     env->SetIntField(statsObj, gSQLiteDebugPagerStatsClassInfo.largestMemAlloc, largestMemAlloc);
+
+    const CursorWindow::PoolStats poolStats = CursorWindow::getPoolStats();
+    setOptionalLongField(env, statsObj, gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolHits,
+            poolStats.hits);
+    setOptionalLongField(env, statsObj, gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolMisses,
+            poolStats.misses);
+    setOptionalLongField(env, statsObj, gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolRecycled,
+            poolStats.recycled);
+    setOptionalLongField(env, statsObj, gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolDiscarded,
+            poolStats.discarded);
+    setOptionalLongField(env, statsObj, gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolBytes,
+            poolStats.pooledBytes);
 }
 
 /*
@@ -73,6 +108,16 @@ int register_android_database_SQLiteDebug(JNIEnv *env)
             "largestMemAlloc", "I");
     gSQLiteDebugPagerStatsClassInfo.pageCacheOverflow = GetFieldIDOrDie(env, clazz,
             "pageCacheOverflow", "I");
+    gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolHits = getOptionalFieldID(env, clazz,
+            "cursorWindowPoolHits", "J");
+    gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolMisses = getOptionalFieldID(env, clazz,
+            "cursorWindowPoolMisses", "J");
+    gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolRecycled = getOptionalFieldID(env, clazz,
+            "cursorWindowPoolRecycled", "J");
+    gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolDiscarded = getOptionalFieldID(env, clazz,
+            "cursorWindowPoolDiscarded", "J");
+    gSQLiteDebugPagerStatsClassInfo.cursorWindowPoolBytes = getOptionalFieldID(env, clazz,
+            "cursorWindowPoolBytes", "J");
 
     return RegisterMethodsOrDie(env, "android/database/sqlite/SQLiteDebug",
             gMethods, NELEM(gMethods));
@@ -94,6 +94,10 @@ static void android_media_ToneGenerator_native_setup(JNIEnv *env, jobject thiz,
                                                      jint volume, jstring opPackageName) {
     ALOGV("%s jobject: %p", __func__, thiz);
     ScopedUtfChars opPackageNameStr{env, opPackageName};
+    // Each instance gets a ToneGenerator, and with it an AudioTrack and audio session, of its own.
+    // They are not pooled across instances: a reused generator would hand out the session of a
+    // released instance, along with any effects still attached to it, and an idle pooled track
+    // would stay open for the life of the process.
     sp<ToneGenerator> lpToneGen = sp<ToneGenerator>::make((audio_stream_type_t)streamType,
                                     AudioSystem::linearToLog(volume),
                                     true /*threadCanCallJava*/,
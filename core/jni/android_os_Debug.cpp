@@ -29,6 +29,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <string>
 #include <vector>
@@ -520,41 +521,20 @@ static jlong android_os_Debug_getPssPid(JNIEnv *env, jobject clazz, jint pid,
         return 0;
     }
 
+    // Only the leading values are written, so they are set directly rather than by copying
+    // the whole arrays in and back out.
     if (outUssSwapPssRss != NULL) {
-        int outLen = env->GetArrayLength(outUssSwapPssRss);
-        if (outLen >= 1) {
-            jlong* outUssSwapPssRssArray = env->GetLongArrayElements(outUssSwapPssRss, 0);
-            if (outUssSwapPssRssArray != NULL) {
-                outUssSwapPssRssArray[0] = uss;
-                if (outLen >= 2) {
-                    outUssSwapPssRssArray[1] = swapPss;
-                }
-                if (outLen >= 3) {
-                    outUssSwapPssRssArray[2] = rss;
-                }
-            }
-            env->ReleaseLongArrayElements(outUssSwapPssRss, outUssSwapPssRssArray, 0);
-        }
+        const jlong values[] = {uss, swapPss, rss};
+        const jsize outLen = std::min<jsize>(env->GetArrayLength(outUssSwapPssRss),
+                                             NELEM(values));
+        env->SetLongArrayRegion(outUssSwapPssRss, 0, outLen, values);
     }
 
     if (outMemtrack != NULL) {
-        int outLen = env->GetArrayLength(outMemtrack);
-        if (outLen >= 1) {
-            jlong* outMemtrackArray = env->GetLongArrayElements(outMemtrack, 0);
-            if (outMemtrackArray != NULL) {
-                outMemtrackArray[0] = memtrack;
-                if (outLen >= 2) {
-                    outMemtrackArray[1] = graphics_mem.graphics;
-                }
-                if (outLen >= 3) {
-                    outMemtrackArray[2] = graphics_mem.gl;
-                }
-                if (outLen >= 4) {
-                    outMemtrackArray[3] = graphics_mem.other;
-                }
-            }
-            env->ReleaseLongArrayElements(outMemtrack, outMemtrackArray, 0);
-        }
+        const jlong values[] = {memtrack, graphics_mem.graphics, graphics_mem.gl,
+                                graphics_mem.other};
+        const jsize outLen = std::min<jsize>(env->GetArrayLength(outMemtrack), NELEM(values));
+        env->SetLongArrayRegion(outMemtrack, 0, outLen, values);
     }
 
     return pss;
@@ -605,10 +585,13 @@ static void android_os_Debug_getMemInfo(JNIEnv *env, jobject clazz, jlongArray o
 
     // Read system memory info including ZRAM. The values are stored in the vector
     // in the same order as MEMINFO_* enum
-    std::vector<std::string_view> tags(
-        ::android::meminfo::SysMemInfo::kDefaultSysMemInfoTags.begin(),
-        ::android::meminfo::SysMemInfo::kDefaultSysMemInfoTags.end());
-    tags.insert(tags.begin() + MEMINFO_ZRAM_TOTAL, "Zram:");
+    static const std::vector<std::string_view> tags = [] {
+        std::vector<std::string_view> tags(
+            ::android::meminfo::SysMemInfo::kDefaultSysMemInfoTags.begin(),
+            ::android::meminfo::SysMemInfo::kDefaultSysMemInfoTags.end());
+        tags.insert(tags.begin() + MEMINFO_ZRAM_TOTAL, "Zram:");
+        return tags;
+    }();
     std::vector<uint64_t> mem(tags.size());
     ::android::meminfo::SysMemInfo smi;
     if (!smi.ReadMemInfo(tags.size(), tags.data(), mem.data())) {
@@ -616,19 +599,16 @@ static void android_os_Debug_getMemInfo(JNIEnv *env, jobject clazz, jlongArray o
         return;
     }
 
-    jlong* outArray = env->GetLongArrayElements(out, 0);
-    if (outArray != NULL) {
-        outLen = MEMINFO_COUNT;
-        for (int i = 0; i < outLen; i++) {
-            if (i == MEMINFO_VMALLOC_USED && mem[i] == 0) {
-                outArray[i] = smi.ReadVmallocInfo() / 1024;
-                continue;
-            }
-            outArray[i] = mem[i];
+    jlong outArray[MEMINFO_COUNT];
+    for (int i = 0; i < MEMINFO_COUNT; i++) {
+        if (i == MEMINFO_VMALLOC_USED && mem[i] == 0) {
+            outArray[i] = smi.ReadVmallocInfo() / 1024;
+            continue;
         }
+        outArray[i] = mem[i];
     }
 
-    env->ReleaseLongArrayElements(out, outArray, 0);
+    env->SetLongArrayRegion(out, 0, MEMINFO_COUNT, outArray);
 }
 
 static jint read_binder_stat(const char* stat)
@@ -118,6 +118,10 @@ void NativeMessageQueue::pollOnce(JNIEnv* env, jobject pollObj, int timeoutMilli
     }
 }
 
+// Wakes are not coalesced here. MessageQueue.java already only wakes a blocked queue when a new
+// message becomes its head, so a burst of posts costs one wake. A skip-if-pending flag would also
+// be unsafe: native code polling this thread's Looper directly drains the wake fd without telling
+// us, and a wake skipped after that would be lost.
 void NativeMessageQueue::wake() {
     mLooper->wake();
 }
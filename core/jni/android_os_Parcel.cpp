@@ -19,6 +19,7 @@
 
 #include "android_os_Parcel.h"
 #include "android_util_Binder.h"
+#include "android_util_BinderLatency.h"
 
 #include <nativehelper/JNIPlatformHelp.h>
 
@@ -202,7 +203,7 @@ static void android_os_Parcel_writeByteArray(JNIEnv* env, jclass clazz, jlong na
     jbyte* ar = (jbyte*)env->GetPrimitiveArrayCritical((jarray)data, 0);
     if (ar) {
         memcpy(dest, ar + offset, length);
-        env->ReleasePrimitiveArrayCritical((jarray)data, ar, 0);
+        env->ReleasePrimitiveArrayCritical((jarray)data, ar, JNI_ABORT);
     }
 }
 
@@ -239,7 +240,7 @@ static void android_os_Parcel_writeBlob(JNIEnv* env, jclass clazz, jlong nativeP
         memset(blob.data(), 0, length);
     } else {
         memcpy(blob.data(), ar + offset, length);
-        env->ReleasePrimitiveArrayCritical((jarray)data, ar, 0);
+        env->ReleasePrimitiveArrayCritical((jarray)data, ar, JNI_ABORT);
     }
 
     blob.release();
@@ -357,16 +358,12 @@ static jbyteArray android_os_Parcel_createByteArray(JNIEnv* env, jclass clazz, j
             ret = env->NewByteArray(len);
 
             if (ret != NULL) {
-                jbyte* a2 = (jbyte*)env->GetPrimitiveArrayCritical(ret, 0);
-                if (a2) {
-                    const void* data = parcel->readInplace(len);
-                    if (data) {
-                        memcpy(a2, data, len);
-                    }
-                    env->ReleasePrimitiveArrayCritical(ret, a2, 0);
-                    if (!data) {
-                        ret = NULL;
-                    }
+                const void* data = parcel->readInplace(len);
+                if (data) {
+                    env->SetByteArrayRegion(ret, 0, len, (const jbyte*)data);
+                } else {
+                    env->DeleteLocalRef(ret);
+                    ret = NULL;
                 }
             }
         }
@@ -386,17 +383,10 @@ static jboolean android_os_Parcel_readByteArray(JNIEnv* env, jclass clazz, jlong
 
     int32_t len = parcel->readInt32();
     if (len >= 0 && len <= (int32_t)parcel->dataAvail() && len == destLen) {
-        jbyte* ar = (jbyte*)env->GetPrimitiveArrayCritical((jarray)dest, 0);
-        if (ar) {
-            const void* data = parcel->readInplace(len);
-            if (data) {
-                memcpy(ar, data, len);
-                ret = JNI_TRUE;
-            } else {
-                ret = JNI_FALSE;
-            }
-
-            env->ReleasePrimitiveArrayCritical((jarray)dest, ar, 0);
+        const void* data = parcel->readInplace(len);
+        if (data) {
+            env->SetByteArrayRegion((jbyteArray)dest, 0, len, (const jbyte*)data);
+            ret = JNI_TRUE;
         }
     }
     return ret;
@@ -419,11 +409,7 @@ static jbyteArray android_os_Parcel_readBlob(JNIEnv* env, jclass clazz, jlong na
 
             ret = env->NewByteArray(len);
             if (ret != NULL) {
-                jbyte* a2 = (jbyte*)env->GetPrimitiveArrayCritical(ret, 0);
-                if (a2) {
-                    memcpy(a2, blob.data(), len);
-                    env->ReleasePrimitiveArrayCritical(ret, a2, 0);
-                }
+                env->SetByteArrayRegion(ret, 0, len, (const jbyte*)blob.data());
             }
             blob.release();
         }
@@ -560,12 +546,7 @@ static jbyteArray android_os_Parcel_marshall(JNIEnv* env, jclass clazz, jlong na
 
     if (ret != NULL)
     {
-        jbyte* array = (jbyte*)env->GetPrimitiveArrayCritical(ret, 0);
-        if (array != NULL)
-        {
-            memcpy(array, parcel->data(), parcel->dataSize());
-            env->ReleasePrimitiveArrayCritical(ret, array, 0);
-        }
+        env->SetByteArrayRegion(ret, 0, parcel->dataSize(), (const jbyte*)parcel->data());
     }
 
     return ret;
@@ -579,16 +560,21 @@ static void android_os_Parcel_unmarshall(JNIEnv* env, jclass clazz, jlong native
        return;
     }
 
+    // Size the parcel before entering the critical region, so that the copy is the only work
+    // done while the garbage collector may be held off.
+    parcel->setDataSize(length);
+    parcel->setDataPosition(0);
+    void* raw = parcel->writeInplace(length);
+    if (raw == NULL) {
+        signalExceptionForError(env, clazz, NO_MEMORY);
+        return;
+    }
+
     jbyte* array = (jbyte*)env->GetPrimitiveArrayCritical(data, 0);
     if (array)
     {
-        parcel->setDataSize(length);
-        parcel->setDataPosition(0);
-
-        void* raw = parcel->writeInplace(length);
         memcpy(raw, (array + offset), length);
-
-        env->ReleasePrimitiveArrayCritical(data, array, 0);
+        env->ReleasePrimitiveArrayCritical(data, array, JNI_ABORT);
     }
 }
 
@@ -715,6 +701,12 @@ static void android_os_Parcel_writeInterfaceToken(JNIEnv* env, jclass clazz, jlo
         InterfaceDescriptorString descriptor(env, name);
         parcel->writeInterfaceToken(reinterpret_cast<const char16_t*>(descriptor.str()),
                                     descriptor.size());
+        if (binder_latency::isEnabled()) {
+            binder_latency::noteInterfaceToken(
+                    parcel,
+                    String16(reinterpret_cast<const char16_t*>(descriptor.str()),
+                             descriptor.size()));
+        }
     }
 }
 
@@ -40,10 +40,18 @@ inline static void withString(JNIEnv* env, jstring jstr, F callback) {
     // So make a buffer of size 4097 and let it hold a string with a maximum length
     // of 1024. The extra last byte for the null terminator.
     std::array<char, 4097> buffer;
-    // We have no idea of knowing how much data GetStringUTFRegion wrote, so null it out in
-    // advance so we can have a reliable null terminator
-    memset(buffer.data(), 0, buffer.size());
-    jsize size = std::min(env->GetStringLength(jstr), 1024);
+    const jsize length = env->GetStringLength(jstr);
+    const jsize size = std::min(length, 1024);
+    if (size == length) {
+        // The whole string is encoded, so its encoded length says where the terminator goes.
+        // That is cheap to get for the usual ASCII name, unlike clearing the whole buffer on
+        // every traced call.
+        buffer[env->GetStringUTFLength(jstr)] = '\0';
+    } else {
+        // We have no idea of knowing how much data GetStringUTFRegion wrote, so null it out in
+        // advance so we can have a reliable null terminator
+        memset(buffer.data(), 0, buffer.size());
+    }
     env->GetStringUTFRegion(jstr, 0, size, buffer.data());
     sanitizeString(buffer.data());
 
@@ -36,6 +36,9 @@ static std::string buildFileName(const std::string& locale) {
     return SYSTEM_HYPHENATOR_PREFIX + lowerLocale + SYSTEM_HYPHENATOR_SUFFIX;
 }
 
+// The zygote calls nInit while it preloads text resources, so these read-only shared mappings are
+// made once and inherited by every app; pages are faulted in from the shared page cache. They are
+// not prefaulted in the zygote, since fork does not copy the page tables of file mappings.
 static const uint8_t* mmapPatternFile(const std::string& locale) {
     const std::string hyFilePath = buildFileName(locale);
     const int fd = open(hyFilePath.c_str(), O_RDONLY | O_CLOEXEC);
@@ -645,6 +645,68 @@ static jint NativeGetResourceValue(JNIEnv* env, jclass /*clazz*/, jlong ptr, jin
   return CopyValue(env, *value, typed_value);
 }
 
+// Looks up the values of all of `resids` under a single acquisition of the lock. The values are
+// written to `out_values` in the layout used by NativeGetResourceArray(), with the entries of ids
+// that could not be resolved set to TYPE_NULL and an invalid cookie. Returns the number of values
+// found, or -1 on error.
+static jint NativeGetResourceValues(JNIEnv* env, jclass /*clazz*/, jlong ptr, jintArray resids,
+                                    jshort density, jboolean resolve_references,
+                                    jintArray out_values) {
+  const jsize resids_length = env->GetArrayLength(resids);
+  const jsize out_values_length = env->GetArrayLength(out_values);
+  if (env->ExceptionCheck()) {
+    return -1;
+  }
+
+  if (static_cast<int64_t>(resids_length) * STYLE_NUM_ENTRIES > out_values_length) {
+    jniThrowException(env, "java/lang/IllegalArgumentException",
+                      "Output array is not large enough");
+    return -1;
+  }
+
+  ScopedLock<AssetManager2> assetmanager(AssetManagerFromLong(ptr));
+  jint* ids = reinterpret_cast<jint*>(env->GetPrimitiveArrayCritical(resids, nullptr));
+  if (ids == nullptr) {
+    return -1;
+  }
+
+  jint* values = reinterpret_cast<jint*>(env->GetPrimitiveArrayCritical(out_values, nullptr));
+  if (values == nullptr) {
+    env->ReleasePrimitiveArrayCritical(resids, ids, JNI_ABORT);
+    return -1;
+  }
+
+  jint found = 0;
+  jint* cursor = values;
+  for (jsize i = 0; i < resids_length; i++, cursor += STYLE_NUM_ENTRIES) {
+    auto value = assetmanager->GetResource(static_cast<uint32_t>(ids[i]), false /*may_be_bag*/,
+                                           static_cast<uint16_t>(density));
+    const bool resolved = value.has_value() &&
+        (!resolve_references || assetmanager->ResolveReference(value.value()).has_value());
+    if (!resolved) {
+      cursor[STYLE_TYPE] = static_cast<jint>(Res_value::TYPE_NULL);
+      cursor[STYLE_DATA] = static_cast<jint>(Res_value::DATA_NULL_UNDEFINED);
+      cursor[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(kInvalidCookie);
+      cursor[STYLE_RESOURCE_ID] = 0;
+      cursor[STYLE_CHANGING_CONFIGURATIONS] = 0;
+      cursor[STYLE_DENSITY] = 0;
+      continue;
+    }
+
+    cursor[STYLE_TYPE] = static_cast<jint>(value->type);
+    cursor[STYLE_DATA] = static_cast<jint>(value->data);
+    cursor[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(value->cookie);
+    cursor[STYLE_RESOURCE_ID] = static_cast<jint>(value->resid);
+    cursor[STYLE_CHANGING_CONFIGURATIONS] = static_cast<jint>(value->flags);
+    cursor[STYLE_DENSITY] = static_cast<jint>(value->config.density);
+    found++;
+  }
+
+  env->ReleasePrimitiveArrayCritical(out_values, values, 0);
+  env->ReleasePrimitiveArrayCritical(resids, ids, JNI_ABORT);
+  return found;
+}
+
 static jint NativeGetResourceBagValue(JNIEnv* env, jclass /*clazz*/, jlong ptr, jint resid,
                                       jint bag_entry_id, jobject typed_value) {
   ScopedLock<AssetManager2> assetmanager(AssetManagerFromLong(ptr));
@@ -1526,6 +1588,10 @@ static const JNINativeMethod gAssetManagerMethods[] = {
     {"getGlobalAssetManagerCount", "()I", (void*)NativeGetGlobalAssetManagerCount},
 };
 
+static const JNINativeMethod gAssetManagerOptionalMethods[] = {
+    {"nativeGetResourceValues", "(J[ISZ[I)I", (void*)NativeGetResourceValues},
+};
+
 int register_android_content_AssetManager(JNIEnv* env) {
   jclass apk_assets_class = FindClassOrDie(env, "android/content/res/ApkAssets");
   gApkAssetsFields.native_ptr = GetFieldIDOrDie(env, apk_assets_class, "mNativePtr", "J");
@@ -1574,8 +1640,16 @@ int register_android_content_AssetManager(JNIEnv* env) {
       GetMethodIDOrDie(env, gArrayMapOffsets.classObject, "put",
                        "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
 
-  return RegisterMethodsOrDie(env, "android/content/res/AssetManager", gAssetManagerMethods,
-                              NELEM(gAssetManagerMethods));
+  const int result = RegisterMethodsOrDie(env, "android/content/res/AssetManager",
+                                          gAssetManagerMethods, NELEM(gAssetManagerMethods));
+
+  // The bulk lookups are optional; they are only bound if AssetManager declares them.
+  jclass assetManagerClass = FindClassOrDie(env, "android/content/res/AssetManager");
+  if (env->RegisterNatives(assetManagerClass, gAssetManagerOptionalMethods,
+                           NELEM(gAssetManagerOptionalMethods)) < 0) {
+    env->ExceptionClear();
+  }
+  return result;
 }
 
 }; // namespace android
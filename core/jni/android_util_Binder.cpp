@@ -19,6 +19,7 @@
 
 #include "android_os_Parcel.h"
 #include "android_util_Binder.h"
+#include "android_util_BinderLatency.h"
 
 #include <atomic>
 #include <fcntl.h>
@@ -404,6 +405,9 @@ protected:
         IPCThreadState* thread_state = IPCThreadState::self();
         const int32_t strict_policy_before = thread_state->getStrictModePolicy();
 
+        const bool time_latency = binder_latency::isEnabled();
+        const nsecs_t start_time = time_latency ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
+
         //printf("Transact from %p to Java code sending: ", this);
         //data.print();
         //printf("\n");
@@ -418,6 +422,13 @@ protected:
             res = JNI_FALSE;
         }
 
+        // Recorded once no exception is pending, the descriptor may have to be asked of Java.
+        if (time_latency) {
+            const nsecs_t duration = systemTime(SYSTEM_TIME_MONOTONIC) - start_time;
+            binder_latency::record(binder_latency::kServer, getInterfaceDescriptor(), code,
+                                   flags & IBinder::FLAG_ONEWAY, duration);
+        }
+
         // Check if the strict mode state changed while processing the
         // call.  The Binder state will be restored by the underlying
         // Binder system in IPCThreadState, however we need to take care
@@ -1423,10 +1434,22 @@ static jboolean android_os_BinderProxy_transact(JNIEnv* env, jobject obj,
         }
     }
 
+    const bool time_latency = binder_latency::isEnabled();
+    const nsecs_t start_time = time_latency ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
+    // Taken from the parcel rather than the proxy, whose descriptor may cost a transaction.
+    const String16 descriptor = time_latency ? binder_latency::takeInterfaceToken(data)
+                                             : String16();
+
     //printf("Transact from Java code to %p sending: ", target); data->print();
     status_t err = target->transact(code, *data, reply, flags);
     //if (reply) printf("Transact from Java code to %p received: ", target); reply->print();
 
+    if (time_latency) {
+        const nsecs_t duration = systemTime(SYSTEM_TIME_MONOTONIC) - start_time;
+        binder_latency::record(binder_latency::kClient, descriptor, code,
+                               flags & IBinder::FLAG_ONEWAY, duration);
+    }
+
     if (kEnableBinderSample) {
         if (time_binder_calls) {
             conditionally_log_binder_call(start_millis, target, code);
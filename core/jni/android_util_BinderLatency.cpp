@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "BinderLatency"
+
+#include "android_util_BinderLatency.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <mutex>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <android-base/properties.h>
+#include <log/log.h>
+#include <utils/String8.h>
+
+namespace android {
+namespace binder_latency {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "");
+
+static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+static constexpr size_t kMappingSize = sizeof(Header) + kSlots * sizeof(Slot);
+
+static std::mutex gInitLock;
+// The process that gHeader and gSlots were set up for. A child of the zygote must not count into
+// a mapping it shares with its parent, so the histograms are set up again after a fork.
+static std::atomic<pid_t> gInitPid(0);
+static Header* gHeader = nullptr;
+static Slot* gSlots = nullptr;
+// Left open while collecting, it is how the histograms are found from outside the process.
+static int gFd = -1;
+
+// The interface token last written by Parcel.writeInterfaceToken() on this thread, and the
+// parcel it was written to.
+static thread_local const Parcel* gTokenParcel = nullptr;
+static thread_local String16 gToken;
+
+static void initLocked() {
+    // After a fork, these are the parent's. Drop them rather than count into its table.
+    if (gHeader != nullptr) {
+        munmap(gHeader, kMappingSize);
+        gHeader = nullptr;
+        gSlots = nullptr;
+    }
+    if (gFd >= 0) {
+        close(gFd);
+        gFd = -1;
+    }
+
+    // The host runtime makes no binder calls worth measuring, and its libc has no memfd_create.
+#ifdef __ANDROID__
+    if (!android::base::GetBoolProperty("debug.binder.latency_histograms", false)) {
+        return;
+    }
+
+    int fd = memfd_create("binder_latency_histograms", MFD_CLOEXEC);
+    if (fd < 0) {
+        ALOGE("memfd_create failed: %s", strerror(errno));
+        return;
+    }
+    if (ftruncate(fd, kMappingSize) != 0) {
+        ALOGE("ftruncate failed: %s", strerror(errno));
+        close(fd);
+        return;
+    }
+    void* mem = mmap(nullptr, kMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        ALOGE("mmap failed: %s", strerror(errno));
+        close(fd);
+        return;
+    }
+
+    // A new memfd reads as zeros, which is also the empty state of every slot.
+    Header* header = new (mem) Header();
+    header->magic = kMagic;
+    header->slotCount = kSlots;
+    header->shardCount = kShards;
+    header->bucketCount = kBuckets;
+    gHeader = header;
+    gSlots = reinterpret_cast<Slot*>(header + 1);
+    gFd = fd;
+    ALOGI("Collecting binder latency histograms in fd %d", fd);
+#endif
+}
+
+bool isEnabled() {
+    const pid_t pid = getpid();
+    if (gInitPid.load(std::memory_order_acquire) != pid) {
+        std::lock_guard<std::mutex> lock(gInitLock);
+        if (gInitPid.load(std::memory_order_relaxed) != pid) {
+            initLocked();
+            gInitPid.store(pid, std::memory_order_release);
+        }
+    }
+    return gSlots != nullptr;
+}
+
+static uint64_t hashKey(const String16& descriptor, uint32_t code, bool oneway, Side side) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    const char16_t* chars = descriptor.string();
+    for (size_t i = 0; i < descriptor.size(); i++) {
+        mix(chars[i]);
+    }
+    mix(code);
+    mix((oneway ? 2 : 0) | side);
+    // 0 marks an empty slot.
+    return hash != 0 ? hash : 1;
+}
+
+static size_t bucketFor(uint64_t us) {
+    if (us < kSubBuckets) {
+        return us;
+    }
+    const size_t octave = 63 - __builtin_clzll(us);
+    const size_t bucket = (octave - kSubBucketBits + 1) * kSubBuckets +
+            ((us >> (octave - kSubBucketBits)) & (kSubBuckets - 1));
+    return std::min(bucket, kBuckets - 1);
+}
+
+static size_t shardOfThisThread() {
+#ifdef __ANDROID__
+    static thread_local const size_t shard = gettid() % kShards;
+    return shard;
+#else
+    return 0;
+#endif
+}
+
+// Whether the descriptor stored in a slot is that of descriptor, as truncated by strlcpy() when
+// the slot was claimed.
+static bool descriptorMatches(const char* stored, const String16& descriptor) {
+    const char16_t* chars = descriptor.string();
+    size_t i = 0;
+    for (; i < descriptor.size() && i < kDescriptorSize - 1; i++) {
+        if (chars[i] >= 0x80) {
+            // Not ASCII, compare the UTF-8 that was stored.
+            return strncmp(stored, String8(descriptor).string(), kDescriptorSize - 1) == 0;
+        }
+        if (stored[i] != static_cast<char>(chars[i])) {
+            return false;
+        }
+    }
+    return i == kDescriptorSize - 1 || stored[i] == '\0';
+}
+
+void noteInterfaceToken(const Parcel* parcel, const String16& descriptor) {
+    if (!isEnabled()) {
+        return;
+    }
+    gTokenParcel = parcel;
+    gToken = descriptor;
+}
+
+String16 takeInterfaceToken(const Parcel* parcel) {
+    String16 token;
+    if (gTokenParcel == parcel) {
+        token = gToken;
+    }
+    gTokenParcel = nullptr;
+    gToken = String16();
+    return token;
+}
+
+void record(Side side, const String16& descriptor, uint32_t code, bool oneway, nsecs_t duration) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    const uint64_t key = hashKey(descriptor, code, oneway, side);
+    const uint64_t us = duration > 0 ? duration / 1000 : 0;
+    for (size_t i = 0; i < kSlots; i++) {
+        Slot* slot = &gSlots[(key + i) % kSlots];
+        uint64_t slotKey = slot->key.load(std::memory_order_relaxed);
+        bool claimed = false;
+        if (slotKey == 0 && slot->key.compare_exchange_strong(slotKey, key,
+                                                              std::memory_order_relaxed)) {
+            slot->code = code;
+            slot->side = side;
+            slot->oneway = oneway;
+            strlcpy(slot->descriptor, String8(descriptor).string(), kDescriptorSize);
+            slot->ready.store(1, std::memory_order_release);
+            slotKey = key;
+            claimed = true;
+        }
+        if (slotKey != key) {
+            continue;
+        }
+        if (!claimed) {
+            // The rest of the key is only readable once the claiming thread has published it,
+            // until then the sample is counted as dropped.
+            if (slot->ready.load(std::memory_order_acquire) == 0) {
+                break;
+            }
+            // Another key with the same hash, keep probing.
+            if (slot->code != code || slot->side != side || slot->oneway != oneway ||
+                !descriptorMatches(slot->descriptor, descriptor)) {
+                continue;
+            }
+        }
+        const size_t shard = shardOfThisThread();
+        slot->counts[shard][bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+        slot->totalUs[shard].fetch_add(us, std::memory_order_relaxed);
+        return;
+    }
+    gHeader->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace binder_latency
+} // namespace android
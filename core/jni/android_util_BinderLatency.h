@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UTIL_BINDER_LATENCY_H
+#define ANDROID_UTIL_BINDER_LATENCY_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include <binder/Parcel.h>
+#include <utils/String16.h>
+#include <utils/Timers.h>
+
+namespace android {
+
+// Latency histograms of the binder transactions of this process, keyed by interface descriptor,
+// transaction code, one-way flag and side: the client side measures the round trip of
+// BinderProxy.transact(), the server side the execution of JavaBBinder::onTransact(). Client
+// transactions whose parcel carries no interface token are keyed by an empty descriptor.
+//
+// Collection is off unless debug.binder.latency_histograms is set when the process first makes
+// or serves a Java binder call. Recording is lock free: a transaction claims the slot of its key
+// with a compare-and-swap on the key's hash, then bumps a relaxed counter in the shard of the
+// calling thread. Keys whose hashes collide are told apart by the rest of the key in the slot.
+//
+// The histograms live in a memfd named "binder_latency_histograms", laid out as a Header
+// followed by kSlots Slots, so that a snapshot can be read through /proc/<pid>/fd without
+// stopping the process. Bucket b of a slot counts the calls that took from bucketStartUs(b)
+// up to bucketStartUs(b + 1) microseconds; the last bucket also counts everything longer.
+namespace binder_latency {
+
+constexpr uint32_t kMagic = 0x424c4831;  // "BLH1"
+constexpr size_t kSlots = 128;
+constexpr size_t kShards = 4;
+constexpr size_t kSubBucketBits = 2;
+constexpr size_t kBuckets = 80;
+constexpr size_t kDescriptorSize = 96;
+
+enum Side : uint8_t {
+    kClient = 0,
+    kServer = 1,
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t slotCount;
+    uint32_t shardCount;
+    uint32_t bucketCount;
+    // Transactions not recorded because every slot was taken.
+    std::atomic<uint64_t> dropped;
+};
+
+struct Slot {
+    // 0 until claimed. Readers should skip slots whose ready flag is not set.
+    std::atomic<uint64_t> key;
+    std::atomic<uint32_t> ready;
+    uint32_t code;
+    uint8_t side;
+    uint8_t oneway;
+    char descriptor[kDescriptorSize];
+    std::atomic<uint64_t> totalUs[kShards];
+    std::atomic<uint32_t> counts[kShards][kBuckets];
+};
+
+constexpr uint64_t bucketStartUs(size_t bucket) {
+    constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const size_t octave = bucket / kSubBuckets + kSubBucketBits - 1;
+    return (uint64_t)(kSubBuckets + bucket % kSubBuckets) << (octave - kSubBucketBits);
+}
+
+// Returns true if transactions should be timed and passed to record().
+bool isEnabled();
+
+// Remembers the interface token that Java wrote to parcel, so that the client side can key the
+// transaction without asking the remote object for its descriptor, which is itself a transaction.
+void noteInterfaceToken(const Parcel* parcel, const String16& descriptor);
+
+// Returns the token noted for parcel on this thread, or an empty string if there is none, and
+// forgets it.
+String16 takeInterfaceToken(const Parcel* parcel);
+
+void record(Side side, const String16& descriptor, uint32_t code, bool oneway, nsecs_t duration);
+
+} // namespace binder_latency
+
+} // namespace android
+
+#endif // ANDROID_UTIL_BINDER_LATENCY_H
@@ -154,11 +154,8 @@ static jint android_util_MemoryIntArray_get(JNIEnv* env, jobject clazz,
         return -1;
     }
 
-    if (!ashmem_valid(fd)) {
-        jniThrowIOException(env, errno);
-        return -1;
-    }
-
+    // The fd was checked to be ashmem when the array was opened, and it stays open until the
+    // array is closed. Checking it again on every element access would only add syscalls.
     if (ashmem_pin_region(fd, 0, 0) == ASHMEM_WAS_PURGED) {
         jniThrowException(env, "java/io/IOException", "ashmem region was purged");
         return -1;
@@ -176,11 +173,7 @@ static void android_util_MemoryIntArray_set(JNIEnv* env, jobject clazz,
         return;
     }
 
-    if (!ashmem_valid(fd)) {
-        jniThrowIOException(env, errno);
-        return;
-    }
-
+    // See android_util_MemoryIntArray_get().
     if (ashmem_pin_region(fd, 0, 0) == ASHMEM_WAS_PURGED) {
         jniThrowException(env, "java/io/IOException", "ashmem region was purged");
         return;
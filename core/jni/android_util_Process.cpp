@@ -782,22 +782,16 @@ void android_os_Process_readProcLines(JNIEnv* env, jobject clazz, jstring fileSt
         }
     }
 
-    jlong* sizesArray = env->GetLongArrayElements(outFields, 0);
-    if (sizesArray == NULL) {
-        return;
-    }
-
     int fd = open(file.string(), O_RDONLY | O_CLOEXEC);
 
     if (fd >= 0) {
-        //ALOGI("Clearing %" PRId32 " sizes", count);
-        for (i=0; i<count; i++) {
-            sizesArray[i] = 0;
-        }
+        // The values are gathered here and copied out in one go, rather than
+        // holding on to the Java array while the file is read.
+        std::vector<jlong> sizesArray(count);
 
         const size_t BUFFER_SIZE = 4096;
-        char* buffer = (char*)malloc(BUFFER_SIZE);
-        int len = read(fd, buffer, BUFFER_SIZE-1);
+        char buffer[BUFFER_SIZE];
+        int len = TEMP_FAILURE_RETRY(read(fd, buffer, BUFFER_SIZE-1));
         close(fd);
 
         if (len < 0) {
@@ -841,13 +835,12 @@ void android_os_Process_readProcLines(JNIEnv* env, jobject clazz, jstring fileSt
             }
         }
 
-        free(buffer);
+        env->SetLongArrayRegion(outFields, 0, count, sizesArray.data());
     } else {
         ALOGW("Unable to open %s", file.string());
     }
 
     //ALOGI("Done!");
-    env->ReleaseLongArrayElements(outFields, sizesArray, 0);
 }
 
 jintArray android_os_Process_getPids(JNIEnv* env, jobject clazz,
@@ -108,7 +108,7 @@ void NativeDisplayEventReceiver::dispose() {
     DisplayEventDispatcher::dispose();
 }
 
-static jobject createJavaVsyncEventData(JNIEnv* env, VsyncEventData vsyncEventData) {
+static jobject createJavaVsyncEventData(JNIEnv* env, const VsyncEventData& vsyncEventData) {
     ScopedLocalRef<jobjectArray>
             frameTimelineObjs(env,
                               env->NewObjectArray(VsyncEventData::kFrameTimelinesLength,
@@ -116,7 +116,7 @@ static jobject createJavaVsyncEventData(JNIEnv* env, VsyncEventData vsyncEventDa
                                                           .frameTimelineClassInfo.clazz,
                                                   /*initial element*/ NULL));
     for (int i = 0; i < VsyncEventData::kFrameTimelinesLength; i++) {
-        VsyncEventData::FrameTimeline frameTimeline = vsyncEventData.frameTimelines[i];
+        const VsyncEventData::FrameTimeline& frameTimeline = vsyncEventData.frameTimelines[i];
         ScopedLocalRef<jobject>
                 frameTimelineObj(env,
                                  env->NewObject(gDisplayEventReceiverClassInfo
@@ -142,9 +142,12 @@ void NativeDisplayEventReceiver::dispatchVsync(nsecs_t timestamp, PhysicalDispla
     if (receiverObj.get()) {
         ALOGV("receiver %p ~ Invoking vsync handler.", this);
 
-        jobject javaVsyncEventData = createJavaVsyncEventData(env, vsyncEventData);
+        // This runs at the display refresh rate, possibly several times in one looper poll, so
+        // the event data is released here rather than left to the enclosing JNI frame.
+        ScopedLocalRef<jobject> javaVsyncEventData(env,
+                                                   createJavaVsyncEventData(env, vsyncEventData));
         env->CallVoidMethod(receiverObj.get(), gDisplayEventReceiverClassInfo.dispatchVsync,
-                            timestamp, displayId.value, count, javaVsyncEventData);
+                            timestamp, displayId.value, count, javaVsyncEventData.get());
         ALOGV("receiver %p ~ Returned from vsync handler.", this);
     }
 
@@ -192,20 +195,28 @@ void NativeDisplayEventReceiver::dispatchFrameRateOverrides(
                 gDisplayEventReceiverClassInfo.frameRateOverrideClassInfo.clazz;
         const auto frameRateOverrideInit =
                 gDisplayEventReceiverClassInfo.frameRateOverrideClassInfo.init;
-        auto frameRateOverrideInitObject =
-                env->NewObject(frameRateOverrideClass, frameRateOverrideInit, 0, 0);
-        auto frameRateOverrideArray = env->NewObjectArray(overrides.size(), frameRateOverrideClass,
-                                                          frameRateOverrideInitObject);
+        ScopedLocalRef<jobject>
+                frameRateOverrideInitObject(env,
+                                            env->NewObject(frameRateOverrideClass,
+                                                           frameRateOverrideInit, 0, 0));
+        ScopedLocalRef<jobjectArray>
+                frameRateOverrideArray(env,
+                                       env->NewObjectArray(overrides.size(),
+                                                           frameRateOverrideClass,
+                                                           frameRateOverrideInitObject.get()));
         for (size_t i = 0; i < overrides.size(); i++) {
-            auto FrameRateOverrideObject =
-                    env->NewObject(frameRateOverrideClass, frameRateOverrideInit, overrides[i].uid,
-                                   overrides[i].frameRateHz);
-            env->SetObjectArrayElement(frameRateOverrideArray, i, FrameRateOverrideObject);
+            ScopedLocalRef<jobject>
+                    FrameRateOverrideObject(env,
+                                            env->NewObject(frameRateOverrideClass,
+                                                           frameRateOverrideInit, overrides[i].uid,
+                                                           overrides[i].frameRateHz));
+            env->SetObjectArrayElement(frameRateOverrideArray.get(), i,
+                                       FrameRateOverrideObject.get());
         }
 
         env->CallVoidMethod(receiverObj.get(),
                             gDisplayEventReceiverClassInfo.dispatchFrameRateOverrides, timestamp,
-                            displayId.value, frameRateOverrideArray);
+                            displayId.value, frameRateOverrideArray.get());
         ALOGV("receiver %p ~ Returned from FrameRateOverride handler.", this);
     }
 
@@ -468,6 +468,11 @@ status_t NativeInputEventReceiver::consumeEvents(JNIEnv* env,
                 inputEventObj = nullptr;
             }
 
+            // Events are handed over one call at a time. The Java objects already come from the
+            // KeyEvent and MotionEvent pools, and a consumed batch of motion samples arrives as
+            // a single MotionEvent with history, so the per-call cost is one JNI transition.
+            // Handing over several events per call would change the dispatchInputEvent contract
+            // of InputEventReceiver.java, which finishes each seq separately.
             if (inputEventObj) {
                 if (kDebugDispatchCycle) {
                     ALOGD("channel '%s' ~ Dispatching input event.", getInputChannelName().c_str());
@@ -60,22 +60,42 @@ private:
     int32_t mActivePointerId;
     BitSet32 mCalculatedIdBits;
     Velocity mCalculatedVelocity[MAX_POINTERS];
+
+    // Whether mCalculatedVelocity holds the velocities of the current samples for
+    // mCalculatedUnits and mCalculatedMaxVelocity. Views of a nested scroll each compute
+    // the velocity on ACTION_UP, for the same samples.
+    bool mCalculatedValid;
+    int32_t mCalculatedUnits;
+    float mCalculatedMaxVelocity;
 };
 
 VelocityTrackerState::VelocityTrackerState(const VelocityTracker::Strategy strategy)
-      : mVelocityTracker(strategy), mActivePointerId(-1) {}
+      : mVelocityTracker(strategy),
+        mActivePointerId(-1),
+        mCalculatedValid(false),
+        mCalculatedUnits(0),
+        mCalculatedMaxVelocity(0) {}
 
 void VelocityTrackerState::clear() {
     mVelocityTracker.clear();
     mActivePointerId = -1;
     mCalculatedIdBits.clear();
+    mCalculatedValid = false;
 }
 
 void VelocityTrackerState::addMovement(const MotionEvent* event) {
     mVelocityTracker.addMovement(event);
+    mCalculatedValid = false;
 }
 
 void VelocityTrackerState::computeCurrentVelocity(int32_t units, float maxVelocity) {
+    if (mCalculatedValid && units == mCalculatedUnits && maxVelocity == mCalculatedMaxVelocity) {
+        return;
+    }
+    mCalculatedValid = true;
+    mCalculatedUnits = units;
+    mCalculatedMaxVelocity = maxVelocity;
+
     BitSet32 idBits(mVelocityTracker.getCurrentPointerIdBits());
     mCalculatedIdBits = idBits;
 
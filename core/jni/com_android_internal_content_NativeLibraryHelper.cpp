@@ -36,9 +36,15 @@
 #include <inttypes.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
 #include <linux/fs.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define APK_LIB "lib/"
 #define APK_LIB_LEN (sizeof(APK_LIB) - 1)
@@ -54,6 +60,9 @@
 #define TMP_FILE_PATTERN "/tmp.XXXXXX"
 #define TMP_FILE_PATTERN_LEN (sizeof(TMP_FILE_PATTERN) - 1)
 
+// Libraries are extracted by up to this many threads at once.
+#define MAX_COPY_THREADS 4
+
 namespace android {
 
 // These match PackageManager.java install codes
@@ -166,33 +175,29 @@ sumFiles(JNIEnv*, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntry, const char
     return INSTALL_SUCCEEDED;
 }
 
+struct CopyNativeBinariesArgs {
+    bool extractNativeLibs;
+    // The names of the entries to extract, in the order they are in the APK.
+    std::vector<std::string> entryNames;
+};
+
 /*
- * Copy the native library if needed.
- *
- * This function assumes the library and path names passed in are considered safe.
+ * Check a native library that is to be loaded from the APK, or note it
+ * down to be extracted by copyFilesIfChanged.
  */
 static install_status_t
-copyFileIfChanged(JNIEnv *env, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntry, const char* fileName)
+collectFileToCopy(JNIEnv*, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntry, const char* fileName)
 {
-    void** args = reinterpret_cast<void**>(arg);
-    jstring* javaNativeLibPath = (jstring*) args[0];
-    jboolean extractNativeLibs = *(jboolean*) args[1];
-
-    ScopedUtfChars nativeLibPath(env, *javaNativeLibPath);
-
-    uint32_t uncompLen;
-    uint32_t when;
-    uint32_t crc;
+    CopyNativeBinariesArgs* args = reinterpret_cast<CopyNativeBinariesArgs*>(arg);
 
-    uint16_t method;
-    off64_t offset;
-
-    if (!zipFile->getEntryInfo(zipEntry, &method, &uncompLen, NULL, &offset, &when, &crc)) {
-        ALOGE("Couldn't read zip entry info\n");
-        return INSTALL_FAILED_INVALID_APK;
-    }
+    if (!args->extractNativeLibs) {
+        uint16_t method;
+        off64_t offset;
+        if (!zipFile->getEntryInfo(zipEntry, &method, NULL, NULL, &offset, NULL, NULL)) {
+            ALOGE("Couldn't read zip entry info\n");
+            return INSTALL_FAILED_INVALID_APK;
+        }
 
-    if (!extractNativeLibs) {
         // check if library is uncompressed and page-aligned
         if (method != ZipFileRO::kCompressStored) {
             ALOGE("Library '%s' is compressed - will not be able to open it directly from apk.\n",
@@ -209,6 +214,64 @@ copyFileIfChanged(JNIEnv *env, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntr
         return INSTALL_SUCCEEDED;
     }
 
+    char entryName[PATH_MAX];
+    if (zipFile->getEntryFileName(zipEntry, entryName, sizeof(entryName))) {
+        return INSTALL_FAILED_INVALID_APK;
+    }
+    args->entryNames.push_back(entryName);
+    return INSTALL_SUCCEEDED;
+}
+
+/*
+ * Copy a stored entry to fd within the kernel, so that its data doesn't
+ * pass through this process. Returns false if the kernel or filesystems
+ * can't, in which case the entry should be extracted as usual.
+ */
+static bool
+copyStoredEntry(const ZipFileRO* zipFile, off64_t offset, uint32_t length, int fd)
+{
+    const int apkFd = zipFile->getFileDescriptor();
+    if (apkFd < 0) {
+        return false;
+    }
+
+    // The offsets are passed explicitly, so neither file position moves and
+    // the regular extraction can start over from the beginning of fd.
+    off64_t outOffset = 0;
+    while (length > 0) {
+        const ssize_t copied = syscall(__NR_copy_file_range, apkFd, &offset, fd, &outOffset,
+                static_cast<size_t>(length), 0);
+        if (copied <= 0) {
+            ALOGV("copy_file_range stopped with %zd: %s", copied, strerror(errno));
+            return false;
+        }
+        length -= copied;
+    }
+    return true;
+}
+
+/*
+ * Copy the native library if needed. Sets *copied if the library was
+ * written out.
+ *
+ * This function assumes the library and path names passed in are considered safe.
+ */
+static install_status_t
+copyFileIfChanged(const ZipFileRO* zipFile, ZipEntryRO zipEntry, const char* fileName,
+        const std::string& nativeLibPath, bool* copied)
+{
+    uint32_t uncompLen;
+    uint32_t when;
+    uint32_t crc;
+
+    uint16_t method;
+    off64_t offset;
+
+    if (!zipFile->getEntryInfo(zipEntry, &method, &uncompLen, NULL, &offset, &when, &crc)) {
+        ALOGE("Couldn't read zip entry info\n");
+        return INSTALL_FAILED_INVALID_APK;
+    }
+
     // Build local file path
     const size_t fileNameLen = strlen(fileName);
     char localFileName[nativeLibPath.size() + fileNameLen + 2];
@@ -264,7 +327,8 @@ copyFileIfChanged(JNIEnv *env, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntr
         ioctl(fd, FS_IOC_SETFLAGS, &flags);
     }
 
-    if (!zipFile->uncompressEntry(zipEntry, fd)) {
+    if (!(method == ZipFileRO::kCompressStored && copyStoredEntry(zipFile, offset, uncompLen, fd))
+            && !zipFile->uncompressEntry(zipEntry, fd)) {
         ALOGE("Failed uncompressing %s to %s\n", fileName, localTmpFileName);
         close(fd);
         unlink(localTmpFileName);
@@ -301,9 +365,77 @@ copyFileIfChanged(JNIEnv *env, void* arg, ZipFileRO* zipFile, ZipEntryRO zipEntr
 
     ALOGV("Successfully moved %s to %s\n", localTmpFileName, localFileName);
 
+    *copied = true;
     return INSTALL_SUCCEEDED;
 }
 
+/*
+ * Copy the named native libraries if needed, spread over a few threads.
+ * The directory is synced once at the end rather than for each library.
+ */
+static install_status_t
+copyFilesIfChanged(const ZipFileRO* zipFile, const std::vector<std::string>& entryNames,
+        const std::string& nativeLibPath)
+{
+    std::atomic<size_t> nextEntry(0);
+    std::atomic<bool> anyCopied(false);
+    std::atomic<install_status_t> status(INSTALL_SUCCEEDED);
+
+    auto copyEntries = [&]() {
+        size_t i;
+        while (status.load(std::memory_order_relaxed) == INSTALL_SUCCEEDED
+                && (i = nextEntry.fetch_add(1, std::memory_order_relaxed)) < entryNames.size()) {
+            // The entry handed out by the iteration is reused for the next
+            // entry, so each thread looks its entries up again.
+            const char* entryName = entryNames[i].c_str();
+            ZipEntryRO entry = zipFile->findEntryByName(entryName);
+            if (entry == NULL) {
+                status = INSTALL_FAILED_INVALID_APK;
+                return;
+            }
+
+            bool copied = false;
+            install_status_t ret = copyFileIfChanged(zipFile, entry, strrchr(entryName, '/') + 1,
+                    nativeLibPath, &copied);
+            zipFile->releaseEntry(entry);
+            if (copied) {
+                anyCopied.store(true, std::memory_order_relaxed);
+            }
+            if (ret != INSTALL_SUCCEEDED) {
+                ALOGV("Failure for entry %s", entryName);
+                install_status_t expected = INSTALL_SUCCEEDED;
+                status.compare_exchange_strong(expected, ret);
+                return;
+            }
+        }
+    };
+
+    const size_t numThreads = std::min({static_cast<size_t>(MAX_COPY_THREADS), entryNames.size(),
+            static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()))});
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; i++) {
+        threads.emplace_back(copyEntries);
+    }
+    copyEntries();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (status == INSTALL_SUCCEEDED && anyCopied) {
+        int dirFd = TEMP_FAILURE_RETRY(open(nativeLibPath.c_str(),
+                O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (dirFd < 0 || fsync(dirFd) < 0) {
+            ALOGE("Couldn't sync %s: %s\n", nativeLibPath.c_str(), strerror(errno));
+            status = INSTALL_FAILED_CONTAINER_ERROR;
+        }
+        if (dirFd >= 0) {
+            close(dirFd);
+        }
+    }
+
+    return status;
+}
+
 /*
  * An iterator over all shared libraries in a zip file. An entry is
  * considered to be a shared library if all of the conditions below are
@@ -499,9 +631,20 @@ com_android_internal_content_NativeLibraryHelper_copyNativeBinaries(JNIEnv *env,
         jlong apkHandle, jstring javaNativeLibPath, jstring javaCpuAbi,
         jboolean extractNativeLibs, jboolean debuggable)
 {
-    void* args[] = { &javaNativeLibPath, &extractNativeLibs };
-    return (jint) iterateOverNativeFiles(env, apkHandle, javaCpuAbi, debuggable,
-            copyFileIfChanged, reinterpret_cast<void*>(args));
+    CopyNativeBinariesArgs args = { extractNativeLibs == JNI_TRUE, {} };
+    install_status_t ret = iterateOverNativeFiles(env, apkHandle, javaCpuAbi, debuggable,
+            collectFileToCopy, &args);
+    if (ret != INSTALL_SUCCEEDED || args.entryNames.empty()) {
+        return (jint) ret;
+    }
+
+    ScopedUtfChars nativeLibPath(env, javaNativeLibPath);
+    if (nativeLibPath.c_str() == NULL) {
+        return (jint) INSTALL_FAILED_INTERNAL_ERROR;
+    }
+
+    ZipFileRO* zipFile = reinterpret_cast<ZipFileRO*>(apkHandle);
+    return (jint) copyFilesIfChanged(zipFile, args.entryNames, nativeLibPath.c_str());
 }
 
 static jlong
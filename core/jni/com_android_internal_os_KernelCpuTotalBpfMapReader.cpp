@@ -24,7 +24,11 @@ static jlongArray KernelCpuTotalBpfMapReader_readInternal(JNIEnv *env, jobject)
     auto freqTimes = android::bpf::getTotalCpuFreqTimes();
     if (!freqTimes) return nullptr;
 
+    size_t count = 0;
+    for (const auto &vec : *freqTimes) count += vec.size();
+
     std::vector<uint64_t> allTimes;
+    allTimes.reserve(count);
     for (const auto &vec : *freqTimes) {
         for (const auto &timeNs : vec) {
             allTimes.push_back(timeNs / 1000000);
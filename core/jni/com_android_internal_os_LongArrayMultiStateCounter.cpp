@@ -18,7 +18,6 @@
 #include <android/binder_parcel_jni.h>
 #include <android/binder_parcel_utils.h>
 #include <android_runtime/Log.h>
-#include <nativehelper/ScopedPrimitiveArray.h>
 
 #include <cstring>
 
@@ -223,21 +222,21 @@ static jlong native_getReleaseFunc_LongArrayContainer() {
 static void native_setValues_LongArrayContainer(JNIEnv *env, jobject self, jlong nativePtr,
                                                 jlongArray jarray) {
     std::vector<uint64_t> *vector = reinterpret_cast<std::vector<uint64_t> *>(nativePtr);
-    ScopedLongArrayRO scopedArray(env, jarray);
-    const uint64_t *array = reinterpret_cast<const uint64_t *>(scopedArray.get());
-    uint8_t size = scopedArray.size();
 
-    // Boundary checks are performed in the Java layer
-    std::copy(array, array + size, vector->data());
+    // Boundary checks are performed in the Java layer. This is called for every UID on each
+    // battery stats update, so the values are copied straight into the container rather than
+    // through a pinned or copied view of the array.
+    env->GetLongArrayRegion(jarray, 0, env->GetArrayLength(jarray),
+                            reinterpret_cast<jlong *>(vector->data()));
 }
 
 static void native_getValues_LongArrayContainer(JNIEnv *env, jobject self, jlong nativePtr,
                                                 jlongArray jarray) {
     std::vector<uint64_t> *vector = reinterpret_cast<std::vector<uint64_t> *>(nativePtr);
-    ScopedLongArrayRW scopedArray(env, jarray);
 
     // Boundary checks are performed in the Java layer
-    std::copy(vector->data(), vector->data() + vector->size(), scopedArray.get());
+    env->SetLongArrayRegion(jarray, 0, vector->size(),
+                            reinterpret_cast<const jlong *>(vector->data()));
 }
 
 static const JNINativeMethod g_LongArrayContainer_methods[] = {
@@ -2318,8 +2318,16 @@ int zygote::forkApp(JNIEnv* env,
       fds_to_ignore.insert(fds_to_ignore.end(), gPreloadFds->begin(), gPreloadFds->end());
   }
 
-  return zygote::ForkCommon(env, /* is_system_server= */ false, fds_to_close,
-                            fds_to_ignore, is_priority_fork == JNI_TRUE, purge);
+  pid_t pid = zygote::ForkCommon(env, /* is_system_server= */ false, fds_to_close,
+                                 fds_to_ignore, is_priority_fork == JNI_TRUE, purge);
+  if (pid == 0 && !args_known) {
+    // A USAP waits in the pool for the command that specializes it. Every app
+    // gets a mount namespace of its own in SpecializeCommon(), so create it now,
+    // taking the copy of the mount table off the path of the app launch.
+    auto fail_fn = std::bind(zygote::ZygoteFailure, env, "usap", nullptr, _1);
+    ensureInAppMountNamespace(fail_fn);
+  }
+  return pid;
 }
 
 static void com_android_internal_os_Zygote_nativeAllowFileAcrossFork(
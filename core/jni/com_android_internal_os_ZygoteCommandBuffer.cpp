@@ -289,18 +289,28 @@ class NativeCommandBuffer {
 
 static int buffersAllocd(0);
 
+// The Java code gets and frees a buffer for every request it handles. The zygote keeps the
+// mapping of a freed buffer for the next request rather than mapping a new one each time.
+// sBufferMemPid is the process that mapped sBufferMem; a process forked from it
+// unmaps the buffer when freeing it, so that it doesn't keep commands meant for the zygote.
+static void* sSpareBufferMem = nullptr;
+static pid_t sBufferMemPid = 0;
+
 // Get a new NativeCommandBuffer. Can only be called once between freeNativeBuffer calls,
 // so that only one buffer exists at a time.
 jlong com_android_internal_os_ZygoteCommandBuffer_getNativeBuffer(JNIEnv* env, jclass, jint fd) {
   CHECK(buffersAllocd == 0);
   ++buffersAllocd;
-  // MMap explicitly to get it page aligned.
-  void *bufferMem = mmap(NULL, sizeof(NativeCommandBuffer), PROT_READ | PROT_WRITE,
-                         MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
-  // Currently we mmap and unmap one for every request handled by the Java code.
-  // That could be improved, but unclear it matters.
-  if (bufferMem == MAP_FAILED) {
-    ZygoteFailure(env, nullptr, nullptr, "Failed to map argument buffer");
+  void *bufferMem = sSpareBufferMem;
+  sSpareBufferMem = nullptr;
+  if (bufferMem == nullptr) {
+    // MMap explicitly to get it page aligned.
+    bufferMem = mmap(NULL, sizeof(NativeCommandBuffer), PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (bufferMem == MAP_FAILED) {
+      ZygoteFailure(env, nullptr, nullptr, "Failed to map argument buffer");
+    }
+    sBufferMemPid = getpid();
   }
   return (jlong) new(bufferMem) NativeCommandBuffer(fd);
 }
@@ -311,7 +321,12 @@ void com_android_internal_os_ZygoteCommandBuffer_freeNativeBuffer(JNIEnv* env, j
   CHECK(buffersAllocd == 1);
   NativeCommandBuffer* n_buffer = reinterpret_cast<NativeCommandBuffer*>(j_buffer);
   n_buffer->~NativeCommandBuffer();
-  if (munmap(n_buffer, sizeof(NativeCommandBuffer)) != 0) {
+  if (getpid() == sBufferMemPid) {
+    // Wipe the commands handled so far, so that a child forked while a later command is
+    // being handled doesn't inherit them.
+    memset(static_cast<void*>(n_buffer), 0, sizeof(NativeCommandBuffer));
+    sSpareBufferMem = n_buffer;
+  } else if (munmap(n_buffer, sizeof(NativeCommandBuffer)) != 0) {
     ZygoteFailure(env, nullptr, nullptr, "Failed to unmap argument buffer");
   }
   --buffersAllocd;
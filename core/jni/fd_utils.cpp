@@ -476,21 +476,24 @@ void FileDescriptorInfo::DetachSocket(fail_fn_t fail_fn) const {
 // TODO: Move the definitions here and eliminate the forward declarations. They
 // temporarily help making code reviews easier.
 static int ParseFd(dirent* dir_entry, int dir_fd);
-static std::unique_ptr<std::set<int>> GetOpenFdsIgnoring(const std::vector<int>& fds_to_ignore,
-                                                         fail_fn_t fail_fn);
+static std::vector<int> GetOpenFdsIgnoring(const std::vector<int>& fds_to_ignore,
+                                           fail_fn_t fail_fn);
 
 FileDescriptorTable* FileDescriptorTable::Create(const std::vector<int>& fds_to_ignore,
                                                  fail_fn_t fail_fn) {
-  std::unique_ptr<std::set<int>> open_fds = GetOpenFdsIgnoring(fds_to_ignore, fail_fn);
+  const std::vector<int> open_fds = GetOpenFdsIgnoring(fds_to_ignore, fail_fn);
   std::unordered_map<int, FileDescriptorInfo*> open_fd_map;
-  for (auto fd : *open_fds) {
+  for (auto fd : open_fds) {
     open_fd_map[fd] = FileDescriptorInfo::CreateFromFd(fd, fail_fn);
   }
   return new FileDescriptorTable(open_fd_map);
 }
 
-static std::unique_ptr<std::set<int>> GetOpenFdsIgnoring(const std::vector<int>& fds_to_ignore,
-                                                         fail_fn_t fail_fn) {
+// Returns the sorted list of file descriptors currently open by the process, less
+// |fds_to_ignore|. This runs before every fork, so it fills a vector rather than allocating a
+// set node per descriptor.
+static std::vector<int> GetOpenFdsIgnoring(const std::vector<int>& fds_to_ignore,
+                                           fail_fn_t fail_fn) {
   DIR* proc_fd_dir = opendir(kFdPath);
   if (proc_fd_dir == nullptr) {
     fail_fn(android::base::StringPrintf("Unable to open directory %s: %s",
@@ -498,7 +501,7 @@ static std::unique_ptr<std::set<int>> GetOpenFdsIgnoring(const std::vector<int>&
                                         strerror(errno)));
   }
 
-  auto result = std::make_unique<std::set<int>>();
+  std::vector<int> result;
   int dir_fd = dirfd(proc_fd_dir);
   dirent* dir_entry;
   while ((dir_entry = readdir(proc_fd_dir)) != nullptr) {
@@ -511,26 +514,27 @@ static std::unique_ptr<std::set<int>> GetOpenFdsIgnoring(const std::vector<int>&
       continue;
     }
 
-    result->insert(fd);
+    result.push_back(fd);
   }
 
   if (closedir(proc_fd_dir) == -1) {
     fail_fn(android::base::StringPrintf("Unable to close directory: %s", strerror(errno)));
   }
+  std::sort(result.begin(), result.end());
   return result;
 }
 
 std::unique_ptr<std::set<int>> GetOpenFds(fail_fn_t fail_fn) {
   const std::vector<int> nothing_to_ignore;
-  return GetOpenFdsIgnoring(nothing_to_ignore, fail_fn);
+  const std::vector<int> open_fds = GetOpenFdsIgnoring(nothing_to_ignore, fail_fn);
+  return std::make_unique<std::set<int>>(open_fds.begin(), open_fds.end());
 }
 
 void FileDescriptorTable::Restat(const std::vector<int>& fds_to_ignore, fail_fn_t fail_fn) {
-  std::unique_ptr<std::set<int>> open_fds = GetOpenFdsIgnoring(fds_to_ignore, fail_fn);
+  const std::vector<int> open_fds = GetOpenFdsIgnoring(fds_to_ignore, fail_fn);
 
-  // Check that the files did not change, and leave only newly opened FDs in
-  // |open_fds|.
-  RestatInternal(*open_fds, fail_fn);
+  // Check that the files did not change, and add newly opened FDs to the table.
+  RestatInternal(open_fds, fail_fn);
 }
 
 // Reopens all file descriptors that are contained in the table.
@@ -557,7 +561,7 @@ FileDescriptorTable::~FileDescriptorTable() {
     }
 }
 
-void FileDescriptorTable::RestatInternal(std::set<int>& open_fds, fail_fn_t fail_fn) {
+void FileDescriptorTable::RestatInternal(const std::vector<int>& open_fds, fail_fn_t fail_fn) {
   // ART creates a file through memfd for optimization purposes. We make sure
   // there is at most one being created.
   bool art_memfd_seen = false;
@@ -571,8 +575,7 @@ void FileDescriptorTable::RestatInternal(std::set<int>& open_fds, fail_fn_t fail
   // We'll only store the last error message.
   std::unordered_map<int, FileDescriptorInfo*>::iterator it = open_fd_map_.begin();
   while (it != open_fd_map_.end()) {
-    std::set<int>::const_iterator element = open_fds.find(it->first);
-    if (element == open_fds.end()) {
+    if (!std::binary_search(open_fds.begin(), open_fds.end(), it->first)) {
       // The entry from the file descriptor table is no longer in the list
       // of open files. We warn about this condition and remove it from
       // the list of FDs under consideration.
@@ -588,7 +591,7 @@ void FileDescriptorTable::RestatInternal(std::set<int>& open_fds, fail_fn_t fail
         // The file descriptor refers to a different description. We must
         // update our entry in the table.
         delete it->second;
-        it->second = FileDescriptorInfo::CreateFromFd(*element, fail_fn);
+        it->second = FileDescriptorInfo::CreateFromFd(it->first, fail_fn);
       } else {
         // It's the same file. Nothing to do here. Move on to the next open
         // FD.
@@ -603,25 +606,19 @@ void FileDescriptorTable::RestatInternal(std::set<int>& open_fds, fail_fn_t fail
       }
 
       ++it;
-
-      // Finally, remove the FD from the set of open_fds. We do this last because
-      // |element| will not remain valid after a call to erase.
-      open_fds.erase(element);
     }
   }
 
-  if (open_fds.size() > 0) {
-    // The zygote has opened new file descriptors since our last inspection.
-    // We warn about this condition and add them to our table.
-    //
-    // TODO(narayan): This will be an error in a future android release.
-    // error = true;
-    // ALOGW("Zygote opened %zd new file descriptor(s).", open_fds.size());
-
-    // TODO(narayan): This code will be removed in a future android release.
-    std::set<int>::const_iterator it;
-    for (it = open_fds.begin(); it != open_fds.end(); ++it) {
-      const int fd = (*it);
+  // Any open FD that is not in the table yet was opened by the zygote since our
+  // last inspection. We add these to our table.
+  //
+  // TODO(narayan): This will be an error in a future android release.
+  // error = true;
+  // ALOGW("Zygote opened new file descriptor %d.", fd);
+  //
+  // TODO(narayan): This code will be removed in a future android release.
+  for (const int fd : open_fds) {
+    if (open_fd_map_.find(fd) == open_fd_map_.end()) {
       open_fd_map_[fd] = FileDescriptorInfo::CreateFromFd(fd, fail_fn);
     }
   }
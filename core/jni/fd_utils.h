@@ -100,7 +100,8 @@ class FileDescriptorTable {
  private:
   explicit FileDescriptorTable(const std::unordered_map<int, FileDescriptorInfo*>& map);
 
-  void RestatInternal(std::set<int>& open_fds, fail_fn_t fail_fn);
+  // Checks the table against |open_fds|, which must be sorted.
+  void RestatInternal(const std::vector<int>& open_fds, fail_fn_t fail_fn);
 
   // Invariant: All values in this unordered_map are non-NULL.
   std::unordered_map<int, FileDescriptorInfo*> open_fd_map_;
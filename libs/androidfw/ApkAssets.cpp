@@ -16,6 +16,10 @@
 
 #include "androidfw/ApkAssets.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "android-base/errors.h"
 #include "android-base/logging.h"
 
@@ -43,6 +47,46 @@ std::unique_ptr<ApkAssets> ApkAssets::Load(const std::string& path, package_prop
   return Load(ZipAssetsProvider::Create(path, flags), flags);
 }
 
+std::vector<std::future<std::unique_ptr<ApkAssets>>> ApkAssets::LoadAsync(
+    std::vector<LoadRequest> requests, size_t max_threads) {
+  struct Batch {
+    std::vector<LoadRequest> requests;
+    std::vector<std::promise<std::unique_ptr<ApkAssets>>> results;
+    std::atomic<size_t> next_request{0U};
+  };
+
+  auto batch = std::make_shared<Batch>();
+  batch->requests = std::move(requests);
+  batch->results.resize(batch->requests.size());
+
+  std::vector<std::future<std::unique_ptr<ApkAssets>>> futures;
+  futures.reserve(batch->results.size());
+  for (auto& result : batch->results) {
+    futures.push_back(result.get_future());
+  }
+
+  // Each worker takes the next request that nobody started on, so a slow APK does not hold back
+  // the ones queued after it. The batch stays alive until the last worker exits.
+  auto worker = [batch]() {
+    while (true) {
+      const size_t i = batch->next_request.fetch_add(1U);
+      if (i >= batch->requests.size()) {
+        return;
+      }
+      const LoadRequest& request = batch->requests[i];
+      batch->results[i].set_value(request.overlay ? LoadOverlay(request.path, request.flags)
+                                                  : Load(request.path, request.flags));
+    }
+  };
+
+  const size_t thread_count = std::min(std::max<size_t>(max_threads, 1U),
+                                       batch->requests.size());
+  for (size_t i = 0; i < thread_count; i++) {
+    std::thread(worker).detach();
+  }
+  return futures;
+}
+
 std::unique_ptr<ApkAssets> ApkAssets::LoadFromFd(base::unique_fd fd,
                                                  const std::string& debug_name,
                                                  package_property_t flags,
@@ -40,6 +40,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 using namespace android;
 
 #ifndef O_BINARY
@@ -48,6 +52,48 @@ using namespace android;
 
 static const bool kIsDebug = false;
 
+/*
+ * Apply the madvise() hint matching "mode" to the pages of "map".
+ */
+static bool adviseMap(const incfs::IncFsFileMap& map, Asset::AccessMode mode)
+{
+#ifndef _WIN32
+    int advice;
+    switch (mode) {
+    case Asset::ACCESS_RANDOM:
+        advice = MADV_RANDOM;
+        break;
+    case Asset::ACCESS_STREAMING:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case Asset::ACCESS_BUFFER:
+        advice = MADV_WILLNEED;
+        break;
+    default:
+        advice = MADV_NORMAL;
+        break;
+    }
+
+    if (map.length() == 0) {
+        return false;
+    }
+
+    // The mapping itself starts on a page boundary at or before the data.
+    static const uintptr_t kPageMask = ~(uintptr_t(sysconf(_SC_PAGESIZE)) - 1);
+    const uintptr_t start = reinterpret_cast<uintptr_t>(map.unsafe_data()) & kPageMask;
+    const uintptr_t end = reinterpret_cast<uintptr_t>(map.unsafe_data()) + map.length();
+    if (madvise(reinterpret_cast<void*>(start), end - start, advice) != 0) {
+        ALOGV("madvise(%d) failed for %zu bytes: %s", advice, map.length(), strerror(errno));
+        return false;
+    }
+    return true;
+#else
+    (void) map;
+    (void) mode;
+    return false;
+#endif
+}
+
 static Mutex gAssetLock;
 static int32_t gCount = 0;
 static Asset* gHead = NULL;
@@ -311,6 +357,9 @@ Asset::Asset(void)
 
     // We succeeded, so relinquish control of dataMap
     pAsset->mAccessMode = mode;
+    if (mode == ACCESS_STREAMING || mode == ACCESS_BUFFER) {
+        pAsset->adviseAccess(mode);
+    }
     return std::move(pAsset);
 }
 
@@ -330,6 +379,9 @@ Asset::Asset(void)
 
   // We succeeded, so relinquish control of dataMap
   pAsset->mAccessMode = mode;
+  if (mode == ACCESS_STREAMING || mode == ACCESS_BUFFER) {
+      pAsset->adviseAccess(mode);
+  }
   return std::move(pAsset);
 }
 
@@ -697,6 +749,14 @@ int _FileAsset::openFileDescriptor(off64_t* outStart, off64_t* outLength) const
     return open(mFileName, O_RDONLY | O_BINARY);
 }
 
+bool _FileAsset::adviseAccess(AccessMode mode)
+{
+    if (!mMap.has_value() || mBuf != NULL) {
+        return false;
+    }
+    return adviseMap(*mMap, mode);
+}
+
 incfs::map_ptr<void> _FileAsset::ensureAlignment(const incfs::IncFsFileMap& map)
 {
     const auto data = map.data();
@@ -955,3 +1015,13 @@ bail:
 incfs::map_ptr<void> _CompressedAsset::getIncFsBuffer(bool aligned) {
     return incfs::map_ptr<void>(getBuffer(aligned));
 }
+
+bool _CompressedAsset::adviseAccess(AccessMode mode)
+{
+    if (!mMap.has_value() || mBuf != NULL) {
+        return false;
+    }
+    // The compressed data is inflated front to back whatever the mode, so it
+    // is only worth fetching all of it up front when it is all needed at once.
+    return adviseMap(*mMap, mode == ACCESS_BUFFER ? ACCESS_BUFFER : ACCESS_STREAMING);
+}
@@ -21,10 +21,14 @@
 #include <algorithm>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <set>
+#include <tuple>
 
 #include "android-base/logging.h"
 #include "android-base/stringprintf.h"
+#include "androidfw/ConcurrentResidMap.h"
+#include "androidfw/ResolvedSnapshot.h"
 #include "androidfw/ResourceTypes.h"
 #include "androidfw/ResourceUtils.h"
 #include "androidfw/Util.h"
@@ -99,6 +103,52 @@ struct FindEntryResult {
   StringPoolRef entry_string_ref;
 };
 
+struct AssetManager2::SharedCaches {
+  SharedCaches(const std::vector<const ApkAssets*>& apk_assets, const ResTable_config& config)
+      : apk_assets(apk_assets), configuration(config) {
+  }
+
+  // The ApkAssets and configuration for which the cached values were resolved.
+  const std::vector<const ApkAssets*> apk_assets;
+  const ResTable_config configuration;
+
+  ConcurrentResidMap<SelectedValue> resolved_values;
+  ConcurrentResidMap<const ResolvedBag*> bags;
+
+  // Owns the bags stored in `bags`.
+  std::mutex bag_storage_lock;
+  std::vector<util::unique_cptr<ResolvedBag>> bag_storage;
+};
+
+struct Theme::Entry {
+  uint32_t attr_res_id;
+  ApkAssetsCookie cookie;
+  uint32_t type_spec_flags;
+  Res_value value;
+};
+
+struct AssetManager2::ThemeStyleCache {
+  using Entries = std::shared_ptr<const std::vector<Theme::Entry>>;
+
+  // The cache is cleared once it holds this many results, which bounds the number of entry
+  // vectors it keeps alive.
+  static constexpr size_t kMaxSize = 128u;
+
+  struct AppliedStyle {
+    // Keeps the entries the style was applied to alive so that their address, which is part of
+    // the key, can't be reused by another vector.
+    Entries base;
+    Entries result;
+
+    // The type spec flags of the bag of the style.
+    uint32_t type_spec_flags;
+  };
+
+  // Keyed by the entries the style was applied to, the style resource ID and the force flag.
+  std::map<std::tuple<const void*, uint32_t, bool>, AppliedStyle> applied_styles;
+};
+
+
 AssetManager2::AssetManager2() {
   memset(&configuration_, 0, sizeof(configuration_));
 }
@@ -110,9 +160,152 @@ bool AssetManager2::SetApkAssets(std::vector<const ApkAssets*> apk_assets, bool
   if (invalidate_caches) {
     InvalidateCaches(static_cast<uint32_t>(-1));
   }
+  UpdateSharedCaches();
+  UpdateResolvedSnapshot();
   return true;
 }
 
+void AssetManager2::SetSharedCachesEnabled(bool enabled) {
+  if (shared_caches_enabled_ == enabled) {
+    return;
+  }
+  shared_caches_enabled_ = enabled;
+  UpdateSharedCaches();
+}
+
+void AssetManager2::SetResolvedSnapshot(std::shared_ptr<const ResolvedSnapshot> snapshot) {
+  resolved_snapshot_ = std::move(snapshot);
+  snapshot_apk_assets_.clear();
+  UpdateResolvedSnapshot();
+}
+
+void AssetManager2::UpdateResolvedSnapshot() {
+  active_snapshot_ = nullptr;
+  if (resolved_snapshot_ == nullptr) {
+    return;
+  }
+
+  if (snapshot_apk_assets_ != apk_assets_) {
+    // Computing the key stats every file, so only do it when the ApkAssets change.
+    const auto key = ResolvedSnapshot::MakeKey(apk_assets_);
+    if (!key.has_value() || *key != resolved_snapshot_->GetKey()) {
+      return;
+    }
+    snapshot_apk_assets_ = apk_assets_;
+  }
+
+  if (configuration_.compare(resolved_snapshot_->GetConfiguration()) == 0) {
+    active_snapshot_ = resolved_snapshot_.get();
+  }
+}
+
+bool AssetManager2::WriteResolvedSnapshot(const std::string& path) const {
+  const auto key = ResolvedSnapshot::MakeKey(apk_assets_);
+  if (!key.has_value()) {
+    return false;
+  }
+
+  std::vector<ResolvedSnapshot_value> values;
+  auto add_value = [&values](uint32_t resid, const SelectedValue& value) {
+    ResolvedSnapshot_value& out = values.emplace_back();
+    out.resid = resid;
+    out.value_resid = value.resid;
+    out.cookie = value.cookie;
+    out.flags = value.flags;
+    out.data = value.data;
+    out.type = value.type;
+    out.config = value.config;
+  };
+
+  std::vector<ResolvedSnapshot_bag> bags;
+  std::vector<ResolvedSnapshot_bag_entry> bag_entries;
+  auto add_bag = [&bags, &bag_entries](uint32_t resid, const ResolvedBag* bag) {
+    bags.push_back(ResolvedSnapshot_bag{resid, bag->type_spec_flags,
+                                        static_cast<uint32_t>(bag_entries.size()),
+                                        bag->entry_count});
+    for (auto it = begin(bag); it != end(bag); ++it) {
+      bag_entries.push_back(ResolvedSnapshot_bag_entry{it->key, it->style, it->cookie, it->value});
+    }
+  };
+
+  if (shared_caches_ != nullptr) {
+    shared_caches_->resolved_values.ForEach(add_value);
+    shared_caches_->bags.ForEach(add_bag);
+  } else {
+    for (const auto& [resid, value] : cached_resolved_values_) {
+      add_value(resid, value);
+    }
+    for (const auto& [resid, bag] : cached_bags_) {
+      add_bag(resid, bag.get());
+    }
+  }
+
+  return ResolvedSnapshot::Write(path, *key, configuration_, std::move(values), std::move(bags),
+                                 bag_entries);
+}
+
+void AssetManager2::SetResolvedIndexEnabled(bool enabled) {
+  resolved_index_enabled_ = enabled;
+  if (!enabled) {
+    for (PackageGroup& package_group : package_groups_) {
+      package_group.resolved_types_.clear();
+    }
+  }
+}
+
+void AssetManager2::UpdateSharedCaches() {
+  if (!shared_caches_enabled_) {
+    shared_caches_.reset();
+    return;
+  }
+
+  if (shared_caches_ != nullptr && shared_caches_->apk_assets == apk_assets_ &&
+      shared_caches_->configuration.compare(configuration_) == 0) {
+    return;
+  }
+
+  // The caches are kept alive only by the AssetManagers that use them. ApkAssets must outlive
+  // every AssetManager they are set on, so a live entry can't refer to a destroyed ApkAssets.
+  static std::mutex& registry_lock = *new std::mutex();
+  static auto& registry = *new std::vector<std::weak_ptr<SharedCaches>>();
+
+  std::lock_guard<std::mutex> lock(registry_lock);
+  shared_caches_.reset();
+  for (auto iter = registry.begin(); iter != registry.end();) {
+    std::shared_ptr<SharedCaches> caches = iter->lock();
+    if (caches == nullptr) {
+      iter = registry.erase(iter);
+      continue;
+    }
+    if (caches->apk_assets == apk_assets_ && caches->configuration.compare(configuration_) == 0) {
+      shared_caches_ = std::move(caches);
+      return;
+    }
+    ++iter;
+  }
+
+  shared_caches_ = std::make_shared<SharedCaches>(apk_assets_, configuration_);
+  registry.push_back(shared_caches_);
+}
+
+const ResolvedBag* AssetManager2::CacheBag(uint32_t resid,
+                                           util::unique_cptr<ResolvedBag> bag) const {
+  if (shared_caches_ == nullptr) {
+    ResolvedBag* result = bag.get();
+    cached_bags_[resid] = std::move(bag);
+    return result;
+  }
+
+  // Another AssetManager may have resolved the same bag concurrently. Keep whichever was
+  // published first so that every user of the cache sees the same pointer.
+  const ResolvedBag* result = *shared_caches_->bags.Insert(resid, bag.get());
+  if (result == bag.get()) {
+    std::lock_guard<std::mutex> lock(shared_caches_->bag_storage_lock);
+    shared_caches_->bag_storage.push_back(std::move(bag));
+  }
+  return result;
+}
+
 void AssetManager2::BuildDynamicRefTable() {
   package_groups_.clear();
   package_ids_.fill(0xff);
@@ -245,6 +438,29 @@ void AssetManager2::DumpToLog() const {
   }
   LOG(INFO) << "ApkAssets: " << list;
 
+  // Report how much heap the UTF-16 decode caches of the string pools are holding.
+  ResStringPool::DecodeCacheStats total_stats;
+  auto accumulate = [&total_stats](const ResStringPool* pool) {
+    if (pool != nullptr) {
+      const ResStringPool::DecodeCacheStats stats = pool->getDecodeCacheStats();
+      total_stats.hits += stats.hits;
+      total_stats.misses += stats.misses;
+      total_stats.strings += stats.strings;
+      total_stats.bytes += stats.bytes;
+    }
+  };
+  for (const auto& apk_assets : apk_assets_) {
+    const LoadedArsc* loaded_arsc = apk_assets->GetLoadedArsc();
+    accumulate(loaded_arsc->GetStringPool());
+    for (const auto& loaded_package : loaded_arsc->GetPackages()) {
+      accumulate(loaded_package->GetTypeStringPool());
+      accumulate(loaded_package->GetKeyStringPool());
+    }
+  }
+  LOG(INFO) << base::StringPrintf("String decode caches: %zu hits, %zu misses, %zu strings, "
+                                  "%zu bytes", total_stats.hits, total_stats.misses,
+                                  total_stats.strings, total_stats.bytes);
+
   list = "";
   for (size_t i = 0; i < package_ids_.size(); i++) {
     if (package_ids_[i] != 0xff) {
@@ -253,6 +469,12 @@ void AssetManager2::DumpToLog() const {
   }
   LOG(INFO) << "Package ID map: " << list;
 
+  if (shared_caches_ != nullptr) {
+    LOG(INFO) << base::StringPrintf("Shared caches(%p): %zu values, %zu bags, %ld users",
+                                    shared_caches_.get(), shared_caches_->resolved_values.size(),
+                                    shared_caches_->bags.size(), shared_caches_.use_count());
+  }
+
   for (const auto& package_group: package_groups_) {
     list = "";
     for (const auto& package : package_group.packages_) {
@@ -394,6 +616,8 @@ void AssetManager2::SetConfiguration(const ResTable_config& configuration) {
   if (diff) {
     RebuildFilterList();
     InvalidateCaches(static_cast<uint32_t>(diff));
+    UpdateSharedCaches();
+    UpdateResolvedSnapshot();
   }
 }
 
@@ -706,6 +930,32 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
   // types matched to the set configuration.
   const bool use_filtered = !ignore_configuration && &desired_config == &configuration_;
 
+  // The resolved index only holds complete selections for the set configuration. Resolution
+  // logging needs every step of the search, so it always takes the slow path.
+  ResolvedEntry* resolved_entry = nullptr;
+  if (resolved_index_enabled_ && use_filtered && !stop_at_first_match && !logging_enabled) {
+    resolved_entry = GetResolvedEntry(package_group, type_idx, entry_idx);
+    if (resolved_entry != nullptr && resolved_entry->package_index != ResolvedEntry::kUnresolved) {
+      if (resolved_entry->package_index == ResolvedEntry::kNoEntry) {
+        return base::unexpected(std::nullopt);
+      }
+      const size_t pi = resolved_entry->package_index;
+      return BuildFindEntryResult(package_group, package_group.cookies_[pi],
+                                  package_group.packages_[pi].loaded_package_,
+                                  resolved_entry->type_entry->type,
+                                  resolved_entry->type_entry->config, resolved_entry->offset,
+                                  resolved_entry->type_flags);
+    }
+  }
+
+  size_t best_package_index = 0U;
+  const TypeSpec::TypeEntry* best_type_entry = nullptr;
+
+  // Only needed when the candidates have to be matched against `desired_config` here.
+  const ResTable_config::PackedAxes packed_desired_config =
+      (use_filtered || ignore_configuration) ? ResTable_config::PackedAxes{}
+                                             : desired_config.packAxes();
+
   const size_t package_count = package_group.packages_.size();
   for (size_t pi = 0; pi < package_count; pi++) {
     const ConfiguredPackage& loaded_package_impl = package_group.packages_[pi];
@@ -740,7 +990,9 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
       // configuration to match or if we're using the list of types that have already had their
       // configuration matched.
       const ResTable_config& this_config = type_entry->config;
-      if (!(use_filtered || ignore_configuration || this_config.match(desired_config))) {
+      if (!(use_filtered || ignore_configuration ||
+            (type_entry->packed_config.mayMatch(packed_desired_config) &&
+             this_config.match(desired_config)))) {
         continue;
       }
 
@@ -779,7 +1031,9 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
 
       best_cookie = cookie;
       best_package = loaded_package;
+      best_package_index = pi;
       best_type = type;
+      best_type_entry = type_entry;
       best_config = &this_config;
       best_offset = offset.value();
 
@@ -796,10 +1050,60 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
     }
   }
 
+  if (resolved_entry != nullptr) {
+    GetResolvedType(package_group, type_idx)->type_flags |= type_flags;
+    if (best_cookie == kInvalidCookie) {
+      resolved_entry->package_index = ResolvedEntry::kNoEntry;
+    } else {
+      resolved_entry->package_index = static_cast<uint8_t>(best_package_index);
+      resolved_entry->type_entry = best_type_entry;
+      resolved_entry->offset = best_offset;
+    }
+    resolved_entry->type_flags = type_flags;
+  }
+
   if (UNLIKELY(best_cookie == kInvalidCookie)) {
     return base::unexpected(std::nullopt);
   }
 
+  return BuildFindEntryResult(package_group, best_cookie, best_package, best_type, *best_config,
+                              best_offset, type_flags);
+}
+
+AssetManager2::ResolvedType* AssetManager2::GetResolvedType(const PackageGroup& package_group,
+                                                            uint8_t type_idx) const {
+  if (package_group.resolved_types_.size() <= type_idx) {
+    package_group.resolved_types_.resize(static_cast<size_t>(type_idx) + 1U);
+  }
+  return &package_group.resolved_types_[type_idx];
+}
+
+AssetManager2::ResolvedEntry* AssetManager2::GetResolvedEntry(const PackageGroup& package_group,
+                                                              uint8_t type_idx,
+                                                              uint16_t entry_idx) const {
+  ResolvedType* resolved_type = GetResolvedType(package_group, type_idx);
+  if (resolved_type->entries.empty()) {
+    // Size the index to hold every entry declared by any package of the group.
+    size_t entry_count = 0U;
+    for (const ConfiguredPackage& package : package_group.packages_) {
+      if (const TypeSpec* type_spec = package.loaded_package_->GetTypeSpecByTypeIndex(type_idx)) {
+        entry_count = std::max<size_t>(entry_count, dtohl(type_spec->type_spec->entryCount));
+      }
+    }
+    resolved_type->entries.resize(entry_count);
+  }
+
+  if (entry_idx >= resolved_type->entries.size() ||
+      package_group.packages_.size() >= ResolvedEntry::kNoEntry) {
+    return nullptr;
+  }
+  return &resolved_type->entries[entry_idx];
+}
+
+base::expected<FindEntryResult, NullOrIOError> AssetManager2::BuildFindEntryResult(
+    const PackageGroup& package_group, ApkAssetsCookie best_cookie,
+    const LoadedPackage* best_package, incfs::verified_map_ptr<ResTable_type> best_type,
+    const ResTable_config& best_config, uint32_t best_offset, uint32_t type_flags) const {
   auto best_entry_result = LoadedPackage::GetEntryFromOffset(best_type, best_offset);
   if (!best_entry_result.has_value()) {
     return base::unexpected(best_entry_result.error());
@@ -818,7 +1122,7 @@ base::expected<FindEntryResult, NullOrIOError> AssetManager2::FindEntryInternal(
   return FindEntryResult{
     .cookie = best_cookie,
     .entry = *entry,
-    .config = *best_config,
+    .config = best_config,
     .type_flags = type_flags,
     .package_name = &best_package->GetPackageName(),
     .type_string_ref = StringPoolRef(best_package->GetTypeStringPool(), best_type->id - 1),
@@ -984,12 +1288,27 @@ base::expected<std::monostate, NullOrIOError> AssetManager2::ResolveReference(
   const uint32_t original_flags = value.flags;
   const uint32_t original_resid = value.data;
   if (cache_value) {
-    auto cached_value = cached_resolved_values_.find(value.data);
-    if (cached_value != cached_resolved_values_.end()) {
+    if (shared_caches_ != nullptr) {
+      if (const SelectedValue* cached_value = shared_caches_->resolved_values.Find(value.data)) {
+        value = *cached_value;
+        value.flags |= original_flags;
+        return {};
+      }
+    } else if (auto cached_value = cached_resolved_values_.find(value.data);
+               cached_value != cached_resolved_values_.end()) {
       value = cached_value->second;
       value.flags |= original_flags;
       return {};
     }
+
+    if (active_snapshot_ != nullptr) {
+      if (const ResolvedSnapshot_value* snapshot_value = active_snapshot_->FindValue(value.data)) {
+        value = SelectedValue(snapshot_value->type, snapshot_value->data, snapshot_value->cookie,
+                              snapshot_value->flags | original_flags, snapshot_value->value_resid,
+                              snapshot_value->config);
+        return {};
+      }
+    }
   }
 
   uint32_t combined_flags = 0U;
@@ -1012,7 +1331,11 @@ base::expected<std::monostate, NullOrIOError> AssetManager2::ResolveReference(
         result->data == resolve_resid || i == kMaxIterations) {
       // This reference can't be resolved, so exit now and let the caller deal with it.
       if (cache_value) {
-        cached_resolved_values_[original_resid] = value;
+        if (shared_caches_ != nullptr) {
+          shared_caches_->resolved_values.Insert(original_resid, value);
+        } else {
+          cached_resolved_values_[original_resid] = value;
+        }
       }
 
       // Above value is cached without original_flags to ensure they don't get included in future
@@ -1033,11 +1356,40 @@ const std::vector<uint32_t> AssetManager2::GetBagResIdStack(uint32_t resid) cons
   }
 
   std::vector<uint32_t> found_resids;
-  GetBag(resid, found_resids);
+  if (GetBag(resid, found_resids).has_value() && found_resids.empty()) {
+    // The bag came from the shared caches or the resolved snapshot, which don't hold the stack.
+    AppendBagResIdStack(resid, found_resids);
+  }
   cached_bag_resid_stacks_.emplace(resid, found_resids);
   return found_resids;
 }
 
+void AssetManager2::AppendBagResIdStack(uint32_t resid, std::vector<uint32_t>& child_resids) const {
+  while (resid != 0U &&
+         std::find(child_resids.begin(), child_resids.end(), resid) == child_resids.end()) {
+    if (auto cached_iter = cached_bag_resid_stacks_.find(resid);
+        cached_iter != cached_bag_resid_stacks_.end() && !cached_iter->second.empty()) {
+      child_resids.insert(child_resids.end(), cached_iter->second.begin(),
+                          cached_iter->second.end());
+      return;
+    }
+
+    auto entry = FindEntry(resid, 0u /* density_override */, false /* stop_at_first_match */,
+                           false /* ignore_configuration */);
+    if (!entry.has_value()) {
+      return;
+    }
+    auto entry_map = std::get_if<incfs::verified_map_ptr<ResTable_map_entry>>(&entry->entry);
+    if (entry_map == nullptr) {
+      return;
+    }
+
+    child_resids.push_back(resid);
+    resid = dtohl((*entry_map)->parent.ident);
+    entry->dynamic_ref_table->lookupResourceId(&resid);
+  }
+}
+
 base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::ResolveBag(
     AssetManager2::SelectedValue& value) const {
   if (UNLIKELY(value.type != Res_value::TYPE_REFERENCE)) {
@@ -1053,17 +1405,42 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::ResolveBag(
 
 base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(uint32_t resid) const {
   std::vector<uint32_t> found_resids;
-  const auto bag = GetBag(resid, found_resids);
-  cached_bag_resid_stacks_.emplace(resid, found_resids);
-  return bag;
+  return GetBag(resid, found_resids);
 }
 
 base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
     uint32_t resid, std::vector<uint32_t>& child_resids) const {
-  if (auto cached_iter = cached_bags_.find(resid); cached_iter != cached_bags_.end()) {
+  if (shared_caches_ != nullptr) {
+    if (const ResolvedBag* const* cached_bag = shared_caches_->bags.Find(resid)) {
+      return *cached_bag;
+    }
+  } else if (auto cached_iter = cached_bags_.find(resid); cached_iter != cached_bags_.end()) {
     return cached_iter->second.get();
   }
 
+  if (active_snapshot_ != nullptr) {
+    if (const ResolvedSnapshot_bag* snapshot_bag = active_snapshot_->FindBag(resid)) {
+      util::unique_cptr<ResolvedBag> new_bag{reinterpret_cast<ResolvedBag*>(
+          malloc(sizeof(ResolvedBag) + (snapshot_bag->entry_count * sizeof(ResolvedBag::Entry))))};
+      new_bag->type_spec_flags = snapshot_bag->type_spec_flags;
+      new_bag->entry_count = snapshot_bag->entry_count;
+      const ResolvedSnapshot_bag_entry* snapshot_entry = active_snapshot_->GetBagEntries(
+          snapshot_bag);
+      for (uint32_t i = 0; i < snapshot_bag->entry_count; i++, snapshot_entry++) {
+        ResolvedBag::Entry* new_entry = new_bag->entries + i;
+        new_entry->key = snapshot_entry->key;
+        new_entry->value = snapshot_entry->value;
+        new_entry->style = snapshot_entry->style;
+        new_entry->cookie = snapshot_entry->cookie;
+        new_entry->key_pool = nullptr;
+        new_entry->type_pool = nullptr;
+      }
+      // The snapshot doesn't hold the ids the bag was built from. GetBagResIdStack() rebuilds
+      // them from the resource tables when they are asked for.
+      return CacheBag(resid, std::move(new_bag));
+    }
+  }
+
   auto entry = FindEntry(resid, 0u /* density_override */, false /* stop_at_first_match */,
                          false /* ignore_configuration */);
   if (!entry.has_value()) {
@@ -1082,7 +1459,12 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
 
   // Keep track of ids that have already been seen to prevent infinite loops caused by circular
   // dependencies between bags.
+  const size_t stack_begin = child_resids.size();
   child_resids.push_back(resid);
+  const auto cache_resid_stack = [&]() {
+    cached_bag_resid_stacks_.emplace(
+        resid, std::vector<uint32_t>(child_resids.begin() + stack_begin, child_resids.end()));
+  };
 
   uint32_t parent_resid = dtohl(map->parent.ident);
   if (parent_resid == 0U ||
@@ -1136,15 +1518,15 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
 
     new_bag->type_spec_flags = entry->type_flags;
     new_bag->entry_count = static_cast<uint32_t>(entry_count);
-    ResolvedBag* result = new_bag.get();
-    cached_bags_[resid] = std::move(new_bag);
-    return result;
+    cache_resid_stack();
+    return CacheBag(resid, std::move(new_bag));
   }
 
   // In case the parent is a dynamic reference, resolve it.
   entry->dynamic_ref_table->lookupResourceId(&parent_resid);
 
   // Get the parent and do a merge of the keys.
+  const size_t parent_stack_begin = child_resids.size();
   const auto parent_bag = GetBag(parent_resid, child_resids);
   if (UNLIKELY(!parent_bag.has_value())) {
     // Failed to get the parent that should exist.
@@ -1152,6 +1534,10 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
                                      resid);
     return base::unexpected(parent_bag.error());
   }
+  if (child_resids.size() == parent_stack_begin) {
+    // The parent was already cached, possibly by another AssetManager, so its ids weren't added.
+    AppendBagResIdStack(parent_resid, child_resids);
+  }
 
   // Create the max possible entries we can make. Once we construct the bag,
   // we will realloc to fit to size.
@@ -1266,9 +1652,8 @@ base::expected<const ResolvedBag*, NullOrIOError> AssetManager2::GetBag(
   // Combine flags from the parent and our own bag.
   new_bag->type_spec_flags = entry->type_flags | (*parent_bag)->type_spec_flags;
   new_bag->entry_count = static_cast<uint32_t>(actual_count);
-  ResolvedBag* result = new_bag.get();
-  cached_bags_[resid] = std::move(new_bag);
-  return result;
+  cache_resid_stack();
+  return CacheBag(resid, std::move(new_bag));
 }
 
 static bool Utf8ToUtf16(const StringPiece& str, std::u16string* out) {
@@ -1345,6 +1730,7 @@ base::expected<uint32_t, NullOrIOError> AssetManager2::GetResourceId(
 }
 
 void AssetManager2::RebuildFilterList() {
+  const ResTable_config::PackedAxes packed_configuration = configuration_.packAxes();
   for (PackageGroup& group : package_groups_) {
     for (ConfiguredPackage& impl : group.packages_) {
       // Destroy it.
@@ -1357,7 +1743,8 @@ void AssetManager2::RebuildFilterList() {
       impl.loaded_package_->ForEachTypeSpec([&](const TypeSpec& type_spec, uint8_t type_id) {
         FilteredConfigGroup& group = impl.filtered_configs_.editItemAt(type_id - 1);
         for (const auto& type_entry : type_spec.type_entries) {
-          if (type_entry.config.match(configuration_)) {
+          if (type_entry.packed_config.mayMatch(packed_configuration) &&
+              type_entry.config.match(configuration_)) {
             group.type_entries.push_back(&type_entry);
           }
         }
@@ -1369,6 +1756,29 @@ void AssetManager2::RebuildFilterList() {
 void AssetManager2::InvalidateCaches(uint32_t diff) {
   cached_bag_resid_stacks_.clear();
 
+  if (theme_style_cache_ != nullptr) {
+    auto& applied_styles = theme_style_cache_->applied_styles;
+    for (auto iter = applied_styles.begin(); iter != applied_styles.end();) {
+      // A full invalidation means the assets changed, so even styles that do not vary with the
+      // configuration may now resolve differently.
+      if (diff == 0xffffffffu || (diff & iter->second.type_spec_flags)) {
+        iter = applied_styles.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  for (PackageGroup& package_group : package_groups_) {
+    for (ResolvedType& resolved_type : package_group.resolved_types_) {
+      // Entries that do not vary with any of the changed axis still select the same value.
+      if (diff == 0xffffffffu || (diff & resolved_type.type_flags)) {
+        resolved_type.type_flags = 0U;
+        resolved_type.entries.clear();
+      }
+    }
+  }
+
   if (diff == 0xffffffffu) {
     // Everything must go.
     cached_bags_.clear();
@@ -1400,10 +1810,7 @@ uint8_t AssetManager2::GetAssignedPackageId(const LoadedPackage* package) const
 }
 
 std::unique_ptr<Theme> AssetManager2::NewTheme() {
-  constexpr size_t kInitialReserveSize = 32;
-  auto theme = std::unique_ptr<Theme>(new Theme(this));
-  theme->entries_.reserve(kInitialReserveSize);
-  return theme;
+  return std::unique_ptr<Theme>(new Theme(this));
 }
 
 Theme::Theme(AssetManager2* asset_manager) : asset_manager_(asset_manager) {
@@ -1411,13 +1818,6 @@ Theme::Theme(AssetManager2* asset_manager) : asset_manager_(asset_manager) {
 
 Theme::~Theme() = default;
 
-struct Theme::Entry {
-  uint32_t attr_res_id;
-  ApkAssetsCookie cookie;
-  uint32_t type_spec_flags;
-  Res_value value;
-};
-
 namespace {
 struct ThemeEntryKeyComparer {
   bool operator() (const Theme::Entry& entry, uint32_t attr_res_id) const noexcept {
@@ -1426,9 +1826,25 @@ struct ThemeEntryKeyComparer {
 };
 } // namespace
 
+const std::vector<Theme::Entry>& Theme::GetEntries() const {
+  static const std::vector<Entry>& kEmptyEntries = *new std::vector<Entry>();
+  return entries_ != nullptr ? *entries_ : kEmptyEntries;
+}
+
 base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid, bool force) {
   ATRACE_NAME("Theme::ApplyStyle");
 
+  if (asset_manager_->theme_style_cache_ == nullptr) {
+    asset_manager_->theme_style_cache_ = std::make_shared<AssetManager2::ThemeStyleCache>();
+  }
+  auto& applied_styles = asset_manager_->theme_style_cache_->applied_styles;
+  const auto key = std::make_tuple(static_cast<const void*>(entries_.get()), resid, force);
+  if (auto applied = applied_styles.find(key); applied != applied_styles.end()) {
+    type_spec_flags_ |= applied->second.type_spec_flags;
+    entries_ = applied->second.result;
+    return {};
+  }
+
   auto bag = asset_manager_->GetBag(resid);
   if (!bag.has_value()) {
     return base::unexpected(bag.error());
@@ -1437,12 +1853,20 @@ base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid,
   // Merge the flags from this style.
   type_spec_flags_ |= (*bag)->type_spec_flags;
 
+  // The entries may be shared with other themes, so merge the bag into a new vector. Both the
+  // entries and the bag are sorted by attribute resource ID.
+  const std::vector<Entry>& base_entries = GetEntries();
+  auto entries = std::make_shared<std::vector<Entry>>();
+  entries->reserve(base_entries.size() + (*bag)->entry_count);
+  auto base_it = base_entries.begin();
   for (auto it = begin(*bag); it != end(*bag); ++it) {
     const uint32_t attr_res_id = it->key;
 
     // If the resource ID passed in is not a style, the key can be some other identifier that is not
     // a resource ID. We should fail fast instead of operating with strange resource IDs.
     if (!is_valid_resid(attr_res_id)) {
+      entries->insert(entries->end(), base_it, base_entries.end());
+      entries_ = std::move(entries);
       return base::unexpected(std::nullopt);
     }
 
@@ -1454,30 +1878,50 @@ base::expected<std::monostate, NullOrIOError> Theme::ApplyStyle(uint32_t resid,
       continue;
     }
 
+    // Carry over the attributes that sort before this one.
+    while (base_it != base_entries.end() && base_it->attr_res_id < attr_res_id) {
+      entries->push_back(*base_it++);
+    }
+
+    Entry* existing_entry = nullptr;
+    if (base_it != base_entries.end() && base_it->attr_res_id == attr_res_id) {
+      entries->push_back(*base_it++);
+      existing_entry = &entries->back();
+    } else if (!entries->empty() && entries->back().attr_res_id == attr_res_id) {
+      existing_entry = &entries->back();
+    }
+
     Theme::Entry new_entry{attr_res_id, it->cookie, (*bag)->type_spec_flags, it->value};
-    auto entry_it = std::lower_bound(entries_.begin(), entries_.end(), attr_res_id,
-                                     ThemeEntryKeyComparer{});
-    if (entry_it != entries_.end() && entry_it->attr_res_id == attr_res_id) {
+    if (existing_entry != nullptr) {
       if (is_undefined) {
         // DATA_NULL_UNDEFINED clears the value of the attribute in the theme only when `force` is
         /// true.
-        entries_.erase(entry_it);
+        entries->pop_back();
       } else if (force) {
-        *entry_it = new_entry;
+        *existing_entry = new_entry;
       }
     } else {
-      entries_.insert(entry_it, new_entry);
+      entries->push_back(new_entry);
     }
   }
+  entries->insert(entries->end(), base_it, base_entries.end());
+
+  if (applied_styles.size() >= AssetManager2::ThemeStyleCache::kMaxSize) {
+    applied_styles.clear();
+  }
+  auto base = std::move(entries_);
+  entries_ = std::move(entries);
+  applied_styles.emplace(key, AssetManager2::ThemeStyleCache::AppliedStyle{
+      std::move(base), entries_, (*bag)->type_spec_flags});
   return {};
 }
 
 void Theme::Rebase(AssetManager2* am, const uint32_t* style_ids, const uint8_t* force,
                    size_t style_count) {
   ATRACE_NAME("Theme::Rebase");
-  // Reset the entries without changing the vector capacity to prevent reallocations during
-  // ApplyStyle.
-  entries_.clear();
+  // Styles applied to an empty theme in the same order resolve to the entries cached by the
+  // AssetManager, so rebasing onto an AssetManager whose bags did not change is cheap.
+  entries_.reset();
   asset_manager_ = am;
   for (size_t i = 0; i < style_count; i++) {
     ApplyStyle(style_ids[i], force[i]);
@@ -1488,10 +1932,11 @@ std::optional<AssetManager2::SelectedValue> Theme::GetAttribute(uint32_t resid)
 
   constexpr const uint32_t kMaxIterations = 20;
   uint32_t type_spec_flags = 0u;
+  const std::vector<Entry>& entries = GetEntries();
   for (uint32_t i = 0; i <= kMaxIterations; i++) {
-    auto entry_it = std::lower_bound(entries_.begin(), entries_.end(), resid,
+    auto entry_it = std::lower_bound(entries.begin(), entries.end(), resid,
                                      ThemeEntryKeyComparer{});
-    if (entry_it == entries_.end() || entry_it->attr_res_id != resid) {
+    if (entry_it == entries.end() || entry_it->attr_res_id != resid) {
       return std::nullopt;
     }
 
@@ -1528,7 +1973,7 @@ base::expected<std::monostate, NullOrIOError> Theme::ResolveAttributeReference(
 }
 
 void Theme::Clear() {
-  entries_.clear();
+  entries_.reset();
 }
 
 base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
@@ -1576,10 +2021,10 @@ base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
       }
     }
 
-    // Reset the data in the destination theme.
-    entries_.clear();
+    // Build the data of the destination theme from scratch.
+    auto entries = std::make_shared<std::vector<Entry>>();
 
-    for (const auto& entry : source.entries_) {
+    for (const auto& entry : source.GetEntries()) {
       bool is_reference = (entry.value.dataType == Res_value::TYPE_ATTRIBUTE
                            || entry.value.dataType == Res_value::TYPE_REFERENCE
                            || entry.value.dataType == Res_value::TYPE_DYNAMIC_ATTRIBUTE
@@ -1656,17 +2101,18 @@ base::expected<std::monostate, IOError> Theme::SetTo(const Theme& source) {
                                                       .data = attribute_data}};
 
       // Since the entries were cleared, the attribute resource id has yet been mapped to any value.
-      auto entry_it = std::lower_bound(entries_.begin(), entries_.end(), dest_attr_id,
+      auto entry_it = std::lower_bound(entries->begin(), entries->end(), dest_attr_id,
                                        ThemeEntryKeyComparer{});
-      entries_.insert(entry_it, new_entry);
+      entries->insert(entry_it, new_entry);
     }
+    entries_ = std::move(entries);
   }
   return {};
 }
 
 void Theme::Dump() const {
   LOG(INFO) << base::StringPrintf("Theme(this=%p, AssetManager2=%p)", this, asset_manager_);
-  for (auto& entry : entries_) {
+  for (auto& entry : GetEntries()) {
     LOG(INFO) << base::StringPrintf("  entry(0x%08x)=(0x%08x) type=(0x%02x), cookie(%d)",
                                     entry.attr_res_id, entry.value.data, entry.value.dataType,
                                     entry.cookie);
@@ -18,6 +18,8 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
+
 #include <android-base/errors.h>
 #include <android-base/stringprintf.h>
 #include <android-base/utf8.h>
@@ -210,6 +212,43 @@ std::unique_ptr<Asset> ZipAssetsProvider::OpenInternal(const std::string& path,
     return asset;
 }
 
+const ZipAssetsProvider::EntryIndex* ZipAssetsProvider::GetEntryIndex() const {
+  std::call_once(entry_index_once_, [this]() {
+    void* cookie;
+    if (StartIteration(zip_handle_.get(), &cookie, "", "") != 0) {
+      return;
+    }
+
+    auto index = std::make_unique<EntryIndex>();
+    std::vector<std::pair<size_t, size_t>> ranges;
+    std::string name;
+    ::ZipEntry entry{};
+    int32_t result;
+    while ((result = Next(cookie, &entry, &name)) == 0) {
+      ranges.emplace_back(index->names.size(), name.size());
+      index->names += name;
+    }
+    EndIteration(cookie);
+
+    // -1 is end of iteration, anything else is an error.
+    if (result != -1) {
+      LOG(ERROR) << "Failed to iterate over APK '" << name_.GetDebugName() << "': "
+                 << ::ErrorCodeString(result);
+      return;
+    }
+
+    // The names are only referenced once they have all been appended.
+    const std::string_view names(index->names);
+    index->sorted_names.reserve(ranges.size());
+    for (const auto& [offset, length] : ranges) {
+      index->sorted_names.push_back(names.substr(offset, length));
+    }
+    std::sort(index->sorted_names.begin(), index->sorted_names.end());
+    entry_index_ = std::move(index);
+  });
+  return entry_index_.get();
+}
+
 bool ZipAssetsProvider::ForEachFile(const std::string& root_path,
                                     const std::function<void(const StringPiece&, FileType)>& f)
                                     const {
@@ -218,43 +257,44 @@ bool ZipAssetsProvider::ForEachFile(const std::string& root_path,
       root_path_full += '/';
     }
 
-    void* cookie;
-    if (StartIteration(zip_handle_.get(), &cookie, root_path_full, "") != 0) {
+    const EntryIndex* index = GetEntryIndex();
+    if (index == nullptr) {
       return false;
     }
 
-    std::string name;
-    ::ZipEntry entry{};
-
     // We need to hold back directories because many paths will contain them and we want to only
-    // surface one.
-    std::set<std::string> dirs{};
-
-    int32_t result;
-    while ((result = Next(cookie, &entry, &name)) == 0) {
-      StringPiece full_file_path(name);
-      StringPiece leaf_file_path = full_file_path.substr(root_path_full.size());
-
-      if (!leaf_file_path.empty()) {
-        auto iter = std::find(leaf_file_path.begin(), leaf_file_path.end(), '/');
-        if (iter != leaf_file_path.end()) {
-          std::string dir =
-              leaf_file_path.substr(0, std::distance(leaf_file_path.begin(), iter)).to_string();
-          dirs.insert(std::move(dir));
-        } else {
-          f(leaf_file_path, kFileTypeRegular);
-        }
+    // surface one. Each one is only seen once, since its entries are skipped as a whole.
+    std::vector<std::string_view> dirs;
+
+    const auto& sorted_names = index->sorted_names;
+    auto iter = std::lower_bound(sorted_names.begin(), sorted_names.end(), root_path_full);
+    while (iter != sorted_names.end() &&
+           iter->compare(0, root_path_full.size(), root_path_full) == 0) {
+      const std::string_view leaf_file_path = iter->substr(root_path_full.size());
+      const size_t slash = leaf_file_path.find('/');
+      if (leaf_file_path.empty()) {
+        ++iter;
+      } else if (slash == std::string_view::npos) {
+        f(StringPiece(leaf_file_path.data(), leaf_file_path.size()), kFileTypeRegular);
+        ++iter;
+      } else {
+        dirs.emplace_back(leaf_file_path.data(), slash);
+
+        // Skip the rest of the directory: every name under it sorts before "<dir>0", since '0'
+        // follows '/'.
+        std::string dir_end(iter->substr(0, root_path_full.size() + slash));
+        dir_end += static_cast<char>('/' + 1);
+        iter = std::lower_bound(iter, sorted_names.end(), dir_end);
       }
     }
-    EndIteration(cookie);
 
-    // Now present the unique directories.
-    for (const std::string& dir : dirs) {
-      f(dir, kFileTypeDirectory);
+    // Now present the unique directories. "<dir>-suffix/" sorts before "<dir>/", so sort them by
+    // name again.
+    std::sort(dirs.begin(), dirs.end());
+    for (const std::string_view& dir : dirs) {
+      f(StringPiece(dir.data(), dir.size()), kFileTypeDirectory);
     }
-
-    // -1 is end of iteration, anything else is an error.
-    return result == -1;
+    return true;
 }
 
 std::optional<uint32_t> ZipAssetsProvider::GetCrc(std::string_view path) const {
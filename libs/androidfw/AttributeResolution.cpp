@@ -16,7 +16,11 @@
 
 #include "androidfw/AttributeResolution.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 #include <log/log.h>
 
@@ -35,19 +39,33 @@ static uint32_t ApkAssetsCookieToJavaCookie(ApkAssetsCookie cookie) {
   return cookie != kInvalidCookie ? static_cast<uint32_t>(cookie + 1) : static_cast<uint32_t>(-1);
 }
 
+// Reads the resource ids of the attributes of the current element once, so that the finder can
+// compare against them as often as it needs to without going back to the parser.
 class XmlAttributeFinder
     : public BackTrackingAttributeFinder<XmlAttributeFinder, size_t> {
  public:
   explicit XmlAttributeFinder(const ResXMLParser* parser)
-      : BackTrackingAttributeFinder(0, parser != nullptr ? parser->getAttributeCount() : 0),
-        parser_(parser) {}
+      : BackTrackingAttributeFinder(0, parser != nullptr ? parser->getAttributeCount() : 0) {
+    const size_t count = parser != nullptr ? parser->getAttributeCount() : 0;
+    if (count > kInlineAttributeCount) {
+      heap_res_ids_.resize(count);
+      res_ids_ = heap_res_ids_.data();
+    }
+    for (size_t i = 0; i < count; i++) {
+      res_ids_[i] = parser->getAttributeNameResID(i);
+    }
+  }
 
   inline uint32_t GetAttribute(size_t index) const {
-    return parser_->getAttributeNameResID(index);
+    return res_ids_[index];
   }
 
  private:
-  const ResXMLParser* parser_;
+  static constexpr size_t kInlineAttributeCount = 32;
+
+  uint32_t inline_res_ids_[kInlineAttributeCount];
+  std::vector<uint32_t> heap_res_ids_;
+  uint32_t* res_ids_ = inline_res_ids_;
 };
 
 class BagAttributeFinder
@@ -217,25 +235,54 @@ base::expected<std::monostate, IOError> ResolveAttrs(Theme* theme, uint32_t def_
   return {};
 }
 
-base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* xml_parser,
-                                                   uint32_t def_style_attr,
-                                                   uint32_t def_style_resid,
-                                                   const uint32_t* attrs, size_t attrs_length,
-                                                   uint32_t* out_values, uint32_t* out_indices) {
-  DEBUG_LOG("APPLY STYLE: theme=0x%p defStyleAttr=0x%x defStyleRes=0x%x xml=0x%p", theme,
-            def_style_attr, def_style_resid, xml_parser);
+namespace {
 
-  int indices_idx = 0;
-  const AssetManager2* assetmanager = theme->GetAssetManager();
+// The default style of a batch of ApplyStyle() requests, looked up once for all the requests that
+// use it.
+struct DefaultStyle {
+  uint32_t def_style_attr;
+  uint32_t def_style_resid;
+  base::expected<const ResolvedBag*, NullOrIOError> bag;
+  uint32_t theme_flags;
+};
 
-  // Load default style from attribute, if specified...
-  uint32_t def_style_theme_flags = 0U;
-  const auto default_style_bag = GetStyleBag(theme, def_style_attr, def_style_resid,
-                                             &def_style_theme_flags);
-  if (IsIOError(default_style_bag)) {
-    return base::unexpected(GetIOError(default_style_bag.error()));
+// Theme attributes resolved while applying a batch of styles, keyed by attribute resource ID. The
+// value is empty if the theme does not define the attribute.
+using ThemeValueCache = std::unordered_map<uint32_t, std::optional<AssetManager2::SelectedValue>>;
+
+// Retrieves the value of `attr` from the theme and resolves its references. `theme_values` may be
+// nullptr; otherwise the result is cached in it.
+base::expected<std::optional<AssetManager2::SelectedValue>, IOError> GetResolvedThemeValue(
+    Theme* theme, uint32_t attr, ThemeValueCache* theme_values) {
+  if (theme_values != nullptr) {
+    if (auto cached = theme_values->find(attr); cached != theme_values->end()) {
+      return cached->second;
+    }
   }
 
+  std::optional<AssetManager2::SelectedValue> attr_value = theme->GetAttribute(attr);
+  if (attr_value.has_value()) {
+    DEBUG_LOG("-> From theme: type=0x%x, data=0x%08x", attr_value->type, attr_value->data);
+    auto result = theme->GetAssetManager()->ResolveReference(*attr_value, true /* cache_value */);
+    if (UNLIKELY(IsIOError(result))) {
+      return base::unexpected(GetIOError(result.error()));
+    }
+    DEBUG_LOG("-> Resolved theme: type=0x%x, data=0x%08x", attr_value->type, attr_value->data);
+  }
+
+  if (theme_values != nullptr) {
+    theme_values->emplace(attr, attr_value);
+  }
+  return attr_value;
+}
+
+base::expected<std::monostate, IOError> ApplyStyleWithDefaultStyle(
+    Theme* theme, ResXMLParser* xml_parser,
+    const base::expected<const ResolvedBag*, NullOrIOError>& default_style_bag,
+    uint32_t def_style_theme_flags, const uint32_t* attrs, size_t attrs_length,
+    uint32_t* out_values, uint32_t* out_indices, ThemeValueCache* theme_values) {
+  int indices_idx = 0;
+
   // Retrieve the style resource ID associated with the current XML tag's style attribute.
   uint32_t xml_style_theme_flags = 0U;
   const auto xml_style_bag = GetXmlStyleBag(theme, xml_parser, &def_style_theme_flags);
@@ -305,15 +352,12 @@ base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* x
       DEBUG_LOG("-> Resolved attr: type=0x%x, data=0x%08x", value.type, value.data);
     } else if (value.data != Res_value::DATA_NULL_EMPTY) {
       // If we still don't have a value for this attribute, try to find it in the theme!
-      if (auto attr_value = theme->GetAttribute(cur_ident)) {
-        value = *attr_value;
-        DEBUG_LOG("-> From theme: type=0x%x, data=0x%08x", value.type, value.data);
-
-        auto result = assetmanager->ResolveReference(value, true /* cache_value */);
-        if (UNLIKELY(IsIOError(result))) {
-          return base::unexpected(GetIOError(result.error()));
-        }
-        DEBUG_LOG("-> Resolved theme: type=0x%x, data=0x%08x", value.type, value.data);
+      auto attr_value = GetResolvedThemeValue(theme, cur_ident, theme_values);
+      if (UNLIKELY(!attr_value.has_value())) {
+        return base::unexpected(attr_value.error());
+      }
+      if (attr_value->has_value()) {
+        value = **attr_value;
         // TODO: set value_source_resid for the style in the theme that was used.
       }
     }
@@ -349,6 +393,72 @@ base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* x
   return {};
 }
 
+} // namespace
+
+base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* xml_parser,
+                                                   uint32_t def_style_attr,
+                                                   uint32_t def_style_resid,
+                                                   const uint32_t* attrs, size_t attrs_length,
+                                                   uint32_t* out_values, uint32_t* out_indices) {
+  DEBUG_LOG("APPLY STYLE: theme=0x%p defStyleAttr=0x%x defStyleRes=0x%x xml=0x%p", theme,
+            def_style_attr, def_style_resid, xml_parser);
+
+  // Load default style from attribute, if specified...
+  uint32_t def_style_theme_flags = 0U;
+  const auto default_style_bag = GetStyleBag(theme, def_style_attr, def_style_resid,
+                                             &def_style_theme_flags);
+  if (IsIOError(default_style_bag)) {
+    return base::unexpected(GetIOError(default_style_bag.error()));
+  }
+
+  return ApplyStyleWithDefaultStyle(theme, xml_parser, default_style_bag, def_style_theme_flags,
+                                    attrs, attrs_length, out_values, out_indices,
+                                    nullptr /* theme_values */);
+}
+
+base::expected<std::monostate, IOError> ApplyStyles(Theme* theme, const StyleRequest* requests,
+                                                    size_t requests_length, uint32_t* out_values,
+                                                    uint32_t* out_indices) {
+  DEBUG_LOG("APPLY STYLES: theme=0x%p count=%zu", theme, requests_length);
+
+  // Views of a batch mostly share a handful of default styles and query the same attributes from
+  // the theme, so both are only looked up once.
+  std::vector<DefaultStyle> default_styles;
+  ThemeValueCache theme_values;
+
+  for (size_t i = 0; i < requests_length; i++) {
+    const StyleRequest& request = requests[i];
+    auto default_style = std::find_if(default_styles.begin(), default_styles.end(),
+                                      [&request](const DefaultStyle& style) {
+      return style.def_style_attr == request.def_style_attr &&
+             style.def_style_resid == request.def_style_resid;
+    });
+    if (default_style == default_styles.end()) {
+      uint32_t def_style_theme_flags = 0U;
+      auto bag = GetStyleBag(theme, request.def_style_attr, request.def_style_resid,
+                             &def_style_theme_flags);
+      if (IsIOError(bag)) {
+        return base::unexpected(GetIOError(bag.error()));
+      }
+      default_style = default_styles.insert(default_styles.end(),
+                                            DefaultStyle{request.def_style_attr,
+                                                         request.def_style_resid, bag,
+                                                         def_style_theme_flags});
+    }
+
+    const auto result = ApplyStyleWithDefaultStyle(theme, request.xml_parser, default_style->bag,
+                                                   default_style->theme_flags, request.attrs,
+                                                   request.attrs_length, out_values, out_indices,
+                                                   &theme_values);
+    if (UNLIKELY(!result.has_value())) {
+      return result;
+    }
+    out_values += request.attrs_length * STYLE_NUM_ENTRIES;
+    out_indices += request.attrs_length + 1;
+  }
+  return {};
+}
+
 base::expected<std::monostate, IOError> RetrieveAttributes(AssetManager2* assetmanager,
                                                            ResXMLParser* xml_parser,
                                                            uint32_t* attrs,
@@ -310,25 +310,42 @@ compute_crc32(const char* file, FileRec* out) {
         return -1;
     }
 
-    const int bufsize = 4*1024;
+    const int bufsize = 128*1024;
     int amt;
 
     char* buf = (char*)malloc(bufsize);
+    if (buf == NULL) {
+        close(fd);
+        return -1;
+    }
     int crc = crc32(0L, Z_NULL, 0);
 
     lseek(fd, 0, SEEK_SET);
 
-    while ((amt = read(fd, buf, bufsize)) != 0) {
+    while ((amt = read(fd, buf, bufsize)) > 0) {
         crc = crc32(crc, (Bytef*)buf, amt);
     }
 
     close(fd);
     free(buf);
 
+    if (amt < 0) {
+        return -1;
+    }
+
     out->s.crc32 = crc;
     return NO_ERROR;
 }
 
+// A file whose modification time, mode and size all match its entry in the previous snapshot is
+// taken to be unchanged, so its CRC is carried over rather than recomputed from the whole file.
+static bool
+matches_snapshot(const FileState& old, const FileState& current)
+{
+    return old.modTime_sec == current.modTime_sec && old.modTime_nsec == current.modTime_nsec
+            && old.mode == current.mode && old.size == current.size;
+}
+
 int
 back_up_files(int oldSnapshotFD, BackupDataWriter* dataStream, int newSnapshotFD,
         char const* const* files, char const* const* keys, int fileCount)
@@ -369,8 +386,11 @@ back_up_files(int oldSnapshotFD, BackupDataWriter* dataStream, int newSnapshotFD
                 return -1;
             }
 
-            // compute the CRC
-            if (compute_crc32(file, &r) != NO_ERROR) {
+            ssize_t oldIndex = oldSnapshot.indexOfKey(key);
+            if (oldIndex >= 0 && matches_snapshot(oldSnapshot.valueAt(oldIndex), r.s)) {
+                r.s.crc32 = oldSnapshot.valueAt(oldIndex).crc32;
+            } else if (compute_crc32(file, &r) != NO_ERROR) {
+                // compute the CRC
                 ALOGW("Unable to open file %s", file);
                 continue;
             }
@@ -550,7 +570,9 @@ int write_tarfile(const String8& packageName, const String8& domain,
 
     // read/write up to this much at a time.
     const size_t BUFSIZE = 32 * 1024;
-    char* buf = (char *)calloc(1,BUFSIZE);
+    // File data is read in after room for its chunk size, so that both go out in one write.
+    const size_t CHUNKHEADER_SIZE = sizeof(uint32_t);
+    char* buf = (char *)calloc(1, BUFSIZE + CHUNKHEADER_SIZE);
     const size_t PAXHEADER_OFFSET = 512;
     const size_t PAXHEADER_SIZE = 512;
     const size_t PAXDATA_SIZE = BUFSIZE - (PAXHEADER_SIZE + PAXHEADER_OFFSET);
@@ -688,7 +710,8 @@ int write_tarfile(const String8& packageName, const String8& domain,
             if (toRead > BUFSIZE) {
                 toRead = BUFSIZE;
             }
-            ssize_t nRead = read(fd, buf, toRead);
+            char* const data = buf + CHUNKHEADER_SIZE;
+            ssize_t nRead = read(fd, data, toRead);
             if (nRead < 0) {
                 err = errno;
                 ALOGE("Unable to read file [%s], err=%d (%s)", filepath.string(),
@@ -707,10 +730,13 @@ int write_tarfile(const String8& packageName, const String8& domain,
             ssize_t partial = (nRead+512) % 512;
             if (partial > 0) {
                 ssize_t remainder = 512 - partial;
-                memset(buf + nRead, 0, remainder);
+                memset(data + nRead, 0, remainder);
                 nRead += remainder;
             }
-            send_tarfile_chunk(writer, buf, nRead);
+            // Same wire format as send_tarfile_chunk()
+            uint32_t chunk_size_no = htonl(nRead);
+            memcpy(buf, &chunk_size_no, CHUNKHEADER_SIZE);
+            writer->WriteEntityData(buf, CHUNKHEADER_SIZE + nRead);
             toWrite -= nRead;
         }
     }
@@ -18,7 +18,12 @@
 
 #include <androidfw/CursorWindow.h>
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <vector>
 
 #include "android-base/logging.h"
 #include "cutils/ashmem.h"
@@ -34,18 +39,204 @@ static constexpr const size_t kInlineSize = 16384;
 static constexpr const size_t kSlotShift = 4;
 static constexpr const size_t kSlotSizeBytes = 1 << kSlotShift;
 
+/**
+ * Number of inflated regions kept mapped for reuse by later windows. Most
+ * windows are inflated to the same default size, so a few regions are
+ * enough to absorb bursts of queries.
+ */
+static constexpr const size_t kMaxPooledRegions = 4;
+
+namespace {
+
+struct Region {
+    int fd;
+    void* data;
+    uint32_t size;
+};
+
+struct RegionPool {
+    std::mutex lock;
+    std::vector<Region> regions;
+    CursorWindow::PoolStats stats;
+};
+
+RegionPool& getRegionPool() {
+    static RegionPool& pool = *new RegionPool();
+    return pool;
+}
+
+/**
+ * Returns whether sealed memfds can back windows. Other processes must not
+ * be able to write to a window, which needs F_SEAL_FUTURE_WRITE (Linux 5.1).
+ */
+bool supportsSealedMemfd() {
+#if defined(__ANDROID__) && defined(F_SEAL_FUTURE_WRITE)
+    static const bool supported = [] {
+        int fd = memfd_create("CursorWindow probe", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) {
+            return false;
+        }
+        bool result = fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE) == 0;
+        ::close(fd);
+        return result;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+status_t createRegion(const String8& name, uint32_t size, Region* outRegion) {
+    int fd = -1;
+    void* data = MAP_FAILED;
+
+#if defined(__ANDROID__) && defined(F_SEAL_FUTURE_WRITE)
+    if (supportsSealedMemfd()) {
+        fd = memfd_create(name.string(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) {
+            PLOG(ERROR) << "Failed memfd_create";
+            goto fail_silent;
+        }
+
+        if (ftruncate(fd, size) < 0) {
+            PLOG(ERROR) << "Failed ftruncate";
+            goto fail_silent;
+        }
+
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) < 0) {
+            PLOG(ERROR) << "Failed F_ADD_SEALS";
+            goto fail_silent;
+        }
+
+        // Writes are sealed off once the window is first sent to another process.
+        data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            PLOG(ERROR) << "Failed mmap";
+            goto fail_silent;
+        }
+
+        *outRegion = {fd, data, size};
+        return OK;
+    }
+#endif
+
+    fd = ashmem_create_region(name.string(), size);
+    if (fd < 0) {
+        PLOG(ERROR) << "Failed ashmem_create_region";
+        goto fail_silent;
+    }
+
+    if (ashmem_set_prot_region(fd, PROT_READ | PROT_WRITE) < 0) {
+        PLOG(ERROR) << "Failed ashmem_set_prot_region";
+        goto fail_silent;
+    }
+
+    data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        PLOG(ERROR) << "Failed mmap";
+        goto fail_silent;
+    }
+
+    if (ashmem_set_prot_region(fd, PROT_READ) < 0) {
+        PLOG(ERROR) << "Failed ashmem_set_prot_region";
+        goto fail_silent;
+    }
+
+    *outRegion = {fd, data, size};
+    return OK;
+
+fail_silent:
+    if (data != MAP_FAILED) {
+        ::munmap(data, size);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return UNKNOWN_ERROR;
+}
+
+/**
+ * Prevents other processes from writing to a memfd region. Regions created
+ * through ashmem were already made read-only by createRegion().
+ */
+status_t sealRegion(int fd) {
+#if defined(__ANDROID__) && defined(F_SEAL_FUTURE_WRITE)
+    if (supportsSealedMemfd() && fcntl(fd, F_GET_SEALS) >= 0) {
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE) < 0) {
+            PLOG(ERROR) << "Failed F_ADD_SEALS";
+            return UNKNOWN_ERROR;
+        }
+    }
+#endif
+    return OK;
+}
+
+bool acquirePooledRegion(uint32_t size, Region* outRegion) {
+    RegionPool& pool = getRegionPool();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    for (auto it = pool.regions.begin(); it != pool.regions.end(); ++it) {
+        if (it->size == size) {
+            *outRegion = *it;
+            pool.regions.erase(it);
+            pool.stats.hits++;
+            return true;
+        }
+    }
+    pool.stats.misses++;
+    return false;
+}
+
+void releaseRegion(const Region& region, bool reusable) {
+    // Dropping the pages keeps pooled regions from holding on to memory. A region
+    // whose pages can't be dropped is not worth keeping.
+    if (reusable && ::madvise(region.data, region.size, MADV_REMOVE) == 0) {
+        RegionPool& pool = getRegionPool();
+        std::lock_guard<std::mutex> guard(pool.lock);
+        if (pool.regions.size() < kMaxPooledRegions) {
+            pool.regions.push_back(region);
+            pool.stats.recycled++;
+            return;
+        }
+        pool.stats.discarded++;
+    } else {
+        RegionPool& pool = getRegionPool();
+        std::lock_guard<std::mutex> guard(pool.lock);
+        pool.stats.discarded++;
+    }
+    ::munmap(region.data, region.size);
+    ::close(region.fd);
+}
+
+}  // namespace
+
 CursorWindow::CursorWindow() {
 }
 
 CursorWindow::~CursorWindow() {
     if (mAshmemFd != -1) {
-        ::munmap(mData, mSize);
-        ::close(mAshmemFd);
+        if (mReadOnly) {
+            ::munmap(mData, mSize);
+            ::close(mAshmemFd);
+        } else {
+            releaseRegion({mAshmemFd, mData, mSize}, !mShared);
+        }
     } else {
         free(mData);
     }
 }
 
+CursorWindow::PoolStats CursorWindow::getPoolStats() {
+    RegionPool& pool = getRegionPool();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    PoolStats stats = pool.stats;
+    stats.pooledRegions = pool.regions.size();
+    stats.pooledBytes = 0;
+    for (const Region& region : pool.regions) {
+        stats.pooledBytes += region.size;
+    }
+    return stats;
+}
+
 status_t CursorWindow::create(const String8 &name, size_t inflatedSize, CursorWindow **outWindow) {
     *outWindow = nullptr;
 
@@ -73,51 +264,34 @@ fail_silent:
 }
 
 status_t CursorWindow::maybeInflate() {
-    int ashmemFd = 0;
-    void* newData = nullptr;
+    Region region;
 
     // Bail early when we can't expand any further
     if (mReadOnly || mSize == mInflatedSize) {
         return INVALID_OPERATION;
     }
 
-    String8 ashmemName("CursorWindow: ");
-    ashmemName.append(mName);
-
-    ashmemFd = ashmem_create_region(ashmemName.string(), mInflatedSize);
-    if (ashmemFd < 0) {
-        PLOG(ERROR) << "Failed ashmem_create_region";
-        goto fail_silent;
-    }
-
-    if (ashmem_set_prot_region(ashmemFd, PROT_READ | PROT_WRITE) < 0) {
-        PLOG(ERROR) << "Failed ashmem_set_prot_region";
-        goto fail_silent;
-    }
-
-    newData = ::mmap(nullptr, mInflatedSize, PROT_READ | PROT_WRITE, MAP_SHARED, ashmemFd, 0);
-    if (newData == MAP_FAILED) {
-        PLOG(ERROR) << "Failed mmap";
-        goto fail_silent;
-    }
+    if (!acquirePooledRegion(mInflatedSize, &region)) {
+        String8 ashmemName("CursorWindow: ");
+        ashmemName.append(mName);
 
-    if (ashmem_set_prot_region(ashmemFd, PROT_READ) < 0) {
-        PLOG(ERROR) << "Failed ashmem_set_prot_region";
-        goto fail_silent;
+        if (createRegion(ashmemName, mInflatedSize, &region)) {
+            return UNKNOWN_ERROR;
+        }
     }
 
     {
         // Migrate existing contents into new ashmem region
         uint32_t slotsSize = mSize - mSlotsOffset;
         uint32_t newSlotsOffset = mInflatedSize - slotsSize;
-        memcpy(static_cast<uint8_t*>(newData),
+        memcpy(static_cast<uint8_t*>(region.data),
                 static_cast<uint8_t*>(mData), mAllocOffset);
-        memcpy(static_cast<uint8_t*>(newData) + newSlotsOffset,
+        memcpy(static_cast<uint8_t*>(region.data) + newSlotsOffset,
                 static_cast<uint8_t*>(mData) + mSlotsOffset, slotsSize);
 
         free(mData);
-        mAshmemFd = ashmemFd;
-        mData = newData;
+        mAshmemFd = region.fd;
+        mData = region.data;
         mSize = mInflatedSize;
         mSlotsOffset = newSlotsOffset;
 
@@ -126,13 +300,6 @@ status_t CursorWindow::maybeInflate() {
 
     LOG(DEBUG) << "Inflated: " << this->toString();
     return OK;
-
-fail:
-    LOG(ERROR) << "Failed maybeInflate";
-fail_silent:
-    ::munmap(newData, mInflatedSize);
-    ::close(ashmemFd);
-    return UNKNOWN_ERROR;
 }
 
 status_t CursorWindow::createFromParcel(Parcel* parcel, CursorWindow** outWindow) {
@@ -211,6 +378,10 @@ status_t CursorWindow::writeToParcel(Parcel* parcel) {
     if (parcel->writeUint32(mNumRows)) goto fail;
     if (parcel->writeUint32(mNumColumns)) goto fail;
     if (mAshmemFd != -1) {
+        if (!mShared) {
+            if (sealRegion(mAshmemFd)) goto fail;
+            mShared = true;
+        }
         if (parcel->writeUint32(mSize)) goto fail;
         if (parcel->writeBool(true)) goto fail;
         if (parcel->writeDupFileDescriptor(mAshmemFd)) goto fail;
@@ -433,4 +604,108 @@ status_t CursorWindow::putNull(uint32_t row, uint32_t column) {
     return OK;
 }
 
+status_t CursorWindow::putRow(const Field* fields, uint32_t numFields) {
+    if (mReadOnly) {
+        return INVALID_OPERATION;
+    }
+    if (numFields != mNumColumns) {
+        return BAD_VALUE;
+    }
+
+    size_t heapSize = 0;
+    for (uint32_t i = 0; i < numFields; i++) {
+        switch (fields[i].type) {
+            case FIELD_TYPE_NULL:
+            case FIELD_TYPE_INTEGER:
+            case FIELD_TYPE_FLOAT:
+                break;
+            case FIELD_TYPE_STRING:
+            case FIELD_TYPE_BLOB:
+                heapSize += (fields[i].value.buffer.size + 3) & ~3;
+                break;
+            default:
+                return BAD_TYPE;
+        }
+    }
+
+    // Reserve the slots and the heap space of the whole row with a single check, so that
+    // neither allocRow() nor alloc() below has to inflate or move the window.
+    const size_t rowSize = heapSize + mNumColumns * kSlotSizeBytes;
+    if (mAllocOffset + rowSize > mSlotsOffset) {
+        maybeInflate();
+        if (mAllocOffset + rowSize > mSlotsOffset) {
+            return NO_MEMORY;
+        }
+    }
+
+    const uint32_t allocOffset = mAllocOffset;
+    status_t status = allocRow();
+    if (status) {
+        return status;
+    }
+
+    // Column `i` of the new row sits `i` slots below its first column.
+    uint8_t* rowStart = static_cast<uint8_t*>(mSlotsStart)
+            - (((mNumRows - 1) * mNumColumns) << kSlotShift);
+    for (uint32_t i = 0; i < numFields; i++) {
+        const Field& field = fields[i];
+        FieldSlot* fieldSlot = reinterpret_cast<FieldSlot*>(rowStart - (i << kSlotShift));
+        fieldSlot->type = field.type;
+        switch (field.type) {
+            case FIELD_TYPE_INTEGER:
+                fieldSlot->data.l = field.value.l;
+                break;
+            case FIELD_TYPE_FLOAT:
+                fieldSlot->data.d = field.value.d;
+                break;
+            case FIELD_TYPE_STRING:
+            case FIELD_TYPE_BLOB: {
+                uint32_t offset;
+                status = alloc(field.value.buffer.size, &offset);
+                if (status) {
+                    goto fail;
+                }
+                memcpy(offsetToPtr(offset), field.value.buffer.data, field.value.buffer.size);
+                fieldSlot->data.buffer.offset = offset;
+                fieldSlot->data.buffer.size = field.value.buffer.size;
+                break;
+            }
+        }
+    }
+    return OK;
+
+fail:
+    freeLastRow();
+    mAllocOffset = allocOffset;
+    return status;
+}
+
+status_t CursorWindow::getColumnLongs(uint32_t column, uint32_t startRow, uint32_t numRows,
+        int64_t* outValues) {
+    if (numRows == 0) {
+        return OK;
+    }
+    FieldSlot* first = getFieldSlot(startRow, column);
+    if (!first || numRows > mNumRows - startRow) {
+        return BAD_VALUE;
+    }
+
+    // The fields of a column are mNumColumns slots apart, walking down from the first row.
+    const size_t stride = mNumColumns << kSlotShift;
+    uint8_t* slot = reinterpret_cast<uint8_t*>(first);
+    for (uint32_t i = 0; i < numRows; i++, slot -= stride) {
+        const int32_t type = reinterpret_cast<FieldSlot*>(slot)->type;
+        if (type != FIELD_TYPE_INTEGER && type != FIELD_TYPE_NULL) {
+            return INVALID_OPERATION;
+        }
+    }
+
+    slot = reinterpret_cast<uint8_t*>(first);
+    for (uint32_t i = 0; i < numRows; i++, slot -= stride) {
+        FieldSlot* fieldSlot = reinterpret_cast<FieldSlot*>(slot);
+        outValues[i] = fieldSlot->type == FIELD_TYPE_INTEGER ? fieldSlot->data.l : 0;
+    }
+    return OK;
+}
+
 }; // namespace android
@@ -18,6 +18,9 @@
 
 #include "androidfw/Idmap.h"
 
+#include <algorithm>
+#include <optional>
+
 #include "android-base/logging.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/misc.h"
@@ -76,6 +79,81 @@ struct Idmap_overlay_entry {
   uint32_t target_id;
 };
 
+IdmapEntryIndex::IdmapEntryIndex(const uint32_t* first_id, size_t stride, uint32_t count,
+                                 uint32_t mask)
+    : first_id_(first_id), stride_(stride), count_(count), mask_(mask) {
+  // The ids of one type are only contiguous if all of the ids belong to the same package.
+  by_type_ = count_ == 0U || (IdAt(0U) >> 24U) == (IdAt(count_ - 1U) >> 24U);
+  for (uint32_t i = 0; by_type_ && i < count_;) {
+    const uint32_t type_id = (IdAt(i) >> 16U) & 0xFFU;
+    if (type_id >= types_.size()) {
+      types_.resize(type_id + 1U);
+    }
+
+    Type& type = types_[type_id];
+    type.first = i;
+    while (i < count_ && ((IdAt(i) >> 16U) & 0xFFU) == type_id) {
+      i++;
+    }
+    type.count = i - type.first;
+
+    // Only index the types whose slots would not be mostly empty, and whose positions fit in a
+    // slot.
+    type.min_entry = IdAt(type.first) & 0xFFFFU;
+    type.entry_span = (IdAt(i - 1U) & 0xFFFFU) - type.min_entry + 1U;
+    if (type.entry_span <= type.count * 2U + 16U && type.count < 0xFFFFU) {
+      type.slots_begin = static_cast<uint32_t>(slots_.size());
+      slots_.resize(slots_.size() + type.entry_span, 0U);
+      for (uint32_t j = 0; j < type.count; j++) {
+        slots_[type.slots_begin + (IdAt(type.first + j) & 0xFFFFU) - type.min_entry] =
+            static_cast<uint16_t>(j + 1U);
+      }
+    }
+  }
+}
+
+uint32_t IdmapEntryIndex::LowerBound(uint32_t first, uint32_t last, uint32_t id) const {
+  while (first < last) {
+    const uint32_t mid = first + (last - first) / 2U;
+    if (IdAt(mid) < id) {
+      first = mid + 1U;
+    } else {
+      last = mid;
+    }
+  }
+  return first;
+}
+
+int32_t IdmapEntryIndex::Find(uint32_t id) const {
+  if (!by_type_) {
+    const uint32_t index = LowerBound(0U, count_, id);
+    return (index != count_ && IdAt(index) == id) ? static_cast<int32_t>(index) : -1;
+  }
+
+  const uint32_t type_id = (id >> 16U) & 0xFFU;
+  if (type_id >= types_.size()) {
+    return -1;
+  }
+
+  const Type& type = types_[type_id];
+  if (type.slots_begin != kNotIndexed) {
+    const uint32_t entry_id = id & 0xFFFFU;
+    if (entry_id < type.min_entry || entry_id - type.min_entry >= type.entry_span) {
+      return -1;
+    }
+    const uint32_t slot = slots_[type.slots_begin + entry_id - type.min_entry];
+    if (slot == 0U) {
+      return -1;
+    }
+    const uint32_t index = type.first + slot - 1U;
+    return IdAt(index) == id ? static_cast<int32_t>(index) : -1;
+  }
+
+  const uint32_t last = type.first + type.count;
+  const uint32_t index = LowerBound(type.first, last, id);
+  return (index != last && IdAt(index) == id) ? static_cast<int32_t>(index) : -1;
+}
+
 OverlayStringPool::OverlayStringPool(const LoadedIdmap* loaded_idmap)
     : data_header_(loaded_idmap->data_header_),
       idmap_string_pool_(loaded_idmap->string_pool_.get()) { };
@@ -108,25 +186,21 @@ size_t OverlayStringPool::size() const {
 
 OverlayDynamicRefTable::OverlayDynamicRefTable(const Idmap_data_header* data_header,
                                                const Idmap_overlay_entry* entries,
+                                               const IdmapEntryIndex* entry_index,
                                                uint8_t target_assigned_package_id)
     : data_header_(data_header),
       entries_(entries),
+      entry_index_(entry_index),
       target_assigned_package_id_(target_assigned_package_id) { };
 
 status_t OverlayDynamicRefTable::lookupResourceId(uint32_t* resId) const {
-  const Idmap_overlay_entry* first_entry = entries_;
-  const Idmap_overlay_entry* end_entry = entries_ + dtohl(data_header_->overlay_entry_count);
-  auto entry = std::lower_bound(first_entry, end_entry, *resId,
-                                [](const Idmap_overlay_entry& e1, const uint32_t overlay_id) {
-    return dtohl(e1.overlay_id) < overlay_id;
-  });
-
-  if (entry == end_entry || dtohl(entry->overlay_id) != *resId) {
+  const int32_t index = entry_index_->Find(*resId);
+  if (index < 0) {
     // A mapping for the target resource id could not be found.
     return DynamicRefTable::lookupResourceId(resId);
   }
 
-  *resId = (0x00FFFFFFU & dtohl(entry->target_id))
+  *resId = (0x00FFFFFFU & dtohl(entries_[index].target_id))
       | (((uint32_t) target_assigned_package_id_) << 24U);
   return NO_ERROR;
 }
@@ -138,11 +212,15 @@ status_t OverlayDynamicRefTable::lookupResourceIdNoRewrite(uint32_t* resId) cons
 IdmapResMap::IdmapResMap(const Idmap_data_header* data_header,
                          const Idmap_target_entry* entries,
                          const Idmap_target_entry_inline* inline_entries,
+                         const IdmapEntryIndex* entry_index,
+                         const IdmapEntryIndex* inline_entry_index,
                          uint8_t target_assigned_package_id,
                          const OverlayDynamicRefTable* overlay_ref_table)
     : data_header_(data_header),
       entries_(entries),
       inline_entries_(inline_entries),
+      entry_index_(entry_index),
+      inline_entry_index_(inline_entry_index),
       target_assigned_package_id_(target_assigned_package_id),
       overlay_ref_table_(overlay_ref_table) { }
 
@@ -157,15 +235,9 @@ IdmapResMap::Result IdmapResMap::Lookup(uint32_t target_res_id) const {
   target_res_id &= 0x00FFFFFFU;
 
   // Check if the target resource is mapped to an overlay resource.
-  auto first_entry = entries_;
-  auto end_entry = entries_ + dtohl(data_header_->target_entry_count);
-  auto entry = std::lower_bound(first_entry, end_entry, target_res_id,
-                                [](const Idmap_target_entry& e, const uint32_t target_id) {
-    return (0x00FFFFFFU & dtohl(e.target_id)) < target_id;
-  });
-
-  if (entry != end_entry && (0x00FFFFFFU & dtohl(entry->target_id)) == target_res_id) {
-    uint32_t overlay_resource_id = dtohl(entry->overlay_id);
+  const int32_t index = entry_index_->Find(target_res_id);
+  if (index >= 0) {
+    uint32_t overlay_resource_id = dtohl(entries_[index].overlay_id);
     // Lookup the resource without rewriting the overlay resource id back to the target resource id
     // being looked up.
     overlay_ref_table_->lookupResourceIdNoRewrite(&overlay_resource_id);
@@ -173,17 +245,9 @@ IdmapResMap::Result IdmapResMap::Lookup(uint32_t target_res_id) const {
   }
 
   // Check if the target resources is mapped to an inline table entry.
-  auto first_inline_entry = inline_entries_;
-  auto end_inline_entry = inline_entries_ + dtohl(data_header_->target_inline_entry_count);
-  auto inline_entry = std::lower_bound(first_inline_entry, end_inline_entry, target_res_id,
-                                       [](const Idmap_target_entry_inline& e,
-                                          const uint32_t target_id) {
-    return (0x00FFFFFFU & dtohl(e.target_id)) < target_id;
-  });
-
-  if (inline_entry != end_inline_entry &&
-      (0x00FFFFFFU & dtohl(inline_entry->target_id)) == target_res_id) {
-    return Result(inline_entry->value);
+  const int32_t inline_index = inline_entry_index_->Find(target_res_id);
+  if (inline_index >= 0) {
+    return Result(inline_entries_[inline_index].value);
   }
   return {};
 }
@@ -230,6 +294,18 @@ std::optional<std::string_view> ReadString(const uint8_t** in_out_data_ptr, size
   }
   return std::string_view(data, *len);
 }
+
+// Returns whether the ids of `entries` as given by `get_id` are sorted.
+template <typename T, typename Func>
+bool AreIdsSorted(const T* entries, uint32_t count, const std::string& label, Func get_id) {
+  for (uint32_t i = 1; i < count; i++) {
+    if (get_id(entries[i]) < get_id(entries[i - 1])) {
+      LOG(ERROR) << "Idmap " << label << " entries are not sorted.";
+      return false;
+    }
+  }
+  return true;
+}
 } // namespace
 
 LoadedIdmap::LoadedIdmap(std::string&& idmap_path,
@@ -326,11 +402,39 @@ std::unique_ptr<LoadedIdmap> LoadedIdmap::Load(const StringPiece& idmap_path,
     return {};
   }
 
+  // Target ids are matched without their package id.
+  const uint32_t target_count = dtohl(data_header->target_entry_count);
+  const uint32_t target_inline_count = dtohl(data_header->target_inline_entry_count);
+  const uint32_t overlay_count = dtohl(data_header->overlay_entry_count);
+  const bool target_sorted = AreIdsSorted(target_entries, target_count, "target",
+                                          [](const Idmap_target_entry& e) {
+    return 0x00FFFFFFU & dtohl(e.target_id);
+  });
+  const bool target_inline_sorted = AreIdsSorted(
+      target_inline_entries, target_inline_count, "target inline",
+      [](const Idmap_target_entry_inline& e) { return 0x00FFFFFFU & dtohl(e.target_id); });
+  const bool overlay_sorted = AreIdsSorted(overlay_entries, overlay_count, "overlay",
+                                           [](const Idmap_overlay_entry& e) {
+    return dtohl(e.overlay_id);
+  });
+  if (!target_sorted || !target_inline_sorted || !overlay_sorted) {
+    return {};
+  }
+
   // Can't use make_unique because LoadedIdmap constructor is private.
-  return std::unique_ptr<LoadedIdmap>(
+  auto loaded_idmap = std::unique_ptr<LoadedIdmap>(
       new LoadedIdmap(idmap_path.to_string(), header, data_header, target_entries,
                       target_inline_entries, overlay_entries, std::move(idmap_string_pool),
                       *target_path, *overlay_path));
+  loaded_idmap->target_index_ = IdmapEntryIndex(&target_entries->target_id,
+                                                sizeof(Idmap_target_entry), target_count,
+                                                0x00FFFFFFU);
+  loaded_idmap->target_inline_index_ = IdmapEntryIndex(&target_inline_entries->target_id,
+                                                       sizeof(Idmap_target_entry_inline),
+                                                       target_inline_count, 0x00FFFFFFU);
+  loaded_idmap->overlay_index_ = IdmapEntryIndex(&overlay_entries->overlay_id,
+                                                 sizeof(Idmap_overlay_entry), overlay_count);
+  return loaded_idmap;
 }
 
 bool LoadedIdmap::IsUpToDate() const {
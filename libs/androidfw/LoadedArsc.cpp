@@ -55,6 +55,7 @@ struct TypeSpecBuilder {
   void AddType(incfs::verified_map_ptr<ResTable_type> type) {
     TypeSpec::TypeEntry& entry = type_entries.emplace_back();
     entry.config.copyFromDtoH(type->config);
+    entry.packed_config = entry.config.packAxes();
     entry.type = type;
   }
 
@@ -306,9 +307,45 @@ base::expected<incfs::map_ptr<ResTable_entry>, NullOrIOError> LoadedPackage::Get
   return type_chunk.offset(offset + dtohl(type_chunk->entriesStart)).convert<ResTable_entry>();
 }
 
+void LoadedPackage::LoadDeferredTypes(uint8_t type_id) const {
+  const auto deferred = deferred_types_.find(type_id);
+  if (deferred == deferred_types_.end()) {
+    return;
+  }
+
+  std::call_once(deferred->second->loaded, [&]() {
+    ATRACE_NAME("LoadedPackage::LoadDeferredTypes");
+    // Other threads may be reading type_specs_, so it must not be inserted into here. Deferred
+    // types are only recorded for types with a TypeSpec, so the lookup should always succeed.
+    const auto type_spec_iter = type_specs_.find(type_id);
+    if (type_spec_iter == type_specs_.end()) {
+      LOG(ERROR) << StringPrintf("Deferred types with ID %02x in '%s' have no TypeSpec.", type_id,
+                                 package_name_.c_str());
+      return;
+    }
+    TypeSpec& type_spec = type_spec_iter->second;
+    type_spec.type_entries.reserve(deferred->second->types.size());
+    for (const auto& type : deferred->second->types) {
+      if (!VerifyResTableType(type)) {
+        LOG(ERROR) << StringPrintf("Skipping corrupt RES_TABLE_TYPE_TYPE with ID %02x in '%s'.",
+                                   type_id, package_name_.c_str());
+        continue;
+      }
+      TypeSpec::TypeEntry& entry = type_spec.type_entries.emplace_back();
+      entry.config.copyFromDtoH(type->config);
+      entry.packed_config = entry.config.packAxes();
+      entry.type = type.verified();
+    }
+
+    // The chunk pointers are no longer needed once the type entries are built.
+    std::vector<incfs::map_ptr<ResTable_type>>().swap(deferred->second->types);
+  });
+}
+
 base::expected<std::monostate, IOError> LoadedPackage::CollectConfigurations(
     bool exclude_mipmap, std::set<ResTable_config>* out_configs) const {\
   for (const auto& type_spec : type_specs_) {
+    LoadDeferredTypes(type_spec.first);
     if (exclude_mipmap) {
       const int type_idx = type_spec.first - 1;
       const auto type_name16 = type_string_pool_.stringAt(type_idx);
@@ -344,6 +381,7 @@ base::expected<std::monostate, IOError> LoadedPackage::CollectConfigurations(
 void LoadedPackage::CollectLocales(bool canonicalize, std::set<std::string>* out_locales) const {
   char temp_locale[RESTABLE_MAX_LOCALE_LEN];
   for (const auto& type_spec : type_specs_) {
+    LoadDeferredTypes(type_spec.first);
     for (const auto& type_entry : type_spec.second.type_entries) {
       if (type_entry.config.locale != 0) {
         type_entry.config.getBcp47Locale(temp_locale, canonicalize);
@@ -467,6 +505,11 @@ std::unique_ptr<const LoadedPackage> LoadedPackage::Load(const Chunk& chunk,
   util::ReadUtf16StringFromDevice(header->name, arraysize(header->name),
                                   &loaded_package->package_name_);
 
+  const bool lazy_types = (property_flags & PROPERTY_LAZY_TYPES) != 0;
+  if (lazy_types) {
+    loaded_package->property_flags_ |= PROPERTY_LAZY_TYPES;
+  }
+
   // A map of TypeSpec builders, each associated with an type index.
   // We use these to accumulate the set of Types available for a TypeSpec, and later build a single,
   // contiguous block of memory that holds all the Types together with the TypeSpec.
@@ -557,13 +600,25 @@ std::unique_ptr<const LoadedPackage> LoadedPackage::Load(const Chunk& chunk,
           return {};
         }
 
-        if (!VerifyResTableType(type)) {
+        if (lazy_types) {
+          // Only remember where the type is. It is validated when its TypeSpec is first accessed.
+          if (type->id == 0) {
+            LOG(ERROR) << "RES_TABLE_TYPE_TYPE has invalid ID 0.";
+            return {};
+          }
+        } else if (!VerifyResTableType(type)) {
           return {};
         }
 
         // Type chunks must be preceded by their TypeSpec chunks.
         std::unique_ptr<TypeSpecBuilder>& builder_ptr = type_builder_map[type->id];
-        if (builder_ptr != nullptr) {
+        if (builder_ptr != nullptr && lazy_types) {
+          auto& deferred = loaded_package->deferred_types_[type->id];
+          if (deferred == nullptr) {
+            deferred = util::make_unique<LoadedPackage::DeferredTypes>();
+          }
+          deferred->types.push_back(type);
+        } else if (builder_ptr != nullptr) {
           builder_ptr->AddType(type.verified());
         } else {
           LOG(ERROR) << StringPrintf(
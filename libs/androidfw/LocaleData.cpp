@@ -132,14 +132,30 @@ inline bool isSpecialSpanish(uint32_t language_and_region) {
     return (language_and_region == US_SPANISH || language_and_region == MEXICAN_SPANISH);
 }
 
-int localeDataCompareRegions(
+// The result of a previous localeDataCompareRegions() call. Best-match selection compares the
+// same few locales against the same request over and over again, so each thread remembers the
+// most recent comparisons instead of walking the parent tables every time.
+struct RegionComparison {
+    uint64_t request; // language, script and region of the request
+    uint32_t regions; // left and right regions
+    int result;
+    bool valid;
+};
+
+const size_t REGION_COMPARISON_CACHE_SIZE = 64; // must be a power of two
+
+inline uint64_t packRequest(const char* language, const char* script, const char* region) {
+    uint64_t packed = 0;
+    memcpy(&packed, language, 2);
+    memcpy(reinterpret_cast<char*>(&packed) + 2, script, SCRIPT_LENGTH);
+    memcpy(reinterpret_cast<char*>(&packed) + 6, region, 2);
+    return packed;
+}
+
+int compareRegionsUncached(
         const char* left_region, const char* right_region,
         const char* requested_language, const char* requested_script,
         const char* requested_region) {
-
-    if (left_region[0] == right_region[0] && left_region[1] == right_region[1]) {
-        return 0;
-    }
     uint32_t left = packLocale(requested_language, left_region);
     uint32_t right = packLocale(requested_language, right_region);
     const uint32_t request = packLocale(requested_language, requested_region);
@@ -198,6 +214,32 @@ int localeDataCompareRegions(
     return (int64_t) right - (int64_t) left;
 }
 
+int localeDataCompareRegions(
+        const char* left_region, const char* right_region,
+        const char* requested_language, const char* requested_script,
+        const char* requested_region) {
+
+    if (left_region[0] == right_region[0] && left_region[1] == right_region[1]) {
+        return 0;
+    }
+
+    static thread_local RegionComparison cache[REGION_COMPARISON_CACHE_SIZE];
+    const uint64_t request = packRequest(requested_language, requested_script, requested_region);
+    const uint32_t regions = packLocale(left_region, right_region);
+    uint64_t hash = (request ^ regions) * 0x9E3779B97F4A7C15ULL;
+    RegionComparison& entry = cache[(hash >> 32u) & (REGION_COMPARISON_CACHE_SIZE - 1)];
+    if (entry.valid && entry.request == request && entry.regions == regions) {
+        return entry.result;
+    }
+
+    entry.result = compareRegionsUncached(left_region, right_region, requested_language,
+                                          requested_script, requested_region);
+    entry.request = request;
+    entry.regions = regions;
+    entry.valid = true;
+    return entry.result;
+}
+
 void localeDataComputeScript(char out[4], const char* language, const char* region) {
     if (language[0] == '\0') {
         memset(out, '\0', SCRIPT_LENGTH);
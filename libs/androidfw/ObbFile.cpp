@@ -21,8 +21,14 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <memory>
+#include <new>
+
 #define LOG_TAG "ObbFile"
 
+#include <android-base/file.h>
+
 #include <androidfw/ObbFile.h>
 #include <utils/Compat.h>
 #include <utils/Log.h>
@@ -127,27 +133,32 @@ bool ObbFile::parseObbFile(int fd)
         return false;
     }
 
-    ssize_t actual;
+    // The footer is at most kMaxBufSize bytes, so read it together with its tag in one go instead
+    // of seeking to the tag, reading it, seeking to the footer and reading that.
+    const size_t tailSize = std::min<off64_t>(fileLength, kFooterTagSize + kMaxBufSize);
+    std::unique_ptr<unsigned char[]> tail(new (std::nothrow) unsigned char[tailSize]);
+    if (tail == nullptr) {
+        ALOGW("couldn't allocate %zu bytes for ObbFile footer\n", tailSize);
+        return false;
+    }
+    if (!base::ReadFullyAtOffset(fd, tail.get(), tailSize, fileLength - (off64_t)tailSize)) {
+        ALOGW("couldn't read ObbFile footer: %s\n", strerror(errno));
+        return false;
+    }
+
     size_t footerSize;
 
     {
-        lseek64(fd, fileLength - kFooterTagSize, SEEK_SET);
-
-        char footer[kFooterTagSize];
-        actual = TEMP_FAILURE_RETRY(read(fd, footer, kFooterTagSize));
-        if (actual != kFooterTagSize) {
-            ALOGW("couldn't read footer signature: %s\n", strerror(errno));
-            return false;
-        }
+        const unsigned char* footer = tail.get() + tailSize - kFooterTagSize;
 
-        unsigned int fileSig = get4LE((unsigned char*)footer + sizeof(int32_t));
+        unsigned int fileSig = get4LE(footer + sizeof(int32_t));
         if (fileSig != kSignature) {
             ALOGW("footer didn't match magic string (expected 0x%08x; got 0x%08x)\n",
                     kSignature, fileSig);
             return false;
         }
 
-        footerSize = get4LE((unsigned char*)footer);
+        footerSize = get4LE(footer);
         if (footerSize > (size_t)fileLength - kFooterTagSize
                 || footerSize > kMaxBufSize) {
             ALOGW("claimed footer size is too large (0x%08zx; file size is 0x%08lld)\n",
@@ -162,27 +173,10 @@ bool ObbFile::parseObbFile(int fd)
         }
     }
 
-    off64_t fileOffset = fileLength - footerSize - kFooterTagSize;
-    if (lseek64(fd, fileOffset, SEEK_SET) != fileOffset) {
-        ALOGW("seek %lld failed: %s\n", (long long int)fileOffset, strerror(errno));
-        return false;
-    }
-
-    mFooterStart = fileOffset;
+    mFooterStart = fileLength - footerSize - kFooterTagSize;
 
-    char* scanBuf = (char*)malloc(footerSize);
-    if (scanBuf == NULL) {
-        ALOGW("couldn't allocate scanBuf: %s\n", strerror(errno));
-        return false;
-    }
-
-    actual = TEMP_FAILURE_RETRY(read(fd, scanBuf, footerSize));
-    // readAmount is guaranteed to be less than kMaxBufSize
-    if (actual != (ssize_t)footerSize) {
-        ALOGI("couldn't read ObbFile footer: %s\n", strerror(errno));
-        free(scanBuf);
-        return false;
-    }
+    // footerSize is guaranteed to fit in the tail read above
+    const unsigned char* scanBuf = tail.get() + tailSize - kFooterTagSize - footerSize;
 
 #ifdef DEBUG
     for (int i = 0; i < footerSize; ++i) {
@@ -190,31 +184,27 @@ bool ObbFile::parseObbFile(int fd)
     }
 #endif
 
-    uint32_t sigVersion = get4LE((unsigned char*)scanBuf);
+    uint32_t sigVersion = get4LE(scanBuf);
     if (sigVersion != kSigVersion) {
         ALOGW("Unsupported ObbFile version %d\n", sigVersion);
-        free(scanBuf);
         return false;
     }
 
-    mVersion = (int32_t) get4LE((unsigned char*)scanBuf + kPackageVersionOffset);
-    mFlags = (int32_t) get4LE((unsigned char*)scanBuf + kFlagsOffset);
+    mVersion = (int32_t) get4LE(scanBuf + kPackageVersionOffset);
+    mFlags = (int32_t) get4LE(scanBuf + kFlagsOffset);
 
-    memcpy(&mSalt, (unsigned char*)scanBuf + kSaltOffset, sizeof(mSalt));
+    memcpy(&mSalt, scanBuf + kSaltOffset, sizeof(mSalt));
 
-    size_t packageNameLen = get4LE((unsigned char*)scanBuf + kPackageNameLenOffset);
+    size_t packageNameLen = get4LE(scanBuf + kPackageNameLenOffset);
     if (packageNameLen == 0
             || packageNameLen > (footerSize - kPackageNameOffset)) {
         ALOGW("bad ObbFile package name length (0x%04zx; 0x%04zx possible)\n",
                 packageNameLen, footerSize - kPackageNameOffset);
-        free(scanBuf);
         return false;
     }
 
-    char* packageName = reinterpret_cast<char*>(scanBuf + kPackageNameOffset);
-    mPackageName = String8(const_cast<char*>(packageName), packageNameLen);
-
-    free(scanBuf);
+    const char* packageName = reinterpret_cast<const char*>(scanBuf + kPackageNameOffset);
+    mPackageName = String8(packageName, packageNameLen);
 
 #ifdef DEBUG
     ALOGI("Obb scan succeeded: packageName=%s, version=%d\n", mPackageName.string(), mVersion);
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG ATRACE_TAG_RESOURCES
+
+#include "androidfw/ResolvedSnapshot.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "android-base/file.h"
+#include "android-base/logging.h"
+#include "android-base/stringprintf.h"
+#include "android-base/unique_fd.h"
+#include "androidfw/ApkAssets.h"
+#include "androidfw/Idmap.h"
+#include "androidfw/misc.h"
+#include "utils/Trace.h"
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+namespace android {
+
+namespace {
+
+constexpr size_t AlignedKeySize(size_t key_size) {
+  return (key_size + 3u) & ~static_cast<size_t>(3u);
+}
+
+template <typename T>
+void AppendRecords(std::string& out, const T* records, size_t count) {
+  out.append(reinterpret_cast<const char*>(records), count * sizeof(T));
+}
+
+template <typename T>
+const T* FindRecord(const T* records, size_t count, uint32_t resid) {
+  const T* end = records + count;
+  const T* record = std::lower_bound(records, end, resid, [](const T& r, uint32_t id) {
+    return r.resid < id;
+  });
+  return (record != end && record->resid == resid) ? record : nullptr;
+}
+
+}  // namespace
+
+std::optional<std::string> ResolvedSnapshot::MakeKey(
+    const std::vector<const ApkAssets*>& apk_assets) {
+  std::string key;
+  for (const ApkAssets* assets : apk_assets) {
+    if (assets->IsLoader()) {
+      // Loaders are modified by the app at runtime.
+      return {};
+    }
+
+    auto path = assets->GetPath();
+    if (!path.has_value()) {
+      return {};
+    }
+    const std::string path_str(*path);
+    base::StringAppendF(&key, "%s@%lld;", path_str.c_str(),
+                        static_cast<long long>(getFileModDate(path_str.c_str())));
+
+    // The idmap is regenerated whenever the CRC of the target or overlay changes.
+    if (const LoadedIdmap* idmap = assets->GetLoadedIdmap(); idmap != nullptr) {
+      const std::string idmap_path(idmap->IdmapPath());
+      base::StringAppendF(&key, "%s@%lld;", idmap_path.c_str(),
+                          static_cast<long long>(getFileModDate(idmap_path.c_str())));
+    }
+  }
+  return key;
+}
+
+std::unique_ptr<const ResolvedSnapshot> ResolvedSnapshot::Load(const std::string& path,
+                                                               const std::string& key) {
+  ATRACE_NAME("ResolvedSnapshot::Load");
+  base::unique_fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_BINARY));
+  if (fd.get() < 0) {
+    return {};
+  }
+
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(ResolvedSnapshot_header)) {
+    return {};
+  }
+
+  auto file_map = std::make_unique<FileMap>();
+  if (!file_map->create(path.c_str(), fd.get(), 0, static_cast<size_t>(st.st_size),
+                        true /* readOnly */)) {
+    LOG(ERROR) << "Failed to mmap resolved snapshot '" << path << "'";
+    return {};
+  }
+
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(file_map->getDataPtr());
+  const auto header = reinterpret_cast<const ResolvedSnapshot_header*>(data);
+  if (header->magic != kMagic || header->version != kVersion) {
+    return {};
+  }
+
+  const size_t values_offset = sizeof(*header) + AlignedKeySize(header->key_size);
+  const uint64_t bags_offset = uint64_t(values_offset) +
+      uint64_t(header->value_count) * sizeof(ResolvedSnapshot_value);
+  const uint64_t entries_offset = bags_offset +
+      uint64_t(header->bag_count) * sizeof(ResolvedSnapshot_bag);
+  const uint64_t expected_size = entries_offset +
+      uint64_t(header->bag_entry_count) * sizeof(ResolvedSnapshot_bag_entry);
+  if (expected_size != static_cast<uint64_t>(st.st_size)) {
+    LOG(ERROR) << "Resolved snapshot '" << path << "' is truncated or corrupt";
+    return {};
+  }
+
+  const char* key_data = reinterpret_cast<const char*>(data + sizeof(*header));
+  if (key.size() != header->key_size || key.compare(0, key.size(), key_data, key.size()) != 0) {
+    // The snapshot was written for other ApkAssets or older versions of them.
+    return {};
+  }
+
+  std::unique_ptr<ResolvedSnapshot> snapshot(new ResolvedSnapshot());
+  snapshot->key_ = key;
+  snapshot->header_ = header;
+  snapshot->values_ = reinterpret_cast<const ResolvedSnapshot_value*>(data + values_offset);
+  snapshot->bags_ = reinterpret_cast<const ResolvedSnapshot_bag*>(data + bags_offset);
+  snapshot->bag_entries_ = reinterpret_cast<const ResolvedSnapshot_bag_entry*>(
+      data + entries_offset);
+
+  for (uint32_t i = 0; i < header->bag_count; i++) {
+    const ResolvedSnapshot_bag& bag = snapshot->bags_[i];
+    if (uint64_t(bag.entries_start) + bag.entry_count > header->bag_entry_count) {
+      LOG(ERROR) << "Resolved snapshot '" << path << "' has out of bounds bag entries";
+      return {};
+    }
+  }
+
+  snapshot->file_map_ = std::move(file_map);
+  return snapshot;
+}
+
+bool ResolvedSnapshot::Write(const std::string& path, const std::string& key,
+                             const ResTable_config& configuration,
+                             std::vector<ResolvedSnapshot_value> values,
+                             std::vector<ResolvedSnapshot_bag> bags,
+                             const std::vector<ResolvedSnapshot_bag_entry>& bag_entries) {
+  ATRACE_NAME("ResolvedSnapshot::Write");
+  auto by_resid = [](const auto& a, const auto& b) { return a.resid < b.resid; };
+  std::sort(values.begin(), values.end(), by_resid);
+  std::sort(bags.begin(), bags.end(), by_resid);
+
+  ResolvedSnapshot_header header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.key_size = static_cast<uint32_t>(key.size());
+  header.value_count = static_cast<uint32_t>(values.size());
+  header.bag_count = static_cast<uint32_t>(bags.size());
+  header.bag_entry_count = static_cast<uint32_t>(bag_entries.size());
+  header.configuration = configuration;
+
+  std::string contents;
+  AppendRecords(contents, &header, 1u);
+  contents.append(key);
+  contents.resize(sizeof(header) + AlignedKeySize(key.size()), '\0');
+  AppendRecords(contents, values.data(), values.size());
+  AppendRecords(contents, bags.data(), bags.size());
+  AppendRecords(contents, bag_entries.data(), bag_entries.size());
+
+  // Write to a temporary file first so that readers never map a partially written snapshot.
+  const std::string temp_path = path + ".tmp";
+  if (!base::WriteStringToFile(contents, temp_path)) {
+    PLOG(ERROR) << "Failed to write resolved snapshot '" << temp_path << "'";
+    return false;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    PLOG(ERROR) << "Failed to rename resolved snapshot to '" << path << "'";
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+const ResolvedSnapshot_value* ResolvedSnapshot::FindValue(uint32_t resid) const {
+  return FindRecord(values_, header_->value_count, resid);
+}
+
+const ResolvedSnapshot_bag* ResolvedSnapshot::FindBag(uint32_t resid) const {
+  return FindRecord(bags_, header_->bag_count, resid);
+}
+
+}  // namespace android
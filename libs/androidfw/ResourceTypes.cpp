@@ -29,6 +29,7 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <new>
 #include <set>
 #include <type_traits>
 #include <vector>
@@ -434,13 +435,27 @@ Res_png_9patch* Res_png_9patch::deserialize(void* inData)
 // --------------------------------------------------------------------
 // --------------------------------------------------------------------
 
+// Decoded strings are packed into blocks of this size to avoid paying a heap allocation and its
+// overhead for every string. Strings that don't fit comfortably get a block of their own.
+static const size_t kDecodeBlockSize = 4096;
+
+struct ResStringPool::DecodeBlock {
+    DecodeBlock* next;
+    size_t used;      // number of char16_t
+    size_t capacity;  // number of char16_t
+
+    char16_t* data() {
+        return reinterpret_cast<char16_t*>(this + 1);
+    }
+};
+
 ResStringPool::ResStringPool()
-    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL)
+    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL), mCacheBlocks(NULL)
 {
 }
 
 ResStringPool::ResStringPool(const void* data, size_t size, bool copyData)
-    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL)
+    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL), mCacheBlocks(NULL)
 {
     setTo(data, size, copyData);
 }
@@ -681,16 +696,16 @@ status_t ResStringPool::getError() const
 void ResStringPool::uninit()
 {
     mError = NO_INIT;
-    if (mHeader && mCache != NULL) {
-        for (size_t x = 0; x < mHeader->stringCount; x++) {
-            if (mCache[x] != NULL) {
-                free(mCache[x]);
-                mCache[x] = NULL;
-            }
-        }
+    if (mCache != NULL) {
         free(mCache);
         mCache = NULL;
     }
+    while (mCacheBlocks != NULL) {
+        DecodeBlock* next = mCacheBlocks->next;
+        free(mCacheBlocks);
+        mCacheBlocks = next;
+    }
+    mCacheStats = DecodeCacheStats();
     if (mOwnedData) {
         free(mOwnedData);
         mOwnedData = NULL;
@@ -814,6 +829,7 @@ base::expected<StringPiece16, NullOrIOError> ResStringPool::stringAt(size_t idx)
                     AutoMutex lock(mDecodeLock);
 
                     if (mCache != NULL && mCache[idx] != NULL) {
+                        mCacheStats.hits++;
                         return StringPiece16(mCache[idx], *u16len);
                     }
 
@@ -839,16 +855,6 @@ base::expected<StringPiece16, NullOrIOError> ResStringPool::stringAt(size_t idx)
                     }
 
                     u16len = (size_t) actualLen;
-                    auto u16str = (char16_t *)calloc(*u16len+1, sizeof(char16_t));
-                    if (!u16str) {
-                        ALOGW("No memory when trying to allocate decode cache for string #%d\n",
-                                (int)idx);
-                        return base::unexpected(std::nullopt);
-                    }
-
-                    utf8_to_utf16(reinterpret_cast<const uint8_t*>(decodedString->data()),
-                                  decodedString->size(), u16str, *u16len + 1);
-
                     if (mCache == NULL) {
 #ifndef __ANDROID__
                         if (kDebugStringPoolNoisy) {
@@ -866,13 +872,26 @@ base::expected<StringPiece16, NullOrIOError> ResStringPool::stringAt(size_t idx)
                                   (int)(mHeader->stringCount*sizeof(char16_t**)));
                             return base::unexpected(std::nullopt);
                         }
+                        mCacheStats.bytes += mHeader->stringCount * sizeof(char16_t*);
+                    }
+
+                    auto u16str = allocDecodeString(*u16len);
+                    if (!u16str) {
+                        ALOGW("No memory when trying to allocate decode cache for string #%d\n",
+                                (int)idx);
+                        return base::unexpected(std::nullopt);
                     }
 
+                    utf8_to_utf16(reinterpret_cast<const uint8_t*>(decodedString->data()),
+                                  decodedString->size(), u16str, *u16len + 1);
+
                     if (kDebugStringPoolNoisy) {
                       ALOGI("Caching UTF8 string: %s", u8str.unsafe_ptr());
                     }
 
                     mCache[idx] = u16str;
+                    mCacheStats.misses++;
+                    mCacheStats.strings++;
                     return StringPiece16(u16str, *u16len);
                 } else {
                     ALOGW("Bad string block: string #%lld extends to %lld, past end at %lld\n",
@@ -889,6 +908,45 @@ base::expected<StringPiece16, NullOrIOError> ResStringPool::stringAt(size_t idx)
     return base::unexpected(std::nullopt);
 }
 
+char16_t* ResStringPool::allocDecodeString(size_t u16len) const
+{
+    // Must be called with mDecodeLock held and mCache allocated.
+    const size_t needed = u16len + 1;
+    if (mCacheBlocks == NULL || mCacheBlocks->capacity - mCacheBlocks->used < needed) {
+        const size_t blockCapacity = std::max(needed,
+                (kDecodeBlockSize - sizeof(DecodeBlock)) / sizeof(char16_t));
+        auto block = (DecodeBlock*)malloc(sizeof(DecodeBlock) + blockCapacity * sizeof(char16_t));
+        if (block == NULL) {
+            return NULL;
+        }
+        block->used = 0;
+        block->capacity = blockCapacity;
+        if (mCacheBlocks != NULL && needed * 4 > mCacheBlocks->capacity) {
+            // Keep the partially filled block at the front so that later small strings still
+            // use its remaining space.
+            block->next = mCacheBlocks->next;
+            mCacheBlocks->next = block;
+        } else {
+            block->next = mCacheBlocks;
+            mCacheBlocks = block;
+        }
+        mCacheStats.bytes += sizeof(DecodeBlock) + blockCapacity * sizeof(char16_t);
+        char16_t* str = block->data();
+        block->used = needed;
+        return str;
+    }
+
+    char16_t* str = mCacheBlocks->data() + mCacheBlocks->used;
+    mCacheBlocks->used += needed;
+    return str;
+}
+
+ResStringPool::DecodeCacheStats ResStringPool::getDecodeCacheStats() const
+{
+    AutoMutex lock(mDecodeLock);
+    return mCacheStats;
+}
+
 base::expected<StringPiece, NullOrIOError> ResStringPool::string8At(size_t idx) const
 {
     if (mError == NO_ERROR && idx < mHeader->stringCount) {
@@ -1411,11 +1469,10 @@ uint32_t ResXMLParser::getAttributeNameResID(size_t idx) const
 {
     int32_t id = getAttributeNameID(idx);
     if (id >= 0 && (size_t)id < mTree.mNumResIds) {
-        uint32_t resId = dtohl(mTree.mResIds[id]);
-        if (mTree.mDynamicRefTable != NULL) {
-            mTree.mDynamicRefTable->lookupResourceId(&resId);
+        if (mTree.mResolvedResIds != NULL) {
+            return mTree.mResolvedResIds[id];
         }
-        return resId;
+        return dtohl(mTree.mResIds[id]);
     }
     return 0;
 }
@@ -1844,6 +1901,21 @@ status_t ResXMLTree::setTo(const void* data, size_t size, bool copyData)
         goto done;
     }
 
+    // Attribute resource ids are looked up for every attribute an inflater queries, so rewrite
+    // them through the dynamic reference table once instead of on every lookup.
+    if (mDynamicRefTable != NULL && mNumResIds > 0) {
+        mResolvedResIds.reset(new (std::nothrow) uint32_t[mNumResIds]);
+        if (mResolvedResIds == NULL) {
+            mError = NO_MEMORY;
+            goto done;
+        }
+        for (size_t i = 0; i < mNumResIds; i++) {
+            uint32_t resId = dtohl(mResIds[i]);
+            mDynamicRefTable->lookupResourceId(&resId);
+            mResolvedResIds[i] = resId;
+        }
+    }
+
     mError = mStrings.getError();
 
 done:
@@ -1860,6 +1932,7 @@ void ResXMLTree::uninit()
 {
     mError = NO_INIT;
     mStrings.uninit();
+    mResolvedResIds.reset();
     if (mOwnedData) {
         free(mOwnedData);
         mOwnedData = NULL;
@@ -2973,6 +3046,38 @@ bool ResTable_config::match(const ResTable_config& settings) const {
     return true;
 }
 
+ResTable_config::PackedAxes ResTable_config::packAxes() const {
+    PackedAxes packed = {};
+    // Each axis occupies its own bit range. The mask of an axis is only set when the axis is set,
+    // mirroring the "field != 0 && field != settings.field" checks of match().
+    auto pack = [&packed](int word, int shift, uint64_t field, uint64_t field_mask) {
+        packed.value[word] |= field << shift;
+        if (field != 0) {
+            packed.mask[word] |= field_mask << shift;
+        }
+    };
+
+    pack(0, 0, mcc, 0xffff);
+    pack(0, 16, mnc, 0xffff);
+    pack(0, 32, orientation, 0xff);
+    pack(0, 40, touchscreen, 0xff);
+    pack(0, 48, keyboard, 0xff);
+    pack(0, 56, navigation, 0xff);
+
+    pack(1, 0, screenLayout & MASK_LAYOUTDIR, MASK_LAYOUTDIR);
+    pack(1, 0, screenLayout & MASK_SCREENLONG, MASK_SCREENLONG);
+    pack(1, 8, uiMode & MASK_UI_MODE_TYPE, MASK_UI_MODE_TYPE);
+    pack(1, 8, uiMode & MASK_UI_MODE_NIGHT, MASK_UI_MODE_NIGHT);
+    pack(1, 16, screenLayout2 & MASK_SCREENROUND, MASK_SCREENROUND);
+    pack(1, 24, colorMode & MASK_HDR, MASK_HDR);
+    pack(1, 24, colorMode & MASK_WIDE_COLOR_GAMUT, MASK_WIDE_COLOR_GAMUT);
+    pack(1, 32, inputFlags & MASK_NAVHIDDEN, MASK_NAVHIDDEN);
+    pack(1, 48, minorVersion, 0xffff);
+
+    // MASK_KEYSHIDDEN is not packed because KEYSHIDDEN_NO also matches KEYSHIDDEN_SOFT.
+    return packed;
+}
+
 void ResTable_config::appendDirLocale(String8& out) const {
     if (!language[0]) {
         return;
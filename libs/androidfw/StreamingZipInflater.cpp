@@ -47,6 +47,15 @@ static inline size_t min_of(size_t a, size_t b) { return (a < b) ? a : b; }
 
 using namespace android;
 
+static size_t seekPointSpanFor(size_t uncompSize) {
+    if (uncompSize < StreamingZipInflater::MIN_INDEXED_SIZE) {
+        return 0;
+    }
+    size_t span = uncompSize / StreamingZipInflater::MAX_SEEK_POINTS;
+    return (span > StreamingZipInflater::MIN_SEEK_POINT_SPAN)
+            ? span : StreamingZipInflater::MIN_SEEK_POINT_SPAN;
+}
+
 /*
  * Streaming access to compressed asset data in an open fd
  */
@@ -64,6 +73,7 @@ StreamingZipInflater::StreamingZipInflater(int fd, off64_t compDataStart,
     mOutBufSize = StreamingZipInflater::OUTPUT_CHUNK_SIZE;
     mOutBuf = new uint8_t[mOutBufSize];
 
+    mSeekPointSpan = seekPointSpanFor(uncompSize);
     initInflateState();
 }
 
@@ -82,6 +92,7 @@ StreamingZipInflater::StreamingZipInflater(const incfs::IncFsFileMap* dataMap, s
     mOutBufSize = StreamingZipInflater::OUTPUT_CHUNK_SIZE;
     mOutBuf = new uint8_t[mOutBufSize];
 
+    mSeekPointSpan = seekPointSpanFor(uncompSize);
     initInflateState();
 }
 
@@ -109,6 +120,7 @@ void StreamingZipInflater::initInflateState() {
 
     mOutLastDecoded = mOutDeliverable = mOutCurPosition = 0;
     mInNextChunkOffset = 0;
+    mStreamOutStart = 0;
     mStreamNeedsInit = true;
 
     if (mDataMap == NULL) {
@@ -181,7 +193,9 @@ ssize_t StreamingZipInflater::read(void* outBuf, size_t count) {
                 result = inflateInit2(&mInflateState, -MAX_WBITS);
                 mStreamNeedsInit = false;
             }
-            if (result == Z_OK) result = ::inflate(&mInflateState, Z_SYNC_FLUSH);
+            // stop at the next block boundary when it is time to record a seek point.
+            int flush = isSeekPointDue() ? Z_BLOCK : Z_SYNC_FLUSH;
+            if (result == Z_OK) result = ::inflate(&mInflateState, flush);
             if (result < 0) {
                 // Whoops, inflation failed
                 ALOGE("Error inflating asset: %d", result);
@@ -193,6 +207,8 @@ ssize_t StreamingZipInflater::read(void* outBuf, size_t count) {
                     // we know we have to have reached the target size here and will
                     // not try to read any further, so just wind things up.
                     ::inflateEnd(&mInflateState);
+                } else if (flush == Z_BLOCK) {
+                    maybeAddSeekPoint();
                 }
 
                 // Note how much data we got, and off we go
@@ -227,10 +243,119 @@ int StreamingZipInflater::readNextChunk() {
     return 0;
 }
 
-// seeking backwards requires uncompressing fom the beginning, so is very
-// expensive.  seeking forwards only requires uncompressing from the current
-// position to the destination.
+bool StreamingZipInflater::isSeekPointDue() const {
+    if (mSeekPointSpan == 0 || mStreamNeedsInit || mSeekPoints.size() >= MAX_SEEK_POINTS) {
+        return false;
+    }
+    off64_t next = mSeekPoints.empty() ? mSeekPointSpan
+            : mSeekPoints.back().outOffset + mSeekPointSpan;
+    return off64_t(mStreamOutStart + mInflateState.total_out) >= next;
+}
+
+/*
+ * Records a seek point if inflate() stopped at the end of a block, following the
+ * approach of zlib's examples/zran.c.  The point holds the last 32KB of uncompressed
+ * data, which is all the state a raw inflate stream carries across blocks.
+ */
+void StreamingZipInflater::maybeAddSeekPoint() {
+    // bit 7 is set at the end of a block, bit 6 if that block was the last one
+    if ((mInflateState.data_type & 128) == 0 || (mInflateState.data_type & 64) != 0) {
+        return;
+    }
+
+    SeekPoint point;
+    point.outOffset = mStreamOutStart + mInflateState.total_out;
+    point.bits = mInflateState.data_type & 7;
+    point.lastByte = 0;
+    size_t consumed = mInflateState.next_in - (Bytef*) mInBuf;
+    point.inOffset = (mDataMap == NULL)
+            ? mInNextChunkOffset - mInflateState.avail_in : consumed;
+    if (point.bits > 0) {
+        if (consumed == 0) {
+            // the partially consumed byte was part of the previous input chunk; wait for
+            // the next boundary instead.
+            return;
+        }
+        point.lastByte = mInflateState.next_in[-1];
+    }
+
+    uInt windowSize = 1U << MAX_WBITS;
+    point.window.reset(new uint8_t[windowSize]);
+    if (inflateGetDictionary(&mInflateState, point.window.get(), &windowSize) != Z_OK) {
+        return;
+    }
+    point.windowSize = windowSize;
+
+    ALOGV("Recorded seek point at %" PRId64 " (input %zu)", (int64_t) point.outOffset,
+            point.inOffset);
+    mSeekPoints.push_back(std::move(point));
+}
+
+/*
+ * Restarts inflation at the given seek point.  On failure the stream is left
+ * rewound to the beginning of the blob.
+ */
+bool StreamingZipInflater::resumeFrom(const SeekPoint& point) {
+    if (!mStreamNeedsInit) {
+        ::inflateEnd(&mInflateState);
+    }
+    initInflateState();
+
+    if (mDataMap == NULL) {
+        ::lseek(mFd, mInFileStart + point.inOffset, SEEK_SET);
+        mInNextChunkOffset = point.inOffset;
+    } else {
+        mInflateState.next_in = (Bytef*) mInBuf + point.inOffset;
+        mInflateState.avail_in = mInBufSize - point.inOffset;
+    }
+
+    int result = inflateInit2(&mInflateState, -MAX_WBITS);
+    if (result != Z_OK) {
+        initInflateState();
+        return false;
+    }
+    mStreamNeedsInit = false;
+
+    if (point.bits > 0) {
+        result = inflatePrime(&mInflateState, point.bits, point.lastByte >> (8 - point.bits));
+    }
+    if (result == Z_OK) {
+        result = inflateSetDictionary(&mInflateState, point.window.get(), point.windowSize);
+    }
+    if (result != Z_OK) {
+        ALOGE("Unable to resume inflating asset at %" PRId64 ": %d",
+                (int64_t) point.outOffset, result);
+        ::inflateEnd(&mInflateState);
+        initInflateState();
+        return false;
+    }
+
+    mOutCurPosition = point.outOffset;
+    mStreamOutStart = point.outOffset;
+    return true;
+}
+
+// seeking backwards requires uncompressing from the nearest seek point, or from the
+// beginning if there is none, so can be expensive.  seeking forwards only requires
+// uncompressing from the current position to the destination.
 off64_t StreamingZipInflater::seekAbsolute(off64_t absoluteInputPosition) {
+    const SeekPoint* point = NULL;
+    for (const SeekPoint& candidate : mSeekPoints) {
+        if (candidate.outOffset > absoluteInputPosition) {
+            break;
+        }
+        point = &candidate;
+    }
+
+    // resume from the seek point if it saves decoding anything
+    if (point != NULL && (absoluteInputPosition < mOutCurPosition
+            || point->outOffset > mOutCurPosition)) {
+        if (resumeFrom(*point)) {
+            read(NULL, absoluteInputPosition - point->outOffset);
+            return absoluteInputPosition;
+        }
+    }
+
     if (absoluteInputPosition < mOutCurPosition) {
         // rewind and reprocess the data from the beginning
         if (!mStreamNeedsInit) {
@@ -17,8 +17,10 @@
 #ifndef APKASSETS_H_
 #define APKASSETS_H_
 
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "android-base/unique_fd.h"
@@ -60,6 +62,22 @@ class ApkAssets {
   static std::unique_ptr<ApkAssets> LoadOverlay(const std::string& idmap_path,
                                                 package_property_t flags = 0U);
 
+  // Describes one ApkAssets of a LoadAsync() batch.
+  struct LoadRequest {
+    // The path of the APK, or of the idmap if `overlay` is set.
+    std::string path;
+    package_property_t flags = 0U;
+    bool overlay = false;
+  };
+
+  static constexpr size_t kDefaultLoadThreads = 4U;
+
+  // Loads the ApkAssets described by `requests` concurrently on up to `max_threads` worker
+  // threads. The returned futures are in the order of `requests` and hold nullptr for the
+  // ApkAssets that failed to load.
+  static std::vector<std::future<std::unique_ptr<ApkAssets>>> LoadAsync(
+      std::vector<LoadRequest> requests, size_t max_threads = kDefaultLoadThreads);
+
   // Path to the contents of the ApkAssets on disk. The path could represent an APk, a directory,
   // or some other file type.
   std::optional<std::string_view> GetPath() const;
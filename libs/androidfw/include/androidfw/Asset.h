@@ -128,6 +128,17 @@ public:
      */
     virtual bool isAllocated(void) const { return false; }
 
+    /*
+     * Tell the kernel how the memory-mapped data of the asset is about to be
+     * read: ahead in large batches for ACCESS_STREAMING and ACCESS_BUFFER, only
+     * as touched for ACCESS_RANDOM.  Returns false if the asset has no mapped
+     * data or the hint could not be applied.
+     *
+     * Assets created from a map with ACCESS_STREAMING or ACCESS_BUFFER apply
+     * the hint for their mode when they are created.
+     */
+    virtual bool adviseAccess(AccessMode /* mode */) { return false; }
+
     /*
      * Get a string identifying the asset's source.  This might be a full
      * path, it might be a colon-separated list of identifiers.
@@ -280,6 +291,7 @@ public:
     off64_t getRemainingLength(void) const override { return mLength-mOffset; }
     int openFileDescriptor(off64_t* outStart, off64_t* outLength) const override;
     bool isAllocated(void) const override { return mBuf != NULL; }
+    bool adviseAccess(AccessMode mode) override;
 
 private:
     incfs::map_ptr<void> ensureAlignment(const incfs::IncFsFileMap& map);
@@ -338,6 +350,7 @@ public:
     virtual off64_t getRemainingLength(void) const { return mUncompressedLen-mOffset; }
     virtual int openFileDescriptor(off64_t* /* outStart */, off64_t* /* outLength */) const { return -1; }
     virtual bool isAllocated(void) const { return mBuf != NULL; }
+    virtual bool adviseAccess(AccessMode mode);
 
 private:
     off64_t mStart;           // offset to start of compressed data
@@ -21,6 +21,7 @@
 
 #include <array>
 #include <limits>
+#include <memory>
 #include <set>
 #include <unordered_map>
 
@@ -32,6 +33,7 @@
 
 namespace android {
 
+class ResolvedSnapshot;
 class Theme;
 
 using ApkAssetsCookie = int32_t;
@@ -137,6 +139,31 @@ class AssetManager2 {
   // caches that are related to the configuration change to be invalidated.
   void SetConfiguration(const ResTable_config& configuration);
 
+  // Enables or disables caches of resolved references and bags that are shared with every other
+  // AssetManager2 that has enabled them and has the same ApkAssets and configuration set.
+  //
+  // Lookups into the shared caches are lock-free, so AssetManagers used from different threads
+  // can share them safely. When disabled, this AssetManager keeps its own private caches.
+  void SetSharedCachesEnabled(bool enabled);
+
+  // Serves resolved references and bags from `snapshot` for as long as the ApkAssets and the
+  // configuration of this AssetManager are the ones the snapshot was written for. Passing nullptr
+  // stops using the snapshot.
+  void SetResolvedSnapshot(std::shared_ptr<const ResolvedSnapshot> snapshot);
+
+  // Writes the references and bags resolved so far to `path`, so that a later process can load
+  // them with ResolvedSnapshot::Load(). Returns false if any of the ApkAssets is not backed by a
+  // file or the snapshot could not be written.
+  bool WriteResolvedSnapshot(const std::string& path) const;
+
+  // Enables or disables the resolved entry index.
+  //
+  // When enabled, the entry selected for the current configuration is remembered per resource in a
+  // dense table that is built lazily for each type, so repeated lookups of the same resource skip
+  // the search through every matching configuration. Configuration changes only drop the types
+  // that vary with the changed configuration axis.
+  void SetResolvedIndexEnabled(bool enabled);
+
   inline const ResTable_config& GetConfiguration() const {
     return configuration_;
   }
@@ -364,6 +391,37 @@ class AssetManager2 {
       ApkAssetsCookie cookie;
   };
 
+  // The entry selected for a resource by FindEntryInternal for the current configuration.
+  struct ResolvedEntry {
+    enum : uint8_t {
+      // The entry has not been looked up yet.
+      kUnresolved = 0xff,
+
+      // No package in the group defines the entry for the current configuration.
+      kNoEntry = 0xfe,
+    };
+
+    // Index into PackageGroup::packages_ of the package defining the selected entry.
+    uint8_t package_index = kUnresolved;
+
+    // The offset of the entry within `type_entry->type`.
+    uint32_t offset = 0U;
+
+    // The bitmask of configuration axis with which the resource value varies.
+    uint32_t type_flags = 0U;
+
+    const TypeSpec::TypeEntry* type_entry = nullptr;
+  };
+
+  // The selected entries of one type, indexed by entry index.
+  struct ResolvedType {
+    // The union of the type flags of every resolved entry. Used to decide whether a configuration
+    // change can affect any of the entries.
+    uint32_t type_flags = 0U;
+
+    std::vector<ResolvedEntry> entries;
+  };
+
   // Represents a logical package, which can be made up of many individual packages. Each package
   // in a PackageGroup shares the same package name and package ID.
   struct PackageGroup {
@@ -379,6 +437,10 @@ class AssetManager2 {
 
       // A library reference table that contains build-package ID to runtime-package ID mappings.
       std::shared_ptr<DynamicRefTable> dynamic_ref_table = std::make_shared<DynamicRefTable>();
+
+      // The resolved entry index for the current configuration, indexed by type index. Only
+      // populated when the resolved index is enabled.
+      mutable std::vector<ResolvedType> resolved_types_;
   };
 
   // Finds the best entry for `resid` from the set of ApkAssets. The entry can be a simple
@@ -406,6 +468,19 @@ class AssetManager2 {
       const ResTable_config& desired_config, bool stop_at_first_match,
       bool ignore_configuration) const;
 
+  // Creates the FindEntryResult for the entry at `best_offset` in `best_type`.
+  base::expected<FindEntryResult, NullOrIOError> BuildFindEntryResult(
+      const PackageGroup& package_group, ApkAssetsCookie best_cookie,
+      const LoadedPackage* best_package, incfs::verified_map_ptr<ResTable_type> best_type,
+      const ResTable_config& best_config, uint32_t best_offset, uint32_t type_flags) const;
+
+  // Returns the resolved index of the type, creating it if needed.
+  ResolvedType* GetResolvedType(const PackageGroup& package_group, uint8_t type_idx) const;
+
+  // Returns the resolved index slot for the entry, or nullptr if the entry can't be indexed.
+  ResolvedEntry* GetResolvedEntry(const PackageGroup& package_group, uint8_t type_idx,
+                                  uint16_t entry_idx) const;
+
   // Assigns package IDs to all shared library ApkAssets.
   // Should be called whenever the ApkAssets are changed.
   void BuildDynamicRefTable();
@@ -421,11 +496,28 @@ class AssetManager2 {
   // Retrieves the APK paths of overlays that overlay non-system packages.
   std::set<const ApkAssets*> GetNonSystemOverlays() const;
 
+  // Selects `resolved_snapshot_` for lookups if it matches the current ApkAssets and
+  // configuration. Should be called whenever the ApkAssets or the configuration change.
+  void UpdateResolvedSnapshot();
+
+  // Attaches this AssetManager to the shared caches matching its current ApkAssets and
+  // configuration, creating them if no other AssetManager holds them.
+  // Should be called whenever the ApkAssets or the configuration change.
+  void UpdateSharedCaches();
+
+  // Stores `bag` in the cache for `resid` and returns the cached bag, which is the bag already
+  // cached by another AssetManager if the shared cache had one.
+  const ResolvedBag* CacheBag(uint32_t resid, util::unique_cptr<ResolvedBag> bag) const;
+
   // AssetManager2::GetBag(resid) wraps this function to track which resource ids have already
   // been seen while traversing bag parents.
   base::expected<const ResolvedBag*, NullOrIOError> GetBag(
       uint32_t resid, std::vector<uint32_t>& child_resids) const;
 
+  // Appends `resid` and the ids of its parents to `child_resids` by walking the bag entries,
+  // for bags served from a cache that doesn't record the ids it was built from.
+  void AppendBagResIdStack(uint32_t resid, std::vector<uint32_t>& child_resids) const;
+
   // The ordered list of ApkAssets to search. These are not owned by the AssetManager, and must
   // have a longer lifetime.
   std::vector<const ApkAssets*> apk_assets_;
@@ -455,6 +547,28 @@ class AssetManager2 {
   // Cached set of resolved resource values.
   mutable std::unordered_map<uint32_t, SelectedValue> cached_resolved_values_;
 
+  // Whether FindEntryInternal records its selections in PackageGroup::resolved_types_.
+  bool resolved_index_enabled_ = false;
+
+  // Caches of resolved values and bags shared with other AssetManagers. When set, these are used
+  // instead of `cached_bags_` and `cached_resolved_values_`.
+  struct SharedCaches;
+  bool shared_caches_enabled_ = false;
+  std::shared_ptr<SharedCaches> shared_caches_;
+
+  // Cached results of applying a style to the entries of a theme, so that themes rebuilt from the
+  // same styles share their entries instead of re-walking the bags. Created on first use.
+  struct ThemeStyleCache;
+  mutable std::shared_ptr<ThemeStyleCache> theme_style_cache_;
+
+  // The snapshot set with SetResolvedSnapshot(), and the same snapshot while it matches the
+  // current ApkAssets and configuration.
+  std::shared_ptr<const ResolvedSnapshot> resolved_snapshot_;
+  const ResolvedSnapshot* active_snapshot_ = nullptr;
+
+  // The ApkAssets whose key was last found to match the key of `resolved_snapshot_`.
+  std::vector<const ApkAssets*> snapshot_apk_assets_;
+
   // Whether or not to save resource resolution steps
   bool resource_resolution_logging_enabled_ = false;
 
@@ -569,10 +683,16 @@ class Theme {
 
   explicit Theme(AssetManager2* asset_manager);
 
+  // Returns the entries of this theme, sorted by attribute resource ID.
+  const std::vector<Entry>& GetEntries() const;
+
   AssetManager2* asset_manager_ = nullptr;
   uint32_t type_spec_flags_ = 0u;
 
-  std::vector<Entry> entries_;
+  // The entries are never modified in place: themes set from one another, and themes built by
+  // applying the same styles in the same order, share a single vector. Null when the theme is
+  // empty.
+  std::shared_ptr<const std::vector<Entry>> entries_;
 };
 
 inline const ResolvedBag::Entry* begin(const ResolvedBag* bag) {
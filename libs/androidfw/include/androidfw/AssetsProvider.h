@@ -18,7 +18,10 @@
 #define ANDROIDFW_ASSETSPROVIDER_H
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "android-base/unique_fd.h"
@@ -121,10 +124,23 @@ struct ZipAssetsProvider : public AssetsProvider {
     bool is_path_;
   };
 
+  // The names of all entries of the archive in lexicographic order, so that listing a directory
+  // only visits the entries under it and skips over its subdirectories.
+  struct EntryIndex {
+    std::string names;
+    std::vector<std::string_view> sorted_names;
+  };
+
+  // Returns the index, building it on first use, or null if the archive could not be iterated.
+  const EntryIndex* GetEntryIndex() const;
+
   std::unique_ptr<ZipArchive, void (*)(ZipArchive*)> zip_handle_;
   PathOrDebugName name_;
   package_property_t flags_;
   time_t last_mod_time_;
+
+  mutable std::once_flag entry_index_once_;
+  mutable std::unique_ptr<EntryIndex> entry_index_;
 };
 
 // Supplies assets from a root directory.
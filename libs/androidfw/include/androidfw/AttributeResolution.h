@@ -59,6 +59,26 @@ base::expected<std::monostate, IOError> ApplyStyle(Theme* theme, ResXMLParser* x
                                                    const uint32_t* attrs, size_t attrs_length,
                                                    uint32_t* out_values, uint32_t* out_indices);
 
+// The attributes requested by one view of a batched ApplyStyles() call.
+struct StyleRequest {
+  ResXMLParser* xml_parser;
+  uint32_t def_style_attr;
+  uint32_t def_style_resid;
+  const uint32_t* attrs;
+  size_t attrs_length;
+};
+
+// Performs ApplyStyle() for each of the `requests` in order, sharing the default style bags and
+// the resolved theme attributes between them.
+// The values of all requests are written back to back to `out_values`, which must hold
+// STYLE_NUM_ENTRIES elements per requested attribute. The indices of each request take up
+// `attrs_length + 1` elements of `out_indices`, following those of the previous request.
+// `out_values` must NOT be nullptr.
+// `out_indices` is NOT optional and must NOT be nullptr.
+base::expected<std::monostate, IOError> ApplyStyles(Theme* theme, const StyleRequest* requests,
+                                                    size_t requests_length, uint32_t* out_values,
+                                                    uint32_t* out_indices);
+
 // `out_values` must NOT be nullptr.
 // `out_indices` may be nullptr.
 base::expected<std::monostate, IOError> RetrieveAttributes(AssetManager2* assetmanager,
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_CONCURRENT_RESID_MAP_H_
+#define ANDROIDFW_CONCURRENT_RESID_MAP_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "android-base/macros.h"
+
+namespace android {
+
+// An insert-only, open-addressing map from resource ID to a value of type T.
+//
+// Lookups never take a lock: a slot is published by storing its key with release semantics after
+// its value has been written, and slots are never modified once published. Insertions are
+// serialized by a mutex. When the table grows, the entries are copied into a larger table which
+// is then published atomically; the old table is retired but kept alive until the map is
+// destroyed, so pointers returned by Find() and Insert() remain valid for the lifetime of the map.
+//
+// Resource ID 0 is reserved to mark empty slots and can't be stored.
+template <typename T>
+class ConcurrentResidMap {
+ public:
+  explicit ConcurrentResidMap(size_t initial_capacity = 64u) {
+    size_t capacity = kMinCapacity;
+    while (capacity < initial_capacity) {
+      capacity <<= 1u;
+    }
+    tables_.push_back(std::make_unique<Table>(capacity));
+    current_.store(tables_.back().get(), std::memory_order_release);
+  }
+
+  // Returns the value stored for `resid`, or nullptr if there is none. Never blocks.
+  const T* Find(uint32_t resid) const {
+    if (resid == 0u) {
+      return nullptr;
+    }
+    const Table* table = current_.load(std::memory_order_acquire);
+    for (size_t i = Hash(resid) & table->mask;; i = (i + 1u) & table->mask) {
+      const Slot& slot = table->slots[i];
+      const uint32_t key = slot.key.load(std::memory_order_acquire);
+      if (key == resid) {
+        return &slot.value;
+      }
+      if (key == 0u) {
+        return nullptr;
+      }
+    }
+  }
+
+  // Stores `value` for `resid` unless a value is already present. Returns the value that is
+  // stored in the map after the call, which is the previously stored value if one existed.
+  const T* Insert(uint32_t resid, T value) {
+    if (resid == 0u) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(write_lock_);
+    Table* table = current_.load(std::memory_order_relaxed);
+    if (Slot* slot = FindSlot(table, resid); slot->key.load(std::memory_order_relaxed) != 0u) {
+      return &slot->value;
+    }
+
+    // Keep the load factor at or below 3/4 so probe sequences stay short.
+    if ((size_ + 1u) * 4u > (table->mask + 1u) * 3u) {
+      table = Grow(table);
+    }
+
+    Slot* slot = FindSlot(table, resid);
+    slot->value = std::move(value);
+    slot->key.store(resid, std::memory_order_release);
+    size_++;
+    return &slot->value;
+  }
+
+  // Calls `func(resid, value)` for every entry of the map. Blocks insertions while running.
+  template <typename Func>
+  void ForEach(Func func) const {
+    std::lock_guard<std::mutex> lock(write_lock_);
+    const Table* table = current_.load(std::memory_order_relaxed);
+    for (size_t i = 0u; i <= table->mask; i++) {
+      const Slot& slot = table->slots[i];
+      if (const uint32_t key = slot.key.load(std::memory_order_relaxed); key != 0u) {
+        func(key, slot.value);
+      }
+    }
+  }
+
+  // Returns the number of entries stored in the map.
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(write_lock_);
+    return size_;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentResidMap);
+
+  static constexpr size_t kMinCapacity = 16u;
+
+  struct Slot {
+    std::atomic<uint32_t> key{0u};
+    T value{};
+  };
+
+  struct Table {
+    explicit Table(size_t capacity) : mask(capacity - 1u), slots(new Slot[capacity]) {
+    }
+
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  static inline size_t Hash(uint32_t resid) {
+    // Resource IDs are dense in their low bits and share their high bits, so mix them before
+    // masking to avoid clustering entries of different types together.
+    uint32_t h = resid * 0x9e3779b1u;
+    return static_cast<size_t>(h ^ (h >> 16u));
+  }
+
+  // Returns the slot holding `resid`, or the empty slot where it would be inserted.
+  static Slot* FindSlot(Table* table, uint32_t resid) {
+    for (size_t i = Hash(resid) & table->mask;; i = (i + 1u) & table->mask) {
+      Slot& slot = table->slots[i];
+      const uint32_t key = slot.key.load(std::memory_order_relaxed);
+      if (key == resid || key == 0u) {
+        return &slot;
+      }
+    }
+  }
+
+  Table* Grow(Table* old_table) {
+    auto new_table = std::make_unique<Table>((old_table->mask + 1u) << 1u);
+    for (size_t i = 0u; i <= old_table->mask; i++) {
+      const Slot& old_slot = old_table->slots[i];
+      const uint32_t key = old_slot.key.load(std::memory_order_relaxed);
+      if (key != 0u) {
+        Slot* slot = FindSlot(new_table.get(), key);
+        slot->value = old_slot.value;
+        slot->key.store(key, std::memory_order_relaxed);
+      }
+    }
+
+    // Readers that still hold the old table can keep using it; it is only freed with the map.
+    Table* result = new_table.get();
+    tables_.push_back(std::move(new_table));
+    current_.store(result, std::memory_order_release);
+    return result;
+  }
+
+  mutable std::mutex write_lock_;
+  std::atomic<Table*> current_{nullptr};
+
+  // Every table ever published. Guarded by write_lock_.
+  std::vector<std::unique_ptr<Table>> tables_;
+  size_t size_ = 0u;
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_CONCURRENT_RESID_MAP_H_
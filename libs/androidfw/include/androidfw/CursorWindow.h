@@ -77,6 +77,33 @@ public:
         friend class CursorWindow;
     } __attribute((packed));
 
+    /* Describes the value of one field of a row passed to putRow(). */
+    struct Field {
+        int32_t type;
+        union {
+            double d;
+            int64_t l;
+            struct {
+                const void* data;
+                size_t size;
+            } buffer;
+        } value;
+    };
+
+    /* Statistics of the process-wide pool of inflated regions. */
+    struct PoolStats {
+        /* Inflations that reused a pooled region. */
+        uint64_t hits = 0;
+        /* Inflations that had to create and map a new region. */
+        uint64_t misses = 0;
+        /* Regions returned to the pool when their window was destroyed. */
+        uint64_t recycled = 0;
+        /* Regions unmapped on destruction because they were shared or the pool was full. */
+        uint64_t discarded = 0;
+        uint32_t pooledRegions = 0;
+        uint64_t pooledBytes = 0;
+    };
+
     ~CursorWindow();
 
     static status_t create(const String8& name, size_t size, CursorWindow** outCursorWindow);
@@ -84,6 +111,8 @@ public:
 
     status_t writeToParcel(Parcel* parcel);
 
+    static PoolStats getPoolStats();
+
     inline String8 name() { return mName; }
     inline size_t size() { return mSize; }
     inline size_t freeSpace() { return mSlotsOffset - mAllocOffset; }
@@ -106,6 +135,24 @@ public:
     status_t putDouble(uint32_t row, uint32_t column, double value);
     status_t putNull(uint32_t row, uint32_t column);
 
+    /**
+     * Allocates a new row and stores all of its fields at once. `numFields`
+     * must match the number of columns. The space needed by the strings and
+     * blobs of the row is reserved up front, so the window is inflated at
+     * most once and the row is either fully stored or not added at all.
+     */
+    status_t putRow(const Field* fields, uint32_t numFields);
+
+    /**
+     * Copies the integer values of `column` for `numRows` rows starting at
+     * `startRow` to `outValues`, reading the field slots sequentially. Null
+     * fields read as 0. Returns INVALID_OPERATION without writing anything
+     * if one of the fields holds another type, so that callers can fall
+     * back to per-field conversion.
+     */
+    status_t getColumnLongs(uint32_t column, uint32_t startRow, uint32_t numRows,
+            int64_t* outValues);
+
     /**
      * Gets the field slot at the specified row and column.
      * Returns null if the requested row or column is not in the window.
@@ -171,6 +218,11 @@ private:
     uint32_t mNumRows = 0;
     uint32_t mNumColumns = 0;
     bool mReadOnly = false;
+    /**
+     * Set once the region has been sent to another process, which may keep
+     * it mapped; such regions are never returned to the pool.
+     */
+    bool mShared = false;
 
     void updateSlotsData();
 
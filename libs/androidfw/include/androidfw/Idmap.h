@@ -21,6 +21,7 @@
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "androidfw/StringPiece.h"
@@ -37,6 +38,57 @@ struct Idmap_target_entry;
 struct Idmap_target_entry_inline;
 struct Idmap_overlay_entry;
 
+// Finds idmap entries by resource id. The entries of a type whose entry ids are dense enough are
+// indexed directly, so that finding them takes a single probe; the entries of other types are
+// binary searched within the type.
+//
+// The ids are read in place from the entries, so that the only memory of the index that is not
+// shared with the mapping of the idmap is the small table of slots.
+class IdmapEntryIndex {
+ public:
+  IdmapEntryIndex() = default;
+
+  // Indexes the `count` ids read from `first_id` onward, `stride` bytes apart, in device byte order
+  // and with `mask` applied. The ids must be sorted in ascending order and outlive the index. Ids
+  // of more than one package are binary searched.
+  IdmapEntryIndex(const uint32_t* first_id, size_t stride, uint32_t count,
+                  uint32_t mask = 0xFFFFFFFFU);
+
+  // Returns the position of `id` in the ids the index was built from, or -1 if it isn't there.
+  int32_t Find(uint32_t id) const;
+
+ private:
+  static constexpr uint32_t kNotIndexed = 0xffffffffU;
+
+  struct Type {
+    // The range of the ids holding the ids of this type.
+    uint32_t first = 0;
+    uint32_t count = 0;
+
+    // The entry ids covered by `slots_`, starting at `slots_begin`. Each slot holds the position
+    // of the entry within the type plus one, or zero if there is no entry for that id.
+    uint32_t min_entry = 0;
+    uint32_t entry_span = 0;
+    uint32_t slots_begin = kNotIndexed;
+  };
+
+  inline uint32_t IdAt(uint32_t i) const {
+    return mask_ & dtohl(*reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const uint8_t*>(first_id_) + i * stride_));
+  }
+
+  // Returns the position of the first id in [first, last) that is not less than `id`.
+  uint32_t LowerBound(uint32_t first, uint32_t last, uint32_t id) const;
+
+  const uint32_t* first_id_ = nullptr;
+  size_t stride_ = 0;
+  uint32_t count_ = 0;
+  uint32_t mask_ = 0xFFFFFFFFU;
+  bool by_type_ = false;
+  std::vector<Type> types_;
+  std::vector<uint16_t> slots_;
+};
+
 // A string pool for overlay apk assets. The string pool holds the strings of the overlay resources
 // table and additionally allows for loading strings from the idmap string pool. The idmap string
 // pool strings are offset after the end of the overlay resource table string pool entries so
@@ -65,6 +117,7 @@ class OverlayDynamicRefTable : public DynamicRefTable {
  private:
   explicit OverlayDynamicRefTable(const Idmap_data_header* data_header,
                                   const Idmap_overlay_entry* entries,
+                                  const IdmapEntryIndex* entry_index,
                                   uint8_t target_assigned_package_id);
 
   // Rewrites a compile-time overlay resource id to the runtime resource id of corresponding target
@@ -73,6 +126,7 @@ class OverlayDynamicRefTable : public DynamicRefTable {
 
   const Idmap_data_header* data_header_;
   const Idmap_overlay_entry* entries_;
+  const IdmapEntryIndex* entry_index_;
   const int8_t target_assigned_package_id_;
 
   friend LoadedIdmap;
@@ -129,12 +183,16 @@ class IdmapResMap {
   explicit IdmapResMap(const Idmap_data_header* data_header,
                        const Idmap_target_entry* entries,
                        const Idmap_target_entry_inline* inline_entries,
+                       const IdmapEntryIndex* entry_index,
+                       const IdmapEntryIndex* inline_entry_index,
                        uint8_t target_assigned_package_id,
                        const OverlayDynamicRefTable* overlay_ref_table);
 
   const Idmap_data_header* data_header_;
   const Idmap_target_entry* entries_;
   const Idmap_target_entry_inline* inline_entries_;
+  const IdmapEntryIndex* entry_index_;
+  const IdmapEntryIndex* inline_entry_index_;
   const uint8_t target_assigned_package_id_;
   const OverlayDynamicRefTable* overlay_ref_table_;
 
@@ -170,13 +228,14 @@ class LoadedIdmap {
   // Returns a mapping from target resource ids to overlay values.
   const IdmapResMap GetTargetResourcesMap(uint8_t target_assigned_package_id,
                                           const OverlayDynamicRefTable* overlay_ref_table) const {
-    return IdmapResMap(data_header_, target_entries_, target_inline_entries_,
-                       target_assigned_package_id, overlay_ref_table);
+    return IdmapResMap(data_header_, target_entries_, target_inline_entries_, &target_index_,
+                       &target_inline_index_, target_assigned_package_id, overlay_ref_table);
   }
 
   // Returns a dynamic reference table for a loaded overlay package.
   const OverlayDynamicRefTable GetOverlayDynamicRefTable(uint8_t target_assigned_package_id) const {
-    return OverlayDynamicRefTable(data_header_, overlay_entries_, target_assigned_package_id);
+    return OverlayDynamicRefTable(data_header_, overlay_entries_, &overlay_index_,
+                                  target_assigned_package_id);
   }
 
   // Returns whether the idmap file on disk has not been modified since the construction of this
@@ -194,6 +253,12 @@ class LoadedIdmap {
   const Idmap_overlay_entry* overlay_entries_;
   const std::unique_ptr<ResStringPool> string_pool_;
 
+  // Indices of the entries above, by target resource id for the target entries and by overlay
+  // resource id for the overlay entries.
+  IdmapEntryIndex target_index_;
+  IdmapEntryIndex target_inline_index_;
+  IdmapEntryIndex overlay_index_;
+
   std::string idmap_path_;
   std::string_view overlay_apk_path_;
   std::string_view target_apk_path_;
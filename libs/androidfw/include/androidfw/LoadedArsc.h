@@ -19,6 +19,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 #include <unordered_map>
@@ -54,6 +55,9 @@ struct TypeSpec {
     // Type configurations are accessed frequently when setting up an AssetManager and querying
     // resources. Access this cached configuration to minimize page faults.
     ResTable_config config;
+
+    // The packed form of `config`, used to quickly reject configurations that can't match.
+    ResTable_config::PackedAxes packed_config;
   };
 
   // Pointer to the mmapped data where flags are kept. Flags denote whether the resource entry is
@@ -96,6 +100,11 @@ enum : package_property_t {
   // The apk assets is owned by the application running in this process and incremental crash
   // protections for this APK must be disabled.
   PROPERTY_DISABLE_INCREMENTAL_HARDENING = 1U << 4U,
+
+  // The RES_TABLE_TYPE_TYPE chunks of each type are validated and indexed the first time the type
+  // is accessed instead of when the package is loaded. Malformed type chunks are then skipped
+  // instead of failing the load of the whole table.
+  PROPERTY_LAZY_TYPES = 1U << 5U,
 };
 
 struct OverlayableInfo {
@@ -242,12 +251,18 @@ class LoadedPackage {
     if (type_spec == type_specs_.end()) {
       return nullptr;
     }
+    if (UNLIKELY(!deferred_types_.empty())) {
+      LoadDeferredTypes(type_spec->first);
+    }
     return &type_spec->second;
   }
 
   template <typename Func>
   void ForEachTypeSpec(Func f) const {
     for (const auto& type_spec : type_specs_) {
+      if (UNLIKELY(!deferred_types_.empty())) {
+        LoadDeferredTypes(type_spec.first);
+      }
       f(type_spec.second, type_spec.first);
     }
   }
@@ -264,6 +279,15 @@ class LoadedPackage {
     return nullptr;
   }
 
+  // Calls `f` with the overlayable properties and the resource ids of each overlayable policy of
+  // the package, in the order GetOverlayableInfo() searches them.
+  template <typename Func>
+  void ForEachOverlayable(Func f) const {
+    for (const auto& overlayable_info_ids : overlayable_infos_) {
+      f(overlayable_info_ids.first, overlayable_info_ids.second);
+    }
+  }
+
   // Retrieves whether or not the package defines overlayable resources.
   // TODO(123905379): Remove this when the enforcement of overlayable is turned on for all APK and
   // not just those that defined overlayable resources.
@@ -284,6 +308,16 @@ class LoadedPackage {
 
   LoadedPackage() = default;
 
+  // The type chunks of a type spec that have not been validated and indexed yet.
+  struct DeferredTypes {
+    std::once_flag loaded;
+    std::vector<incfs::map_ptr<ResTable_type>> types;
+  };
+
+  // Validates the deferred type chunks of the type with ID `type_id` and adds them to its TypeSpec.
+  // Does nothing if the type was not deferred or has already been loaded.
+  void LoadDeferredTypes(uint8_t type_id) const;
+
   ResStringPool type_string_pool_;
   ResStringPool key_string_pool_;
   std::string package_name_;
@@ -292,7 +326,10 @@ class LoadedPackage {
   int type_id_offset_ = 0;
   package_property_t property_flags_ = 0U;
 
-  std::unordered_map<uint8_t, TypeSpec> type_specs_;
+  // The type entries of a TypeSpec are filled in by LoadDeferredTypes when the package was loaded
+  // with PROPERTY_LAZY_TYPES, hence mutable. The map itself is never modified after loading.
+  mutable std::unordered_map<uint8_t, TypeSpec> type_specs_;
+  std::unordered_map<uint8_t, std::unique_ptr<DeferredTypes>> deferred_types_;
   ByteBucketArray<uint32_t> resource_ids_;
   std::vector<DynamicPackageEntry> dynamic_package_map_;
   std::vector<const std::pair<OverlayableInfo, std::unordered_set<uint32_t>>> overlayable_infos_;
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROIDFW_RESOLVED_SNAPSHOT_H_
+#define ANDROIDFW_RESOLVED_SNAPSHOT_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "androidfw/ResourceTypes.h"
+#include "utils/FileMap.h"
+
+namespace android {
+
+class ApkAssets;
+
+// The snapshot file starts with this header, followed by the key (padded to a multiple of four
+// bytes), the values sorted by resource ID, the bags sorted by resource ID, and the entries of all
+// bags. Snapshots are only ever read back on the device that wrote them, so every field is stored
+// in host byte order.
+struct ResolvedSnapshot_header {
+  // Always 'RSNP'.
+  uint32_t magic;
+
+  // Incremented whenever the layout of the file changes.
+  uint32_t version;
+
+  // The length of the key, without padding.
+  uint32_t key_size;
+
+  uint32_t value_count;
+  uint32_t bag_count;
+  uint32_t bag_entry_count;
+
+  // The configuration the values and bags were resolved for.
+  ResTable_config configuration;
+};
+
+// A resolved resource value, as cached by AssetManager2::ResolveReference().
+struct ResolvedSnapshot_value {
+  // The resource ID of the reference that was resolved.
+  uint32_t resid;
+
+  // The resource ID the final value was read from.
+  uint32_t value_resid;
+
+  int32_t cookie;
+  uint32_t flags;
+  uint32_t data;
+  uint8_t type;
+  uint8_t padding[3];
+  ResTable_config config;
+};
+
+// A resolved bag, with its parents' entries merged in.
+struct ResolvedSnapshot_bag {
+  uint32_t resid;
+  uint32_t type_spec_flags;
+
+  // The index of the first entry of the bag in the entries of the snapshot.
+  uint32_t entries_start;
+  uint32_t entry_count;
+};
+
+struct ResolvedSnapshot_bag_entry {
+  uint32_t key;
+  uint32_t style;
+  int32_t cookie;
+  Res_value value;
+};
+
+// A memory mapped snapshot of the values and bags resolved by an AssetManager2 for one set of
+// ApkAssets and one configuration. Serving resolutions from a snapshot written by a previous run
+// of the process avoids walking the resource tables on cold start.
+class ResolvedSnapshot {
+ public:
+  static constexpr uint32_t kMagic = 0x504e5352u;  // 'RSNP'
+  static constexpr uint32_t kVersion = 1u;
+
+  // Returns the key identifying the contents of `apk_assets`, made of the path and modification
+  // time of every APK and idmap. Returns nullopt if any of the ApkAssets is not backed by a file.
+  static std::optional<std::string> MakeKey(const std::vector<const ApkAssets*>& apk_assets);
+
+  // Maps the snapshot at `path`. Returns nullptr if the file can't be read, is malformed, or was
+  // written for a different key.
+  static std::unique_ptr<const ResolvedSnapshot> Load(const std::string& path,
+                                                      const std::string& key);
+
+  // Writes a snapshot holding `values` and the bags in `bags` to `path`. `bag_entries` holds the
+  // entries of every bag as referenced by ResolvedSnapshot_bag::entries_start. The values and bags
+  // may be in any order. Returns false if the file could not be written.
+  static bool Write(const std::string& path, const std::string& key,
+                    const ResTable_config& configuration,
+                    std::vector<ResolvedSnapshot_value> values,
+                    std::vector<ResolvedSnapshot_bag> bags,
+                    const std::vector<ResolvedSnapshot_bag_entry>& bag_entries);
+
+  const std::string& GetKey() const {
+    return key_;
+  }
+
+  const ResTable_config& GetConfiguration() const {
+    return header_->configuration;
+  }
+
+  // Returns the resolved value of the reference to `resid`, or nullptr if it isn't in the snapshot.
+  const ResolvedSnapshot_value* FindValue(uint32_t resid) const;
+
+  // Returns the bag `resid`, or nullptr if it isn't in the snapshot.
+  const ResolvedSnapshot_bag* FindBag(uint32_t resid) const;
+
+  // Returns the first entry of `bag`.
+  const ResolvedSnapshot_bag_entry* GetBagEntries(const ResolvedSnapshot_bag* bag) const {
+    return bag_entries_ + bag->entries_start;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ResolvedSnapshot);
+
+  ResolvedSnapshot() = default;
+
+  std::unique_ptr<FileMap> file_map_;
+  std::string key_;
+  const ResolvedSnapshot_header* header_ = nullptr;
+  const ResolvedSnapshot_value* values_ = nullptr;
+  const ResolvedSnapshot_bag* bags_ = nullptr;
+  const ResolvedSnapshot_bag_entry* bag_entries_ = nullptr;
+};
+
+}  // namespace android
+
+#endif  // ANDROIDFW_RESOLVED_SNAPSHOT_H_
@@ -548,7 +548,31 @@ public:
     bool isSorted() const;
     bool isUTF8() const;
 
+    // Statistics of the cache holding the UTF-16 copies of strings decoded from a UTF-8 pool by
+    // stringAt(). Callers that can consume UTF-8 should use string8At() to avoid growing it.
+    struct DecodeCacheStats {
+        // Number of stringAt() calls served from the cache.
+        size_t hits = 0;
+
+        // Number of stringAt() calls that decoded and cached a string.
+        size_t misses = 0;
+
+        // Number of strings held by the cache.
+        size_t strings = 0;
+
+        // Heap bytes held by the cache, including its index.
+        size_t bytes = 0;
+    };
+
+    DecodeCacheStats getDecodeCacheStats() const;
+
 private:
+    // A block of memory holding decoded strings. Strings are never evicted because stringAt()
+    // hands out pointers into the cache that must stay valid for the lifetime of the pool.
+    struct DecodeBlock;
+
+    char16_t* allocDecodeString(size_t u16len) const;
+
     status_t                                      mError;
     void*                                         mOwnedData;
     incfs::verified_map_ptr<ResStringPool_header> mHeader;
@@ -558,6 +582,8 @@ private:
     incfs::map_ptr<uint32_t>                      mEntryStyles;
     incfs::map_ptr<void>                          mStrings;
     char16_t mutable**                            mCache;
+    DecodeBlock mutable*                          mCacheBlocks;
+    DecodeCacheStats mutable                      mCacheStats;
     uint32_t                                      mStringPoolSize;    // number of uint16_t
     incfs::map_ptr<uint32_t>                      mStyles;
     uint32_t                                      mStylePoolSize;    // number of uint32_t
@@ -861,6 +887,8 @@ private:
     ResStringPool               mStrings;
     const uint32_t*             mResIds;
     size_t                      mNumResIds;
+    // mResIds rewritten through mDynamicRefTable, or null if the tree has no DynamicRefTable.
+    std::unique_ptr<uint32_t[]> mResolvedResIds;
     const ResXMLTree_node*      mRootNode;
     const void*                 mRootExt;
     event_code_t                mRootCode;
@@ -1288,6 +1316,26 @@ struct ResTable_config
     // settings is the requested settings
     bool match(const ResTable_config& settings) const;
 
+    // The configuration axes that only match a request when they are unset or equal to the
+    // requested value, packed into machine words. Comparing the packed words of a candidate with
+    // those of the request rejects most non-matching candidates without the branches of match().
+    struct PackedAxes {
+        // The packed values of the axes.
+        uint64_t value[2];
+
+        // Selects the bits of the axes that are set.
+        uint64_t mask[2];
+
+        // Returns false if `settings` can't be matched by the configuration these axes were packed
+        // from. Returning true does not imply a match; match() must still be called.
+        inline bool mayMatch(const PackedAxes& settings) const {
+            return (((value[0] ^ settings.value[0]) & mask[0]) |
+                    ((value[1] ^ settings.value[1]) & mask[1])) == 0;
+        }
+    };
+
+    PackedAxes packAxes() const;
+
     // Get the string representation of the locale component of this
     // Config. The maximum size of this representation will be
     // |RESTABLE_MAX_LOCALE_LEN| (including a terminating '\0').
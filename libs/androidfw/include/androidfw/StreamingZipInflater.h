@@ -20,6 +20,9 @@
 #include <unistd.h>
 #include <inttypes.h>
 
+#include <memory>
+#include <vector>
+
 #include <util/map_ptr.h>
 #include <zlib.h>
 
@@ -32,6 +35,12 @@ public:
     static const size_t INPUT_CHUNK_SIZE = 64 * 1024;
     static const size_t OUTPUT_CHUNK_SIZE = 64 * 1024;
 
+    // Blobs at least this large record seek points while they are inflated, so that
+    // seeking backwards resumes from the nearest one instead of the start of the blob.
+    static const size_t MIN_INDEXED_SIZE = 2 * 1024 * 1024;
+    static const size_t MAX_SEEK_POINTS = 16;
+    static const size_t MIN_SEEK_POINT_SPAN = 1024 * 1024;
+
     // Flavor that pages in the compressed data from a fd
     StreamingZipInflater(int fd, off64_t compDataStart, size_t uncompSize, size_t compSize);
 
@@ -44,14 +53,30 @@ public:
     // be NULL, in which case the data is consumed and discarded.
     ssize_t read(void* outBuf, size_t count);
 
-    // seeking backwards requires uncompressing fom the beginning, so is very
-    // expensive.  seeking forwards only requires uncompressing from the current
-    // position to the destination.
+    // seeking backwards requires uncompressing from the nearest seek point recorded
+    // so far, or from the beginning if there is none, so can be expensive.  seeking
+    // forwards only requires uncompressing from the current position, or from the last
+    // seek point before the destination, to the destination.
     off64_t seekAbsolute(off64_t absoluteInputPosition);
 
+    size_t getSeekPointCount() const { return mSeekPoints.size(); }
+
 private:
+    // A deflate block boundary from which inflation can resume without the data before it.
+    struct SeekPoint {
+        off64_t outOffset;          // uncompressed offset of the boundary
+        size_t inOffset;            // offset of the first compressed byte not fully consumed
+        int bits;                   // number of bits of the previous byte still to be consumed
+        uint8_t lastByte;           // the previous byte, when bits > 0
+        size_t windowSize;
+        std::unique_ptr<uint8_t[]> window;  // the uncompressed data preceding the boundary
+    };
+
     void initInflateState();
     int readNextChunk();
+    bool isSeekPointDue() const;
+    void maybeAddSeekPoint();
+    bool resumeFrom(const SeekPoint& point);
 
     // where to find the uncompressed data
     int mFd;
@@ -79,6 +104,11 @@ private:
     // input state bookkeeping
     size_t mInNextChunkOffset;  // offset from start of blob at which the next input chunk lies
     // the z_stream contains state about input block consumption
+
+    // seek point bookkeeping
+    off64_t mStreamOutStart;    // uncompressed offset at which the current z_stream started
+    size_t mSeekPointSpan;      // minimum distance between seek points, 0 if not indexed
+    std::vector<SeekPoint> mSeekPoints;
 };
 
 }
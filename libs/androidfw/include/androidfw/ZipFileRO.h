@@ -174,6 +174,12 @@ public:
      */
     bool uncompressEntry(ZipEntryRO entry, int fd) const;
 
+    /*
+     * Return the file descriptor the archive is read from, or -1 if it has
+     * none. The descriptor remains owned by the archive.
+     */
+    int getFileDescriptor() const;
+
     ~ZipFileRO();
 
 private:
@@ -26,9 +26,12 @@
 
 using ::android::base::unique_fd;
 using ::com::android::basic::R;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Ge;
+using ::testing::IsNull;
 using ::testing::NotNull;
+using ::testing::Pair;
 using ::testing::SizeIs;
 using ::testing::StrEq;
 
@@ -45,6 +48,30 @@ TEST(ApkAssetsTest, LoadApk) {
   ASSERT_THAT(loaded_apk->GetAssetsProvider()->Open("res/layout/main.xml"), NotNull());
 }
 
+TEST(ApkAssetsTest, LoadAsync) {
+  std::vector<ApkAssets::LoadRequest> requests;
+  requests.push_back({GetTestDataPath() + "/basic/basic.apk"});
+  requests.push_back({GetTestDataPath() + "/does/not/exist.apk"});
+  requests.push_back({GetTestDataPath() + "/styles/styles.apk"});
+  requests.push_back({GetTestDataPath() + "/basic/basic.apk"});
+
+  auto futures = ApkAssets::LoadAsync(std::move(requests), 2U /* max_threads */);
+  ASSERT_THAT(futures, SizeIs(4U));
+
+  std::vector<std::unique_ptr<ApkAssets>> loaded_apks;
+  for (auto& future : futures) {
+    loaded_apks.push_back(future.get());
+  }
+
+  ASSERT_THAT(loaded_apks[0], NotNull());
+  EXPECT_THAT(loaded_apks[1], IsNull());
+  ASSERT_THAT(loaded_apks[2], NotNull());
+  ASSERT_THAT(loaded_apks[3], NotNull());
+  EXPECT_NE(loaded_apks[0].get(), loaded_apks[3].get());
+  ASSERT_THAT(loaded_apks[0]->GetLoadedArsc()->GetPackageById(0x7fu), NotNull());
+  ASSERT_THAT(loaded_apks[2]->GetAssetsProvider()->Open("res/layout/layout.xml"), NotNull());
+}
+
 TEST(ApkAssetsTest, LoadApkFromFd) {
   const std::string path = GetTestDataPath() + "/basic/basic.apk";
   unique_fd fd(::open(path.c_str(), O_RDONLY | O_BINARY));
@@ -90,6 +117,34 @@ TEST(ApkAssetsTest, CreateAndDestroyAssetKeepsApkAssetsOpen) {
                                                       Asset::ACCESS_BUFFER), NotNull()); }
 }
 
+TEST(ApkAssetsTest, ForEachFileListsDirectoriesOnce) {
+  std::unique_ptr<const ApkAssets> loaded_apk =
+      ApkAssets::Load(GetTestDataPath() + "/basic/basic.apk");
+  ASSERT_THAT(loaded_apk, NotNull());
+
+  std::vector<std::pair<std::string, FileType>> files;
+  auto func = [&](const StringPiece& name, FileType type) {
+    files.emplace_back(name.to_string(), type);
+  };
+
+  // Entries of "res/layout/" sort after those of "res/layout-v17/", but directories are
+  // presented by name.
+  ASSERT_TRUE(loaded_apk->GetAssetsProvider()->ForEachFile("res", func));
+  EXPECT_THAT(files, ElementsAre(Pair("layout", kFileTypeDirectory),
+                                 Pair("layout-fr-sw600dp-v13", kFileTypeDirectory),
+                                 Pair("layout-v1", kFileTypeDirectory),
+                                 Pair("layout-v17", kFileTypeDirectory)));
+
+  files.clear();
+  ASSERT_TRUE(loaded_apk->GetAssetsProvider()->ForEachFile("res/layout/", func));
+  EXPECT_THAT(files, ElementsAre(Pair("layout.xml", kFileTypeRegular),
+                                 Pair("main.xml", kFileTypeRegular)));
+
+  files.clear();
+  ASSERT_TRUE(loaded_apk->GetAssetsProvider()->ForEachFile("res/lay", func));
+  EXPECT_THAT(files, SizeIs(0u));
+}
+
 TEST(ApkAssetsTest, OpenUncompressedAssetFd) {
   std::unique_ptr<const ApkAssets> loaded_apk =
       ApkAssets::Load(GetTestDataPath() + "/basic/basic.apk");
@@ -112,4 +167,21 @@ TEST(ApkAssetsTest, OpenUncompressedAssetFd) {
   EXPECT_THAT(buffer, StrEq("This should be uncompressed.\n\n"));
 }
 
+TEST(ApkAssetsTest, AdviseAccessOnMappedAssets) {
+  std::unique_ptr<const ApkAssets> loaded_apk =
+      ApkAssets::Load(GetTestDataPath() + "/basic/basic.apk");
+  ASSERT_THAT(loaded_apk, NotNull());
+
+  auto asset = loaded_apk->GetAssetsProvider()->Open("assets/uncompressed.txt",
+                                                     Asset::ACCESS_RANDOM);
+  ASSERT_THAT(asset, NotNull());
+  EXPECT_TRUE(asset->adviseAccess(Asset::ACCESS_STREAMING));
+  EXPECT_TRUE(asset->adviseAccess(Asset::ACCESS_BUFFER));
+  EXPECT_TRUE(asset->adviseAccess(Asset::ACCESS_RANDOM));
+
+  // Assets read into RAM have nothing to advise.
+  std::unique_ptr<Asset> file_asset(new _FileAsset());
+  EXPECT_FALSE(file_asset->adviseAccess(Asset::ACCESS_BUFFER));
+}
+
 }  // namespace android
@@ -256,4 +256,32 @@ static void BM_AssetManagerSetConfigurationFrameworkOld(benchmark::State& state)
 }
 BENCHMARK(BM_AssetManagerSetConfigurationFrameworkOld);
 
+static void BM_AssetManagerResolveReference(benchmark::State& state, bool cold) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(GetTestDataPath() + "/basic/basic.apk");
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  auto assets = std::make_unique<AssetManager2>();
+  assets->SetApkAssets({apk.get()});
+  while (state.KeepRunning()) {
+    if (cold) {
+      // Start from an AssetManager that has not cached any resolved value yet.
+      state.PauseTiming();
+      assets = std::make_unique<AssetManager2>();
+      assets->SetApkAssets({apk.get()});
+      state.ResumeTiming();
+    }
+
+    AssetManager2::SelectedValue value{};
+    value.type = Res_value::TYPE_REFERENCE;
+    value.data = basic::R::integer::deep_ref;
+    assets->ResolveReference(value, true /* cache_value */);
+    benchmark::DoNotOptimize(value);
+  }
+}
+BENCHMARK_CAPTURE(BM_AssetManagerResolveReference, cold, true);
+BENCHMARK_CAPTURE(BM_AssetManagerResolveReference, warm, false);
+
 }  // namespace android
@@ -17,9 +17,12 @@
 #include "androidfw/AssetManager2.h"
 #include "androidfw/AssetManager.h"
 
+#include <thread>
+
 #include "TestHelpers.h"
 #include "android-base/file.h"
 #include "android-base/logging.h"
+#include "androidfw/ResolvedSnapshot.h"
 #include "androidfw/ResourceUtils.h"
 #include "data/appaslib/R.h"
 #include "data/basic/R.h"
@@ -154,6 +157,42 @@ TEST_F(AssetManager2Test, FindsResourceFromMultipleApkAssets) {
   EXPECT_EQ(Res_value::TYPE_STRING, value->type);
 }
 
+TEST_F(AssetManager2Test, ResolvedIndexFollowsConfigurationChanges) {
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.language[0] = 'd';
+  desired_config.language[1] = 'e';
+
+  AssetManager2 assetmanager;
+  assetmanager.SetResolvedIndexEnabled(true);
+  assetmanager.SetConfiguration(desired_config);
+  assetmanager.SetApkAssets({basic_assets_.get(), basic_de_fr_assets_.get()});
+
+  // The second lookup is served by the resolved index.
+  for (int i = 0; i < 2; i++) {
+    auto value = assetmanager.GetResource(basic::R::string::test1);
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(1, value->cookie);
+    EXPECT_EQ('d', value->config.language[0]);
+    EXPECT_EQ('e', value->config.language[1]);
+  }
+
+  desired_config.language[0] = 'f';
+  desired_config.language[1] = 'r';
+  assetmanager.SetConfiguration(desired_config);
+
+  auto value = assetmanager.GetResource(basic::R::string::test1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(1, value->cookie);
+  EXPECT_EQ('f', value->config.language[0]);
+  EXPECT_EQ('r', value->config.language[1]);
+
+  // A density override bypasses the index.
+  value = assetmanager.GetResource(basic::R::string::test1, false /* may_be_bag */, 320u);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ('f', value->config.language[0]);
+}
+
 TEST_F(AssetManager2Test, FindsResourceFromSharedLibrary) {
   AssetManager2 assetmanager;
 
@@ -410,6 +449,231 @@ TEST_F(AssetManager2Test, MergeStylesCircularDependency) {
   ASSERT_EQ(3u, (*bag)->entry_count);
 }
 
+TEST_F(AssetManager2Test, SharedCachesShareBagsBetweenAssetManagers) {
+  AssetManager2 assetmanager_one;
+  assetmanager_one.SetSharedCachesEnabled(true);
+  assetmanager_one.SetApkAssets({style_assets_.get()});
+
+  AssetManager2 assetmanager_two;
+  assetmanager_two.SetSharedCachesEnabled(true);
+  assetmanager_two.SetApkAssets({style_assets_.get()});
+
+  auto bag_one = assetmanager_one.GetBag(app::R::style::StyleTwo);
+  ASSERT_TRUE(bag_one.has_value());
+  ASSERT_EQ(6u, (*bag_one)->entry_count);
+
+  auto bag_two = assetmanager_two.GetBag(app::R::style::StyleTwo);
+  ASSERT_TRUE(bag_two.has_value());
+  EXPECT_EQ(*bag_one, *bag_two);
+
+  // The parent style was resolved and cached while resolving StyleTwo.
+  auto parent_one = assetmanager_one.GetBag(app::R::style::StyleOne);
+  auto parent_two = assetmanager_two.GetBag(app::R::style::StyleOne);
+  ASSERT_TRUE(parent_one.has_value());
+  ASSERT_TRUE(parent_two.has_value());
+  EXPECT_EQ(*parent_one, *parent_two);
+}
+
+TEST_F(AssetManager2Test, SharedCachesKeepBagResIdStacks) {
+  AssetManager2 assetmanager_one;
+  assetmanager_one.SetSharedCachesEnabled(true);
+  assetmanager_one.SetApkAssets({style_assets_.get()});
+
+  AssetManager2 assetmanager_two;
+  assetmanager_two.SetSharedCachesEnabled(true);
+  assetmanager_two.SetApkAssets({style_assets_.get()});
+
+  const std::vector<uint32_t> expected_stack = {app::R::style::StyleTwo, app::R::style::StyleOne};
+  ASSERT_TRUE(assetmanager_one.GetBag(app::R::style::StyleTwo).has_value());
+  EXPECT_EQ(expected_stack, assetmanager_one.GetBagResIdStack(app::R::style::StyleTwo));
+
+  // The bags were resolved by assetmanager_one, so assetmanager_two finds them in the shared
+  // cache, but still reports every style they were built from.
+  ASSERT_TRUE(assetmanager_two.GetBag(app::R::style::StyleTwo).has_value());
+  EXPECT_EQ(expected_stack, assetmanager_two.GetBagResIdStack(app::R::style::StyleTwo));
+  EXPECT_EQ(std::vector<uint32_t>{app::R::style::StyleOne},
+            assetmanager_two.GetBagResIdStack(app::R::style::StyleOne));
+}
+
+TEST_F(AssetManager2Test, SharedCachesConcurrentGetBag) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 100;
+  const std::vector<uint32_t> expected_stack = {app::R::style::StyleTwo, app::R::style::StyleOne};
+
+  std::vector<std::unique_ptr<AssetManager2>> assetmanagers;
+  for (int i = 0; i < kNumThreads; i++) {
+    auto& assetmanager = assetmanagers.emplace_back(std::make_unique<AssetManager2>());
+    assetmanager->SetSharedCachesEnabled(true);
+    assetmanager->SetApkAssets({style_assets_.get()});
+  }
+
+  std::vector<const ResolvedBag*> bags(kNumThreads, nullptr);
+  // Not std::vector<bool>, whose elements can't be written from separate threads.
+  std::vector<char> stacks_match(kNumThreads, false);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      bool match = true;
+      for (int j = 0; j < kNumIterations; j++) {
+        auto bag = assetmanagers[i]->GetBag(app::R::style::StyleTwo);
+        if (!bag.has_value() || (bags[i] != nullptr && bags[i] != *bag)) {
+          match = false;
+          break;
+        }
+        bags[i] = *bag;
+        match = match &&
+            assetmanagers[i]->GetBagResIdStack(app::R::style::StyleTwo) == expected_stack;
+      }
+      stacks_match[i] = match;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Every AssetManager sees the one bag that was published first.
+  for (int i = 0; i < kNumThreads; i++) {
+    EXPECT_TRUE(stacks_match[i]);
+    ASSERT_NE(nullptr, bags[i]);
+    EXPECT_EQ(bags[0], bags[i]);
+    EXPECT_EQ(6u, bags[i]->entry_count);
+  }
+}
+
+TEST_F(AssetManager2Test, SharedCachesAreKeyedByConfiguration) {
+  AssetManager2 assetmanager_one;
+  assetmanager_one.SetSharedCachesEnabled(true);
+  assetmanager_one.SetApkAssets({basic_assets_.get()});
+
+  AssetManager2 assetmanager_two;
+  assetmanager_two.SetSharedCachesEnabled(true);
+  assetmanager_two.SetApkAssets({basic_assets_.get()});
+
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.language[0] = 'd';
+  desired_config.language[1] = 'e';
+  assetmanager_two.SetConfiguration(desired_config);
+
+  auto bag_one = assetmanager_one.GetBag(basic::R::array::integerArray1);
+  auto bag_two = assetmanager_two.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(bag_one.has_value());
+  ASSERT_TRUE(bag_two.has_value());
+  EXPECT_NE(*bag_one, *bag_two);
+
+  // Matching the configuration again attaches to the same cache.
+  assetmanager_two.SetConfiguration(assetmanager_one.GetConfiguration());
+  bag_two = assetmanager_two.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(bag_two.has_value());
+  EXPECT_EQ(*bag_one, *bag_two);
+}
+
+TEST_F(AssetManager2Test, SharedCachesResolveReference) {
+  AssetManager2 assetmanager_one;
+  assetmanager_one.SetSharedCachesEnabled(true);
+  assetmanager_one.SetApkAssets({basic_assets_.get()});
+
+  AssetManager2 assetmanager_two;
+  assetmanager_two.SetSharedCachesEnabled(true);
+  assetmanager_two.SetApkAssets({basic_assets_.get()});
+
+  AssetManager2::SelectedValue value_one{};
+  value_one.data = basic::R::integer::ref1;
+  value_one.type = Res_value::TYPE_REFERENCE;
+  ASSERT_TRUE(assetmanager_one.ResolveReference(value_one, true /* cache_value */).has_value());
+  EXPECT_EQ(Res_value::TYPE_INT_DEC, value_one.type);
+  EXPECT_EQ(12000u, value_one.data);
+
+  AssetManager2::SelectedValue value_two{};
+  value_two.data = basic::R::integer::ref1;
+  value_two.type = Res_value::TYPE_REFERENCE;
+  ASSERT_TRUE(assetmanager_two.ResolveReference(value_two, true /* cache_value */).has_value());
+  EXPECT_EQ(Res_value::TYPE_INT_DEC, value_two.type);
+  EXPECT_EQ(12000u, value_two.data);
+  EXPECT_EQ(value_one.resid, value_two.resid);
+}
+
+TEST_F(AssetManager2Test, ResolvedSnapshotServesResolvedValuesAndBags) {
+  TemporaryFile snapshot_file;
+  {
+    AssetManager2 assetmanager;
+    assetmanager.SetApkAssets({basic_assets_.get()});
+
+    AssetManager2::SelectedValue value{};
+    value.data = basic::R::integer::ref1;
+    value.type = Res_value::TYPE_REFERENCE;
+    ASSERT_TRUE(assetmanager.ResolveReference(value, true /* cache_value */).has_value());
+    ASSERT_TRUE(assetmanager.GetBag(basic::R::array::integerArray1).has_value());
+    ASSERT_TRUE(assetmanager.WriteResolvedSnapshot(snapshot_file.path));
+  }
+
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({basic_assets_.get()});
+
+  // A snapshot written for other ApkAssets is rejected.
+  EXPECT_EQ(nullptr, ResolvedSnapshot::Load(snapshot_file.path, "other"));
+
+  const auto key = ResolvedSnapshot::MakeKey(assetmanager.GetApkAssets());
+  ASSERT_TRUE(key.has_value());
+  std::shared_ptr<const ResolvedSnapshot> snapshot =
+      ResolvedSnapshot::Load(snapshot_file.path, *key);
+  ASSERT_NE(nullptr, snapshot);
+  ASSERT_NE(nullptr, snapshot->FindValue(basic::R::integer::ref1));
+  ASSERT_NE(nullptr, snapshot->FindBag(basic::R::array::integerArray1));
+  EXPECT_EQ(nullptr, snapshot->FindBag(basic::R::integer::ref1));
+  assetmanager.SetResolvedSnapshot(snapshot);
+
+  AssetManager2::SelectedValue value{};
+  value.data = basic::R::integer::ref1;
+  value.type = Res_value::TYPE_REFERENCE;
+  ASSERT_TRUE(assetmanager.ResolveReference(value, true /* cache_value */).has_value());
+  EXPECT_EQ(Res_value::TYPE_INT_DEC, value.type);
+  EXPECT_EQ(12000u, value.data);
+  EXPECT_EQ(basic::R::integer::ref2, value.resid);
+
+  auto bag = assetmanager.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(bag.has_value());
+  ASSERT_EQ(3u, (*bag)->entry_count);
+  EXPECT_EQ(static_cast<uint8_t>(Res_value::TYPE_INT_DEC), (*bag)->entries[2].value.dataType);
+  EXPECT_EQ(3u, (*bag)->entries[2].value.data);
+  EXPECT_EQ(0, (*bag)->entries[2].cookie);
+
+  // The snapshot stops being used once the configuration differs from the one it was written for,
+  // and resolution falls back to the resource tables.
+  ResTable_config desired_config;
+  memset(&desired_config, 0, sizeof(desired_config));
+  desired_config.orientation = ResTable_config::ORIENTATION_LAND;
+  assetmanager.SetConfiguration(desired_config);
+
+  bag = assetmanager.GetBag(basic::R::array::integerArray1);
+  ASSERT_TRUE(bag.has_value());
+  EXPECT_EQ(3u, (*bag)->entry_count);
+}
+
+TEST_F(AssetManager2Test, ResolvedSnapshotBagsKeepResIdStacks) {
+  TemporaryFile snapshot_file;
+  {
+    AssetManager2 assetmanager;
+    assetmanager.SetApkAssets({style_assets_.get()});
+    ASSERT_TRUE(assetmanager.GetBag(app::R::style::StyleTwo).has_value());
+    ASSERT_TRUE(assetmanager.WriteResolvedSnapshot(snapshot_file.path));
+  }
+
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({style_assets_.get()});
+  const auto key = ResolvedSnapshot::MakeKey(assetmanager.GetApkAssets());
+  ASSERT_TRUE(key.has_value());
+  std::shared_ptr<const ResolvedSnapshot> snapshot =
+      ResolvedSnapshot::Load(snapshot_file.path, *key);
+  ASSERT_NE(nullptr, snapshot);
+  ASSERT_NE(nullptr, snapshot->FindBag(app::R::style::StyleTwo));
+  assetmanager.SetResolvedSnapshot(snapshot);
+
+  ASSERT_TRUE(assetmanager.GetBag(app::R::style::StyleTwo).has_value());
+  const std::vector<uint32_t> expected_stack = {app::R::style::StyleTwo, app::R::style::StyleOne};
+  EXPECT_EQ(expected_stack, assetmanager.GetBagResIdStack(app::R::style::StyleTwo));
+}
+
 TEST_F(AssetManager2Test, ResolveReferenceToResource) {
   AssetManager2 assetmanager;
   assetmanager.SetApkAssets({basic_assets_.get()});
@@ -165,4 +165,47 @@ static void BM_ApplyStyleFramework(benchmark::State& state) {
 }
 BENCHMARK(BM_ApplyStyleFramework);
 
+// Resolves the attributes of `state.range(0)` views styled the same way, one call per view or in a
+// single batch.
+static void BM_ApplyStylesFramework(benchmark::State& state, bool batched) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({apk.get()});
+
+  std::unique_ptr<Theme> theme = assetmanager.NewTheme();
+  if (!theme->ApplyStyle(Theme_Material_Light).has_value()) {
+    state.SkipWithError("failed to apply style");
+    return;
+  }
+
+  // android:attr/colorForeground, textColorPrimary, windowBackground and textAppearance.
+  const std::array<uint32_t, 4> attrs{{0x01010030u, 0x01010036u, 0x01010054u, 0x01010034u}};
+  const size_t view_count = static_cast<size_t>(state.range(0));
+  std::vector<StyleRequest> requests(view_count, StyleRequest{nullptr, 0u /* def_style_attr */,
+                                                              0u /* def_style_resid */,
+                                                              attrs.data(), attrs.size()});
+  std::vector<uint32_t> values(view_count * attrs.size() * STYLE_NUM_ENTRIES);
+  std::vector<uint32_t> indices(view_count * (attrs.size() + 1));
+
+  while (state.KeepRunning()) {
+    if (batched) {
+      ApplyStyles(theme.get(), requests.data(), requests.size(), values.data(), indices.data());
+      continue;
+    }
+    for (size_t i = 0; i < view_count; i++) {
+      ApplyStyle(theme.get(), nullptr /* xml_parser */, 0u /* def_style_attr */,
+                 0u /* def_style_res */, attrs.data(), attrs.size(),
+                 values.data() + i * attrs.size() * STYLE_NUM_ENTRIES,
+                 indices.data() + i * (attrs.size() + 1));
+    }
+  }
+}
+BENCHMARK_CAPTURE(BM_ApplyStylesFramework, separate, false)->Arg(1)->Arg(16);
+BENCHMARK_CAPTURE(BM_ApplyStylesFramework, batched, true)->Arg(1)->Arg(16);
+
 }  // namespace android
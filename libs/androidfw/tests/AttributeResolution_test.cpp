@@ -16,6 +16,7 @@
 
 #include "androidfw/AttributeResolution.h"
 
+#include <algorithm>
 #include <array>
 
 #include "android-base/file.h"
@@ -272,5 +273,35 @@ TEST_F(AttributeResolutionXmlTest, ThemeAndXmlParser) {
   EXPECT_EQ(expected_indices, indices);
 }
 
-} // namespace android
+TEST_F(AttributeResolutionXmlTest, ApplyStylesMatchesApplyStyle) {
+  std::unique_ptr<Theme> theme = assetmanager_.NewTheme();
+  ASSERT_TRUE(theme->ApplyStyle(R::style::StyleTwo).has_value());
 
+  std::array<uint32_t, 6> attrs{{R::attr::attr_one, R::attr::attr_two, R::attr::attr_three,
+                                 R::attr::attr_four, R::attr::attr_five, R::attr::attr_empty}};
+  const std::array<StyleRequest, 3> requests{{
+      {&xml_parser_, 0u /*def_style_attr*/, 0u /*def_style_res*/, attrs.data(), attrs.size()},
+      {nullptr, 0u /*def_style_attr*/, R::style::StyleOne, attrs.data(), attrs.size()},
+      {&xml_parser_, 0u /*def_style_attr*/, R::style::StyleOne, attrs.data(), attrs.size()},
+  }};
+
+  std::array<uint32_t, requests.size() * attrs.size() * STYLE_NUM_ENTRIES> values;
+  std::array<uint32_t, requests.size() * (attrs.size() + 1)> indices{};
+  ASSERT_TRUE(ApplyStyles(theme.get(), requests.data(), requests.size(), values.data(),
+                          indices.data()).has_value());
+
+  for (size_t i = 0; i < requests.size(); i++) {
+    std::array<uint32_t, attrs.size() * STYLE_NUM_ENTRIES> expected_values;
+    std::array<uint32_t, attrs.size() + 1> expected_indices{};
+    ASSERT_TRUE(ApplyStyle(theme.get(), requests[i].xml_parser, requests[i].def_style_attr,
+                           requests[i].def_style_resid, attrs.data(), attrs.size(),
+                           expected_values.data(), expected_indices.data()).has_value());
+
+    EXPECT_TRUE(std::equal(expected_values.begin(), expected_values.end(),
+                           values.begin() + i * expected_values.size()));
+    EXPECT_TRUE(std::equal(expected_indices.begin(), expected_indices.end(),
+                           indices.begin() + i * expected_indices.size()));
+  }
+}
+
+} // namespace android
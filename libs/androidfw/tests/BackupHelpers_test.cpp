@@ -20,6 +20,8 @@
 #include <gtest/gtest.h>
 
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include <utils/String8.h>
 #include <android-base/file.h>
 
@@ -59,5 +61,34 @@ TEST_F(BackupHelpersTest, WriteTarFileWithSizeGreaterThan2GB) {
   off64_t expectedTarSize = fileSize + 512;
   ASSERT_EQ(tarSize, expectedTarSize);
 }
+
+TEST_F(BackupHelpersTest, BackUpFilesSkipsFilesUnchangedSinceSnapshot) {
+  TemporaryFile file;
+  ASSERT_TRUE(android::base::WriteStringToFile("first", file.path));
+  char const* files[] = {file.path};
+  char const* keys[] = {"file"};
+
+  TemporaryFile firstData;
+  TemporaryFile firstSnapshot;
+  BackupDataWriter firstWriter(firstData.fd);
+  ASSERT_EQ(0, back_up_files(-1, &firstWriter, firstSnapshot.fd, files, keys, 1));
+  struct stat st;
+  ASSERT_EQ(0, fstat(firstData.fd, &st));
+  ASSERT_GT(st.st_size, 0);
+
+  // Rewrite the file with the same size and restore its modification time.
+  ASSERT_EQ(0, stat(file.path, &st));
+  ASSERT_TRUE(android::base::WriteStringToFile("other", file.path));
+  struct timeval times[2] = {{st.st_atime, 0}, {st.st_mtime, 0}};
+  ASSERT_EQ(0, utimes(file.path, times));
+
+  TemporaryFile secondData;
+  TemporaryFile secondSnapshot;
+  BackupDataWriter secondWriter(secondData.fd);
+  ASSERT_EQ(0, lseek(firstSnapshot.fd, 0, SEEK_SET));
+  ASSERT_EQ(0, back_up_files(firstSnapshot.fd, &secondWriter, secondSnapshot.fd, files, keys, 1));
+  ASSERT_EQ(0, fstat(secondData.fd, &st));
+  EXPECT_EQ(0, st.st_size);
+}
 }
 
@@ -205,4 +205,41 @@ TEST(ConfigTest, ScreenIsHdr) {
   EXPECT_EQ(defaultConfig.diff(hdrConfig), ResTable_config::CONFIG_COLOR_MODE);
 }
 
+TEST(ConfigTest, PackedAxesNeverRejectMatchingConfigs) {
+  // Candidates and requests that vary over the axes covered by the packed form, including the
+  // KEYSHIDDEN_NO/KEYSHIDDEN_SOFT compatibility rule that the packed form can't express.
+  Vector<ResTable_config> configs;
+  for (uint8_t orientation : {0, 1, 2}) {
+    for (uint8_t night : {0, 0x10, 0x20}) {
+      for (uint8_t keys_hidden : {0, 1, 3}) {
+        for (uint16_t mcc : {0, 310}) {
+          ResTable_config config;
+          memset(&config, 0, sizeof(config));
+          config.orientation = orientation;
+          config.uiMode = night | ResTable_config::UI_MODE_TYPE_NORMAL;
+          config.inputFlags = keys_hidden;
+          config.mcc = mcc;
+          config.colorMode = (mcc != 0) ? ResTable_config::HDR_YES : 0;
+          configs.add(config);
+        }
+      }
+    }
+  }
+
+  size_t rejected = 0;
+  for (const ResTable_config& settings : configs) {
+    const ResTable_config::PackedAxes packed_settings = settings.packAxes();
+    for (const ResTable_config& candidate : configs) {
+      const bool may_match = candidate.packAxes().mayMatch(packed_settings);
+      if (candidate.match(settings)) {
+        EXPECT_TRUE(may_match) << candidate.toString() << " vs " << settings.toString();
+      }
+      rejected += may_match ? 0 : 1;
+    }
+  }
+
+  // Most of the candidates must be rejected by the packed form alone.
+  EXPECT_GT(rejected, configs.size() * configs.size() / 2);
+}
+
 }  // namespace android.
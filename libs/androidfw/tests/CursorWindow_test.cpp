@@ -176,6 +176,102 @@ TEST(CursorWindowTest, StoreBounds) {
     ASSERT_EQ(w->getFieldSlot(-1, -1), nullptr);
 }
 
+TEST(CursorWindowTest, PutRow) {
+    CREATE_WINDOW_1K;
+    ASSERT_EQ(w->setNumColumns(4), OK);
+
+    CursorWindow::Field fields[4];
+    fields[0].type = CursorWindow::FIELD_TYPE_INTEGER;
+    fields[0].value.l = 0xcafe;
+    fields[1].type = CursorWindow::FIELD_TYPE_STRING;
+    fields[1].value.buffer.data = "food";
+    fields[1].value.buffer.size = 5;
+    fields[2].type = CursorWindow::FIELD_TYPE_FLOAT;
+    fields[2].value.d = 4.5;
+    fields[3].type = CursorWindow::FIELD_TYPE_NULL;
+    ASSERT_EQ(w->putRow(fields, 4), OK);
+    ASSERT_EQ(w->getNumRows(), 1);
+
+    // Rows must cover every column
+    ASSERT_NE(w->putRow(fields, 3), OK);
+    ASSERT_EQ(w->getNumRows(), 1);
+
+    {
+        auto field = w->getFieldSlot(0, 0);
+        ASSERT_EQ(w->getFieldSlotType(field), CursorWindow::FIELD_TYPE_INTEGER);
+        ASSERT_EQ(w->getFieldSlotValueLong(field), 0xcafe);
+    }
+    {
+        auto field = w->getFieldSlot(0, 1);
+        ASSERT_EQ(w->getFieldSlotType(field), CursorWindow::FIELD_TYPE_STRING);
+        size_t size;
+        auto actual = w->getFieldSlotValueString(field, &size);
+        ASSERT_EQ(size, 5);
+        ASSERT_EQ(std::string(actual), "food");
+    }
+    {
+        auto field = w->getFieldSlot(0, 2);
+        ASSERT_EQ(w->getFieldSlotType(field), CursorWindow::FIELD_TYPE_FLOAT);
+        ASSERT_EQ(w->getFieldSlotValueDouble(field), 4.5);
+    }
+    {
+        auto field = w->getFieldSlot(0, 3);
+        ASSERT_EQ(w->getFieldSlotType(field), CursorWindow::FIELD_TYPE_NULL);
+    }
+}
+
+TEST(CursorWindowTest, PutRowFull) {
+    CREATE_WINDOW_1K;
+    ASSERT_EQ(w->setNumColumns(2), OK);
+
+    void* buf = malloc(1 << 10);
+    memset(buf, 42, 1 << 10);
+
+    CursorWindow::Field fields[2];
+    fields[0].type = CursorWindow::FIELD_TYPE_INTEGER;
+    fields[0].value.l = 0xcafe;
+    fields[1].type = CursorWindow::FIELD_TYPE_BLOB;
+    fields[1].value.buffer.data = buf;
+    fields[1].value.buffer.size = 1 << 10;
+
+    // A row that doesn't fit is not added at all
+    auto before = w->freeSpace();
+    ASSERT_EQ(w->putRow(fields, 2), NO_MEMORY);
+    ASSERT_EQ(w->getNumRows(), 0);
+    ASSERT_EQ(w->freeSpace(), before);
+
+    fields[1].value.buffer.size = 16;
+    ASSERT_EQ(w->putRow(fields, 2), OK);
+    ASSERT_EQ(w->getNumRows(), 1);
+    free(buf);
+}
+
+TEST(CursorWindowTest, GetColumnLongs) {
+    CREATE_WINDOW_1K_3X3;
+
+    ASSERT_EQ(w->putLong(0, 1, 10), OK);
+    ASSERT_EQ(w->putLong(1, 1, 11), OK);
+    ASSERT_EQ(w->putNull(2, 1), OK);
+    ASSERT_EQ(w->putString(1, 2, "cafe", 5), OK);
+
+    int64_t values[3] = {-1, -1, -1};
+    ASSERT_EQ(w->getColumnLongs(1, 0, 3, values), OK);
+    ASSERT_EQ(values[0], 10);
+    ASSERT_EQ(values[1], 11);
+    ASSERT_EQ(values[2], 0);
+
+    ASSERT_EQ(w->getColumnLongs(1, 1, 1, values), OK);
+    ASSERT_EQ(values[0], 11);
+
+    // Columns holding other types are left to per-field readers
+    ASSERT_EQ(w->getColumnLongs(2, 0, 3, values), INVALID_OPERATION);
+    ASSERT_EQ(values[0], 11);
+
+    // Can't read beyond bounds
+    ASSERT_NE(w->getColumnLongs(1, 1, 3, values), OK);
+    ASSERT_NE(w->getColumnLongs(3, 0, 1, values), OK);
+}
+
 TEST(CursorWindowTest, Inflate) {
     CREATE_WINDOW_2M;
 
@@ -235,6 +331,47 @@ TEST(CursorWindowTest, Inflate) {
     }
 }
 
+TEST(CursorWindowTest, InflateReusesPooledRegion) {
+    void* buf = malloc(kGiantSize);
+    memset(buf, 42, kGiantSize);
+
+    CursorWindow* w;
+    ASSERT_EQ(CursorWindow::create(String8("test"), 1 << 21, &w), OK);
+    ASSERT_EQ(w->setNumColumns(1), OK);
+    ASSERT_EQ(w->allocRow(), OK);
+    ASSERT_EQ(w->putBlob(0, 0, buf, kGiantSize), OK);
+
+    auto before = CursorWindow::getPoolStats();
+    delete w;
+    auto released = CursorWindow::getPoolStats();
+    ASSERT_EQ(released.recycled + released.discarded, before.recycled + before.discarded + 1);
+    bool recycled = released.recycled > before.recycled;
+
+    ASSERT_EQ(CursorWindow::create(String8("test"), 1 << 21, &w), OK);
+    ASSERT_EQ(w->setNumColumns(1), OK);
+    ASSERT_EQ(w->allocRow(), OK);
+    ASSERT_EQ(w->putBlob(0, 0, buf, kGiantSize), OK);
+    auto after = CursorWindow::getPoolStats();
+    ASSERT_EQ(after.hits, released.hits + (recycled ? 1 : 0));
+
+    // The reused region holds the contents of the new window only
+    auto field = w->getFieldSlot(0, 0);
+    size_t actualSize;
+    auto actual = w->getFieldSlotValueBlob(field, &actualSize);
+    ASSERT_EQ(actualSize, kGiantSize);
+    ASSERT_EQ(memcmp(buf, actual, kGiantSize), 0);
+
+    // Regions that were sent to another process are never pooled
+    Parcel p;
+    ASSERT_EQ(w->writeToParcel(&p), OK);
+    before = CursorWindow::getPoolStats();
+    delete w;
+    after = CursorWindow::getPoolStats();
+    ASSERT_EQ(after.recycled, before.recycled);
+    ASSERT_EQ(after.discarded, before.discarded + 1);
+    free(buf);
+}
+
 TEST(CursorWindowTest, ParcelEmpty) {
     CREATE_WINDOW_2M;
 
@@ -17,6 +17,7 @@
 #include "android-base/file.h"
 #include "androidfw/ApkAssets.h"
 #include "androidfw/AssetManager2.h"
+#include "androidfw/Idmap.h"
 #include "androidfw/ResourceTypes.h"
 
 #include "utils/String16.h"
@@ -234,4 +235,40 @@ TEST_F(IdmapTest, OverlayAssetsIsUpToDate) {
   ASSERT_FALSE(apk_assets->IsUpToDate());
 }
 
+TEST(IdmapEntryIndexTest, FindsDenseAndSparseEntries) {
+  // Type 0x01 is dense enough to be indexed directly, type 0x02 is binary searched.
+  const std::vector<uint32_t> ids = {0x7f010000, 0x7f010001, 0x7f010003, 0x7f020000, 0x7f029000};
+  IdmapEntryIndex index(ids.data(), sizeof(uint32_t), ids.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    EXPECT_EQ(static_cast<int32_t>(i), index.Find(ids[i]));
+  }
+
+  EXPECT_EQ(-1, index.Find(0x7f010002));
+  EXPECT_EQ(-1, index.Find(0x7f010004));
+  EXPECT_EQ(-1, index.Find(0x7f020001));
+  EXPECT_EQ(-1, index.Find(0x7f030000));
+  EXPECT_EQ(-1, index.Find(0x01010000));
+  EXPECT_EQ(-1, IdmapEntryIndex().Find(0x7f010000));
+}
+
+TEST(IdmapEntryIndexTest, FindsEntriesOfSeveralPackages) {
+  const std::vector<uint32_t> ids = {0x01020000, 0x7f010000, 0x7f020000};
+  IdmapEntryIndex index(ids.data(), sizeof(uint32_t), ids.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    EXPECT_EQ(static_cast<int32_t>(i), index.Find(ids[i]));
+  }
+  EXPECT_EQ(-1, index.Find(0x7f020001));
+}
+
+TEST(IdmapEntryIndexTest, FindsMaskedIdsInPlace) {
+  // The ids are the first half of each pair, and are matched without their package id.
+  const std::vector<uint32_t> entries = {0x7f010000, 1, 0x7f010002, 2, 0x7f020000, 3};
+  IdmapEntryIndex index(entries.data(), 2 * sizeof(uint32_t), entries.size() / 2, 0x00FFFFFFU);
+  EXPECT_EQ(0, index.Find(0x010000));
+  EXPECT_EQ(1, index.Find(0x010002));
+  EXPECT_EQ(2, index.Find(0x020000));
+  EXPECT_EQ(-1, index.Find(0x010001));
+  EXPECT_EQ(-1, index.Find(0x7f010000));
+}
+
 }  // namespace
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "androidfw/AssetsProvider.h"
+#include "androidfw/LoadedArsc.h"
+#include "androidfw/ResourceTypes.h"
+
+#include "BenchmarkHelpers.h"
+
+namespace android {
+
+constexpr const static char* kFrameworkPath = "/system/framework/framework-res.apk";
+
+// `apk_path` is relative to the test data directory unless it is absolute.
+static std::unique_ptr<Asset> OpenResourcesArsc(const std::string& apk_path) {
+  auto zip = ZipAssetsProvider::Create(
+      apk_path[0] == '/' ? apk_path : GetTestDataPath() + "/" + apk_path, 0U /* flags */);
+  if (zip == nullptr) {
+    return {};
+  }
+  return zip->Open("resources.arsc", Asset::ACCESS_BUFFER);
+}
+
+static void BM_LoadedArscLoad(benchmark::State& state, const std::string& apk_path,
+                              package_property_t flags) {
+  std::unique_ptr<Asset> asset = OpenResourcesArsc(apk_path);
+  if (asset == nullptr) {
+    state.SkipWithError("Failed to open resources.arsc");
+    return;
+  }
+
+  const void* data = asset->getBuffer(true /* aligned */);
+  const size_t length = static_cast<size_t>(asset->getLength());
+  while (state.KeepRunning()) {
+    std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(data, length,
+                                                                     nullptr /* loaded_idmap */,
+                                                                     flags);
+    benchmark::DoNotOptimize(loaded_arsc);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * length);
+}
+BENCHMARK_CAPTURE(BM_LoadedArscLoad, basic, "basic/basic.apk", 0U);
+BENCHMARK_CAPTURE(BM_LoadedArscLoad, basic_lazy_types, "basic/basic.apk", PROPERTY_LAZY_TYPES);
+BENCHMARK_CAPTURE(BM_LoadedArscLoad, framework, kFrameworkPath, 0U);
+BENCHMARK_CAPTURE(BM_LoadedArscLoad, framework_lazy_types, kFrameworkPath, PROPERTY_LAZY_TYPES);
+
+// Loads the table and then walks every type, which is what a lookup of each type eventually does.
+static void BM_LoadedArscLoadAndVisitTypes(benchmark::State& state, package_property_t flags) {
+  std::unique_ptr<Asset> asset = OpenResourcesArsc(kFrameworkPath);
+  if (asset == nullptr) {
+    state.SkipWithError("Failed to open resources.arsc");
+    return;
+  }
+
+  const void* data = asset->getBuffer(true /* aligned */);
+  const size_t length = static_cast<size_t>(asset->getLength());
+  while (state.KeepRunning()) {
+    std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(data, length,
+                                                                     nullptr /* loaded_idmap */,
+                                                                     flags);
+    size_t type_count = 0;
+    for (const auto& package : loaded_arsc->GetPackages()) {
+      package->ForEachTypeSpec([&](const TypeSpec& spec, uint8_t) {
+        type_count += spec.type_entries.size();
+      });
+    }
+    benchmark::DoNotOptimize(type_count);
+  }
+}
+BENCHMARK_CAPTURE(BM_LoadedArscLoadAndVisitTypes, framework, 0U);
+BENCHMARK_CAPTURE(BM_LoadedArscLoadAndVisitTypes, framework_lazy_types, PROPERTY_LAZY_TYPES);
+
+}  // namespace android
@@ -71,6 +71,42 @@ TEST(LoadedArscTest, LoadSinglePackageArsc) {
   ASSERT_TRUE(LoadedPackage::GetEntry(type.type, entry_index).has_value());
 }
 
+TEST(LoadedArscTest, LoadSinglePackageArscWithLazyTypes) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/styles/styles.apk", "resources.arsc",
+                                      &contents));
+
+  auto eager_arsc = LoadedArsc::Load(contents.data(), contents.length());
+  ASSERT_THAT(eager_arsc, NotNull());
+  auto lazy_arsc = LoadedArsc::Load(contents.data(), contents.length(), nullptr /* loaded_idmap */,
+                                    PROPERTY_LAZY_TYPES);
+  ASSERT_THAT(lazy_arsc, NotNull());
+
+  const uint8_t package_id = get_package_id(app::R::string::string_one);
+  const LoadedPackage* eager_package = eager_arsc->GetPackageById(package_id);
+  const LoadedPackage* lazy_package = lazy_arsc->GetPackageById(package_id);
+  ASSERT_THAT(eager_package, NotNull());
+  ASSERT_THAT(lazy_package, NotNull());
+  EXPECT_NE(0U, lazy_package->GetPropertyFlags() & PROPERTY_LAZY_TYPES);
+
+  const uint8_t type_index = get_type_id(app::R::string::string_one) - 1;
+  const uint16_t entry_index = get_entry_id(app::R::string::string_one);
+
+  const TypeSpec* type_spec = lazy_package->GetTypeSpecByTypeIndex(type_index);
+  ASSERT_THAT(type_spec, NotNull());
+  ASSERT_THAT(type_spec->type_entries.size(),
+              Eq(eager_package->GetTypeSpecByTypeIndex(type_index)->type_entries.size()));
+  ASSERT_TRUE(LoadedPackage::GetEntry(type_spec->type_entries[0].type, entry_index).has_value());
+
+  std::set<ResTable_config> eager_configs;
+  std::set<ResTable_config> lazy_configs;
+  ASSERT_TRUE(eager_package->CollectConfigurations(false /* exclude_mipmap */, &eager_configs)
+                  .has_value());
+  ASSERT_TRUE(lazy_package->CollectConfigurations(false /* exclude_mipmap */, &lazy_configs)
+                  .has_value());
+  EXPECT_EQ(eager_configs, lazy_configs);
+}
+
 TEST(LoadedArscTest, LoadSparseEntryApp) {
   std::string contents;
   ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/sparse/sparse.apk", "resources.arsc",
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "androidfw/ApkAssets.h"
+#include "androidfw/ResourceTypes.h"
+
+#include "BenchmarkHelpers.h"
+
+namespace android {
+
+constexpr const static char* kFrameworkPath = "/system/framework/framework-res.apk";
+
+// Returns the global string pool chunk of the resources.arsc in `asset`, or nullptr if the table
+// does not start with one.
+static const ResStringPool_header* FindGlobalStringPool(Asset* asset) {
+  const auto table = reinterpret_cast<const ResTable_header*>(asset->getBuffer(true /* aligned */));
+  const size_t length = static_cast<size_t>(asset->getLength());
+  if (table == nullptr || length < sizeof(ResTable_header) + sizeof(ResStringPool_header)) {
+    return nullptr;
+  }
+  const auto pool = reinterpret_cast<const ResStringPool_header*>(
+      reinterpret_cast<const uint8_t*>(table) + dtohs(table->header.headerSize));
+  if (dtohs(pool->header.type) != RES_STRING_POOL_TYPE) {
+    return nullptr;
+  }
+  return pool;
+}
+
+static void ReportDecodeCache(benchmark::State& state, const ResStringPool& pool) {
+  const ResStringPool::DecodeCacheStats stats = pool.getDecodeCacheStats();
+  state.counters["cached_strings"] = stats.strings;
+  state.counters["cache_bytes"] = stats.bytes;
+}
+
+// Decodes every string of a freshly parsed pool, as done on first access after process start.
+static void BM_ResStringPoolStringAtCold(benchmark::State& state) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  std::unique_ptr<Asset> asset = apk->GetAssetsProvider()->Open("resources.arsc",
+                                                               Asset::ACCESS_BUFFER);
+  const ResStringPool_header* header = asset != nullptr ? FindGlobalStringPool(asset.get())
+                                                        : nullptr;
+  if (header == nullptr) {
+    state.SkipWithError("Failed to find the global string pool");
+    return;
+  }
+
+  ResStringPool pool;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    pool.setTo(header, dtohl(header->header.size), false /* copyData */);
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < pool.size(); i++) {
+      benchmark::DoNotOptimize(pool.stringAt(i));
+    }
+  }
+  ReportDecodeCache(state, pool);
+}
+BENCHMARK(BM_ResStringPoolStringAtCold);
+
+// Looks up every string of a pool whose strings have all been decoded already.
+static void BM_ResStringPoolStringAtWarm(benchmark::State& state) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  const ResStringPool* pool = apk->GetLoadedArsc()->GetStringPool();
+  for (size_t i = 0; i < pool->size(); i++) {
+    pool->stringAt(i);
+  }
+
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < pool->size(); i++) {
+      benchmark::DoNotOptimize(pool->stringAt(i));
+    }
+  }
+  ReportDecodeCache(state, *pool);
+}
+BENCHMARK(BM_ResStringPoolStringAtWarm);
+
+}  // namespace android
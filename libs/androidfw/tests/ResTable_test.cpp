@@ -476,4 +476,42 @@ TEST(ResTableTest, TruncatedEncodeLength) {
   ASSERT_FALSE(invalid_pool->stringAt(invalid_val.data).has_value());
 }
 
+TEST(ResTableTest, DecodeCacheStats) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/length_decode/length_decode_valid.apk",
+                                      "resources.arsc", &contents));
+
+  ResTable table;
+  ASSERT_EQ(NO_ERROR, table.add(contents.data(), contents.size()));
+
+  Res_value val;
+  ssize_t block = table.getResource(0x7f010001, &val, MAY_NOT_BE_BAG);
+  ASSERT_GE(block, 0);
+  ASSERT_EQ(Res_value::TYPE_STRING, val.dataType);
+
+  const ResStringPool* pool = table.getTableStringBlock(block);
+  ASSERT_TRUE(pool != NULL);
+  ASSERT_TRUE(pool->isUTF8());
+
+  // Reading UTF-8 strings does not populate the decode cache.
+  ASSERT_TRUE(pool->string8At(val.data).has_value());
+  EXPECT_EQ(size_t(0), pool->getDecodeCacheStats().strings);
+  EXPECT_EQ(size_t(0), pool->getDecodeCacheStats().bytes);
+
+  auto first = pool->stringAt(val.data);
+  ASSERT_TRUE(first.has_value());
+  ResStringPool::DecodeCacheStats stats = pool->getDecodeCacheStats();
+  EXPECT_EQ(size_t(0), stats.hits);
+  EXPECT_EQ(size_t(1), stats.misses);
+  EXPECT_EQ(size_t(1), stats.strings);
+  EXPECT_GE(stats.bytes, (first->size() + 1) * sizeof(char16_t));
+
+  // The cached copy is returned on the next lookup.
+  auto second = pool->stringAt(val.data);
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(first->data(), second->data());
+  EXPECT_EQ(size_t(1), pool->getDecodeCacheStats().hits);
+  EXPECT_EQ(stats.bytes, pool->getDecodeCacheStats().bytes);
+}
+
 }  // namespace android
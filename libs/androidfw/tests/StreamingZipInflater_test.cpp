@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "androidfw/StreamingZipInflater.h"
+
+#include <string>
+
+#include "android-base/file.h"
+#include "zlib.h"
+
+#include "TestHelpers.h"
+
+namespace android {
+
+// Returns `size` bytes of text that compresses well but not trivially.
+static std::string MakeUncompressedData(size_t size) {
+  std::string data;
+  data.reserve(size);
+  uint32_t seed = 42;
+  while (data.size() < size) {
+    seed = seed * 1103515245 + 12345;
+    data += "line " + std::to_string((seed >> 16) % 1000) + "\n";
+  }
+  data.resize(size);
+  return data;
+}
+
+// Compresses `data` into a raw deflate stream, like the data of a zip entry.
+static std::string Deflate(const std::string& data) {
+  z_stream stream = {};
+  EXPECT_EQ(Z_OK, deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                               Z_DEFAULT_STRATEGY));
+  std::string compressed(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = (Bytef*)data.data();
+  stream.avail_in = data.size();
+  stream.next_out = (Bytef*)compressed.data();
+  stream.avail_out = compressed.size();
+  EXPECT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+class StreamingZipInflaterTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    data_ = MakeUncompressedData(4 * 1024 * 1024);
+    const std::string compressed = Deflate(data_);
+    ASSERT_TRUE(android::base::WriteStringToFd(compressed, file_.fd));
+    inflater_ = std::make_unique<StreamingZipInflater>(file_.fd, 0, data_.size(),
+                                                       compressed.size());
+  }
+
+ protected:
+  void ExpectReadAt(off64_t offset, size_t size) {
+    std::string actual(size, '\0');
+    ASSERT_EQ(offset, inflater_->seekAbsolute(offset));
+    ASSERT_EQ(static_cast<ssize_t>(size), inflater_->read(actual.data(), size));
+    EXPECT_EQ(0, data_.compare(offset, size, actual)) << "at offset " << offset;
+  }
+
+  std::string data_;
+  TemporaryFile file_;
+  std::unique_ptr<StreamingZipInflater> inflater_;
+};
+
+TEST_F(StreamingZipInflaterTest, ReadsSequentially) {
+  std::string actual(data_.size(), '\0');
+  ASSERT_EQ(static_cast<ssize_t>(data_.size()), inflater_->read(actual.data(), actual.size()));
+  EXPECT_EQ(data_, actual);
+
+  // The first pass records seek points along the way.
+  EXPECT_GT(inflater_->getSeekPointCount(), 0u);
+  EXPECT_LE(inflater_->getSeekPointCount(), size_t(StreamingZipInflater::MAX_SEEK_POINTS));
+}
+
+TEST_F(StreamingZipInflaterTest, SeeksBackwardsFromSeekPoints) {
+  ASSERT_EQ(static_cast<ssize_t>(data_.size()), inflater_->read(nullptr, data_.size()));
+  ASSERT_GT(inflater_->getSeekPointCount(), 0u);
+
+  ExpectReadAt(3 * 1024 * 1024 + 17, 4096);
+  ExpectReadAt(1024 * 1024 + 5, 100000);
+  ExpectReadAt(2 * 1024 * 1024, 1);
+  ExpectReadAt(10, 4096);
+  ExpectReadAt(data_.size() - 4096, 4096);
+  ExpectReadAt(1500 * 1024, 65536 * 3);
+}
+
+TEST_F(StreamingZipInflaterTest, SmallBlobsAreNotIndexed) {
+  data_ = MakeUncompressedData(StreamingZipInflater::MIN_INDEXED_SIZE - 1);
+  const std::string compressed = Deflate(data_);
+  TemporaryFile file;
+  ASSERT_TRUE(android::base::WriteStringToFd(compressed, file.fd));
+  inflater_ = std::make_unique<StreamingZipInflater>(file.fd, 0, data_.size(),
+                                                     compressed.size());
+
+  ASSERT_EQ(static_cast<ssize_t>(data_.size()), inflater_->read(nullptr, data_.size()));
+  EXPECT_EQ(0u, inflater_->getSeekPointCount());
+  ExpectReadAt(1024 * 1024, 4096);
+}
+
+}  // namespace android
@@ -93,4 +93,43 @@ static void BM_ThemeGetAttributeOld(benchmark::State& state) {
 }
 BENCHMARK(BM_ThemeGetAttributeOld);
 
+static void BM_ThemeApplyStyleFrameworkCold(benchmark::State& state) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  while (state.KeepRunning()) {
+    // A new AssetManager has neither the bags nor the applied styles cached.
+    state.PauseTiming();
+    AssetManager2 assets;
+    assets.SetApkAssets({apk.get()});
+    state.ResumeTiming();
+
+    auto theme = assets.NewTheme();
+    theme->ApplyStyle(kStyleId, false /* force */);
+  }
+}
+BENCHMARK(BM_ThemeApplyStyleFrameworkCold);
+
+static void BM_ThemeRebaseFramework(benchmark::State& state) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets({apk.get()});
+
+  const uint32_t styles[] = {kStyleId, kStyleId};
+  const uint8_t force[] = {false, true};
+  auto theme = assets.NewTheme();
+  while (state.KeepRunning()) {
+    theme->Rebase(&assets, styles, force, arraysize(styles));
+  }
+}
+BENCHMARK(BM_ThemeRebaseFramework);
+
 }  // namespace android
@@ -90,6 +90,27 @@ TEST_F(ThemeTest, SingleThemeNoParent) {
   EXPECT_EQ(static_cast<uint32_t>(ResTable_typeSpec::SPEC_PUBLIC), value->flags);
 }
 
+TEST_F(ThemeTest, ApplyStyleAfterApkAssetsChange) {
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({style_assets_.get()});
+
+  std::unique_ptr<Theme> theme = assetmanager.NewTheme();
+  ASSERT_TRUE(theme->ApplyStyle(app::R::style::StyleOne).has_value());
+
+  // The applied style must not be served from the cache once the style is gone.
+  assetmanager.SetApkAssets({});
+  std::unique_ptr<Theme> theme_two = assetmanager.NewTheme();
+  EXPECT_FALSE(theme_two->ApplyStyle(app::R::style::StyleOne).has_value());
+  EXPECT_FALSE(theme_two->GetAttribute(app::R::attr::attr_one).has_value());
+
+  assetmanager.SetApkAssets({style_assets_.get()});
+  std::unique_ptr<Theme> theme_three = assetmanager.NewTheme();
+  ASSERT_TRUE(theme_three->ApplyStyle(app::R::style::StyleOne).has_value());
+  auto value = theme_three->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(1u, value->data);
+}
+
 TEST_F(ThemeTest, SingleThemeWithParent) {
   AssetManager2 assetmanager;
   assetmanager.SetApkAssets({style_assets_.get()});
@@ -325,6 +346,63 @@ TEST_F(ThemeTest, ThemeRebase) {
   EXPECT_EQ(static_cast<uint32_t>(ResTable_typeSpec::SPEC_PUBLIC), value->flags);
 }
 
+TEST_F(ThemeTest, ThemeRebaseAfterConfigurationChange) {
+  AssetManager2 am;
+  am.SetApkAssets({style_assets_.get()});
+
+  const uint32_t styles[] = {app::R::style::StyleOne, app::R::style::StyleDayNight};
+  const uint8_t force[] = {false, true};
+  auto theme = am.NewTheme();
+  theme->Rebase(&am, styles, force, arraysize(styles));
+
+  auto value = theme->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(10u, value->data);
+
+  // Rebasing onto the same configuration gives the same result.
+  theme->Rebase(&am, styles, force, arraysize(styles));
+  value = theme->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(10u, value->data);
+
+  // The styles applied before the configuration change must not be reused after it.
+  ResTable_config night{};
+  night.uiMode = ResTable_config::UI_MODE_NIGHT_YES;
+  night.version = 8u;
+  am.SetConfiguration(night);
+  theme->Rebase(&am, styles, force, arraysize(styles));
+
+  value = theme->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(100u, value->data);
+  EXPECT_EQ(static_cast<uint32_t>(ResTable_typeSpec::SPEC_PUBLIC | ResTable_config::CONFIG_UI_MODE |
+            ResTable_config::CONFIG_VERSION), theme->GetChangingConfigurations());
+}
+
+TEST_F(ThemeTest, ApplyStyleDoesNotModifySharedEntries) {
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({style_assets_.get()});
+
+  std::unique_ptr<Theme> theme_one = assetmanager.NewTheme();
+  ASSERT_TRUE(theme_one->ApplyStyle(app::R::style::StyleOne).has_value());
+
+  std::unique_ptr<Theme> theme_two = assetmanager.NewTheme();
+  theme_two->SetTo(*theme_one);
+  ASSERT_TRUE(theme_two->ApplyStyle(app::R::style::StyleThree, true /* force */).has_value());
+
+  // A theme independently built from the same style sees the same attributes.
+  std::unique_ptr<Theme> theme_three = assetmanager.NewTheme();
+  ASSERT_TRUE(theme_three->ApplyStyle(app::R::style::StyleOne).has_value());
+
+  EXPECT_TRUE(theme_two->GetAttribute(app::R::attr::attr_six).has_value());
+  EXPECT_FALSE(theme_one->GetAttribute(app::R::attr::attr_six).has_value());
+  EXPECT_FALSE(theme_three->GetAttribute(app::R::attr::attr_six).has_value());
+
+  auto value = theme_three->GetAttribute(app::R::attr::attr_one);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(1u, value->data);
+}
+
 TEST_F(ThemeTest, OnlyCopySameAssetsThemeWhenAssetManagersDiffer) {
   AssetManager2 assetmanager_dst;
   assetmanager_dst.SetApkAssets({system_assets_.get(), lib_one_assets_.get(), style_assets_.get(),
@@ -37,9 +37,9 @@ struct DirtyStack {
         const RenderNode* renderNode;
         const Matrix4* matrix4;
     };
-    // When this frame is pop'd, this rect is mapped through the above transform
+    // When this frame is pop'd, this region is mapped through the above transform
     // and applied to the previous (aka parent) frame
-    SkRect pendingDirty;
+    DamageRegion pendingDirty;
     DirtyStack* prev;
     DirtyStack* next;
 };
@@ -119,18 +119,22 @@ void DamageAccumulator::popTransform() {
     }
 }
 
-static inline void mapRect(const Matrix4* matrix, const SkRect& in, SkRect* out) {
+static inline void mapRect(const Matrix4* matrix, const DamageRegion& in, DamageRegion* out) {
     if (in.isEmpty()) return;
-    Rect temp(in);
-    if (CC_LIKELY(!matrix->isPerspective())) {
-        matrix->mapRect(temp);
-    } else {
+    if (CC_UNLIKELY(matrix->isPerspective())) {
         // Don't attempt to calculate damage for a perspective transform
         // as the numbers this works with can break the perspective
         // calculations. Just give up and expand to DIRTY_MIN/DIRTY_MAX
-        temp.set(DIRTY_MIN, DIRTY_MIN, DIRTY_MAX, DIRTY_MAX);
+        out->join(SkRect::MakeLTRB(DIRTY_MIN, DIRTY_MIN, DIRTY_MAX, DIRTY_MAX));
+        return;
+    }
+    // in and out may be the same region
+    const DamageRegion source(in);
+    for (const SkRect& rect : source) {
+        Rect temp(rect);
+        matrix->mapRect(temp);
+        out->join({RECT_ARGS(temp)});
     }
-    out->join({RECT_ARGS(temp)});
 }
 
 void DamageAccumulator::applyMatrix4Transform(DirtyStack* frame) {
@@ -154,23 +158,28 @@ static inline void applyMatrix(const SkMatrix& transform, SkRect* rect) {
     return applyMatrix(&transform, rect);
 }
 
-static inline void mapRect(const RenderProperties& props, const SkRect& in, SkRect* out) {
+static inline void mapRect(const RenderProperties& props, const DamageRegion& in,
+                           DamageRegion* out) {
     if (in.isEmpty()) return;
-    SkRect temp(in);
-    if (Properties::getStretchEffectBehavior() == StretchEffectBehavior::UniformScale) {
-        const StretchEffect& stretch = props.layerProperties().getStretchEffect();
-        if (!stretch.isEmpty()) {
+    const bool uniformStretch =
+            Properties::getStretchEffectBehavior() == StretchEffectBehavior::UniformScale &&
+            !props.layerProperties().getStretchEffect().isEmpty();
+    // in and out may be the same region
+    const DamageRegion source(in);
+    for (SkRect temp : source) {
+        if (uniformStretch) {
+            const StretchEffect& stretch = props.layerProperties().getStretchEffect();
             applyMatrix(stretch.makeLinearStretch(props.getWidth(), props.getHeight()), &temp);
         }
+        applyMatrix(props.getTransformMatrix(), &temp);
+        if (props.getStaticMatrix()) {
+            applyMatrix(props.getStaticMatrix(), &temp);
+        } else if (props.getAnimationMatrix()) {
+            applyMatrix(props.getAnimationMatrix(), &temp);
+        }
+        temp.offset(props.getLeft(), props.getTop());
+        out->join(temp);
     }
-    applyMatrix(props.getTransformMatrix(), &temp);
-    if (props.getStaticMatrix()) {
-        applyMatrix(props.getStaticMatrix(), &temp);
-    } else if (props.getAnimationMatrix()) {
-        applyMatrix(props.getAnimationMatrix(), &temp);
-    }
-    temp.offset(props.getLeft(), props.getTop());
-    out->join(temp);
 }
 
 static DirtyStack* findParentRenderNode(DirtyStack* frame) {
@@ -196,7 +205,7 @@ static DirtyStack* findProjectionReceiver(DirtyStack* frame) {
 }
 
 static void applyTransforms(DirtyStack* frame, DirtyStack* end) {
-    SkRect* rect = &frame->pendingDirty;
+    DamageRegion* rect = &frame->pendingDirty;
     while (frame != end) {
         if (frame->type == TransformRenderNode) {
             mapRect(frame->renderNode->properties(), *rect, rect);
@@ -264,19 +273,29 @@ void DamageAccumulator::applyRenderNodeTransform(DirtyStack* frame) {
 }
 
 void DamageAccumulator::dirty(float left, float top, float right, float bottom) {
-    mHead->pendingDirty.join({left, top, right, bottom});
+    mHead->pendingDirty.join(SkRect{left, top, right, bottom});
 }
 
 void DamageAccumulator::peekAtDirty(SkRect* dest) const {
+    *dest = mHead->pendingDirty.getBounds();
+}
+
+void DamageAccumulator::peekAtDirty(DamageRegion* dest) const {
     *dest = mHead->pendingDirty;
 }
 
 void DamageAccumulator::finish(SkRect* totalDirty) {
+    DamageRegion region;
+    finish(&region);
+    *totalDirty = region.getBounds();
+}
+
+void DamageAccumulator::finish(DamageRegion* totalDirty) {
     LOG_ALWAYS_FATAL_IF(mHead->prev != mHead, "Cannot finish, mismatched push/pop calls! %p vs. %p",
                         mHead->prev, mHead);
-    // Root node never has a transform, so this is the fully mapped dirty rect
+    // Root node never has a transform, so this is the fully mapped dirty region
     *totalDirty = mHead->pendingDirty;
-    totalDirty->roundOut(totalDirty);
+    totalDirty->roundOut();
     mHead->pendingDirty.setEmpty();
 }
 
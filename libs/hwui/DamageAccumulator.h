@@ -23,6 +23,7 @@
 #include <SkRect.h>
 #include <effects/StretchEffect.h>
 
+#include "DamageRegion.h"
 #include "utils/Macros.h"
 
 // Smaller than INT_MIN/INT_MAX because we offset these values
@@ -58,10 +59,14 @@ public:
 
     // Returns the current dirty area, *NOT* transformed by pushed transforms
     void peekAtDirty(SkRect* dest) const;
+    void peekAtDirty(DamageRegion* dest) const;
 
     void computeCurrentTransform(Matrix4* outMatrix) const;
 
+    // Returns the bounds of the dirty area
     void finish(SkRect* totalDirty);
+    // Returns the dirty area as the few disjoint rects that make it up
+    void finish(DamageRegion* totalDirty);
 
     struct StretchResult {
         /**
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DamageRegion.h"
+
+#include <limits>
+
+namespace android {
+namespace uirenderer {
+
+static inline float area(const SkRect& rect) {
+    return rect.width() * rect.height();
+}
+
+void DamageRegion::join(const SkRect& rect) {
+    if (rect.isEmpty()) {
+        return;
+    }
+    // Absorb every rect the new one overlaps. Growing it can make it overlap rects it didn't
+    // before, so go around until it stops growing.
+    SkRect merged = rect;
+    bool grew = true;
+    while (grew) {
+        grew = false;
+        for (size_t i = 0; i < mCount;) {
+            if (SkRect::Intersects(mRects[i], merged)) {
+                merged.join(mRects[i]);
+                mRects[i] = mRects[--mCount];
+                grew = true;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    if (mCount == kMaxRects) {
+        size_t best = 0;
+        float bestGrowth = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < mCount; i++) {
+            SkRect joined = mRects[i];
+            joined.join(merged);
+            const float growth = area(joined) - area(mRects[i]) - area(merged);
+            if (growth < bestGrowth) {
+                best = i;
+                bestGrowth = growth;
+            }
+        }
+        merged.join(mRects[best]);
+        mRects[best] = mRects[--mCount];
+        // The merged rect may now overlap others, which the above takes care of.
+        join(merged);
+        return;
+    }
+
+    mRects[mCount++] = merged;
+    mBounds.join(merged);
+}
+
+bool DamageRegion::intersect(const SkRect& clip) {
+    mBounds.setEmpty();
+    for (size_t i = 0; i < mCount;) {
+        if (mRects[i].intersect(clip)) {
+            mBounds.join(mRects[i]);
+            i++;
+        } else {
+            mRects[i] = mRects[--mCount];
+        }
+    }
+    return mCount > 0;
+}
+
+void DamageRegion::roundOut() {
+    DamageRegion rounded;
+    for (const SkRect& rect : *this) {
+        rounded.join(SkRect::Make(rect.roundOut()));
+    }
+    *this = rounded;
+}
+
+} /* namespace uirenderer */
+} /* namespace android */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <SkRect.h>
+
+#include <stddef.h>
+
+namespace android {
+namespace uirenderer {
+
+/**
+ * A damaged area kept as a few disjoint rects rather than their union, so that two small
+ * changes far apart don't damage everything between them. Rects that overlap are merged, and
+ * once kMaxRects are held a new rect is merged into whichever one grows the least.
+ *
+ * This is trivially destructible and an all-zero DamageRegion is empty, so that it can live in
+ * the LinearAllocator-backed frames of the DamageAccumulator.
+ */
+class DamageRegion {
+public:
+    static constexpr size_t kMaxRects = 4;
+
+    DamageRegion() {}
+    DamageRegion(const SkRect& rect) { join(rect); }  // NOLINT(google-explicit-constructor)
+
+    bool isEmpty() const { return mCount == 0; }
+    size_t count() const { return mCount; }
+    const SkRect* begin() const { return mRects; }
+    const SkRect* end() const { return mRects + mCount; }
+
+    // The union of every rect.
+    const SkRect& getBounds() const { return mBounds; }
+
+    void setEmpty() {
+        mCount = 0;
+        mBounds.setEmpty();
+    }
+
+    void join(const SkRect& rect);
+    void join(const DamageRegion& other) {
+        for (const SkRect& rect : other) {
+            join(rect);
+        }
+    }
+
+    // Clips every rect to clip. Returns false if nothing is left.
+    bool intersect(const SkRect& clip);
+
+    // Grows every rect to integer bounds, merging any that come to overlap.
+    void roundOut();
+
+private:
+    SkRect mRects[kMaxRects];
+    size_t mCount = 0;
+    SkRect mBounds = SkRect::MakeEmpty();
+};
+
+} /* namespace uirenderer */
+} /* namespace android */
@@ -49,6 +49,10 @@ const std::array FrameInfoNames{"Flags",
 static_assert(static_cast<int>(FrameInfoIndex::NumIndexes) == 23,
               "Must update value in FrameMetrics.java#FRAME_STATS_COUNT (and here)");
 
+const std::array FrameStageNames{"PrepareTree", "Draw", "PipelineDraw"};
+
+static_assert(FrameStageNames.size() == static_cast<size_t>(FrameStage::NumStages));
+
 void FrameInfo::importUiThreadInfo(int64_t* info) {
     memcpy(mFrameInfo, info, UI_THREAD_FRAME_INFO_SIZE * sizeof(int64_t));
 }
@@ -67,6 +67,38 @@ enum class FrameInfoIndex {
 
 extern const std::array<const char*, static_cast<int>(FrameInfoIndex::NumIndexes)> FrameInfoNames;
 
+// The stages of a frame for which hardware counters are sampled, see PerfCounters.
+enum class FrameStage {
+    // RenderNode::prepareTree() of every node of the context
+    PrepareTree = 0,
+    // All of CanvasContext::draw()
+    Draw,
+    // The part of draw() spent in the pipeline, i.e. SkiaPipeline::renderFrame() and its flush
+    PipelineDraw,
+
+    // Must be the last value!
+    NumStages
+};
+
+extern const std::array<const char*, static_cast<int>(FrameStage::NumStages)> FrameStageNames;
+
+struct FrameStageCounters {
+    int64_t cycles = 0;
+    int64_t instructions = 0;
+    int64_t cacheMisses = 0;
+};
+
+// The time a frame spent in WebView functor callbacks on the RenderThread, see WebViewFunctor.
+// hwui waits on every one of these, so with several WebViews on screen they add up.
+struct FunctorTimings {
+    int32_t syncCount = 0;
+    int32_t drawCount = 0;
+    int64_t syncDuration = 0;
+    int64_t drawDuration = 0;
+    // The slowest single draw
+    int64_t maxDrawDuration = 0;
+};
+
 namespace FrameInfoFlags {
 enum {
     WindowVisibilityChanged = 1 << 0,
@@ -180,6 +212,20 @@ public:
 
     inline int64_t& set(FrameInfoIndex index) { return mFrameInfo[static_cast<int>(index)]; }
 
+    // Only filled in when Properties::sampleFrameCounters is set.
+    FrameStageCounters& stageCounters(FrameStage stage) {
+        return mStageCounters[static_cast<int>(stage)];
+    }
+
+    const FrameStageCounters& stageCounters(FrameStage stage) const {
+        return mStageCounters[static_cast<int>(stage)];
+    }
+
+    void resetStageCounters() { mStageCounters = {}; }
+
+    FunctorTimings& functorTimings() { return mFunctorTimings; }
+    const FunctorTimings& functorTimings() const { return mFunctorTimings; }
+
     inline int64_t get(FrameInfoIndex index) const {
         if (index == FrameInfoIndex::NumIndexes) return 0;
         return mFrameInfo[static_cast<int>(index)];
@@ -187,6 +233,8 @@ public:
 
 private:
     int64_t mFrameInfo[static_cast<int>(FrameInfoIndex::NumIndexes)];
+    std::array<FrameStageCounters, static_cast<int>(FrameStage::NumStages)> mStageCounters;
+    FunctorTimings mFunctorTimings;
 };
 
 } /* namespace uirenderer */
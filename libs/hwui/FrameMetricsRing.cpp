@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameMetricsRing.h"
+
+#include <cutils/ashmem.h>
+#include <log/log.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+namespace android {
+namespace uirenderer {
+
+// A reader can lose the race against the writer for a slot that is being overwritten. Give up
+// after a few tries rather than spinning: the frame is about to be gone anyway.
+static constexpr int kMaxReadAttempts = 4;
+
+std::unique_ptr<FrameMetricsRing> FrameMetricsRing::create() {
+    base::unique_fd fd(ashmem_create_region("hwui-frame-metrics", sizeof(Header)));
+    if (fd.get() < 0) {
+        int err = errno;
+        ALOGW("Failed to create frame metrics ring, err %d %s", err, strerror(err));
+        return nullptr;
+    }
+    void* addr = mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (addr == MAP_FAILED) {
+        int err = errno;
+        ALOGW("Failed to map frame metrics ring, err %d %s", err, strerror(err));
+        return nullptr;
+    }
+    // Readers only ever get to map the region read-only.
+    if (ashmem_set_prot_region(fd.get(), PROT_READ) < 0) {
+        ALOGW("Failed to protect frame metrics ring");
+        munmap(addr, sizeof(Header));
+        return nullptr;
+    }
+
+    // ashmem regions are zero filled, which is a valid initial state for every slot.
+    Header* header = reinterpret_cast<Header*>(addr);
+    header->magic = kMagic;
+    header->version = kVersion;
+    header->capacity = kCapacity;
+    header->frameInfoSize = kFrameInfoSize;
+    return std::unique_ptr<FrameMetricsRing>(
+            new FrameMetricsRing(std::move(fd), header, true /* writable */));
+}
+
+std::unique_ptr<FrameMetricsRing> FrameMetricsRing::map(int fd) {
+    int regionSize = ashmem_get_size_region(fd);
+    if (regionSize < static_cast<int>(sizeof(Header))) {
+        ALOGW("Frame metrics ring fd %d is too small: %d", fd, regionSize);
+        return nullptr;
+    }
+    base::unique_fd dupFd(dup(fd));
+    void* addr = mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, dupFd.get(), 0);
+    if (addr == MAP_FAILED) {
+        int err = errno;
+        ALOGW("Failed to map frame metrics ring fd %d, err %d %s", fd, err, strerror(err));
+        return nullptr;
+    }
+    Header* header = reinterpret_cast<Header*>(addr);
+    if (header->magic != kMagic || header->version != kVersion ||
+        header->capacity != kCapacity || header->frameInfoSize != kFrameInfoSize) {
+        ALOGW("Frame metrics ring fd %d has an unsupported layout", fd);
+        munmap(addr, sizeof(Header));
+        return nullptr;
+    }
+    return std::unique_ptr<FrameMetricsRing>(
+            new FrameMetricsRing(std::move(dupFd), header, false /* writable */));
+}
+
+FrameMetricsRing::~FrameMetricsRing() {
+    munmap(mHeader, sizeof(Header));
+}
+
+void FrameMetricsRing::write(const int64_t* frameInfo) {
+    LOG_ALWAYS_FATAL_IF(!mWritable, "Writing to a read-only frame metrics ring");
+    const uint32_t frameIndex = mHeader->writeCount.load(std::memory_order_relaxed);
+    Slot& slot = mHeader->slots[frameIndex % kCapacity];
+
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.frameIndex = frameIndex;
+    memcpy(slot.frameInfo, frameInfo, sizeof(slot.frameInfo));
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    mHeader->writeCount.store(frameIndex + 1, std::memory_order_release);
+}
+
+bool FrameMetricsRing::read(uint32_t frameIndex, int64_t* outFrameInfo) const {
+    // Unsigned arithmetic keeps this correct when writeCount wraps around.
+    const uint32_t age = writeCount() - frameIndex - 1;
+    if (age >= kCapacity) {
+        return false;
+    }
+
+    const Slot& slot = mHeader->slots[frameIndex % kCapacity];
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        const uint32_t slotFrameIndex = slot.frameIndex;
+        memcpy(outFrameInfo, slot.frameInfo, sizeof(slot.frameInfo));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            return slotFrameIndex == frameIndex;
+        }
+    }
+    return false;
+}
+
+} /* namespace uirenderer */
+} /* namespace android */
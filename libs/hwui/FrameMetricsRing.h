@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "FrameInfo.h"
+#include "utils/Macros.h"
+
+#include <android-base/unique_fd.h>
+
+#include <atomic>
+#include <memory>
+
+namespace android {
+namespace uirenderer {
+
+/**
+ * A ring of the FrameInfo of the last kCapacity frames, in an ashmem region that can be mapped by
+ * other processes. There is a single writer (the CanvasContext that owns the ring) and any number
+ * of readers, none of which ever block each other: each slot is protected by a sequence counter
+ * that is odd while the slot is being written, and readers retry or skip a slot that changed
+ * while they were copying it.
+ *
+ * All counters are 32 bits so that they can be read atomically from a read-only mapping on 32 bit
+ * processes as well.
+ */
+class FrameMetricsRing {
+    PREVENT_COPY_AND_ASSIGN(FrameMetricsRing);
+
+public:
+    static constexpr uint32_t kMagic = 0x464d5247;  // 'FMRG'
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kCapacity = 128;
+    static constexpr uint32_t kFrameInfoSize = static_cast<uint32_t>(FrameInfoIndex::NumIndexes);
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        // The value of Header::writeCount before this frame was written.
+        uint32_t frameIndex;
+        int64_t frameInfo[kFrameInfoSize];
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t frameInfoSize;
+        // The number of frames written so far. The newest frame is writeCount - 1.
+        std::atomic<uint32_t> writeCount;
+        uint32_t reserved;
+        Slot slots[kCapacity];
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    // Creates a new ring, writable by this process. Returns nullptr if the region can't be
+    // allocated.
+    static std::unique_ptr<FrameMetricsRing> create();
+
+    // Maps the ring behind a file descriptor returned by getFd(), for reading only. Returns
+    // nullptr if fd doesn't hold a ring of this version.
+    static std::unique_ptr<FrameMetricsRing> map(int fd);
+
+    ~FrameMetricsRing();
+
+    // Returns a file descriptor that readers can pass to map(). The descriptor can't be used to
+    // map the region writable, and stays owned by the ring.
+    int getFd() const { return mFd.get(); }
+
+    // Appends the FrameInfo of one frame. Must only be called by a single thread at a time.
+    void write(const int64_t* frameInfo);
+
+    uint32_t writeCount() const { return mHeader->writeCount.load(std::memory_order_acquire); }
+
+    // Copies the FrameInfo of frame `frameIndex` into `outFrameInfo`, which must hold
+    // kFrameInfoSize values. Returns false if the frame hasn't been written yet or has already
+    // been overwritten.
+    bool read(uint32_t frameIndex, int64_t* outFrameInfo) const;
+
+private:
+    FrameMetricsRing(base::unique_fd fd, Header* header, bool writable)
+            : mFd(std::move(fd)), mHeader(header), mWritable(writable) {}
+
+    base::unique_fd mFd;
+    Header* const mHeader;
+    const bool mWritable;
+};
+
+} /* namespace uirenderer */
+} /* namespace android */
@@ -29,7 +29,9 @@
 #include <utils/NdkUtils.h>
 #include <utils/Trace.h>
 
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "hwui/Bitmap.h"
 #include "renderthread/EglManager.h"
@@ -52,6 +54,14 @@ struct FormatInfo {
     bool valid = true;
 };
 
+// One bitmap of a batch given to AHBUploader::uploadHardwareBitmaps().
+struct UploadRequest {
+    SkBitmap bitmap;
+    FormatInfo format;
+    UniqueAHardwareBuffer ahb;
+    bool succeeded = false;
+};
+
 class AHBUploader : public RefBase {
 public:
     virtual ~AHBUploader() {}
@@ -67,13 +77,13 @@ public:
         onDestroy();
     }
 
-    bool uploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                              AHardwareBuffer* ahb) {
-        ATRACE_CALL();
+    // Uploads every request in a single trip to the upload thread, and waits for the GPU once
+    // for the whole batch. Sets UploadRequest::succeeded for the requests that were uploaded.
+    void uploadHardwareBitmaps(std::vector<UploadRequest>& requests) {
+        ATRACE_FORMAT("uploadHardwareBitmaps (%zu)", requests.size());
         beginUpload();
-        bool result = onUploadHardwareBitmap(bitmap, format, ahb);
+        onUploadHardwareBitmaps(requests);
         endUpload();
-        return result;
     }
 
     void postIdleTimeoutCheck() {
@@ -88,8 +98,7 @@ private:
     virtual void onIdle() = 0;
     virtual void onDestroy() = 0;
 
-    virtual bool onUploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                                        AHardwareBuffer* ahb) = 0;
+    virtual void onUploadHardwareBitmaps(std::vector<UploadRequest>& requests) = 0;
     virtual void onBeginUpload() = 0;
 
     bool shouldTimeOutLocked() {
@@ -159,43 +168,59 @@ private:
         return mEglManager.eglDisplay();
     }
 
-    bool onUploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                                AHardwareBuffer* ahb) override {
+    void onUploadHardwareBitmaps(std::vector<UploadRequest>& requests) override {
         ATRACE_CALL();
 
         EGLDisplay display = getUploadEglDisplay();
 
         LOG_ALWAYS_FATAL_IF(display == EGL_NO_DISPLAY, "Failed to get EGL_DEFAULT_DISPLAY! err=%s",
                             uirenderer::renderthread::EglManager::eglErrorString());
-        // We use an EGLImage to access the content of the buffer
+        // We use an EGLImage to access the content of each buffer
         // The EGL image is later bound to a 2D texture
-        const EGLClientBuffer clientBuffer = eglGetNativeClientBufferANDROID(ahb);
-        AutoEglImage autoImage(display, clientBuffer);
-        if (autoImage.image == EGL_NO_IMAGE_KHR) {
-            ALOGW("Could not create EGL image, err =%s",
-                  uirenderer::renderthread::EglManager::eglErrorString());
-            return false;
+        std::vector<std::unique_ptr<AutoEglImage>> images;
+        images.reserve(requests.size());
+        for (const UploadRequest& request : requests) {
+            const EGLClientBuffer clientBuffer = eglGetNativeClientBufferANDROID(request.ahb.get());
+            images.push_back(std::make_unique<AutoEglImage>(display, clientBuffer));
+            if (images.back()->image == EGL_NO_IMAGE_KHR) {
+                ALOGW("Could not create EGL image, err =%s",
+                      uirenderer::renderthread::EglManager::eglErrorString());
+            }
         }
 
         {
-            ATRACE_FORMAT("CPU -> gralloc transfer (%dx%d)", bitmap.width(), bitmap.height());
+            ATRACE_FORMAT("CPU -> gralloc transfer (%zu bitmaps)", requests.size());
             EGLSyncKHR fence = mUploadThread->queue().runSync([&]() -> EGLSyncKHR {
-                AutoSkiaGlTexture glTexture;
-                glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, autoImage.image);
-                if (GLUtils::dumpGLErrors()) {
-                    return EGL_NO_SYNC_KHR;
+                bool uploadedAny = false;
+                for (size_t i = 0; i < requests.size(); i++) {
+                    if (images[i]->image == EGL_NO_IMAGE_KHR) {
+                        continue;
+                    }
+                    const SkBitmap& bitmap = requests[i].bitmap;
+                    const FormatInfo& format = requests[i].format;
+                    AutoSkiaGlTexture glTexture;
+                    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, images[i]->image);
+                    if (GLUtils::dumpGLErrors()) {
+                        continue;
+                    }
+
+                    // glTexSubImage2D is synchronous in sense that it memcpy() from pointer that
+                    // we provide.
+                    // But asynchronous in sense that driver may upload texture onto hardware
+                    // buffer when we first use it in drawing
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bitmap.width(), bitmap.height(),
+                                    format.format, format.type, bitmap.getPixels());
+                    if (GLUtils::dumpGLErrors()) {
+                        continue;
+                    }
+                    requests[i].succeeded = true;
+                    uploadedAny = true;
                 }
-
-                // glTexSubImage2D is synchronous in sense that it memcpy() from pointer that we
-                // provide.
-                // But asynchronous in sense that driver may upload texture onto hardware buffer
-                // when we first use it in drawing
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bitmap.width(), bitmap.height(),
-                                format.format, format.type, bitmap.getPixels());
-                if (GLUtils::dumpGLErrors()) {
+                if (!uploadedAny) {
                     return EGL_NO_SYNC_KHR;
                 }
 
+                // A single fence covers all of the uploads above.
                 EGLSyncKHR uploadFence =
                         eglCreateSyncKHR(eglGetCurrentDisplay(), EGL_SYNC_FENCE_KHR, NULL);
                 if (uploadFence == EGL_NO_SYNC_KHR) {
@@ -207,7 +232,10 @@ private:
             });
 
             if (fence == EGL_NO_SYNC_KHR) {
-                return false;
+                for (UploadRequest& request : requests) {
+                    request.succeeded = false;
+                }
+                return;
             }
             EGLint waitStatus = eglClientWaitSyncKHR(display, fence, 0, FENCE_TIMEOUT);
             ALOGE_IF(waitStatus != EGL_CONDITION_SATISFIED_KHR,
@@ -215,7 +243,6 @@ private:
 
             eglDestroySyncKHR(display, fence);
         }
-        return true;
     }
 
     renderthread::EglManager mEglManager;
@@ -234,10 +261,8 @@ private:
 
     void onBeginUpload() override {}
 
-    bool onUploadHardwareBitmap(const SkBitmap& bitmap, const FormatInfo& format,
-                                AHardwareBuffer* ahb) override {
-        bool uploadSucceeded = false;
-        mUploadThread->queue().runSync([this, &uploadSucceeded, bitmap, ahb]() {
+    void onUploadHardwareBitmaps(std::vector<UploadRequest>& requests) override {
+        mUploadThread->queue().runSync([this, &requests]() {
           ATRACE_CALL();
           std::lock_guard _lock{mVkLock};
 
@@ -256,13 +281,14 @@ private:
               this->postIdleTimeoutCheck();
           }
 
-          sk_sp<SkImage> image =
-              SkImage::MakeFromAHardwareBufferWithData(mGrContext.get(), bitmap.pixmap(), ahb);
+          for (UploadRequest& request : requests) {
+              sk_sp<SkImage> image = SkImage::MakeFromAHardwareBufferWithData(
+                      mGrContext.get(), request.bitmap.pixmap(), request.ahb.get());
+              request.succeeded = (image.get() != nullptr);
+          }
+          // Wait for the whole batch at once.
           mGrContext->submit(true);
-
-          uploadSucceeded = (image.get() != nullptr);
         });
-        return uploadSucceeded;
     }
 
     /* must be called on the upload thread after the vkLock has been acquired  */
@@ -407,38 +433,116 @@ static void createUploader(bool usingGL) {
 }
 
 sk_sp<Bitmap> HardwareBitmapUploader::allocateHardwareBitmap(const SkBitmap& sourceBitmap) {
+    return std::move(allocateHardwareBitmaps({sourceBitmap})[0]);
+}
+
+std::vector<sk_sp<Bitmap>> HardwareBitmapUploader::allocateHardwareBitmaps(
+        const std::vector<SkBitmap>& sourceBitmaps) {
     ATRACE_CALL();
 
     bool usingGL = uirenderer::Properties::getRenderPipelineType() ==
             uirenderer::RenderPipelineType::SkiaGL;
 
-    FormatInfo format = determineFormat(sourceBitmap, usingGL);
-    if (!format.valid) {
+    std::vector<sk_sp<Bitmap>> result(sourceBitmaps.size());
+    // Index in sourceBitmaps of each request
+    std::vector<size_t> sourceIndices;
+    std::vector<UploadRequest> requests;
+    requests.reserve(sourceBitmaps.size());
+    for (size_t i = 0; i < sourceBitmaps.size(); i++) {
+        FormatInfo format = determineFormat(sourceBitmaps[i], usingGL);
+        if (!format.valid) {
+            continue;
+        }
+
+        SkBitmap bitmap = makeHwCompatible(format, sourceBitmaps[i]);
+        AHardwareBuffer_Desc desc = {
+                .width = static_cast<uint32_t>(bitmap.width()),
+                .height = static_cast<uint32_t>(bitmap.height()),
+                .layers = 1,
+                .format = format.bufferFormat,
+                .usage = AHARDWAREBUFFER_USAGE_CPU_READ_NEVER |
+                         AHARDWAREBUFFER_USAGE_CPU_WRITE_NEVER |
+                         AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE,
+        };
+        UniqueAHardwareBuffer ahb = allocateAHardwareBuffer(desc);
+        if (!ahb) {
+            ALOGW("allocateHardwareBitmap() failed in AHardwareBuffer_allocate()");
+            continue;
+        };
+        requests.push_back({
+                .bitmap = std::move(bitmap),
+                .format = format,
+                .ahb = std::move(ahb),
+        });
+        sourceIndices.push_back(i);
+    }
+    if (requests.empty()) {
+        return result;
+    }
+
+    createUploader(usingGL);
+    sUploader->uploadHardwareBitmaps(requests);
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        const UploadRequest& request = requests[i];
+        if (request.succeeded) {
+            const SkBitmap& bitmap = request.bitmap;
+            result[sourceIndices[i]] = Bitmap::createFrom(
+                    request.ahb.get(), bitmap.colorType(), bitmap.refColorSpace(),
+                    bitmap.alphaType(), Bitmap::computePalette(bitmap));
+        }
+    }
+    return result;
+}
+
+sk_sp<Bitmap> HardwareBitmapUploader::allocateHardwareBitmap(
+        const SkImageInfo& info, const std::function<bool(const SkPixmap&)>& writePixels) {
+    ATRACE_CALL();
+    SkBitmap bitmap;
+    bitmap.setInfo(info);
+    const bool usingGL = uirenderer::Properties::getRenderPipelineType() ==
+            uirenderer::RenderPipelineType::SkiaGL;
+    FormatInfo format = determineFormat(bitmap, usingGL);
+    if (!format.valid || !format.isSupported) {
+        // The pixels would need converting, which is what the upload path is for.
         return nullptr;
     }
 
-    SkBitmap bitmap = makeHwCompatible(format, sourceBitmap);
     AHardwareBuffer_Desc desc = {
-            .width = static_cast<uint32_t>(bitmap.width()),
-            .height = static_cast<uint32_t>(bitmap.height()),
+            .width = static_cast<uint32_t>(info.width()),
+            .height = static_cast<uint32_t>(info.height()),
             .layers = 1,
             .format = format.bufferFormat,
-            .usage = AHARDWAREBUFFER_USAGE_CPU_READ_NEVER | AHARDWAREBUFFER_USAGE_CPU_WRITE_NEVER |
+            .usage = AHARDWAREBUFFER_USAGE_CPU_READ_RARELY |
+                     AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN |
                      AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE,
     };
     UniqueAHardwareBuffer ahb = allocateAHardwareBuffer(desc);
     if (!ahb) {
         ALOGW("allocateHardwareBitmap() failed in AHardwareBuffer_allocate()");
         return nullptr;
-    };
-
-    createUploader(usingGL);
+    }
 
-    if (!sUploader->uploadHardwareBitmap(bitmap, format, ahb.get())) {
+    // The mapping is read back as well, to compute the palette.
+    void* addr = nullptr;
+    if (AHardwareBuffer_lock(ahb.get(),
+                             AHARDWAREBUFFER_USAGE_CPU_READ_RARELY |
+                                     AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN,
+                             -1, nullptr, &addr) != 0) {
+        ALOGW("allocateHardwareBitmap() failed in AHardwareBuffer_lock()");
+        return nullptr;
+    }
+    AHardwareBuffer_describe(ahb.get(), &desc);
+    const SkPixmap pixmap(info, addr, desc.stride * info.bytesPerPixel());
+    const bool wrote = writePixels(pixmap);
+    const BitmapPalette palette =
+            wrote ? Bitmap::computePalette(info, addr, pixmap.rowBytes()) : BitmapPalette::Unknown;
+    AHardwareBuffer_unlock(ahb.get(), nullptr);
+    if (!wrote) {
         return nullptr;
     }
-    return Bitmap::createFrom(ahb.get(), bitmap.colorType(), bitmap.refColorSpace(),
-                              bitmap.alphaType(), Bitmap::computePalette(bitmap));
+    return Bitmap::createFrom(ahb.get(), info.colorType(), info.refColorSpace(), info.alphaType(),
+                              palette);
 }
 
 void HardwareBitmapUploader::initialize() {
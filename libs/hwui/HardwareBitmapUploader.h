@@ -18,6 +18,9 @@
 
 #include <hwui/Bitmap.h>
 
+#include <functional>
+#include <vector>
+
 namespace android::uirenderer {
 
 class HardwareBitmapUploader {
@@ -27,7 +30,20 @@ public:
 
     static sk_sp<Bitmap> allocateHardwareBitmap(const SkBitmap& sourceBitmap);
 
+    // Like allocateHardwareBitmap(), but uploads all of the bitmaps together, which is much
+    // cheaper than uploading them one at a time. The returned bitmaps are in the same order as
+    // sourceBitmaps, with nullptr for the ones that could not be allocated.
+    static std::vector<sk_sp<Bitmap>> allocateHardwareBitmaps(
+            const std::vector<SkBitmap>& sourceBitmaps);
+
 #ifdef __ANDROID__
+    // Allocates a hardware bitmap of `info` and maps it so that `writePixels` can produce the
+    // pixels in place, e.g. by decoding into it. This skips the intermediate bitmap and the copy
+    // of allocateHardwareBitmap(). Returns nullptr if `info` has no matching buffer format, if
+    // the buffer can't be allocated or mapped, or if `writePixels` returns false.
+    static sk_sp<Bitmap> allocateHardwareBitmap(
+            const SkImageInfo& info, const std::function<bool(const SkPixmap&)>& writePixels);
+
     static bool hasFP16Support();
     static bool has1010102Support();
     static bool hasAlpha8Support();
@@ -95,15 +95,27 @@ float OvershootInterpolator::interpolate(float t) {
     return t * t * ((mTension + 1) * t + mTension) + 1.0f;
 }
 
+PathInterpolator::PathInterpolator(std::vector<float>&& x, std::vector<float>&& y)
+        : mX(std::move(x)), mY(std::move(y)), mBucketStart(kBucketCount + 1) {
+    for (size_t bucket = 0; bucket <= kBucketCount; bucket++) {
+        const float bucketStart = bucket / static_cast<float>(kBucketCount);
+        const auto after = std::upper_bound(mX.begin(), mX.end(), bucketStart);
+        mBucketStart[bucket] = after == mX.begin() ? 0 : after - mX.begin() - 1;
+    }
+}
+
 float PathInterpolator::interpolate(float t) {
     if (t <= 0) {
         return 0;
     } else if (t >= 1) {
         return 1;
     }
-    // Do a binary search for the correct x to interpolate between.
-    size_t startIndex = 0;
-    size_t endIndex = mX.size() - 1;
+    // Do a binary search for the correct x to interpolate between, within the points spanning the
+    // bucket of t. As x is non-decreasing only one pair of points brackets t, so this finds the
+    // same pair as searching all of them.
+    const size_t bucket = static_cast<size_t>(t * kBucketCount);
+    size_t startIndex = mBucketStart[bucket];
+    size_t endIndex = std::min<size_t>(mBucketStart[bucket + 1] + 1, mX.size() - 1);
 
     while (endIndex > startIndex + 1) {
         int midIndex = (startIndex + endIndex) / 2;
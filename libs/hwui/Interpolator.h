@@ -17,6 +17,7 @@
 #define INTERPOLATOR_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <memory>
 
 #include <cutils/compiler.h>
@@ -109,12 +110,20 @@ private:
 
 class PathInterpolator : public Interpolator {
 public:
-    explicit PathInterpolator(std::vector<float>&& x, std::vector<float>&& y) : mX(x), mY(y) {}
+    // x must be non-decreasing, as the Java PathInterpolator guarantees.
+    explicit PathInterpolator(std::vector<float>&& x, std::vector<float>&& y);
     virtual float interpolate(float input) override;
 
 private:
+    // The input range is split into this many equal buckets, each knowing the points it spans,
+    // so that interpolate() only searches the few points of one bucket rather than all of them.
+    // A power of two keeps the bucket bounds exact in float.
+    static constexpr size_t kBucketCount = 256;
+
     std::vector<float> mX;
     std::vector<float> mY;
+    // The index of the last point at or before the start of each bucket, plus one entry for 1.
+    std::vector<uint32_t> mBucketStart;
 };
 
 class LUTInterpolator : public Interpolator {
@@ -303,6 +303,19 @@ void JankTracker::dumpFrames(int fd) {
         dprintf(fd, "%s", FrameInfoNames[i]);
         dprintf(fd, ",");
     }
+    // The counters and functor timings are appended after the regular columns, so that parsers
+    // that only know about those keep working.
+    const bool dumpCounters = Properties::sampleFrameCounters;
+    const bool dumpFunctorTimings = Properties::dumpFunctorTimings;
+    if (dumpCounters) {
+        for (const char* stage : FrameStageNames) {
+            dprintf(fd, "%sCycles,%sInstructions,%sCacheMisses,", stage, stage, stage);
+        }
+    }
+    if (dumpFunctorTimings) {
+        dprintf(fd, "FunctorSyncCount,FunctorSyncDuration,FunctorDrawCount,FunctorDrawDuration,"
+                    "FunctorMaxDrawDuration,");
+    }
     for (size_t i = 0; i < mFrames.size(); i++) {
         FrameInfo& frame = mFrames[i];
         if (frame[FrameInfoIndex::SyncStart] == 0) {
@@ -312,6 +325,19 @@ void JankTracker::dumpFrames(int fd) {
         for (int i = 0; i < static_cast<int>(FrameInfoIndex::NumIndexes); i++) {
             dprintf(fd, "%" PRId64 ",", frame[i]);
         }
+        if (dumpCounters) {
+            for (int i = 0; i < static_cast<int>(FrameStage::NumStages); i++) {
+                const FrameStageCounters& counters = frame.stageCounters(static_cast<FrameStage>(i));
+                dprintf(fd, "%" PRId64 ",%" PRId64 ",%" PRId64 ",", counters.cycles,
+                        counters.instructions, counters.cacheMisses);
+            }
+        }
+        if (dumpFunctorTimings) {
+            const FunctorTimings& functors = frame.functorTimings();
+            dprintf(fd, "%" PRId32 ",%" PRId64 ",%" PRId32 ",%" PRId64 ",%" PRId64 ",",
+                    functors.syncCount, functors.syncDuration, functors.drawCount,
+                    functors.drawDuration, functors.maxDrawDuration);
+        }
     }
     dprintf(fd, "\n---PROFILEDATA---\n\n");
 }
@@ -26,12 +26,18 @@ void LayerUpdateQueue::clear() {
 }
 
 void LayerUpdateQueue::enqueueLayerWithDamage(RenderNode* renderNode, Rect damage) {
+    // Round out first, so that an empty rect still damages the pixel it is in
     damage.roundOut();
-    damage.doIntersect(0, 0, renderNode->getWidth(), renderNode->getHeight());
-    if (!damage.isEmpty()) {
+    enqueueLayerWithDamage(renderNode, DamageRegion(damage.toSkRect()));
+}
+
+void LayerUpdateQueue::enqueueLayerWithDamage(RenderNode* renderNode, DamageRegion damage) {
+    damage.roundOut();
+    if (damage.intersect(SkRect::MakeIWH(renderNode->getWidth(), renderNode->getHeight()))) {
         for (Entry& entry : mEntries) {
             if (CC_UNLIKELY(entry.renderNode == renderNode)) {
-                entry.damage.unionWith(damage);
+                entry.damageRegion.join(damage);
+                entry.damage = entry.damageRegion.getBounds();
                 return;
             }
         }
@@ -18,6 +18,7 @@
 #define ANDROID_HWUI_LAYER_UPDATE_QUEUE_H
 
 #include <utils/StrongPointer.h>
+#include "DamageRegion.h"
 #include "Rect.h"
 #include "RenderNode.h"
 #include "utils/Macros.h"
@@ -35,14 +36,20 @@ class LayerUpdateQueue {
 
 public:
     struct Entry {
-        Entry(RenderNode* renderNode, const Rect& damage)
-                : renderNode(renderNode), damage(damage) {}
+        Entry(RenderNode* renderNode, const DamageRegion& damage)
+                : renderNode(renderNode), damage(damage.getBounds()), damageRegion(damage) {}
         sp<RenderNode> renderNode;
+        // The bounds of damageRegion
         Rect damage;
+        DamageRegion damageRegion;
     };
 
     LayerUpdateQueue() {}
     void enqueueLayerWithDamage(RenderNode* renderNode, Rect dirty);
+    void enqueueLayerWithDamage(RenderNode* renderNode, const SkRect& dirty) {
+        enqueueLayerWithDamage(renderNode, Rect(dirty));
+    }
+    void enqueueLayerWithDamage(RenderNode* renderNode, DamageRegion dirty);
     void clear();
     const std::vector<Entry>& entries() const { return mEntries; }
 
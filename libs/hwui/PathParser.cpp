@@ -19,8 +19,13 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <utils/Log.h>
+#include <iterator>
+#include <list>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace android {
@@ -97,8 +102,58 @@ static void extract(int* outEndPosition, bool* outEndWithNegOrDot, const char* s
     *outEndPosition = currentIndex;
 }
 
-static float parseFloat(PathParser::ParseResult* result, const char* startPtr,
+// The powers of ten that are exactly representable as a float.
+static constexpr float kExactPowersOfTen[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                              1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+/**
+ * Parses the plain decimal numbers ([-]digits[.digits]) that make up nearly all path data without
+ * going through strtof(). If the digits fit in the mantissa of a float and there are at most 10 of
+ * them after the dot, the number is the quotient of two exactly representable floats, and the
+ * division is correctly rounded, just like strtof(). Returns false for anything else, such as
+ * exponents, so that the caller falls back to strtof().
+ */
+static bool parseSimpleFloat(const char* s, size_t length, float* outValue) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && s[i] == '-') {
+        negative = true;
+        i++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fractionDigits = 0;
+    bool seenDot = false;
+    for (; i < length; i++) {
+        const char c = s[i];
+        if (c >= '0' && c <= '9') {
+            if (++digits > 18) {
+                return false;
+            }
+            mantissa = mantissa * 10 + (c - '0');
+            fractionDigits += seenDot;
+        } else if (c == '.' && !seenDot) {
+            seenDot = true;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0 || mantissa > (1u << 24) ||
+        fractionDigits >= static_cast<int>(std::size(kExactPowersOfTen))) {
+        return false;
+    }
+    const float value = static_cast<float>(mantissa) / kExactPowersOfTen[fractionDigits];
+    *outValue = negative ? -value : value;
+    return true;
+}
+
+static float parseFloat(PathParser::ParseResult* result, const char* startPtr, size_t tokenLength,
                         size_t expectedLength) {
+    float simpleValue;
+    if (CC_LIKELY(parseSimpleFloat(startPtr, tokenLength, &simpleValue))) {
+        return simpleValue;
+    }
+
     char* endPtr = NULL;
     float currentValue = strtof(startPtr, &endPtr);
     if ((currentValue == HUGE_VALF || currentValue == -HUGE_VALF) && errno == ERANGE) {
@@ -123,6 +178,7 @@ static float parseFloat(PathParser::ParseResult* result, const char* startPtr,
  */
 static void getFloats(std::vector<float>* outPoints, PathParser::ParseResult* result,
                       const char* pathStr, int start, int end) {
+    outPoints->clear();
     if (pathStr[start] == 'z' || pathStr[start] == 'Z') {
         return;
     }
@@ -137,7 +193,8 @@ static void getFloats(std::vector<float>* outPoints, PathParser::ParseResult* re
         extract(&endPosition, &endWithNegOrDot, pathStr, startPosition, end);
 
         if (startPosition < endPosition) {
-            float currentValue = parseFloat(result, &pathStr[startPosition], end - startPosition);
+            float currentValue = parseFloat(result, &pathStr[startPosition],
+                                            endPosition - startPosition, end - startPosition);
             if (result->failureOccurred) {
                 return;
             }
@@ -212,8 +269,140 @@ void PathParser::validateVerbAndPoints(char verb, size_t points, PathParser::Par
                               std::to_string(points) + " float(s) are found. ";
 }
 
+namespace {
+
+/**
+ * The same path strings are used by many icons, and are parsed again each time one of them is
+ * inflated. Keep the data of the most recently parsed strings, along with the SkPath built from
+ * them if any, in a process-wide LRU cache.
+ */
+class PathDataCache {
+public:
+    // Strings longer than this are rarely shared, and would take up too much of the cache.
+    static constexpr size_t kMaxCachedLength = 4096;
+    static constexpr size_t kMaxEntries = 256;
+
+    // Appends the cached data of pathString to outData. Returns false on a miss.
+    bool getData(std::string_view pathString, PathData* outData) {
+        std::lock_guard lock(mLock);
+        Entry* entry = find(pathString);
+        if (!entry) {
+            return false;
+        }
+        append(entry->data, outData);
+        return true;
+    }
+
+    // Sets outPath to the SkPath of pathString. Returns false on a miss.
+    bool getPath(std::string_view pathString, SkPath* outPath) {
+        std::lock_guard lock(mLock);
+        Entry* entry = find(pathString);
+        if (!entry || !entry->hasPath) {
+            return false;
+        }
+        // SkPath copies share their points until one of them is modified.
+        *outPath = entry->path;
+        return true;
+    }
+
+    void putData(std::string_view pathString, const PathData& data) {
+        if (pathString.size() > kMaxCachedLength) {
+            return;
+        }
+        std::lock_guard lock(mLock);
+        if (!find(pathString)) {
+            insert(pathString, data);
+        }
+    }
+
+    void putPath(std::string_view pathString, const SkPath& path) {
+        if (pathString.size() > kMaxCachedLength) {
+            return;
+        }
+        std::lock_guard lock(mLock);
+        Entry* entry = find(pathString);
+        if (entry) {
+            entry->path = path;
+            entry->hasPath = true;
+        }
+    }
+
+    void clear() {
+        std::lock_guard lock(mLock);
+        mIndex.clear();
+        mEntries.clear();
+    }
+
+private:
+    struct Entry {
+        std::string pathString;
+        PathData data;
+        bool hasPath = false;
+        SkPath path;
+    };
+
+    static void append(const PathData& from, PathData* to) {
+        to->verbs.insert(to->verbs.end(), from.verbs.begin(), from.verbs.end());
+        to->verbSizes.insert(to->verbSizes.end(), from.verbSizes.begin(), from.verbSizes.end());
+        to->points.insert(to->points.end(), from.points.begin(), from.points.end());
+    }
+
+    Entry* find(std::string_view pathString) {
+        auto it = mIndex.find(pathString);
+        if (it == mIndex.end()) {
+            return nullptr;
+        }
+        // Move the entry to the front, as the most recently used.
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        return &*it->second;
+    }
+
+    void insert(std::string_view pathString, const PathData& data) {
+        if (mEntries.size() >= kMaxEntries) {
+            mIndex.erase(mEntries.back().pathString);
+            mEntries.pop_back();
+        }
+        mEntries.push_front({std::string(pathString), data});
+        // The key points into the entry, whose string never moves.
+        mIndex.emplace(mEntries.front().pathString, mEntries.begin());
+    }
+
+    std::mutex mLock;
+    std::list<Entry> mEntries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> mIndex;
+};
+
+PathDataCache& pathDataCache() {
+    static PathDataCache* sCache = new PathDataCache();
+    return *sCache;
+}
+
+}  // namespace
+
+void PathParser::clearCache() {
+    pathDataCache().clear();
+}
+
 void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
                                             const char* pathStr, size_t strLen) {
+    if (pathStr == NULL) {
+        getPathDataFromAsciiStringUncached(data, result, pathStr, strLen);
+        return;
+    }
+    const std::string_view pathString(pathStr, strLen);
+    if (pathDataCache().getData(pathString, data)) {
+        return;
+    }
+    // Only the data of a whole string can be cached, not what it appends to existing data.
+    const bool wasEmpty = data->verbs.empty() && data->points.empty();
+    getPathDataFromAsciiStringUncached(data, result, pathStr, strLen);
+    if (wasEmpty && !result->failureOccurred) {
+        pathDataCache().putData(pathString, *data);
+    }
+}
+
+void PathParser::getPathDataFromAsciiStringUncached(PathData* data, ParseResult* result,
+                                                    const char* pathStr, size_t strLen) {
     if (pathStr == NULL) {
         result->failureOccurred = true;
         result->failureMessage = "Path string cannot be NULL.";
@@ -232,9 +421,9 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
     }
     size_t end = start + 1;
 
+    std::vector<float> points;
     while (end < strLen) {
         end = nextStart(pathStr, strLen, end);
-        std::vector<float> points;
         getFloats(&points, result, pathStr, start, end);
         validateVerbAndPoints(pathStr[start], points.size(), result);
         if (result->failureOccurred) {
@@ -286,6 +475,9 @@ void PathParser::dump(const PathData& data) {
 
 void PathParser::parseAsciiStringForSkPath(SkPath* skPath, ParseResult* result, const char* pathStr,
                                            size_t strLen) {
+    if (pathStr != NULL && pathDataCache().getPath(std::string_view(pathStr, strLen), skPath)) {
+        return;
+    }
     PathData pathData;
     getPathDataFromAsciiString(&pathData, result, pathStr, strLen);
     if (result->failureOccurred) {
@@ -299,7 +491,7 @@ void PathParser::parseAsciiStringForSkPath(SkPath* skPath, ParseResult* result,
         return;
     }
     VectorDrawableUtils::verbsToPath(skPath, pathData);
-    return;
+    pathDataCache().putPath(std::string_view(pathStr, strLen), *skPath);
 }
 
 }  // namespace uirenderer
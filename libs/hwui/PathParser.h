@@ -39,8 +39,21 @@ public:
      */
     static void parseAsciiStringForSkPath(SkPath* outPath, ParseResult* result,
                                           const char* pathStr, size_t strLength);
+    /**
+     * Parse the string literal and append its data to outData. The data of the most recently
+     * parsed strings is cached, so parsing the same string again is cheap.
+     */
     static void getPathDataFromAsciiString(PathData* outData, ParseResult* result,
                                            const char* pathStr, size_t strLength);
+    /**
+     * Same as getPathDataFromAsciiString, but always parses the string. Used by benchmarks.
+     */
+    static void getPathDataFromAsciiStringUncached(PathData* outData, ParseResult* result,
+                                                   const char* pathStr, size_t strLength);
+    /**
+     * Drops every cached path.
+     */
+    static void clearCache();
     static void dump(const PathData& data);
     static void validateVerbAndPoints(char verb, size_t points, ParseResult* result);
 };
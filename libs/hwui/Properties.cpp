@@ -87,6 +87,14 @@ int Properties::targetCpuTimePercentage = 70;
 
 bool Properties::enableWebViewOverlays = true;
 
+bool Properties::sampleFrameCounters = false;
+bool Properties::dumpFunctorTimings = false;
+bool Properties::profileRenderNodes = false;
+
+int Properties::renderAheadDepth = 0;
+
+int Properties::animatedImageDecodeAhead = 0;
+
 StretchEffectBehavior Properties::stretchEffectBehavior = StretchEffectBehavior::ShaderHWUI;
 
 DrawingEnabled Properties::drawingEnabled = DrawingEnabled::NotInitialized;
@@ -144,6 +152,17 @@ bool Properties::load() {
 
     enableWebViewOverlays = base::GetBoolProperty(PROPERTY_WEBVIEW_OVERLAYS_ENABLED, true);
 
+    sampleFrameCounters = base::GetBoolProperty(PROPERTY_SAMPLE_FRAME_COUNTERS, false);
+    dumpFunctorTimings = base::GetBoolProperty(PROPERTY_DUMP_FUNCTOR_TIMINGS, false);
+    profileRenderNodes = base::GetBoolProperty(PROPERTY_PROFILE_RENDER_NODES, false);
+
+    renderAheadDepth = std::clamp(
+            base::GetIntProperty(PROPERTY_RENDER_AHEAD, render_ahead().value_or(0)), 0, 2);
+
+    animatedImageDecodeAhead = 0;
+    getAnimatedImageDecodeAhead();
+
+
     // call isDrawingEnabled to force loading of the property
     isDrawingEnabled();
 
@@ -230,5 +249,17 @@ bool Properties::isDrawingEnabled() {
     return drawingEnabled == DrawingEnabled::On;
 }
 
+bool Properties::isDirectHardwareDecodeEnabled() {
+    return base::GetBoolProperty(PROPERTY_DIRECT_HARDWARE_DECODE, false);
+}
+
+int Properties::getAnimatedImageDecodeAhead() {
+    if (animatedImageDecodeAhead == 0) {
+        animatedImageDecodeAhead =
+                std::clamp(base::GetIntProperty(PROPERTY_ANIMATED_IMAGE_DECODE_AHEAD, 1), 1, 4);
+    }
+    return animatedImageDecodeAhead;
+}
+
 }  // namespace uirenderer
 }  // namespace android
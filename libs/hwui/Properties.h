@@ -187,6 +187,52 @@ enum DebugLevel {
  */
 #define PROPERTY_WEBVIEW_OVERLAYS_ENABLED "debug.hwui.webview_overlays_enabled"
 
+/**
+ * Path of a read-only shader cache, generated for this device's GPU driver, that seeds the cache
+ * of every app. It is only used when its identity matches the app's own cache.
+ */
+#define PROPERTY_SHADER_SEED_CACHE "ro.hwui.shader_seed_cache"
+
+/**
+ * Samples the cycles, instructions and cache misses of the render thread around the stages of
+ * each frame, and adds them to the output of dumpsys gfxinfo framestats. Debug only, as reading
+ * the counters adds a few syscalls to every frame.
+ */
+#define PROPERTY_SAMPLE_FRAME_COUNTERS "debug.hwui.sample_frame_counters"
+
+/**
+ * Adds the time each frame spent in WebView functor callbacks to the output of dumpsys gfxinfo
+ * framestats. The timings are always recorded, this only changes the columns dumped.
+ */
+#define PROPERTY_DUMP_FUNCTOR_TIMINGS "debug.hwui.dump_functor_timings"
+
+/**
+ * Times the playback of every RenderNode's display list on the render thread, aggregated by node
+ * name across frames, and adds the most expensive names to the output of dumpsys gfxinfo. Debug
+ * only, as it reads the clock twice for every node drawn.
+ */
+#define PROPERTY_PROFILE_RENDER_NODES "debug.hwui.profile_render_nodes"
+
+/**
+ * Number of frames (0 to 2) the render thread may queue ahead of the GPU. Each frame of render
+ * ahead adds a buffer to the swap chain. Defaults to ro.hwui.render_ahead.
+ */
+#define PROPERTY_RENDER_AHEAD "debug.hwui.render_ahead"
+
+/**
+ * Number of frames (1 to 4) an AnimatedImageDrawable keeps decoded ahead of the one on screen.
+ * Each frame of depth beyond the first costs the memory of one more decoded frame, in exchange
+ * for absorbing decodes that occasionally take longer than a frame's duration.
+ */
+#define PROPERTY_ANIMATED_IMAGE_DECODE_AHEAD "debug.hwui.animated_image_decode_ahead"
+
+/**
+ * Makes ImageDecoder decode hardware bitmaps straight into a CPU mapped AHardwareBuffer instead
+ * of decoding into a heap bitmap and uploading it. Saves an allocation of the full image and a
+ * copy, but the buffer is linear, which some GPUs sample more slowly than an uploaded texture.
+ */
+#define PROPERTY_DIRECT_HARDWARE_DECODE "debug.hwui.direct_hardware_decode"
+
 /**
  * Property for globally GL drawing state. Can be overridden per process with
  * setDrawingEnabled.
@@ -292,6 +338,22 @@ public:
 
     static bool enableWebViewOverlays;
 
+    static bool sampleFrameCounters;
+
+    static bool dumpFunctorTimings;
+
+    static bool profileRenderNodes;
+
+    static int renderAheadDepth;
+
+    // 0 until loaded. Read through getAnimatedImageDecodeAhead, which loads the property if the
+    // UI thread needs it before load() ran on the RenderThread.
+    static int animatedImageDecodeAhead;
+    static int getAnimatedImageDecodeAhead();
+
+    // Read on every call, since decodes run on any thread and may start before load().
+    static bool isDirectHardwareDecodeEnabled();
+
     static StretchEffectBehavior getStretchEffectBehavior() {
         return stretchEffectBehavior;
     }
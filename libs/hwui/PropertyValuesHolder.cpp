@@ -100,8 +100,7 @@ void FullPathPropertyValuesHolder::setFraction(float fraction) {
 }
 
 void PathDataPropertyValuesHolder::setFraction(float fraction) {
-    mEvaluator->evaluate(&mPathData, mStartValue, mEndValue, fraction);
-    mPath->mutateProperties()->setData(mPathData);
+    mPath->mutateProperties()->interpolateData(mStartValue, mEndValue, fraction);
 }
 
 void RootAlphaPropertyValuesHolder::setFraction(float fraction) {
@@ -143,7 +143,6 @@ public:
 
 private:
     VectorDrawable::Path* mPath;
-    PathData mPathData;
 };
 
 class RootAlphaPropertyValuesHolder : public PropertyValuesHolderImpl<float> {
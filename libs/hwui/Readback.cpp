@@ -19,6 +19,8 @@
 #include <sync/sync.h>
 #include <system/window.h>
 
+#include <memory>
+
 #include <gui/TraceUtils.h>
 #include "DeferredLayerUpdater.h"
 #include "Properties.h"
@@ -26,6 +28,7 @@
 #include "pipeline/skia/LayerDrawable.h"
 #include "renderthread/EglManager.h"
 #include "renderthread/VulkanManager.h"
+#include "thread/CommonPool.h"
 #include "utils/Color.h"
 #include "utils/MathUtils.h"
 #include "utils/NdkUtils.h"
@@ -40,6 +43,147 @@ namespace uirenderer {
 CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRect,
                                      SkBitmap* bitmap) {
     ATRACE_CALL();
+    sk_sp<SkSurface> tmpSurface;
+    bool useLegacy = false;
+    CopyResult result = drawSurfaceInto(window, inSrcRect, bitmap->info(), false /* waitOnGpu */,
+                                        &tmpSurface, &useLegacy);
+    if (useLegacy) {
+        return copySurfaceIntoLegacy(window, inSrcRect, bitmap);
+    }
+    if (result != CopyResult::Success) {
+        return result;
+    }
+
+    if (!tmpSurface->readPixels(*bitmap, 0, 0)) {
+        // if we fail to readback from the GPU directly (e.g. 565) then we attempt to read into
+        // 8888 and then convert that into the destination format before giving up.
+        SkBitmap tmpBitmap;
+        SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
+        if (bitmap->info().colorType() == SkColorType::kN32_SkColorType ||
+            !tmpBitmap.tryAllocPixels(tmpInfo) || !tmpSurface->readPixels(tmpBitmap, 0, 0) ||
+            !tmpBitmap.readPixels(bitmap->info(), bitmap->getPixels(), bitmap->rowBytes(), 0, 0)) {
+            ALOGW("Unable to convert content into the provided bitmap");
+            return CopyResult::UnknownError;
+        }
+    }
+
+    bitmap->notifyPixelsChanged();
+
+    return CopyResult::Success;
+}
+
+namespace {
+
+struct AsyncReadback {
+    SkBitmap bitmap;
+    SkImageInfo readInfo;
+    ReadbackCallback callback;
+};
+
+// Returns a fence that signals once the GPU work submitted so far has completed, or -1 if the
+// driver can't provide one.
+int createGpuCompletionFence(RenderThread& thread) {
+    int fence = -1;
+    if (Properties::getRenderPipelineType() == RenderPipelineType::SkiaGL) {
+        EGLSyncKHR eglFence = EGL_NO_SYNC_KHR;
+        thread.eglManager().createReleaseFence(false /* useFenceSync */, &eglFence, &fence);
+    } else {
+        thread.vulkanManager().createReleaseFence(&fence, thread.getGrContext());
+    }
+    return fence;
+}
+
+void checkAsyncWorkCompletion(RenderThread& thread) {
+    GrDirectContext* grContext = thread.getGrContext();
+    if (grContext) {
+        grContext->checkAsyncWorkCompletion();
+    }
+}
+
+// Called on the RenderThread by Skia once the pixels have been transferred into a staging buffer.
+void onAsyncReadPixels(SkSurface::ReadPixelsContext context,
+                       std::unique_ptr<const SkSurface::AsyncReadResult> result) {
+    std::shared_ptr<AsyncReadback> readback(static_cast<AsyncReadback*>(context));
+    if (!result || result->count() != 1) {
+        ALOGW("Asynchronous readback from the GPU failed");
+        readback->callback(CopyResult::UnknownError);
+        return;
+    }
+    // The staging buffer may be released on any thread, so convert the pixels into the bitmap
+    // off the RenderThread.
+    std::shared_ptr<const SkSurface::AsyncReadResult> pixels(std::move(result));
+    CommonPool::post(
+            [readback, pixels]() {
+                ATRACE_NAME("Readback::copyStagingIntoBitmap");
+                SkPixmap staging(readback->readInfo, pixels->data(0), pixels->rowBytes(0));
+                if (!staging.readPixels(readback->bitmap.pixmap())) {
+                    ALOGW("Unable to convert content into the provided bitmap");
+                    readback->callback(CopyResult::UnknownError);
+                    return;
+                }
+                readback->bitmap.notifyPixelsChanged();
+                readback->callback(CopyResult::Success);
+            },
+            CommonPool::Priority::Background);
+}
+
+}  // namespace
+
+void Readback::copySurfaceIntoAsync(ANativeWindow* window, const Rect& inSrcRect,
+                                    const SkBitmap& bitmap, ReadbackCallback&& callback) {
+    ATRACE_CALL();
+    sk_sp<SkSurface> tmpSurface;
+    bool useLegacy = false;
+    CopyResult result = drawSurfaceInto(window, inSrcRect, bitmap.info(), true /* waitOnGpu */,
+                                        &tmpSurface, &useLegacy);
+    if (useLegacy) {
+        SkBitmap dst = bitmap;
+        callback(copySurfaceIntoLegacy(window, inSrcRect, &dst));
+        return;
+    }
+    if (result != CopyResult::Success) {
+        callback(result);
+        return;
+    }
+
+    auto readback = std::make_unique<AsyncReadback>();
+    readback->bitmap = bitmap;
+    readback->readInfo = tmpSurface->imageInfo();
+    readback->callback = std::move(callback);
+    // The read is queued behind the draw above; Skia copies the pixels into a transfer buffer on
+    // the GPU and calls onAsyncReadPixels once that copy is done, so nothing here waits on the GPU.
+    tmpSurface->asyncRescaleAndReadPixels(readback->readInfo,
+                                          SkIRect::MakeWH(tmpSurface->width(),
+                                                          tmpSurface->height()),
+                                          SkSurface::RescaleGamma::kSrc,
+                                          SkSurface::RescaleMode::kNearest, onAsyncReadPixels,
+                                          readback.release());
+    GrDirectContext* grContext = mRenderThread.getGrContext();
+    grContext->flushAndSubmit();
+
+    base::unique_fd fence(createGpuCompletionFence(mRenderThread));
+    if (fence.get() == -1) {
+        // Without a fence to wait on elsewhere, fall back to waiting for the GPU here.
+        grContext->submit(true /* syncCpu */);
+        grContext->checkAsyncWorkCompletion();
+        return;
+    }
+    RenderThread* thread = &mRenderThread;
+    CommonPool::post(
+            [thread, fence = std::make_shared<base::unique_fd>(std::move(fence))]() {
+                // Don't hold a pool thread forever on a stuck GPU. Skia also checks for
+                // completed async work on later submits, so the callback still runs then.
+                if (sync_wait(fence->get(), 500 /* ms */) != NO_ERROR) {
+                    ALOGW("Timeout (500ms) exceeded waiting for the asynchronous readback");
+                }
+                thread->queue().post([thread]() { checkAsyncWorkCompletion(*thread); });
+            },
+            CommonPool::Priority::Background);
+}
+
+CopyResult Readback::drawSurfaceInto(ANativeWindow* window, const Rect& inSrcRect,
+                                     const SkImageInfo& dstInfo, bool waitOnGpu,
+                                     sk_sp<SkSurface>* outSurface, bool* outUseLegacy) {
     // Setup the source
     AHardwareBuffer* rawSourceBuffer;
     int rawSourceFence;
@@ -51,7 +195,8 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRec
     // Really this shouldn't ever happen, but better safe than sorry.
     if (err == UNKNOWN_TRANSACTION) {
         ALOGW("Readback failed to ANativeWindow_getLastQueuedBuffer2 - who are we talking to?");
-        return copySurfaceIntoLegacy(window, inSrcRect, bitmap);
+        *outUseLegacy = true;
+        return CopyResult::UnknownError;
     }
     ALOGV("Using new path, cropRect=" RECT_STRING ", transform=%x", ARECT_ARGS(cropRect),
           windowTransform);
@@ -72,7 +217,8 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRec
         return CopyResult::SourceInvalid;
     }
 
-    if (sourceFence != -1 && sync_wait(sourceFence.get(), 500 /* ms */) != NO_ERROR) {
+    if (!waitOnGpu && sourceFence != -1 &&
+        sync_wait(sourceFence.get(), 500 /* ms */) != NO_ERROR) {
         ALOGE("Timeout (500ms) exceeded waiting for buffer fence, abandoning readback attempt");
         return CopyResult::Timeout;
     }
@@ -87,6 +233,17 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRec
     }
 
     sk_sp<GrDirectContext> grContext = mRenderThread.requireGrContext();
+    if (waitOnGpu && sourceFence != -1) {
+        // Make the GPU wait for the producer rather than blocking the RenderThread.
+        status_t waitErr =
+                Properties::getRenderPipelineType() == RenderPipelineType::SkiaGL
+                        ? mRenderThread.eglManager().fenceWait(sourceFence.get())
+                        : mRenderThread.vulkanManager().fenceWait(sourceFence.get(),
+                                                                  grContext.get());
+        if (waitErr != OK) {
+            return CopyResult::UnknownError;
+        }
+    }
 
     SkRect srcRect = inSrcRect.toSkRect();
 
@@ -117,12 +274,12 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRec
 
     sk_sp<SkSurface> tmpSurface =
             SkSurface::MakeRenderTarget(mRenderThread.getGrContext(), SkBudgeted::kYes,
-                                        bitmap->info(), 0, kTopLeft_GrSurfaceOrigin, nullptr);
+                                        dstInfo, 0, kTopLeft_GrSurfaceOrigin, nullptr);
 
     // if we can't generate a GPU surface that matches the destination bitmap (e.g. 565) then we
     // attempt to do the intermediate rendering step in 8888
     if (!tmpSurface.get()) {
-        SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
+        SkImageInfo tmpInfo = dstInfo.makeColorType(SkColorType::kN32_SkColorType);
         tmpSurface = SkSurface::MakeRenderTarget(mRenderThread.getGrContext(), SkBudgeted::kYes,
                                                  tmpInfo, 0, kTopLeft_GrSurfaceOrigin, nullptr);
         if (!tmpSurface.get()) {
@@ -169,11 +326,11 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRec
 
     SkSamplingOptions sampling(SkFilterMode::kNearest);
     ALOGV("Mapping from " RECT_STRING " to " RECT_STRING, SK_RECT_ARGS(srcRect),
-          SK_RECT_ARGS(SkRect::MakeWH(bitmap->width(), bitmap->height())));
+          SK_RECT_ARGS(SkRect::MakeWH(dstInfo.width(), dstInfo.height())));
     m.postConcat(SkMatrix::MakeRectToRect(srcRect,
-                                          SkRect::MakeWH(bitmap->width(), bitmap->height()),
+                                          SkRect::MakeWH(dstInfo.width(), dstInfo.height()),
                                           SkMatrix::kFill_ScaleToFit));
-    if (srcRect.width() != bitmap->width() || srcRect.height() != bitmap->height()) {
+    if (srcRect.width() != dstInfo.width() || srcRect.height() != dstInfo.height()) {
         sampling = SkSamplingOptions(SkFilterMode::kLinear);
     }
 
@@ -189,21 +346,7 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& inSrcRec
     canvas->drawImageRect(image, imageSrcRect, imageDstRect, sampling, &paint, constraint);
     canvas->restore();
 
-    if (!tmpSurface->readPixels(*bitmap, 0, 0)) {
-        // if we fail to readback from the GPU directly (e.g. 565) then we attempt to read into
-        // 8888 and then convert that into the destination format before giving up.
-        SkBitmap tmpBitmap;
-        SkImageInfo tmpInfo = bitmap->info().makeColorType(SkColorType::kN32_SkColorType);
-        if (bitmap->info().colorType() == SkColorType::kN32_SkColorType ||
-            !tmpBitmap.tryAllocPixels(tmpInfo) || !tmpSurface->readPixels(tmpBitmap, 0, 0) ||
-            !tmpBitmap.readPixels(bitmap->info(), bitmap->getPixels(), bitmap->rowBytes(), 0, 0)) {
-            ALOGW("Unable to convert content into the provided bitmap");
-            return CopyResult::UnknownError;
-        }
-    }
-
-    bitmap->notifyPixelsChanged();
-
+    *outSurface = std::move(tmpSurface);
     return CopyResult::Success;
 }
 
@@ -21,6 +21,9 @@
 #include "renderthread/RenderThread.h"
 
 #include <SkBitmap.h>
+#include <SkSurface.h>
+
+#include <functional>
 
 namespace android {
 class Bitmap;
@@ -41,6 +44,8 @@ enum class CopyResult {
     DestinationInvalid = 5,
 };
 
+using ReadbackCallback = std::function<void(CopyResult)>;
+
 class Readback {
 public:
     explicit Readback(renderthread::RenderThread& thread) : mRenderThread(thread) {}
@@ -49,6 +54,15 @@ public:
      */
     CopyResult copySurfaceInto(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap);
 
+    /**
+     * Like copySurfaceInto, but without blocking the RenderThread on the GPU. The copy goes
+     * through a GPU staging buffer and the conversion into the bitmap happens on a CommonPool
+     * thread, which then invokes the callback. The bitmap's pixels must stay alive until then.
+     * The callback may also be invoked synchronously if the copy fails early.
+     */
+    void copySurfaceIntoAsync(ANativeWindow* window, const Rect& srcRect, const SkBitmap& bitmap,
+                              ReadbackCallback&& callback);
+
     CopyResult copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap);
     CopyResult copyImageInto(const sk_sp<SkImage>& image, SkBitmap* bitmap);
 
@@ -56,6 +70,11 @@ public:
 
 private:
     CopyResult copySurfaceIntoLegacy(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap);
+    // Draws the surface's most recently queued buffer into a GPU surface of dstInfo's size. Sets
+    // outUseLegacy if the producer doesn't support the query and the legacy path must be used.
+    CopyResult drawSurfaceInto(ANativeWindow* window, const Rect& srcRect,
+                               const SkImageInfo& dstInfo, bool waitOnGpu,
+                               sk_sp<SkSurface>* outSurface, bool* outUseLegacy);
     CopyResult copyImageInto(const sk_sp<SkImage>& image, const Rect& srcRect, SkBitmap* bitmap);
 
     bool copyLayerInto(Layer* layer, const SkRect* srcRect, const SkRect* dstRect,
@@ -20,6 +20,7 @@
 #include <GrRecordingContext.h>
 
 #include <experimental/type_traits>
+#include <string.h>
 
 #include "SkAndroidFrameworkUtils.h"
 #include "SkCanvas.h"
@@ -78,6 +79,12 @@ enum class Type : uint8_t {
 };
 #undef X
 
+#define X(T) +1
+static_assert(0
+#include "DisplayListOps.in"
+              <= 64, "DisplayListData::fOpTypes needs a bit per Type");
+#undef X
+
 struct Op {
     uint32_t type : 8;
     uint32_t skip : 24;
@@ -603,9 +610,12 @@ void* DisplayListData::push(size_t pod, Args&&... args) {
     SkASSERT(fUsed + skip <= fReserved);
     auto op = (T*)(fBytes.get() + fUsed);
     fUsed += skip;
+    // Zero padding so that re-recording the same ops gives the same bytes, see hasSameOps().
+    memset(op, 0, skip);
     new (op) T{std::forward<Args>(args)...};
     op->type = (uint32_t)T::kType;
     op->skip = skip;
+    fOpTypes |= uint64_t(1) << (uint32_t)T::kType;
     return op + 1;
 }
 
@@ -819,6 +829,20 @@ void DisplayListData::reset() {
 
     // Leave fBytes and fReserved alone.
     fUsed = 0;
+    fOpTypes = 0;
+}
+
+bool DisplayListData::hasSameOps(const DisplayListData& other) const {
+    constexpr uint64_t kExternalContentOps = (uint64_t(1) << (uint32_t)Type::DrawDrawable) |
+                                             (uint64_t(1) << (uint32_t)Type::DrawVectorDrawable) |
+                                             (uint64_t(1) << (uint32_t)Type::DrawRippleDrawable) |
+                                             (uint64_t(1) << (uint32_t)Type::DrawWebView);
+    if (fUsed != other.fUsed || fOpTypes != other.fOpTypes || (fOpTypes & kExternalContentOps)) {
+        return false;
+    }
+    // Refcounted arguments are compared by pointer, which is conservative: the old list still
+    // holds its references, so an equal pointer is the same immutable object.
+    return fUsed == 0 || memcmp(fBytes.get(), other.fBytes.get(), fUsed) == 0;
 }
 
 template <class T>
@@ -77,6 +77,12 @@ public:
     size_t usedSize() const { return fUsed; }
     size_t allocatedSize() const { return fReserved; }
 
+    // Returns true if this holds exactly the same ops as other, byte for byte. Ops that draw
+    // content owned outside of the display list (drawables, vector drawables, ripples, WebViews)
+    // can change without their recorded bytes changing, so lists containing them never compare
+    // equal.
+    bool hasSameOps(const DisplayListData& other) const;
+
 private:
     friend class RecordingCanvas;
 
@@ -143,6 +149,8 @@ private:
     SkAutoTMalloc<uint8_t> fBytes;
     size_t fUsed = 0;
     size_t fReserved = 0;
+    // One bit per op Type that has been pushed since the last reset().
+    uint64_t fOpTypes = 0;
 
     bool mHasText : 1;
 };
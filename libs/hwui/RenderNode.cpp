@@ -38,6 +38,7 @@
 #include <sstream>
 #include <string>
 #include <ui/FatVector.h>
+#include <unordered_set>
 
 namespace android {
 namespace uirenderer {
@@ -192,7 +193,7 @@ void RenderNode::pushLayerUpdate(TreeInfo& info) {
         return;
     }
 
-    SkRect dirty;
+    DamageRegion dirty;
     info.damageAccumulator->peekAtDirty(&dirty);
     info.layerUpdateQueue->enqueueLayerWithDamage(this, dirty);
     if (!dirty.isEmpty()) {
@@ -213,6 +214,14 @@ void RenderNode::pushLayerUpdate(TreeInfo& info) {
  *
  * While traversing down the tree, functorsNeedLayer flag is set to true if anything that uses the
  * stencil buffer may be needed. Views that use a functor to draw will be forced onto a layer.
+ *
+ * The traversal has to stay serial. Sibling subtrees aren't independent of each other:
+ * - A node may appear more than once in the tree (see mDamageGenerationId).
+ * - Projected children depend on the order siblings are visited in.
+ * - Syncing display lists changes parent counts and hands removals to the TreeObserver.
+ * - Animators, position listeners and layer updates call back into the CanvasContext and the
+ *   LayerUpdateQueue, none of which are thread safe.
+ * - Damage is folded into the parent's frame of the DamageAccumulator as each child is popped.
  */
 void RenderNode::prepareTreeImpl(TreeObserver& observer, TreeInfo& info, bool functorsNeedLayer) {
     if (mDamageGenerationId == info.damageGenerationId) {
@@ -311,6 +320,7 @@ void RenderNode::pushStagingPropertiesChanges(TreeInfo& info) {
         const StretchEffect& stagingStretch = layerProperties.getStretchEffect();
         if (stagingStretch.isEmpty()) {
             mStretchMask.clear();
+            mStretchShaderCache.clear();
         }
 
         if (layerProperties.getImageFilter() == nullptr) {
@@ -429,6 +439,13 @@ void RenderNode::handleForceDark(android::uirenderer::TreeInfo *info) {
 void RenderNode::pushStagingDisplayListChanges(TreeObserver& observer, TreeInfo& info) {
     if (mNeedsDisplayListSync) {
         mNeedsDisplayListSync = false;
+        // A re-record that produced the same ops draws the same pixels, so there is nothing to
+        // damage. Force dark transforms the new list after the sync, which the old list has
+        // already been through, so the lists are only comparable when it is disabled.
+        if (info.disableForceDark && mDisplayList.hasSameContent(mStagingDisplayList)) {
+            syncDisplayList(observer, &info);
+            return;
+        }
         // Damage with the old display list first then the new one to catch any
         // changes in isRenderable or, in the future, bounds
         damageSelf(info);
@@ -455,6 +472,26 @@ void RenderNode::destroyHardwareResources(TreeInfo* info) {
     deleteDisplayList(observer, info);
 }
 
+// Every RenderNode with a layer surface. Only touched on the RenderThread.
+static std::unordered_set<const RenderNode*>& nodesWithLayers() {
+    static std::unordered_set<const RenderNode*> nodes;
+    return nodes;
+}
+
+void RenderNode::registerLayer() {
+    nodesWithLayers().insert(this);
+}
+
+void RenderNode::unregisterLayer() {
+    nodesWithLayers().erase(this);
+}
+
+void RenderNode::forEachNodeWithLayer(const std::function<void(const RenderNode&)>& func) {
+    for (const RenderNode* node : nodesWithLayers()) {
+        func(*node);
+    }
+}
+
 void RenderNode::destroyLayers() {
     if (hasLayer()) {
         this->setLayerSurface(nullptr);
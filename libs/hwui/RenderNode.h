@@ -39,6 +39,7 @@
 #include "pipeline/skia/SkiaDisplayList.h"
 #include "pipeline/skia/SkiaLayer.h"
 
+#include <functional>
 #include <vector>
 #include <pipeline/skia/StretchMask.h>
 
@@ -130,6 +131,9 @@ public:
 
     StretchMask& getStretchMask() { return mStretchMask; }
 
+    // The shader stretching the contents of this node's layer.
+    StretchShaderCache& getStretchShaderCache() { return mStretchShaderCache; }
+
     VirtualLightRefBase* getUserContext() const { return mUserContext.get(); }
 
     void setUserContext(VirtualLightRefBase* context) { mUserContext = context; }
@@ -239,6 +243,8 @@ private:
     void pushStagingDisplayListChanges(TreeObserver& observer, TreeInfo& info);
     void prepareLayer(TreeInfo& info, uint32_t dirtyMask);
     void pushLayerUpdate(TreeInfo& info);
+    void registerLayer();
+    void unregisterLayer();
     void deleteDisplayList(TreeObserver& observer, TreeInfo* info = nullptr);
     void damageSelf(TreeInfo& info);
 
@@ -290,6 +296,7 @@ private:
 
     bool mHasHolePunches;
     StretchMask mStretchMask;
+    StretchShaderCache mStretchShaderCache;
 
     // METHODS & FIELDS ONLY USED BY THE SKIA RENDERER
 public:
@@ -324,15 +331,18 @@ public:
         if (layer.get()) {
             if (!mSkiaLayer.get()) {
                 mSkiaLayer = std::make_unique<skiapipeline::SkiaLayer>();
+                registerLayer();
             }
             mSkiaLayer->layerSurface = std::move(layer);
             mSkiaLayer->inverseTransformInWindow.loadIdentity();
-        } else {
+        } else if (mSkiaLayer.get()) {
+            unregisterLayer();
             mSkiaLayer.reset();
         }
 
         mProperties.mutateLayerProperties().mutableStretchEffect().clear();
         mStretchMask.clear();
+        mStretchShaderCache.clear();
         // Clear out the previous snapshot and the image filter the previous
         // snapshot was created with whenever the layer changes.
         mSnapshotResult.snapshot = nullptr;
@@ -364,6 +374,13 @@ public:
 
     skiapipeline::SkiaLayer* getSkiaLayer() const { return mSkiaLayer.get(); }
 
+    /**
+     * Calls func with every RenderNode that currently has a layer surface, so that the GPU memory
+     * of layers can be attributed to the views that own them. Layers are only attached and
+     * detached on the RenderThread, so this must only be called there too.
+     */
+    static void forEachNodeWithLayer(const std::function<void(const RenderNode&)>& func);
+
     /**
      * Returns the path that represents the outline of RenderNode intersected with
      * the provided rect.  This call will internally cache the resulting path in
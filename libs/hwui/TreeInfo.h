@@ -23,6 +23,7 @@
 #include "SkSize.h"
 
 #include <string>
+#include <vector>
 
 namespace android {
 namespace uirenderer {
@@ -31,6 +32,10 @@ namespace renderthread {
 class CanvasContext;
 }
 
+namespace VectorDrawable {
+class Tree;
+}
+
 class DamageAccumulator;
 class LayerUpdateQueue;
 class RenderNode;
@@ -90,6 +95,9 @@ public:
     int64_t damageGenerationId = 0;
 
     LayerUpdateQueue* layerUpdateQueue = nullptr;
+    // Visible VectorDrawables whose cache is dirty and will be redrawn this frame. May be null,
+    // in which case their caches are redrawn on demand while drawing.
+    std::vector<VectorDrawable::Tree*>* dirtyVectorDrawables = nullptr;
     ErrorHandler* errorHandler = nullptr;
 
     bool updateWindowPositions = false;
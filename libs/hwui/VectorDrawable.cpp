@@ -52,6 +52,30 @@ Path::Path(const char* pathStr, size_t strLength) {
     mStagingProperties.setData(data);
 }
 
+void Path::PathProperties::interpolateData(const Data& from, const Data& to, float fraction) {
+    bool changed = false;
+    if (mData.verbs != from.verbs || mData.verbSizes != from.verbSizes) {
+        mData.verbs = from.verbs;
+        mData.verbSizes = from.verbSizes;
+        changed = true;
+    }
+    if (mData.points.size() != from.points.size()) {
+        mData.points.resize(from.points.size());
+        changed = true;
+    }
+    // Same as VectorDrawableUtils::interpolatePaths(), so that both give the same points.
+    for (size_t i = 0; i < from.points.size(); i++) {
+        const float point = from.points[i] * (1 - fraction) + to.points[i] * fraction;
+        if (point != mData.points[i]) {
+            mData.points[i] = point;
+            changed = true;
+        }
+    }
+    if (changed) {
+        onPropertyChanged();
+    }
+}
+
 Path::Path(const Path& path) : Node(path) {
     mStagingProperties.syncProperties(path.mStagingProperties);
 }
@@ -156,6 +156,9 @@ public:
             mData = data;
             onPropertyChanged();
         }
+        // Morphs the path data between from and to in place. Path morphing animations do this
+        // every frame, and this spares them the full copy and comparison setData() would take.
+        void interpolateData(const Data& from, const Data& to, float fraction);
         const Data& getData() const { return mData; }
 
     private:
@@ -23,6 +23,8 @@
 
 #include <log/log.h>
 #include <utils/Trace.h>
+#include <utils/Timers.h>
+#include <algorithm>
 #include <atomic>
 
 namespace android::uirenderer {
@@ -54,8 +56,25 @@ private:
 };
 
 WebViewFunctor* ScopedCurrentFunctor::sCurrentFunctor = nullptr;
+
+void recordSync(nsecs_t duration) {
+    if (FunctorTimings* timings = ScopedFunctorTimings::current()) {
+        timings->syncCount++;
+        timings->syncDuration += duration;
+    }
+}
+
+void recordDraw(nsecs_t duration) {
+    if (FunctorTimings* timings = ScopedFunctorTimings::current()) {
+        timings->drawCount++;
+        timings->drawDuration += duration;
+        timings->maxDrawDuration = std::max(timings->maxDrawDuration, duration);
+    }
+}
 }  // namespace
 
+FunctorTimings* ScopedFunctorTimings::sCurrent = nullptr;
+
 RenderMode WebViewFunctor_queryPlatformRenderMode() {
     auto pipelineType = Properties::getRenderPipelineType();
     switch (pipelineType) {
@@ -108,7 +127,9 @@ WebViewFunctor::~WebViewFunctor() {
 
 void WebViewFunctor::sync(const WebViewSyncData& syncData) const {
     ATRACE_NAME("WebViewFunctor::sync");
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
     mCallbacks.onSync(mFunctor, mData, syncData);
+    recordSync(systemTime(SYSTEM_TIME_MONOTONIC) - start);
 }
 
 void WebViewFunctor::onRemovedFromTree() {
@@ -153,7 +174,9 @@ void WebViewFunctor::drawGl(const DrawGlInfo& drawInfo) {
         overlayParams.overlaysMode = OverlaysMode::Enabled;
     }
 
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
     mCallbacks.gles.draw(mFunctor, mData, drawInfo, overlayParams);
+    recordDraw(systemTime(SYSTEM_TIME_MONOTONIC) - start);
 }
 
 void WebViewFunctor::initVk(const VkFunctorInitParams& params) {
@@ -180,7 +203,9 @@ void WebViewFunctor::drawVk(const VkFunctorDrawParams& params) {
         overlayParams.overlaysMode = OverlaysMode::Enabled;
     }
 
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
     mCallbacks.vk.draw(mFunctor, mData, params, overlayParams);
+    recordDraw(systemTime(SYSTEM_TIME_MONOTONIC) - start);
 }
 
 void WebViewFunctor::postDrawVk() {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <private/hwui/WebViewFunctor.h>
+#include "FrameInfo.h"
 #ifdef __ANDROID__ // Layoutlib does not support render thread
 #include <renderthread/RenderProxy.h>
 #endif
@@ -31,6 +32,25 @@ namespace android::uirenderer {
 
 class WebViewFunctorManager;
 
+/**
+ * Adds the time spent in WebView functor callbacks during its lifetime to a frame's
+ * FunctorTimings. RenderThread only.
+ */
+class ScopedFunctorTimings {
+public:
+    explicit ScopedFunctorTimings(FunctorTimings& timings) : mPrevious(sCurrent) {
+        sCurrent = &timings;
+    }
+    ~ScopedFunctorTimings() { sCurrent = mPrevious; }
+
+    // Returns nullptr outside of any scope, e.g. for a layer update outside of a frame.
+    static FunctorTimings* current() { return sCurrent; }
+
+private:
+    static FunctorTimings* sCurrent;
+    FunctorTimings* const mPrevious;
+};
+
 class WebViewFunctor {
 public:
     WebViewFunctor(void* data, const WebViewFunctorCallbacks& callbacks, RenderMode functorMode);
@@ -70,6 +70,10 @@ void CanvasStateHelper::internalClipRect(const SkRect& rect, SkClipOp op) {
     clip().apply(op, transform(), rect, /*aa=*/false, /*fillsBounds=*/true);
 }
 
+void CanvasStateHelper::internalClipRRect(const SkRRect& rrect, SkClipOp op, bool aa) {
+    clip().apply(op, transform(), rrect.getBounds(), aa, /*fillsBounds=*/rrect.isRect());
+}
+
 void CanvasStateHelper::internalClipPath(const SkPath& path, SkClipOp op) {
     SkRect bounds = path.getBounds();
     if (path.isInverseFillType()) {
@@ -79,6 +83,18 @@ void CanvasStateHelper::internalClipPath(const SkPath& path, SkClipOp op) {
     clip().apply(op, transform(), bounds, /*aa=*/true, /*fillsBounds=*/false);
 }
 
+void CanvasStateHelper::internalClipRegion(const SkRegion& region, SkClipOp op) {
+    // Regions are in device space, so they are not affected by the current transform.
+    clip().apply(op, SkMatrix::I(), SkRect::Make(region.getBounds()), /*aa=*/false,
+                 /*fillsBounds=*/region.isRect());
+}
+
+void CanvasStateHelper::internalResetClip() {
+    ConservativeClip& current = clip();
+    current = ConservativeClip{};
+    current.bounds = mInitialBounds;
+}
+
 CanvasStateHelper::ConservativeClip& CanvasStateHelper::clip() {
     return writableEntry(&mClipStack);
 }
@@ -89,7 +89,10 @@ protected:
     bool internalRestore();
 
     void internalClipRect(const SkRect& rect, SkClipOp op);
+    void internalClipRRect(const SkRRect& rrect, SkClipOp op, bool aa);
     void internalClipPath(const SkPath& path, SkClipOp op);
+    void internalClipRegion(const SkRegion& region, SkClipOp op);
+    void internalResetClip();
 
     // The canvas' clip will never expand beyond these bounds since intersect
     // and difference operations only subtract pixels.
@@ -220,11 +223,20 @@ public:
             internalSave(saveEntryForLayer());
         }
         if constexpr (T == CanvasOpType::ClipRect) {
-            internalClipRect(op.rect, op.op);
+            internalClipRect(op.rect, op.clipOp);
+        }
+        if constexpr (T == CanvasOpType::ClipRRect) {
+            internalClipRRect(op.rrect, op.op, op.aa);
         }
         if constexpr (T == CanvasOpType::ClipPath) {
             internalClipPath(op.path, op.op);
         }
+        if constexpr (T == CanvasOpType::ClipRegion) {
+            internalClipRegion(op.region, op.op);
+        }
+        if constexpr (T == CanvasOpType::ResetClip) {
+            internalResetClip();
+        }
 
         submit(std::move(op));
     }
@@ -17,6 +17,14 @@
 #include "CanvasOpBuffer.h"
 
 #include "CanvasOps.h"
+#include "DamageAccumulator.h"
+#include "Matrix.h"
+#include "RenderNode.h"
+
+#include <experimental/type_traits>
+#include <iterator>
+#include <ostream>
+#include <string>
 
 namespace android::uirenderer {
 
@@ -31,27 +39,142 @@ void CanvasOpBuffer::updateChildren(std::function<void(RenderNode*)> updateFn) {
     }
 }
 
+// Indexed by CanvasOpType, so these must stay in the order of the enum.
+static constexpr const char* kCanvasOpNames[] = {
+        "Save",
+        "SaveLayer",
+        "SaveBehind",
+        "Restore",
+        "BeginZ",
+        "EndZ",
+        "ClipRect",
+        "ClipRRect",
+        "ClipPath",
+        "ClipRegion",
+        "ResetClip",
+        "DrawColor",
+        "DrawRect",
+        "DrawRegion",
+        "DrawRoundRect",
+        "DrawRoundRectProperty",
+        "DrawDoubleRoundRect",
+        "DrawCircleProperty",
+        "DrawRippleDrawable",
+        "DrawCircle",
+        "DrawOval",
+        "DrawArc",
+        "DrawPaint",
+        "DrawPoint",
+        "DrawPoints",
+        "DrawPath",
+        "DrawLine",
+        "DrawLines",
+        "DrawVertices",
+        "DrawImage",
+        "DrawImageRect",
+        "DrawImageLattice",
+        "DrawPicture",
+        "DrawBehind",
+        "DrawTextBlob",
+        "DrawPatch",
+        "DrawAtlas",
+        "DrawShadowRec",
+        "DrawAnnotation",
+        "DrawDrawable",
+        "DrawVectorDrawable",
+        "DrawLayer",
+        "DrawRenderNode",
+};
+static_assert(std::size(kCanvasOpNames) == static_cast<size_t>(CanvasOpType::COUNT));
+
 void CanvasOpBuffer::output(std::ostream& output, uint32_t level) const {
-    LOG_ALWAYS_FATAL("TODO");
+    for_each([&]<CanvasOpType T>(const CanvasOpContainer<T>* op) {
+        output << std::string(level * 2, ' ') << kCanvasOpNames[static_cast<size_t>(T)];
+        if constexpr (T == CanvasOpType::DrawRenderNode) {
+            // Like DumpOpsCanvas, children are listed inline, below the op that draws them.
+            op->op().renderNode->output(output, level + 1);
+        } else {
+            output << std::endl;
+        }
+    });
 }
 
 bool CanvasOpBuffer::prepareListAndChildren(
             TreeObserver& observer, TreeInfo& info, bool functorsNeedLayer,
             std::function<void(RenderNode*, TreeObserver&, TreeInfo&, bool)> childFn) {
-    LOG_ALWAYS_FATAL("TODO");
-    return false;
+    if (mHas.children) {
+        for (auto& iter : filter<CanvasOpType::DrawRenderNode>()) {
+            Matrix4 mat4(iter.transform());
+            info.damageAccumulator->pushTransform(&mat4);
+            childFn(iter->renderNode.get(), observer, info, functorsNeedLayer);
+            info.damageAccumulator->popTransform();
+        }
+    }
+
+    bool isDirty = false;
+    if (mHas.vectorDrawable) {
+        for (auto& iter : filter<CanvasOpType::DrawVectorDrawable>()) {
+            // If any vector drawable in the display list needs update, damage the node.
+            if (iter->root->isDirty()) {
+                isDirty = true;
+                iter->root->setPropertyChangeWillBeConsumed(true);
+            }
+        }
+    }
+    return isDirty;
 }
 
 void CanvasOpBuffer::syncContents(const WebViewSyncData& data) {
-    LOG_ALWAYS_FATAL("TODO");
+    if (mHas.vectorDrawable) {
+        for (auto& iter : filter<CanvasOpType::DrawVectorDrawable>()) {
+            iter->root->syncProperties();
+        }
+    }
 }
 
 void CanvasOpBuffer::onRemovedFromTree() {
-    LOG_ALWAYS_FATAL("TODO");
+    // Only functors need to be told, and they can't be recorded into a CanvasOpBuffer yet.
 }
 
+template <class T>
+using paint_helper = decltype(std::declval<T>().paint);
+
+template <class T>
+static constexpr bool has_sk_paint = [] {
+    if constexpr (std::experimental::is_detected_v<paint_helper, T>) {
+        return std::is_base_of_v<SkPaint, std::decay_t<paint_helper<T>>>;
+    }
+    return false;
+}();
+
 void CanvasOpBuffer::applyColorTransform(ColorTransform transform) {
-    LOG_ALWAYS_FATAL("TODO");
+    for_each([&]<CanvasOpType T>(const CanvasOpContainer<T>* container) {
+        // Like DisplayListData, the ops are transformed in place after recording
+        auto& op = const_cast<CanvasOp<T>&>(container->op());
+        if constexpr (T == CanvasOpType::DrawTextBlob) {
+            switch (op.drawTextBlobMode) {
+                case DrawTextBlobMode::HctOutline:
+                    op.paint.setColor(SK_ColorBLACK);
+                    break;
+                case DrawTextBlobMode::HctInner:
+                    op.paint.setColor(SK_ColorWHITE);
+                    break;
+                default:
+                    transformPaint(transform, &op.paint);
+                    break;
+            }
+        } else if constexpr (T == CanvasOpType::DrawRippleDrawable) {
+            // Ripples need to contrast against the background, so they get the inverse color.
+            op.params.color = transformColorInverse(transform, op.params.color);
+        } else if constexpr (T == CanvasOpType::DrawVectorDrawable) {
+            transformPaint(transform, &op.paint, op.palette);
+        } else if constexpr (T == CanvasOpType::DrawImage || T == CanvasOpType::DrawImageRect ||
+                             T == CanvasOpType::DrawImageLattice) {
+            transformPaint(transform, &op.paint, op.bitmap->palette());
+        } else if constexpr (has_sk_paint<CanvasOp<T>>) {
+            transformPaint(transform, &op.paint);
+        }
+    });
 }
 
 }  // namespace android::uirenderer
@@ -80,6 +80,12 @@ public:
         if constexpr (IsDrawOp(T)) {
             mHas.content = true;
         }
+        if constexpr (T == CanvasOpType::DrawTextBlob) {
+            mHas.text = true;
+        }
+        if constexpr (T == CanvasOpType::DrawVectorDrawable) {
+            mHas.vectorDrawable = true;
+        }
         if constexpr (T == CanvasOpType::DrawRenderNode) {
             mHas.children = true;
             // use staging property, since recording on UI thread
@@ -32,7 +32,10 @@ enum class CanvasOpType : int8_t {
 
     // Clip ops
     ClipRect,
+    ClipRRect,
     ClipPath,
+    ClipRegion,
+    ResetClip,
 
     // Drawing ops
     DRAW_OP_BEGIN,
@@ -59,11 +62,19 @@ enum class CanvasOpType : int8_t {
     // DrawImageLattice also used to draw 9 patches
     DrawImageLattice,
     DrawPicture,
+    DrawBehind,
+    DrawTextBlob,
+    DrawPatch,
+    DrawAtlas,
+    DrawShadowRec,
+    DrawAnnotation,
+    DrawDrawable,
+    DrawVectorDrawable,
     DrawLayer,
     DrawRenderNode,
     DRAW_OP_END = DrawRenderNode,
 
-    // TODO: Rest
+    // TODO: WebView functors, which need the FunctorDrawable lifecycle of SkiaDisplayList
 
     COUNT  // must be last
 };
@@ -18,8 +18,15 @@
 
 #include <SkAndroidFrameworkUtils.h>
 #include <SkCanvas.h>
+#include <SkCanvasPriv.h>
+#include <SkData.h>
+#include <SkDrawable.h>
+#include <SkDrawShadowInfo.h>
 #include <SkPath.h>
 #include <SkRegion.h>
+#include <SkRRect.h>
+#include <SkRSXform.h>
+#include <SkTextBlob.h>
 #include <SkVertices.h>
 #include <SkImage.h>
 #include <SkPicture.h>
@@ -28,14 +35,21 @@
 #include <log/log.h>
 
 #include "hwui/Bitmap.h"
+#include "hwui/Canvas.h"
+#include "hwui/Paint.h"
 #include "CanvasProperty.h"
 #include "CanvasOpTypes.h"
 #include "Layer.h"
 #include "Points.h"
 #include "RenderNode.h"
+#include "VectorDrawable.h"
 
+#include <array>
 #include <experimental/type_traits>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace android::uirenderer {
 
@@ -111,6 +125,29 @@ struct CanvasOp<CanvasOpType::ClipPath> {
     ASSERT_DRAWABLE()
 };
 
+template <>
+struct CanvasOp<CanvasOpType::ClipRRect> {
+    SkRRect rrect;
+    SkClipOp op;
+    bool aa;
+    void draw(SkCanvas* canvas) const { canvas->clipRRect(rrect, op, aa); }
+    ASSERT_DRAWABLE()
+};
+
+template <>
+struct CanvasOp<CanvasOpType::ClipRegion> {
+    SkRegion region;
+    SkClipOp op;
+    void draw(SkCanvas* canvas) const { canvas->clipRegion(region, op); }
+    ASSERT_DRAWABLE()
+};
+
+template <>
+struct CanvasOp<CanvasOpType::ResetClip> {
+    void draw(SkCanvas* canvas) const { SkAndroidFrameworkUtils::ResetClip(canvas); }
+    ASSERT_DRAWABLE()
+};
+
 // ----------------------------------------------
 //   Drawing Ops
 //  ---------------------------------------------
@@ -421,6 +458,104 @@ struct CanvasOp<CanvasOpType::DrawPicture> {
     }
 };
 
+template<>
+struct CanvasOp<CanvasOpType::DrawBehind> {
+    SkPaint paint;
+    void draw(SkCanvas* canvas) const { SkCanvasPriv::DrawBehind(canvas, paint); }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawTextBlob> {
+    sk_sp<SkTextBlob> blob;
+    float x;
+    float y;
+    SkPaint paint;
+    DrawTextBlobMode drawTextBlobMode = gDrawTextBlobMode;
+    void draw(SkCanvas* canvas) const { canvas->drawTextBlob(blob, x, y, paint); }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawPatch> {
+    std::array<SkPoint, 12> cubics;
+    std::optional<std::array<SkColor, 4>> colors;
+    std::optional<std::array<SkPoint, 4>> texCoords;
+    SkBlendMode mode;
+    SkPaint paint;
+    void draw(SkCanvas* canvas) const {
+        canvas->drawPatch(cubics.data(), colors ? colors->data() : nullptr,
+                          texCoords ? texCoords->data() : nullptr, mode, paint);
+    }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawAtlas> {
+    sk_sp<SkImage> atlas;
+    std::vector<SkRSXform> xforms;
+    std::vector<SkRect> texs;
+    // Either empty or one color per sprite
+    std::vector<SkColor> colors;
+    SkBlendMode mode;
+    SkSamplingOptions sampling;
+    std::optional<SkRect> cull;
+    SkPaint paint;
+    void draw(SkCanvas* canvas) const {
+        canvas->drawAtlas(atlas.get(), xforms.data(), texs.data(),
+                          colors.empty() ? nullptr : colors.data(), xforms.size(), mode, sampling,
+                          cull ? &*cull : nullptr, &paint);
+    }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawShadowRec> {
+    SkPath path;
+    SkDrawShadowRec rec;
+    void draw(SkCanvas* canvas) const { canvas->private_draw_shadow_rec(path, rec); }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawAnnotation> {
+    SkRect rect;
+    std::string key;
+    sk_sp<SkData> value;
+    void draw(SkCanvas* canvas) const { canvas->drawAnnotation(rect, key.c_str(), value.get()); }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawDrawable> {
+    sk_sp<SkDrawable> drawable;
+    SkMatrix matrix = SkMatrix::I();
+    // Resolve the drawable now rather than letting the canvas keep a reference to it, as
+    // drawables are mutable and not expected to outlive the frame, see DisplayListData.
+    void draw(SkCanvas* canvas) const { drawable->draw(canvas, &matrix); }
+    ASSERT_DRAWABLE()
+};
+
+template<>
+struct CanvasOp<CanvasOpType::DrawVectorDrawable> {
+
+    explicit CanvasOp(VectorDrawableRoot* tree)
+            : root(tree)
+            , bounds(tree->stagingProperties().getBounds())
+            , palette(tree->computePalette()) {
+        // Recording, so use staging properties
+        tree->getPaintFor(&paint, tree->stagingProperties());
+    }
+
+    sp<VectorDrawableRoot> root;
+    SkRect bounds;
+    Paint paint;
+    BitmapPalette palette;
+
+    void draw(SkCanvas* canvas) const { root->draw(canvas, bounds, paint); }
+    ASSERT_DRAWABLE()
+};
+
 template<>
 struct CanvasOp<CanvasOpType::DrawLayer> {
     sp<Layer> layer;
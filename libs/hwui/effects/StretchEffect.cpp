@@ -232,6 +232,27 @@ sk_sp<SkShader> StretchEffect::getShader(float width, float height,
     return result;
 }
 
+sk_sp<SkShader> StretchShaderCache::getShader(const StretchEffect& stretch, float width,
+                                              float height, const sk_sp<SkImage>& snapshotImage,
+                                              const SkMatrix* matrix) {
+    const bool hasMatrix = matrix != nullptr;
+    if (mShader && mImageId == snapshotImage->uniqueID() && mStretch == stretch &&
+        mWidth == width && mHeight == height && mHasMatrix == hasMatrix &&
+        (!hasMatrix || mMatrix == *matrix)) {
+        return mShader;
+    }
+    mShader = stretch.getShader(width, height, snapshotImage, matrix);
+    mStretch = stretch;
+    mWidth = width;
+    mHeight = height;
+    mImageId = snapshotImage->uniqueID();
+    mHasMatrix = hasMatrix;
+    if (hasMatrix) {
+        mMatrix = *matrix;
+    }
+    return mShader;
+}
+
 sk_sp<SkRuntimeEffect> StretchEffect::getStretchEffect() {
     const static SkRuntimeEffect::Result instance = SkRuntimeEffect::MakeForShader(stretchShader);
     return instance.effect;
@@ -133,4 +133,29 @@ private:
     mutable std::unique_ptr<SkRuntimeShaderBuilder> mBuilder;
 };
 
+/**
+ * Keeps the last shader made by StretchEffect::getShader(), so that drawing the same stretch of
+ * the same image again, e.g. a layer that isn't repainted while an overscroll is held, reuses it
+ * rather than building a new one. When only the stretch changes just the uniforms are rebuilt.
+ */
+class StretchShaderCache {
+public:
+    sk_sp<SkShader> getShader(const StretchEffect& stretch, float width, float height,
+                              const sk_sp<SkImage>& snapshotImage, const SkMatrix* matrix);
+
+    void clear() {
+        mShader = nullptr;
+        mImageId = 0;
+    }
+
+private:
+    sk_sp<SkShader> mShader;
+    StretchEffect mStretch;
+    float mWidth = 0;
+    float mHeight = 0;
+    uint32_t mImageId = 0;
+    bool mHasMatrix = false;
+    SkMatrix mMatrix;
+};
+
 } // namespace android::uirenderer
@@ -20,6 +20,7 @@
 #endif
 
 #include <gui/TraceUtils.h>
+#include "Properties.h"
 #include "pipeline/skia/SkiaUtils.h"
 
 #include <SkPicture.h>
@@ -187,6 +188,9 @@ void AnimatedImageDrawable::onDraw(SkCanvas* canvas) {
 #ifdef __ANDROID__ // Layoutlib does not support AnimatedImageThread
         auto& thread = uirenderer::AnimatedImageThread::getInstance();
         mNextSnapshot = thread.reset(sk_ref_sp(this));
+        // Frames decoded ahead before the reset are stale. Their decodes still run first, as
+        // the thread handles this drawable's work in order.
+        mDecodeAhead.clear();
 #endif
     }
 
@@ -195,6 +199,10 @@ void AnimatedImageDrawable::onDraw(SkCanvas* canvas) {
         std::unique_lock lock{mSwapLock};
         if (mCurrentTime >= mTimeToShowNextSnapshot) {
             mSnapshot = mNextSnapshot.get();
+            if (!mDecodeAhead.empty()) {
+                mNextSnapshot = std::move(mDecodeAhead.front());
+                mDecodeAhead.pop_front();
+            }
             const nsecs_t timeToShowCurrentSnap = mTimeToShowNextSnapshot;
             if (mSnapshot.mDurationMS == SkAnimatedImage::kFinished) {
                 finalFrame = true;
@@ -212,12 +220,20 @@ void AnimatedImageDrawable::onDraw(SkCanvas* canvas) {
         }
     }
 
-    if (mRunning && !mNextSnapshot.valid()) {
 #ifdef __ANDROID__ // Layoutlib does not support AnimatedImageThread
+    if (mRunning) {
         auto& thread = uirenderer::AnimatedImageThread::getInstance();
-        mNextSnapshot = thread.decodeNextFrame(sk_ref_sp(this));
-#endif
+        if (!mNextSnapshot.valid()) {
+            mNextSnapshot = thread.decodeNextFrame(sk_ref_sp(this));
+        }
+        const size_t decodeAhead = uirenderer::Properties::getAnimatedImageDecodeAhead() - 1;
+        while (mDecodeAhead.size() < decodeAhead) {
+            mDecodeAhead.push_back(thread.decodeNextFrame(sk_ref_sp(this)));
+        }
+    } else {
+        mDecodeAhead.clear();
     }
+#endif
 
     if (!drawDirectly) {
         // No other thread will modify mCurrentSnap so this should be safe to
@@ -27,6 +27,7 @@
 #include <SkDrawable.h>
 #include <SkPicture.h>
 
+#include <deque>
 #include <future>
 #include <mutex>
 
@@ -124,6 +125,10 @@ private:
 
     std::future<Snapshot> mNextSnapshot;
 
+    // The frames after mNextSnapshot that have been requested from AnimatedImageThread, in
+    // order. Holds Properties::getAnimatedImageDecodeAhead() - 1 frames while running.
+    std::deque<std::future<Snapshot>> mDecodeAhead;
+
     bool nextSnapshotReady() const;
 
     // When to switch from mSnapshot to mNextSnapshot.
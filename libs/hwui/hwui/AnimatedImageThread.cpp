@@ -18,30 +18,46 @@
 
 #include <sys/resource.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace android {
 namespace uirenderer {
 
 AnimatedImageThread& AnimatedImageThread::getInstance() {
-    static sp<AnimatedImageThread> sInstance = []() {
-        sp<AnimatedImageThread> thread = sp<AnimatedImageThread>::make();
-        thread->start("AnimatedImageThread");
-        return thread;
-    }();
-    return *sInstance;
+    static AnimatedImageThread sInstance;
+    return sInstance;
 }
 
 AnimatedImageThread::AnimatedImageThread() {
+    const int cpuCount = static_cast<int>(std::thread::hardware_concurrency());
+    const int workerCount = std::clamp(cpuCount / 2, 1, MAX_WORKER_COUNT);
+    for (int i = 0; i < workerCount; i++) {
+        sp<Worker> worker = sp<Worker>::make();
+        worker->start("AnimatedImageThread");
+        mWorkers.push_back(std::move(worker));
+    }
+}
+
+status_t AnimatedImageThread::Worker::readyToRun() {
     setpriority(PRIO_PROCESS, 0, PRIORITY_NORMAL + PRIORITY_MORE_FAVORABLE);
+    return NO_ERROR;
+}
+
+WorkQueue& AnimatedImageThread::queueFor(const AnimatedImageDrawable* drawable) {
+    // Drawables are heap allocated, so drop the alignment bits before picking a worker.
+    const uintptr_t key = reinterpret_cast<uintptr_t>(drawable) >> 4;
+    return mWorkers[key % mWorkers.size()]->queue();
 }
 
 std::future<AnimatedImageDrawable::Snapshot> AnimatedImageThread::decodeNextFrame(
         const sk_sp<AnimatedImageDrawable>& drawable) {
-    return queue().async([drawable]() { return drawable->decodeNextFrame(); });
+    return queueFor(drawable.get()).async([drawable]() { return drawable->decodeNextFrame(); });
 }
 
 std::future<AnimatedImageDrawable::Snapshot> AnimatedImageThread::reset(
         const sk_sp<AnimatedImageDrawable>& drawable) {
-    return queue().async([drawable]() { return drawable->reset(); });
+    return queueFor(drawable.get()).async([drawable]() { return drawable->reset(); });
 }
 
 }  // namespace uirenderer
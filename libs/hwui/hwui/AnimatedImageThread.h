@@ -22,14 +22,21 @@
 
 #include <SkRefCnt.h>
 
+#include <vector>
+
 namespace android {
 
 namespace uirenderer {
 
-class AnimatedImageThread : private ThreadBase {
+// Decodes the frames of AnimatedImageDrawables on a few worker threads. All the work for one
+// drawable goes to the same worker, so its frames are decoded in the order they are requested,
+// while different drawables decode in parallel.
+class AnimatedImageThread {
     PREVENT_COPY_AND_ASSIGN(AnimatedImageThread);
 
 public:
+    static constexpr int MAX_WORKER_COUNT = 3;
+
     static AnimatedImageThread& getInstance();
 
     std::future<AnimatedImageDrawable::Snapshot> decodeNextFrame(
@@ -37,8 +44,16 @@ public:
     std::future<AnimatedImageDrawable::Snapshot> reset(const sk_sp<AnimatedImageDrawable>&);
 
 private:
-    friend sp<AnimatedImageThread>;
+    class Worker : public ThreadBase {
+    protected:
+        status_t readyToRun() override;
+    };
+
     AnimatedImageThread();
+
+    WorkQueue& queueFor(const AnimatedImageDrawable* drawable);
+
+    std::vector<sp<Worker>> mWorkers;
 };
 
 }  // namespace uirenderer
@@ -38,7 +38,10 @@
 #include <SkImagePriv.h>
 #include <SkWebpEncoder.h>
 #include <SkHighContrastFilter.h>
+#include <cstring>
 #include <limits>
+#include <list>
+#include <mutex>
 
 namespace android {
 
@@ -48,6 +51,117 @@ bool Bitmap::computeAllocationSize(size_t rowBytes, int height, size_t* size) {
            *size <= std::numeric_limits<int32_t>::max();
 }
 
+/**
+ * Freed heap pixel buffers, kept for the next bitmaps of the same allocation size. Apps decode
+ * thumbnails and tiles of a handful of sizes over and over, and reusing their buffers saves the
+ * mmap, the page faults and the munmap that large callocs and frees each cost. Bitmaps of equal
+ * dimensions and color type have equal sizes, so the buffers are matched by size alone.
+ */
+class HeapPixelPool {
+public:
+    // Smaller buffers come from malloc's own pools, which already reuse them.
+    static constexpr size_t MIN_POOLED_SIZE = 64 * 1024;
+    static constexpr size_t MAX_POOLED_BYTES = 16 * 1024 * 1024;
+    static constexpr size_t MAX_POOLED_BUFFERS = 16;
+
+    static HeapPixelPool& get() {
+        static HeapPixelPool& pool = *new HeapPixelPool();
+        return pool;
+    }
+
+    // Returns zeroed memory of size bytes, like calloc.
+    void* acquire(size_t size) {
+        if (size >= MIN_POOLED_SIZE) {
+            void* buffer = nullptr;
+            {
+                std::lock_guard lock(mLock);
+                for (auto it = mBuffers.begin(); it != mBuffers.end(); it++) {
+                    if (it->size == size) {
+                        buffer = it->address;
+                        mBuffers.erase(it);
+                        mPooledBytes -= size;
+                        break;
+                    }
+                }
+                buffer ? mHits++ : mMisses++;
+            }
+            if (buffer) {
+                memset(buffer, 0, size);
+                return buffer;
+            }
+        }
+        return calloc(size, 1);
+    }
+
+    // Returns false if the buffer wasn't kept, in which case the caller still owns it.
+    bool release(void* address, size_t size) {
+        if (size < MIN_POOLED_SIZE || size > MAX_POOLED_BYTES / 2) {
+            return false;
+        }
+        void* evicted[MAX_POOLED_BUFFERS + 1];
+        size_t evictedCount = 0;
+        {
+            std::lock_guard lock(mLock);
+            // The most recently freed buffers are the most likely to be reused.
+            mBuffers.push_front({address, size});
+            mPooledBytes += size;
+            while (mPooledBytes > MAX_POOLED_BYTES || mBuffers.size() > MAX_POOLED_BUFFERS) {
+                evicted[evictedCount++] = mBuffers.back().address;
+                mPooledBytes -= mBuffers.back().size;
+                mBuffers.pop_back();
+            }
+        }
+        for (size_t i = 0; i < evictedCount; i++) {
+            free(evicted[i]);
+        }
+        return true;
+    }
+
+    void trim() {
+        std::list<Buffer> buffers;
+        {
+            std::lock_guard lock(mLock);
+            buffers.swap(mBuffers);
+            mPooledBytes = 0;
+        }
+        for (const Buffer& buffer : buffers) {
+            free(buffer.address);
+        }
+#ifdef __ANDROID__
+        if (!buffers.empty()) {
+            mallopt(M_PURGE, 0);
+        }
+#endif
+    }
+
+    Bitmap::HeapPoolStats stats() {
+        std::lock_guard lock(mLock);
+        return {mBuffers.size(), mPooledBytes, mHits, mMisses};
+    }
+
+private:
+    struct Buffer {
+        void* address;
+        size_t size;
+    };
+
+    HeapPixelPool() {}
+
+    std::mutex mLock;
+    std::list<Buffer> mBuffers;
+    size_t mPooledBytes = 0;
+    size_t mHits = 0;
+    size_t mMisses = 0;
+};
+
+Bitmap::HeapPoolStats Bitmap::getHeapPoolStats() {
+    return HeapPixelPool::get().stats();
+}
+
+void Bitmap::trimHeapPool() {
+    HeapPixelPool::get().trim();
+}
+
 typedef sk_sp<Bitmap> (*AllocPixelRef)(size_t allocSize, const SkImageInfo& info, size_t rowBytes);
 
 static sk_sp<Bitmap> allocateBitmap(SkBitmap* bitmap, AllocPixelRef alloc) {
@@ -114,6 +228,38 @@ sk_sp<Bitmap> Bitmap::allocateHardwareBitmap(const SkBitmap& bitmap) {
 #endif
 }
 
+std::vector<sk_sp<Bitmap>> Bitmap::allocateHardwareBitmaps(const std::vector<SkBitmap>& bitmaps) {
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+    if (!uirenderer::HardwareBitmapUploader::hasAlpha8Support()) {
+        std::vector<SkBitmap> supported;
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < bitmaps.size(); i++) {
+            if (bitmaps[i].colorType() != kAlpha_8_SkColorType) {
+                supported.push_back(bitmaps[i]);
+                indices.push_back(i);
+            }
+        }
+        if (supported.size() != bitmaps.size()) {
+            std::vector<sk_sp<Bitmap>> uploaded =
+                    uirenderer::HardwareBitmapUploader::allocateHardwareBitmaps(supported);
+            std::vector<sk_sp<Bitmap>> result(bitmaps.size());
+            for (size_t i = 0; i < indices.size(); i++) {
+                result[indices[i]] = std::move(uploaded[i]);
+            }
+            return result;
+        }
+    }
+    return uirenderer::HardwareBitmapUploader::allocateHardwareBitmaps(bitmaps);
+#else
+    std::vector<sk_sp<Bitmap>> result;
+    result.reserve(bitmaps.size());
+    for (const SkBitmap& bitmap : bitmaps) {
+        result.push_back(Bitmap::allocateHeapBitmap(bitmap.info()));
+    }
+    return result;
+#endif
+}
+
 sk_sp<Bitmap> Bitmap::allocateHeapBitmap(SkBitmap* bitmap) {
     return allocateBitmap(bitmap, &Bitmap::allocateHeapBitmap);
 }
@@ -128,7 +274,7 @@ sk_sp<Bitmap> Bitmap::allocateHeapBitmap(const SkImageInfo& info) {
 }
 
 sk_sp<Bitmap> Bitmap::allocateHeapBitmap(size_t size, const SkImageInfo& info, size_t rowBytes) {
-    void* addr = calloc(size, 1);
+    void* addr = HeapPixelPool::get().acquire(size);
     if (!addr) {
         return nullptr;
     }
@@ -270,10 +416,13 @@ Bitmap::~Bitmap() {
             close(mPixelStorage.ashmem.fd);
             break;
         case PixelStorageType::Heap:
-            free(mPixelStorage.heap.address);
+            if (!HeapPixelPool::get().release(mPixelStorage.heap.address,
+                                              mPixelStorage.heap.size)) {
+                free(mPixelStorage.heap.address);
 #ifdef __ANDROID__
-            mallopt(M_PURGE, 0);
+                mallopt(M_PURGE, 0);
 #endif
+            }
             break;
         case PixelStorageType::Hardware:
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
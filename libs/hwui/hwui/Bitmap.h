@@ -23,6 +23,8 @@
 #include <SkImageInfo.h>
 #include <SkPixelRef.h>
 #include <cutils/compiler.h>
+#include <vector>
+
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
 #include <android/hardware_buffer.h>
 #endif
@@ -69,10 +71,29 @@ public:
      */
     static sk_sp<Bitmap> allocateAshmemBitmap(SkBitmap* bitmap);
     static sk_sp<Bitmap> allocateHardwareBitmap(const SkBitmap& bitmap);
+    // Allocates the hardware bitmaps for all of |bitmaps| in a single batched upload. Entries
+    // that could not be allocated are nullptr.
+    static std::vector<sk_sp<Bitmap>> allocateHardwareBitmaps(const std::vector<SkBitmap>& bitmaps);
     static sk_sp<Bitmap> allocateHeapBitmap(SkBitmap* bitmap);
     static sk_sp<Bitmap> allocateHeapBitmap(const SkImageInfo& info);
     static sk_sp<Bitmap> allocateHeapBitmap(size_t size, const SkImageInfo& i, size_t rowBytes);
 
+    struct HeapPoolStats {
+        size_t pooledBuffers;
+        size_t pooledBytes;
+        size_t hits;
+        size_t misses;
+    };
+
+    /* The pixels of large heap bitmaps are handed back to a process-wide pool when the bitmap is
+     * destroyed, for the next heap bitmap of the same size. Returns the current state of that pool.
+     */
+    static HeapPoolStats getHeapPoolStats();
+
+    /* Frees the pixels held by the pool.
+     */
+    static void trimHeapPool();
+
     /* The createFrom factories construct a new Bitmap object by wrapping the already allocated
      * memory that is provided as an input param.
      */
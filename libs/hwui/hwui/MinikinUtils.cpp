@@ -17,6 +17,7 @@
 #include "MinikinUtils.h"
 
 #include <string>
+#include <vector>
 
 #include <log/log.h>
 
@@ -24,6 +25,7 @@
 #include <minikin/Measurement.h>
 #include "Paint.h"
 #include "SkPathMeasure.h"
+#include "TextRunCache.h"
 #include "Typeface.h"
 
 namespace android {
@@ -63,8 +65,22 @@ minikin::Layout MinikinUtils::doLayout(const Paint* paint, minikin::Bidi bidiFla
     const minikin::EndHyphenEdit endHyphen = paint->getEndHyphenEdit();
 
     if (mt == nullptr) {
-        return minikin::Layout(textBuf.substr(contextRange), range - contextStart, bidiFlags,
-                               minikinPaint, startHyphen, endHyphen);
+        const minikin::U16StringPiece contextBuf = textBuf.substr(contextRange);
+        const minikin::Range contextualRange = range - contextStart;
+        minikin::Layout layout(contextBuf, contextualRange, bidiFlags, minikinPaint, startHyphen,
+                               endHyphen);
+        // Record the advances so that measuring the run afterwards doesn't lay it out again.
+        if (contextBuf.size() <= TextRunCache::kMaxRunLength && count > 0) {
+            std::vector<float> advances(count);
+            for (size_t i = 0; i < count; i++) {
+                advances[i] = layout.getCharAdvance(i);
+            }
+            TextRunCache::getInstance().put(
+                    contextBuf, contextualRange, bidiFlags, minikinPaint,
+                    TextRunCache::isSizeInvariant(paint->getSkFont(), minikinPaint), startHyphen,
+                    endHyphen, layout.getAdvance(), advances.data());
+        }
+        return layout;
     } else {
         return mt->buildLayout(textBuf, range, contextRange, minikinPaint, startHyphen, endHyphen);
     }
@@ -91,8 +107,29 @@ float MinikinUtils::measureText(const Paint* paint, minikin::Bidi bidiFlags,
     const minikin::StartHyphenEdit startHyphen = paint->getStartHyphenEdit();
     const minikin::EndHyphenEdit endHyphen = paint->getEndHyphenEdit();
 
-    return minikin::Layout::measureText(textBuf, range, bidiFlags, minikinPaint, startHyphen,
-                                        endHyphen, advances);
+    if (bufSize > TextRunCache::kMaxRunLength || count == 0) {
+        return minikin::Layout::measureText(textBuf, range, bidiFlags, minikinPaint, startHyphen,
+                                            endHyphen, advances);
+    }
+
+    TextRunCache& cache = TextRunCache::getInstance();
+    const bool sizeInvariant = TextRunCache::isSizeInvariant(paint->getSkFont(), minikinPaint);
+    float advance;
+    if (cache.get(textBuf, range, bidiFlags, minikinPaint, sizeInvariant, startHyphen, endHyphen,
+                  &advance, advances)) {
+        return advance;
+    }
+
+    std::vector<float> localAdvances;
+    if (advances == nullptr) {
+        localAdvances.resize(count);
+        advances = localAdvances.data();
+    }
+    advance = minikin::Layout::measureText(textBuf, range, bidiFlags, minikinPaint, startHyphen,
+                                           endHyphen, advances);
+    cache.put(textBuf, range, bidiFlags, minikinPaint, sizeInvariant, startHyphen, endHyphen,
+              advance, advances);
+    return advance;
 }
 
 minikin::MinikinExtent MinikinUtils::getFontExtent(const Paint* paint, minikin::Bidi bidiFlags,
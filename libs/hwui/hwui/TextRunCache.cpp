@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TextRunCache.h"
+
+#include <SkFont.h>
+#include <SkFontStyle.h>
+#include <minikin/FontCollection.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace android {
+
+namespace {
+
+inline void hashCombine(size_t* seed, size_t value) {
+    *seed ^= value + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+}  // namespace
+
+TextRunCache& TextRunCache::getInstance() {
+    static TextRunCache* sInstance = new TextRunCache();
+    return *sInstance;
+}
+
+bool TextRunCache::isSizeInvariant(const SkFont& font, const minikin::MinikinPaint& paint) {
+    // Hinted advances snap to the pixel grid, word spacing is a fixed amount added to each space,
+    // and the outset of synthetic bold doesn't grow linearly with the size. Synthetic bold is only
+    // applied when a bold style is requested, so bold runs are keyed by size as a whole.
+    return font.isLinearMetrics() && paint.wordSpacing == 0 && !font.isEmbolden() &&
+           paint.fontStyle.weight() < SkFontStyle::kSemiBold_Weight;
+}
+
+bool TextRunCache::makeKey(const minikin::U16StringPiece& text, const minikin::Range& range,
+                           minikin::Bidi bidiFlags, const minikin::MinikinPaint& paint,
+                           bool sizeInvariant, minikin::StartHyphenEdit startHyphen,
+                           minikin::EndHyphenEdit endHyphen, Key* outKey) {
+    if (text.size() > kMaxRunLength || range.isEmpty() || paint.size <= 0 ||
+        paint.font == nullptr) {
+        return false;
+    }
+    // The whole buffer is part of the key as it's the shaping context of the range.
+    outKey->text.assign(reinterpret_cast<const char16_t*>(text.data()), text.size());
+    outKey->rangeStart = range.getStart();
+    outKey->rangeEnd = range.getEnd();
+    outKey->bidiFlags = bidiFlags;
+    outKey->fontCollectionId = paint.font->getId();
+    outKey->size = sizeInvariant ? 0 : paint.size;
+    outKey->scaleX = paint.scaleX;
+    outKey->skewX = paint.skewX;
+    outKey->letterSpacing = paint.letterSpacing;
+    outKey->wordSpacing = paint.wordSpacing;
+    outKey->fontFlags = paint.fontFlags;
+    outKey->localeListId = paint.localeListId;
+    outKey->familyVariant = paint.familyVariant;
+    outKey->fontStyle = paint.fontStyle;
+    outKey->fontFeatureSettings = paint.fontFeatureSettings;
+    outKey->startHyphen = startHyphen;
+    outKey->endHyphen = endHyphen;
+    return true;
+}
+
+bool TextRunCache::Key::operator==(const Key& other) const {
+    return rangeStart == other.rangeStart && rangeEnd == other.rangeEnd &&
+           bidiFlags == other.bidiFlags && fontCollectionId == other.fontCollectionId &&
+           size == other.size && scaleX == other.scaleX && skewX == other.skewX &&
+           letterSpacing == other.letterSpacing && wordSpacing == other.wordSpacing &&
+           fontFlags == other.fontFlags && localeListId == other.localeListId &&
+           familyVariant == other.familyVariant && fontStyle == other.fontStyle &&
+           startHyphen == other.startHyphen && endHyphen == other.endHyphen &&
+           text == other.text && fontFeatureSettings == other.fontFeatureSettings;
+}
+
+size_t TextRunCache::KeyHasher::operator()(const Key& key) const {
+    size_t seed = std::hash<std::u16string>()(key.text);
+    hashCombine(&seed, key.rangeStart);
+    hashCombine(&seed, key.rangeEnd);
+    hashCombine(&seed, static_cast<size_t>(key.bidiFlags));
+    hashCombine(&seed, key.fontCollectionId);
+    hashCombine(&seed, std::hash<float>()(key.size));
+    hashCombine(&seed, std::hash<float>()(key.scaleX));
+    hashCombine(&seed, std::hash<float>()(key.skewX));
+    hashCombine(&seed, std::hash<float>()(key.letterSpacing));
+    hashCombine(&seed, std::hash<float>()(key.wordSpacing));
+    hashCombine(&seed, key.fontFlags);
+    hashCombine(&seed, key.localeListId);
+    hashCombine(&seed, static_cast<size_t>(key.familyVariant));
+    hashCombine(&seed, key.fontStyle.weight());
+    hashCombine(&seed, static_cast<size_t>(key.fontStyle.slant()));
+    hashCombine(&seed, std::hash<std::string>()(key.fontFeatureSettings));
+    hashCombine(&seed, static_cast<size_t>(key.startHyphen));
+    hashCombine(&seed, static_cast<size_t>(key.endHyphen));
+    return seed;
+}
+
+bool TextRunCache::get(const minikin::U16StringPiece& text, const minikin::Range& range,
+                       minikin::Bidi bidiFlags, const minikin::MinikinPaint& paint,
+                       bool sizeInvariant, minikin::StartHyphenEdit startHyphen,
+                       minikin::EndHyphenEdit endHyphen, float* outAdvance, float* advances) {
+    Key key;
+    if (!makeKey(text, range, bidiFlags, paint, sizeInvariant, startHyphen, endHyphen, &key)) {
+        return false;
+    }
+
+    std::lock_guard lock(mLock);
+    auto found = mEntries.find(key);
+    if (found == mEntries.end()) {
+        mMisses++;
+        return false;
+    }
+    mLru.splice(mLru.begin(), mLru, found->second);
+
+    const Entry& entry = found->second->second;
+    const float scale = paint.size / entry.size;
+    if (scale == 1.0f) {
+        mHits++;
+        *outAdvance = entry.advance;
+        if (advances) {
+            std::copy(entry.advances.begin(), entry.advances.end(), advances);
+        }
+    } else {
+        mScaledHits++;
+        *outAdvance = entry.advance * scale;
+        if (advances) {
+            std::transform(entry.advances.begin(), entry.advances.end(), advances,
+                           [scale](float advance) { return advance * scale; });
+        }
+    }
+    return true;
+}
+
+void TextRunCache::put(const minikin::U16StringPiece& text, const minikin::Range& range,
+                       minikin::Bidi bidiFlags, const minikin::MinikinPaint& paint,
+                       bool sizeInvariant, minikin::StartHyphenEdit startHyphen,
+                       minikin::EndHyphenEdit endHyphen, float advance, const float* advances) {
+    Key key;
+    if (!makeKey(text, range, bidiFlags, paint, sizeInvariant, startHyphen, endHyphen, &key)) {
+        return;
+    }
+
+    std::lock_guard lock(mLock);
+    auto found = mEntries.find(key);
+    if (found != mEntries.end()) {
+        // Another thread measured the same run in the meantime.
+        mLru.splice(mLru.begin(), mLru, found->second);
+        return;
+    }
+
+    Entry entry{paint.size, advance, std::vector<float>(advances, advances + range.getLength())};
+    mLru.emplace_front(key, std::move(entry));
+    mEntries.emplace(std::move(key), mLru.begin());
+    if (mLru.size() > kMaxEntries) {
+        mEntries.erase(mLru.back().first);
+        mLru.pop_back();
+    }
+}
+
+TextRunCache::Stats TextRunCache::getStats() {
+    std::lock_guard lock(mLock);
+    return Stats{mHits, mScaledHits, mMisses, mLru.size()};
+}
+
+void TextRunCache::clear() {
+    std::lock_guard lock(mLock);
+    mEntries.clear();
+    mLru.clear();
+    mHits = 0;
+    mScaledHits = 0;
+    mMisses = 0;
+}
+
+}  // namespace android
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ANDROID_GRAPHICS_TEXT_RUN_CACHE_H_
+#define _ANDROID_GRAPHICS_TEXT_RUN_CACHE_H_
+
+#include <minikin/Layout.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class SkFont;
+
+namespace android {
+
+/**
+ * A process-wide cache of the advances of whole text runs.
+ *
+ * Minikin already caches shaping per word, but every measurement still splits the run into words,
+ * looks each of them up and sums the advances. Views measure the same short runs over and over,
+ * often with Paints that only differ in their color or text size, so the advances of the whole run
+ * are cached here. Runs laid out for drawing are recorded as well, so that drawing a run makes
+ * measuring it again cheap.
+ *
+ * When the advances scale linearly with the text size (linear metrics, no word spacing and no
+ * synthetic bold), the size is left out of the key and a cached run serves every text size.
+ */
+class TextRunCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        // Hits served by an entry measured at a different text size.
+        uint64_t scaledHits;
+        uint64_t misses;
+        size_t entries;
+    };
+
+    // Longer runs are not cached: they're rarely measured twice with the same contents.
+    static constexpr size_t kMaxRunLength = 256;
+    static constexpr size_t kMaxEntries = 512;
+
+    static TextRunCache& getInstance();
+
+    // Returns whether the advances of paint scale linearly with its size.
+    static bool isSizeInvariant(const SkFont& font, const minikin::MinikinPaint& paint);
+
+    /**
+     * Looks up the advance of range in text. On a hit, returns true, sets outAdvance and, if
+     * advances isn't null, writes the advance of each code unit of range into advances.
+     */
+    bool get(const minikin::U16StringPiece& text, const minikin::Range& range,
+             minikin::Bidi bidiFlags, const minikin::MinikinPaint& paint, bool sizeInvariant,
+             minikin::StartHyphenEdit startHyphen, minikin::EndHyphenEdit endHyphen,
+             float* outAdvance, float* advances);
+
+    // Records the advance of range in text along with the advances of its code units.
+    void put(const minikin::U16StringPiece& text, const minikin::Range& range,
+             minikin::Bidi bidiFlags, const minikin::MinikinPaint& paint, bool sizeInvariant,
+             minikin::StartHyphenEdit startHyphen, minikin::EndHyphenEdit endHyphen,
+             float advance, const float* advances);
+
+    Stats getStats();
+    void clear();
+
+private:
+    struct Key {
+        std::u16string text;
+        uint32_t rangeStart;
+        uint32_t rangeEnd;
+        minikin::Bidi bidiFlags;
+        // Font collection IDs are never reused, unlike their addresses.
+        uint32_t fontCollectionId;
+        // Zero when the run is size invariant.
+        float size;
+        float scaleX;
+        float skewX;
+        float letterSpacing;
+        float wordSpacing;
+        uint32_t fontFlags;
+        uint32_t localeListId;
+        minikin::FamilyVariant familyVariant;
+        minikin::FontStyle fontStyle;
+        std::string fontFeatureSettings;
+        minikin::StartHyphenEdit startHyphen;
+        minikin::EndHyphenEdit endHyphen;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHasher {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        // The text size the advances were measured at.
+        float size;
+        float advance;
+        std::vector<float> advances;
+    };
+
+    using LruList = std::list<std::pair<Key, Entry>>;
+
+    static bool makeKey(const minikin::U16StringPiece& text, const minikin::Range& range,
+                        minikin::Bidi bidiFlags, const minikin::MinikinPaint& paint,
+                        bool sizeInvariant, minikin::StartHyphenEdit startHyphen,
+                        minikin::EndHyphenEdit endHyphen, Key* outKey);
+
+    std::mutex mLock;
+    LruList mLru;
+    std::unordered_map<Key, LruList::iterator, KeyHasher> mEntries;
+    uint64_t mHits = 0;
+    uint64_t mScaledHits = 0;
+    uint64_t mMisses = 0;
+};
+
+}  // namespace android
+
+#endif  // _ANDROID_GRAPHICS_TEXT_RUN_CACHE_H_
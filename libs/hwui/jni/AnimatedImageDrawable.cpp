@@ -18,6 +18,7 @@
 #include "ImageDecoder.h"
 #include "Utils.h"
 
+#include <Properties.h>
 #include <SkAndroidCodec.h>
 #include <SkAnimatedImage.h>
 #include <SkColorFilter.h>
@@ -76,9 +77,11 @@ static jlong AnimatedImageDrawable_nCreate(JNIEnv* env, jobject /*clazz*/,
     size_t bytesUsed = info.computeMinByteSize();
     // SkAnimatedImage has one SkBitmap for decoding, plus an extra one if there is a
     // kRestorePrevious frame. AnimatedImageDrawable has two SkPictures storing the current
-    // frame and the next frame. (The former assumes that the image is animated, and the
-    // latter assumes that it is drawn to a hardware canvas.)
-    bytesUsed *= hasRestoreFrame ? 4 : 3;
+    // frame and the next frame, plus one for every further frame it decodes ahead. (The former
+    // assumes that the image is animated, and the latter assumes that it is drawn to a hardware
+    // canvas.)
+    const int decodeAhead = uirenderer::Properties::getAnimatedImageDecodeAhead() - 1;
+    bytesUsed *= (hasRestoreFrame ? 4 : 3) + decodeAhead;
     sk_sp<SkPicture> picture;
     if (jpostProcess) {
         SkRect bounds = SkRect::MakeWH(subset.width(), subset.height());
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "BitmapRegionDecoder"
+
+#include "CachingRegionDecoder.h"
+
+#include "SkCodec.h"
+
+#include <gui/TraceUtils.h>
+#include <thread/CommonPool.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace android {
+
+namespace {
+
+// Cache entries are immutable once decoded, so plain heap pixels are enough.
+class CacheAllocator : public skia::BRDAllocator {
+public:
+    bool allocPixelRef(SkBitmap* bitmap) override { return bitmap->tryAllocPixels(); }
+    SkCodec::ZeroInitialized zeroInit() const override { return SkCodec::kNo_ZeroInitialized; }
+};
+
+// At most this many regions are prefetched at once, each with its own decoder.
+constexpr size_t kMaxPendingPrefetches = 2;
+
+}  // namespace
+
+bool CachingRegionDecoder::Request::operator==(const Request& other) const {
+    return subset == other.subset && sampleSize == other.sampleSize &&
+           colorType == other.colorType && requireUnpremul == other.requireUnpremul &&
+           SkColorSpace::Equals(colorSpace.get(), other.colorSpace.get());
+}
+
+struct CachingRegionDecoder::State {
+    struct Entry {
+        Request request;
+        SkBitmap bitmap;
+    };
+
+    explicit State(sk_sp<SkData> data) : data(std::move(data)) {}
+
+    // Returns the cached decode of `request`, marking it as most recently used.
+    std::optional<SkBitmap> find(const Request& request) {
+        // The cache only ever holds a few dozen tiles, so a linear search is cheap next to a
+        // decode.
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            if (it->request == request) {
+                entries.splice(entries.begin(), entries, it);
+                return it->bitmap;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void insert(const Request& request, SkBitmap bitmap) {
+        const size_t size = bitmap.computeByteSize();
+        if (size > kMaxCacheBytes / 4) {
+            // Mostly whole images at a coarse sample size; caching them would evict every tile.
+            return;
+        }
+        entries.push_front({request, std::move(bitmap)});
+        bytes += size;
+        while (bytes > kMaxCacheBytes) {
+            bytes -= entries.back().bitmap.computeByteSize();
+            entries.pop_back();
+        }
+    }
+
+    bool isPending(const Request& request) const {
+        return std::find(pending.begin(), pending.end(), request) != pending.end();
+    }
+
+    std::mutex lock;
+    const sk_sp<SkData> data;
+    // Most recently used first.
+    std::list<Entry> entries;
+    size_t bytes = 0;
+    std::vector<Request> pending;
+    // Decoders of finished prefetches, kept for the next ones.
+    std::vector<std::unique_ptr<skia::BitmapRegionDecoder>> idleDecoders;
+};
+
+std::unique_ptr<CachingRegionDecoder> CachingRegionDecoder::Make(sk_sp<SkData> data) {
+    auto decoder = skia::BitmapRegionDecoder::Make(data);
+    if (!decoder) {
+        return nullptr;
+    }
+    return std::unique_ptr<CachingRegionDecoder>(
+            new CachingRegionDecoder(std::move(decoder), std::move(data)));
+}
+
+CachingRegionDecoder::CachingRegionDecoder(std::unique_ptr<skia::BitmapRegionDecoder> decoder,
+                                           sk_sp<SkData> data)
+        : mDecoder(std::move(decoder)), mState(std::make_shared<State>(std::move(data))) {}
+
+CachingRegionDecoder::~CachingRegionDecoder() = default;
+
+bool CachingRegionDecoder::decodeRegion(SkBitmap* bitmap, skia::BRDAllocator* allocator,
+                                        const Request& request) {
+    std::optional<SkBitmap> cached;
+    {
+        std::lock_guard lock(mState->lock);
+        cached = mState->find(request);
+    }
+
+    if (cached) {
+        ATRACE_NAME("BitmapRegionDecoder cache hit");
+        bitmap->setInfo(cached->info());
+        if (!allocator->allocPixelRef(bitmap) || !cached->readPixels(bitmap->pixmap())) {
+            return false;
+        }
+    } else {
+        if (!mDecoder->decodeRegion(bitmap, allocator, request.subset, request.sampleSize,
+                                    request.colorType, request.requireUnpremul,
+                                    request.colorSpace)) {
+            return false;
+        }
+        SkBitmap copy;
+        if (copy.tryAllocPixels(bitmap->info()) && bitmap->readPixels(copy.pixmap())) {
+            copy.setImmutable();
+            std::lock_guard lock(mState->lock);
+            if (!mState->find(request)) {
+                mState->insert(request, std::move(copy));
+            }
+        }
+    }
+
+    prefetchNextTile(request);
+    mLastRequest = request;
+    return true;
+}
+
+void CachingRegionDecoder::prefetchNextTile(const Request& request) {
+    if (!mLastRequest) {
+        return;
+    }
+    const SkIRect& last = mLastRequest->subset;
+    const SkIRect& current = request.subset;
+    Request lastWithCurrentSubset = *mLastRequest;
+    lastWithCurrentSubset.subset = current;
+    if (current.size() != last.size() || !(lastWithCurrentSubset == request)) {
+        return;
+    }
+
+    // Only predict when the caller stepped exactly one tile left, right, up or down.
+    const int dx = current.x() - last.x();
+    const int dy = current.y() - last.y();
+    const bool horizontalStep = dy == 0 && std::abs(dx) == current.width();
+    const bool verticalStep = dx == 0 && std::abs(dy) == current.height();
+    if (!horizontalStep && !verticalStep) {
+        return;
+    }
+
+    Request next = request;
+    next.subset = current.makeOffset(dx, dy);
+    if (SkIRect::Intersects(next.subset, SkIRect::MakeWH(mDecoder->width(), mDecoder->height()))) {
+        prefetchRegion(next);
+    }
+}
+
+void CachingRegionDecoder::prefetchRegion(const Request& request) {
+    {
+        std::lock_guard lock(mState->lock);
+        if (mState->pending.size() >= kMaxPendingPrefetches || mState->isPending(request) ||
+            mState->find(request)) {
+            return;
+        }
+        mState->pending.push_back(request);
+    }
+
+    std::shared_ptr<State> state = mState;
+    uirenderer::CommonPool::post(
+            [state, request]() {
+                ATRACE_NAME("BitmapRegionDecoder prefetch");
+                std::unique_ptr<skia::BitmapRegionDecoder> decoder;
+                {
+                    std::lock_guard lock(state->lock);
+                    if (!state->idleDecoders.empty()) {
+                        decoder = std::move(state->idleDecoders.back());
+                        state->idleDecoders.pop_back();
+                    }
+                }
+                if (!decoder) {
+                    decoder = skia::BitmapRegionDecoder::Make(state->data);
+                }
+
+                SkBitmap bitmap;
+                CacheAllocator allocator;
+                const bool decoded =
+                        decoder && decoder->decodeRegion(&bitmap, &allocator, request.subset,
+                                                         request.sampleSize, request.colorType,
+                                                         request.requireUnpremul,
+                                                         request.colorSpace);
+
+                std::lock_guard lock(state->lock);
+                if (decoded && !state->find(request)) {
+                    bitmap.setImmutable();
+                    state->insert(request, std::move(bitmap));
+                }
+                state->pending.erase(
+                        std::find(state->pending.begin(), state->pending.end(), request));
+                if (decoder) {
+                    state->idleDecoders.push_back(std::move(decoder));
+                }
+            },
+            uirenderer::CommonPool::Priority::Background);
+}
+
+}  // namespace android
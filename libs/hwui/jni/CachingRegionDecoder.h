@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ANDROID_GRAPHICS_CACHING_REGION_DECODER_H_
+#define _ANDROID_GRAPHICS_CACHING_REGION_DECODER_H_
+
+#include "BitmapRegionDecoder.h"
+#include "SkBitmap.h"
+#include "SkColorSpace.h"
+#include "SkData.h"
+#include "SkRect.h"
+
+#include <memory>
+#include <optional>
+
+namespace android {
+
+/**
+ * The native object behind android.graphics.BitmapRegionDecoder. Wraps a
+ * skia::BitmapRegionDecoder with a cache of recently decoded regions, so that tiles requested
+ * again while panning are copied instead of decoded. When requests walk across the image one
+ * tile at a time, the next tile in that direction is prefetched into the cache on a background
+ * thread, with its own decoder, while the caller handles the tile it just got.
+ */
+class CachingRegionDecoder {
+public:
+    struct Request {
+        SkIRect subset;
+        int sampleSize;
+        SkColorType colorType;
+        bool requireUnpremul;
+        sk_sp<SkColorSpace> colorSpace;
+
+        bool operator==(const Request& other) const;
+    };
+
+    // The cache holds at most this many bytes of decoded pixels per decoder.
+    static constexpr size_t kMaxCacheBytes = 16 * 1024 * 1024;
+
+    static std::unique_ptr<CachingRegionDecoder> Make(sk_sp<SkData> data);
+
+    ~CachingRegionDecoder();
+
+    // The decoder used for the caller's own requests, e.g. to query the image's properties.
+    skia::BitmapRegionDecoder* decoder() const { return mDecoder.get(); }
+
+    // Same as skia::BitmapRegionDecoder::decodeRegion, but served from the cache if possible.
+    bool decodeRegion(SkBitmap* bitmap, skia::BRDAllocator* allocator, const Request& request);
+
+private:
+    struct State;
+
+    CachingRegionDecoder(std::unique_ptr<skia::BitmapRegionDecoder> decoder, sk_sp<SkData> data);
+
+    // Decodes the request into the cache on a CommonPool thread.
+    void prefetchRegion(const Request& request);
+    void prefetchNextTile(const Request& request);
+
+    std::unique_ptr<skia::BitmapRegionDecoder> mDecoder;
+    // Shared with the prefetch tasks, which may outlive this object.
+    std::shared_ptr<State> mState;
+    std::optional<Request> mLastRequest;
+};
+
+}  // namespace android
+
+#endif  // _ANDROID_GRAPHICS_CACHING_REGION_DECODER_H_
@@ -24,6 +24,7 @@ namespace android {
 namespace skia {
     class BitmapRegionDecoder;
 }
+class CachingRegionDecoder;
 class Canvas;
 class Paint;
 struct Typeface;
@@ -120,7 +121,7 @@ public:
     static jobject createRegion(JNIEnv* env, SkRegion* region);
 
     static jobject createBitmapRegionDecoder(JNIEnv* env,
-                                             android::skia::BitmapRegionDecoder* bitmap);
+                                             android::CachingRegionDecoder* bitmap);
 
     /**
      * Given a bitmap we natively allocate a memory block to store the contents
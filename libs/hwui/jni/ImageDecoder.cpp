@@ -26,6 +26,7 @@
 #include <hwui/Bitmap.h>
 #include <hwui/ImageDecoder.h>
 #include <HardwareBitmapUploader.h>
+#include <Properties.h>
 
 #include <FrontBufferedStream.h>
 #include <SkAndroidCodec.h>
@@ -318,21 +319,41 @@ static jobject ImageDecoder_nDecodeBitmap(JNIEnv* env, jobject /*clazz*/, jlong
         return nullptr;
     }
 
-    sk_sp<Bitmap> nativeBitmap;
-    if (allocator == kSharedMemory_Allocator) {
-        nativeBitmap = Bitmap::allocateAshmemBitmap(&bm);
-    } else {
-        nativeBitmap = Bitmap::allocateHeapBitmap(&bm);
-    }
-    if (!nativeBitmap) {
-        SkString msg;
-        msg.printf("OOM allocating Bitmap with dimensions %i x %i",
-                bitmapInfo.width(), bitmapInfo.height());
-        doThrowOOME(env, msg.c_str());
-        return nullptr;
+    SkCodec::Result result = SkCodec::kInternalError;
+    bool decodeFailed = false;
+    sk_sp<Bitmap> hwBitmap;
+#ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
+    if (isHardware && !jpostProcess && uirenderer::Properties::isDirectHardwareDecodeEnabled()) {
+        // Decode straight into the buffer backing the hardware bitmap, skipping the upload.
+        hwBitmap = uirenderer::HardwareBitmapUploader::allocateHardwareBitmap(
+                bitmapInfo, [&](const SkPixmap& pixmap) {
+                    result = decoder->decode(pixmap.writable_addr(), pixmap.rowBytes());
+                    decodeFailed = result != SkCodec::kSuccess &&
+                                   result != SkCodec::kIncompleteInput &&
+                                   result != SkCodec::kErrorInInput;
+                    return !decodeFailed;
+                });
     }
+#endif
 
-    SkCodec::Result result = decoder->decode(bm.getPixels(), bm.rowBytes());
+    // Unless the decode itself failed, fall back to decoding into a heap or ashmem bitmap.
+    sk_sp<Bitmap> nativeBitmap;
+    if (!hwBitmap && !decodeFailed) {
+        if (allocator == kSharedMemory_Allocator) {
+            nativeBitmap = Bitmap::allocateAshmemBitmap(&bm);
+        } else {
+            nativeBitmap = Bitmap::allocateHeapBitmap(&bm);
+        }
+        if (!nativeBitmap) {
+            SkString msg;
+            msg.printf("OOM allocating Bitmap with dimensions %i x %i",
+                    bitmapInfo.width(), bitmapInfo.height());
+            doThrowOOME(env, msg.c_str());
+            return nullptr;
+        }
+
+        result = decoder->decode(bm.getPixels(), bm.rowBytes());
+    }
     jthrowable jexception = get_and_clear_exception(env);
     int onPartialImageError = jexception ? kSourceException
                                          : 0; // No error.
@@ -443,7 +464,9 @@ static jobject ImageDecoder_nDecodeBitmap(JNIEnv* env, jobject /*clazz*/, jlong
         bitmapCreateFlags |= bitmap::kBitmapCreateFlag_Mutable;
     } else {
         if (isHardware) {
-            sk_sp<Bitmap> hwBitmap = Bitmap::allocateHardwareBitmap(bm);
+            if (!hwBitmap) {
+                hwBitmap = Bitmap::allocateHardwareBitmap(bm);
+            }
             if (hwBitmap) {
                 hwBitmap->setImmutable();
                 return bitmap::createBitmap(env, hwBitmap.release(), bitmapCreateFlags,
@@ -163,7 +163,8 @@ static void Typeface_registerGenericFamily(JNIEnv *env, jobject, jstring familyN
 
 static bool getVerity(const std::string& path) {
     struct statx out = {};
-    if (statx(AT_FDCWD, path.c_str(), 0 /* flags */, STATX_ALL, &out) != 0) {
+    // Only the attributes are read below, which don't depend on the mask.
+    if (statx(AT_FDCWD, path.c_str(), 0 /* flags */, STATX_TYPE, &out) != 0) {
         ALOGE("statx failed for %s, errno = %d", path.c_str(), errno);
         return false;
     }
@@ -192,13 +193,15 @@ static sk_sp<SkData> makeSkDataCached(const std::string& path, bool hasVerity) {
     static std::unordered_map<std::string, sk_sp<SkData>> cache;
     static std::mutex mutex;
     ALOG_ASSERT(!path.empty());
-    if (hasVerity && !getVerity(path)) {
-        LOG_ALWAYS_FATAL("verity bit was removed from %s", path.c_str());
-        return nullptr;
-    }
     std::lock_guard lock{mutex};
     sk_sp<SkData>& entry = cache[path];
     if (entry.get() == nullptr) {
+        // A variable font is loaded once per named instance, all from the same file. The mapping
+        // is of the file that was checked here, so later loads need not check it again.
+        if (hasVerity && !getVerity(path)) {
+            LOG_ALWAYS_FATAL("verity bit was removed from %s", path.c_str());
+            return nullptr;
+        }
         entry = SkData::MakeFromFileName(path.c_str());
     }
     return entry;
@@ -6,6 +6,24 @@
 
 #include "graphics_jni_helpers.h"
 
+#include <algorithm>
+#include <future>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef __ANDROID__ // Layoutlib does not support CommonPool
+#include <thread/CommonPool.h>
+
+using android::uirenderer::CommonPool;
+#endif
+
+// Smaller images are encoded on the calling thread, as splitting them doesn't pay off.
+static constexpr int kMinParallelPixels = 1024 * 1024;
+// Each stripe holds at least this many rows of MCUs.
+static constexpr int kMinStripeMcuRows = 8;
+
 YuvToJpegEncoder* YuvToJpegEncoder::create(int format, int* strides) {
     // Only ImageFormat.NV21 and ImageFormat.YUY2 are supported
     // for now.
@@ -34,6 +52,23 @@ void error_exit(j_common_ptr cinfo) {
 
 bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
         int height, int* offsets, int jpegQuality) {
+#ifdef __ANDROID__ // Layoutlib does not support CommonPool
+    if (width * height >= kMinParallelPixels) {
+        const int mcuRows = (height + kMcuSize - 1) / kMcuSize;
+        const int stripeCount = std::min(CommonPool::getThreadCount(),
+                                         mcuRows / kMinStripeMcuRows);
+        if (stripeCount > 1) {
+            return encodeStripes(stream, (uint8_t*) inYuv, width, height, stripeCount, offsets,
+                                 jpegQuality);
+        }
+    }
+#endif
+    return encodeStripe(stream, (uint8_t*) inYuv, width, height, 0, height, offsets,
+                        jpegQuality);
+}
+
+bool YuvToJpegEncoder::encodeStripe(SkWStream* stream, uint8_t* yuv, int width, int height,
+        int startRow, int rowCount, int* offsets, int jpegQuality) {
     jpeg_compress_struct    cinfo;
     ErrorMgr                err;
     skjpeg_destination_mgr  sk_wstream(stream);
@@ -49,11 +84,11 @@ bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
 
     cinfo.dest = &sk_wstream;
 
-    setJpegCompressStruct(&cinfo, width, height, jpegQuality);
+    setJpegCompressStruct(&cinfo, width, rowCount, jpegQuality);
 
     jpeg_start_compress(&cinfo, TRUE);
 
-    compress(&cinfo, (uint8_t*) inYuv, offsets);
+    compress(&cinfo, yuv, offsets, startRow, height);
 
     jpeg_finish_compress(&cinfo);
 
@@ -62,6 +97,114 @@ bool YuvToJpegEncoder::encode(SkWStream* stream, void* inYuv, int width,
     return true;
 }
 
+bool YuvToJpegEncoder::encodeStripes(SkWStream* stream, uint8_t* yuv, int width, int height,
+        int stripeCount, int* offsets, int jpegQuality) {
+#ifdef __ANDROID__ // Layoutlib does not support CommonPool
+    // Every stripe but the last is a whole number of MCU rows, so that the stripes can follow each
+    // other in one scan, separated by restart markers. libjpeg resets the DC predictors of a new
+    // image just like a decoder does after a restart marker, and pads the end of the entropy
+    // coded data the same way, so each stripe's data can be used as is.
+    const int mcuRows = (height + kMcuSize - 1) / kMcuSize;
+    const int stripeRows = (mcuRows + stripeCount - 1) / stripeCount * kMcuSize;
+    const int restartInterval = stripeRows / kMcuSize * ((width + kMcuSize - 1) / kMcuSize);
+    if (restartInterval > 0xFFFF) {
+        return encodeStripe(stream, yuv, width, height, 0, height, offsets, jpegQuality);
+    }
+    stripeCount = (height + stripeRows - 1) / stripeRows;
+
+    auto encodeOne = [=](int stripe) -> sk_sp<SkData> {
+        const int startRow = stripe * stripeRows;
+        SkDynamicMemoryWStream output;
+        if (!encodeStripe(&output, yuv, width, height, startRow,
+                          std::min(stripeRows, height - startRow), offsets, jpegQuality)) {
+            return nullptr;
+        }
+        return output.detachAsData();
+    };
+
+    std::vector<std::future<sk_sp<SkData>>> pending;
+    for (int stripe = 1; stripe < stripeCount; stripe++) {
+        pending.push_back(CommonPool::async([&encodeOne, stripe]() { return encodeOne(stripe); }));
+    }
+    std::vector<sk_sp<SkData>> stripes;
+    stripes.push_back(encodeOne(0));
+    for (auto& future : pending) {
+        stripes.push_back(future.get());
+    }
+    for (const auto& data : stripes) {
+        if (data == nullptr) {
+            return false;
+        }
+    }
+    return writeJoinedStripes(stream, stripes, height, restartInterval);
+#else
+    return false;
+#endif
+}
+
+// Finds the height field of the frame header and the start of the entropy coded data in a JPEG
+// written by libjpeg.
+static bool findScanData(const uint8_t* data, size_t size, size_t* outHeightOffset,
+        size_t* outHeaderEnd, size_t* outScanStart) {
+    // Skip SOI, and expect EOI at the end.
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8 || data[size - 2] != 0xFF ||
+            data[size - 1] != 0xD9) {
+        return false;
+    }
+    size_t offset = 2;
+    *outHeightOffset = 0;
+    while (offset + 4 <= size && data[offset] == 0xFF) {
+        const uint8_t marker = data[offset + 1];
+        const size_t length = (data[offset + 2] << 8) | data[offset + 3];
+        if (marker == 0xC0 || marker == 0xC1) {
+            // Length, then the sample precision, then the height.
+            *outHeightOffset = offset + 5;
+        } else if (marker == 0xDA) {
+            *outHeaderEnd = offset;
+            *outScanStart = offset + 2 + length;
+            return *outHeightOffset != 0 && *outScanStart <= size - 2;
+        }
+        offset += 2 + length;
+    }
+    return false;
+}
+
+bool YuvToJpegEncoder::writeJoinedStripes(SkWStream* stream,
+        const std::vector<sk_sp<SkData>>& stripes, int height, int restartInterval) {
+    for (size_t i = 0; i < stripes.size(); i++) {
+        const uint8_t* data = stripes[i]->bytes();
+        const size_t size = stripes[i]->size();
+        size_t heightOffset, headerEnd, scanStart;
+        if (!findScanData(data, size, &heightOffset, &headerEnd, &scanStart)) {
+            ALOGE("Failed to find the scan of JPEG stripe %zu", i);
+            return false;
+        }
+
+        bool written;
+        if (i == 0) {
+            // The headers of the first stripe, made to describe the whole image, and a restart
+            // interval of one stripe.
+            const uint8_t heightBytes[] = {(uint8_t) (height >> 8), (uint8_t) height};
+            const uint8_t restart[] = {0xFF, 0xDD, 0x00, 0x04, (uint8_t) (restartInterval >> 8),
+                                       (uint8_t) restartInterval};
+            written = stream->write(data, heightOffset) &&
+                    stream->write(heightBytes, sizeof(heightBytes)) &&
+                    stream->write(data + heightOffset + 2, headerEnd - heightOffset - 2) &&
+                    stream->write(restart, sizeof(restart)) &&
+                    stream->write(data + headerEnd, size - 2 - headerEnd);
+        } else {
+            const uint8_t marker[] = {0xFF, (uint8_t) (0xD0 + ((i - 1) & 7))};
+            written = stream->write(marker, sizeof(marker)) &&
+                    stream->write(data + scanStart, size - 2 - scanStart);
+        }
+        if (!written) {
+            return false;
+        }
+    }
+    const uint8_t eoi[] = {0xFF, 0xD9};
+    return stream->write(eoi, sizeof(eoi));
+}
+
 void YuvToJpegEncoder::setJpegCompressStruct(jpeg_compress_struct* cinfo,
         int width, int height, int quality) {
     cinfo->image_width = width;
@@ -84,7 +227,7 @@ Yuv420SpToJpegEncoder::Yuv420SpToJpegEncoder(int* strides) :
 }
 
 void Yuv420SpToJpegEncoder::compress(jpeg_compress_struct* cinfo,
-        uint8_t* yuv, int* offsets) {
+        uint8_t* yuv, int* offsets, int startRow, int height) {
     ALOGD("onFlyCompress");
     JSAMPROW y[16];
     JSAMPROW cb[8];
@@ -95,7 +238,6 @@ void Yuv420SpToJpegEncoder::compress(jpeg_compress_struct* cinfo,
     planes[2] = cr;
 
     int width = cinfo->image_width;
-    int height = cinfo->image_height;
     uint8_t* yPlanar = yuv + offsets[0];
     uint8_t* vuPlanar = yuv + offsets[1]; //width * height;
     uint8_t* uRows = new uint8_t [8 * (width >> 1)];
@@ -104,13 +246,14 @@ void Yuv420SpToJpegEncoder::compress(jpeg_compress_struct* cinfo,
 
     // process 16 lines of Y and 8 lines of U/V each time.
     while (cinfo->next_scanline < cinfo->image_height) {
+        const int row = startRow + cinfo->next_scanline;
         //deitnerleave u and v
-        deinterleave(vuPlanar, uRows, vRows, cinfo->next_scanline, width, height);
+        deinterleave(vuPlanar, uRows, vRows, row, width, height);
 
         // Jpeg library ignores the rows whose indices are greater than height.
         for (int i = 0; i < 16; i++) {
             // y row
-            y[i] = yPlanar + (cinfo->next_scanline + i) * fStrides[0];
+            y[i] = yPlanar + (row + i) * fStrides[0];
 
             // construct u row and v row
             if ((i & 1) == 0) {
@@ -134,11 +277,19 @@ void Yuv420SpToJpegEncoder::deinterleave(uint8_t* vuPlanar, uint8_t* uRows,
     for (int row = 0; row < numRows; ++row) {
         int offset = ((rowIndex >> 1) + row) * fStrides[1];
         uint8_t* vu = vuPlanar + offset;
-        for (int i = 0; i < (width >> 1); ++i) {
-            int index = row * (width >> 1) + i;
-            uRows[index] = vu[1];
-            vRows[index] = vu[0];
-            vu += 2;
+        uint8_t* u = uRows + row * (width >> 1);
+        uint8_t* v = vRows + row * (width >> 1);
+        int i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+        for (; i + 16 <= (width >> 1); i += 16) {
+            const uint8x16x2_t vuPixels = vld2q_u8(vu + (i << 1));
+            vst1q_u8(v + i, vuPixels.val[0]);
+            vst1q_u8(u + i, vuPixels.val[1]);
+        }
+#endif
+        for (; i < (width >> 1); ++i) {
+            u[i] = vu[(i << 1) + 1];
+            v[i] = vu[i << 1];
         }
     }
 }
@@ -160,7 +311,7 @@ Yuv422IToJpegEncoder::Yuv422IToJpegEncoder(int* strides) :
 }
 
 void Yuv422IToJpegEncoder::compress(jpeg_compress_struct* cinfo,
-        uint8_t* yuv, int* offsets) {
+        uint8_t* yuv, int* offsets, int startRow, int height) {
     ALOGD("onFlyCompress_422");
     JSAMPROW y[16];
     JSAMPROW cb[16];
@@ -171,7 +322,6 @@ void Yuv422IToJpegEncoder::compress(jpeg_compress_struct* cinfo,
     planes[2] = cr;
 
     int width = cinfo->image_width;
-    int height = cinfo->image_height;
     uint8_t* yRows = new uint8_t [16 * width];
     uint8_t* uRows = new uint8_t [16 * (width >> 1)];
     uint8_t* vRows = new uint8_t [16 * (width >> 1)];
@@ -180,7 +330,8 @@ void Yuv422IToJpegEncoder::compress(jpeg_compress_struct* cinfo,
 
     // process 16 lines of Y and 16 lines of U/V each time.
     while (cinfo->next_scanline < cinfo->image_height) {
-        deinterleave(yuvOffset, yRows, uRows, vRows, cinfo->next_scanline, width, height);
+        deinterleave(yuvOffset, yRows, uRows, vRows, startRow + cinfo->next_scanline, width,
+                height);
 
         // Jpeg library ignores the rows whose indices are greater than height.
         for (int i = 0; i < 16; i++) {
@@ -208,14 +359,25 @@ void Yuv422IToJpegEncoder::deinterleave(uint8_t* yuv, uint8_t* yRows, uint8_t* u
     if (numRows > 16) numRows = 16;
     for (int row = 0; row < numRows; ++row) {
         uint8_t* yuvSeg = yuv + (rowIndex + row) * fStrides[0];
-        for (int i = 0; i < (width >> 1); ++i) {
-            int indexY = row * width + (i << 1);
-            int indexU = row * (width >> 1) + i;
-            yRows[indexY] = yuvSeg[0];
-            yRows[indexY + 1] = yuvSeg[2];
-            uRows[indexU] = yuvSeg[1];
-            vRows[indexU] = yuvSeg[3];
-            yuvSeg += 4;
+        uint8_t* y = yRows + row * width;
+        uint8_t* u = uRows + row * (width >> 1);
+        uint8_t* v = vRows + row * (width >> 1);
+        int i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+        for (; i + 16 <= (width >> 1); i += 16) {
+            // Y0 U Y1 V for every two pixels.
+            const uint8x16x4_t yuyv = vld4q_u8(yuvSeg + (i << 2));
+            const uint8x16x2_t yPixels = {{yuyv.val[0], yuyv.val[2]}};
+            vst2q_u8(y + (i << 1), yPixels);
+            vst1q_u8(u + i, yuyv.val[1]);
+            vst1q_u8(v + i, yuyv.val[3]);
+        }
+#endif
+        for (; i < (width >> 1); ++i) {
+            y[i << 1] = yuvSeg[i << 2];
+            y[(i << 1) + 1] = yuvSeg[(i << 2) + 2];
+            u[i] = yuvSeg[(i << 2) + 1];
+            v[i] = yuvSeg[(i << 2) + 3];
         }
     }
 }
@@ -1,8 +1,11 @@
 #ifndef _ANDROID_GRAPHICS_YUV_TO_JPEG_ENCODER_H_
 #define _ANDROID_GRAPHICS_YUV_TO_JPEG_ENCODER_H_
 
+#include "SkData.h"
 #include "SkTypes.h"
 #include "SkStream.h"
+
+#include <vector>
 extern "C" {
     #include "jpeglib.h"
     #include "jerror.h"
@@ -36,13 +39,29 @@ public:
     virtual ~YuvToJpegEncoder() {}
 
 protected:
+    // Both encoders sample chroma in 16x16 MCUs.
+    static constexpr int kMcuSize = 16;
+
     int fNumPlanes;
     int* fStrides;
     void setJpegCompressStruct(jpeg_compress_struct* cinfo, int width,
             int height, int quality);
     virtual void configSamplingFactors(jpeg_compress_struct* cinfo) = 0;
+    /** Feeds the rows [startRow, startRow + cinfo->image_height) of the image to cinfo.
+     *  height is the height of the whole image.
+     */
     virtual void compress(jpeg_compress_struct* cinfo,
-            uint8_t* yuv, int* offsets) = 0;
+            uint8_t* yuv, int* offsets, int startRow, int height) = 0;
+
+private:
+    /** Encodes the rows [startRow, startRow + rowCount) as a JPEG of their own. */
+    bool encodeStripe(SkWStream* stream, uint8_t* yuv, int width, int height,
+            int startRow, int rowCount, int* offsets, int jpegQuality);
+    /** Encodes stripes of the image in parallel and joins them with restart markers. */
+    bool encodeStripes(SkWStream* stream, uint8_t* yuv, int width, int height,
+            int stripeCount, int* offsets, int jpegQuality);
+    static bool writeJoinedStripes(SkWStream* stream, const std::vector<sk_sp<SkData>>& stripes,
+            int height, int restartInterval);
 };
 
 class Yuv420SpToJpegEncoder : public YuvToJpegEncoder {
@@ -56,7 +75,8 @@ private:
             uint8_t*& yPlanar, uint8_t*& uPlanar, uint8_t*& vPlanar);
     void deinterleave(uint8_t* vuPlanar, uint8_t* uRows, uint8_t* vRows,
             int rowIndex, int width, int height);
-    void compress(jpeg_compress_struct* cinfo, uint8_t* yuv, int* offsets);
+    void compress(jpeg_compress_struct* cinfo, uint8_t* yuv, int* offsets, int startRow,
+            int height);
 };
 
 class Yuv422IToJpegEncoder : public YuvToJpegEncoder {
@@ -66,7 +86,8 @@ public:
 
 private:
     void configSamplingFactors(jpeg_compress_struct* cinfo);
-    void compress(jpeg_compress_struct* cinfo, uint8_t* yuv, int* offsets);
+    void compress(jpeg_compress_struct* cinfo, uint8_t* yuv, int* offsets, int startRow,
+            int height);
     void deinterleave(uint8_t* yuv, uint8_t* yRows, uint8_t* uRows,
             uint8_t* vRows, int rowIndex, int width, int height);
 };
@@ -62,7 +62,11 @@ static jboolean android_graphics_Picture_serialize(JNIEnv* env, jobject, jlong p
     SkWStream* strm = CreateJavaOutputStreamAdaptor(env, jstream, jstorage);
 
     if (NULL != strm) {
-        picture->serialize(strm);
+        // SkPicture writes a few bytes at a time, and every write to the adaptor is a call into
+        // the Java OutputStream. Collect the data first and hand it over in large chunks.
+        SkDynamicMemoryWStream buffer;
+        picture->serialize(&buffer);
+        buffer.writeToStream(strm);
         delete strm;
         return JNI_TRUE;
     }
@@ -77,11 +77,6 @@ static void nativeRenderPage(JNIEnv* env, jclass thiz, jlong documentPtr, jlong
     SkBitmap skBitmap;
     bitmap::toBitmap(bitmapPtr).getSkBitmap(&skBitmap);
 
-    const int stride = skBitmap.width() * 4;
-
-    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(skBitmap.width(), skBitmap.height(),
-            FPDFBitmap_BGRA, skBitmap.getPixels(), stride);
-
     int renderFlags = FPDF_REVERSE_BYTE_ORDER;
     if (renderMode == RENDER_MODE_FOR_DISPLAY) {
         renderFlags |= FPDF_LCD_TEXT;
@@ -104,8 +99,17 @@ static void nativeRenderPage(JNIEnv* env, jclass thiz, jlong documentPtr, jlong
 
     FS_RECTF clip = {(float) clipLeft, (float) clipTop, (float) clipRight, (float) clipBottom};
 
+    // Wraps the pixels of the bitmap without copying them. PDFium only rasterizes the parts of the
+    // page that fall inside the clip, so callers that render tiles or a damaged area should pass
+    // that area as the clip rather than render the whole page.
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(skBitmap.width(), skBitmap.height(),
+            FPDFBitmap_BGRA, skBitmap.getPixels(), skBitmap.rowBytes());
+
     FPDF_RenderPageBitmapWithMatrix(bitmap, page, &transform, &clip, renderFlags);
 
+    // Frees the wrapper only, the pixels belong to the bitmap.
+    FPDFBitmap_Destroy(bitmap);
+
     skBitmap.notifyPixelsChanged();
 }
 
@@ -18,6 +18,7 @@
 #include <SkPaintFilterCanvas.h>
 #include <gui/TraceUtils.h>
 #include "RenderNode.h"
+#include "RenderNodeProfiler.h"
 #include "SkiaDisplayList.h"
 #include "StretchMask.h"
 #include "TransformCanvas.h"
@@ -209,6 +210,7 @@ private:
 
 void RenderNodeDrawable::drawContent(SkCanvas* canvas) const {
     RenderNode* renderNode = mRenderNode.get();
+    ScopedRenderNodeProfile _profile{*renderNode};
     float alphaMultiplier = 1.0f;
     const RenderProperties& properties = renderNode->properties();
 
@@ -224,7 +226,6 @@ void RenderNodeDrawable::drawContent(SkCanvas* canvas) const {
     // TODO should we let the bound of the drawable do this for us?
     const SkRect bounds = SkRect::MakeWH(properties.getWidth(), properties.getHeight());
     bool quickRejected = properties.getClipToBounds() && canvas->quickReject(bounds);
-    auto clipBounds = canvas->getLocalClipBounds();
     SkIRect srcBounds = SkIRect::MakeWH(bounds.width(), bounds.height());
     SkIPoint offset = SkIPoint::Make(0.0f, 0.0f);
     if (!quickRejected) {
@@ -233,6 +234,9 @@ void RenderNodeDrawable::drawContent(SkCanvas* canvas) const {
         // composing a hardware layer
         if (renderNode->getLayerSurface() && mComposeLayer) {
             SkASSERT(properties.effectiveLayerType() == LayerType::RenderLayer);
+            // Mapping the clip back to local space inverts the total matrix, so only do it for
+            // the layers whose image filters need it rather than for every node drawn.
+            auto clipBounds = canvas->getLocalClipBounds();
             SkPaint paint;
             layerNeedsPaint(layerProperties, alphaMultiplier, &paint);
             sk_sp<SkImage> snapshotImage;
@@ -320,8 +324,8 @@ void RenderNodeDrawable::drawContent(SkCanvas* canvas) const {
                                      canvas);
                 }
 
-                sk_sp<SkShader> stretchShader =
-                        stretch.getShader(bounds.width(), bounds.height(), snapshotImage, &matrix);
+                sk_sp<SkShader> stretchShader = renderNode->getStretchShaderCache().getShader(
+                        stretch, bounds.width(), bounds.height(), snapshotImage, &matrix);
                 paint.setShader(stretchShader);
                 canvas->drawRect(SkRect::Make(dstBounds), paint);
             }
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RenderNodeProfiler.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "Properties.h"
+#include "RenderNode.h"
+
+namespace android {
+namespace uirenderer {
+namespace skiapipeline {
+
+// Enough to find the expensive views without flooding the dump with every node of the hierarchy.
+static constexpr size_t kMaxDumpedNodes = 50;
+
+RenderNodeProfiler& RenderNodeProfiler::get() {
+    static RenderNodeProfiler* sProfiler = new RenderNodeProfiler();
+    return *sProfiler;
+}
+
+void RenderNodeProfiler::end(const RenderNode& node, nsecs_t duration) {
+    const nsecs_t childTime = mChildTime.back();
+    mChildTime.pop_back();
+    if (!mChildTime.empty()) {
+        mChildTime.back() += duration;
+    }
+
+    const nsecs_t selfTime = std::max<nsecs_t>(duration - childTime, 0);
+    Stats& stats = mStats[node.getName()];
+    stats.count++;
+    stats.totalTime += duration;
+    stats.selfTime += selfTime;
+    stats.maxSelfTime = std::max(stats.maxSelfTime, selfTime);
+}
+
+void RenderNodeProfiler::dump(int fd) const {
+    if (mStats.empty()) {
+        return;
+    }
+    std::vector<std::pair<const std::string*, const Stats*>> sorted;
+    sorted.reserve(mStats.size());
+    for (const auto& [name, stats] : mStats) {
+        sorted.emplace_back(&name, &stats);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second->selfTime > b.second->selfTime; });
+    if (sorted.size() > kMaxDumpedNodes) {
+        sorted.resize(kMaxDumpedNodes);
+    }
+
+    dprintf(fd, "\nRenderNode playback (%zu names, top %zu by self time):\n", mStats.size(),
+            sorted.size());
+    dprintf(fd, "  %12s %12s %12s %12s  %s\n", "Draws", "Self(ms)", "Total(ms)", "MaxSelf(us)",
+            "Name");
+    for (const auto& [name, stats] : sorted) {
+        dprintf(fd, "  %12" PRIu64 " %12.3f %12.3f %12.1f  %s\n", stats->count,
+                stats->selfTime / 1000000.0, stats->totalTime / 1000000.0,
+                stats->maxSelfTime / 1000.0, name->c_str());
+    }
+}
+
+void RenderNodeProfiler::reset() {
+    mStats.clear();
+}
+
+ScopedRenderNodeProfile::ScopedRenderNodeProfile(const RenderNode& node)
+        : mNode(node), mActive(Properties::profileRenderNodes) {
+    if (CC_UNLIKELY(mActive)) {
+        RenderNodeProfiler::get().begin();
+        mStart = systemTime(SYSTEM_TIME_MONOTONIC);
+    }
+}
+
+ScopedRenderNodeProfile::~ScopedRenderNodeProfile() {
+    if (CC_UNLIKELY(mActive)) {
+        RenderNodeProfiler::get().end(mNode, systemTime(SYSTEM_TIME_MONOTONIC) - mStart);
+    }
+}
+
+}  // namespace skiapipeline
+}  // namespace uirenderer
+}  // namespace android
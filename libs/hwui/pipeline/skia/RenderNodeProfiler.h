@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "utils/Macros.h"
+
+#include <utils/Timers.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace uirenderer {
+
+class RenderNode;
+
+namespace skiapipeline {
+
+/**
+ * Aggregates, across frames, the CPU time the render thread spends playing back the display list
+ * of each RenderNode, keyed by the name of the node. Self time excludes the child nodes drawn
+ * from the node's display list. Only used when Properties::profileRenderNodes is set.
+ *
+ * The time is that of issuing the node's ops to Skia. GPU work is deferred to the flush at the
+ * end of the frame and is not attributed to nodes.
+ *
+ * Must only be used on the render thread.
+ */
+class RenderNodeProfiler {
+    PREVENT_COPY_AND_ASSIGN(RenderNodeProfiler);
+
+public:
+    static RenderNodeProfiler& get();
+
+    void dump(int fd) const;
+    void reset();
+
+private:
+    friend class ScopedRenderNodeProfile;
+
+    struct Stats {
+        uint64_t count = 0;
+        nsecs_t totalTime = 0;
+        nsecs_t selfTime = 0;
+        nsecs_t maxSelfTime = 0;
+    };
+
+    RenderNodeProfiler() {}
+
+    void begin() { mChildTime.push_back(0); }
+    void end(const RenderNode& node, nsecs_t duration);
+
+    std::unordered_map<std::string, Stats> mStats;
+    // The time spent in the children of each node being drawn, innermost last.
+    std::vector<nsecs_t> mChildTime;
+};
+
+/**
+ * Adds the time spent during its lifetime to the stats of node. Does nothing unless
+ * Properties::profileRenderNodes is set.
+ */
+class ScopedRenderNodeProfile {
+    PREVENT_COPY_AND_ASSIGN(ScopedRenderNodeProfile);
+
+public:
+    explicit ScopedRenderNodeProfile(const RenderNode& node);
+    ~ScopedRenderNodeProfile();
+
+private:
+    const RenderNode& mNode;
+    // Latched, so that the property changing mid-frame can't unbalance the profiler.
+    const bool mActive;
+    nsecs_t mStart = 0;
+};
+
+}  // namespace skiapipeline
+}  // namespace uirenderer
+}  // namespace android
@@ -16,6 +16,7 @@
 
 #include "ShaderCache.h"
 #include <GrDirectContext.h>
+#include <android-base/properties.h>
 #include <gui/TraceUtils.h>
 #include <log/log.h>
 #include <openssl/sha.h>
@@ -75,6 +76,30 @@ bool ShaderCache::validateCache(const void* identity, ssize_t size) {
     return false;
 }
 
+void ShaderCache::loadSeedCacheLocked(bool hasIdentity) {
+    mSeedCache.reset();
+    if (!mSeedFilenameSet) {
+        mSeedFilename = base::GetProperty(PROPERTY_SHADER_SEED_CACHE, "");
+    }
+    // Without an identity there is no way to tell whether the seed was made by the same driver.
+    if (!hasIdentity || mSeedFilename.empty() || mSeedFilename == mFilename || mIDHash.empty()) {
+        return;
+    }
+
+    ATRACE_NAME("loadSeedCache");
+    std::unique_ptr<FileBlobCache> seed(
+            new FileBlobCache(maxKeySize, maxValueSize, maxTotalSize, mSeedFilename));
+    std::array<uint8_t, SHA256_DIGEST_LENGTH> hash;
+    auto key = sIDKey;
+    auto loaded = seed->get(&key, sizeof(key), hash.data(), hash.size());
+    if (loaded == hash.size() && std::equal(hash.begin(), hash.end(), mIDHash.begin())) {
+        mSeedCache = std::move(seed);
+    } else if (CC_UNLIKELY(Properties::debugLevel & kDebugCaches)) {
+        ALOGW("ShaderCache: ignoring seed cache %s with a different identity",
+              mSeedFilename.c_str());
+    }
+}
+
 void ShaderCache::initShaderDiskCache(const void* identity, ssize_t size) {
     ATRACE_NAME("initShaderDiskCache");
     std::lock_guard<std::mutex> lock(mMutex);
@@ -85,6 +110,7 @@ void ShaderCache::initShaderDiskCache(const void* identity, ssize_t size) {
     if (!Properties::runningInEmulator && mFilename.length() > 0) {
         mBlobCache.reset(new FileBlobCache(maxKeySize, maxValueSize, maxTotalSize, mFilename));
         validateCache(identity, size);
+        loadSeedCacheLocked(identity != nullptr && size > 0);
         mInitialized = true;
     }
 }
@@ -94,6 +120,12 @@ void ShaderCache::setFilename(const char* filename) {
     mFilename = filename;
 }
 
+void ShaderCache::setSeedFilename(const char* filename) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSeedFilename = filename;
+    mSeedFilenameSet = true;
+}
+
 BlobCache* ShaderCache::getBlobCacheLocked() {
     LOG_ALWAYS_FATAL_IF(!mInitialized, "ShaderCache has not been initialized");
     return mBlobCache.get();
@@ -101,19 +133,31 @@ BlobCache* ShaderCache::getBlobCacheLocked() {
 
 sk_sp<SkData> ShaderCache::load(const SkData& key) {
     ATRACE_NAME("ShaderCache::load");
-    size_t keySize = key.size();
     std::lock_guard<std::mutex> lock(mMutex);
     if (!mInitialized) {
         return nullptr;
     }
 
+    sk_sp<SkData> data = loadFromLocked(getBlobCacheLocked(), key);
+    if (!data && mSeedCache) {
+        data = loadFromLocked(mSeedCache.get(), key);
+    }
+    if (!data) {
+        return nullptr;
+    }
+    mNumShadersCachedInRam++;
+    ATRACE_FORMAT("HWUI RAM cache: %d shaders", mNumShadersCachedInRam);
+    return data;
+}
+
+sk_sp<SkData> ShaderCache::loadFromLocked(BlobCache* bc, const SkData& key) {
+    size_t keySize = key.size();
     // mObservedBlobValueSize is reasonably big to avoid memory reallocation
     // Allocate a buffer with malloc. SkData takes ownership of that allocation and will call free.
     void* valueBuffer = malloc(mObservedBlobValueSize);
     if (!valueBuffer) {
         return nullptr;
     }
-    BlobCache* bc = getBlobCacheLocked();
     size_t valueSize = bc->get(key.data(), keySize, valueBuffer, mObservedBlobValueSize);
     int maxTries = 3;
     while (valueSize > mObservedBlobValueSize && maxTries > 0) {
@@ -136,8 +180,6 @@ sk_sp<SkData> ShaderCache::load(const SkData& key) {
         free(valueBuffer);
         return nullptr;
     }
-    mNumShadersCachedInRam++;
-    ATRACE_FORMAT("HWUI RAM cache: %d shaders", mNumShadersCachedInRam);
     return SkData::MakeFromMalloc(valueBuffer, valueSize);
 }
 
@@ -179,11 +221,57 @@ void ShaderCache::saveToDiskLocked() {
             auto key = sIDKey;
             set(mBlobCache.get(), &key, sizeof(key), mIDHash.data(), mIDHash.size());
         }
+        // Don't race with a deferred save writing the same file, and keep a deferred save of
+        // an older snapshot from overwriting it afterwards.
+        const uint64_t generation = ++mSnapshotGeneration;
+        std::lock_guard<std::mutex> lock(mWriterMutex);
         mBlobCache->writeToFile();
+        mWrittenGeneration = generation;
     }
     mSavePending = false;
 }
 
+bool ShaderCache::snapshotLocked(std::vector<uint8_t>* outSnapshot, uint64_t* outGeneration) {
+    ATRACE_NAME("ShaderCache::snapshotLocked");
+    if (!mInitialized || !mBlobCache) {
+        return false;
+    }
+    if (mIDHash.size()) {
+        auto key = sIDKey;
+        set(mBlobCache.get(), &key, sizeof(key), mIDHash.data(), mIDHash.size());
+    }
+    outSnapshot->resize(mBlobCache->getFlattenedSize());
+    if (mBlobCache->flatten(outSnapshot->data(), outSnapshot->size()) < 0) {
+        ALOGE("ShaderCache: failed to flatten the cache for saving");
+        return false;
+    }
+    *outGeneration = ++mSnapshotGeneration;
+    return true;
+}
+
+void ShaderCache::writeSnapshot(const std::string& filename, const std::vector<uint8_t>& snapshot,
+                                uint64_t generation) {
+    ATRACE_NAME("ShaderCache::writeSnapshot");
+    std::lock_guard<std::mutex> lock(mWriterMutex);
+    if (generation < mWrittenGeneration) {
+        // A newer snapshot was saved since this one was taken.
+        return;
+    }
+    mWrittenGeneration = generation;
+    // The writer reads the existing file when created, so keep it around for later saves to the
+    // same file, but empty it in between.
+    if (!mDiskWriter || mDiskWriterFilename != filename) {
+        mDiskWriter.reset(new FileBlobCache(maxKeySize, maxValueSize, maxTotalSize, filename));
+        mDiskWriterFilename = filename;
+    }
+    if (mDiskWriter->unflatten(snapshot.data(), snapshot.size()) < 0) {
+        ALOGE("ShaderCache: failed to restore the cache snapshot for saving");
+    } else {
+        mDiskWriter->writeToFile();
+    }
+    mDiskWriter->clear();
+}
+
 void ShaderCache::store(const SkData& key, const SkData& data, const SkString& /*description*/) {
     ATRACE_NAME("ShaderCache::store");
     std::lock_guard<std::mutex> lock(mMutex);
@@ -228,14 +316,27 @@ void ShaderCache::store(const SkData& key, const SkData& data, const SkString& /
         mSavePending = true;
         std::thread deferredSaveThread([this]() {
             sleep(mDeferredSaveDelay);
-            std::lock_guard<std::mutex> lock(mMutex);
-            // Store file on disk if there a new shader or Vulkan pipeline cache size changed.
-            if (mCacheDirty || mNewPipelineCacheSize != mOldPipelineCacheSize) {
-                saveToDiskLocked();
+            std::vector<uint8_t> snapshot;
+            uint64_t generation = 0;
+            std::string filename;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                // Store file on disk if there a new shader or Vulkan pipeline cache size changed.
+                const bool needsSave =
+                        mCacheDirty || mNewPipelineCacheSize != mOldPipelineCacheSize;
+                if (!mSavePending || !needsSave || !snapshotLocked(&snapshot, &generation)) {
+                    mSavePending = false;
+                    return;
+                }
+                filename = mFilename;
+                mSavePending = false;
                 mOldPipelineCacheSize = mNewPipelineCacheSize;
                 mTryToStorePipelineCache = false;
                 mCacheDirty = false;
             }
+            // Writing the file takes much longer than copying the cache, so do it without holding
+            // mMutex to keep load() and store() from stalling the render thread meanwhile.
+            writeSnapshot(filename, snapshot, generation);
         });
         deferredSaveThread.detach();
     }
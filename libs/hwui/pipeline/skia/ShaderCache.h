@@ -63,6 +63,14 @@ public:
      */
     virtual void setFilename(const char* filename);
 
+    /**
+     * "setSeedFilename" sets the name of a read-only cache file that is looked up when an entry
+     * is missing from the app's own cache. The seed is only used if it was saved with the same
+     * identity as the one given to "initShaderDiskCache". By default it is read from the
+     * ro.hwui.shader_seed_cache property. It should be invoked before "initShaderCache".
+     */
+    virtual void setSeedFilename(const char* filename);
+
     /**
      * "load" attempts to retrieve the value blob associated with a given key
      * blob from cache.  This will be called by Skia, when it needs to compile a new SKSL shader.
@@ -104,6 +112,17 @@ private:
      */
     bool validateCache(const void* identity, ssize_t size);
 
+    /**
+     * "loadSeedCacheLocked" loads the seed cache, if there is one, hasIdentity is true and the
+     * seed's identity matches the identity hash of the app's cache.
+     */
+    void loadSeedCacheLocked(bool hasIdentity);
+
+    /**
+     * "loadFromLocked" returns the value stored for key in cache, or nullptr.
+     */
+    sk_sp<SkData> loadFromLocked(BlobCache* cache, const SkData& key);
+
     /**
      * "saveToDiskLocked" attemps to save the current contents of the cache to
      * disk. If the identity hash exists, we will insert the identity hash into
@@ -111,6 +130,20 @@ private:
      */
     void saveToDiskLocked();
 
+    /**
+     * "snapshotLocked" copies the current contents of the cache, including the identity hash,
+     * into outSnapshot so that they can be written to disk without holding mMutex. The generation
+     * of the snapshot is returned in outGeneration.
+     */
+    bool snapshotLocked(std::vector<uint8_t>* outSnapshot, uint64_t* outGeneration);
+
+    /**
+     * "writeSnapshot" writes a snapshot made by snapshotLocked to filename, unless a newer
+     * snapshot has already been written. It must be called without holding mMutex.
+     */
+    void writeSnapshot(const std::string& filename, const std::vector<uint8_t>& snapshot,
+                       uint64_t generation);
+
     /**
      * "mInitialized" indicates whether the ShaderCache is in the initialized
      * state.  It is initialized to false at construction time, and gets set to
@@ -130,6 +163,15 @@ private:
      */
     std::unique_ptr<FileBlobCache> mBlobCache;
 
+    /**
+     * "mSeedCache" holds the contents of the read-only seed file named "mSeedFilename". It is
+     * null if there is no seed file or the seed does not match the identity of the cache. It is
+     * never written to disk.
+     */
+    std::unique_ptr<FileBlobCache> mSeedCache;
+    std::string mSeedFilename;
+    bool mSeedFilenameSet = false;
+
     /**
      * "mFilename" is the name of the file for storing cache contents in between
      * program invocations.  It is initialized to an empty string at
@@ -173,6 +215,23 @@ private:
      */
     mutable std::mutex mMutex;
 
+    /**
+     * "mDiskWriter" writes the snapshots of deferred saves to "mDiskWriterFilename". It is empty
+     * in between saves. Both are guarded by "mWriterMutex", which also serializes all writes of
+     * the cache file. When both mutexes are needed, mMutex must be locked first.
+     */
+    std::unique_ptr<FileBlobCache> mDiskWriter;
+    std::string mDiskWriterFilename;
+    std::mutex mWriterMutex;
+
+    /**
+     * "mSnapshotGeneration" numbers the contents of the cache each time they are saved or
+     * snapshotted, and is guarded by mMutex. "mWrittenGeneration" is the newest generation written
+     * to disk, and is guarded by mWriterMutex.
+     */
+    uint64_t mSnapshotGeneration = 0;
+    uint64_t mWrittenGeneration = 0;
+
     /**
      *  If set to "true", the next call to onVkFrameFlushed, will invoke
      * GrCanvas::storeVkPipelineCacheData. This does not guarantee that data will be stored on disk.
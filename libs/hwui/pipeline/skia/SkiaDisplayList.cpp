@@ -59,6 +59,16 @@ bool SkiaDisplayList::reuseDisplayList(RenderNode* node) {
     return true;
 }
 
+bool SkiaDisplayList::hasSameContent(const SkiaDisplayList& other) const {
+    const auto isLeaf = [](const SkiaDisplayList& list) {
+        return list.mChildNodes.empty() && list.mChildFunctors.empty() &&
+               list.mMutableImages.empty() && list.mVectorDrawables.empty() &&
+               list.mAnimatedImages.empty() && !list.mProjectionReceiver;
+    };
+    return isLeaf(*this) && isLeaf(other) && mHasHolePunches == other.mHasHolePunches &&
+           mDisplayList.hasSameOps(other.mDisplayList);
+}
+
 void SkiaDisplayList::updateChildren(std::function<void(RenderNode*)> updateFn) {
     for (auto& child : mChildNodes) {
         updateFn(child.getRenderNode());
@@ -157,6 +167,9 @@ bool SkiaDisplayList::prepareListAndChildren(
             if (intersects(info.screenSize, totalMatrix, bounds)) {
                 isDirty = true;
                 vectorDrawable->setPropertyChangeWillBeConsumed(true);
+                if (info.dirtyVectorDrawables) {
+                    info.dirtyVectorDrawables->push_back(vectorDrawable);
+                }
             }
         }
     }
@@ -95,6 +95,13 @@ public:
 
     bool hasText() const { return mDisplayList.hasText(); }
 
+    /**
+     * Returns true if drawing this list is known to produce the same output as drawing other.
+     * Only lists without children, functors, mutable images, vector drawables or animated images
+     * are compared, as that content can change without the recorded ops changing.
+     */
+    bool hasSameContent(const SkiaDisplayList& other) const;
+
     /**
      * Attempts to reset and reuse this DisplayList.
      *
@@ -69,7 +69,7 @@ Frame SkiaOpenGLPipeline::getFrame() {
 }
 
 IRenderPipeline::DrawResult SkiaOpenGLPipeline::draw(
-        const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
+        const Frame& frame, const DamageRegion& screenDirty, const DamageRegion& dirty,
         const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
         const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
         const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler) {
@@ -130,8 +130,9 @@ IRenderPipeline::DrawResult SkiaOpenGLPipeline::draw(
     return {true, IRenderPipeline::DrawResult::kUnknownTime};
 }
 
-bool SkiaOpenGLPipeline::swapBuffers(const Frame& frame, bool drew, const SkRect& screenDirty,
-                                     FrameInfo* currentFrameInfo, bool* requireSwap) {
+bool SkiaOpenGLPipeline::swapBuffers(const Frame& frame, bool drew,
+                                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
+                                     bool* requireSwap) {
     GL_CHECKPOINT(LOW);
 
     // Even if we decided to cancel the frame, from the perspective of jank
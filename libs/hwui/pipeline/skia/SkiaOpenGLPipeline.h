@@ -37,7 +37,8 @@ public:
     renderthread::MakeCurrentResult makeCurrent() override;
     renderthread::Frame getFrame() override;
     renderthread::IRenderPipeline::DrawResult draw(const renderthread::Frame& frame,
-                                                   const SkRect& screenDirty, const SkRect& dirty,
+                                                   const DamageRegion& screenDirty,
+                                                   const DamageRegion& dirty,
                                                    const LightGeometry& lightGeometry,
                                                    LayerUpdateQueue* layerUpdateQueue,
                                                    const Rect& contentDrawBounds, bool opaque,
@@ -45,8 +46,9 @@ public:
                                                    const std::vector<sp<RenderNode> >& renderNodes,
                                                    FrameInfoVisualizer* profiler) override;
     GrSurfaceOrigin getSurfaceOrigin() override { return kBottomLeft_GrSurfaceOrigin; }
-    bool swapBuffers(const renderthread::Frame& frame, bool drew, const SkRect& screenDirty,
-                     FrameInfo* currentFrameInfo, bool* requireSwap) override;
+    bool swapBuffers(const renderthread::Frame& frame, bool drew,
+                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
+                     bool* requireSwap) override;
     DeferredLayerUpdater* createTextureLayer() override;
     bool setSurface(ANativeWindow* surface, renderthread::SwapBehavior swapBehavior) override;
     void onStop() override;
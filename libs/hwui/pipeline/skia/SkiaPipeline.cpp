@@ -24,6 +24,7 @@
 #include <SkOverdrawColorFilter.h>
 #include <SkPicture.h>
 #include <SkPictureRecorder.h>
+#include <SkRegion.h>
 #include <SkSerialProcs.h>
 #include <SkTypeface.h>
 #include <android-base/properties.h>
@@ -89,6 +90,19 @@ void SkiaPipeline::renderLayers(const LightGeometry& lightGeometry,
     layerUpdateQueue->clear();
 }
 
+// The device clip restriction only takes one rect, so when damage is made of several further
+// clip to those, mapped by matrix into device space.
+static void clipToDamage(SkCanvas* canvas, const DamageRegion& damage, const SkMatrix& matrix) {
+    if (damage.count() < 2) {
+        return;
+    }
+    SkRegion region;
+    for (const SkRect& rect : damage) {
+        region.op(matrix.mapRect(rect).roundOut(), SkRegion::kUnion_Op);
+    }
+    canvas->clipRegion(region);
+}
+
 void SkiaPipeline::renderLayersImpl(const LayerUpdateQueue& layers, bool opaque) {
     sk_sp<GrDirectContext> cachedContext;
 
@@ -116,6 +130,7 @@ void SkiaPipeline::renderLayersImpl(const LayerUpdateQueue& layers, bool opaque)
         SkASSERT(saveCount == 1);
 
         layerCanvas->androidFramework_setDeviceClipRestriction(layerDamage.toSkIRect());
+        clipToDamage(layerCanvas, layers.entries()[i].damageRegion, SkMatrix::I());
 
         // TODO: put localized light center calculation and storage to a drawable related code.
         // It does not seem right to store something localized in a global state
@@ -234,7 +249,7 @@ static void savePictureAsync(const sk_sp<SkData>& data, const std::string& filen
             ALOGD("SKP Captured Drawing Output (%zu bytes) for frame. %s", stream.bytesWritten(),
                      filename.c_str());
         }
-    });
+    }, CommonPool::Priority::Background);
 }
 
 // Note multiple SkiaPipeline instances may be loaded if more than one app is visible.
@@ -415,7 +430,7 @@ void SkiaPipeline::endCapture(SkSurface* surface) {
                 doc->close();
                 delete stream;
                 ALOGD("Multi frame SKP complete.");
-            });
+            }, CommonPool::Priority::Background);
         }
     } else {
         sk_sp<SkPicture> picture = mRecorder->finishRecordingAsPicture();
@@ -438,7 +453,7 @@ void SkiaPipeline::endCapture(SkSurface* surface) {
     }
 }
 
-void SkiaPipeline::renderFrame(const LayerUpdateQueue& layers, const SkRect& clip,
+void SkiaPipeline::renderFrame(const LayerUpdateQueue& layers, const DamageRegion& clip,
                                const std::vector<sp<RenderNode>>& nodes, bool opaque,
                                const Rect& contentDrawBounds, sk_sp<SkSurface> surface,
                                const SkMatrix& preTransform) {
@@ -472,12 +487,12 @@ static Rect nodeBounds(RenderNode& node) {
 }
 }  // namespace
 
-void SkiaPipeline::renderFrameImpl(const SkRect& clip,
+void SkiaPipeline::renderFrameImpl(const DamageRegion& clip,
                                    const std::vector<sp<RenderNode>>& nodes, bool opaque,
                                    const Rect& contentDrawBounds, SkCanvas* canvas,
                                    const SkMatrix& preTransform) {
     SkAutoCanvasRestore saver(canvas, true);
-    auto clipRestriction = preTransform.mapRect(clip).roundOut();
+    auto clipRestriction = preTransform.mapRect(clip.getBounds()).roundOut();
     if (CC_UNLIKELY(isCapturingSkp())) {
         canvas->drawAnnotation(SkRect::Make(clipRestriction), "AndroidDeviceClipRestriction",
             nullptr);
@@ -485,6 +500,7 @@ void SkiaPipeline::renderFrameImpl(const SkRect& clip,
         // clip drawing to dirty region only when not recording SKP files (which should contain all
         // draw ops on every frame)
         canvas->androidFramework_setDeviceClipRestriction(clipRestriction);
+        clipToDamage(canvas, clip, preTransform);
     }
     canvas->concat(preTransform);
 
@@ -643,7 +659,7 @@ static const SkColor kOverdrawColors[2][6] = {
     },
 };
 
-void SkiaPipeline::renderOverdraw(const SkRect& clip,
+void SkiaPipeline::renderOverdraw(const DamageRegion& clip,
                                   const std::vector<sp<RenderNode>>& nodes,
                                   const Rect& contentDrawBounds, sk_sp<SkSurface> surface,
                                   const SkMatrix& preTransform) {
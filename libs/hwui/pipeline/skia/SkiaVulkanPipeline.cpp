@@ -64,7 +64,7 @@ Frame SkiaVulkanPipeline::getFrame() {
 }
 
 IRenderPipeline::DrawResult SkiaVulkanPipeline::draw(
-        const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
+        const Frame& frame, const DamageRegion& screenDirty, const DamageRegion& dirty,
         const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
         const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
         const std::vector<sp<RenderNode>>& renderNodes, FrameInfoVisualizer* profiler) {
@@ -107,8 +107,9 @@ IRenderPipeline::DrawResult SkiaVulkanPipeline::draw(
     return {true, submissionTime};
 }
 
-bool SkiaVulkanPipeline::swapBuffers(const Frame& frame, bool drew, const SkRect& screenDirty,
-                                     FrameInfo* currentFrameInfo, bool* requireSwap) {
+bool SkiaVulkanPipeline::swapBuffers(const Frame& frame, bool drew,
+                                     const DamageRegion& screenDirty, FrameInfo* currentFrameInfo,
+                                     bool* requireSwap) {
     *requireSwap = drew;
 
     // Even if we decided to cancel the frame, from the perspective of jank
@@ -140,7 +141,8 @@ bool SkiaVulkanPipeline::setSurface(ANativeWindow* surface, SwapBehavior swapBeh
         mRenderThread.requireVkContext();
         mVkSurface =
                 vulkanManager().createSurface(surface, mColorMode, mSurfaceColorSpace,
-                                              mSurfaceColorType, mRenderThread.getGrContext(), 0);
+                                              mSurfaceColorType, mRenderThread.getGrContext(),
+                                              Properties::renderAheadDepth);
     }
 
     return mVkSurface != nullptr;
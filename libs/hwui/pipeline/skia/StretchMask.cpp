@@ -56,10 +56,14 @@ void StretchMask::draw(GrRecordingContext* context,
         displayList->draw(&transformCanvas);
         maskCanvas->restore();
         displayList->mParentMatrix = previousMatrix;
+        mMaskImage = nullptr;
     }
 
-    sk_sp<SkImage> maskImage = mMaskSurface->makeImageSnapshot();
-    sk_sp<SkShader> maskStretchShader = stretch.getShader(width, height, maskImage, nullptr);
+    if (mMaskImage == nullptr) {
+        mMaskImage = mMaskSurface->makeImageSnapshot();
+    }
+    sk_sp<SkShader> maskStretchShader =
+            mShaderCache.getShader(stretch, width, height, mMaskImage, nullptr);
 
     SkPaint maskPaint;
     maskPaint.setShader(maskStretchShader);
@@ -33,6 +33,8 @@ class StretchMask {
    */
   void clear() {
       mMaskSurface = nullptr;
+      mMaskImage = nullptr;
+      mShaderCache.clear();
   }
 
   /**
@@ -56,6 +58,9 @@ class StretchMask {
             skiapipeline::SkiaDisplayList* displayList, SkCanvas* canvas);
 private:
   sk_sp<SkSurface> mMaskSurface;
+  // The snapshot of mMaskSurface, kept while the mask isn't re-rendered
+  sk_sp<SkImage> mMaskImage;
+  StretchShaderCache mShaderCache;
   bool mIsDirty = true;
 };
 
@@ -19,19 +19,25 @@
 #include "DeviceInfo.h"
 #include "Layer.h"
 #include "Properties.h"
+#include "RenderNode.h"
 #include "RenderThread.h"
+#include "hwui/Bitmap.h"
 #include "pipeline/skia/ATraceMemoryDump.h"
 #include "pipeline/skia/ShaderCache.h"
 #include "pipeline/skia/SkiaMemoryTracer.h"
 #include "renderstate/RenderState.h"
 #include "thread/CommonPool.h"
+#include "utils/LinearAllocator.h"
 #include <utils/Trace.h>
 
 #include <GrContextOptions.h>
 #include <SkExecutor.h>
 #include <SkGraphics.h>
 #include <SkMathPriv.h>
+#include <inttypes.h>
 #include <math.h>
+
+#include <algorithm>
 #include <set>
 
 namespace android {
@@ -45,10 +51,21 @@ namespace renderthread {
 #define SURFACE_SIZE_MULTIPLIER (12.0f * 4.0f)
 #define BACKGROUND_RETENTION_PERCENTAGE (0.5f)
 
+// The adaptive budget moves between the base budget and ADAPTIVE_MAX_MULTIPLIER times that, in
+// steps of ADAPTIVE_STEP_PERCENTAGE of the base budget.
+#define ADAPTIVE_MAX_MULTIPLIER (1.5f)
+#define ADAPTIVE_STEP_PERCENTAGE (0.25f)
+// The cache counts as full when it uses this much of its budget.
+#define ADAPTIVE_FULL_PERCENTAGE (0.95f)
+// Hysteresis, in frames, before the budget grows or shrinks.
+#define ADAPTIVE_GROW_FRAMES 3
+#define ADAPTIVE_SHRINK_FRAMES 300
+
 CacheManager::CacheManager()
         : mMaxSurfaceArea(DeviceInfo::getWidth() * DeviceInfo::getHeight())
-        , mMaxResourceBytes(mMaxSurfaceArea * SURFACE_SIZE_MULTIPLIER)
-        , mBackgroundResourceBytes(mMaxResourceBytes * BACKGROUND_RETENTION_PERCENTAGE)
+        , mBaseResourceBytes(mMaxSurfaceArea * SURFACE_SIZE_MULTIPLIER)
+        , mMaxResourceBytes(mBaseResourceBytes)
+        , mBackgroundResourceBytes(mBaseResourceBytes * BACKGROUND_RETENTION_PERCENTAGE)
         // This sets the maximum size for a single texture atlas in the GPU font cache. If
         // necessary, the cache can allocate additional textures that are counted against the
         // total cache limits provided to Skia.
@@ -72,6 +89,19 @@ void CacheManager::reset(sk_sp<GrDirectContext> context) {
     }
 }
 
+void CacheManager::setResourceBudget(size_t bytes) {
+    mSlowFramesWithFullCache = 0;
+    mUnderusedFrames = 0;
+    if (bytes == mMaxResourceBytes) {
+        return;
+    }
+    mMaxResourceBytes = bytes;
+    if (mGrContext) {
+        mGrContext->setResourceCacheLimit(mMaxResourceBytes);
+    }
+    ATRACE_INT("HWUI resource budget", static_cast<int32_t>(mMaxResourceBytes));
+}
+
 void CacheManager::destroy() {
     // cleanup any caches here as the GrContext is about to go away...
     mGrContext.reset(nullptr);
@@ -97,6 +127,9 @@ void CacheManager::configureContext(GrContextOptions* contextOptions, const void
 }
 
 void CacheManager::trimMemory(TrimMemoryMode mode) {
+    LinearAllocator::trimPagePool();
+    Bitmap::trimHeapPool();
+
     if (!mGrContext) {
         return;
     }
@@ -108,6 +141,7 @@ void CacheManager::trimMemory(TrimMemoryMode mode) {
         case TrimMemoryMode::Complete:
             mGrContext->freeGpuResources();
             SkGraphics::PurgeAllCaches();
+            setResourceBudget(mBaseResourceBytes);
             break;
         case TrimMemoryMode::UiHidden:
             // Here we purge all the unlocked scratch resources and then toggle the resources cache
@@ -116,6 +150,8 @@ void CacheManager::trimMemory(TrimMemoryMode mode) {
             mGrContext->purgeUnlockedResources(true);
             mGrContext->setResourceCacheLimit(mBackgroundResourceBytes);
             mGrContext->setResourceCacheLimit(mMaxResourceBytes);
+            // The app is in the background, so go back to the base budget.
+            setResourceBudget(mBaseResourceBytes);
             SkGraphics::SetFontCacheLimit(mBackgroundCpuFontCacheBytes);
             SkGraphics::SetFontCacheLimit(mMaxCpuFontCacheBytes);
             break;
@@ -194,11 +230,57 @@ void CacheManager::dumpMemoryUsage(String8& log, const RenderState* renderState)
                          layerMemoryTotal / 1024.0f, renderState->mActiveLayers.size());
     }
 
+    dumpLayerOwners(log);
+
     log.appendFormat("Total GPU memory usage:\n");
     gpuTracer.logTotals(log);
+
+    const LinearAllocator::PagePoolStats pagePool = LinearAllocator::getPagePoolStats();
+    log.appendFormat("Display list page pool: %zu pages, %6.2f KB (hits = %zu, misses = %zu)\n",
+                     pagePool.pooledPages, pagePool.pooledBytes / 1024.0f, pagePool.hits,
+                     pagePool.misses);
+
+    const Bitmap::HeapPoolStats bitmapPool = Bitmap::getHeapPoolStats();
+    log.appendFormat("Bitmap pixel pool: %zu buffers, %6.2f KB (hits = %zu, misses = %zu)\n",
+                     bitmapPool.pooledBuffers, bitmapPool.pooledBytes / 1024.0f, bitmapPool.hits,
+                     bitmapPool.misses);
+}
+
+void CacheManager::dumpLayerOwners(String8& log) {
+    struct LayerOwner {
+        const RenderNode* node;
+        int width;
+        int height;
+        size_t bytes;
+    };
+    std::vector<LayerOwner> owners;
+    size_t totalBytes = 0;
+    RenderNode::forEachNodeWithLayer([&](const RenderNode& node) {
+        const SkImageInfo& info = node.getLayerSurface()->imageInfo();
+        owners.push_back({&node, info.width(), info.height(), info.computeMinByteSize()});
+        totalBytes += owners.back().bytes;
+    });
+    if (owners.empty()) {
+        return;
+    }
+
+    // The largest layers are the ones worth looking at for leaks and oversized views.
+    const size_t shown = std::min(owners.size(), kMaxLayerOwnersDumped);
+    std::partial_sort(owners.begin(), owners.begin() + shown, owners.end(),
+                      [](const LayerOwner& a, const LayerOwner& b) { return a.bytes > b.bytes; });
+    log.appendFormat("RenderNode layers by size (top %zu of %zu):\n", shown, owners.size());
+    for (size_t i = 0; i < shown; i++) {
+        const LayerOwner& owner = owners[i];
+        log.appendFormat("    %8.2f KB  RenderLayer %dx%d  RenderNode(id=%" PRId64
+                         ", name='%s')\n",
+                         owner.bytes / 1024.0f, owner.width, owner.height, owner.node->uniqueId(),
+                         owner.node->getName());
+    }
+    log.appendFormat("  RenderNode Layers Total %6.2f KB\n", totalBytes / 1024.0f);
 }
 
-void CacheManager::onFrameCompleted() {
+void CacheManager::onFrameCompleted(bool wasSlow) {
+    updateAdaptiveBudget(wasSlow);
     if (ATRACE_ENABLED()) {
         static skiapipeline::ATraceMemoryDump tracer;
         tracer.startFrame();
@@ -210,6 +292,38 @@ void CacheManager::onFrameCompleted() {
     }
 }
 
+void CacheManager::updateAdaptiveBudget(bool wasSlow) {
+    if (!mGrContext) {
+        return;
+    }
+    size_t usedBytes = 0;
+    mGrContext->getResourceCacheUsage(nullptr, &usedBytes);
+
+    const size_t step = mBaseResourceBytes * ADAPTIVE_STEP_PERCENTAGE;
+    if (usedBytes >= mMaxResourceBytes * ADAPTIVE_FULL_PERCENTAGE) {
+        // A slow frame with a full cache likely had to re-upload resources evicted to stay within
+        // the budget.
+        mUnderusedFrames = 0;
+        if (wasSlow) {
+            mSlowFramesWithFullCache++;
+        } else if (mSlowFramesWithFullCache > 0) {
+            mSlowFramesWithFullCache--;
+        }
+        const size_t maxBytes = mBaseResourceBytes * ADAPTIVE_MAX_MULTIPLIER;
+        if (mSlowFramesWithFullCache >= ADAPTIVE_GROW_FRAMES && mMaxResourceBytes < maxBytes) {
+            setResourceBudget(std::min(mMaxResourceBytes + step, maxBytes));
+        }
+    } else if (usedBytes < mMaxResourceBytes / 2) {
+        mSlowFramesWithFullCache = 0;
+        if (++mUnderusedFrames >= ADAPTIVE_SHRINK_FRAMES &&
+            mMaxResourceBytes > mBaseResourceBytes) {
+            setResourceBudget(std::max(mMaxResourceBytes - step, mBaseResourceBytes));
+        }
+    } else {
+        mUnderusedFrames = 0;
+    }
+}
+
 void CacheManager::performDeferredCleanup(nsecs_t cleanupOlderThanMillis) {
     if (mGrContext) {
         mGrContext->performDeferredCleanup(
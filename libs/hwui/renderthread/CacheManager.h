@@ -51,8 +51,14 @@ public:
     void getMemoryUsage(size_t* cpuUsage, size_t* gpuUsage);
 
     size_t getCacheSize() const { return mMaxResourceBytes; }
+    size_t getBaseCacheSize() const { return mBaseResourceBytes; }
     size_t getBackgroundCacheSize() const { return mBackgroundResourceBytes; }
-    void onFrameCompleted();
+
+    // wasSlow is true if issuing the frame's draw commands took longer than a frame interval.
+    // Slow frames rendered with a full resource cache grow the cache budget, up to
+    // ADAPTIVE_MAX_MULTIPLIER times its base size, and frames using well under the budget
+    // shrink it back. Memory trims reset it to the base size.
+    void onFrameCompleted(bool wasSlow = false);
 
     void performDeferredCleanup(nsecs_t cleanupOlderThanMillis);
 
@@ -65,14 +71,26 @@ private:
     void reset(sk_sp<GrDirectContext> grContext);
 #endif
     void destroy();
+    void updateAdaptiveBudget(bool wasSlow);
+    void setResourceBudget(size_t bytes);
+    // Lists the largest RenderNode layers and the views that own them.
+    void dumpLayerOwners(String8& log);
+
+    static constexpr size_t kMaxLayerOwnersDumped = 10;
 
     const size_t mMaxSurfaceArea;
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
     sk_sp<GrDirectContext> mGrContext;
 #endif
 
-    const size_t mMaxResourceBytes;
+    // The resource budget derived from the screen size, and the current, adapted one.
+    const size_t mBaseResourceBytes;
+    size_t mMaxResourceBytes;
     const size_t mBackgroundResourceBytes;
+    // Consecutive slow frames with a full cache, minus fast ones, and consecutive frames that
+    // used less than half the budget. Both must build up before the budget moves.
+    int mSlowFramesWithFullCache = 0;
+    int mUnderusedFrames = 0;
 
     const size_t mMaxGpuFontAtlasBytes;
     const size_t mMaxCpuFontCacheBytes;
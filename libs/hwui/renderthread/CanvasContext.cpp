@@ -34,12 +34,15 @@
 #include "LayerUpdateQueue.h"
 #include "Properties.h"
 #include "RenderThread.h"
+#include "VectorDrawable.h"
+#include "WebViewFunctorManager.h"
 #include "hwui/Canvas.h"
 #include "pipeline/skia/SkiaOpenGLPipeline.h"
 #include "pipeline/skia/SkiaPipeline.h"
 #include "pipeline/skia/SkiaVulkanPipeline.h"
 #include "thread/CommonPool.h"
 #include "utils/GLUtils.h"
+#include "utils/PerfCounters.h"
 #include "utils/TimeUtils.h"
 
 #define TRIM_MEMORY_COMPLETE 80
@@ -156,7 +159,7 @@ void CanvasContext::destroy() {
     mAnimationContext->destroy();
 }
 
-static void setBufferCount(ANativeWindow* window) {
+static void setBufferCount(ANativeWindow* window, int extraBuffers) {
     int query_value;
     int err = window->query(window, NATIVE_WINDOW_MIN_UNDEQUEUED_BUFFERS, &query_value);
     if (err != 0 || query_value < 0) {
@@ -166,8 +169,9 @@ static void setBufferCount(ANativeWindow* window) {
     auto min_undequeued_buffers = static_cast<uint32_t>(query_value);
 
     // We only need to set min_undequeued + 2 because the renderahead amount was already factored into the
-    // query for min_undequeued
-    int bufferCount = min_undequeued_buffers + 2;
+    // query for min_undequeued. The extra buffers let the render thread queue frames ahead of the GPU
+    // without blocking in dequeueBuffer.
+    int bufferCount = min_undequeued_buffers + 2 + extraBuffers;
     native_window_set_buffer_count(window, bufferCount);
 }
 
@@ -204,6 +208,8 @@ void CanvasContext::setSurfaceControl(ASurfaceControl* surfaceControl) {
     mSurfaceControl = surfaceControl;
     mSurfaceControlGenerationId++;
     mExpectSurfaceStats = surfaceControl != nullptr;
+    mLastQueuedFrameNumber = 0;
+    mLastGpuCompletedFrameNumber = 0;
     if (mExpectSurfaceStats) {
         funcs.acquireFunc(mSurfaceControl);
         funcs.registerListenerFunc(surfaceControl, mSurfaceControlGenerationId, this,
@@ -216,11 +222,13 @@ void CanvasContext::setupPipelineSurface() {
             mNativeSurface ? mNativeSurface->getNativeWindow() : nullptr, mSwapBehavior);
 
     if (mNativeSurface && !mNativeSurface->didSetExtraBuffers()) {
-        setBufferCount(mNativeSurface->getNativeWindow());
+        setBufferCount(mNativeSurface->getNativeWindow(), Properties::renderAheadDepth);
 
     }
 
     mFrameNumber = 0;
+    mLastQueuedFrameNumber = 0;
+    mLastGpuCompletedFrameNumber = 0;
 
     if (mNativeSurface != nullptr && hasSurface) {
         mHaveNewSurface = true;
@@ -308,6 +316,22 @@ static bool wasSkipped(FrameInfo* info) {
     return info && ((*info)[FrameInfoIndex::Flags] & FrameInfoFlags::SkippedFrame);
 }
 
+bool CanvasContext::isGpuBehindRenderAhead() {
+    if (Properties::renderAheadDepth <= 0 || !mExpectSurfaceStats) {
+        return false;
+    }
+    // With render ahead the render thread may queue up to renderAheadDepth frames beyond the one
+    // the GPU is working on. Checking the GPU completion reported by surface stats lets a frame be
+    // skipped here instead of blocking for a buffer in dequeueBuffer.
+    // The oldest pending frame is the one the GPU is working on, only the rest are ahead of it.
+    uint64_t completed = mLastGpuCompletedFrameNumber.load(std::memory_order_relaxed);
+    if (mLastQueuedFrameNumber <= completed) {
+        return false;
+    }
+    uint64_t framesAhead = mLastQueuedFrameNumber - completed - 1;
+    return framesAhead > static_cast<uint64_t>(Properties::renderAheadDepth);
+}
+
 bool CanvasContext::isSwapChainStuffed() {
     static const auto SLOW_THRESHOLD = 6_ms;
 
@@ -361,24 +385,39 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
     mCurrentFrameInfo->importUiThreadInfo(uiFrameInfo);
     mCurrentFrameInfo->set(FrameInfoIndex::SyncQueued) = syncQueued;
     mCurrentFrameInfo->markSyncStart();
+    PerfCounters* perfCounters = PerfCounters::forCurrentThread();
+    if (CC_UNLIKELY(perfCounters)) {
+        mCurrentFrameInfo->resetStageCounters();
+    }
+    mCurrentFrameInfo->functorTimings() = {};
+    // Functors are synced as their nodes are prepared, and drawn in draw().
+    ScopedFunctorTimings functorTimings(mCurrentFrameInfo->functorTimings());
 
     info.damageAccumulator = &mDamageAccumulator;
     info.layerUpdateQueue = &mLayerUpdateQueue;
+    info.dirtyVectorDrawables = &mDirtyVectorDrawables;
     info.damageGenerationId = mDamageId++;
     info.out.canDrawThisFrame = true;
 
     mAnimationContext->startFrame(info.mode);
-    for (const sp<RenderNode>& node : mRenderNodes) {
-        // Only the primary target node will be drawn full - all other nodes would get drawn in
-        // real time mode. In case of a window, the primary node is the window content and the other
-        // node(s) are non client / filler nodes.
-        info.mode = (node.get() == target ? TreeInfo::MODE_FULL : TreeInfo::MODE_RT_ONLY);
-        node->prepareTree(info);
-        GL_CHECKPOINT(MODERATE);
+    {
+        ScopedFrameCounters counters(perfCounters,
+                                     mCurrentFrameInfo->stageCounters(FrameStage::PrepareTree));
+        for (const sp<RenderNode>& node : mRenderNodes) {
+            // Only the primary target node will be drawn full - all other nodes would get drawn in
+            // real time mode. In case of a window, the primary node is the window content and the
+            // other node(s) are non client / filler nodes.
+            info.mode = (node.get() == target ? TreeInfo::MODE_FULL : TreeInfo::MODE_RT_ONLY);
+            node->prepareTree(info);
+            GL_CHECKPOINT(MODERATE);
+        }
     }
     mAnimationContext->runRemainingAnimations(info);
     GL_CHECKPOINT(MODERATE);
 
+    info.dirtyVectorDrawables = nullptr;
+    rasterizeVectorDrawables(mDirtyVectorDrawables);
+
     freePrefetchedLayers();
     GL_CHECKPOINT(MODERATE);
 
@@ -407,6 +446,17 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
         info.out.canDrawThisFrame = true;
     }
 
+    if (info.out.canDrawThisFrame && !info.forceDrawFrame) {
+        static constexpr int kMaxGpuPacingSkips = 2;
+        if (mGpuPacingSkips < kMaxGpuPacingSkips && isGpuBehindRenderAhead()) {
+            ATRACE_NAME("GPU behind render ahead, skipping frame");
+            mGpuPacingSkips++;
+            info.out.canDrawThisFrame = false;
+        } else {
+            mGpuPacingSkips = 0;
+        }
+    }
+
     // TODO: Do we need to abort out if the backdrop is added but not ready? Should that even
     // be an allowable combination?
     if (mRenderNodes.size() > 2 && !mRenderNodes[1]->isRenderable()) {
@@ -473,13 +523,17 @@ void CanvasContext::notifyFramePending() {
 }
 
 nsecs_t CanvasContext::draw() {
+    PerfCounters* perfCounters = PerfCounters::forCurrentThread();
+    ScopedFrameCounters drawCounters(perfCounters,
+                                     mCurrentFrameInfo->stageCounters(FrameStage::Draw));
+    ScopedFunctorTimings functorTimings(mCurrentFrameInfo->functorTimings());
     if (auto grContext = getGrContext()) {
         if (grContext->abandoned()) {
             LOG_ALWAYS_FATAL("GrContext is abandoned/device lost at start of CanvasContext::draw");
             return 0;
         }
     }
-    SkRect dirty;
+    DamageRegion dirty;
     mDamageAccumulator.finish(&dirty);
 
     if (!Properties::isDrawingEnabled() ||
@@ -508,13 +562,19 @@ nsecs_t CanvasContext::draw() {
     mCurrentFrameInfo->markIssueDrawCommandsStart();
 
     Frame frame = mRenderPipeline->getFrame();
-    SkRect windowDirty = computeDirtyRect(frame, &dirty);
-
-    ATRACE_FORMAT("Drawing " RECT_STRING, SK_RECT_ARGS(dirty));
-
-    const auto drawResult = mRenderPipeline->draw(frame, windowDirty, dirty, mLightGeometry,
-                                                  &mLayerUpdateQueue, mContentDrawBounds, mOpaque,
-                                                  mLightInfo, mRenderNodes, &(profiler()));
+    DamageRegion windowDirty = computeDirtyRect(frame, &dirty);
+
+    ATRACE_FORMAT("Drawing " RECT_STRING " in %zu rects", SK_RECT_ARGS(dirty.getBounds()),
+                  dirty.count());
+
+    IRenderPipeline::DrawResult drawResult;
+    {
+        ScopedFrameCounters counters(perfCounters,
+                                     mCurrentFrameInfo->stageCounters(FrameStage::PipelineDraw));
+        drawResult = mRenderPipeline->draw(frame, windowDirty, dirty, mLightGeometry,
+                                           &mLayerUpdateQueue, mContentDrawBounds, mOpaque,
+                                           mLightInfo, mRenderNodes, &(profiler()));
+    }
 
     uint64_t frameCompleteNr = getFrameNumber();
 
@@ -628,6 +688,7 @@ nsecs_t CanvasContext::draw() {
                 next.frameNumber = frameCompleteNr;
                 next.surfaceId = mSurfaceControlGenerationId;
             }  // release lock
+            mLastQueuedFrameNumber = frameCompleteNr;
         } else {
             mCurrentFrameInfo->markFrameCompleted();
             mCurrentFrameInfo->set(FrameInfoIndex::GpuCompleted)
@@ -635,11 +696,17 @@ nsecs_t CanvasContext::draw() {
             std::scoped_lock lock(mFrameMetricsReporterMutex);
             mJankTracker.finishFrame(*mCurrentFrameInfo, mFrameMetricsReporter, frameCompleteNr,
                                      mSurfaceControlGenerationId);
+            if (mFrameMetricsRing) {
+                mFrameMetricsRing->write(mCurrentFrameInfo->data());
+            }
         }
     }
 
     cleanupResources();
-    mRenderThread.cacheManager().onFrameCompleted();
+    const bool wasSlow = systemTime(SYSTEM_TIME_MONOTONIC) -
+                                 mCurrentFrameInfo->get(FrameInfoIndex::IssueDrawCommandsStart) >
+                         mRenderThread.timeLord().frameIntervalNanos();
+    mRenderThread.cacheManager().onFrameCompleted(wasSlow);
     return mCurrentFrameInfo->get(FrameInfoIndex::DequeueBufferDuration);
 }
 
@@ -726,6 +793,17 @@ void CanvasContext::removeFrameMetricsObserver(FrameMetricsObserver* observer) {
     }
 }
 
+int CanvasContext::getFrameMetricsRingFd() {
+    std::scoped_lock lock(mFrameMetricsReporterMutex);
+    if (mFrameMetricsRing == nullptr) {
+        mFrameMetricsRing = FrameMetricsRing::create();
+        if (mFrameMetricsRing == nullptr) {
+            return -1;
+        }
+    }
+    return mFrameMetricsRing->getFd();
+}
+
 FrameInfo* CanvasContext::getFrameInfoFromLast4(uint64_t frameNumber, uint32_t surfaceControlId) {
     std::scoped_lock lock(mLast4FrameMetricsInfosMutex);
     for (size_t i = 0; i < mLast4FrameMetricsInfos.size(); i++) {
@@ -754,6 +832,13 @@ void CanvasContext::onSurfaceStatsAvailable(void* context, int32_t surfaceContro
     FrameInfo* frameInfo = instance->getFrameInfoFromLast4(frameNumber, surfaceControlId);
 
     if (frameInfo != nullptr) {
+        if (gpuCompleteTime != -1) {
+            uint64_t completed = instance->mLastGpuCompletedFrameNumber.load();
+            while (completed < frameNumber &&
+                   !instance->mLastGpuCompletedFrameNumber.compare_exchange_weak(completed,
+                                                                                 frameNumber)) {
+            }
+        }
         frameInfo->set(FrameInfoIndex::FrameCompleted) = std::max(gpuCompleteTime,
                 frameInfo->get(FrameInfoIndex::SwapBuffersCompleted));
         frameInfo->set(FrameInfoIndex::GpuCompleted) = std::max(
@@ -761,6 +846,9 @@ void CanvasContext::onSurfaceStatsAvailable(void* context, int32_t surfaceContro
         std::scoped_lock lock(instance->mFrameMetricsReporterMutex);
         instance->mJankTracker.finishFrame(*frameInfo, instance->mFrameMetricsReporter, frameNumber,
                                            surfaceControlId);
+        if (instance->mFrameMetricsRing) {
+            instance->mFrameMetricsRing->write(frameInfo->data());
+        }
     }
 }
 
@@ -811,6 +899,31 @@ void CanvasContext::markLayerInUse(RenderNode* node) {
     }
 }
 
+void CanvasContext::rasterizeVectorDrawables(std::vector<VectorDrawable::Tree*>& trees) {
+    // A single tree isn't worth a trip to the CommonPool, draw() redraws it on demand.
+    if (trees.size() > 1) {
+        ATRACE_FORMAT("rasterizeVectorDrawables (%zu)", trees.size());
+        // The same tree may be drawn by several display lists, but must only be redrawn once.
+        std::sort(trees.begin(), trees.end());
+        trees.erase(std::unique(trees.begin(), trees.end()), trees.end());
+
+        // Redraw the caches of the trees on the CommonPool, and do the last one here while
+        // waiting. The RenderThread is the only other user of these caches and is blocked until
+        // they are done, so no lock is needed.
+        std::vector<std::future<void>> pending;
+        pending.reserve(trees.size() - 1);
+        for (size_t i = 0; i + 1 < trees.size(); i++) {
+            pending.push_back(
+                    CommonPool::async([tree = trees[i]]() { tree->getBitmapUpdateIfDirty(); }));
+        }
+        trees.back()->getBitmapUpdateIfDirty();
+        for (auto& future : pending) {
+            future.get();
+        }
+    }
+    trees.clear();
+}
+
 void CanvasContext::freePrefetchedLayers() {
     if (mPrefetchedLayers.size()) {
         for (auto& node : mPrefetchedLayers) {
@@ -920,7 +1033,8 @@ bool CanvasContext::surfaceRequiresRedraw() {
     return width != mLastFrameWidth || height != mLastFrameHeight;
 }
 
-SkRect CanvasContext::computeDirtyRect(const Frame& frame, SkRect* dirty) {
+DamageRegion CanvasContext::computeDirtyRect(const Frame& frame, DamageRegion* dirty) {
+    const SkRect frameBounds = SkRect::MakeIWH(frame.width(), frame.height());
     if (frame.width() != mLastFrameWidth || frame.height() != mLastFrameHeight) {
         // can't rely on prior content of window if viewport size changes
         dirty->setEmpty();
@@ -930,22 +1044,27 @@ SkRect CanvasContext::computeDirtyRect(const Frame& frame, SkRect* dirty) {
         // New surface needs a full draw
         dirty->setEmpty();
     } else {
-        if (!dirty->isEmpty() && !dirty->intersect(SkRect::MakeIWH(frame.width(), frame.height()))) {
-            ALOGW("Dirty " RECT_STRING " doesn't intersect with 0 0 %d %d ?", SK_RECT_ARGS(*dirty),
-                  frame.width(), frame.height());
+        const SkRect dirtyBounds = dirty->getBounds();
+        if (!dirty->isEmpty() && !dirty->intersect(frameBounds)) {
+            ALOGW("Dirty " RECT_STRING " doesn't intersect with 0 0 %d %d ?",
+                  SK_RECT_ARGS(dirtyBounds), frame.width(), frame.height());
+        }
+        // The profiler empties the dirty area when it needs the whole frame redrawn
+        SkRect profilerDirty = dirty->getBounds();
+        profiler().unionDirty(&profilerDirty);
+        if (profilerDirty.isEmpty()) {
             dirty->setEmpty();
         }
-        profiler().unionDirty(dirty);
     }
 
     if (dirty->isEmpty()) {
-        dirty->setIWH(frame.width(), frame.height());
+        *dirty = frameBounds;
     }
 
     // At this point dirty is the area of the window to update. However,
     // the area of the frame we need to repaint is potentially different, so
     // stash the screen area for later
-    SkRect windowDirty(*dirty);
+    DamageRegion windowDirty(*dirty);
 
     // If the buffer age is 0 we do a full-screen repaint (handled above)
     // If the buffer age is 1 the buffer contents are the same as they were
@@ -955,7 +1074,7 @@ SkRect CanvasContext::computeDirtyRect(const Frame& frame, SkRect* dirty) {
         if (frame.bufferAge() > (int)mSwapHistory.size()) {
             // We don't have enough history to handle this old of a buffer
             // Just do a full-draw
-            dirty->setIWH(frame.width(), frame.height());
+            *dirty = frameBounds;
         } else {
             // At this point we haven't yet added the latest frame
             // to the damage history (happens below)
@@ -20,6 +20,7 @@
 #include "FrameInfo.h"
 #include "FrameInfoVisualizer.h"
 #include "FrameMetricsReporter.h"
+#include "FrameMetricsRing.h"
 #include "IContextFactory.h"
 #include "IRenderPipeline.h"
 #include "JankTracker.h"
@@ -39,6 +40,7 @@
 #include <utils/Functor.h>
 #include <utils/Mutex.h>
 
+#include <atomic>
 #include <functional>
 #include <future>
 #include <set>
@@ -170,6 +172,11 @@ public:
     void addFrameMetricsObserver(FrameMetricsObserver* observer);
     void removeFrameMetricsObserver(FrameMetricsObserver* observer);
 
+    // Returns a read-only fd of the ring that the FrameInfo of every completed frame is written
+    // to, creating the ring on first use. Returns -1 if the ring couldn't be created. The fd stays
+    // owned by this context.
+    int getFrameMetricsRingFd();
+
     // Used to queue up work that needs to be completed before this frame completes
     void enqueueFrameWork(std::function<void()>&& func);
 
@@ -224,12 +231,14 @@ private:
     friend class android::uirenderer::RenderState;
 
     void freePrefetchedLayers();
+    void rasterizeVectorDrawables(std::vector<VectorDrawable::Tree*>& trees);
 
     bool isSwapChainStuffed();
+    bool isGpuBehindRenderAhead();
     bool surfaceRequiresRedraw();
     void setupPipelineSurface();
 
-    SkRect computeDirtyRect(const Frame& frame, SkRect* dirty);
+    DamageRegion computeDirtyRect(const Frame& frame, DamageRegion* dirty);
     void finishFrame(FrameInfo* frameInfo);
 
     /**
@@ -272,7 +281,7 @@ private:
     bool mIsDirty = false;
     SwapBehavior mSwapBehavior = SwapBehavior::kSwap_default;
     struct SwapHistory {
-        SkRect damage;
+        DamageRegion damage;
         nsecs_t vsyncTime;
         nsecs_t swapCompletedTime;
         nsecs_t dequeueDuration;
@@ -313,10 +322,14 @@ private:
     FrameInfoVisualizer mProfiler;
     std::unique_ptr<FrameMetricsReporter> mFrameMetricsReporter
             GUARDED_BY(mFrameMetricsReporterMutex);
+    std::unique_ptr<FrameMetricsRing> mFrameMetricsRing GUARDED_BY(mFrameMetricsReporterMutex);
     std::mutex mFrameMetricsReporterMutex;
 
     std::set<RenderNode*> mPrefetchedLayers;
 
+    // The dirty VectorDrawables found by prepareTree. Kept between frames to avoid reallocating.
+    std::vector<VectorDrawable::Tree*> mDirtyVectorDrawables;
+
     // Stores the bounds of the main content.
     Rect mContentDrawBounds;
 
@@ -328,6 +341,15 @@ private:
     // If set to true, we expect that callbacks into onSurfaceStatsAvailable
     bool mExpectSurfaceStats = false;
 
+    // The number of the last frame queued while expecting surface stats, and of the latest frame
+    // that onSurfaceStatsAvailable reported as GPU complete. Their difference is the number of
+    // frames the GPU is still working on, which paces render ahead.
+    uint64_t mLastQueuedFrameNumber = 0;
+    std::atomic<uint64_t> mLastGpuCompletedFrameNumber = 0;
+    // Consecutive frames skipped to let the GPU catch up, bounded so that lost surface stats can
+    // never stall rendering.
+    int mGpuPacingSkips = 0;
+
     std::function<bool(int64_t, int64_t, int64_t)> mASurfaceTransactionCallback;
     std::function<void()> mPrepareSurfaceControlForWebviewCallback;
 
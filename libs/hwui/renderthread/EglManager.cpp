@@ -111,9 +111,15 @@ void EglManager::initialize() {
     LOG_ALWAYS_FATAL_IF(mEglDisplay == EGL_NO_DISPLAY, "Failed to get EGL_DEFAULT_DISPLAY! err=%s",
                         eglErrorString());
 
+    // The stages below are traced separately to tell driver start up, which
+    // RenderThread::preload() starts early, from the work that only happens here.
     EGLint major, minor;
-    LOG_ALWAYS_FATAL_IF(eglInitialize(mEglDisplay, &major, &minor) == EGL_FALSE,
-                        "Failed to initialize display %p! err=%s", mEglDisplay, eglErrorString());
+    {
+        ATRACE_NAME("eglInitialize");
+        LOG_ALWAYS_FATAL_IF(eglInitialize(mEglDisplay, &major, &minor) == EGL_FALSE,
+                            "Failed to initialize display %p! err=%s", mEglDisplay,
+                            eglErrorString());
+    }
 
     ALOGV("Initialized EGL, version %d.%d", (int)major, (int)minor);
 
@@ -131,10 +137,19 @@ void EglManager::initialize() {
         }
     }
 
-    loadConfigs();
-    createContext();
-    createPBufferSurface();
-    makeCurrent(mPBufferSurface, nullptr, /* force */ true);
+    {
+        ATRACE_NAME("loadConfigs");
+        loadConfigs();
+    }
+    {
+        ATRACE_NAME("createContext");
+        createContext();
+    }
+    {
+        ATRACE_NAME("makeCurrent PBuffer");
+        createPBufferSurface();
+        makeCurrent(mPBufferSurface, nullptr, /* force */ true);
+    }
 
     skcms_Matrix3x3 wideColorGamut;
     LOG_ALWAYS_FATAL_IF(!DeviceInfo::get()->getWideColorSpace()->toXYZD50(&wideColorGamut),
@@ -572,12 +587,21 @@ Frame EglManager::beginFrame(EGLSurface surface) {
     return frame;
 }
 
-void EglManager::damageFrame(const Frame& frame, const SkRect& dirty) {
+// Maps every rect of region into rects for EGL and returns how many there are
+static EGLint mapDamage(const Frame& frame, const DamageRegion& region, EGLint* rects) {
+    EGLint count = 0;
+    for (const SkRect& rect : region) {
+        frame.map(rect, rects + 4 * count++);
+    }
+    return count;
+}
+
+void EglManager::damageFrame(const Frame& frame, const DamageRegion& dirty) {
 #ifdef EGL_KHR_partial_update
     if (EglExtensions.setDamage && mSwapBehavior == SwapBehavior::BufferAge) {
-        EGLint rects[4];
-        frame.map(dirty, rects);
-        if (!eglSetDamageRegionKHR(mEglDisplay, frame.mSurface, rects, 1)) {
+        EGLint rects[4 * DamageRegion::kMaxRects];
+        const EGLint count = mapDamage(frame, dirty, rects);
+        if (!eglSetDamageRegionKHR(mEglDisplay, frame.mSurface, rects, count)) {
             LOG_ALWAYS_FATAL("Failed to set damage region on surface %p, error=%s",
                              (void*)frame.mSurface, eglErrorString());
         }
@@ -589,15 +613,15 @@ bool EglManager::damageRequiresSwap() {
     return EglExtensions.setDamage && mSwapBehavior == SwapBehavior::BufferAge;
 }
 
-bool EglManager::swapBuffers(const Frame& frame, const SkRect& screenDirty) {
+bool EglManager::swapBuffers(const Frame& frame, const DamageRegion& screenDirty) {
     if (CC_UNLIKELY(Properties::waitForGpuCompletion)) {
         ATRACE_NAME("Finishing GPU work");
         fence();
     }
 
-    EGLint rects[4];
-    frame.map(screenDirty, rects);
-    eglSwapBuffersWithDamageKHR(mEglDisplay, frame.mSurface, rects, screenDirty.isEmpty() ? 0 : 1);
+    EGLint rects[4 * DamageRegion::kMaxRects];
+    const EGLint count = mapDamage(frame, screenDirty, rects);
+    eglSwapBuffersWithDamageKHR(mEglDisplay, frame.mSurface, rects, count);
 
     EGLint err = eglGetError();
     if (CC_LIKELY(err == EGL_SUCCESS)) {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "DamageAccumulator.h"
+#include "DamageRegion.h"
 #include "FrameInfoVisualizer.h"
 #include "LayerUpdateQueue.h"
 #include "Lighting.h"
@@ -59,12 +60,13 @@ public:
         static constexpr nsecs_t kUnknownTime = -1;
         nsecs_t commandSubmissionTime = kUnknownTime;
     };
-    virtual DrawResult draw(const Frame& frame, const SkRect& screenDirty, const SkRect& dirty,
-                            const LightGeometry& lightGeometry, LayerUpdateQueue* layerUpdateQueue,
+    virtual DrawResult draw(const Frame& frame, const DamageRegion& screenDirty,
+                            const DamageRegion& dirty, const LightGeometry& lightGeometry,
+                            LayerUpdateQueue* layerUpdateQueue,
                             const Rect& contentDrawBounds, bool opaque, const LightInfo& lightInfo,
                             const std::vector<sp<RenderNode>>& renderNodes,
                             FrameInfoVisualizer* profiler) = 0;
-    virtual bool swapBuffers(const Frame& frame, bool drew, const SkRect& screenDirty,
+    virtual bool swapBuffers(const Frame& frame, bool drew, const DamageRegion& screenDirty,
                              FrameInfo* currentFrameInfo, bool* requireSwap) = 0;
     virtual DeferredLayerUpdater* createTextureLayer() = 0;
     virtual bool setSurface(ANativeWindow* window, SwapBehavior swapBehavior) = 0;
@@ -23,6 +23,7 @@
 #include "Readback.h"
 #include "Rect.h"
 #include "WebViewFunctorManager.h"
+#include "pipeline/skia/RenderNodeProfiler.h"
 #include "renderthread/CanvasContext.h"
 #include "renderthread/RenderTask.h"
 #include "renderthread/RenderThread.h"
@@ -266,8 +267,13 @@ void RenderProxy::dumpGraphicsMemory(int fd, bool includeProfileData, bool reset
         auto& thread = RenderThread::getInstance();
         thread.queue().runSync([&]() {
             thread.dumpGraphicsMemory(fd, includeProfileData);
+            // The node profile covers every window of the process, like the global profile data.
+            if (includeProfileData && CC_UNLIKELY(Properties::profileRenderNodes)) {
+                skiapipeline::RenderNodeProfiler::get().dump(fd);
+            }
             if (resetProfile) {
                 thread.globalProfileData()->reset();
+                skiapipeline::RenderNodeProfiler::get().reset();
             }
         });
     }
@@ -356,6 +362,13 @@ void RenderProxy::removeFrameMetricsObserver(FrameMetricsObserver* observerPtr)
     });
 }
 
+int RenderProxy::getFrameMetricsRingFd() {
+    return mRenderThread.queue().runSync([this]() -> int {
+        int fd = mContext->getFrameMetricsRingFd();
+        return fd >= 0 ? dup(fd) : -1;
+    });
+}
+
 void RenderProxy::setForceDark(bool enable) {
     mRenderThread.queue().post([this, enable]() { mContext->setForceDark(enable); });
 }
@@ -368,6 +381,20 @@ int RenderProxy::copySurfaceInto(ANativeWindow* window, int left, int top, int r
     }));
 }
 
+void RenderProxy::copySurfaceIntoAsync(ANativeWindow* window, int left, int top, int right,
+                                       int bottom, const SkBitmap& bitmap,
+                                       std::function<void(int)>&& callback) {
+    auto& thread = RenderThread::getInstance();
+    ANativeWindow_acquire(window);
+    thread.queue().post([&thread, window, rect = Rect(left, top, right, bottom), bitmap,
+                         callback = std::move(callback)]() {
+        thread.readback().copySurfaceIntoAsync(
+                window, rect, bitmap,
+                [callback](CopyResult result) { callback(static_cast<int>(result)); });
+        ANativeWindow_release(window);
+    });
+}
+
 void RenderProxy::prepareToDraw(Bitmap& bitmap) {
     // If we haven't spun up a hardware accelerated window yet, there's no
     // point in precaching these bitmaps as it can't impact jank.
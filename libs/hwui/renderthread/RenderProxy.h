@@ -131,10 +131,18 @@ public:
 
     void addFrameMetricsObserver(FrameMetricsObserver* observer);
     void removeFrameMetricsObserver(FrameMetricsObserver* observer);
+    // Returns a new read-only fd of the ring holding the FrameInfo of the recent frames of this
+    // context, see FrameMetricsRing. The caller owns the fd. Returns -1 on failure.
+    int getFrameMetricsRingFd();
     void setForceDark(bool enable);
 
     static int copySurfaceInto(ANativeWindow* window, int left, int top, int right,
                                            int bottom, SkBitmap* bitmap);
+    // Like copySurfaceInto, but returns immediately. The callback is invoked with the result, on
+    // a background thread, once the bitmap's pixels have been written.
+    static void copySurfaceIntoAsync(ANativeWindow* window, int left, int top, int right,
+                                     int bottom, const SkBitmap& bitmap,
+                                     std::function<void(int)>&& callback);
     static void prepareToDraw(Bitmap& bitmap);
 
     static int copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap);
@@ -563,7 +563,7 @@ nsecs_t VulkanManager::finishFrame(SkSurface* surface) {
     return submissionTime;
 }
 
-void VulkanManager::swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect) {
+void VulkanManager::swapBuffers(VulkanSurface* surface, const DamageRegion& dirty) {
     if (CC_UNLIKELY(Properties::waitForGpuCompletion)) {
         ATRACE_NAME("Finishing GPU work");
         mDeviceWaitIdle(mDevice);
@@ -589,7 +589,7 @@ void VulkanManager::swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect)
         destroy_semaphore(mDestroySemaphoreContext);
     }
 
-    surface->presentCurrentBuffer(dirtyRect, fenceFd);
+    surface->presentCurrentBuffer(dirty, fenceFd);
     mSwapSemaphore = VK_NULL_HANDLE;
     mDestroySemaphoreContext = nullptr;
 }
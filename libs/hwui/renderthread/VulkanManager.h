@@ -87,7 +87,7 @@ public:
     // Finishes the frame and submits work to the GPU
     // Returns the estimated start time for intiating GPU work, -1 otherwise.
     nsecs_t finishFrame(SkSurface* surface);
-    void swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect);
+    void swapBuffers(VulkanSurface* surface, const DamageRegion& dirty);
 
     // Inserts a wait on fence command into the Vulkan command buffer.
     status_t fenceWait(int fence, GrDirectContext* grContext);
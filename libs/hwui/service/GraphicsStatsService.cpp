@@ -378,24 +378,27 @@ public:
     int fd() { return mFd; }
     DumpType type() { return mType; }
     protos::GraphicsStatsServiceDumpProto& proto() { return mProto; }
-    void mergeStat(const protos::GraphicsStatsProto& stat);
-    void updateProto();
+    // Takes the contents of stat, which is left in an unspecified state.
+    void mergeStat(protos::GraphicsStatsProto* stat);
 
-private:
     // use package name and app version for a key
     typedef std::pair<std::string, int64_t> DumpKey;
 
+    const std::map<DumpKey, protos::GraphicsStatsProto>& stats() { return mStats; }
+
+private:
     std::map<DumpKey, protos::GraphicsStatsProto> mStats;
     int mFd;
     DumpType mType;
     protos::GraphicsStatsServiceDumpProto mProto;
 };
 
-void GraphicsStatsService::Dump::mergeStat(const protos::GraphicsStatsProto& stat) {
+void GraphicsStatsService::Dump::mergeStat(protos::GraphicsStatsProto* statPtr) {
+    const protos::GraphicsStatsProto& stat = *statPtr;
     auto dumpKey = std::make_pair(stat.package_name(), stat.version_code());
     auto findIt = mStats.find(dumpKey);
     if (findIt == mStats.end()) {
-        mStats[dumpKey] = stat;
+        mStats[dumpKey].Swap(statPtr);
     } else {
         auto summary = findIt->second.mutable_summary();
         summary->set_total_frames(summary->total_frames() + stat.summary().total_frames());
@@ -427,16 +430,22 @@ void GraphicsStatsService::Dump::mergeStat(const protos::GraphicsStatsProto& sta
     }
 }
 
-void GraphicsStatsService::Dump::updateProto() {
-    for (auto& stat : mStats) {
-        mProto.add_stats()->CopyFrom(stat.second);
-    }
-}
-
 GraphicsStatsService::Dump* GraphicsStatsService::createDump(int outFd, DumpType type) {
     return new Dump(outFd, type);
 }
 
+// Moves the stats into the dump rather than copying them, statsProto is not usable afterwards.
+static void addStatsToDump(GraphicsStatsService::Dump* dump,
+                           protos::GraphicsStatsProto* statsProto) {
+    if (dump->type() == GraphicsStatsService::DumpType::ProtobufStatsd) {
+        dump->mergeStat(statsProto);
+    } else if (dump->type() == GraphicsStatsService::DumpType::Protobuf) {
+        dump->proto().add_stats()->Swap(statsProto);
+    } else {
+        dumpAsTextToFd(statsProto, dump->fd());
+    }
+}
+
 void GraphicsStatsService::addToDump(Dump* dump, const std::string& path,
                                      const std::string& package, int64_t versionCode,
                                      int64_t startTime, int64_t endTime, const ProfileData* data) {
@@ -453,13 +462,7 @@ void GraphicsStatsService::addToDump(Dump* dump, const std::string& path,
               path.empty() ? "<empty>" : path.c_str(), data);
         return;
     }
-    if (dump->type() == DumpType::ProtobufStatsd) {
-        dump->mergeStat(statsProto);
-    } else if (dump->type() == DumpType::Protobuf) {
-        dump->proto().add_stats()->CopyFrom(statsProto);
-    } else {
-        dumpAsTextToFd(&statsProto, dump->fd());
-    }
+    addStatsToDump(dump, &statsProto);
 }
 
 void GraphicsStatsService::addToDump(Dump* dump, const std::string& path) {
@@ -467,13 +470,7 @@ void GraphicsStatsService::addToDump(Dump* dump, const std::string& path) {
     if (!parseFromFile(path, &statsProto)) {
         return;
     }
-    if (dump->type() == DumpType::ProtobufStatsd) {
-        dump->mergeStat(statsProto);
-    } else if (dump->type() == DumpType::Protobuf) {
-        dump->proto().add_stats()->CopyFrom(statsProto);
-    } else {
-        dumpAsTextToFd(&statsProto, dump->fd());
-    }
+    addStatsToDump(dump, &statsProto);
 }
 
 void GraphicsStatsService::finishDump(Dump* dump) {
@@ -533,10 +530,9 @@ static void writeGpuHistogram(AStatsEvent* event,
 
 void GraphicsStatsService::finishDumpInMemory(Dump* dump, AStatsEventList* data,
                                               bool lastFullDay) {
-    dump->updateProto();
-    auto& serviceDump = dump->proto();
-    for (int stat_index = 0; stat_index < serviceDump.stats_size(); stat_index++) {
-        auto& stat = serviceDump.stats(stat_index);
+    // The merged stats are read in place, there is no need to build the dump proto first.
+    for (const auto& entry : dump->stats()) {
+        const auto& stat = entry.second;
         AStatsEvent* event = AStatsEventList_addStatsEvent(data);
         AStatsEvent_setAtomId(event, stats::GRAPHICS_STATS);
         AStatsEvent_writeString(event, stat.package_name().c_str());
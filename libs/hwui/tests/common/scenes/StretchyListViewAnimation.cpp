@@ -26,6 +26,7 @@ class StretchyUniformListView;
 class StretchyUniformListViewHolePunch;
 class StretchyUniformLayerListView;
 class StretchyUniformLayerListViewHolePunch;
+class StretchyLayerListViewHeld;
 
 static TestScene::Registrar _StretchyListViewAnimation(TestScene::Info{
         "stretchylistview",
@@ -61,12 +62,25 @@ static TestScene::Registrar _StretchyUniformLayerListViewHolePunch(TestScene::In
         "Uses a layer & includes a hole punch",
         TestScene::simpleCreateScene<StretchyUniformLayerListViewHolePunch>});
 
+static TestScene::Registrar _StretchyLayerListViewHeld(TestScene::Info{
+        "stretchylistview_layer_held",
+        "A mock ListView that's stretched and then held, using a layer & includes a hole punch. "
+        "Neither the content nor the stretch changes while held, so this measures how much of the "
+        "stretch is redone every frame.",
+        TestScene::simpleCreateScene<StretchyLayerListViewHeld>});
+
 class StretchyListViewAnimation : public TestScene {
 protected:
     virtual StretchEffectBehavior stretchBehavior() { return StretchEffectBehavior::Shader; }
     virtual bool haveHolePunch() { return false; }
     virtual bool forceLayer() { return false; }
 
+    // Animates from 0f to .1f and back every 150 frames
+    virtual float stretchAmount(int frameNr) {
+        frameNr = frameNr % 150;
+        return (frameNr > 75 ? 150 - frameNr : frameNr) / 1500.f;
+    }
+
 private:
     int mItemHeight;
     int mItemSpacing;
@@ -195,9 +209,7 @@ private:
         auto& props = mListView->mutateStagingProperties();
         auto& stretch = props.mutateLayerProperties().mutableStretchEffect();
         stretch.setEmpty();
-        frameNr = frameNr % 150;
-        // Animate from 0f to .1f
-        const float sY = (frameNr > 75 ? 150 - frameNr : frameNr) / 1500.f;
+        const float sY = stretchAmount(frameNr);
         stretch.mergeWith({{.fX = 0, .fY = sY},
                            static_cast<float>(props.getWidth()),
                            static_cast<float>(props.getHeight())});
@@ -227,4 +239,12 @@ class StretchyUniformLayerListViewHolePunch : public StretchyListViewAnimation {
     StretchEffectBehavior stretchBehavior() override { return StretchEffectBehavior::UniformScale; }
     bool haveHolePunch() override { return true; }
     bool forceLayer() override { return true; }
-};
\ No newline at end of file
+};
+
+class StretchyLayerListViewHeld : public StretchyListViewAnimation {
+    bool haveHolePunch() override { return true; }
+    bool forceLayer() override { return true; }
+
+    // Pulls to .1f over 75 frames, then holds there
+    float stretchAmount(int frameNr) override { return std::min(frameNr, 75) / 750.f; }
+};
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameStats.h"
+
+#include "FrameInfo.h"
+
+#include <android-base/file.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+namespace android {
+namespace uirenderer {
+namespace test {
+
+namespace {
+
+// A stage of the frame, measured from one FrameInfo timestamp to another.
+struct StageDefinition {
+    const char* name;
+    FrameInfoIndex start;
+    FrameInfoIndex end;
+};
+
+const StageDefinition kStages[] = {
+        {"total", FrameInfoIndex::IntendedVsync, FrameInfoIndex::FrameCompleted},
+        {"ui", FrameInfoIndex::IntendedVsync, FrameInfoIndex::SyncQueued},
+        {"sync", FrameInfoIndex::SyncStart, FrameInfoIndex::IssueDrawCommandsStart},
+        {"draw", FrameInfoIndex::IssueDrawCommandsStart, FrameInfoIndex::SwapBuffers},
+        {"swap", FrameInfoIndex::SwapBuffers, FrameInfoIndex::FrameCompleted},
+        {"gpu", FrameInfoIndex::IssueDrawCommandsStart, FrameInfoIndex::GpuCompleted},
+};
+
+// The stages reported as durations by FrameInfo itself.
+const std::pair<const char*, FrameInfoIndex> kDurations[] = {
+        {"dequeue", FrameInfoIndex::DequeueBufferDuration},
+        {"queue", FrameInfoIndex::QueueBufferDuration},
+};
+
+const int kPercentiles[] = {50, 90, 95, 99};
+
+double percentile(std::vector<double> samples, int percent) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const size_t index = std::min(samples.size() - 1, samples.size() * percent / 100);
+    return samples[index];
+}
+
+double mean(const std::vector<double>& samples) {
+    return samples.empty() ? 0
+                           : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double stddev(const std::vector<double>& samples) {
+    if (samples.size() < 2) {
+        return 0;
+    }
+    const double average = mean(samples);
+    double sum = 0;
+    for (double sample : samples) {
+        sum += (sample - average) * (sample - average);
+    }
+    return sqrt(sum / (samples.size() - 1));
+}
+
+// Returns the two-sided p-value of the Mann-Whitney U test of a and b, using the normal
+// approximation with the correction for ties. Frame times are far from normally distributed, so
+// this is used rather than a t-test.
+double mannWhitneyP(const std::vector<double>& a, const std::vector<double>& b) {
+    const double n1 = a.size();
+    const double n2 = b.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1;
+    }
+    std::vector<std::pair<double, bool>> all;
+    all.reserve(a.size() + b.size());
+    for (double sample : a) all.emplace_back(sample, true);
+    for (double sample : b) all.emplace_back(sample, false);
+    std::sort(all.begin(), all.end());
+
+    double rankSumA = 0;
+    double tieTerm = 0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) j++;
+        // Tied samples all get the average of their ranks, which are 1-based.
+        const double rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; k++) {
+            if (all[k].second) rankSumA += rank;
+        }
+        const double ties = j - i;
+        tieTerm += ties * ties * ties - ties;
+        i = j;
+    }
+
+    const double n = n1 + n2;
+    const double u = rankSumA - n1 * (n1 + 1) / 2;
+    const double variance = n1 * n2 / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) {
+        return 1;
+    }
+    const double z = (u - n1 * n2 / 2) / sqrt(variance);
+    return erfc(fabs(z) / sqrt(2.0));
+}
+
+void writeEscaped(FILE* file, const std::string& string) {
+    fputc('"', file);
+    for (char c : string) {
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+        }
+        fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+// Just enough of a JSON reader to load the reports written by writeJsonReport().
+class JsonValue {
+public:
+    enum class Type { Null, Number, String, Array, Object };
+
+    static bool parse(const std::string& text, JsonValue* out) {
+        size_t pos = 0;
+        return parseValue(text, &pos, out) && (skipSpace(text, &pos), pos == text.size());
+    }
+
+    const JsonValue* get(const char* key) const {
+        if (mType != Type::Object) return nullptr;
+        for (const auto& member : mMembers) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+
+    Type type() const { return mType; }
+    double number() const { return mNumber; }
+    const std::string& string() const { return mString; }
+    const std::vector<JsonValue>& elements() const { return mElements; }
+
+private:
+    static void skipSpace(const std::string& text, size_t* pos) {
+        while (*pos < text.size() && isspace(text[*pos])) (*pos)++;
+    }
+
+    static bool parseString(const std::string& text, size_t* pos, std::string* out) {
+        if (text[*pos] != '"') return false;
+        for ((*pos)++; *pos < text.size(); (*pos)++) {
+            char c = text[*pos];
+            if (c == '"') {
+                (*pos)++;
+                return true;
+            }
+            if (c == '\\') {
+                if (++(*pos) == text.size()) return false;
+                c = text[*pos];
+            }
+            out->push_back(c);
+        }
+        return false;
+    }
+
+    static bool parseValue(const std::string& text, size_t* pos, JsonValue* out) {
+        skipSpace(text, pos);
+        if (*pos == text.size()) return false;
+        const char c = text[*pos];
+        if (c == '{' || c == '[') {
+            const bool isObject = c == '{';
+            out->mType = isObject ? Type::Object : Type::Array;
+            (*pos)++;
+            skipSpace(text, pos);
+            if (*pos < text.size() && text[*pos] == (isObject ? '}' : ']')) {
+                (*pos)++;
+                return true;
+            }
+            while (true) {
+                JsonValue value;
+                std::string key;
+                if (isObject) {
+                    skipSpace(text, pos);
+                    if (*pos == text.size() || !parseString(text, pos, &key)) return false;
+                    skipSpace(text, pos);
+                    if (*pos == text.size() || text[(*pos)++] != ':') return false;
+                }
+                if (!parseValue(text, pos, &value)) return false;
+                if (isObject) {
+                    out->mMembers.emplace_back(std::move(key), std::move(value));
+                } else {
+                    out->mElements.push_back(std::move(value));
+                }
+                skipSpace(text, pos);
+                if (*pos == text.size()) return false;
+                const char next = text[(*pos)++];
+                if (next == (isObject ? '}' : ']')) return true;
+                if (next != ',') return false;
+            }
+        }
+        if (c == '"') {
+            out->mType = Type::String;
+            return parseString(text, pos, &out->mString);
+        }
+        if (text.compare(*pos, 4, "null") == 0 || text.compare(*pos, 4, "true") == 0) {
+            *pos += 4;
+            return true;
+        }
+        if (text.compare(*pos, 5, "false") == 0) {
+            *pos += 5;
+            return true;
+        }
+        char* end;
+        out->mType = Type::Number;
+        out->mNumber = strtod(text.c_str() + *pos, &end);
+        const size_t length = end - (text.c_str() + *pos);
+        *pos += length;
+        return length > 0;
+    }
+
+    Type mType = Type::Null;
+    double mNumber = 0;
+    std::string mString;
+    std::vector<JsonValue> mElements;
+    std::vector<std::pair<std::string, JsonValue>> mMembers;
+};
+
+bool readInt(const std::string& path, int64_t* out) {
+    std::string contents;
+    return base::ReadFileToString(path, &contents) &&
+           base::ParseInt(base::Trim(contents), out);
+}
+
+// The total frame times of every scene, with the repetitions pooled.
+std::map<std::string, std::vector<double>> totalsByScene(const std::vector<RunRecord>& records) {
+    std::map<std::string, std::vector<double>> totals;
+    for (const RunRecord& record : records) {
+        for (const StageSamples& stage : record.stages) {
+            if (stage.name == "total") {
+                auto& samples = totals[record.name];
+                samples.insert(samples.end(), stage.ms.begin(), stage.ms.end());
+            }
+        }
+    }
+    return totals;
+}
+
+}  // namespace
+
+FrameStatsRecorder::FrameStatsRecorder() : FrameMetricsObserver(false /*waitForPresentTime*/) {
+    for (const auto& stage : kStages) {
+        mStages.push_back({stage.name, {}});
+    }
+    for (const auto& duration : kDurations) {
+        mStages.push_back({duration.first, {}});
+    }
+}
+
+void FrameStatsRecorder::notify(const int64_t* buffer) {
+    std::lock_guard lock(mLock);
+    size_t index = 0;
+    for (const auto& stage : kStages) {
+        const int64_t start = buffer[static_cast<int>(stage.start)];
+        const int64_t end = buffer[static_cast<int>(stage.end)];
+        // Stages such as the GPU work aren't known for every frame.
+        if (start > 0 && end >= start) {
+            mStages[index].ms.push_back((end - start) / 1000000.0);
+        }
+        index++;
+    }
+    for (const auto& duration : kDurations) {
+        mStages[index++].ms.push_back(buffer[static_cast<int>(duration.second)] / 1000000.0);
+    }
+}
+
+std::vector<StageSamples> FrameStatsRecorder::stages() {
+    std::lock_guard lock(mLock);
+    return mStages;
+}
+
+void sampleDeviceState(RunRecord* record) {
+    for (int cpu = 0;; cpu++) {
+        const std::string cpuPath = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        if (access(cpuPath.c_str(), F_OK) != 0) {
+            break;
+        }
+        int64_t khz = 0;
+        readInt(cpuPath + "/cpufreq/scaling_cur_freq", &khz);
+        record->cpuFreqsKhz.push_back(khz);
+    }
+    for (int zone = 0;; zone++) {
+        const std::string zonePath = "/sys/class/thermal/thermal_zone" + std::to_string(zone);
+        if (access(zonePath.c_str(), F_OK) != 0) {
+            break;
+        }
+        int64_t milliC;
+        if (readInt(zonePath + "/temp", &milliC)) {
+            record->maxThermalMilliC = std::max(record->maxThermalMilliC, milliC);
+        }
+    }
+}
+
+void writeJsonReport(FILE* file, const std::vector<RunRecord>& records) {
+    fprintf(file, "{\n  \"runs\": [");
+    for (size_t r = 0; r < records.size(); r++) {
+        const RunRecord& record = records[r];
+        fprintf(file, "%s\n    {\n      \"name\": ", r ? "," : "");
+        writeEscaped(file, record.name);
+        fprintf(file, ",\n      \"repetition\": %d,\n      \"frame_count\": %d,\n",
+                record.repetition, record.frameCount);
+        fprintf(file, "      \"duration_s\": %.6f,\n      \"cpu_freq_khz\": [", record.durationS);
+        for (size_t i = 0; i < record.cpuFreqsKhz.size(); i++) {
+            fprintf(file, "%s%" PRId64, i ? ", " : "", record.cpuFreqsKhz[i]);
+        }
+        fprintf(file, "],\n      \"max_thermal_mc\": %" PRId64 ",\n      \"stages\": {",
+                record.maxThermalMilliC);
+        for (size_t s = 0; s < record.stages.size(); s++) {
+            const StageSamples& stage = record.stages[s];
+            fprintf(file, "%s\n        ", s ? "," : "");
+            writeEscaped(file, stage.name);
+            fprintf(file, ": {\"mean\": %.4f, \"stddev\": %.4f", mean(stage.ms),
+                    stddev(stage.ms));
+            for (int percent : kPercentiles) {
+                fprintf(file, ", \"p%d\": %.4f", percent, percentile(stage.ms, percent));
+            }
+            fprintf(file, ", \"frames_ms\": [");
+            for (size_t i = 0; i < stage.ms.size(); i++) {
+                fprintf(file, "%s%.4f", i ? ", " : "", stage.ms[i]);
+            }
+            fprintf(file, "]}");
+        }
+        fprintf(file, "\n      }\n    }");
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+bool compareWithBaseline(const char* baselinePath, const std::vector<RunRecord>& records,
+                         double thresholdPercent) {
+    std::string contents;
+    JsonValue baseline;
+    if (!base::ReadFileToString(baselinePath, &contents) ||
+        !JsonValue::parse(contents, &baseline) || !baseline.get("runs")) {
+        fprintf(stderr, "Failed to read the baseline '%s'\n", baselinePath);
+        return false;
+    }
+
+    std::vector<RunRecord> baselineRecords;
+    for (const JsonValue& run : baseline.get("runs")->elements()) {
+        const JsonValue* name = run.get("name");
+        const JsonValue* stages = run.get("stages");
+        const JsonValue* total = stages ? stages->get("total") : nullptr;
+        const JsonValue* frames = total ? total->get("frames_ms") : nullptr;
+        if (!name || !frames) {
+            continue;
+        }
+        RunRecord record;
+        record.name = name->string();
+        StageSamples samples{"total", {}};
+        for (const JsonValue& frame : frames->elements()) {
+            samples.ms.push_back(frame.number());
+        }
+        record.stages.push_back(std::move(samples));
+        baselineRecords.push_back(std::move(record));
+    }
+
+    const auto baselineTotals = totalsByScene(baselineRecords);
+    bool passed = true;
+    for (const auto& [name, samples] : totalsByScene(records)) {
+        auto found = baselineTotals.find(name);
+        if (found == baselineTotals.end()) {
+            printf("%-30s no baseline\n", name.c_str());
+            continue;
+        }
+        const double before = percentile(found->second, 50);
+        const double after = percentile(samples, 50);
+        const double change = before > 0 ? (after - before) * 100 / before : 0;
+        const double p = mannWhitneyP(found->second, samples);
+        const bool regressed = change > thresholdPercent && p < 0.01;
+        printf("%-30s median %.3fms -> %.3fms (%+.1f%%, p=%.4f)%s\n", name.c_str(), before, after,
+               change, p, regressed ? " REGRESSED" : "");
+        passed &= !regressed;
+    }
+    return passed;
+}
+
+} /* namespace test */
+} /* namespace uirenderer */
+} /* namespace android */
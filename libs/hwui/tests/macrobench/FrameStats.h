@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "FrameMetricsObserver.h"
+
+#include <stdio.h>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace android {
+namespace uirenderer {
+namespace test {
+
+// The durations of one stage of every measured frame, in milliseconds.
+struct StageSamples {
+    std::string name;
+    std::vector<double> ms;
+};
+
+// Collects the stage timings of every frame from its FrameInfo.
+class FrameStatsRecorder : public FrameMetricsObserver {
+public:
+    FrameStatsRecorder();
+
+    void notify(const int64_t* buffer) override;
+
+    std::vector<StageSamples> stages();
+
+private:
+    std::mutex mLock;
+    std::vector<StageSamples> mStages;
+};
+
+// The machine-readable record of one run of one scene.
+struct RunRecord {
+    std::string name;
+    int repetition = 0;
+    int frameCount = 0;
+    double durationS = 0;
+    // The current frequency of each CPU at the end of the run, 0 for offline CPUs.
+    std::vector<int64_t> cpuFreqsKhz;
+    // The hottest thermal zone at the end of the run, or -1 if none could be read.
+    int64_t maxThermalMilliC = -1;
+    std::vector<StageSamples> stages;
+};
+
+// Samples the CPU frequencies and the thermal state into record.
+void sampleDeviceState(RunRecord* record);
+
+// Writes records as one JSON document with the percentiles of every stage and the raw samples.
+void writeJsonReport(FILE* file, const std::vector<RunRecord>& records);
+
+/**
+ * Compares the total frame times of records against those of a report written by
+ * writeJsonReport() to baselinePath, pooling the repetitions of each scene. A scene regressed if
+ * its median frame time grew by more than thresholdPercent and a Mann-Whitney U test finds the
+ * difference significant at the 1% level. Prints a summary line per scene to stdout.
+ *
+ * Returns false if the baseline couldn't be read or any scene regressed.
+ */
+bool compareWithBaseline(const char* baselinePath, const std::vector<RunRecord>& records,
+                         double thresholdPercent);
+
+} /* namespace test */
+} /* namespace uirenderer */
+} /* namespace android */
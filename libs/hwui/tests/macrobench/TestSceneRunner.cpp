@@ -16,6 +16,7 @@
 
 #include <gui/TraceUtils.h>
 #include "AnimationContext.h"
+#include "FrameStats.h"
 #include "RenderNode.h"
 #include "renderthread/RenderProxy.h"
 #include "renderthread/RenderTask.h"
@@ -99,7 +100,7 @@ void outputBenchmarkReport(const TestScene::Info& info, const TestScene::Options
 }
 
 static void doRun(const TestScene::Info& info, const TestScene::Options& opts, int repetitionIndex,
-                  BenchmarkResults* reports) {
+                  BenchmarkResults* reports, std::vector<RunRecord>* records) {
     if (opts.reportGpuMemoryUsage) {
         // If we're reporting GPU memory usage we need to first start with a clean slate
         RenderProxy::purgeCaches();
@@ -150,6 +151,12 @@ static void doRun(const TestScene::Info& info, const TestScene::Options& opts, i
     proxy->resetProfileInfo();
     proxy->fence();
 
+    sp<FrameStatsRecorder> frameStats;
+    if (records) {
+        frameStats = sp<FrameStatsRecorder>::make();
+        proxy->addFrameMetricsObserver(frameStats.get());
+    }
+
     ModifiedMovingAverage<double> avgMs(opts.reportFrametimeWeight);
 
     nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -178,6 +185,18 @@ static void doRun(const TestScene::Info& info, const TestScene::Options& opts, i
     proxy->fence();
     nsecs_t end = systemTime(SYSTEM_TIME_MONOTONIC);
 
+    if (records) {
+        proxy->removeFrameMetricsObserver(frameStats.get());
+        RunRecord record;
+        record.name = info.name;
+        record.repetition = repetitionIndex;
+        record.frameCount = opts.frameCount;
+        record.durationS = (end - start) / (double)s2ns(1);
+        sampleDeviceState(&record);
+        record.stages = frameStats->stages();
+        records->push_back(std::move(record));
+    }
+
     if (reports) {
         outputBenchmarkReport(info, opts, (end - start) / (double)s2ns(1), repetitionIndex,
                               reports);
@@ -187,10 +206,10 @@ static void doRun(const TestScene::Info& info, const TestScene::Options& opts, i
 }
 
 void run(const TestScene::Info& info, const TestScene::Options& opts,
-         benchmark::BenchmarkReporter* reporter) {
+         benchmark::BenchmarkReporter* reporter, std::vector<RunRecord>* records) {
     BenchmarkResults results;
     for (int i = 0; i < opts.repeatCount; i++) {
-        doRun(info, opts, i, reporter ? &results : nullptr);
+        doRun(info, opts, i, reporter ? &results : nullptr, records);
     }
     if (reporter) {
         reporter->ReportRuns(results);
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "FrameStats.h"
 #include "tests/common/LeakChecker.h"
 #include "tests/common/TestScene.h"
 
@@ -44,10 +45,13 @@ using namespace android::uirenderer::test;
 static std::vector<TestScene::Info> gRunTests;
 static TestScene::Options gOpts;
 static bool gRunLeakCheck = true;
+static const char* gJsonOutputPath = nullptr;
+static const char* gBaselinePath = nullptr;
+static double gRegressionThresholdPercent = 5.0;
 std::unique_ptr<benchmark::BenchmarkReporter> gBenchmarkReporter;
 
 void run(const TestScene::Info& info, const TestScene::Options& opts,
-         benchmark::BenchmarkReporter* reporter);
+         benchmark::BenchmarkReporter* reporter, std::vector<RunRecord>* records);
 
 static void printHelp() {
     printf(R"(
@@ -72,6 +76,12 @@ OPTIONS:
   --renderer=TYPE      Sets the render pipeline to use. May be skiagl or skiavk
   --skip-leak-check    Skips the memory leak check
   --report-gpu-memory[=verbose]  Dumps the GPU memory usage after each test run
+  --json-output=FILE   Writes the per-frame stage timings, their percentiles and the
+                       CPU frequency and thermal state of every run to FILE as JSON
+  --baseline=FILE      Compares the frame times against a report previously written
+                       with --json-output and exits with an error if any test regressed
+  --regression-threshold=PCT  The median frame time growth a significant difference
+                       must exceed to count as a regression. Default is 5
 )");
 }
 
@@ -175,6 +185,9 @@ enum {
     Renderer,
     SkipLeakCheck,
     ReportGpuMemory,
+    JsonOutput,
+    Baseline,
+    RegressionThreshold,
 };
 }
 
@@ -192,6 +205,9 @@ static const struct option LONG_OPTIONS[] = {
         {"renderer", required_argument, nullptr, LongOpts::Renderer},
         {"skip-leak-check", no_argument, nullptr, LongOpts::SkipLeakCheck},
         {"report-gpu-memory", optional_argument, nullptr, LongOpts::ReportGpuMemory},
+        {"json-output", required_argument, nullptr, LongOpts::JsonOutput},
+        {"baseline", required_argument, nullptr, LongOpts::Baseline},
+        {"regression-threshold", required_argument, nullptr, LongOpts::RegressionThreshold},
         {0, 0, 0, 0}};
 
 static const char* SHORT_OPTIONS = "c:r:h";
@@ -306,6 +322,22 @@ void parseOptions(int argc, char* argv[]) {
                 }
                 break;
 
+            case LongOpts::JsonOutput:
+                gJsonOutputPath = optarg;
+                break;
+
+            case LongOpts::Baseline:
+                gBaselinePath = optarg;
+                break;
+
+            case LongOpts::RegressionThreshold:
+                gRegressionThresholdPercent = atof(optarg);
+                if (gRegressionThresholdPercent <= 0) {
+                    fprintf(stderr, "Invalid regression threshold '%s'\n", optarg);
+                    error = true;
+                }
+                break;
+
             case 'h':
                 printHelp();
                 exit(EXIT_SUCCESS);
@@ -374,19 +406,36 @@ int main(int argc, char* argv[]) {
         gBenchmarkReporter->ReportContext(context);
     }
 
+    const bool recordFrameStats = gJsonOutputPath || gBaselinePath;
+    std::vector<RunRecord> records;
     for (auto&& test : gRunTests) {
-        run(test, gOpts, gBenchmarkReporter.get());
+        run(test, gOpts, gBenchmarkReporter.get(), recordFrameStats ? &records : nullptr);
     }
 
     if (gBenchmarkReporter) {
         gBenchmarkReporter->Finalize();
     }
 
+    bool passed = true;
+    if (gJsonOutputPath) {
+        FILE* file = fopen(gJsonOutputPath, "we");
+        if (file) {
+            writeJsonReport(file, records);
+            fclose(file);
+        } else {
+            fprintf(stderr, "Failed to open '%s', errno=%d\n", gJsonOutputPath, errno);
+            passed = false;
+        }
+    }
+    if (gBaselinePath) {
+        passed &= compareWithBaseline(gBaselinePath, records, gRegressionThresholdPercent);
+    }
+
     renderthread::RenderProxy::trimMemory(100);
     HardwareBitmapUploader::terminate();
 
     if (gRunLeakCheck) {
         LeakChecker::checkForLeaks();
     }
-    return 0;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "utils/Blur.h"
+
+#include <vector>
+
+using namespace android;
+using namespace android::uirenderer;
+
+static constexpr int32_t kWidth = 1080;
+static constexpr int32_t kHeight = 1920;
+
+static std::vector<uint8_t> makeAlpha() {
+    std::vector<uint8_t> pixels(kWidth * kHeight);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = (i * 7919) & 0xFF;
+    }
+    return pixels;
+}
+
+static void BM_Blur_gaussian(benchmark::State& state) {
+    const int32_t radius = state.range(0);
+    std::vector<float> weights(2 * radius + 1);
+    Blur::generateGaussianWeights(weights.data(), radius);
+    std::vector<uint8_t> source = makeAlpha();
+    std::vector<uint8_t> scratch(source.size());
+    std::vector<uint8_t> dest(source.size());
+    while (state.KeepRunning()) {
+        Blur::horizontal(weights.data(), radius, source.data(), scratch.data(), kWidth, kHeight);
+        Blur::vertical(weights.data(), radius, scratch.data(), dest.data(), kWidth, kHeight);
+        benchmark::DoNotOptimize(dest.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK(BM_Blur_gaussian)->Arg(4)->Arg(16)->Arg(64);
@@ -16,10 +16,14 @@
 
 #include <benchmark/benchmark.h>
 
+#include <SkNoDrawCanvas.h>
+
 #include "DisplayList.h"
+#include "RecordingCanvas.h"
 #include "hwui/Paint.h"
 #include "canvas/CanvasOpBuffer.h"
 #include "canvas/CanvasFrontend.h"
+#include "canvas/CanvasOpRasterizer.h"
 #include "tests/common/TestUtils.h"
 
 using namespace android;
@@ -95,3 +99,78 @@ void BM_CanvasOpBuffer_record_simpleBitmapView(benchmark::State& benchState) {
     }
 }
 BENCHMARK(BM_CanvasOpBuffer_record_simpleBitmapView);
+
+// The benchmarks below record and play back the same translated rects with both recording
+// engines, to compare CanvasOpBuffer against DisplayListData.
+
+static void recordRects(SkCanvas* canvas, int count, const SkPaint& paint) {
+    for (int i = 0; i < count; i++) {
+        canvas->save();
+        canvas->translate(i % 10, i / 10);
+        canvas->drawRect(SkRect::MakeWH(10, 10), paint);
+        canvas->restore();
+    }
+}
+
+static void recordRects(CanvasFrontend<CanvasOpBuffer>& canvas, int count, const SkPaint& paint) {
+    for (int i = 0; i < count; i++) {
+        canvas.save(SaveFlags::MatrixClip);
+        canvas.translate(i % 10, i / 10);
+        canvas.draw(CanvasOp<CanvasOpType::DrawRect> {
+                .rect = SkRect::MakeWH(10, 10),
+                .paint = paint,
+        });
+        canvas.restore();
+    }
+}
+
+void BM_DisplayListData_record_rects(benchmark::State& benchState) {
+    RecordingCanvas recorder;
+    DisplayListData displayList;
+    SkPaint paint;
+    while (benchState.KeepRunning()) {
+        displayList.reset();
+        recorder.reset(&displayList, SkIRect::MakeWH(100, 100));
+        recordRects(&recorder, benchState.range(0), paint);
+        benchmark::DoNotOptimize(&displayList);
+    }
+}
+BENCHMARK(BM_DisplayListData_record_rects)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_CanvasOpBuffer_record_rects(benchmark::State& benchState) {
+    CanvasFrontend<CanvasOpBuffer> canvas(100, 100);
+    SkPaint paint;
+    while (benchState.KeepRunning()) {
+        canvas.reset(100, 100);
+        recordRects(canvas, benchState.range(0), paint);
+        benchmark::DoNotOptimize(&canvas);
+    }
+}
+BENCHMARK(BM_CanvasOpBuffer_record_rects)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_DisplayListData_playback_rects(benchmark::State& benchState) {
+    RecordingCanvas recorder;
+    DisplayListData displayList;
+    recorder.reset(&displayList, SkIRect::MakeWH(100, 100));
+    recordRects(&recorder, benchState.range(0), SkPaint{});
+
+    SkNoDrawCanvas canvas(100, 100);
+    while (benchState.KeepRunning()) {
+        displayList.draw(&canvas);
+        benchmark::DoNotOptimize(&canvas);
+    }
+}
+BENCHMARK(BM_DisplayListData_playback_rects)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_CanvasOpBuffer_playback_rects(benchmark::State& benchState) {
+    CanvasFrontend<CanvasOpBuffer> recorder(100, 100);
+    recordRects(recorder, benchState.range(0), SkPaint{});
+    CanvasOpBuffer buffer = recorder.finish();
+
+    SkNoDrawCanvas canvas(100, 100);
+    while (benchState.KeepRunning()) {
+        rasterizeCanvasBuffer(buffer, &canvas);
+        benchmark::DoNotOptimize(&canvas);
+    }
+}
+BENCHMARK(BM_CanvasOpBuffer_playback_rects)->Arg(10)->Arg(100)->Arg(1000);
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "thread/CommonPool.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace android;
+using namespace android::uirenderer;
+
+// Round trip of one task: post, run on a worker and hand the result back to the caller.
+static void BM_CommonPool_async(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        auto future = CommonPool::async([]() { return 1; });
+        benchmark::DoNotOptimize(future.get());
+    }
+}
+BENCHMARK(BM_CommonPool_async);
+
+// Cost of fanning a batch of small tasks out to the workers, as a frame does for its fences.
+static void BM_CommonPool_postBatch(benchmark::State& state) {
+    std::atomic<int> remaining{0};
+    while (state.KeepRunning()) {
+        remaining.store(state.range(0), std::memory_order_relaxed);
+        for (int i = 0; i < state.range(0); i++) {
+            CommonPool::post([&remaining]() { remaining.fetch_sub(1, std::memory_order_release); });
+        }
+        // Spin rather than waitForIdle(), which would also time the workers going to sleep.
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CommonPool_postBatch)->Arg(1)->Arg(8)->Arg(64);
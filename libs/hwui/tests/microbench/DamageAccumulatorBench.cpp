@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "DamageAccumulator.h"
+#include "Matrix.h"
+
+using namespace android;
+using namespace android::uirenderer;
+
+// Walks a tree of the given depth in which every node has two children, pushing a translation
+// for each node and dirtying each leaf, the way prepareTree() does for a damaged hierarchy.
+static void walk(DamageAccumulator& accumulator, const Matrix4& transform, int depth) {
+    accumulator.pushTransform(&transform);
+    if (depth == 0) {
+        accumulator.dirty(0, 0, 48, 48);
+    } else {
+        walk(accumulator, transform, depth - 1);
+        walk(accumulator, transform, depth - 1);
+    }
+    accumulator.popTransform();
+}
+
+static void BM_DamageAccumulator_tree(benchmark::State& state) {
+    Matrix4 transform;
+    transform.loadTranslate(8, 8, 0);
+    while (state.KeepRunning()) {
+        DamageAccumulator accumulator;
+        walk(accumulator, transform, state.range(0));
+        SkRect dirty;
+        accumulator.finish(&dirty);
+        benchmark::DoNotOptimize(dirty);
+    }
+    state.SetItemsProcessed(state.iterations() * ((2 << state.range(0)) - 1));
+}
+BENCHMARK(BM_DamageAccumulator_tree)->Arg(2)->Arg(6)->Arg(10);
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "FrameInfo.h"
+#include "FrameMetricsReporter.h"
+
+#include <vector>
+
+using namespace android;
+using namespace android::uirenderer;
+
+class CountingObserver : public FrameMetricsObserver {
+public:
+    CountingObserver() : FrameMetricsObserver(false) {}
+    void notify(const int64_t*) override { mCount++; }
+
+private:
+    int mCount = 0;
+};
+
+// Fan-out of one frame's metrics to the given number of observers.
+static void BM_FrameMetricsReporter_report(benchmark::State& state) {
+    FrameMetricsReporter reporter;
+    std::vector<sp<CountingObserver>> observers;
+    for (int i = 0; i < state.range(0); i++) {
+        sp<CountingObserver> observer = new CountingObserver();
+        observer->reportMetricsFrom(0, 0);
+        reporter.addObserver(observer.get());
+        observers.push_back(observer);
+    }
+    int64_t stats[static_cast<int>(FrameInfoIndex::NumIndexes)] = {};
+    uint64_t frameNumber = 0;
+    while (state.KeepRunning()) {
+        reporter.reportFrameMetrics(stats, false, frameNumber++, 0);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FrameMetricsReporter_report)->Arg(1)->Arg(4)->Arg(16);
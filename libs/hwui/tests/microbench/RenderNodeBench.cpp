@@ -16,11 +16,26 @@
 
 #include <benchmark/benchmark.h>
 
-#include "hwui/Canvas.h"
+#include "AnimationContext.h"
+#include "DamageAccumulator.h"
+#include "IContextFactory.h"
 #include "RenderNode.h"
+#include "TreeInfo.h"
+#include "hwui/Canvas.h"
+#include "hwui/Paint.h"
+#include "renderthread/CanvasContext.h"
+#include "tests/common/TestUtils.h"
 
 using namespace android;
 using namespace android::uirenderer;
+using namespace android::uirenderer::renderthread;
+
+class ContextFactory : public IContextFactory {
+public:
+    AnimationContext* createAnimationContext(TimeLord& clock) override {
+        return new AnimationContext(clock);
+    }
+};
 
 void BM_RenderNode_create(benchmark::State& state) {
     while (state.KeepRunning()) {
@@ -44,3 +59,38 @@ void BM_RenderNode_recordSimple(benchmark::State& state) {
     }
 }
 BENCHMARK(BM_RenderNode_recordSimple);
+
+// prepareTree() of a synced hierarchy of the given number of children, in which nothing changes
+// from frame to frame. This is the floor every frame pays to walk the tree.
+void BM_RenderNode_prepareTree(benchmark::State& state) {
+    TestUtils::runOnRenderThread([&state](RenderThread& thread) {
+        auto root = TestUtils::createNode(0, 0, 1080, 1920, [&state](RenderProperties&,
+                                                                     Canvas& canvas) {
+            for (int i = 0; i < state.range(0); i++) {
+                auto child = TestUtils::createNode(0, i * 10, 1080, i * 10 + 10,
+                                                   [](RenderProperties&, Canvas& canvas) {
+                                                       Paint paint;
+                                                       canvas.drawRect(0, 0, 1080, 10, paint);
+                                                   });
+                canvas.drawRenderNode(child.get());
+            }
+        });
+        TestUtils::syncHierarchyPropertiesAndDisplayList(root);
+        ContextFactory contextFactory;
+        std::unique_ptr<CanvasContext> canvasContext(
+                CanvasContext::create(thread, false, root.get(), &contextFactory));
+
+        while (state.KeepRunning()) {
+            TreeInfo info(TreeInfo::MODE_FULL, *canvasContext.get());
+            DamageAccumulator damageAccumulator;
+            info.damageAccumulator = &damageAccumulator;
+            root->prepareTree(info);
+            SkRect damage;
+            damageAccumulator.finish(&damage);
+            benchmark::DoNotOptimize(damage);
+        }
+        canvasContext->destroy();
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RenderNode_prepareTree)->Arg(10)->Arg(100)->Arg(1000);
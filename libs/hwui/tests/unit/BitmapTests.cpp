@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "hwui/Bitmap.h"
+
+#include <SkImageInfo.h>
+
+using namespace android;
+
+TEST(Bitmap, reusesPooledHeapPixels) {
+    Bitmap::trimHeapPool();
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(256, 256);
+    void* pixels;
+    {
+        sk_sp<Bitmap> bitmap = Bitmap::allocateHeapBitmap(info);
+        ASSERT_NE(nullptr, bitmap);
+        pixels = bitmap->pixels();
+        memset(pixels, 0xFF, bitmap->getAllocationByteCount());
+    }
+    EXPECT_EQ(1u, Bitmap::getHeapPoolStats().pooledBuffers);
+
+    const size_t hits = Bitmap::getHeapPoolStats().hits;
+    sk_sp<Bitmap> bitmap = Bitmap::allocateHeapBitmap(info);
+    ASSERT_NE(nullptr, bitmap);
+    EXPECT_EQ(pixels, bitmap->pixels());
+    EXPECT_EQ(hits + 1, Bitmap::getHeapPoolStats().hits);
+
+    // Reused pixels are cleared, just like new ones.
+    const uint32_t* reused = static_cast<const uint32_t*>(bitmap->pixels());
+    for (int i = 0; i < info.width() * info.height(); i++) {
+        ASSERT_EQ(0u, reused[i]);
+    }
+}
+
+TEST(Bitmap, doesNotPoolSmallOrMismatchedPixels) {
+    Bitmap::trimHeapPool();
+    Bitmap::allocateHeapBitmap(SkImageInfo::MakeN32Premul(16, 16));
+    EXPECT_EQ(0u, Bitmap::getHeapPoolStats().pooledBuffers);
+
+    Bitmap::allocateHeapBitmap(SkImageInfo::MakeN32Premul(256, 256));
+    EXPECT_EQ(1u, Bitmap::getHeapPoolStats().pooledBuffers);
+    const size_t misses = Bitmap::getHeapPoolStats().misses;
+    sk_sp<Bitmap> other = Bitmap::allocateHeapBitmap(SkImageInfo::MakeN32Premul(512, 256));
+    EXPECT_EQ(misses + 1, Bitmap::getHeapPoolStats().misses);
+    EXPECT_EQ(1u, Bitmap::getHeapPoolStats().pooledBuffers);
+
+    Bitmap::trimHeapPool();
+    EXPECT_EQ(0u, Bitmap::getHeapPoolStats().pooledBuffers);
+    EXPECT_EQ(0u, Bitmap::getHeapPoolStats().pooledBytes);
+}
@@ -83,3 +83,39 @@ RENDERTHREAD_SKIA_PIPELINE_TEST(CacheManager, trimMemory) {
     renderThread.cacheManager().trimMemory(CacheManager::TrimMemoryMode::Complete);
     ASSERT_TRUE(0 == grContext->getResourceCachePurgeableBytes());
 }
+
+RENDERTHREAD_SKIA_PIPELINE_TEST(CacheManager, adaptiveBudget) {
+    int32_t width = DeviceInfo::get()->getWidth();
+    int32_t height = DeviceInfo::get()->getHeight();
+    GrDirectContext* grContext = renderThread.getGrContext();
+    ASSERT_TRUE(grContext != nullptr);
+    CacheManager& cacheManager = renderThread.cacheManager();
+    const size_t baseSize = cacheManager.getBaseCacheSize();
+    ASSERT_EQ(baseSize, cacheManager.getCacheSize());
+
+    // hold on to render targets until the cache is over its budget
+    std::vector<sk_sp<SkSurface>> surfaces;
+    while (getCacheUsage(grContext) <= baseSize) {
+        SkImageInfo info = SkImageInfo::MakeA8(width, height);
+        sk_sp<SkSurface> surface = SkSurface::MakeRenderTarget(grContext, SkBudgeted::kYes, info);
+        surface->getCanvas()->drawColor(SK_AlphaTRANSPARENT);
+        grContext->flushAndSubmit();
+        surfaces.push_back(surface);
+    }
+
+    // fast frames never grow the budget, and a single slow frame isn't enough
+    cacheManager.onFrameCompleted(false);
+    cacheManager.onFrameCompleted(true);
+    ASSERT_EQ(baseSize, cacheManager.getCacheSize());
+
+    // sustained slow frames with a full cache do
+    for (int i = 0; i < 10; i++) {
+        cacheManager.onFrameCompleted(true);
+    }
+    ASSERT_LT(baseSize, cacheManager.getCacheSize());
+
+    // memory pressure goes back to the base budget
+    surfaces.clear();
+    cacheManager.trimMemory(CacheManager::TrimMemoryMode::Complete);
+    ASSERT_EQ(baseSize, cacheManager.getCacheSize());
+}
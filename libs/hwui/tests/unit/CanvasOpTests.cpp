@@ -29,6 +29,8 @@
 #include "pipeline/skia/AnimatedDrawables.h"
 #include <SkNoDrawCanvas.h>
 
+#include <sstream>
+
 using namespace android;
 using namespace android::uirenderer;
 using namespace android::uirenderer::skiapipeline;
@@ -49,7 +51,7 @@ public:
     }
 
 private:
-    std::array<int, static_cast<size_t>(CanvasOpType::COUNT)> mOpCounts;
+    std::array<int, static_cast<size_t>(CanvasOpType::COUNT)> mOpCounts{};
 };
 
 template<typename T>
@@ -597,6 +599,87 @@ TEST(CanvasOp, simpleDrawRipple) {
     EXPECT_EQ(1, canvas.sumTotalDrawCalls());
 }
 
+TEST(CanvasOp, simpleDrawBehind) {
+    CanvasOpBuffer buffer;
+    EXPECT_EQ(buffer.size(), 0);
+    buffer.push<Op::DrawBehind> ({
+        .paint = SkPaint{}
+    });
+
+    CallCountingCanvas canvas;
+    EXPECT_EQ(0, canvas.sumTotalDrawCalls());
+    rasterizeCanvasBuffer(buffer, &canvas);
+    EXPECT_EQ(1, canvas.drawBehindCount);
+    EXPECT_EQ(1, canvas.sumTotalDrawCalls());
+}
+
+TEST(CanvasOp, simpleDrawAnnotation) {
+    CanvasOpBuffer buffer;
+    EXPECT_EQ(buffer.size(), 0);
+    buffer.push<Op::DrawAnnotation> ({
+        .rect = SkRect::MakeWH(10, 10),
+        .key = "key",
+        .value = SkData::MakeWithCString("value")
+    });
+
+    CallCountingCanvas canvas;
+    EXPECT_EQ(0, canvas.sumTotalDrawCalls());
+    rasterizeCanvasBuffer(buffer, &canvas);
+    EXPECT_EQ(1, canvas.drawAnnotationCount);
+    EXPECT_EQ(1, canvas.sumTotalDrawCalls());
+}
+
+TEST(CanvasOp, simpleDrawPatch) {
+    CanvasOpBuffer buffer;
+    EXPECT_EQ(buffer.size(), 0);
+    CanvasOp<Op::DrawPatch> op{
+        .mode = SkBlendMode::kSrcOver,
+        .paint = SkPaint{}
+    };
+    for (int i = 0; i < 12; i++) {
+        op.cubics[i] = SkPoint::Make(i * 10, (i % 4) * 10);
+    }
+    buffer.push(std::move(op));
+
+    CallCountingCanvas canvas;
+    EXPECT_EQ(0, canvas.sumTotalDrawCalls());
+    rasterizeCanvasBuffer(buffer, &canvas);
+    EXPECT_EQ(1, canvas.drawPatchCount);
+    EXPECT_EQ(1, canvas.sumTotalDrawCalls());
+}
+
+TEST(CanvasOp, clipOpsDoNotDraw) {
+    CanvasOpBuffer buffer;
+    buffer.push<Op::ClipRRect> ({
+        .rrect = SkRRect::MakeRectXY(SkRect::MakeWH(50, 50), 5, 5),
+        .op = SkClipOp::kIntersect,
+        .aa = true
+    });
+    buffer.push<Op::ClipRegion> ({
+        .region = SkRegion(SkIRect::MakeWH(20, 20)),
+        .op = SkClipOp::kIntersect
+    });
+    buffer.push<Op::ResetClip> ({});
+    EXPECT_EQ(3, countItems(buffer));
+
+    CallCountingCanvas canvas;
+    rasterizeCanvasBuffer(buffer, &canvas);
+    EXPECT_EQ(0, canvas.sumTotalDrawCalls());
+}
+
+TEST(CanvasOp, outputListsOps) {
+    CanvasOpBuffer buffer;
+    buffer.push<Op::Save> ({});
+    buffer.push<Op::DrawPaint> ({
+        .paint = SkPaint{}
+    });
+    buffer.push<Op::Restore> ({});
+
+    std::ostringstream output;
+    buffer.output(output, 1);
+    EXPECT_EQ("  Save\n  DrawPaint\n  Restore\n", output.str());
+}
+
 TEST(CanvasOp, immediateRendering) {
     auto canvas = std::make_shared<CallCountingCanvas>();
 
@@ -638,3 +721,32 @@ TEST(CanvasOp, frontendSaveCount) {
     EXPECT_EQ(1, receiver[Op::Save]);
     EXPECT_EQ(1, receiver[Op::Restore]);
 }
+
+TEST(CanvasOp, frontendClipOps) {
+    CanvasFrontend<CanvasOpCountingReceiver> opCanvas(100, 100);
+    const auto& receiver = opCanvas.receiver();
+
+    opCanvas.save(SaveFlags::MatrixClip);
+    opCanvas.draw(CanvasOp<Op::ClipRect> {
+        .rect = SkRect::MakeLTRB(10, 10, 90, 90),
+        .clipOp = SkClipOp::kIntersect
+    });
+    EXPECT_TRUE(opCanvas.isClipRect());
+    EXPECT_EQ(SkRect::MakeLTRB(10, 10, 90, 90), opCanvas.getClipBounds());
+
+    opCanvas.draw(CanvasOp<Op::ClipRRect> {
+        .rrect = SkRRect::MakeRectXY(SkRect::MakeLTRB(20, 20, 80, 80), 5, 5),
+        .op = SkClipOp::kIntersect,
+        .aa = true
+    });
+    EXPECT_TRUE(opCanvas.isClipComplex());
+
+    opCanvas.draw(CanvasOp<Op::ResetClip> {});
+    EXPECT_FALSE(opCanvas.isClipComplex());
+    EXPECT_EQ(SkRect::MakeWH(100, 100), opCanvas.getClipBounds());
+    opCanvas.restore();
+
+    EXPECT_EQ(1, receiver[Op::ClipRect]);
+    EXPECT_EQ(1, receiver[Op::ClipRRect]);
+    EXPECT_EQ(1, receiver[Op::ResetClip]);
+}
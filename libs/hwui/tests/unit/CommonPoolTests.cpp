@@ -50,7 +50,7 @@ TEST(DISABLED_CommonPool, threadCount) {
     for (auto& f : futures) {
         threads.insert(f.get());
     }
-    EXPECT_EQ(threads.size(), CommonPool::THREAD_COUNT);
+    EXPECT_EQ(threads.size(), static_cast<size_t>(CommonPool::getThreadCount()));
     EXPECT_EQ(0, threads.count(gettid()));
 }
 
@@ -97,36 +97,32 @@ TEST(CommonPool, DISABLED_singleThread) {
     EXPECT_NE(gettid(), tid1);
 }
 
-// Test currently relies on timings
-// which makes it flaky, disable for now
-TEST(DISABLED_CommonPool, fullQueue) {
+TEST(CommonPool, threadCountWithinLimits) {
+    EXPECT_LE(CommonPool::MIN_THREAD_COUNT, CommonPool::getThreadCount());
+    EXPECT_GE(CommonPool::MAX_THREAD_COUNT, CommonPool::getThreadCount());
+    EXPECT_EQ(static_cast<size_t>(CommonPool::getThreadCount()), CommonPool::getThreadIds().size());
+}
+
+TEST(CommonPool, postDoesNotBlockWhenBusy) {
     std::mutex lock;
     std::condition_variable fence;
     bool signaled = false;
-    static constexpr auto QUEUE_COUNT = CommonPool::THREAD_COUNT + CommonPool::QUEUE_SIZE + 10;
-    std::atomic_int queuedCount{0};
+    static constexpr auto QUEUE_COUNT = 512;
+    std::atomic_int ranCount{0};
     std::array<std::future<void>, QUEUE_COUNT> futures;
 
-    std::thread queueThread{[&] {
-        for (int i = 0; i < QUEUE_COUNT; i++) {
-            futures[i] = CommonPool::async([&] {
-                std::unique_lock _lock{lock};
-                while (!signaled) {
-                    fence.wait(_lock);
-                }
-            });
-            queuedCount++;
-        }
-    }};
-
-    int previous;
-    do {
-        previous = queuedCount.load();
-        usleep(10000);
-    } while (previous != queuedCount.load());
-
-    EXPECT_GT(queuedCount.load(), CommonPool::QUEUE_SIZE);
-    EXPECT_LT(queuedCount.load(), QUEUE_COUNT);
+    // Every worker blocks on the first tasks it takes, so all of the others stay queued.
+    for (int i = 0; i < QUEUE_COUNT; i++) {
+        futures[i] = CommonPool::async(
+                [&] {
+                    std::unique_lock _lock{lock};
+                    while (!signaled) {
+                        fence.wait(_lock);
+                    }
+                    ranCount++;
+                },
+                i % 2 ? CommonPool::Priority::Frame : CommonPool::Priority::Background);
+    }
 
     {
         std::unique_lock _lock{lock};
@@ -134,13 +130,11 @@ TEST(DISABLED_CommonPool, fullQueue) {
         fence.notify_all();
     }
 
-    queueThread.join();
-    EXPECT_EQ(queuedCount.load(), QUEUE_COUNT);
-
     // Ensure all our tasks are finished before return as they have references to the stack
     for (auto& f : futures) {
         f.get();
     }
+    EXPECT_EQ(QUEUE_COUNT, ranCount.load());
 }
 
 class ObjectTracker {
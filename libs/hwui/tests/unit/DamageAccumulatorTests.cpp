@@ -127,3 +127,46 @@ TEST(DamageAccumulator, perspectiveTransform) {
     da.finish(&dirty);
     ASSERT_EQ(SkRect::MakeLTRB(50, 50, 500, 500), dirty);
 }
+
+// Test that damage far apart is kept as separate rects, while overlapping damage is merged
+TEST(DamageAccumulator, disjointRects) {
+    DamageAccumulator da;
+    Matrix4 translate;
+    translate.loadTranslate(10, 10, 0);
+    da.pushTransform(&translate);
+    da.dirty(0, 0, 10, 10);
+    da.dirty(100, 100, 110, 110);
+    da.dirty(105, 105, 120, 120);
+    da.popTransform();
+    DamageRegion dirty;
+    da.finish(&dirty);
+    ASSERT_EQ(2u, dirty.count());
+    EXPECT_EQ(SkRect::MakeLTRB(10, 10, 20, 20), dirty.begin()[0]);
+    EXPECT_EQ(SkRect::MakeLTRB(110, 110, 130, 130), dirty.begin()[1]);
+    EXPECT_EQ(SkRect::MakeLTRB(10, 10, 130, 130), dirty.getBounds());
+}
+
+// Test that once the region is full new damage is merged into the rect that grows the least
+TEST(DamageAccumulator, boundedRects) {
+    DamageAccumulator da;
+    da.pushTransform(&Matrix4::identity());
+    for (size_t i = 0; i < DamageRegion::kMaxRects; i++) {
+        da.dirty(i * 100, 0, i * 100 + 10, 10);
+    }
+    da.dirty(5, 20, 15, 30);
+    da.popTransform();
+    DamageRegion dirty;
+    da.finish(&dirty);
+    ASSERT_EQ(DamageRegion::kMaxRects, dirty.count());
+    bool foundMerged = false;
+    for (const SkRect& rect : dirty) {
+        foundMerged |= rect == SkRect::MakeLTRB(0, 0, 15, 30);
+    }
+    EXPECT_TRUE(foundMerged);
+    SkRect bounds;
+    bounds.setEmpty();
+    for (const SkRect& rect : dirty) {
+        bounds.join(rect);
+    }
+    EXPECT_EQ(bounds, dirty.getBounds());
+}
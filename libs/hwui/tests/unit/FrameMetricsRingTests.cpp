@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <FrameMetricsRing.h>
+
+#include <thread>
+
+using namespace android;
+using namespace android::uirenderer;
+
+static void fillFrameInfo(int64_t* frameInfo, int64_t value) {
+    for (uint32_t i = 0; i < FrameMetricsRing::kFrameInfoSize; i++) {
+        frameInfo[i] = value;
+    }
+}
+
+TEST(FrameMetricsRing, readsWrittenFrames) {
+    auto ring = FrameMetricsRing::create();
+    ASSERT_NE(nullptr, ring);
+    auto reader = FrameMetricsRing::map(ring->getFd());
+    ASSERT_NE(nullptr, reader);
+
+    int64_t frameInfo[FrameMetricsRing::kFrameInfoSize];
+    EXPECT_EQ(0u, reader->writeCount());
+    EXPECT_FALSE(reader->read(0, frameInfo));
+
+    for (int i = 0; i < 3; i++) {
+        fillFrameInfo(frameInfo, i + 100);
+        ring->write(frameInfo);
+    }
+    EXPECT_EQ(3u, reader->writeCount());
+    for (uint32_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(reader->read(i, frameInfo));
+        EXPECT_EQ(static_cast<int64_t>(i + 100), frameInfo[0]);
+        EXPECT_EQ(static_cast<int64_t>(i + 100), frameInfo[FrameMetricsRing::kFrameInfoSize - 1]);
+    }
+    EXPECT_FALSE(reader->read(3, frameInfo));
+}
+
+TEST(FrameMetricsRing, oldFramesAreOverwritten) {
+    auto ring = FrameMetricsRing::create();
+    ASSERT_NE(nullptr, ring);
+
+    int64_t frameInfo[FrameMetricsRing::kFrameInfoSize];
+    const uint32_t frameCount = FrameMetricsRing::kCapacity + 10;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        fillFrameInfo(frameInfo, i);
+        ring->write(frameInfo);
+    }
+    EXPECT_FALSE(ring->read(9, frameInfo));
+    ASSERT_TRUE(ring->read(10, frameInfo));
+    EXPECT_EQ(10, frameInfo[0]);
+    ASSERT_TRUE(ring->read(frameCount - 1, frameInfo));
+    EXPECT_EQ(static_cast<int64_t>(frameCount - 1), frameInfo[0]);
+}
+
+TEST(FrameMetricsRing, readsAreNeverTorn) {
+    auto ring = FrameMetricsRing::create();
+    ASSERT_NE(nullptr, ring);
+    auto reader = FrameMetricsRing::map(ring->getFd());
+    ASSERT_NE(nullptr, reader);
+
+    constexpr uint32_t kFrameCount = 20000;
+    std::thread writer([&]() {
+        int64_t frameInfo[FrameMetricsRing::kFrameInfoSize];
+        for (uint32_t i = 0; i < kFrameCount; i++) {
+            fillFrameInfo(frameInfo, i);
+            ring->write(frameInfo);
+        }
+    });
+
+    int64_t frameInfo[FrameMetricsRing::kFrameInfoSize];
+    uint32_t count;
+    do {
+        count = reader->writeCount();
+        if (count > 0 && reader->read(count - 1, frameInfo)) {
+            for (uint32_t i = 0; i < FrameMetricsRing::kFrameInfoSize; i++) {
+                ASSERT_EQ(static_cast<int64_t>(count - 1), frameInfo[i]);
+            }
+        }
+    } while (count < kFrameCount);
+    writer.join();
+}
+
+TEST(FrameMetricsRing, rejectsOtherRegions) {
+    EXPECT_EQ(nullptr, FrameMetricsRing::map(-1));
+}
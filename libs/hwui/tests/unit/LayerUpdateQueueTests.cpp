@@ -67,6 +67,8 @@ TEST(LayerUpdateQueue, enqueueUnion) {
 
     EXPECT_EQ(a.get(), queue.entries()[0].renderNode.get());
     EXPECT_EQ(Rect(10, 10, 40, 40), queue.entries()[0].damage);
+    // The disjoint rects are still redrawn separately
+    EXPECT_EQ(2u, queue.entries()[0].damageRegion.count());
 }
 
 TEST(LayerUpdateQueue, clear) {
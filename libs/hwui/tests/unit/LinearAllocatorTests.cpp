@@ -86,6 +86,28 @@ TEST(LinearAllocator, rewind) {
     EXPECT_EQ(1, destroyed);
 }
 
+TEST(LinearAllocator, reusesPooledPages) {
+    LinearAllocator::trimPagePool();
+    {
+        LinearAllocator la;
+        la.alloc<char>(64);
+    }
+    auto stats = LinearAllocator::getPagePoolStats();
+    EXPECT_EQ(1u, stats.pooledPages);
+    const size_t hits = stats.hits;
+    {
+        LinearAllocator la;
+        la.alloc<char>(64);
+        EXPECT_EQ(hits + 1, LinearAllocator::getPagePoolStats().hits);
+        EXPECT_EQ(0u, LinearAllocator::getPagePoolStats().pooledPages);
+    }
+
+    LinearAllocator::trimPagePool();
+    stats = LinearAllocator::getPagePoolStats();
+    EXPECT_EQ(0u, stats.pooledPages);
+    EXPECT_EQ(0u, stats.pooledBytes);
+}
+
 TEST(LinearStdAllocator, simpleAllocate) {
     LinearAllocator la;
     LinearStdAllocator<void*> stdAllocator(la);
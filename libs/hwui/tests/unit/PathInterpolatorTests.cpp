@@ -18,6 +18,8 @@
 
 #include <Interpolator.h>
 
+#include <algorithm>
+
 namespace android {
 namespace uirenderer {
 
@@ -86,5 +88,23 @@ TEST(Interpolator, pathInterpolation) {
         }
     }
 }
+
+TEST(Interpolator, densePathInterpolation) {
+    // As many points as the Java PathInterpolator produces for a curve, including repeated x.
+    std::vector<float> x, y;
+    for (int i = 0; i <= 1000; i++) {
+        const float t = i / 1000.0f;
+        x.push_back(i % 7 == 6 ? x.back() : t * t * (3 - 2 * t));
+        y.push_back(t);
+    }
+    std::vector<float> points = x;
+    PathInterpolator interpolator(std::move(x), std::move(y));
+    for (int i = 1; i < 4000; i++) {
+        const float t = i / 4000.0f;
+        const size_t end = std::upper_bound(points.begin(), points.end(), t) - points.begin();
+        const float fraction = (t - points[end - 1]) / (points[end] - points[end - 1]);
+        EXPECT_FLOAT_EQ((end - 1 + fraction) / 1000.0f, interpolator.interpolate(t)) << t;
+    }
+}
 }
 }
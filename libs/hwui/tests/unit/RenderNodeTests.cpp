@@ -299,6 +299,40 @@ RENDERTHREAD_TEST(RenderNode, prepareTree_nullableDisplayList) {
     canvasContext->destroy();
 }
 
+RENDERTHREAD_TEST(RenderNode, prepareTree_identicalDisplayListNotDamaged) {
+    auto drawRect = [](SkColor color) {
+        return [color](Canvas& canvas) {
+            Paint paint;
+            paint.setColor(color);
+            canvas.drawRect(0, 0, 100, 100, paint);
+        };
+    };
+    auto node = TestUtils::createNode(0, 0, 200, 400, nullptr);
+    TestUtils::recordNode(*node, drawRect(Color::Red_500));
+    ContextFactory contextFactory;
+    std::unique_ptr<CanvasContext> canvasContext(
+            CanvasContext::create(renderThread, false, node.get(), &contextFactory));
+
+    auto prepareAndGetDamage = [&]() {
+        TreeInfo info(TreeInfo::MODE_FULL, *canvasContext.get());
+        DamageAccumulator damageAccumulator;
+        info.damageAccumulator = &damageAccumulator;
+        node->prepareTree(info);
+        SkRect damage;
+        damageAccumulator.finish(&damage);
+        return damage;
+    };
+    EXPECT_FALSE(prepareAndGetDamage().isEmpty());
+
+    TestUtils::recordNode(*node, drawRect(Color::Red_500));
+    EXPECT_TRUE(prepareAndGetDamage().isEmpty());
+
+    TestUtils::recordNode(*node, drawRect(Color::Blue_500));
+    EXPECT_FALSE(prepareAndGetDamage().isEmpty());
+
+    canvasContext->destroy();
+}
+
 // TODO: Is this supposed to work in SkiaGL/SkiaVK?
 RENDERTHREAD_TEST(DISABLED_RenderNode, prepareTree_HwLayer_AVD_enqueueDamage) {
     VectorDrawable::Group* group = new VectorDrawable::Group();
@@ -332,3 +366,26 @@ RENDERTHREAD_TEST(DISABLED_RenderNode, prepareTree_HwLayer_AVD_enqueueDamage) {
     EXPECT_EQ(uirenderer::Rect(0, 0, 200, 400), info.layerUpdateQueue->entries().at(0).damage);
     canvasContext->destroy();
 }
+
+TEST(RenderNode, forEachNodeWithLayer) {
+    auto node = TestUtils::createNode(0, 0, 100, 100, nullptr);
+    auto hasNode = [&node]() {
+        bool found = false;
+        RenderNode::forEachNodeWithLayer(
+                [&](const RenderNode& layerNode) { found |= &layerNode == node.get(); });
+        return found;
+    };
+    EXPECT_FALSE(hasNode());
+
+    node->setLayerSurface(SkSurface::MakeRasterN32Premul(100, 100));
+    EXPECT_TRUE(hasNode());
+    // Replacing the surface keeps the node registered once
+    node->setLayerSurface(SkSurface::MakeRasterN32Premul(200, 200));
+    size_t count = 0;
+    RenderNode::forEachNodeWithLayer(
+            [&](const RenderNode& layerNode) { count += &layerNode == node.get(); });
+    EXPECT_EQ(1u, count);
+
+    node->setLayerSurface(nullptr);
+    EXPECT_FALSE(hasNode());
+}
@@ -51,6 +51,22 @@ public:
         cache.mSavePending = saveContent;
         cache.saveToDiskLocked();
         cache.mBlobCache = NULL;
+        cache.mSeedCache = NULL;
+    }
+
+    /**
+     * "snapshot" copies the contents of the cache the way a deferred save does before writing
+     * them with "writeSnapshot".
+     */
+    static bool snapshot(ShaderCache& cache, std::vector<uint8_t>* outSnapshot,
+                         uint64_t* outGeneration) {
+        std::lock_guard<std::mutex> lock(cache.mMutex);
+        return cache.snapshotLocked(outSnapshot, outGeneration);
+    }
+
+    static void writeSnapshot(ShaderCache& cache, const std::string& filename,
+                              const std::vector<uint8_t>& snapshot, uint64_t generation) {
+        cache.writeSnapshot(filename, snapshot, generation);
     }
 
     /**
@@ -187,6 +203,43 @@ TEST(ShaderCacheTest, testWriteAndRead) {
     remove(cacheFile1.c_str());
 }
 
+TEST(ShaderCacheTest, testStaleSnapshotIsNotWritten) {
+    if (!folderExist(getExternalStorageFolder())) {
+        // don't run the test if external storage folder is not available
+        return;
+    }
+    std::string cacheFile1 = getExternalStorageFolder() + "/shaderCacheTest1";
+
+    // remove any test files from previous test run
+    int deleteFile = remove(cacheFile1.c_str());
+    ASSERT_TRUE(0 == deleteFile || ENOENT == errno);
+
+    ShaderCache::get().setFilename(cacheFile1.c_str());
+    ShaderCacheTestUtils::setSaveDelay(ShaderCache::get(), 0);  // disable deferred save
+    ShaderCache::get().initShaderDiskCache();
+
+    // take a snapshot the way a deferred save would, then save newer contents synchronously
+    sk_sp<SkData> inVS;
+    setShader(inVS, "oldData");
+    ShaderCache::get().store(GrProgramDescTest(432), *inVS.get(), SkString());
+    std::vector<uint8_t> snapshot;
+    uint64_t generation = 0;
+    ASSERT_TRUE(ShaderCacheTestUtils::snapshot(ShaderCache::get(), &snapshot, &generation));
+    setShader(inVS, "newData");
+    ShaderCache::get().store(GrProgramDescTest(432), *inVS.get(), SkString());
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), true);
+
+    // the late write of the older snapshot must not replace the newer file
+    ShaderCacheTestUtils::writeSnapshot(ShaderCache::get(), cacheFile1, snapshot, generation);
+    ShaderCache::get().initShaderDiskCache();
+    sk_sp<SkData> outVS;
+    ASSERT_NE((outVS = ShaderCache::get().load(GrProgramDescTest(432))), sk_sp<SkData>());
+    ASSERT_TRUE(checkShader(outVS, "newData"));
+
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), false);
+    remove(cacheFile1.c_str());
+}
+
 TEST(ShaderCacheTest, testCacheValidation) {
     if (!folderExist(getExternalStorageFolder())) {
         // don't run the test if external storage folder is not available
@@ -279,4 +332,59 @@ TEST(ShaderCacheTest, testCacheValidation) {
     remove(cacheFile1.c_str());
 }
 
+TEST(ShaderCacheTest, testSeedCache) {
+    if (!folderExist(getExternalStorageFolder())) {
+        // don't run the test if external storage folder is not available
+        return;
+    }
+    std::string seedFile = getExternalStorageFolder() + "/shaderCacheTestSeed";
+    std::string cacheFile = getExternalStorageFolder() + "/shaderCacheTest1";
+
+    // remove any test files from previous test run
+    int deleteFile = remove(seedFile.c_str());
+    ASSERT_TRUE(0 == deleteFile || ENOENT == errno);
+    deleteFile = remove(cacheFile.c_str());
+    ASSERT_TRUE(0 == deleteFile || ENOENT == errno);
+    std::srand(0);
+
+    std::vector<uint8_t> identity(1024);
+    genRandomData(identity);
+    const size_t identitySize = identity.size() * sizeof(decltype(identity)::value_type);
+
+    // write the seed like any other cache
+    ShaderCache::get().setFilename(seedFile.c_str());
+    ShaderCacheTestUtils::setSaveDelay(ShaderCache::get(), 0);  // disable deferred save
+    ShaderCache::get().initShaderDiskCache(identity.data(), identitySize);
+    sk_sp<SkData> inVS;
+    setShader(inVS, "sassas");
+    ShaderCache::get().store(GrProgramDescTest(100), *inVS.get(), SkString());
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), true);
+
+    // a new app cache with the same identity finds the seeded entry
+    ShaderCache::get().setFilename(cacheFile.c_str());
+    ShaderCache::get().setSeedFilename(seedFile.c_str());
+    ShaderCache::get().initShaderDiskCache(identity.data(), identitySize);
+    ASSERT_TRUE(checkShader(ShaderCache::get().load(GrProgramDescTest(100)), "sassas"));
+    ASSERT_EQ(ShaderCache::get().load(GrProgramDescTest(432)), sk_sp<SkData>());
+
+    // entries of the app cache take precedence over the seed
+    sk_sp<SkData> appVS;
+    setShader(appVS, "someVS");
+    ShaderCache::get().store(GrProgramDescTest(100), *appVS.get(), SkString());
+    ASSERT_TRUE(checkShader(ShaderCache::get().load(GrProgramDescTest(100)), "someVS"));
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), false);
+
+    // the seed is ignored when the identity differs
+    for (auto& data : identity) {
+        data += std::rand();
+    }
+    ShaderCache::get().initShaderDiskCache(identity.data(), identitySize);
+    ASSERT_EQ(ShaderCache::get().load(GrProgramDescTest(100)), sk_sp<SkData>());
+
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), false);
+    ShaderCache::get().setSeedFilename("");
+    remove(seedFile.c_str());
+    remove(cacheFile.c_str());
+}
+
 }  // namespace
@@ -197,6 +197,39 @@ RENDERTHREAD_SKIA_PIPELINE_TEST(SkiaDisplayList, prepareListAndChildren) {
     canvasContext->destroy();
 }
 
+RENDERTHREAD_SKIA_PIPELINE_TEST(SkiaDisplayList, prepareListAndChildren_collectsDirtyVDs) {
+    auto rootNode = TestUtils::createNode(0, 0, 200, 400, nullptr);
+    ContextFactory contextFactory;
+    std::unique_ptr<CanvasContext> canvasContext(
+            CanvasContext::create(renderThread, false, rootNode.get(), &contextFactory));
+    TreeInfo info(TreeInfo::MODE_FULL, *canvasContext.get());
+    DamageAccumulator damageAccumulator;
+    info.damageAccumulator = &damageAccumulator;
+    std::vector<VectorDrawableRoot*> dirtyVectorDrawables;
+    info.dirtyVectorDrawables = &dirtyVectorDrawables;
+
+    SkiaDisplayList skiaDL;
+    const auto bounds = SkRect::MakeIWH(100, 100);
+
+    VectorDrawableRoot cleanVD(new VectorDrawable::Group());
+    cleanVD.mutateProperties()->setBounds(bounds);
+    cleanVD.mutateProperties()->setScaledSize(10, 10);
+    cleanVD.getBitmapUpdateIfDirty();
+    skiaDL.appendVD(&cleanVD);
+
+    VectorDrawableRoot dirtyVD(new VectorDrawable::Group());
+    dirtyVD.mutateProperties()->setBounds(bounds);
+    skiaDL.appendVD(&dirtyVD);
+
+    TestUtils::MockTreeObserver observer;
+    ASSERT_TRUE(skiaDL.prepareListAndChildren(observer, info, false,
+                                              [](RenderNode*, TreeObserver&, TreeInfo&, bool) {}));
+    ASSERT_EQ(1u, dirtyVectorDrawables.size());
+    EXPECT_EQ(&dirtyVD, dirtyVectorDrawables[0]);
+
+    canvasContext->destroy();
+}
+
 RENDERTHREAD_SKIA_PIPELINE_TEST(SkiaDisplayList, prepareListAndChildren_vdOffscreen) {
     auto rootNode = TestUtils::createNode(0, 0, 200, 400, nullptr);
     ContextFactory contextFactory;
@@ -58,4 +58,30 @@ TEST(StretchEffect, bidirectionalStretchRequiresLayer) {
 
   Properties::setStretchEffectBehavior(StretchEffectBehavior::UniformScale);
   ASSERT_TRUE(stretchEffect.requiresLayer());
-}
\ No newline at end of file
+}
+
+TEST(StretchShaderCache, reusesShaderUntilInputsChange) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(100, 100);
+  bitmap.eraseColor(SK_ColorRED);
+  sk_sp<SkImage> image = bitmap.asImage();
+
+  StretchShaderCache cache;
+  auto stretchEffect = StretchEffect({.fX = 0.f, .fY = .1f}, 100.f, 100.f);
+  sk_sp<SkShader> shader = cache.getShader(stretchEffect, 100.f, 100.f, image, nullptr);
+  ASSERT_TRUE(shader);
+  EXPECT_EQ(shader, cache.getShader(stretchEffect, 100.f, 100.f, image, nullptr));
+
+  auto moreStretch = StretchEffect({.fX = 0.f, .fY = .2f}, 100.f, 100.f);
+  sk_sp<SkShader> stretched = cache.getShader(moreStretch, 100.f, 100.f, image, nullptr);
+  EXPECT_NE(shader, stretched);
+
+  SkMatrix matrix = SkMatrix::Translate(10, 0);
+  EXPECT_NE(stretched, cache.getShader(moreStretch, 100.f, 100.f, image, &matrix));
+
+  // A repainted layer has a new snapshot.
+  shader = cache.getShader(moreStretch, 100.f, 100.f, image, &matrix);
+  EXPECT_EQ(shader, cache.getShader(moreStretch, 100.f, 100.f, image, &matrix));
+  bitmap.eraseColor(SK_ColorBLUE);
+  EXPECT_NE(shader, cache.getShader(moreStretch, 100.f, 100.f, bitmap.asImage(), &matrix));
+}
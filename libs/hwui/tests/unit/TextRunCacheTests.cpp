@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "hwui/MinikinUtils.h"
+#include "hwui/Paint.h"
+#include "hwui/TextRunCache.h"
+
+using namespace android;
+
+namespace {
+
+const uint16_t kText[] = {'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd'};
+constexpr size_t kTextLength = sizeof(kText) / sizeof(kText[0]);
+
+float measure(const Paint& paint, float* advances) {
+    return MinikinUtils::measureText(&paint, minikin::Bidi::LTR, nullptr, kText, 0, kTextLength,
+                                     kTextLength, advances);
+}
+
+}  // namespace
+
+TEST(TextRunCache, measureHitsCache) {
+    TextRunCache& cache = TextRunCache::getInstance();
+    cache.clear();
+
+    Paint paint;
+    paint.getSkFont().setSize(20);
+    std::vector<float> first(kTextLength);
+    const float advance = measure(paint, first.data());
+    EXPECT_EQ(1u, cache.getStats().misses);
+
+    std::vector<float> second(kTextLength);
+    EXPECT_EQ(advance, measure(paint, second.data()));
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1u, cache.getStats().hits);
+
+    // Paints differing in anything but their size and color don't share entries.
+    paint.setLetterSpacing(0.1f);
+    EXPECT_NE(advance, measure(paint, nullptr));
+    EXPECT_EQ(2u, cache.getStats().misses);
+}
+
+TEST(TextRunCache, linearMetricsShareAcrossSizes) {
+    TextRunCache& cache = TextRunCache::getInstance();
+    cache.clear();
+
+    Paint paint;
+    paint.getSkFont().setLinearMetrics(true);
+    paint.getSkFont().setSize(10);
+    const float small = measure(paint, nullptr);
+
+    paint.getSkFont().setSize(30);
+    std::vector<float> advances(kTextLength);
+    const float large = measure(paint, advances.data());
+    EXPECT_EQ(1u, cache.getStats().scaledHits);
+    EXPECT_FLOAT_EQ(small * 3, large);
+
+    cache.clear();
+    std::vector<float> expected(kTextLength);
+    EXPECT_NEAR(measure(paint, expected.data()), large, 0.01f);
+    for (size_t i = 0; i < kTextLength; i++) {
+        EXPECT_NEAR(expected[i], advances[i], 0.01f);
+    }
+}
+
+TEST(TextRunCache, hintedMetricsAreKeyedBySize) {
+    TextRunCache& cache = TextRunCache::getInstance();
+    cache.clear();
+
+    Paint paint;
+    paint.getSkFont().setSize(10);
+    measure(paint, nullptr);
+    paint.getSkFont().setSize(30);
+    measure(paint, nullptr);
+    EXPECT_EQ(0u, cache.getStats().scaledHits);
+    EXPECT_EQ(2u, cache.getStats().misses);
+}
+
+TEST(TextRunCache, layoutFeedsMeasure) {
+    TextRunCache& cache = TextRunCache::getInstance();
+    cache.clear();
+
+    Paint paint;
+    paint.getSkFont().setSize(20);
+    minikin::Layout layout =
+            MinikinUtils::doLayout(&paint, minikin::Bidi::LTR, nullptr, kText, kTextLength, 0,
+                                   kTextLength, 0, kTextLength, nullptr);
+    EXPECT_EQ(layout.getAdvance(), measure(paint, nullptr));
+    EXPECT_EQ(1u, cache.getStats().hits);
+}
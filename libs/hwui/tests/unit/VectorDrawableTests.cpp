@@ -306,6 +306,56 @@ TEST(PathParser, parseAsciiStringForSkPath) {
     }
 }
 
+TEST(PathParser, cachedParsesMatchUncached) {
+    PathParser::clearCache();
+    for (int pass = 0; pass < 2; pass++) {
+        for (const TestData& testData : sTestDataSet) {
+            size_t length = strlen(testData.pathString);
+            PathParser::ParseResult result;
+            PathData pathData;
+            PathParser::getPathDataFromAsciiString(&pathData, &result, testData.pathString,
+                                                   length);
+            EXPECT_EQ(testData.pathData, pathData);
+
+            PathParser::ParseResult uncachedResult;
+            PathData uncachedData;
+            PathParser::getPathDataFromAsciiStringUncached(&uncachedData, &uncachedResult,
+                                                           testData.pathString, length);
+            EXPECT_EQ(uncachedData, pathData);
+
+            PathParser::ParseResult pathResult;
+            SkPath actualPath;
+            PathParser::parseAsciiStringForSkPath(&actualPath, &pathResult, testData.pathString,
+                                                  length);
+            SkPath expectedPath;
+            testData.skPathLamda(&expectedPath);
+            EXPECT_EQ(expectedPath, actualPath);
+        }
+
+        // Failures are never cached.
+        for (StringPath stringPath : sStringPaths) {
+            PathParser::ParseResult result;
+            PathData pathData;
+            PathParser::getPathDataFromAsciiString(&pathData, &result, stringPath.stringPath,
+                                                   strlen(stringPath.stringPath));
+            EXPECT_EQ(stringPath.isValid, !result.failureOccurred);
+        }
+    }
+    PathParser::clearCache();
+}
+
+TEST(PathParser, parseDecimalFloats) {
+    const char* pathString = "M0.5,-1.25L1e2,3.000001 L-0.0000000001 16777217 l.5-.5";
+    PathParser::ParseResult result;
+    PathData pathData;
+    PathParser::getPathDataFromAsciiStringUncached(&pathData, &result, pathString,
+                                                   strlen(pathString));
+    ASSERT_FALSE(result.failureOccurred);
+    const std::vector<float> expected = {0.5f,          -1.25f,      100.0f, 3.000001f,
+                                         -0.0000000001f, 16777217.0f, 0.5f,   -0.5f};
+    EXPECT_EQ(expected, pathData.points);
+}
+
 TEST(VectorDrawableUtils, morphPathData) {
     for (const TestData& fromData : sTestDataSet) {
         for (const TestData& toData : sTestDataSet) {
@@ -409,5 +459,34 @@ TEST(VectorDrawable, drawPathWithoutIncrementingShaderRefCount) {
     EXPECT_TRUE(shader->unique());
 }
 
+TEST(VectorDrawable, interpolatePathDataInPlace) {
+    VectorDrawable::FullPath fullPath("m1 1", 4);
+    VectorDrawable::Path& path = fullPath;
+    bool dirty = false;
+    bool stagingDirty = false;
+    VectorDrawable::PropertyChangedListener listener(&dirty, &stagingDirty);
+    path.setPropertyChangedListener(&listener);
+
+    for (const TestData& data : sTestDataSet) {
+        PathData toPathData = data.pathData;
+        for (size_t i = 0; i < toPathData.points.size(); i++) {
+            toPathData.points[i]++;
+        }
+        for (float fraction : {0.0f, 0.28f, 1.0f}) {
+            PathData expected;
+            VectorDrawableUtils::interpolatePaths(&expected, data.pathData, toPathData, fraction);
+            dirty = false;
+            path.mutateProperties()->interpolateData(data.pathData, toPathData, fraction);
+            EXPECT_TRUE(dirty);
+            EXPECT_EQ(expected, path.mutateProperties()->getData());
+
+            // Morphing to the same fraction again doesn't change anything.
+            dirty = false;
+            path.mutateProperties()->interpolateData(data.pathData, toPathData, fraction);
+            EXPECT_FALSE(dirty);
+        }
+    }
+}
+
 }  // namespace uirenderer
 }  // namespace android
@@ -152,3 +152,33 @@ TEST(WebViewFunctor, contextDestroyed) {
     EXPECT_EQ(2, counts.contextDestroyed);
     EXPECT_EQ(1, counts.destroyed);
 }
+
+TEST(WebViewFunctor, functorTimings) {
+    int functor = WebViewFunctor_create(
+            nullptr, TestUtils::createMockFunctor(RenderMode::OpenGL_ES), RenderMode::OpenGL_ES);
+    ASSERT_NE(-1, functor);
+    auto handle = WebViewFunctorManager::instance().handleFor(functor);
+    ASSERT_TRUE(handle);
+    WebViewFunctor_release(functor);
+    FunctorTimings timings;
+    TestUtils::runOnRenderThreadUnmanaged([&](auto&) {
+        WebViewSyncData syncData;
+        DrawGlInfo drawInfo;
+        // Outside of a scope nothing is recorded.
+        handle->sync(syncData);
+        handle->drawGl(drawInfo);
+        EXPECT_EQ(nullptr, ScopedFunctorTimings::current());
+
+        ScopedFunctorTimings scope(timings);
+        handle->sync(syncData);
+        handle->drawGl(drawInfo);
+        handle->drawGl(drawInfo);
+    });
+    EXPECT_EQ(1, timings.syncCount);
+    EXPECT_EQ(2, timings.drawCount);
+    EXPECT_LE(timings.maxDrawDuration, timings.drawDuration);
+    handle.clear();
+    TestUtils::runOnRenderThreadUnmanaged([](renderthread::RenderThread&) {
+        // fence
+    });
+}
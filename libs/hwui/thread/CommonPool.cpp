@@ -16,25 +16,41 @@
 
 #include "CommonPool.h"
 
+#include <sched.h>
 #include <sys/resource.h>
 #include <utils/Trace.h>
 #include "renderthread/RenderThread.h"
 
+#include <algorithm>
 #include <array>
 
 namespace android {
 namespace uirenderer {
 
+// Use a worker for every two CPUs the process may run on, within the pool's limits.
+static int computeThreadCount() {
+    int cpuCount = 0;
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+        cpuCount = CPU_COUNT(&cpus);
+    }
+    return std::clamp(cpuCount / 2, CommonPool::MIN_THREAD_COUNT, CommonPool::MAX_THREAD_COUNT);
+}
+
 CommonPool::CommonPool() {
     ATRACE_CALL();
 
     CommonPool* pool = this;
+    const int threadCount = computeThreadCount();
     std::mutex mLock;
-    std::vector<int> tids(THREAD_COUNT);
-    std::vector<std::condition_variable> tidConditionVars(THREAD_COUNT);
+    std::vector<int> tids(threadCount);
+    std::vector<std::condition_variable> tidConditionVars(threadCount);
 
-    // Create 2 workers
-    for (int i = 0; i < THREAD_COUNT; i++) {
+    for (int i = 0; i < threadCount; i++) {
+        mWorkers.push_back(std::make_unique<Worker>());
+    }
+
+    for (int i = 0; i < threadCount; i++) {
         std::thread worker([pool, i, &mLock, &tids, &tidConditionVars] {
             {
                 std::array<char, 20> name{"hwuiTask"};
@@ -52,13 +68,13 @@ CommonPool::CommonPool() {
                     startHook(name.data());
                 }
             }
-            pool->workerLoop();
+            pool->workerLoop(i);
         });
         worker.detach();
     }
     {
         std::unique_lock lock(mLock);
-        for (int i = 0; i < THREAD_COUNT; i++) {
+        for (int i = 0; i < threadCount; i++) {
             while (!tids[i]) {
                 tidConditionVars[i].wait(lock);
             }
@@ -68,47 +84,85 @@ CommonPool::CommonPool() {
 }
 
 CommonPool& CommonPool::instance() {
-    static CommonPool pool;
+    // The workers are detached and never exit, so the pool must outlive static destruction.
+    static CommonPool& pool = *new CommonPool();
     return pool;
 }
 
-void CommonPool::post(Task&& task) {
-    instance().enqueue(std::move(task));
+void CommonPool::post(Task&& task, Priority priority) {
+    instance().enqueue(std::move(task), priority);
+}
+
+int CommonPool::getThreadCount() {
+    return static_cast<int>(instance().mWorkers.size());
 }
 
 std::vector<int> CommonPool::getThreadIds() {
     return instance().mWorkerThreadIds;
 }
 
-void CommonPool::enqueue(Task&& task) {
-    std::unique_lock lock(mLock);
-    while (!mWorkQueue.hasSpace()) {
-        lock.unlock();
-        usleep(100);
-        lock.lock();
+void CommonPool::enqueue(Task&& task, Priority priority) {
+    // Spread the tasks over the workers' queues; idle workers steal whatever is left behind.
+    Worker& worker = *mWorkers[mNextWorker.fetch_add(1, std::memory_order_relaxed) %
+                               mWorkers.size()];
+    int queuedTasks;
+    {
+        std::lock_guard lock(worker.lock);
+        worker.lanes[static_cast<int>(priority)].push_back({std::move(task), systemTime()});
+        queuedTasks = mQueuedTasks.fetch_add(1) + 1;
     }
-    mWorkQueue.push(std::move(task));
-    if (mWaitingThreads == THREAD_COUNT || (mWaitingThreads > 0 && mWorkQueue.size() > 1)) {
+    ATRACE_INT("hwuiTaskQueueDepth", queuedTasks);
+
+    std::lock_guard lock(mLock);
+    if (mWaitingThreads > 0) {
         mCondition.notify_one();
     }
 }
 
-void CommonPool::workerLoop() {
-    std::unique_lock lock(mLock);
+bool CommonPool::takeTask(int workerIndex, QueuedTask* outTask) {
+    const int workerCount = static_cast<int>(mWorkers.size());
+    for (int lane = 0; lane < PRIORITY_COUNT; lane++) {
+        // Take the oldest task of our own queue, or else steal the newest task of another one.
+        for (int i = 0; i < workerCount; i++) {
+            Worker& worker = *mWorkers[(workerIndex + i) % workerCount];
+            std::lock_guard lock(worker.lock);
+            auto& queue = worker.lanes[lane];
+            if (queue.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                *outTask = std::move(queue.front());
+                queue.pop_front();
+            } else {
+                *outTask = std::move(queue.back());
+                queue.pop_back();
+            }
+            mQueuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CommonPool::workerLoop(int workerIndex) {
     while (true) {
-        if (!mWorkQueue.hasWork()) {
-            mWaitingThreads++;
-            mCondition.wait(lock);
-            mWaitingThreads--;
+        QueuedTask work;
+        if (takeTask(workerIndex, &work)) {
+            if (ATRACE_ENABLED()) {
+                ATRACE_INT64("hwuiTaskWaitTimeNs", systemTime() - work.queueTime);
+            }
+            work.task();
+            continue;
         }
-        // Need to double-check that work is still available now that we have the lock
-        // It may have already been grabbed by a different thread
-        while (mWorkQueue.hasWork()) {
-            auto work = mWorkQueue.pop();
-            lock.unlock();
-            work();
-            lock.lock();
+
+        std::unique_lock lock(mLock);
+        mWaitingThreads++;
+        // The task count is raised before mLock is taken to post a task, so checking it under
+        // the lock can't miss a wakeup.
+        while (mQueuedTasks.load() == 0) {
+            mCondition.wait(lock);
         }
+        mWaitingThreads--;
     }
 }
 
@@ -118,7 +172,7 @@ void CommonPool::waitForIdle() {
 
 void CommonPool::doWaitForIdle() {
     std::unique_lock lock(mLock);
-    while (mWaitingThreads != THREAD_COUNT) {
+    while (mWaitingThreads != static_cast<int>(mWorkers.size()) || mQueuedTasks.load() != 0) {
         lock.unlock();
         usleep(100);
         lock.lock();
@@ -20,106 +20,101 @@
 #include "utils/Macros.h"
 
 #include <log/log.h>
+#include <utils/Timers.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 namespace android {
 namespace uirenderer {
 
-template <class T, int SIZE>
-class ArrayQueue {
-    PREVENT_COPY_AND_ASSIGN(ArrayQueue);
-    static_assert(SIZE > 0, "Size must be positive");
-
-public:
-    ArrayQueue() = default;
-    ~ArrayQueue() = default;
-
-    constexpr size_t capacity() const { return SIZE; }
-    constexpr bool hasWork() const { return mHead != mTail; }
-    constexpr bool hasSpace() const { return ((mHead + 1) % SIZE) != mTail; }
-    constexpr int size() const {
-        if (mHead > mTail) {
-            return mHead - mTail;
-        } else {
-            return mTail - mHead + SIZE;
-        }
-    }
-
-    constexpr void push(T&& t) {
-        int newHead = (mHead + 1) % SIZE;
-        LOG_ALWAYS_FATAL_IF(newHead == mTail, "no space");
-
-        mBuffer[mHead] = std::move(t);
-        mHead = newHead;
-    }
-
-    constexpr T pop() {
-        LOG_ALWAYS_FATAL_IF(mTail == mHead, "empty");
-        int index = mTail;
-        mTail = (mTail + 1) % SIZE;
-        T ret = std::move(mBuffer[index]);
-        mBuffer[index] = nullptr;
-        return ret;
-    }
-
-private:
-    T mBuffer[SIZE];
-    int mHead = 0;
-    int mTail = 0;
-};
-
+// A small pool of worker threads for hwui's short-lived background work. Every worker has its
+// own queue so that posting and taking tasks rarely contend, and an idle worker steals from the
+// others before it goes to sleep. Tasks are posted into one of two lanes; workers always drain
+// the frame lane, which holds work a frame in flight waits on, before the background lane.
 class CommonPool {
     PREVENT_COPY_AND_ASSIGN(CommonPool);
 
 public:
     using Task = std::function<void()>;
-    static constexpr auto THREAD_COUNT = 2;
-    static constexpr auto QUEUE_SIZE = 128;
 
-    static void post(Task&& func);
+    enum class Priority {
+        // Work that a frame being drawn waits on.
+        Frame,
+        // Work that nothing on the critical path waits on, such as writing out captures.
+        Background,
+    };
+
+    static constexpr int MIN_THREAD_COUNT = 2;
+    static constexpr int MAX_THREAD_COUNT = 4;
+
+    // Queues `func` to be run on a worker thread. Never blocks, however much work is queued.
+    static void post(Task&& func, Priority priority = Priority::Frame);
 
     template <class F>
-    static auto async(F&& func) -> std::future<decltype(func())> {
+    static auto async(F&& func, Priority priority = Priority::Frame)
+            -> std::future<decltype(func())> {
         typedef std::packaged_task<decltype(func())()> task_t;
         auto task = std::make_shared<task_t>(std::forward<F>(func));
-        post([task]() { std::invoke(*task); });
+        post([task]() { std::invoke(*task); }, priority);
         return task->get_future();
     }
 
     template <class F>
-    static auto runSync(F&& func) -> decltype(func()) {
+    static auto runSync(F&& func, Priority priority = Priority::Frame) -> decltype(func()) {
         std::packaged_task<decltype(func())()> task{std::forward<F>(func)};
-        post([&task]() { std::invoke(task); });
+        post([&task]() { std::invoke(task); }, priority);
         return task.get_future().get();
     };
 
+    // The number of worker threads, between MIN_THREAD_COUNT and MAX_THREAD_COUNT depending on
+    // the number of CPUs the process may run on.
+    static int getThreadCount();
+
     static std::vector<int> getThreadIds();
 
     // For testing purposes only, blocks until all worker threads are parked.
     static void waitForIdle();
 
 private:
+    static constexpr int PRIORITY_COUNT = 2;
+
+    struct QueuedTask {
+        Task task;
+        nsecs_t queueTime;
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<QueuedTask> lanes[PRIORITY_COUNT];
+    };
+
     static CommonPool& instance();
 
     CommonPool();
     ~CommonPool() {}
 
-    void enqueue(Task&&);
+    void enqueue(Task&&, Priority priority);
+    bool takeTask(int workerIndex, QueuedTask* outTask);
     void doWaitForIdle();
 
-    void workerLoop();
+    void workerLoop(int workerIndex);
 
     std::vector<int> mWorkerThreadIds;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::atomic_uint mNextWorker{0};
+    std::atomic_int mQueuedTasks{0};
 
+    // Guards parking and waking up idle workers.
     std::mutex mLock;
     std::condition_variable mCondition;
     int mWaitingThreads = 0;
-    ArrayQueue<Task, QUEUE_SIZE> mWorkQueue;
 };
 
 }  // namespace uirenderer
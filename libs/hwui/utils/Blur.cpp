@@ -16,8 +16,18 @@
 
 #include <math.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "Blur.h"
 #include "MathUtils.h"
+#ifdef __ANDROID__  // Layoutlib does not support CommonPool
+#include "thread/CommonPool.h"
+#endif
 
 namespace android {
 namespace uirenderer {
@@ -91,91 +101,109 @@ void Blur::generateGaussianWeights(float* weights, float radius) {
     }
 }
 
+namespace {
+
+// Below this many multiply-adds, handing bands to other threads costs more than it saves.
+constexpr int64_t kMinParallelWork = 1 << 20;
+constexpr int32_t kMaxBands = 8;
+
+// Splits [0, count) into bands and calls fn(begin, end) for each of them, on the CommonPool when
+// there is enough work. The calling thread takes bands as well, so this never waits on a worker
+// that hasn't started, even when called from the pool itself.
+template <typename F>
+void forEachBand(int32_t count, int64_t work, F&& fn) {
+#ifdef __ANDROID__  // Layoutlib does not support CommonPool
+    const int32_t bandCount =
+            static_cast<int32_t>(std::min<int64_t>({kMaxBands, count, work / kMinParallelWork}));
+    if (bandCount > 1) {
+        struct State {
+            std::atomic<int32_t> next{0};
+            std::atomic<int32_t> finished{0};
+            std::mutex lock;
+            std::condition_variable done;
+        };
+        auto state = std::make_shared<State>();
+        // fn is only reached through a band, and every band is finished before this returns.
+        auto runBands = [state, count, bandCount, fn = &fn]() {
+            int32_t band;
+            while ((band = state->next.fetch_add(1)) < bandCount) {
+                (*fn)(count * band / bandCount, count * (band + 1) / bandCount);
+                if (state->finished.fetch_add(1) + 1 == bandCount) {
+                    std::lock_guard lock(state->lock);
+                    state->done.notify_all();
+                }
+            }
+        };
+        for (int32_t i = 1; i < bandCount; i++) {
+            CommonPool::post(runBands);
+        }
+        runBands();
+        std::unique_lock lock(state->lock);
+        state->done.wait(lock, [&state, bandCount] { return state->finished == bandCount; });
+        return;
+    }
+#endif
+    fn(0, count);
+}
+
+}  // namespace
+
+// The taps are in the outer loops below so that the inner loops run over contiguous pixels with
+// no dependency between iterations, which the compiler vectorizes with NEON or SSE. Each output
+// pixel still sums its taps in the same order as a per-pixel loop would.
 void Blur::horizontal(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
                       int32_t width, int32_t height) {
-    float blurredPixel = 0.0f;
-    float currentPixel = 0.0f;
-
-    for (int32_t y = 0; y < height; y++) {
-        const uint8_t* input = source + y * width;
-        uint8_t* output = dest + y * width;
-
-        for (int32_t x = 0; x < width; x++) {
-            blurredPixel = 0.0f;
-            const float* gPtr = weights;
-            // Optimization for non-border pixels
-            if (x > radius && x < (width - radius)) {
-                const uint8_t* i = input + (x - radius);
-                for (int r = -radius; r <= radius; r++) {
-                    currentPixel = (float)(*i);
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
-                    i++;
-                }
-            } else {
-                for (int32_t r = -radius; r <= radius; r++) {
-                    // Stepping left and right away from the pixel
-                    int validW = x + r;
-                    if (validW < 0) {
-                        validW = 0;
-                    }
-                    if (validW > width - 1) {
-                        validW = width - 1;
-                    }
-
-                    currentPixel = (float)input[validW];
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
+    const int32_t taps = 2 * radius + 1;
+    forEachBand(height, int64_t(width) * height * taps, [&](int32_t begin, int32_t end) {
+        std::vector<float> row(width + 2 * radius);
+        std::vector<float> sums(width);
+        for (int32_t y = begin; y < end; y++) {
+            const uint8_t* input = source + y * width;
+            uint8_t* output = dest + y * width;
+
+            // Padding the row with its edge pixels is the same as clamping the taps to it.
+            std::fill_n(row.begin(), radius, input[0]);
+            std::copy(input, input + width, row.begin() + radius);
+            std::fill_n(row.begin() + radius + width, radius, input[width - 1]);
+
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            for (int32_t r = 0; r < taps; r++) {
+                const float weight = weights[r];
+                const float* tap = row.data() + r;
+                for (int32_t x = 0; x < width; x++) {
+                    sums[x] += tap[x] * weight;
                 }
             }
-            *output = (uint8_t)blurredPixel;
-            output++;
+            for (int32_t x = 0; x < width; x++) {
+                output[x] = (uint8_t)sums[x];
+            }
         }
-    }
+    });
 }
 
 void Blur::vertical(float* weights, int32_t radius, const uint8_t* source, uint8_t* dest,
                     int32_t width, int32_t height) {
-    float blurredPixel = 0.0f;
-    float currentPixel = 0.0f;
-
-    for (int32_t y = 0; y < height; y++) {
-        uint8_t* output = dest + y * width;
-
-        for (int32_t x = 0; x < width; x++) {
-            blurredPixel = 0.0f;
-            const float* gPtr = weights;
-            const uint8_t* input = source + x;
-            // Optimization for non-border pixels
-            if (y > radius && y < (height - radius)) {
-                const uint8_t* i = input + ((y - radius) * width);
-                for (int32_t r = -radius; r <= radius; r++) {
-                    currentPixel = (float)(*i);
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
-                    i += width;
-                }
-            } else {
-                for (int32_t r = -radius; r <= radius; r++) {
-                    int validH = y + r;
-                    // Clamp to zero and width
-                    if (validH < 0) {
-                        validH = 0;
-                    }
-                    if (validH > height - 1) {
-                        validH = height - 1;
-                    }
-
-                    const uint8_t* i = input + validH * width;
-                    currentPixel = (float)(*i);
-                    blurredPixel += currentPixel * gPtr[0];
-                    gPtr++;
+    const int32_t taps = 2 * radius + 1;
+    forEachBand(height, int64_t(width) * height * taps, [&](int32_t begin, int32_t end) {
+        std::vector<float> sums(width);
+        for (int32_t y = begin; y < end; y++) {
+            uint8_t* output = dest + y * width;
+
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            for (int32_t r = 0; r < taps; r++) {
+                const float weight = weights[r];
+                // Clamp to the first and last rows
+                const int32_t validH = std::clamp(y + r - radius, 0, height - 1);
+                const uint8_t* input = source + validH * width;
+                for (int32_t x = 0; x < width; x++) {
+                    sums[x] += (float)input[x] * weight;
                 }
             }
-            *output = (uint8_t)blurredPixel;
-            output++;
+            for (int32_t x = 0; x < width; x++) {
+                output[x] = (uint8_t)sums[x];
+            }
         }
-    }
+    });
 }
 
 }  // namespace uirenderer
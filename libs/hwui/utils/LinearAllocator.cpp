@@ -31,6 +31,8 @@
 #include <utils/Log.h>
 #include <utils/Macros.h>
 
+#include <mutex>
+
 // The ideal size of a page allocation (these need to be multiples of 8)
 #define INITIAL_PAGE_SIZE ((size_t)512)  // 512b
 #define MAX_PAGE_SIZE ((size_t)131072)   // 128kb
@@ -42,6 +44,11 @@
 // Must be smaller than INITIAL_PAGE_SIZE
 #define MAX_WASTE_RATIO (0.5f)
 
+// Page sizes the pool keeps pages of: INITIAL_PAGE_SIZE doubled up to MAX_PAGE_SIZE
+#define PAGE_SIZE_CLASS_COUNT 9
+// The most memory the pool holds on to between trims
+#define MAX_POOLED_BYTES ((size_t)1048576)  // 1mb
+
 #if LOG_NDEBUG
 #define ADD_ALLOCATION()
 #define RM_ALLOCATION()
@@ -93,6 +100,103 @@ private:
     Page* mNextPage;
 };
 
+/**
+ * Free pages of the standard page sizes, shared by all LinearAllocators. Display lists are
+ * re-recorded all the time, so this saves a round trip through malloc for most of their pages.
+ */
+class PagePool {
+public:
+    static PagePool& get() {
+        static PagePool& pool = *new PagePool();
+        return pool;
+    }
+
+    void* acquire(size_t allocSize) {
+        int sizeClass = sizeClassOf(allocSize);
+        if (sizeClass >= 0) {
+            std::lock_guard lock(mLock);
+            if (FreePage* page = mFreePages[sizeClass]) {
+                mFreePages[sizeClass] = page->next;
+                mPooledPages--;
+                mPooledBytes -= allocSize;
+                mHits++;
+                return page;
+            }
+            mMisses++;
+        }
+        return malloc(allocSize);
+    }
+
+    void release(void* buf, size_t allocSize) {
+        int sizeClass = sizeClassOf(allocSize);
+        if (sizeClass >= 0) {
+            std::lock_guard lock(mLock);
+            if (mPooledBytes + allocSize <= MAX_POOLED_BYTES) {
+                FreePage* page = reinterpret_cast<FreePage*>(buf);
+                page->next = mFreePages[sizeClass];
+                mFreePages[sizeClass] = page;
+                mPooledPages++;
+                mPooledBytes += allocSize;
+                return;
+            }
+        }
+        free(buf);
+    }
+
+    void trim() {
+        FreePage* pages[PAGE_SIZE_CLASS_COUNT];
+        {
+            std::lock_guard lock(mLock);
+            for (int i = 0; i < PAGE_SIZE_CLASS_COUNT; i++) {
+                pages[i] = mFreePages[i];
+                mFreePages[i] = nullptr;
+            }
+            mPooledPages = 0;
+            mPooledBytes = 0;
+        }
+        for (FreePage* page : pages) {
+            while (page) {
+                FreePage* next = page->next;
+                free(page);
+                page = next;
+            }
+        }
+    }
+
+    LinearAllocator::PagePoolStats stats() {
+        std::lock_guard lock(mLock);
+        return {mPooledPages, mPooledBytes, mHits, mMisses};
+    }
+
+    static size_t allocSizeOf(size_t pageSize) {
+        return ALIGN(pageSize + sizeof(LinearAllocator::Page));
+    }
+
+private:
+    struct FreePage {
+        FreePage* next;
+    };
+
+    PagePool() {}
+
+    // Returns the size class of allocations of allocSize, or -1 if it isn't a standard size.
+    static int sizeClassOf(size_t allocSize) {
+        for (int i = 0; i < PAGE_SIZE_CLASS_COUNT; i++) {
+            if (allocSize == allocSizeOf(INITIAL_PAGE_SIZE << i)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    std::mutex mLock;
+    FreePage* mFreePages[PAGE_SIZE_CLASS_COUNT] = {};
+    size_t mPooledPages = 0;
+    size_t mPooledBytes = 0;
+    size_t mHits = 0;
+    size_t mMisses = 0;
+};
+
 LinearAllocator::LinearAllocator()
         : mPageSize(INITIAL_PAGE_SIZE)
         , mMaxAllocSize(INITIAL_PAGE_SIZE * MAX_WASTE_RATIO)
@@ -110,7 +214,18 @@ LinearAllocator::~LinearAllocator(void) {
         mDtorList = node->next;
         node->dtor(node->addr);
     }
+    // mPages only holds standard pages, so their sizes follow from their position in the list.
+    size_t pageSize = INITIAL_PAGE_SIZE;
     Page* p = mPages;
+    while (p) {
+        Page* next = p->next();
+        p->~Page();
+        PagePool::get().release(p, PagePool::allocSizeOf(pageSize));
+        RM_ALLOCATION();
+        pageSize = min(MAX_PAGE_SIZE, pageSize * 2);
+        p = next;
+    }
+    p = mDedicatedPages;
     while (p) {
         Page* next = p->next();
         p->~Page();
@@ -120,6 +235,14 @@ LinearAllocator::~LinearAllocator(void) {
     }
 }
 
+LinearAllocator::PagePoolStats LinearAllocator::getPagePoolStats() {
+    return PagePool::get().stats();
+}
+
+void LinearAllocator::trimPagePool() {
+    PagePool::get().trim();
+}
+
 void* LinearAllocator::start(Page* p) {
     return ALIGN_PTR((size_t)p + sizeof(Page));
 }
@@ -159,9 +282,8 @@ void* LinearAllocator::allocImpl(size_t size) {
         // Allocation is too large, create a dedicated page for the allocation
         Page* page = newPage(size);
         mDedicatedPageCount++;
-        page->setNext(mPages);
-        mPages = page;
-        if (!mCurrentPage) mCurrentPage = mPages;
+        page->setNext(mDedicatedPages);
+        mDedicatedPages = page;
         return start(page);
     }
     ensureNext(size);
@@ -209,7 +331,7 @@ void LinearAllocator::rewindIfLastAlloc(void* ptr, size_t allocSize) {
     runDestructorFor(ptr);
     // Don't bother rewinding across pages
     allocSize = ALIGN(allocSize);
-    if (ptr >= start(mCurrentPage) && ptr < end(mCurrentPage) &&
+    if (mCurrentPage && ptr >= start(mCurrentPage) && ptr < end(mCurrentPage) &&
         ptr == ((char*)mNext - allocSize)) {
         mWastedSpace += allocSize;
         mNext = ptr;
@@ -217,11 +339,11 @@ void LinearAllocator::rewindIfLastAlloc(void* ptr, size_t allocSize) {
 }
 
 LinearAllocator::Page* LinearAllocator::newPage(size_t pageSize) {
-    pageSize = ALIGN(pageSize + sizeof(LinearAllocator::Page));
+    pageSize = PagePool::allocSizeOf(pageSize);
     ADD_ALLOCATION();
     mTotalAllocated += pageSize;
     mPageCount++;
-    void* buf = malloc(pageSize);
+    void* buf = PagePool::get().acquire(pageSize);
     return new (buf) Page();
 }
 
@@ -117,7 +117,27 @@ public:
     size_t usedSize() const { return mTotalAllocated - mWastedSpace; }
     size_t allocatedSize() const { return mTotalAllocated; }
 
+    struct PagePoolStats {
+        size_t pooledPages;
+        size_t pooledBytes;
+        size_t hits;
+        size_t misses;
+    };
+
+    /**
+     * Pages of the standard sizes are handed back to a process-wide pool when an allocator is
+     * destroyed, for the next allocators to reuse. Returns the current state of that pool.
+     */
+    static PagePoolStats getPagePoolStats();
+
+    /**
+     * Frees the pages held by the pool.
+     */
+    static void trimPagePool();
+
 private:
+    friend class PagePool;
+
     LinearAllocator(const LinearAllocator& other);
 
     class Page;
@@ -142,7 +162,10 @@ private:
     size_t mMaxAllocSize;
     void* mNext;
     Page* mCurrentPage;
+    // The pages of the standard sizes, in allocation order
     Page* mPages;
+    // The pages dedicated to a single large allocation
+    Page* mDedicatedPages = nullptr;
     DestructorNode* mDtorList = nullptr;
 
     // Memory usage tracking
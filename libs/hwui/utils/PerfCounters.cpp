@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerfCounters.h"
+
+#include "Properties.h"
+
+#include <linux/perf_event.h>
+#include <log/log.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <errno.h>
+#include <string.h>
+
+namespace android {
+namespace uirenderer {
+
+static int openCounter(uint64_t config, int groupFd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0 /* this thread */,
+                                    -1 /* any cpu */, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+PerfCounters* PerfCounters::forCurrentThread() {
+    if (CC_LIKELY(!Properties::sampleFrameCounters)) {
+        return nullptr;
+    }
+    // Counters follow the thread that opened them, so each thread gets its own. A thread that
+    // failed to open them doesn't try again.
+    thread_local bool sOpened = false;
+    thread_local PerfCounters* sCounters = nullptr;
+    if (!sOpened) {
+        sOpened = true;
+        PerfCounters* counters = new PerfCounters();
+        if (counters->open()) {
+            sCounters = counters;
+        } else {
+            delete counters;
+        }
+    }
+    return sCounters;
+}
+
+bool PerfCounters::open() {
+    // Cycles lead the group so that all three are scheduled, and read, together.
+    mCycles.reset(openCounter(PERF_COUNT_HW_CPU_CYCLES, -1));
+    if (mCycles.get() < 0) {
+        int err = errno;
+        ALOGW("Failed to open the cycles counter, err %d %s", err, strerror(err));
+        return false;
+    }
+    mInstructions.reset(openCounter(PERF_COUNT_HW_INSTRUCTIONS, mCycles.get()));
+    mCacheMisses.reset(openCounter(PERF_COUNT_HW_CACHE_MISSES, mCycles.get()));
+    if (mInstructions.get() < 0 || mCacheMisses.get() < 0) {
+        int err = errno;
+        ALOGW("Failed to open the instructions and cache misses counters, err %d %s", err,
+              strerror(err));
+        return false;
+    }
+    return true;
+}
+
+bool PerfCounters::read(FrameStageCounters* outCounters) {
+    struct {
+        uint64_t count;
+        uint64_t values[3];
+    } group;
+    if (::read(mCycles.get(), &group, sizeof(group)) != sizeof(group) || group.count != 3) {
+        return false;
+    }
+    outCounters->cycles = static_cast<int64_t>(group.values[0]);
+    outCounters->instructions = static_cast<int64_t>(group.values[1]);
+    outCounters->cacheMisses = static_cast<int64_t>(group.values[2]);
+    return true;
+}
+
+} /* namespace uirenderer */
+} /* namespace android */
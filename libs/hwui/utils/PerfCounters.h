@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "FrameInfo.h"
+#include "utils/Macros.h"
+
+#include <android-base/unique_fd.h>
+
+namespace android {
+namespace uirenderer {
+
+/**
+ * Hardware counters (cycles, instructions and cache misses) of the calling thread, read through
+ * perf_event_open. Only used when Properties::sampleFrameCounters is set.
+ */
+class PerfCounters {
+    PREVENT_COPY_AND_ASSIGN(PerfCounters);
+
+public:
+    // Returns the counters of the calling thread, opening them on first use. Returns nullptr if
+    // sampling is disabled or the counters aren't available, e.g. because of the perf_event
+    // paranoia level.
+    static PerfCounters* forCurrentThread();
+
+    // Reads the current value of every counter. Returns false on failure.
+    bool read(FrameStageCounters* outCounters);
+
+private:
+    PerfCounters() {}
+    bool open();
+
+    base::unique_fd mCycles;
+    base::unique_fd mInstructions;
+    base::unique_fd mCacheMisses;
+};
+
+/**
+ * Adds the counters spent during its lifetime to a FrameStageCounters. Does nothing if counters
+ * is nullptr.
+ */
+class ScopedFrameCounters {
+    PREVENT_COPY_AND_ASSIGN(ScopedFrameCounters);
+
+public:
+    ScopedFrameCounters(PerfCounters* counters, FrameStageCounters& out)
+            : mCounters(counters), mOut(out) {
+        if (mCounters && !mCounters->read(&mStart)) {
+            mCounters = nullptr;
+        }
+    }
+
+    ~ScopedFrameCounters() {
+        FrameStageCounters end;
+        if (mCounters && mCounters->read(&end)) {
+            mOut.cycles += end.cycles - mStart.cycles;
+            mOut.instructions += end.instructions - mStart.instructions;
+            mOut.cacheMisses += end.cacheMisses - mStart.cacheMisses;
+        }
+    }
+
+private:
+    PerfCounters* mCounters;
+    FrameStageCounters& mOut;
+    FrameStageCounters mStart;
+};
+
+} /* namespace uirenderer */
+} /* namespace android */
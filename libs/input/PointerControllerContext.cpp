@@ -211,6 +211,15 @@ void PointerControllerContext::PointerAnimator::startAnimationLocked() REQUIRES(
 
 void PointerControllerContext::PointerAnimator::handleCallbacksLocked(nsecs_t timestamp)
         REQUIRES(mLock) {
+    if (mLocked.callbacks.empty()) {
+        // The last animation was removed after the vsync was requested.
+        return;
+    }
+
+    // Controllers of every display animate in the same sprite transaction, so that a frame
+    // results in a single sprite update no matter how many of them changed their sprites.
+    sp<SpriteController> spriteController = mContext.getSpriteController();
+    spriteController->openTransaction();
     for (auto it = mLocked.callbacks.begin(); it != mLocked.callbacks.end();) {
         bool keepCallback = it->second(timestamp);
         if (!keepCallback) {
@@ -219,6 +228,7 @@ void PointerControllerContext::PointerAnimator::handleCallbacksLocked(nsecs_t ti
             ++it;
         }
     }
+    spriteController->closeTransaction();
 
     if (!mLocked.callbacks.empty()) {
         startAnimationLocked();
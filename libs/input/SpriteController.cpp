@@ -20,6 +20,7 @@
 #include "SpriteController.h"
 
 #include <log/log.h>
+#include <string.h>
 #include <utils/String8.h>
 #include <gui/Surface.h>
 
@@ -363,20 +364,39 @@ SpriteController::SpriteImpl::~SpriteImpl() {
     }
 }
 
+// Returns true if the bitmap would redraw to exactly the pixels of the current RGBA_8888 copy.
+static bool hasSamePixels(const graphics::Bitmap& bitmap, const graphics::Bitmap& current) {
+    const AndroidBitmapInfo info = bitmap.getInfo();
+    const AndroidBitmapInfo currentInfo = current.getInfo();
+    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 || info.width != currentInfo.width ||
+        info.height != currentInfo.height || info.stride != currentInfo.stride ||
+        bitmap.getDataSpace() != current.getDataSpace()) {
+        return false;
+    }
+    const void* pixels = bitmap.getPixels();
+    const void* currentPixels = current.getPixels();
+    return pixels != nullptr && currentPixels != nullptr &&
+            memcmp(pixels, currentPixels, size_t(info.stride) * info.height) == 0;
+}
+
 void SpriteController::SpriteImpl::setIcon(const SpriteIcon& icon) {
     AutoMutex _l(mController->mLock);
 
-    uint32_t dirty;
+    uint32_t dirty = 0;
     if (icon.isValid()) {
-        mLocked.state.icon.bitmap = icon.bitmap.copy(ANDROID_BITMAP_FORMAT_RGBA_8888);
-        if (!mLocked.state.icon.isValid()
+        const bool wasValid = mLocked.state.icon.isValid();
+        // Setting the icon the sprite already shows, e.g. when the pointer type is requested
+        // again, must not copy the bitmap and redraw the surface.
+        if (!wasValid || !hasSamePixels(icon.bitmap, mLocked.state.icon.bitmap)) {
+            mLocked.state.icon.bitmap = icon.bitmap.copy(ANDROID_BITMAP_FORMAT_RGBA_8888);
+            dirty |= DIRTY_BITMAP;
+        }
+        if (!wasValid
                 || mLocked.state.icon.hotSpotX != icon.hotSpotX
                 || mLocked.state.icon.hotSpotY != icon.hotSpotY) {
             mLocked.state.icon.hotSpotX = icon.hotSpotX;
             mLocked.state.icon.hotSpotY = icon.hotSpotY;
-            dirty = DIRTY_BITMAP | DIRTY_HOTSPOT;
-        } else {
-            dirty = DIRTY_BITMAP;
+            dirty |= DIRTY_HOTSPOT;
         }
 
         if (mLocked.state.icon.style != icon.style) {
@@ -386,10 +406,11 @@ void SpriteController::SpriteImpl::setIcon(const SpriteIcon& icon) {
     } else if (mLocked.state.icon.isValid()) {
         mLocked.state.icon.bitmap.reset();
         dirty = DIRTY_BITMAP | DIRTY_HOTSPOT | DIRTY_ICON_STYLE;
-    } else {
-        return; // setting to invalid icon and already invalid so nothing to do
     }
 
+    if (dirty == 0) {
+        return; // nothing to do, the icon is unchanged
+    }
     invalidateLocked(dirty);
 }
 
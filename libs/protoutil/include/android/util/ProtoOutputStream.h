@@ -18,10 +18,13 @@
 #define ANDROID_UTIL_PROTOOUTPUT_STREAM_H
 
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <android/util/EncodedBuffer.h>
+#include <android/util/protobuf.h>
 
 namespace android {
 namespace util {
@@ -105,6 +108,16 @@ public:
     bool write(uint64_t fieldId, std::string val);
     bool write(uint64_t fieldId, const char* val, size_t size);
 
+    /**
+     * Write APIs for a fieldId known at compile time, such as the constants generated by
+     * protoc-gen-cppstream. The type of the value is checked against the field type, and the
+     * encoding picked, at compile time. The output is the same as write(fieldId, val).
+     */
+    template<uint64_t fieldId, typename T>
+    bool write(const T& val);
+    template<uint64_t fieldId>
+    bool write(const char* val, size_t size);
+
     /**
      * Starts a sub-message write session.
      * Returns a token of this write session.
@@ -113,6 +126,13 @@ public:
     uint64_t start(uint64_t fieldId);
     void end(uint64_t token);
 
+    /**
+     * Starts a sub-message write session whose encoded size is already known, so that it is
+     * written in its final form and needs no compaction. Exactly size bytes must be written
+     * before end(token), and only sub-messages with a known size can be nested in it.
+     */
+    uint64_t start(uint64_t fieldId, size_t size);
+
     /**
      * Returns how many bytes are buffered in ProtoOutputStream.
      * Notice, this is not the actual(compact) size of the output data.
@@ -136,7 +156,7 @@ public:
 
     // Please don't use the following functions to dump protos unless you are familiar with protobuf encoding.
     void writeRawVarint(uint64_t varint);
-    void writeLengthDelimitedHeader(uint32_t id, size_t size);
+    void writeLengthDelimitedHeader(uint32_t id, size_t size); // Must be followed by size bytes.
     void writeRawByte(uint8_t byte);
 
 private:
@@ -146,6 +166,8 @@ private:
     uint32_t mDepth;
     uint32_t mObjectId;
     uint64_t mExpectedObjectToken;
+    bool mNeedsCompaction;                    // True once a sub-message of unknown size is ended.
+    std::vector<uint64_t> mSizedObjectTokens; // Tokens of the enclosing sub-messages of known size.
 
     inline void writeDoubleImpl(uint32_t id, double val);
     inline void writeFloatImpl(uint32_t id, float val);
@@ -170,8 +192,102 @@ private:
 
     template<typename T>
     bool internalWrite(uint64_t fieldId, T val, const char* typeName);
+
+    template<uint32_t id, uint8_t wireType>
+    inline void writeTag();
 };
 
+template<uint32_t id, uint8_t wireType>
+inline void
+ProtoOutputStream::writeTag()
+{
+    constexpr uint32_t tag = (id << FIELD_ID_SHIFT) | wireType;
+    if constexpr (tag < 0x80) {
+        mBuffer->writeRawByte((uint8_t)tag);
+    } else if constexpr (tag < 0x4000) {
+        mBuffer->writeRawByte((uint8_t)((tag & 0x7F) | 0x80));
+        mBuffer->writeRawByte((uint8_t)(tag >> 7));
+    } else {
+        mBuffer->writeRawVarint32(tag);
+    }
+}
+
+template<uint64_t fieldId, typename T>
+inline bool
+ProtoOutputStream::write(const T& val)
+{
+    constexpr uint64_t type = fieldId & FIELD_TYPE_MASK;
+    constexpr uint32_t id = (uint32_t)fieldId;
+    if (mCompact) return false;
+
+    if constexpr (type == FIELD_TYPE_STRING) {
+        static_assert(std::is_convertible<T, std::string>::value,
+                "A string field can only be written from a string.");
+        const std::string& str = val;
+        writeLengthDelimitedHeader(id, str.size());
+        mBuffer->writeRaw((const uint8_t*)str.data(), str.size());
+    } else if constexpr (type == FIELD_TYPE_BOOL || type == FIELD_TYPE_ENUM) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "A bool or enum field can only be written from an integral value.");
+        writeTag<id, WIRE_TYPE_VARINT>();
+        mBuffer->writeRawVarint32(type == FIELD_TYPE_BOOL ? (val ? 1 : 0) : (uint32_t)(int)val);
+    } else {
+        static_assert(std::is_arithmetic<T>::value,
+                "A numeric field can only be written from an arithmetic value.");
+        if constexpr (type == FIELD_TYPE_DOUBLE) {
+            double d = (double)val;
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            writeTag<id, WIRE_TYPE_FIXED64>();
+            mBuffer->writeRawFixed64(bits);
+        } else if constexpr (type == FIELD_TYPE_FLOAT) {
+            float f = (float)val;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            writeTag<id, WIRE_TYPE_FIXED32>();
+            mBuffer->writeRawFixed32(bits);
+        } else if constexpr (type == FIELD_TYPE_INT64 || type == FIELD_TYPE_UINT64) {
+            writeTag<id, WIRE_TYPE_VARINT>();
+            mBuffer->writeRawVarint64((uint64_t)val);
+        } else if constexpr (type == FIELD_TYPE_INT32 || type == FIELD_TYPE_UINT32) {
+            writeTag<id, WIRE_TYPE_VARINT>();
+            mBuffer->writeRawVarint32((uint32_t)val);
+        } else if constexpr (type == FIELD_TYPE_FIXED64 || type == FIELD_TYPE_SFIXED64) {
+            writeTag<id, WIRE_TYPE_FIXED64>();
+            mBuffer->writeRawFixed64((uint64_t)val);
+        } else if constexpr (type == FIELD_TYPE_FIXED32 || type == FIELD_TYPE_SFIXED32) {
+            writeTag<id, WIRE_TYPE_FIXED32>();
+            mBuffer->writeRawFixed32((uint32_t)val);
+        } else if constexpr (type == FIELD_TYPE_SINT64) {
+            int64_t v = (int64_t)val;
+            writeTag<id, WIRE_TYPE_VARINT>();
+            mBuffer->writeRawVarint64((v << 1) ^ (v >> 63));
+        } else if constexpr (type == FIELD_TYPE_SINT32) {
+            int32_t v = (int32_t)val;
+            writeTag<id, WIRE_TYPE_VARINT>();
+            mBuffer->writeRawVarint32((v << 1) ^ (v >> 31));
+        } else {
+            static_assert(type == FIELD_TYPE_DOUBLE, "The field type can't be written from a value.");
+        }
+    }
+    return true;
+}
+
+template<uint64_t fieldId>
+inline bool
+ProtoOutputStream::write(const char* val, size_t size)
+{
+    constexpr uint64_t type = fieldId & FIELD_TYPE_MASK;
+    static_assert(type == FIELD_TYPE_STRING || type == FIELD_TYPE_BYTES
+            || type == FIELD_TYPE_MESSAGE,
+            "Only a string, bytes or message field can be written from char[].");
+    if (mCompact) return false;
+    if (val == NULL) return true;
+    writeLengthDelimitedHeader((uint32_t)fieldId, size);
+    mBuffer->writeRaw((const uint8_t*)val, size);
+    return true;
+}
+
 }
 }
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <android/util/ProtoReader.h>
+
+namespace android {
+namespace util {
+
+/**
+ * A ProtoReader on top of a list of memory spans, such as the iovecs of a scatter list or a
+ * mapped file. The data is read in place: readBuffer() and currentToRead() return a whole span.
+ */
+class ProtoSpanReader : public ProtoReader
+{
+public:
+    /**
+     * Read from these spans, in order. The memory is NOT owned and must outlive the reader.
+     */
+    ProtoSpanReader(const struct iovec* iov, int iovcnt);
+
+    /**
+     * Maps the data from the current offset to the end of the file in fd and reads from it.
+     * Returns NULL if fd is not a regular file or can't be mapped. Does NOT move the file
+     * offset, nor close the file.
+     */
+    static sp<ProtoSpanReader> mapFile(int fd);
+
+    /**
+     * Unmaps the file if there is one.
+     */
+    virtual ~ProtoSpanReader();
+
+    // From ProtoReader.
+    virtual ssize_t size() const;
+    virtual size_t bytesRead() const;
+    virtual uint8_t const* readBuffer();
+    virtual size_t currentToRead();
+    virtual bool hasNext();
+    virtual uint8_t next();
+    virtual uint64_t readRawVarint();
+    virtual void move(size_t amt);
+
+    status_t getError() const;
+private:
+    std::vector<struct iovec> mSpans;   // The non empty spans to read.
+    status_t mStatus;                   // Any errors encountered during read.
+    size_t mSize;                       // How much total data there is.
+    size_t mPos;                        // How much data has been read so far.
+    size_t mIndex;                      // Index of the current span.
+    size_t mOffset;                     // Offset in the current span.
+    void* mMapped;                      // The mapped file, if any.
+    size_t mMappedSize;                 // Size of the mapping.
+
+    ProtoSpanReader();
+};
+
+} // util
+} // android
@@ -45,6 +45,12 @@ uint32_t read_field_id(uint32_t varint);
  */
 size_t get_varint_size(uint64_t varint);
 
+/**
+ * Read a varint from the buffer, which ends at end. Return the position after the varint, or
+ * NULL if the buffer ends before it does.
+ */
+const uint8_t* read_raw_varint(const uint8_t* buf, const uint8_t* end, uint64_t* val);
+
 /**
  * Write a varint into the buffer. Return the next position to write at.
  * There must be 10 bytes in the buffer.
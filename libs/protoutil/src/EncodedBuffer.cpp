@@ -15,6 +15,8 @@
  */
 #define LOG_TAG "libprotoutil"
 
+#include <algorithm>
+
 #include <stdlib.h>
 #include <sys/mman.h>
 
@@ -339,9 +341,16 @@ EncodedBuffer::copy(size_t srcPos, size_t size)
     Pointer cp(mChunkSize);
     cp.move(srcPos);
 
-    while (cp.pos() < srcPos + size) {
-        writeRawByte(*at(cp));
-        cp.move();
+    // Copy the spans that are contiguous in both the source and the destination chunks. The
+    // source is never behind the write pointer, so the spans can only overlap in the same chunk.
+    while (size > 0) {
+        uint8_t* target = writeBuffer();
+        if (target == NULL) return;
+        size_t chunk = std::min(size, std::min(currentToWrite(), mChunkSize - cp.offset()));
+        memmove(target, at(cp), chunk);
+        size -= chunk;
+        cp.move(chunk);
+        mWp.move(chunk);
     }
 }
 
@@ -404,6 +413,17 @@ EncodedBuffer::Reader::next()
 uint64_t
 EncodedBuffer::Reader::readRawVarint()
 {
+    // Decode straight from the chunk unless the varint crosses into the next one.
+    const uint8_t* buf = readBuffer();
+    if (buf != NULL) {
+        uint64_t val;
+        const uint8_t* end = read_raw_varint(buf, buf + currentToRead(), &val);
+        if (end != NULL) {
+            mRp.move(end - buf);
+            return val;
+        }
+    }
+
     uint64_t val = 0, shift = 0;
     while (true) {
         uint8_t byte = next();
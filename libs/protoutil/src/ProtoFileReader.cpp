@@ -16,6 +16,7 @@
 #define LOG_TAG "libprotoutil"
 
 #include <android/util/ProtoFileReader.h>
+#include <android/util/protobuf.h>
 #include <cutils/log.h>
 
 #include <cinttypes>
@@ -105,6 +106,17 @@ ProtoFileReader::next()
 uint64_t
 ProtoFileReader::readRawVarint()
 {
+    // Decode straight from mBuffer unless the varint crosses into the next read.
+    if (ensure_data()) {
+        uint64_t val;
+        const uint8_t* buf = mBuffer + mOffset;
+        const uint8_t* end = read_raw_varint(buf, mBuffer + mMaxOffset, &val);
+        if (end != NULL) {
+            mOffset += end - buf;
+            return val;
+        }
+    }
+
     uint64_t val = 0, shift = 0;
     while (true) {
         if (!hasNext()) {
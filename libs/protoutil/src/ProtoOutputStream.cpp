@@ -26,6 +26,13 @@
 namespace android {
 namespace util {
 
+/**
+ * Wire type of the tag of a sub-message whose size is not known yet. The two 32 bit size
+ * fields after it are turned into a length delimited header by compact(). Every other length
+ * delimited field is written in its final form, so compact() can skip over it.
+ */
+static const uint8_t WIRE_TYPE_UNSIZED_MESSAGE = 7;
+
 ProtoOutputStream::ProtoOutputStream(): ProtoOutputStream(new EncodedBuffer())
 {
 }
@@ -36,7 +43,9 @@ ProtoOutputStream::ProtoOutputStream(sp<EncodedBuffer> buffer)
          mCompact(false),
          mDepth(0),
          mObjectId(0),
-         mExpectedObjectToken(UINT64_C(-1))
+         mExpectedObjectToken(UINT64_C(-1)),
+         mNeedsCompaction(false),
+         mSizedObjectTokens()
 {
 }
 
@@ -54,6 +63,8 @@ ProtoOutputStream::clear()
     mDepth = 0;
     mObjectId = 0;
     mExpectedObjectToken = UINT64_C(-1);
+    mNeedsCompaction = false;
+    mSizedObjectTokens.clear();
 }
 
 template<typename T>
@@ -209,7 +220,7 @@ ProtoOutputStream::write(uint64_t fieldId, const char* val, size_t size)
 /**
  * Make a token.
  *  Bits 61-63 - tag size (So we can go backwards later if the object had not data)
- *                - 3 bits, max value 7, max value needed 5
+ *                - 3 bits, max value 7, max value needed 5, 0 if the object size is known
  *  Bit  60    - true if the object is repeated
  *  Bits 59-51 - depth (For error checking)
  *                - 9 bits, max value 511, when checking, value is masked (if we really
@@ -217,7 +228,8 @@ ProtoOutputStream::write(uint64_t fieldId, const char* val, size_t size)
  *  Bits 32-50 - objectId (For error checking)
  *                - 19 bits, max value 524,287. that's a lot of objects. IDs will wrap
  *                  because of the overflow, and only the tokens are compared.
- *  Bits  0-31 - offset of the first size field in the buffer.
+ *  Bits  0-31 - offset of the first size field in the buffer, or of the end of the object
+ *                if its size is known.
  */
 static uint64_t
 makeToken(uint32_t tagSize, bool repeated, uint32_t depth, uint32_t objectId, size_t sizePos) {
@@ -257,9 +269,16 @@ ProtoOutputStream::start(uint64_t fieldId)
         return 0;
     }
 
+    if (!mSizedObjectTokens.empty()) {
+        ALOGE("Can't call start without a size in a sub-message of known size: 0x%" PRIx64,
+                fieldId);
+        mDepth = UINT32_C(-1); // make depth invalid
+        return 0;
+    }
+
     uint32_t id = (uint32_t)fieldId;
     size_t prevPos = mBuffer->wp()->pos();
-    mBuffer->writeHeader(id, WIRE_TYPE_LENGTH_DELIMITED);
+    mBuffer->writeHeader(id, WIRE_TYPE_UNSIZED_MESSAGE);
     size_t sizePos = mBuffer->wp()->pos();
 
     mDepth++;
@@ -271,6 +290,26 @@ ProtoOutputStream::start(uint64_t fieldId)
     return mExpectedObjectToken;
 }
 
+uint64_t
+ProtoOutputStream::start(uint64_t fieldId, size_t size)
+{
+    if ((fieldId & FIELD_TYPE_MASK) != FIELD_TYPE_MESSAGE) {
+        ALOGE("Can't call start for non-message type field: 0x%" PRIx64, fieldId);
+        return 0;
+    }
+
+    writeLengthDelimitedHeader((uint32_t)fieldId, size);
+    size_t endPos = mBuffer->wp()->pos() + size;
+
+    mDepth++;
+    mObjectId++;
+    mSizedObjectTokens.push_back(mExpectedObjectToken); // push previous token into stack.
+
+    mExpectedObjectToken = makeToken(0, (bool)(fieldId & FIELD_COUNT_REPEATED), mDepth,
+        mObjectId, endPos);
+    return mExpectedObjectToken;
+}
+
 void
 ProtoOutputStream::end(uint64_t token)
 {
@@ -288,6 +327,19 @@ ProtoOutputStream::end(uint64_t token)
     }
     mDepth--;
 
+    if (getTagSizeFromToken(token) == 0) {
+        // The size of the object was given to start, and has already been written.
+        size_t endPos = getSizePosFromToken(token);
+        if (mBuffer->wp()->pos() != endPos) {
+            ALOGE("Unexpected object end at %zu, should be at %zu", mBuffer->wp()->pos(), endPos);
+            mDepth = UINT32_C(-1); // make depth invalid
+            return;
+        }
+        mExpectedObjectToken = mSizedObjectTokens.back();
+        mSizedObjectTokens.pop_back();
+        return;
+    }
+
     uint32_t sizePos = getSizePosFromToken(token);
     // number of bytes written in this start-end session.
     int childRawSize = mBuffer->wp()->pos() - sizePos - 8;
@@ -300,6 +352,7 @@ ProtoOutputStream::end(uint64_t token)
     if (childRawSize > 0) {
         mBuffer->editRawFixed32(sizePos, -childRawSize);
         mBuffer->editRawFixed32(sizePos+4, -1);
+        mNeedsCompaction = true;
     } else {
         // reset wp which erase the header tag of the message when its size is 0.
         mBuffer->wp()->rewind()->move(sizePos - getTagSizeFromToken(token));
@@ -319,6 +372,12 @@ ProtoOutputStream::compact() {
         ALOGE("Can't compact when depth(%" PRIu32 ") is not zero. Missing or extra calls to end.", mDepth);
         return false;
     }
+    // Nothing to do if every length delimited field has been written with its final size.
+    if (!mNeedsCompaction) {
+        mCompact = true;
+        return true;
+    }
+
     // record the size of the original buffer.
     size_t rawBufferSize = mBuffer->size();
     if (rawBufferSize == 0) return true; // nothing to do if the buffer is empty;
@@ -374,12 +433,15 @@ ProtoOutputStream::editEncodedSize(size_t rawSize)
                 mBuffer->ep()->move(8);
                 break;
             case WIRE_TYPE_LENGTH_DELIMITED:
+                childEncodedSize = (int)mBuffer->readRawVarint();
+                mBuffer->ep()->move(childEncodedSize);
+                encodedSize += get_varint_size(childEncodedSize) + childEncodedSize;
+                break;
+            case WIRE_TYPE_UNSIZED_MESSAGE:
                 childRawSize = (int)mBuffer->readRawFixed32();
                 childEncodedSizePos = mBuffer->ep()->pos();
                 childEncodedSize = (int)mBuffer->readRawFixed32();
-                if (childRawSize >= 0 && childRawSize == childEncodedSize) {
-                    mBuffer->ep()->move(childRawSize);
-                } else if (childRawSize < 0 && childEncodedSize == -1){
+                if (childRawSize < 0 && childEncodedSize == -1){
                     childEncodedSize = editEncodedSize(-childRawSize);
                     mBuffer->editRawFixed32(childEncodedSizePos, childEncodedSize);
                 } else {
@@ -415,6 +477,7 @@ ProtoOutputStream::compactSize(size_t rawSize)
     int childRawSize, childEncodedSize;
 
     while (mBuffer->ep()->pos() < objectEnd) {
+        size_t tagPos = mBuffer->ep()->pos();
         uint32_t tag = (uint32_t)mBuffer->readRawVarint();
         switch (read_wire_type(tag)) {
             case WIRE_TYPE_VARINT:
@@ -424,17 +487,19 @@ ProtoOutputStream::compactSize(size_t rawSize)
                 mBuffer->ep()->move(8);
                 break;
             case WIRE_TYPE_LENGTH_DELIMITED:
-                mBuffer->copy(mCopyBegin, mBuffer->ep()->pos() - mCopyBegin);
+                mBuffer->ep()->move(mBuffer->readRawVarint());
+                break;
+            case WIRE_TYPE_UNSIZED_MESSAGE:
+                mBuffer->copy(mCopyBegin, tagPos - mCopyBegin);
 
                 childRawSize = (int)mBuffer->readRawFixed32();
                 childEncodedSize = (int)mBuffer->readRawFixed32();
                 mCopyBegin = mBuffer->ep()->pos();
 
-                // write encoded size to buffer.
+                // write the tag as a length delimited one, and the encoded size to buffer.
+                mBuffer->writeHeader(read_field_id(tag), WIRE_TYPE_LENGTH_DELIMITED);
                 mBuffer->writeRawVarint32(childEncodedSize);
-                if (childRawSize >= 0 && childRawSize == childEncodedSize) {
-                    mBuffer->ep()->move(childEncodedSize);
-                } else if (childRawSize < 0){
+                if (childRawSize < 0) {
                     if (!compactSize(-childRawSize)) return false;
                 } else {
                     ALOGE("Bad raw or encoded values: raw=%d, encoded=%d",
@@ -533,9 +598,7 @@ void
 ProtoOutputStream::writeLengthDelimitedHeader(uint32_t id, size_t size)
 {
     mBuffer->writeHeader(id, WIRE_TYPE_LENGTH_DELIMITED);
-    // reserves 64 bits for length delimited fields, if first field is negative, compact it.
-    mBuffer->writeRawFixed32(size);
-    mBuffer->writeRawFixed32(size);
+    mBuffer->writeRawVarint32(size);
 }
 
 void
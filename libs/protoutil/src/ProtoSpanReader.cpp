@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "libprotoutil"
+
+#include <android/util/ProtoSpanReader.h>
+#include <android/util/protobuf.h>
+#include <cutils/log.h>
+
+#include <cinttypes>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace android {
+namespace util {
+
+ProtoSpanReader::ProtoSpanReader()
+        :mSpans(),
+         mStatus(NO_ERROR),
+         mSize(0),
+         mPos(0),
+         mIndex(0),
+         mOffset(0),
+         mMapped(NULL),
+         mMappedSize(0) {
+}
+
+ProtoSpanReader::ProtoSpanReader(const struct iovec* iov, int iovcnt)
+        :ProtoSpanReader() {
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0) {
+            mSpans.push_back(iov[i]);
+            mSize += iov[i].iov_len;
+        }
+    }
+}
+
+sp<ProtoSpanReader>
+ProtoSpanReader::mapFile(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return NULL;
+    }
+    off_t current = lseek(fd, 0, SEEK_CUR);
+    if (current < 0 || current > st.st_size) {
+        return NULL;
+    }
+
+    sp<ProtoSpanReader> reader = new ProtoSpanReader();
+    if (current == st.st_size) {
+        return reader;
+    }
+
+    // The mapping has to start on a page boundary.
+    off_t start = current - current % sysconf(_SC_PAGE_SIZE);
+    size_t mappedSize = (size_t)(st.st_size - start);
+    void* mapped = mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE, fd, start);
+    if (mapped == MAP_FAILED) {
+        ALOGW("ProtoSpanReader can't map the file: %s", strerror(errno));
+        return NULL;
+    }
+    madvise(mapped, mappedSize, MADV_SEQUENTIAL);
+
+    reader->mMapped = mapped;
+    reader->mMappedSize = mappedSize;
+    struct iovec span;
+    span.iov_base = static_cast<uint8_t*>(mapped) + (current - start);
+    span.iov_len = (size_t)(st.st_size - current);
+    reader->mSpans.push_back(span);
+    reader->mSize = span.iov_len;
+    return reader;
+}
+
+ProtoSpanReader::~ProtoSpanReader() {
+    if (mMapped != NULL) {
+        munmap(mMapped, mMappedSize);
+    }
+}
+
+ssize_t
+ProtoSpanReader::size() const
+{
+    return (ssize_t)mSize;
+}
+
+size_t
+ProtoSpanReader::bytesRead() const
+{
+    return mPos;
+}
+
+uint8_t const*
+ProtoSpanReader::readBuffer()
+{
+    return hasNext() ? static_cast<uint8_t const*>(mSpans[mIndex].iov_base) + mOffset : NULL;
+}
+
+size_t
+ProtoSpanReader::currentToRead()
+{
+    return hasNext() ? mSpans[mIndex].iov_len - mOffset : 0;
+}
+
+bool
+ProtoSpanReader::hasNext()
+{
+    return mStatus == NO_ERROR && mPos < mSize;
+}
+
+uint8_t
+ProtoSpanReader::next()
+{
+    if (!hasNext()) {
+        // Shouldn't get to here.  Always call hasNext() before calling next().
+        return 0;
+    }
+    uint8_t res = static_cast<uint8_t const*>(mSpans[mIndex].iov_base)[mOffset];
+    move(1);
+    return res;
+}
+
+uint64_t
+ProtoSpanReader::readRawVarint()
+{
+    // Decode straight from the span unless the varint crosses into the next one.
+    uint8_t const* buf = readBuffer();
+    if (buf != NULL) {
+        uint64_t val;
+        uint8_t const* end = read_raw_varint(buf, buf + currentToRead(), &val);
+        if (end != NULL) {
+            move(end - buf);
+            return val;
+        }
+    }
+
+    uint64_t val = 0, shift = 0;
+    while (true) {
+        if (!hasNext()) {
+            ALOGW("readRawVarint() called without hasNext() called first.");
+            mStatus = NOT_ENOUGH_DATA;
+            return 0;
+        }
+        uint8_t byte = next();
+        val |= (INT64_C(0x7F) & byte) << shift;
+        if ((byte & 0x80) == 0) break;
+        shift += 7;
+    }
+    return val;
+}
+
+void
+ProtoSpanReader::move(size_t amt)
+{
+    if (mStatus != NO_ERROR) {
+        return;
+    }
+    if (amt > mSize - mPos) {
+        mStatus = NOT_ENOUGH_DATA;
+        amt = mSize - mPos;
+    }
+    mPos += amt;
+    mOffset += amt;
+    // Spans are never empty, so this stops at the span holding mPos, or past the last one.
+    while (mIndex < mSpans.size() && mOffset >= mSpans[mIndex].iov_len) {
+        mOffset -= mSpans[mIndex].iov_len;
+        mIndex++;
+    }
+}
+
+status_t
+ProtoSpanReader::getError() const {
+    return mStatus;
+}
+
+} // util
+} // android
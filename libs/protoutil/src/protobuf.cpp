@@ -42,6 +42,42 @@ get_varint_size(uint64_t varint)
     return size;
 }
 
+const uint8_t*
+read_raw_varint(const uint8_t* buf, const uint8_t* end, uint64_t* val)
+{
+    // Most varints are tags and small sizes which fit in a single byte.
+    if (buf < end && (*buf & 0x80) == 0) {
+        *val = *buf;
+        return buf + 1;
+    }
+
+    uint64_t result = 0;
+    if (end - buf >= 10) {
+        // A varint is at most 10 bytes long, so none of these reads need a bounds check.
+        for (int shift = 0; shift < 70; shift += 7) {
+            uint8_t byte = *buf++;
+            result |= (UINT64_C(0x7F) & byte) << shift;
+            if ((byte & 0x80) == 0) {
+                *val = result;
+                return buf;
+            }
+        }
+        // Cut a malformed varint short at 10 bytes.
+        *val = result;
+        return buf;
+    }
+
+    for (int shift = 0; buf < end; shift += 7) {
+        uint8_t byte = *buf++;
+        result |= (UINT64_C(0x7F) & byte) << shift;
+        if ((byte & 0x80) == 0) {
+            *val = result;
+            return buf;
+        }
+    }
+    return nullptr;
+}
+
 uint8_t*
 write_raw_varint(uint8_t* buf, uint64_t val)
 {
@@ -88,6 +88,65 @@ TEST(ProtoOutputStreamTest, Primitives) {
     EXPECT_EQ(primitives.val_enum(), PrimitiveProto_Count_TWO);
 }
 
+TEST(ProtoOutputStreamTest, TypedPrimitives) {
+    constexpr uint64_t VAL_INT32 = FIELD_TYPE_INT32 | PrimitiveProto::kValInt32FieldNumber;
+    constexpr uint64_t VAL_INT64 = FIELD_TYPE_INT64 | PrimitiveProto::kValInt64FieldNumber;
+    constexpr uint64_t VAL_FLOAT = FIELD_TYPE_FLOAT | PrimitiveProto::kValFloatFieldNumber;
+    constexpr uint64_t VAL_DOUBLE = FIELD_TYPE_DOUBLE | PrimitiveProto::kValDoubleFieldNumber;
+    constexpr uint64_t VAL_UINT32 = FIELD_TYPE_UINT32 | PrimitiveProto::kValUint32FieldNumber;
+    constexpr uint64_t VAL_UINT64 = FIELD_TYPE_UINT64 | PrimitiveProto::kValUint64FieldNumber;
+    constexpr uint64_t VAL_FIXED32 = FIELD_TYPE_FIXED32 | PrimitiveProto::kValFixed32FieldNumber;
+    constexpr uint64_t VAL_FIXED64 = FIELD_TYPE_FIXED64 | PrimitiveProto::kValFixed64FieldNumber;
+    constexpr uint64_t VAL_BOOL = FIELD_TYPE_BOOL | PrimitiveProto::kValBoolFieldNumber;
+    constexpr uint64_t VAL_STRING = FIELD_TYPE_STRING | PrimitiveProto::kValStringFieldNumber;
+    constexpr uint64_t VAL_BYTES = FIELD_TYPE_BYTES | PrimitiveProto::kValBytesFieldNumber;
+    constexpr uint64_t VAL_SFIXED32 = FIELD_TYPE_SFIXED32 | PrimitiveProto::kValSfixed32FieldNumber;
+    constexpr uint64_t VAL_SFIXED64 = FIELD_TYPE_SFIXED64 | PrimitiveProto::kValSfixed64FieldNumber;
+    constexpr uint64_t VAL_SINT32 = FIELD_TYPE_SINT32 | PrimitiveProto::kValSint32FieldNumber;
+    constexpr uint64_t VAL_SINT64 = FIELD_TYPE_SINT64 | PrimitiveProto::kValSint64FieldNumber;
+    constexpr uint64_t VAL_ENUM = FIELD_TYPE_ENUM | PrimitiveProto::kValEnumFieldNumber;
+    std::string s = "hello";
+    const char b[5] = { 'a', 'p', 'p', 'l', 'e' };
+
+    ProtoOutputStream typed;
+    EXPECT_TRUE(typed.write<VAL_INT32>(-123));
+    EXPECT_TRUE(typed.write<VAL_INT64>(-1LL));
+    EXPECT_TRUE(typed.write<VAL_FLOAT>(-23.5f));
+    EXPECT_TRUE(typed.write<VAL_DOUBLE>(324.5));
+    EXPECT_TRUE(typed.write<VAL_UINT32>(3424));
+    EXPECT_TRUE(typed.write<VAL_UINT64>(57LL));
+    EXPECT_TRUE(typed.write<VAL_FIXED32>(-20));
+    EXPECT_TRUE(typed.write<VAL_FIXED64>(-37LL));
+    EXPECT_TRUE(typed.write<VAL_BOOL>(true));
+    EXPECT_TRUE(typed.write<VAL_STRING>(s));
+    EXPECT_TRUE(typed.write<VAL_BYTES>(b, 5));
+    EXPECT_TRUE(typed.write<VAL_SFIXED32>(63));
+    EXPECT_TRUE(typed.write<VAL_SFIXED64>(-54));
+    EXPECT_TRUE(typed.write<VAL_SINT32>(-533));
+    EXPECT_TRUE(typed.write<VAL_SINT64>(-61224762453LL));
+    EXPECT_TRUE(typed.write<VAL_ENUM>(2));
+
+    ProtoOutputStream proto;
+    proto.write(VAL_INT32, -123);
+    proto.write(VAL_INT64, -1LL);
+    proto.write(VAL_FLOAT, -23.5f);
+    proto.write(VAL_DOUBLE, 324.5);
+    proto.write(VAL_UINT32, 3424);
+    proto.write(VAL_UINT64, 57LL);
+    proto.write(VAL_FIXED32, -20);
+    proto.write(VAL_FIXED64, -37LL);
+    proto.write(VAL_BOOL, true);
+    proto.write(VAL_STRING, s);
+    proto.write(VAL_BYTES, b, 5);
+    proto.write(VAL_SFIXED32, 63);
+    proto.write(VAL_SFIXED64, -54);
+    proto.write(VAL_SINT32, -533);
+    proto.write(VAL_SINT64, -61224762453LL);
+    proto.write(VAL_ENUM, 2);
+
+    EXPECT_EQ(flushToString(&typed), flushToString(&proto));
+}
+
 TEST(ProtoOutputStreamTest, SerializeToStringPrimitives) {
     std::string s = "hello";
     const char b[5] = { 'a', 'p', 'p', 'l', 'e' };
@@ -356,3 +415,57 @@ TEST(ProtoOutputStreamTest, NoStartCalled) {
     EXPECT_EQ(proto.size(), 0);
     EXPECT_FALSE(proto.flush(STDOUT_FILENO));
 }
+
+TEST(ProtoOutputStreamTest, StartWithSize) {
+    ProtoOutputStream proto;
+    proto.write(FIELD_TYPE_INT32 | ComplexProto::kIntsFieldNumber, 3);
+    // id 14 and name "kiwi" are 2 + 6 bytes.
+    uint64_t token = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber, 8);
+    proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 14);
+    proto.write(FIELD_TYPE_STRING | ComplexProto::Log::kNameFieldNumber, std::string("kiwi"));
+    proto.end(token);
+    // Every sub-message has its size, the data is already compact.
+    EXPECT_EQ(proto.bytesWritten(), proto.size());
+
+    ComplexProto complex;
+    ASSERT_TRUE(complex.ParseFromString(flushToString(&proto)));
+    EXPECT_EQ(complex.ints_size(), 1);
+    EXPECT_EQ(complex.ints(0), 3);
+    EXPECT_EQ(complex.logs_size(), 1);
+    EXPECT_EQ(complex.logs(0).id(), 14);
+    EXPECT_THAT(complex.logs(0).name(), StrEq("kiwi"));
+}
+
+TEST(ProtoOutputStreamTest, StartWithSizeAfterStart) {
+    ProtoOutputStream proto;
+    uint64_t token1 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber);
+    proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 1);
+    proto.end(token1);
+    uint64_t token2 = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber, 2);
+    proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 2);
+    proto.end(token2);
+
+    ComplexProto complex;
+    ASSERT_TRUE(complex.ParseFromString(flushToString(&proto)));
+    EXPECT_EQ(complex.logs_size(), 2);
+    EXPECT_EQ(complex.logs(0).id(), 1);
+    EXPECT_EQ(complex.logs(1).id(), 2);
+}
+
+TEST(ProtoOutputStreamTest, StartWithWrongSize) {
+    ProtoOutputStream proto;
+    uint64_t token = proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber, 3);
+    proto.write(FIELD_TYPE_INT32 | ComplexProto::Log::kIdFieldNumber, 53);
+    proto.end(token);
+    EXPECT_NE(proto.bytesWritten(), 0);
+    EXPECT_EQ(proto.size(), 0);
+    EXPECT_FALSE(proto.flush(STDOUT_FILENO));
+}
+
+TEST(ProtoOutputStreamTest, StartInStartWithSize) {
+    ProtoOutputStream proto;
+    proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber, 3);
+    proto.start(FIELD_TYPE_MESSAGE | ComplexProto::kLogsFieldNumber);
+    EXPECT_EQ(proto.size(), 0);
+    EXPECT_FALSE(proto.flush(STDOUT_FILENO));
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2022 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <android-base/file.h>
+#include <android-base/test_utils.h>
+#include <android/util/ProtoSpanReader.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace android::base;
+using namespace android::util;
+using android::sp;
+
+TEST(ProtoSpanReaderTest, ReadAcrossSpans) {
+    // A tag, a varint split across the first two spans, and 3 bytes to skip.
+    uint8_t first[] = { 0x08, 0x96 };
+    uint8_t second[] = { 0x01, 'a', 'b' };
+    uint8_t third[] = { 'c', 0x10 };
+    struct iovec iov[] = {
+        { first, sizeof(first) }, { NULL, 0 }, { second, sizeof(second) }, { third, sizeof(third) },
+    };
+    sp<ProtoSpanReader> reader = new ProtoSpanReader(iov, 4);
+    EXPECT_EQ(reader->size(), 7);
+
+    EXPECT_EQ(reader->readBuffer(), first);
+    EXPECT_EQ(reader->currentToRead(), sizeof(first));
+    EXPECT_EQ(reader->readRawVarint(), UINT64_C(8));
+    EXPECT_EQ(reader->readRawVarint(), UINT64_C(150));
+    EXPECT_EQ(reader->readBuffer(), second + 1);
+    EXPECT_EQ(reader->currentToRead(), 2UL);
+    reader->move(3);
+    EXPECT_EQ(reader->next(), 0x10);
+    EXPECT_EQ(reader->bytesRead(), 7UL);
+    EXPECT_FALSE(reader->hasNext());
+    EXPECT_EQ(reader->readBuffer(), nullptr);
+    EXPECT_EQ(reader->getError(), android::NO_ERROR);
+
+    reader->move(1);
+    EXPECT_EQ(reader->getError(), android::NOT_ENOUGH_DATA);
+}
+
+TEST(ProtoSpanReaderTest, MapFile) {
+    TemporaryFile tf;
+    ASSERT_NE(tf.fd, -1);
+    ASSERT_TRUE(WriteStringToFd("skip\x08\x2a", tf.fd));
+    ASSERT_EQ(lseek(tf.fd, 4, SEEK_SET), 4);
+
+    sp<ProtoSpanReader> reader = ProtoSpanReader::mapFile(tf.fd);
+    ASSERT_NE(reader, nullptr);
+    EXPECT_EQ(reader->size(), 2);
+    EXPECT_EQ(reader->readRawVarint(), UINT64_C(8));
+    EXPECT_EQ(reader->readRawVarint(), UINT64_C(42));
+    EXPECT_FALSE(reader->hasNext());
+    EXPECT_EQ(reader->getError(), android::NO_ERROR);
+}
+
+TEST(ProtoSpanReaderTest, MapPipeFails) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    EXPECT_EQ(ProtoSpanReader::mapFile(fds[0]), nullptr);
+    close(fds[0]);
+    close(fds[1]);
+}
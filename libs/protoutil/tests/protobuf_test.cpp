@@ -48,4 +48,12 @@ TEST(ProtobufTest, All) {
     EXPECT_EQ(header[1], 0x96);
     EXPECT_EQ(header[2], 0x01);
     EXPECT_EQ(header[3], UNSET_BYTE);
+
+    uint64_t val = 0;
+    EXPECT_EQ(read_raw_varint(header + 1, header + 3, &val) - header, 3);
+    EXPECT_EQ(val, UINT64_C(150));
+    EXPECT_EQ(read_raw_varint(header + 1, header + 2, &val), nullptr);
+    EXPECT_EQ(read_raw_varint(buf, buf + sizeof(buf), &val) - buf, 10);
+    EXPECT_EQ(val, UINT64_C(-2));
+    EXPECT_EQ(read_raw_varint(buf, buf + 9, &val), nullptr);
 }
\ No newline at end of file
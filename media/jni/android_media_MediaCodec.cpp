@@ -158,6 +158,24 @@ static struct {
     jmethodID addId;
 } gArrayListInfo;
 
+// Classes and methods used for every buffer or frame, looked up once rather than per call.
+static struct {
+    jclass clazz;
+    jmethodID ctorId;
+    jmethodID setId;
+} gBufferInfo;
+
+static struct {
+    jclass clazz;
+    jmethodID ctorId;
+} gRectInfo;
+
+static struct {
+    jclass clazz;
+    jmethodID bufferCtorId;
+    jmethodID planesCtorId;
+} gMediaImageInfo;
+
 static struct {
     jclass clazz;
     jmethodID ctorId;
@@ -460,11 +478,7 @@ status_t JMediaCodec::dequeueOutputBuffer(
         return err;
     }
 
-    ScopedLocalRef<jclass> clazz(
-            env, env->FindClass("android/media/MediaCodec$BufferInfo"));
-
-    jmethodID method = env->GetMethodID(clazz.get(), "set", "(IIJI)V");
-    env->CallVoidMethod(bufferInfo, method, (jint)offset, (jint)size, timeUs, flags);
+    env->CallVoidMethod(bufferInfo, gBufferInfo.setId, (jint)offset, (jint)size, timeUs, flags);
 
     return OK;
 }
@@ -670,25 +684,11 @@ status_t JMediaCodec::getImage(
     jobject cropRect = NULL;
     int32_t left, top, right, bottom;
     if (buffer->meta()->findRect("crop-rect", &left, &top, &right, &bottom)) {
-        ScopedLocalRef<jclass> rectClazz(
-                env, env->FindClass("android/graphics/Rect"));
-        CHECK(rectClazz.get() != NULL);
-
-        jmethodID rectConstructID = env->GetMethodID(
-                rectClazz.get(), "<init>", "(IIII)V");
-
         cropRect = env->NewObject(
-                rectClazz.get(), rectConstructID, left, top, right + 1, bottom + 1);
+                gRectInfo.clazz, gRectInfo.ctorId, left, top, right + 1, bottom + 1);
     }
 
-    ScopedLocalRef<jclass> imageClazz(
-            env, env->FindClass("android/media/MediaCodec$MediaImage"));
-    CHECK(imageClazz.get() != NULL);
-
-    jmethodID imageConstructID = env->GetMethodID(imageClazz.get(), "<init>",
-            "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;ZJIILandroid/graphics/Rect;)V");
-
-    *buf = env->NewObject(imageClazz.get(), imageConstructID,
+    *buf = env->NewObject(gMediaImageInfo.clazz, gMediaImageInfo.bufferCtorId,
             byteBuffer, infoBuffer,
             (jboolean)!input /* readOnly */,
             (jlong)timestamp,
@@ -1091,12 +1091,7 @@ void JMediaCodec::handleCallback(const sp<AMessage> &msg) {
             CHECK(msg->findInt64("timeUs", &timeUs));
             CHECK(msg->findInt32("flags", (int32_t *)&flags));
 
-            ScopedLocalRef<jclass> clazz(
-                    env, env->FindClass("android/media/MediaCodec$BufferInfo"));
-            jmethodID ctor = env->GetMethodID(clazz.get(), "<init>", "()V");
-            jmethodID method = env->GetMethodID(clazz.get(), "set", "(IIJI)V");
-
-            obj = env->NewObject(clazz.get(), ctor);
+            obj = env->NewObject(gBufferInfo.clazz, gBufferInfo.ctorId);
 
             if (obj == NULL) {
                 if (env->ExceptionCheck()) {
@@ -1107,7 +1102,8 @@ void JMediaCodec::handleCallback(const sp<AMessage> &msg) {
                 return;
             }
 
-            env->CallVoidMethod(obj, method, (jint)offset, (jint)size, timeUs, flags);
+            env->CallVoidMethod(
+                    obj, gBufferInfo.setId, (jint)offset, (jint)size, timeUs, flags);
             break;
         }
 
@@ -2131,14 +2127,7 @@ static jobject android_media_MediaCodec_mapHardwareBuffer(JNIEnv *env, jclass, j
     env->ReleaseIntArrayElements(pixelStridesArray.get(), pixelStrides, 0);
     rowStrides = pixelStrides = nullptr;
 
-    ScopedLocalRef<jclass> imageClazz(
-            env, env->FindClass("android/media/MediaCodec$MediaImage"));
-    CHECK(imageClazz.get() != NULL);
-
-    jmethodID imageConstructID = env->GetMethodID(imageClazz.get(), "<init>",
-            "([Ljava/nio/ByteBuffer;[I[IIIIZJIILandroid/graphics/Rect;J)V");
-
-    jobject img = env->NewObject(imageClazz.get(), imageConstructID,
+    jobject img = env->NewObject(gMediaImageInfo.clazz, gMediaImageInfo.planesCtorId,
             buffersArray.get(),
             rowStridesArray.get(),
             pixelStridesArray.get(),
@@ -3202,6 +3191,35 @@ static void android_media_MediaCodec_native_init(JNIEnv *env, jclass) {
     gArrayListInfo.addId = env->GetMethodID(clazz.get(), "add", "(Ljava/lang/Object;)Z");
     CHECK(gArrayListInfo.addId != NULL);
 
+    clazz.reset(env->FindClass("android/media/MediaCodec$BufferInfo"));
+    CHECK(clazz.get() != NULL);
+    gBufferInfo.clazz = (jclass)env->NewGlobalRef(clazz.get());
+
+    gBufferInfo.ctorId = env->GetMethodID(clazz.get(), "<init>", "()V");
+    CHECK(gBufferInfo.ctorId != NULL);
+
+    gBufferInfo.setId = env->GetMethodID(clazz.get(), "set", "(IIJI)V");
+    CHECK(gBufferInfo.setId != NULL);
+
+    clazz.reset(env->FindClass("android/graphics/Rect"));
+    CHECK(clazz.get() != NULL);
+    gRectInfo.clazz = (jclass)env->NewGlobalRef(clazz.get());
+
+    gRectInfo.ctorId = env->GetMethodID(clazz.get(), "<init>", "(IIII)V");
+    CHECK(gRectInfo.ctorId != NULL);
+
+    clazz.reset(env->FindClass("android/media/MediaCodec$MediaImage"));
+    CHECK(clazz.get() != NULL);
+    gMediaImageInfo.clazz = (jclass)env->NewGlobalRef(clazz.get());
+
+    gMediaImageInfo.bufferCtorId = env->GetMethodID(clazz.get(), "<init>",
+            "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;ZJIILandroid/graphics/Rect;)V");
+    CHECK(gMediaImageInfo.bufferCtorId != NULL);
+
+    gMediaImageInfo.planesCtorId = env->GetMethodID(clazz.get(), "<init>",
+            "([Ljava/nio/ByteBuffer;[I[IIIIZJIILandroid/graphics/Rect;J)V");
+    CHECK(gMediaImageInfo.planesCtorId != NULL);
+
     clazz.reset(env->FindClass("android/media/MediaCodec$LinearBlock"));
     CHECK(clazz.get() != NULL);
 
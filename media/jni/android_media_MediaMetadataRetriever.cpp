@@ -18,6 +18,7 @@
 //#define LOG_NDEBUG 0
 #define LOG_TAG "MediaMetadataRetrieverJNI"
 
+#include <algorithm>
 #include <cmath>
 #include <assert.h>
 #include <utils/Log.h>
@@ -208,12 +209,22 @@ static void rotate0(T* dst, const T* src, size_t width, size_t height)
     memcpy(dst, src, width * height * sizeof(T));
 }
 
+// Frames are rotated a square tile at a time, so that the rows of the tile in dst stay in the
+// cache while the tile is transposed into them rather than each pixel landing on a new line.
+static const size_t kRotateTileSize = 32;
+
 template<typename T>
 static void rotate90(T* dst, const T* src, size_t width, size_t height)
 {
-    for (size_t i = 0; i < height; ++i) {
-        for (size_t j = 0; j < width; ++j) {
-            dst[j * height + height - 1 - i] = src[i * width + j];
+    for (size_t i0 = 0; i0 < height; i0 += kRotateTileSize) {
+        const size_t iEnd = std::min(i0 + kRotateTileSize, height);
+        for (size_t j0 = 0; j0 < width; j0 += kRotateTileSize) {
+            const size_t jEnd = std::min(j0 + kRotateTileSize, width);
+            for (size_t i = i0; i < iEnd; ++i) {
+                for (size_t j = j0; j < jEnd; ++j) {
+                    dst[j * height + height - 1 - i] = src[i * width + j];
+                }
+            }
         }
     }
 }
@@ -221,19 +232,21 @@ static void rotate90(T* dst, const T* src, size_t width, size_t height)
 template<typename T>
 static void rotate180(T* dst, const T* src, size_t width, size_t height)
 {
-    for (size_t i = 0; i < height; ++i) {
-        for (size_t j = 0; j < width; ++j) {
-            dst[(height - 1 - i) * width + width - 1 - j] = src[i * width + j];
-        }
-    }
+    std::reverse_copy(src, src + width * height, dst);
 }
 
 template<typename T>
 static void rotate270(T* dst, const T* src, size_t width, size_t height)
 {
-    for (size_t i = 0; i < height; ++i) {
-        for (size_t j = 0; j < width; ++j) {
-            dst[(width - 1 - j) * height + i] = src[i * width + j];
+    for (size_t i0 = 0; i0 < height; i0 += kRotateTileSize) {
+        const size_t iEnd = std::min(i0 + kRotateTileSize, height);
+        for (size_t j0 = 0; j0 < width; j0 += kRotateTileSize) {
+            const size_t jEnd = std::min(j0 + kRotateTileSize, width);
+            for (size_t i = i0; i < iEnd; ++i) {
+                for (size_t j = j0; j < jEnd; ++j) {
+                    dst[(width - 1 - j) * height + i] = src[i * width + j];
+                }
+            }
         }
     }
 }
@@ -69,6 +69,10 @@ static const short fir21[] = {
     FIR_COEF(-0.006965742326)
 };
 static const int nFir21 = sizeof(fir21) / sizeof(fir21[0]);
+// The filter is symmetric around its middle tap, so each coefficient but that one is applied once
+// to the sum of the two samples it weighs, halving the multiplies.
+static const int nFir21Half = nFir21 / 2;
+static_assert(nFir21 % 2 == 1, "fir21 must have a middle tap");
 
 static const int BUF_SIZE = 2048;
 
@@ -92,11 +96,10 @@ static void android_media_ResampleInputStream_fir21(JNIEnv *env, jclass /* clazz
     // compute filter
     short out[BUF_SIZE];
     for (int i = 0; i < jNpoints; i++) {
-        long sum = 0;
-        const short* firp = &fir21[0];
         const short* inp = &in[i * 2];
-        for (int n = nFir21; --n >= 0; ) {
-            sum += ((long)*firp++) * ((long)*inp++);
+        long sum = ((long)fir21[nFir21Half]) * ((long)inp[nFir21Half]);
+        for (int n = 0; n < nFir21Half; n++) {
+            sum += ((long)fir21[n]) * ((long)inp[n] + (long)inp[nFir21 - 1 - n]);
         }
         out[i] = (short)(sum >> 16);
     }
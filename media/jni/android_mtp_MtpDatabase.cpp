@@ -342,7 +342,7 @@ MtpObjectHandleList* MtpDatabase::getObjectList(MtpStorageID storageID,
     jsize length = env->GetArrayLength(array);
     for (int i = 0; i < length; i++)
         list->push_back(handles[i]);
-    env->ReleaseIntArrayElements(array, handles, 0);
+    env->ReleaseIntArrayElements(array, handles, JNI_ABORT);
     env->DeleteLocalRef(array);
 
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
@@ -371,7 +371,7 @@ MtpObjectFormatList* MtpDatabase::getSupportedPlaybackFormats() {
     jsize length = env->GetArrayLength(array);
     for (int i = 0; i < length; i++)
         list->push_back(formats[i]);
-    env->ReleaseIntArrayElements(array, formats, 0);
+    env->ReleaseIntArrayElements(array, formats, JNI_ABORT);
     env->DeleteLocalRef(array);
 
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
@@ -389,7 +389,7 @@ MtpObjectFormatList* MtpDatabase::getSupportedCaptureFormats() {
     jsize length = env->GetArrayLength(array);
     for (int i = 0; i < length; i++)
         list->push_back(formats[i]);
-    env->ReleaseIntArrayElements(array, formats, 0);
+    env->ReleaseIntArrayElements(array, formats, JNI_ABORT);
     env->DeleteLocalRef(array);
 
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
@@ -407,7 +407,7 @@ MtpObjectPropertyList* MtpDatabase::getSupportedObjectProperties(MtpObjectFormat
     jsize length = env->GetArrayLength(array);
     for (int i = 0; i < length; i++)
         list->push_back(properties[i]);
-    env->ReleaseIntArrayElements(array, properties, 0);
+    env->ReleaseIntArrayElements(array, properties, JNI_ABORT);
     env->DeleteLocalRef(array);
 
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
@@ -425,7 +425,7 @@ MtpDevicePropertyList* MtpDatabase::getSupportedDeviceProperties() {
     jsize length = env->GetArrayLength(array);
     for (int i = 0; i < length; i++)
         list->push_back(properties[i]);
-    env->ReleaseIntArrayElements(array, properties, 0);
+    env->ReleaseIntArrayElements(array, properties, JNI_ABORT);
     env->DeleteLocalRef(array);
 
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
@@ -516,10 +516,10 @@ MtpResponseCode MtpDatabase::getObjectPropertyValue(MtpObjectHandle handle,
                 ALOGE("unsupported type in getObjectPropertyValue\n");
                 result = MTP_RESPONSE_INVALID_OBJECT_PROP_FORMAT;
         }
-        env->ReleaseIntArrayElements(objectHandlesArray, objectHandles, 0);
-        env->ReleaseIntArrayElements(propertyCodesArray, propertyCodes, 0);
-        env->ReleaseIntArrayElements(dataTypesArray, dataTypes, 0);
-        env->ReleaseLongArrayElements(longValuesArray, longValues, 0);
+        env->ReleaseIntArrayElements(objectHandlesArray, objectHandles, JNI_ABORT);
+        env->ReleaseIntArrayElements(propertyCodesArray, propertyCodes, JNI_ABORT);
+        env->ReleaseIntArrayElements(dataTypesArray, dataTypes, JNI_ABORT);
+        env->ReleaseLongArrayElements(longValuesArray, longValues, JNI_ABORT);
 
         env->DeleteLocalRef(objectHandlesArray);
         env->DeleteLocalRef(propertyCodesArray);
@@ -816,10 +816,10 @@ MtpResponseCode MtpDatabase::getObjectPropertyList(MtpObjectHandle handle,
             }
         }
 
-        env->ReleaseIntArrayElements(objectHandlesArray, objectHandles, 0);
-        env->ReleaseIntArrayElements(propertyCodesArray, propertyCodes, 0);
-        env->ReleaseIntArrayElements(dataTypesArray, dataTypes, 0);
-        env->ReleaseLongArrayElements(longValuesArray, longValues, 0);
+        env->ReleaseIntArrayElements(objectHandlesArray, objectHandles, JNI_ABORT);
+        env->ReleaseIntArrayElements(propertyCodesArray, propertyCodes, JNI_ABORT);
+        env->ReleaseIntArrayElements(dataTypesArray, dataTypes, JNI_ABORT);
+        env->ReleaseLongArrayElements(longValuesArray, longValues, JNI_ABORT);
 
         env->DeleteLocalRef(objectHandlesArray);
         env->DeleteLocalRef(propertyCodesArray);
@@ -851,16 +851,17 @@ MtpResponseCode MtpDatabase::getObjectInfo(MtpObjectHandle handle,
         return MTP_RESPONSE_INVALID_OBJECT_HANDLE;
     }
 
-    jint* intValues = env->GetIntArrayElements(mIntBuffer, 0);
+    // The few values are copied out of the buffers rather than pinning them.
+    jint intValues[3];
+    env->GetIntArrayRegion(mIntBuffer, 0, 3, intValues);
     info.mStorageID = intValues[0];
     info.mFormat = intValues[1];
     info.mParent = intValues[2];
-    env->ReleaseIntArrayElements(mIntBuffer, intValues, 0);
 
-    jlong* longValues = env->GetLongArrayElements(mLongBuffer, 0);
+    jlong longValues[2];
+    env->GetLongArrayRegion(mLongBuffer, 0, 2, longValues);
     info.mDateCreated = longValues[0];
     info.mDateModified = longValues[1];
-    env->ReleaseLongArrayElements(mLongBuffer, longValues, 0);
 
     if ((false)) {
         info.mAssociationType = (format == MTP_FORMAT_ASSOCIATION ?
@@ -886,7 +887,8 @@ MtpResponseCode MtpDatabase::getObjectInfo(MtpObjectHandle handle,
             if (env->CallBooleanMethod(
                     mDatabase, method_getThumbnailInfo, (jint)handle, mLongBuffer)) {
 
-                jlong* longValues = env->GetLongArrayElements(mLongBuffer, 0);
+                jlong longValues[3];
+                env->GetLongArrayRegion(mLongBuffer, 0, 3, longValues);
                 jlong size = longValues[0];
                 jlong w = longValues[1];
                 jlong h = longValues[2];
@@ -898,7 +900,6 @@ MtpResponseCode MtpDatabase::getObjectInfo(MtpObjectHandle handle,
                     info.mImagePixWidth = w;
                     info.mImagePixHeight = h;
                 }
-                env->ReleaseLongArrayElements(mLongBuffer, longValues, 0);
             }
             break;
         }
@@ -1031,10 +1032,15 @@ int MtpDatabase::openFilePath(const char* path, bool transcode) {
     JNIEnv* env = AndroidRuntime::getJNIEnv();
     jstring pathStr = env->NewStringUTF(path);
     jint result = env->CallIntMethod(mDatabase, method_openFilePath, pathStr, transcode);
+    env->DeleteLocalRef(pathStr);
 
     if (result < 0) {
         checkAndClearExceptionFromCallback(env, __FUNCTION__);
+        return result;
     }
+    // The file is sent to the host front to back, so let the kernel read ahead further than it
+    // would for random access. Failing to do so only loses the hint.
+    posix_fadvise(result, 0, 0, POSIX_FADV_SEQUENTIAL);
     return result;
 }
 
@@ -1169,7 +1175,7 @@ MtpObjectHandleList* MtpDatabase::getObjectReferences(MtpObjectHandle handle) {
     jsize length = env->GetArrayLength(array);
     for (int i = 0; i < length; i++)
         list->push_back(handles[i]);
-    env->ReleaseIntArrayElements(array, handles, 0);
+    env->ReleaseIntArrayElements(array, handles, JNI_ABORT);
     env->DeleteLocalRef(array);
 
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
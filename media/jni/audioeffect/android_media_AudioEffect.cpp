@@ -579,11 +579,12 @@ static jint android_media_AudioEffect_native_setParameter(JNIEnv *env,
 
 setParameter_Exit:
 
+    // Neither array is written, so releasing them needs no copy back.
     if (lpParam != NULL) {
-        env->ReleaseByteArrayElements(pJavaParam, lpParam, 0 /* mode */);
+        env->ReleaseByteArrayElements(pJavaParam, lpParam, JNI_ABORT);
     }
     if (lpValue != NULL) {
-        env->ReleaseByteArrayElements(pJavaValue, lpValue, 0 /* mode */);
+        env->ReleaseByteArrayElements(pJavaValue, lpValue, JNI_ABORT);
     }
     return AudioEffectJni::translateNativeErrorToJava(lStatus);
 }
@@ -644,7 +645,7 @@ android_media_AudioEffect_native_getParameter(JNIEnv *env,
 getParameter_Exit:
 
     if (lpParam != NULL) {
-        env->ReleaseByteArrayElements(pJavaParam, lpParam, 0 /* mode */);
+        env->ReleaseByteArrayElements(pJavaParam, lpParam, JNI_ABORT);
     }
     if (lpValue != NULL) {
         env->ReleaseByteArrayElements(pJavaValue, lpValue, 0 /* mode */);
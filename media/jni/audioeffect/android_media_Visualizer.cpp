@@ -199,9 +199,7 @@ static void captureCallback(void* user,
         jArray = callbackInfo->waveform_data;
 
         if (jArray != NULL) {
-            jbyte *nArray = env->GetByteArrayElements(jArray, NULL);
-            memcpy(nArray, waveform, waveformSize);
-            env->ReleaseByteArrayElements(jArray, nArray, 0);
+            env->SetByteArrayRegion(jArray, 0, waveformSize, (const jbyte *)waveform);
             env->CallStaticVoidMethod(
                 callbackInfo->visualizer_class,
                 fields.midPostNativeEvent,
@@ -219,9 +217,7 @@ static void captureCallback(void* user,
         jArray = callbackInfo->fft_data;
 
         if (jArray != NULL) {
-            jbyte *nArray = env->GetByteArrayElements(jArray, NULL);
-            memcpy(nArray, fft, fftSize);
-            env->ReleaseByteArrayElements(jArray, nArray, 0);
+            env->SetByteArrayRegion(jArray, 0, fftSize, (const jbyte *)fft);
             env->CallStaticVoidMethod(
                 callbackInfo->visualizer_class,
                 fields.midPostNativeEvent,
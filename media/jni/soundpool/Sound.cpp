@@ -20,15 +20,62 @@
 
 #include "Sound.h"
 
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include <media/NdkMediaCodec.h>
 #include <media/NdkMediaExtractor.h>
 #include <media/NdkMediaFormat.h>
+#include <sys/stat.h>
 
 namespace android::soundpool {
 
 constexpr uint32_t kMaxSampleRate = 192000;
 constexpr size_t   kDefaultHeapSize = 1024 * 1024; // 1MB (compatible with low mem devices)
 
+// Identifies the contents of a sound by the file and the range of it that is decoded.
+struct SampleKey {
+    dev_t   dev;
+    ino_t   ino;
+    int64_t mtimeNs;
+    int64_t offset;
+    int64_t length;
+
+    bool operator<(const SampleKey& other) const {
+        return std::tie(dev, ino, mtimeNs, offset, length)
+                < std::tie(other.dev, other.ino, other.mtimeNs, other.offset, other.length);
+    }
+};
+
+namespace {
+
+struct DecodedSample {
+    wp<MemoryHeapBase>   heap;
+    size_t               sizeInBytes;
+    uint32_t             sampleRate;
+    int32_t              channelCount;
+    audio_format_t       format;
+    audio_channel_mask_t channelMask;
+};
+
+// The decoded samples of the process, so that SoundPools loading the same asset share the
+// memory.  An entry is only valid while a Sound holds on to its heap.
+std::mutex gDecodedSamplesLock;
+std::map<SampleKey, DecodedSample> gDecodedSamples; // GUARDED_BY(gDecodedSamplesLock)
+
+bool getSampleKey(int fd, int64_t offset, int64_t length, SampleKey* key) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    *key = { st.st_dev, st.st_ino,
+            (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec, offset, length };
+    return true;
+}
+
+} // namespace
+
 Sound::Sound(int32_t soundID, int fd, int64_t offset, int64_t length)
     : mSoundID(soundID)
     , mFd(fcntl(fd, F_DUPFD_CLOEXEC, (int)0 /* arg */)) // dup(fd) + close on exec to prevent leaks.
@@ -47,7 +94,7 @@ Sound::~Sound()
 
 static status_t decode(int fd, int64_t offset, int64_t length,
         uint32_t *rate, int32_t *channelCount, audio_format_t *audioFormat,
-        audio_channel_mask_t *channelMask, const sp<MemoryHeapBase>& heap,
+        audio_channel_mask_t *channelMask, uint8_t *data, size_t capacity,
         size_t *sizeInBytes) {
     ALOGV("%s(fd=%d, offset=%lld, length=%lld, ...)",
             __func__, fd, (long long)offset, (long long)length);
@@ -81,8 +128,8 @@ static status_t decode(int fd, int64_t offset, int64_t length,
 
             bool sawInputEOS = false;
             bool sawOutputEOS = false;
-            auto writePos = static_cast<uint8_t*>(heap->getBase());
-            size_t available = heap->getSize();
+            auto writePos = data;
+            size_t available = capacity;
             size_t written = 0;
             format.reset(AMediaCodec_getOutputFormat(codec.get())); // update format.
 
@@ -197,7 +244,18 @@ status_t Sound::doLoad()
     ALOGV("%s()", __func__);
     status_t status = NO_INIT;
     if (mFd.get() != -1) {
-        mHeap = new MemoryHeapBase(kDefaultHeapSize);
+        SampleKey key;
+        const bool shareable = getSampleKey(mFd.get(), mOffset, mLength, &key);
+        if (shareable && loadShared(key)) {
+            ALOGV("%s: sharing decoded sample, close(%d)", __func__, mFd.get());
+            mFd.reset();  // close
+            mState = READY;  // this should be last, as it is an atomic sync point
+            return NO_ERROR;
+        }
+
+        // Decode into a scratch buffer, so that the heap kept with the sound is only as large
+        // as the decoded sample rather than the largest sample a sound may hold.
+        std::unique_ptr<uint8_t[]> scratch(new uint8_t[kDefaultHeapSize]);
 
         ALOGV("%s: start decode", __func__);
         uint32_t sampleRate;
@@ -205,7 +263,7 @@ status_t Sound::doLoad()
         audio_format_t format;
         audio_channel_mask_t channelMask;
         status = decode(mFd.get(), mOffset, mLength, &sampleRate, &channelCount, &format,
-                        &channelMask, mHeap, &mSizeInBytes);
+                        &channelMask, scratch.get(), kDefaultHeapSize, &mSizeInBytes);
         ALOGV("%s: close(%d)", __func__, mFd.get());
         mFd.reset();  // close
 
@@ -217,8 +275,13 @@ status_t Sound::doLoad()
         } else if (channelCount < 1 || channelCount > FCC_LIMIT) {
             ALOGE("%s: sample channel count (%d) out of range", __func__, channelCount);
             status = BAD_VALUE;
+        } else if ((mHeap = new MemoryHeapBase(std::max(mSizeInBytes, (size_t)1)))
+                ->getHeapID() < 0) {
+            ALOGE("%s: unable to allocate heap of %zu bytes", __func__, mSizeInBytes);
+            status = NO_MEMORY;
         } else {
             // Correctly loaded, proper parameters
+            memcpy(mHeap->getBase(), scratch.get(), mSizeInBytes);
             ALOGV("%s: pointer = %p, sizeInBytes = %zu, sampleRate = %u, channelCount = %d",
                   __func__, mHeap->getBase(), mSizeInBytes, sampleRate, channelCount);
             mData = new MemoryBase(mHeap, 0, mSizeInBytes);
@@ -226,6 +289,9 @@ status_t Sound::doLoad()
             mChannelCount = channelCount;
             mFormat = format;
             mChannelMask = channelMask;
+            if (shareable) {
+                publishShared(key);
+            }
             mState = READY;  // this should be last, as it is an atomic sync point
             return NO_ERROR;
         }
@@ -238,4 +304,40 @@ status_t Sound::doLoad()
     return status;
 }
 
+bool Sound::loadShared(const SampleKey& key)
+{
+    std::lock_guard lock(gDecodedSamplesLock);
+    auto it = gDecodedSamples.find(key);
+    if (it == gDecodedSamples.end()) {
+        return false;
+    }
+    mHeap = it->second.heap.promote();
+    if (mHeap == nullptr) {
+        gDecodedSamples.erase(it);
+        return false;
+    }
+    mSizeInBytes = it->second.sizeInBytes;
+    mSampleRate = it->second.sampleRate;
+    mChannelCount = it->second.channelCount;
+    mFormat = it->second.format;
+    mChannelMask = it->second.channelMask;
+    mData = new MemoryBase(mHeap, 0, mSizeInBytes);
+    return true;
+}
+
+void Sound::publishShared(const SampleKey& key)
+{
+    std::lock_guard lock(gDecodedSamplesLock);
+    // Drop the samples no sound uses anymore.
+    for (auto it = gDecodedSamples.begin(); it != gDecodedSamples.end();) {
+        if (it->second.heap.promote() == nullptr) {
+            it = gDecodedSamples.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    gDecodedSamples[key] = { mHeap, mSizeInBytes, mSampleRate, mChannelCount, mFormat,
+            mChannelMask };
+}
+
 } // namespace android::soundpool
@@ -24,6 +24,7 @@
 namespace android::soundpool {
 
 class SoundDecoder;
+struct SampleKey;
 
 /**
  * Sound is a resource used by SoundPool, referenced by soundID.
@@ -76,6 +77,11 @@ public:
 private:
     status_t doLoad();  // only SoundDecoder accesses this.
 
+    // Shares the decoded sample of another sound of the process with the same contents, if
+    // there is one still in use.
+    bool loadShared(const SampleKey& key);
+    void publishShared(const SampleKey& key);
+
     size_t               mSizeInBytes = 0;
     const int32_t        mSoundID;
     uint32_t             mSampleRate = 0;
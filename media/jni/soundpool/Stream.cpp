@@ -168,6 +168,7 @@ void Stream::setPlay(
     mRate = rate;
     mState = PLAYING;
     mAutoPaused = false;   // New for R (consistent with Java API spec).
+    mPlayTimeNs = systemTime();
     mStreamID = streamID;  // prefer this to be the last, as it is an atomic sync point
 }
 
@@ -323,6 +324,11 @@ void Stream::play_l(const std::shared_ptr<Sound>& sound, int32_t nextStreamID,
 
         // do not create a new audio track if current track is compatible with sound parameters
 
+        // Each stream plays its sound on its own static track, which the fast mixer mixes
+        // when AUDIO_OUTPUT_FLAG_FAST is granted.  Mixing the streams into one track in the
+        // client would move looping, rate and volume ramps out of AudioFlinger, and the
+        // BUFFER_END callback that ends a stream would have to come from the client mixer.
+
         android::content::AttributionSourceState attributionSource;
         attributionSource.packageName = mStreamManager->getOpPackageName();
         attributionSource.token = sp<BBinder>::make();
@@ -112,6 +112,7 @@ public:
         return getPairStream()->getPriority();
     }
     int64_t getStopTimeNs() const NO_THREAD_SAFETY_ANALYSIS { return mStopTimeNs; }
+    int64_t getPlayTimeNs() const NO_THREAD_SAFETY_ANALYSIS { return mPlayTimeNs; }
 
     // Can change with setPlay()
     int32_t getStreamID() const NO_THREAD_SAFETY_ANALYSIS { return mStreamID; }
@@ -184,6 +185,7 @@ private:
     sp<AudioTrack>      mAudioTrack GUARDED_BY(mLock);
     int                 mToggle GUARDED_BY(mLock) = 0;
     int64_t             mStopTimeNs GUARDED_BY(mLock) = 0;  // if nonzero, time to wait for stop.
+    int64_t             mPlayTimeNs GUARDED_BY(mLock) = 0;  // time of the last setPlay().
 };
 
 } // namespace android::soundpool
@@ -247,6 +247,7 @@ int32_t StreamManager::queueForPlay(const std::shared_ptr<Sound> &sound,
             if (Stream* nextStream = newStream->playPairStream(garbage)) {
                 lock.lock();
                 ALOGV("%s: starting streamID:%d", __func__, nextStream->getStreamID());
+                recordPlayLatency_l(nextStream);
                 addToActiveQueue_l(nextStream);
             } else {
                 lock.lock();
@@ -400,6 +401,7 @@ void StreamManager::run(int32_t id)
                             __func__, id, nextStream->getStreamID());
                     moveToRestartQueue_l(nextStream);
                 } else {
+                    recordPlayLatency_l(nextStream);
                     addToActiveQueue_l(nextStream);
                 }
             } else {
@@ -422,6 +424,31 @@ void StreamManager::run(int32_t id)
 void StreamManager::dump() const
 {
     forEach([](const Stream *stream) { stream->dump(); });
+    std::lock_guard lock(mStreamManagerLock);
+    dumpPlayLatency_l();
+}
+
+void StreamManager::recordPlayLatency_l(const Stream *stream)
+{
+    const int64_t latencyMs = (systemTime() - stream->getPlayTimeNs()) / NANOS_PER_MILLISECOND;
+    size_t bucket = 0;
+    while (bucket < kPlayLatencyBuckets - 1 && latencyMs >= (int64_t(1) << bucket)) {
+        ++bucket;
+    }
+    ++mPlayLatencyHistogram[bucket];
+}
+
+void StreamManager::dumpPlayLatency_l() const
+{
+    std::string histogram;
+    uint32_t plays = 0;
+    for (size_t i = 0; i < kPlayLatencyBuckets; ++i) {
+        histogram.append(i == kPlayLatencyBuckets - 1 ? " >=" : " <")
+                .append(std::to_string(1 << std::min(i, kPlayLatencyBuckets - 2)))
+                .append("ms:").append(std::to_string(mPlayLatencyHistogram[i]));
+        plays += mPlayLatencyHistogram[i];
+    }
+    ALOGD_IF(plays > 0, "%s: play latency of %u plays:%s", __func__, plays, histogram.c_str());
 }
 
 void StreamManager::sanityCheckQueue_l() const
@@ -18,6 +18,7 @@
 
 #include "Stream.h"
 
+#include <array>
 #include <condition_variable>
 #include <future>
 #include <list>
@@ -413,7 +414,7 @@ public:
 private:
 
     void run(int32_t id) NO_THREAD_SAFETY_ANALYSIS; // worker thread, takes unique_lock.
-    void dump() const;                           // no lock needed
+    void dump() const;                           // takes mStreamManagerLock
 
     // returns true if more worker threads are needed.
     bool needMoreThreads_l() REQUIRES(mStreamManagerLock) {
@@ -436,6 +437,10 @@ private:
     void addToActiveQueue_l(Stream *stream) REQUIRES(mStreamManagerLock);
     void sanityCheckQueue_l() const REQUIRES(mStreamManagerLock);
 
+    // Counts the time from the play() of the stream until its AudioTrack was started.
+    void recordPlayLatency_l(const Stream *stream) REQUIRES(mStreamManagerLock);
+    void dumpPlayLatency_l() const REQUIRES(mStreamManagerLock);
+
     const audio_attributes_t mAttributes;
     const std::string mOpPackageName;
 
@@ -450,11 +455,16 @@ private:
     // mStreamManagerLock is used to lock access for transitions between the
     // 4 stream queues by the Manager Thread or by the user initiated play().
     // A stream pair has exactly one stream on exactly one of the queues.
-    std::mutex                  mStreamManagerLock;
+    mutable std::mutex          mStreamManagerLock;
     std::condition_variable     mStreamManagerCondition GUARDED_BY(mStreamManagerLock);
 
     bool                        mQuit GUARDED_BY(mStreamManagerLock) = false;
 
+    // Bucket i counts the plays that started in less than 2^i ms, the last bucket the rest.
+    static constexpr size_t     kPlayLatencyBuckets = 8;
+    std::array<uint32_t, kPlayLatencyBuckets>
+                                mPlayLatencyHistogram GUARDED_BY(mStreamManagerLock){};
+
     // There are constructor arg "streams" pairs of streams, only one of each
     // pair on the 4 stream queues below.  The other stream in the pair serves as
     // placeholder to accumulate user changes, pending actual availability of the
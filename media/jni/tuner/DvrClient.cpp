@@ -23,6 +23,7 @@
 #include <android-base/logging.h>
 #include <inttypes.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <utils/Log.h>
 
@@ -31,6 +32,23 @@
 using ::aidl::android::hardware::tv::tuner::DemuxQueueNotifyBits;
 
 namespace android {
+
+// Describes the regions of tx holding size bytes, so that they are transferred with one readv() or
+// writev() instead of a read() or write() per region. Returns the number of regions used.
+static int getTransactionIovecs(const AidlMQ::MemTransaction& tx, int64_t size, struct iovec* iov) {
+    auto first = tx.getFirstRegion();
+    int64_t firstLength = std::min(static_cast<int64_t>(first.getLength()), size);
+    iov[0].iov_base = first.getAddress();
+    iov[0].iov_len = firstLength;
+    if (firstLength == size) {
+        return 1;
+    }
+    auto second = tx.getSecondRegion();
+    iov[1].iov_base = second.getAddress();
+    iov[1].iov_len = std::min(static_cast<int64_t>(second.getLength()), size - firstLength);
+    return 2;
+}
+
 /////////////// DvrClient ///////////////////////
 DvrClient::DvrClient(shared_ptr<ITunerDvr> tunerDvr) {
     mTunerDvr = tunerDvr;
@@ -66,28 +84,15 @@ int64_t DvrClient::readFromFile(int64_t size) {
     AidlMQ::MemTransaction tx;
     int64_t ret = 0;
     if (mDvrMQ->beginWrite(write, &tx)) {
-        auto first = tx.getFirstRegion();
-        auto data = first.getAddress();
-        int64_t length = first.getLength();
-        int64_t firstToWrite = min(length, write);
-        ret = read(mFd, data, firstToWrite);
-
+        struct iovec iov[2];
+        ret = readv(mFd, iov, getTransactionIovecs(tx, write, iov));
         if (ret < 0) {
             ALOGE("Failed to read from FD: %s", strerror(errno));
             return -1;
         }
-        if (ret < firstToWrite) {
-            ALOGW("file to MQ, first region: %" PRIu64 " bytes to write, but %" PRIu64
-                  " bytes written",
-                  firstToWrite, ret);
-        } else if (firstToWrite < write) {
-            ALOGV("write second region: %" PRIu64 " bytes written, %" PRIu64 " bytes in total", ret,
-                  write);
-            auto second = tx.getSecondRegion();
-            data = second.getAddress();
-            length = second.getLength();
-            int64_t secondToWrite = std::min(length, write - firstToWrite);
-            ret += read(mFd, data, secondToWrite);
+        if (ret < write) {
+            ALOGW("file to MQ: %" PRIu64 " bytes to write, but %" PRIu64 " bytes written", write,
+                  ret);
         }
         ALOGV("file to MQ: %" PRIu64 " bytes need to be written, %" PRIu64 " bytes written", write,
               ret);
@@ -143,27 +148,15 @@ int64_t DvrClient::writeToFile(int64_t size) {
     int64_t ret = 0;
     AidlMQ::MemTransaction tx;
     if (mDvrMQ->beginRead(toRead, &tx)) {
-        auto first = tx.getFirstRegion();
-        auto data = first.getAddress();
-        int64_t length = first.getLength();
-        int64_t firstToRead = std::min(length, toRead);
-        ret = write(mFd, data, firstToRead);
-
+        struct iovec iov[2];
+        ret = writev(mFd, iov, getTransactionIovecs(tx, toRead, iov));
         if (ret < 0) {
             ALOGE("Failed to write to FD: %s", strerror(errno));
             return -1;
         }
-        if (ret < firstToRead) {
-            ALOGW("MQ to file: %" PRIu64 " bytes read, but %" PRIu64 " bytes written", firstToRead,
+        if (ret < toRead) {
+            ALOGW("MQ to file: %" PRIu64 " bytes read, but %" PRIu64 " bytes written", toRead,
                   ret);
-        } else if (firstToRead < toRead) {
-            ALOGV("read second region: %" PRIu64 " bytes read, %" PRIu64 " bytes in total", ret,
-                  toRead);
-            auto second = tx.getSecondRegion();
-            data = second.getAddress();
-            length = second.getLength();
-            int32_t secondToRead = toRead - firstToRead;
-            ret += write(mFd, data, secondToRead);
         }
         ALOGV("MQ to file: %" PRIu64 " bytes to be read, %" PRIu64 " bytes written", toRead, ret);
         if (!mDvrMQ->commitRead(ret)) {
@@ -28,15 +28,17 @@ using android::filterfw::GLFrame;
 using android::filterfw::NativeFrame;
 
 // Helper functions ////////////////////////////////////////////////////////////////////////////////
+// These convert in single precision, which gives the same results as double precision for values
+// in [0, 1] and lets the loops be vectorized more widely.
 void ConvertFloatsToRGBA(const float* floats, int length, uint8_t* result) {
   for (int i = 0; i < length; ++i) {
-    result[i] = static_cast<uint8_t>(floats[i] * 255.0);
+    result[i] = static_cast<uint8_t>(floats[i] * 255.0f);
   }
 }
 
 void ConvertRGBAToFloats(const uint8_t* rgba, int length, float* result) {
   for (int i = 0; i < length; ++i) {
-    result[i] = rgba[i] / 255.0;
+    result[i] = rgba[i] / 255.0f;
   }
 }
 
@@ -185,9 +185,11 @@ jboolean Java_android_filterfw_core_NativeFrame_setNativeBitmap(JNIEnv* env,
       const uint8_t* end_ptr = dst_ptr + frame->Size();
       switch (bytes_per_sample) {
         case 1: { // RGBA -> GRAY
+          // Divides the sum by 3 as a multiply and shift, which is exact for sums up to 765, so
+          // that the loop can be vectorized.
           while (dst_ptr < end_ptr) {
             const Pixel pixel = *(src_ptr++);
-            *(dst_ptr++) = (pixel.rgba[0] + pixel.rgba[1] + pixel.rgba[2]) / 3;
+            *(dst_ptr++) = ((pixel.rgba[0] + pixel.rgba[1] + pixel.rgba[2]) * 21846) >> 16;
           }
           break;
         }
@@ -221,15 +223,15 @@ jboolean Java_android_filterfw_core_NativeFrame_getNativeBitmap(JNIEnv* env,
                                                                 jint bytes_per_sample) {
   NativeFrame* frame = ConvertFromJava<NativeFrame>(env, thiz);
   if (frame && bitmap) {
+    // Make sure frame size matches bitmap size
+    if ((size / 4) != (frame->Size() / bytes_per_sample)) {
+      ALOGE("Size mismatch in native getBitmap()!");
+      return JNI_FALSE;
+    }
+
     Pixel* dst_ptr;
     const int result = AndroidBitmap_lockPixels(env, bitmap, reinterpret_cast<void**>(&dst_ptr));
     if (result == ANDROID_BITMAP_RESULT_SUCCESS) {
-      // Make sure frame size matches bitmap size
-      if ((size / 4) != (frame->Size() / bytes_per_sample)) {
-        ALOGE("Size mismatch in native getBitmap()!");
-        return JNI_FALSE;
-      }
-
       const uint8_t* src_ptr = frame->Data();
       const uint8_t* end_ptr = src_ptr + frame->Size();
       switch (bytes_per_sample) {
@@ -83,8 +83,13 @@ AAsset* AAssetManager_open(AAssetManager* amgr, const char* filename, int mode)
         return NULL;
     }
 
-    ScopedLock<AssetManager2> locked_mgr(*AssetManagerForNdkAssetManager(amgr));
-    std::unique_ptr<Asset> asset = locked_mgr->Open(filename, amMode);
+    // Only the lookup needs the lock: inflating a compressed asset happens on its first read or
+    // getBuffer(), which do not touch the AssetManager2, so loaders on other threads can go on.
+    std::unique_ptr<Asset> asset;
+    {
+        ScopedLock<AssetManager2> locked_mgr(*AssetManagerForNdkAssetManager(amgr));
+        asset = locked_mgr->Open(filename, amMode);
+    }
     if (asset == nullptr) {
         return nullptr;
     }
@@ -93,8 +98,12 @@ AAsset* AAssetManager_open(AAssetManager* amgr, const char* filename, int mode)
 
 AAssetDir* AAssetManager_openDir(AAssetManager* amgr, const char* dirName)
 {
-    ScopedLock<AssetManager2> locked_mgr(*AssetManagerForNdkAssetManager(amgr));
-    return new AAssetDir(locked_mgr->OpenDir(dirName));
+    std::unique_ptr<AssetDir> dir;
+    {
+        ScopedLock<AssetManager2> locked_mgr(*AssetManagerForNdkAssetManager(amgr));
+        dir = locked_mgr->OpenDir(dirName);
+    }
+    return new AAssetDir(std::move(dir));
 }
 
 /**
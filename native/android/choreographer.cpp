@@ -18,6 +18,10 @@
 
 using namespace android;
 
+// The NDK entry points forward to libnativedisplay, which owns the per-thread Choreographer, its
+// DisplayEventReceiver and the looper the callbacks are delivered on. Changes to how callbacks
+// are queued or delivered belong there, not in these wrappers.
+
 AChoreographer* AChoreographer_getInstance() {
     return AChoreographer_routeGetInstance();
 }
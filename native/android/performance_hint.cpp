@@ -72,6 +72,8 @@ private:
     int64_t mTargetDurationNanos;
     // Last update timestamp
     int64_t mLastUpdateTimestamp;
+    // Whether the last reported sample ran over the target
+    bool mLastSampleOvertime;
     // Cached samples
     std::vector<int64_t> mActualDurationsNanos;
     std::vector<int64_t> mTimestampsNanos;
@@ -143,7 +145,8 @@ APerformanceHintSession::APerformanceHintSession(sp<IHintSession> session,
       : mHintSession(std::move(session)),
         mPreferredRateNanos(preferredRateNanos),
         mTargetDurationNanos(targetDurationNanos),
-        mLastUpdateTimestamp(elapsedRealtimeNano()) {}
+        mLastUpdateTimestamp(elapsedRealtimeNano()),
+        mLastSampleOvertime(false) {}
 
 APerformanceHintSession::~APerformanceHintSession() {
     binder::Status ret = mHintSession->close();
@@ -171,6 +174,7 @@ int APerformanceHintSession::updateTargetWorkDuration(int64_t targetDurationNano
     mActualDurationsNanos.clear();
     mTimestampsNanos.clear();
     mLastUpdateTimestamp = elapsedRealtimeNano();
+    mLastSampleOvertime = false;
     return 0;
 }
 
@@ -184,11 +188,15 @@ int APerformanceHintSession::reportActualWorkDuration(int64_t actualDurationNano
     mTimestampsNanos.push_back(now);
 
     /**
-     * Cache the hint if the hint is not overtime and the mLastUpdateTimestamp is
-     * still in the mPreferredRateNanos duration.
+     * Cache the hint if the mLastUpdateTimestamp is still in the mPreferredRateNanos duration,
+     * unless it is the first overtime hint after on-time ones. The HAL only needs to hear about a
+     * miss once to react; a session that keeps running over would otherwise make a binder call
+     * for every frame.
      */
-    if (actualDurationNanos < mTargetDurationNanos &&
-        now - mLastUpdateTimestamp <= mPreferredRateNanos) {
+    const bool overtime = actualDurationNanos >= mTargetDurationNanos;
+    const bool newlyOvertime = overtime && !mLastSampleOvertime;
+    mLastSampleOvertime = overtime;
+    if (!newlyOvertime && now - mLastUpdateTimestamp <= mPreferredRateNanos) {
         return 0;
     }
 
@@ -141,6 +141,10 @@ int ASensorManager_destroyEventQueue(ASensorManager* manager, ASensorEventQueue*
     return 0;
 }
 
+// Events reach a direct channel without a syscall: the HAL writes ASensorEvent records into the
+// memory as a ring, and bumps each record's reserved0 counter after filling it in. Readers poll
+// the next slot's counter, and a jump of more than one since the last record read means the ring
+// wrapped and events were overwritten. No code on this side touches the memory after setup.
 int ASensorManager_createSharedMemoryDirectChannel(ASensorManager *manager, int fd, size_t size) {
     RETURN_IF_MANAGER_IS_NULL(android::BAD_VALUE);
 
@@ -298,12 +298,14 @@ void ASurfaceTransaction_setOnComplete(ASurfaceTransaction* aSurfaceTransaction,
         aSurfaceTransactionStats.transactionCompleted = true;
 
         auto& aSurfaceControlStats = aSurfaceTransactionStats.aSurfaceControlStats;
+        aSurfaceControlStats.reserve(surfaceControlStats.size());
 
         for (const auto& [surfaceControl, latchTime, acquireTimeOrFence, presentFence,
                           previousReleaseFence, transformHint, frameEvents] : surfaceControlStats) {
             ASurfaceControl* aSurfaceControl = reinterpret_cast<ASurfaceControl*>(surfaceControl.get());
-            aSurfaceControlStats[aSurfaceControl].acquireTimeOrFence = acquireTimeOrFence;
-            aSurfaceControlStats[aSurfaceControl].previousReleaseFence = previousReleaseFence;
+            ASurfaceControlStats& stats = aSurfaceControlStats[aSurfaceControl];
+            stats.acquireTimeOrFence = acquireTimeOrFence;
+            stats.previousReleaseFence = previousReleaseFence;
         }
 
         (*func)(callback_context, &aSurfaceTransactionStats);
@@ -649,6 +651,7 @@ void ASurfaceTransaction_setOnCommit(ASurfaceTransaction* aSurfaceTransaction, v
                 aSurfaceTransactionStats.transactionCompleted = false;
 
                 auto& aSurfaceControlStats = aSurfaceTransactionStats.aSurfaceControlStats;
+                aSurfaceControlStats.reserve(surfaceControlStats.size());
                 for (const auto& [surfaceControl, latchTime, acquireTimeOrFence, presentFence,
                                   previousReleaseFence, transformHint, frameEvents] :
                      surfaceControlStats) {
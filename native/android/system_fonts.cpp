@@ -247,8 +247,14 @@ ASystemFontIterator* ASystemFontIterator_open() {
     std::unordered_set<AFont, FontHasher> fonts;
     minikin::SystemFonts::getFontMap(
             [&fonts](const std::vector<std::shared_ptr<minikin::FontCollection>>& collections) {
+                // Every named collection ends with the same fallback families, so most families
+                // are seen many times over. Their fonts only need to be read once.
+                std::unordered_set<const minikin::FontFamily*> visitedFamilies;
                 for (const auto& fc : collections) {
                     for (const auto& family : fc->getFamilies()) {
+                        if (!visitedFamilies.insert(family.get()).second) {
+                            continue;
+                        }
                         for (uint32_t i = 0; i < family->getNumFonts(); ++i) {
                             const minikin::Font* font = family->getFont(i);
 
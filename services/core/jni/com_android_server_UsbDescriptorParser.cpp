@@ -18,7 +18,6 @@
 #include <nativehelper/JNIHelp.h>
 #include <stdlib.h>
 #include <usbhost/usbhost.h>
-#include <usbhost/usbhost_jni.h>
 
 #include "jni.h"
 #include "utils/Log.h"
@@ -38,8 +37,18 @@ jbyteArray JNICALL Java_com_android_server_usb_descriptors_UsbDescriptorParser_g
         return NULL;
     }
 
-    int fd = usb_device_get_fd(device);
-    jbyteArray descriptors = usb_jni_read_descriptors(env, fd);
+    // usb_device_open() has already read the descriptors, don't read them from the fd again.
+    int numBytes = usb_device_get_descriptors_length(device);
+    jbyteArray descriptors = NULL;
+    if (numBytes > 0) {
+        descriptors = env->NewByteArray(numBytes);
+        if (descriptors != NULL) {
+            env->SetByteArrayRegion(descriptors, 0, numBytes,
+                                    (const jbyte*)usb_device_get_raw_descriptors(device));
+        }
+    } else {
+        ALOGE("error reading descriptors");
+    }
     usb_device_close(device);
     return descriptors;
 }
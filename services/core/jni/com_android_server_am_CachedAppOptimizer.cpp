@@ -27,6 +27,7 @@
 #include <binder/IPCThreadState.h>
 #include <cutils/compiler.h>
 #include <dirent.h>
+#include <inttypes.h>
 #include <jni.h>
 #include <linux/errno.h>
 #include <log/log.h>
@@ -42,6 +43,7 @@
 #include <sys/sysinfo.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <utils/Timers.h>
 #include <utils/Trace.h>
 
 #include <algorithm>
@@ -101,11 +103,6 @@ struct VmaBatch {
 // needed parts of the batch.
 // Returns total bytes consumed
 uint64_t consumeBytes(VmaBatch& batch, uint64_t bytesToConsume) {
-    if (CC_UNLIKELY(bytesToConsume) < 0) {
-        LOG(ERROR) << "Cannot consume negative bytes for VMA batch !";
-        return 0;
-    }
-
     if (CC_UNLIKELY(bytesToConsume > batch.totalBytes)) {
         // Avoid consuming more bytes than available
         bytesToConsume = batch.totalBytes;
@@ -113,7 +110,7 @@ uint64_t consumeBytes(VmaBatch& batch, uint64_t bytesToConsume) {
 
     uint64_t bytesConsumed = 0;
     while (bytesConsumed < bytesToConsume) {
-        if (CC_UNLIKELY(batch.totalVmas > 0)) {
+        if (CC_UNLIKELY(batch.totalVmas == 0)) {
             // No more vmas to consume
             break;
         }
@@ -163,7 +160,7 @@ public:
     // past the last VMA in the batch.
     // Returns true on success, false on failure
     bool createNextBatch(VmaBatch& batch) {
-        if (currentIndex_ >= MAX_VMAS_PER_BATCH && currentIndex_ >= sourceVmas->size()) {
+        if (currentIndex_ >= sourceVmas->size()) {
             return false;
         }
 
@@ -335,6 +332,12 @@ static int getAnyPageAdvice(const Vma& vma) {
     return MADV_COLD;
 }
 
+// The main thread stack is touched again as soon as the process runs, so paging
+// it out only costs a round trip through swap on the next warm start.
+static bool isHotVma(const Vma& vma) {
+    return vma.name == "[stack]";
+}
+
 // Perform a full process compaction using process_madvise syscall
 // using the madvise behavior defined by vmaToAdviseFunc per VMA.
 //
@@ -345,11 +348,15 @@ static int getAnyPageAdvice(const Vma& vma) {
 // it returns ERROR_COMPACTION_CANCELLED.
 static int64_t compactProcess(int pid, VmaToAdviseFunc vmaToAdviseFunc) {
     cancelRunningCompaction.store(false);
+    const nsecs_t startCpuTime = systemTime(SYSTEM_TIME_THREAD);
 
     ATRACE_BEGIN("CollectVmas");
     ProcMemInfo meminfo(pid);
     std::vector<Vma> pageoutVmas, coldVmas;
     auto vmaCollectorCb = [&coldVmas,&pageoutVmas,&vmaToAdviseFunc](const Vma& vma) {
+        if (isHotVma(vma)) {
+            return;
+        }
         int advice = vmaToAdviseFunc(vma);
         switch (advice) {
             case MADV_COLD:
@@ -377,6 +384,15 @@ static int64_t compactProcess(int pid, VmaToAdviseFunc vmaToAdviseFunc) {
         return coldBytes;
     }
 
+    if (ATRACE_ENABLED()) {
+        const nsecs_t cpuTime = systemTime(SYSTEM_TIME_THREAD) - startCpuTime;
+        ATRACE_INSTANT_FOR_TRACK(ATRACE_COMPACTION_TRACK,
+                                 StringPrintf("Compacted %d: %" PRId64 " pageout bytes, %" PRId64
+                                              " cold bytes, %" PRId64 "us cpu",
+                                              pid, pageoutBytes, coldBytes, ns2us(cpuTime))
+                                         .c_str());
+    }
+
     return pageoutBytes + coldBytes;
 }
 
@@ -477,7 +493,9 @@ static jint com_android_server_am_CachedAppOptimizer_freezeBinder(
 
     jint retVal = IPCThreadState::freeze(pid, freeze, 100 /* timeout [ms] */);
     if (retVal != 0 && retVal != -EAGAIN) {
-        jniThrowException(env, "java/lang/RuntimeException", "Unable to freeze/unfreeze binder");
+        jniThrowExceptionFmt(env, "java/lang/RuntimeException",
+                             "Unable to %s binder of pid %d: %s", freeze ? "freeze" : "unfreeze",
+                             pid, strerror(-retVal));
     }
 
     return retVal;
@@ -490,7 +508,11 @@ static jint com_android_server_am_CachedAppOptimizer_getBinderFreezeInfo(JNIEnv
     int error = IPCThreadState::getProcessFreezeInfo(pid, &syncReceived, &asyncReceived);
 
     if (error < 0) {
-        jniThrowException(env, "java/lang/RuntimeException", strerror(error));
+        // IPCThreadState returns a negative errno
+        jniThrowExceptionFmt(env, "java/lang/RuntimeException",
+                             "Unable to get binder freeze info of pid %d: %s", pid,
+                             strerror(-error));
+        return 0;
     }
 
     jint retVal = 0;
@@ -24,6 +24,9 @@
 #include <jni.h>
 #include <nativehelper/JNIHelp.h>
 #include <utils/Log.h>
+#include <utils/Timers.h>
+
+#include <algorithm>
 
 namespace android {
 
@@ -90,8 +93,20 @@ low_fail:
     return -1;
 }
 
+// Returns the wait in ms until the current pressure level expires, with no
+// timeout when there is no pressure.
+static int timeout_ms(uint32_t pressure_level, nsecs_t level_time) {
+    if (pressure_level == PRESSURE_NONE) {
+        return -1;
+    }
+    return toMillisecondTimeoutDelay(systemTime(SYSTEM_TIME_MONOTONIC),
+                                     level_time + us2ns(PSI_WINDOW_SIZE_US));
+}
+
 static jint android_server_am_LowMemDetector_waitForPressure(JNIEnv*, jobject) {
     static uint32_t pressure_level = PRESSURE_NONE;
+    // when pressure_level was last raised or confirmed by a trigger of the same level
+    static nsecs_t level_time = 0;
     struct epoll_event events[PRESSURE_LEVEL_COUNT];
     int nevents = 0;
 
@@ -101,20 +116,18 @@ static jint android_server_am_LowMemDetector_waitForPressure(JNIEnv*, jobject) {
     }
 
     do {
-        if (pressure_level == PRESSURE_NONE) {
-            /* Wait for events with no timeout */
-            nevents = epoll_wait(psi_epollfd, events, PRESSURE_LEVEL_COUNT, -1);
-        } else {
-            // This is simpler than lmkd. Assume that the memory pressure
-            // state will stay high for at least 1s. Within that 1s window,
-            // the memory pressure state can go up due to a different FD
-            // becoming available or it can go down when that window expires.
-            // Accordingly, there's no polling: just epoll_wait with a 1s timeout.
-            nevents = epoll_wait(psi_epollfd, events, PRESSURE_LEVEL_COUNT, 1000);
-            if (nevents == 0) {
-                pressure_level = PRESSURE_NONE;
-                return pressure_level;
-            }
+        // This is simpler than lmkd. Assume that the memory pressure state will
+        // stay at least at the current level for 1s after the trigger that
+        // reported it. Within that window the state can go up due to a different
+        // FD becoming available, and once it expires the state goes down by one
+        // level, so that a single quiet window does not take HIGH back to NONE.
+        // Accordingly, there's no polling: just epoll_wait until the window ends.
+        nevents = epoll_wait(psi_epollfd, events, PRESSURE_LEVEL_COUNT,
+                             timeout_ms(pressure_level, level_time));
+        if (nevents == 0) {
+            pressure_level--;
+            level_time = systemTime(SYSTEM_TIME_MONOTONIC);
+            return pressure_level;
         }
         // keep waiting if interrupted
     } while (nevents == -1 && errno == EINTR);
@@ -124,20 +137,29 @@ static jint android_server_am_LowMemDetector_waitForPressure(JNIEnv*, jobject) {
         return -1;
     }
 
-    // reset pressure_level and raise it based on received events
-    pressure_level = PRESSURE_NONE;
+    // find the highest reported level
+    uint32_t reported_level = PRESSURE_NONE;
     for (int i = 0; i < nevents; i++) {
         if (events[i].events & (EPOLLERR | EPOLLHUP)) {
             // should never happen unless psi got disabled in kernel
             ALOGE("Memory pressure events are not available anymore");
             return -1;
         }
-        // record the highest reported level
-        if (events[i].data.u32 > pressure_level) {
-            pressure_level = events[i].data.u32;
+        if (events[i].data.u32 > reported_level) {
+            reported_level = events[i].data.u32;
         }
     }
 
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    if (reported_level >= pressure_level) {
+        pressure_level = reported_level;
+        level_time = now;
+    } else if (now - level_time >= us2ns(PSI_WINDOW_SIZE_US)) {
+        // A lower trigger kept epoll_wait from timing out, step down as if it had.
+        pressure_level = std::max(reported_level, pressure_level - 1);
+        level_time = now;
+    }
+
     return pressure_level;
 }
 
@@ -130,6 +130,14 @@ static void nativeReportActualWorkDuration(JNIEnv* env, jclass /* clazz */, jlon
                                            jlongArray actualDurations, jlongArray timeStamps) {
     ScopedLongArrayRO arrayActualDurations(env, actualDurations);
     ScopedLongArrayRO arrayTimeStamps(env, timeStamps);
+    // Apps already batch their samples in APerformanceHintSession, so this is the only HAL call
+    // for a batch; do not make it for nothing, and do not read past the shorter array.
+    if (arrayActualDurations.size() == 0 ||
+        arrayActualDurations.size() != arrayTimeStamps.size()) {
+        ALOGW("Dropping work durations: %zu durations, %zu timestamps",
+              arrayActualDurations.size(), arrayTimeStamps.size());
+        return;
+    }
 
     std::vector<WorkDuration> actualList(arrayActualDurations.size());
     for (size_t i = 0; i < arrayActualDurations.size(); i++) {
@@ -58,6 +58,7 @@
 
 #include <atomic>
 #include <cinttypes>
+#include <iterator>
 #include <vector>
 
 #include "android_hardware_display_DisplayViewport.h"
@@ -246,6 +247,52 @@ static std::string getStringElementFromJavaArray(JNIEnv* env, jobjectArray array
     return result;
 }
 
+// Latency distribution of a policy callback that calls into Java synchronously on an input
+// thread, and so delays every event queued or dispatched behind it.
+class PolicyCallStats {
+public:
+    explicit PolicyCallStats(const char* name) : mName(name) {}
+
+    void record(nsecs_t duration) {
+        size_t bucket = 0;
+        while (bucket < NUM_BUCKETS - 1 && duration >= ms2ns(BUCKET_LIMITS_MS[bucket])) {
+            bucket++;
+        }
+        mCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+        mTotal.fetch_add(duration, std::memory_order_relaxed);
+        nsecs_t max = mMax.load(std::memory_order_relaxed);
+        while (duration > max &&
+               !mMax.compare_exchange_weak(max, duration, std::memory_order_relaxed)) {
+        }
+    }
+
+    void dump(std::string& dump) const {
+        uint64_t count = 0;
+        std::string histogram;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            const uint64_t bucketCount = mCounts[i].load(std::memory_order_relaxed);
+            count += bucketCount;
+            histogram += i < NUM_BUCKETS - 1
+                    ? StringPrintf(" <%" PRId64 "ms=%" PRIu64, BUCKET_LIMITS_MS[i], bucketCount)
+                    : StringPrintf(" >=%" PRId64 "ms=%" PRIu64, BUCKET_LIMITS_MS[i - 1],
+                                   bucketCount);
+        }
+        const nsecs_t total = mTotal.load(std::memory_order_relaxed);
+        dump += StringPrintf(INDENT INDENT "%s: calls=%" PRIu64 ", avg=%.3fms, max=%.3fms,%s\n",
+                             mName, count, count ? total / 1000000.0 / count : 0.0,
+                             mMax.load(std::memory_order_relaxed) / 1000000.0, histogram.c_str());
+    }
+
+private:
+    static constexpr int64_t BUCKET_LIMITS_MS[] = {1, 2, 5, 10, 20, 50, 100};
+    static constexpr size_t NUM_BUCKETS = std::size(BUCKET_LIMITS_MS) + 1;
+
+    const char* const mName;
+    std::atomic<uint64_t> mCounts[NUM_BUCKETS] = {};
+    std::atomic<nsecs_t> mTotal{0};
+    std::atomic<nsecs_t> mMax{0};
+};
+
 // --- NativeInputManager ---
 
 class NativeInputManager : public virtual RefBase,
@@ -390,6 +437,11 @@ private:
 
     std::atomic<bool> mInteractive;
 
+    PolicyCallStats mInterceptKeyBeforeQueueingStats{"interceptKeyBeforeQueueing"};
+    PolicyCallStats mInterceptMotionBeforeQueueingStats{
+            "interceptMotionBeforeQueueingNonInteractive"};
+    PolicyCallStats mInterceptKeyBeforeDispatchingStats{"interceptKeyBeforeDispatching"};
+
     void updateInactivityTimeoutLocked();
     void handleInterceptActions(jint wmActions, nsecs_t when, uint32_t& policyFlags);
     void ensureSpriteControllerLocked();
@@ -450,6 +502,10 @@ void NativeInputManager::dump(std::string& dump) {
                              mLocked.pointerCaptureRequest.enable ? "Enabled" : "Disabled",
                              mLocked.pointerCaptureRequest.seq);
     }
+    dump += INDENT "Policy Call Latency:\n";
+    mInterceptKeyBeforeQueueingStats.dump(dump);
+    mInterceptMotionBeforeQueueingStats.dump(dump);
+    mInterceptKeyBeforeDispatchingStats.dump(dump);
     dump += "\n";
 
     mInputManager->getReader().dump(dump);
@@ -1230,9 +1286,11 @@ void NativeInputManager::interceptKeyBeforeQueueing(const KeyEvent* keyEvent,
         jobject keyEventObj = android_view_KeyEvent_fromNative(env, keyEvent);
         jint wmActions;
         if (keyEventObj) {
+            const nsecs_t callStart = systemTime(SYSTEM_TIME_MONOTONIC);
             wmActions = env->CallIntMethod(mServiceObj,
                     gServiceClassInfo.interceptKeyBeforeQueueing,
                     keyEventObj, policyFlags);
+            mInterceptKeyBeforeQueueingStats.record(systemTime(SYSTEM_TIME_MONOTONIC) - callStart);
             if (checkAndClearExceptionFromCallback(env, "interceptKeyBeforeQueueing")) {
                 wmActions = 0;
             }
@@ -1268,9 +1326,12 @@ void NativeInputManager::interceptMotionBeforeQueueing(const int32_t displayId,
             policyFlags |= POLICY_FLAG_PASS_TO_USER;
         } else {
             JNIEnv* env = jniEnv();
+            const nsecs_t callStart = systemTime(SYSTEM_TIME_MONOTONIC);
             jint wmActions = env->CallIntMethod(mServiceObj,
                         gServiceClassInfo.interceptMotionBeforeQueueingNonInteractive,
                         displayId, when, policyFlags);
+            mInterceptMotionBeforeQueueingStats.record(systemTime(SYSTEM_TIME_MONOTONIC) -
+                                                       callStart);
             if (checkAndClearExceptionFromCallback(env,
                     "interceptMotionBeforeQueueingNonInteractive")) {
                 wmActions = 0;
@@ -1314,9 +1375,12 @@ nsecs_t NativeInputManager::interceptKeyBeforeDispatching(
 
         jobject keyEventObj = android_view_KeyEvent_fromNative(env, keyEvent);
         if (keyEventObj) {
+            const nsecs_t callStart = systemTime(SYSTEM_TIME_MONOTONIC);
             jlong delayMillis = env->CallLongMethod(mServiceObj,
                     gServiceClassInfo.interceptKeyBeforeDispatching,
                     tokenObj, keyEventObj, policyFlags);
+            mInterceptKeyBeforeDispatchingStats.record(systemTime(SYSTEM_TIME_MONOTONIC) -
+                                                       callStart);
             bool error = checkAndClearExceptionFromCallback(env, "interceptKeyBeforeDispatching");
             android_view_KeyEvent_recycle(env, keyEventObj);
             env->DeleteLocalRef(keyEventObj);
@@ -661,6 +661,9 @@ private:
             return;
         }
         CHECK(mIfs);
+        // Several threads blocked on the same page show up as separate pending reads; the
+        // server only needs to be asked for each block once.
+        mMissingBlocks.clear();
         for (auto&& pendingRead : pendingReads) {
             const android::dataloader::FileId& fileId = pendingRead.id;
             const auto blockIdx = static_cast<BlockIdx>(pendingRead.block);
@@ -677,7 +680,10 @@ private:
                 !sendRequest(mOutFd, PREFETCH, fileIdx, blockIdx)) {
                 mRequestedFiles.erase(fileIdx);
             }
-            sendRequest(mOutFd, BLOCK_MISSING, fileIdx, blockIdx);
+            const auto block = (uint64_t(uint16_t(fileIdx)) << 32) | uint32_t(blockIdx);
+            if (mMissingBlocks.insert(block).second) {
+                sendRequest(mOutFd, BLOCK_MISSING, fileIdx, blockIdx);
+            }
         }
     }
 
@@ -937,6 +943,8 @@ private:
     int64_t mLastSerialNo{-1};
     /** Tracks which files have been requested */
     std::unordered_set<FileIdx> mRequestedFiles;
+    /** Blocks requested in the current batch of pending reads, guarded by mOutFdLock */
+    std::unordered_set<uint64_t> mMissingBlocks;
 };
 
 OnTraceChanged::OnTraceChanged() {
@@ -35,15 +35,25 @@ static AStatsManager_PullAtomCallbackReturn onSurfaceFlingerPullCallback(int32_t
     return gSurfaceFlingerPuller.pull(atom_tag, data);
 }
 
+// The layer info pull serializes and parses the time stats of every layer, so it is the most
+// expensive of the native pulls. statsd shares the result between the metrics that request it
+// within the cool down, and waits for it longer than for the cheaper pulls.
+static constexpr int64_t kLayerInfoCoolDownMillis = 5000;
+static constexpr int64_t kLayerInfoTimeoutMillis = 5000;
+
 static void initializeNativePullers(JNIEnv* env, jobject javaObject) {
     // Surface flinger layer & global info.
     gSurfaceFlingerPuller = server::stats::SurfaceFlingerPuller();
     AStatsManager_setPullAtomCallback(android::util::SURFACEFLINGER_STATS_GLOBAL_INFO,
                                       /* metadata= */ nullptr, onSurfaceFlingerPullCallback,
                                       /* cookie= */ nullptr);
+    AStatsManager_PullAtomMetadata* layerInfoMetadata = AStatsManager_PullAtomMetadata_obtain();
+    AStatsManager_PullAtomMetadata_setCoolDownMillis(layerInfoMetadata, kLayerInfoCoolDownMillis);
+    AStatsManager_PullAtomMetadata_setTimeoutMillis(layerInfoMetadata, kLayerInfoTimeoutMillis);
     AStatsManager_setPullAtomCallback(android::util::SURFACEFLINGER_STATS_LAYER_INFO,
-                                      /* metadata= */ nullptr, onSurfaceFlingerPullCallback,
+                                      layerInfoMetadata, onSurfaceFlingerPullCallback,
                                       /* cookie= */ nullptr);
+    AStatsManager_PullAtomMetadata_release(layerInfoMetadata);
 }
 
 static const JNINativeMethod sMethods[] = {
@@ -97,6 +97,9 @@ void com_android_server_storage_AppFuseBridge_delete(JNIEnv* env, jobject self,
     delete loop;
 }
 
+// Runs the loop that relays FUSE requests of every bridge between /dev/fuse and the proxy
+// sockets. The relaying itself, including its buffers, lives in libappfuse's FuseBridgeLoop,
+// which none of the natives here look into.
 void com_android_server_storage_AppFuseBridge_start_loop(
         JNIEnv* env, jobject self, jlong java_loop) {
     fuse::FuseBridgeLoop* const loop = reinterpret_cast<fuse::FuseBridgeLoop*>(java_loop);
@@ -21,6 +21,11 @@
 #include <android/hardware/gnss/1.0/IGnss.h>
 #include <android/hardware/gnss/2.0/IGnss.h>
 #include <utils/SystemClock.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
 /*
  * Save a pointer to JavaVm to attach/detach threads executing
  * callback methods that need to make JNI calls.
@@ -118,6 +123,30 @@ void callObjectMethodIgnoringResult(JNIEnv* env, jobject obj, jmethodID mid, ...
     va_end(args);
 }
 
+jmethodID getSetterMethodId(JNIEnv* env, jclass clazz, const char* method_name,
+                            const char* signature) {
+    // Callers pass string literals, so their addresses identify the method. A literal that is
+    // not merged with an identical one only costs an extra entry.
+    using Key = std::tuple<jclass, const char*, const char*>;
+    static std::mutex lock;
+    static std::map<Key, jmethodID> methods;
+
+    const Key key{clazz, method_name, signature};
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = methods.find(key);
+        if (it != methods.end()) {
+            return it->second;
+        }
+    }
+    jmethodID method = env->GetMethodID(clazz, method_name, signature);
+    if (method != nullptr) {
+        std::lock_guard<std::mutex> guard(lock);
+        methods.emplace(key, method);
+    }
+    return method;
+}
+
 JavaObject::JavaObject(JNIEnv* env, jclass clazz, jmethodID defaultCtor)
       : env_(env), clazz_(clazz) {
     object_ = env_->NewObject(clazz_, defaultCtor);
@@ -139,7 +168,7 @@ template <>
 void JavaObject::callSetter(const char* method_name, uint8_t* value, size_t size) {
     jbyteArray array = env_->NewByteArray(size);
     env_->SetByteArrayRegion(array, 0, size, reinterpret_cast<jbyte*>(value));
-    jmethodID method = env_->GetMethodID(clazz_, method_name, "([B)V");
+    jmethodID method = getSetterMethodId(env_, clazz_, method_name, "([B)V");
     env_->CallVoidMethod(object_, method, array);
     env_->DeleteLocalRef(array);
 }
@@ -58,6 +58,11 @@ void checkAndClearExceptionFromCallback(JNIEnv* env, const char* methodName);
 
 void callObjectMethodIgnoringResult(JNIEnv* env, jobject obj, jmethodID mid, ...);
 
+// Returns the ID of a setter of clazz, which must be a global reference. IDs are looked up
+// once and then cached, since the setters run for every field of every measurement.
+jmethodID getSetterMethodId(JNIEnv* env, jclass clazz, const char* method_name,
+                            const char* signature);
+
 template <class T>
 void logHidlError(hardware::Return<T>& result, const char* errorMessage) {
     ALOGE("%s HIDL transport error: %s", errorMessage, result.description().c_str());
@@ -127,7 +132,7 @@ const char* const JavaMethodHelper<jdoubleArray>::signature_;
 template <class T>
 void JavaMethodHelper<T>::callJavaMethod(JNIEnv* env, jclass clazz, jobject object,
                                          const char* method_name, T value) {
-    jmethodID method = env->GetMethodID(clazz, method_name, signature_);
+    jmethodID method = getSetterMethodId(env, clazz, method_name, signature_);
     env->CallVoidMethod(object, method, value);
 }
 
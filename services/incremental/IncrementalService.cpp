@@ -94,6 +94,10 @@ struct Constants {
     static constexpr auto destroyTimeout = 10s;
 
     static constexpr auto anyStatus = INT_MIN;
+
+    // Native libraries of a mount extracted at the same time. Each one is decompressed into
+    // memory in full, so this also bounds the memory used by extraction.
+    static constexpr auto maxExtractionThreads = 4;
 };
 
 static const Constants& constants() {
@@ -1188,6 +1192,11 @@ int IncrementalService::makeFile(StorageId storage, std::string_view path, int m
                    << "]: " << err;
         return err;
     }
+    {
+        // A file that used to be at this path may have been fully loaded.
+        std::lock_guard l(ifs->loadedFilesLock);
+        ifs->loadedFileBlocks.erase(normPath);
+    }
     if (params.size > 0) {
         if (auto err = mIncFs->reserveSpace(ifs->control, id, params.size)) {
             if (err != -EOPNOTSUPP) {
@@ -1265,6 +1274,10 @@ int IncrementalService::link(StorageId sourceStorageId, std::string_view oldPath
 int IncrementalService::unlink(StorageId storage, std::string_view path) {
     if (auto ifs = getIfs(storage)) {
         std::string normOldPath = normalizePathToStorage(*ifs, storage, path);
+        {
+            std::lock_guard l(ifs->loadedFilesLock);
+            ifs->loadedFileBlocks.erase(normOldPath);
+        }
         return mIncFs->unlink(ifs->control, normOldPath);
     }
     return -EINVAL;
@@ -2214,6 +2227,15 @@ IncrementalService::LoadingProgress IncrementalService::getLoadingProgressFromPa
         const IncFsMount& ifs, std::string_view storagePath) const {
     ssize_t totalBlocks = 0, filledBlocks = 0, error = 0;
     mFs->listFilesRecursive(storagePath, [&, this](auto filePath) {
+        {
+            std::lock_guard l(ifs.loadedFilesLock);
+            if (const auto it = ifs.loadedFileBlocks.find(std::string(filePath));
+                it != ifs.loadedFileBlocks.end()) {
+                totalBlocks += it->second;
+                filledBlocks += it->second;
+                return true;
+            }
+        }
         const auto [filledBlocksCount, totalBlocksCount] =
                 mIncFs->countFilledBlocks(ifs.control, filePath);
         if (filledBlocksCount == -EOPNOTSUPP || filledBlocksCount == -ENOTSUP ||
@@ -2228,6 +2250,10 @@ IncrementalService::LoadingProgress IncrementalService::getLoadingProgressFromPa
             error = filledBlocksCount;
             return false;
         }
+        if (totalBlocksCount > 0 && filledBlocksCount == totalBlocksCount) {
+            std::lock_guard l(ifs.loadedFilesLock);
+            ifs.loadedFileBlocks.emplace(std::string(filePath), totalBlocksCount);
+        }
         totalBlocks += totalBlocksCount;
         filledBlocks += filledBlocksCount;
         return true;
@@ -2270,6 +2296,31 @@ bool IncrementalService::perfLoggingEnabled() {
     return enabled;
 }
 
+// Extraction jobs write separate files and only read the shared zip archive with pread(), so
+// the jobs of a mount can run at the same time: a library whose blocks have already arrived does
+// not have to wait for the one before it.
+static void runJobsInParallel(std::vector<Job>& jobs) {
+    const auto threadCount = std::min<size_t>(jobs.size(), constants().maxExtractionThreads);
+    std::atomic<size_t> nextJob = 0;
+    auto worker = [&jobs, &nextJob]() {
+        for (auto i = nextJob++; i < jobs.size(); i = nextJob++) {
+            jobs[i]();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    if (threadCount > 1) {
+        threads.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+    }
+    worker();
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+}
+
 void IncrementalService::runJobProcessing() {
     for (;;) {
         std::unique_lock lock(mJobMutex);
@@ -2284,9 +2335,7 @@ void IncrementalService::runJobProcessing() {
         mJobQueue.erase(it);
         lock.unlock();
 
-        for (auto&& job : queue) {
-            job();
-        }
+        runJobsInParallel(queue);
 
         lock.lock();
         mPendingJobsMount = kInvalidStorageId;
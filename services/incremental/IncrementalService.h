@@ -351,6 +351,10 @@ private:
         TimePoint startLoadingTs = {};
         std::atomic<int> nextStorageDirNo{0};
         const IncrementalService& incrementalService;
+        // Block counts of the files known to be fully loaded. These never change again, so
+        // loading progress only needs to ask incfs about the files that are still incomplete.
+        mutable std::mutex loadedFilesLock;
+        mutable std::unordered_map<std::string, ssize_t> loadedFileBlocks;
 
         IncFsMount(std::string root, std::string metricsKey, MountId mountId, Control control,
                    const IncrementalService& incrementalService)
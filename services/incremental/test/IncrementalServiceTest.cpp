@@ -1862,6 +1862,19 @@ TEST_F(IncrementalServiceTest, testGetLoadingProgressSuccess) {
     ASSERT_EQ(0.5, mIncrementalService->getLoadingProgress(storageId).getProgress());
 }
 
+TEST_F(IncrementalServiceTest, testGetLoadingProgressSkipsFullyLoadedFiles) {
+    mIncFs->countFilledBlocksFullyLoaded();
+    mFs->hasFiles();
+
+    TemporaryDir tempDir;
+    int storageId =
+            mIncrementalService->createStorage(tempDir.path, mDataLoaderParcel,
+                                               IncrementalService::CreateOptions::CreateNew);
+    EXPECT_CALL(*mIncFs, countFilledBlocks(_, _)).Times(3);
+    ASSERT_EQ(1, mIncrementalService->getLoadingProgress(storageId).getProgress());
+    ASSERT_EQ(1, mIncrementalService->getLoadingProgress(storageId).getProgress());
+}
+
 TEST_F(IncrementalServiceTest, testRegisterLoadingProgressListenerSuccess) {
     mIncFs->countFilledBlocksSuccess();
     mFs->hasFiles();
@@ -99,6 +99,8 @@ void CompileApkAssetsLayouts(const std::unique_ptr<android::ApkAssets>& assets,
   dex::ClassBuilder compiled_view{
       dex_file.MakeClass(StringPrintf("%s.CompiledView", package_name.c_str()))};
   std::vector<dex::MethodBuilder> methods;
+  size_t layout_count = 0;
+  size_t compiled_count = 0;
 
   assets->GetAssetsProvider()->ForEachFile("res/", [&](const android::StringPiece& s,
                                                        android::FileType) {
@@ -113,13 +115,16 @@ void CompileApkAssetsLayouts(const std::unique_ptr<android::ApkAssets>& assets,
         CHECK(android::kInvalidCookie != cookie);
         const auto dynamic_ref_table = resources.GetDynamicRefTableForCookie(cookie);
         CHECK(nullptr != dynamic_ref_table);
+        // The asset outlives the tree, so the tree can parse its buffer in place.
         android::ResXMLTree xml_tree{dynamic_ref_table};
         xml_tree.setTo(asset->getBuffer(/*wordAligned=*/true),
                        asset->getLength(),
-                       /*copy_data=*/true);
+                       /*copy_data=*/false);
         android::ResXMLParser parser{xml_tree};
         parser.restart();
+        layout_count++;
         if (CanCompileLayout(&parser)) {
+          compiled_count++;
           parser.restart();
           const std::string layout_name = startop::util::FindLayoutNameFromFilename(layout_path);
           ResXmlVisitorAdapter adapter{&parser};
@@ -152,6 +157,8 @@ void CompileApkAssetsLayouts(const std::unique_ptr<android::ApkAssets>& assets,
     }
   });
 
+  LOG(INFO) << "Compiled " << compiled_count << " of " << layout_count << " layouts";
+
   if (target == CompilationTarget::kDex) {
     slicer::MemView image{dex_file.CreateImage()};
     target_out.write(image.ptr<const char>(), image.size());
@@ -118,6 +118,10 @@ namespace {
 std::string ResolveName(const std::string& name) {
   if (name == "View") return "android.view.View";
   if (name == "ViewGroup") return "android.view.ViewGroup";
+  // The few android.view classes that layouts use by their short name.
+  if (name == "ViewStub") return "android.view.ViewStub";
+  if (name == "SurfaceView") return "android.view.SurfaceView";
+  if (name == "TextureView") return "android.view.TextureView";
   if (name.find('.') == std::string::npos) {
     return StringPrintf("android.widget.%s", name.c_str());
   }
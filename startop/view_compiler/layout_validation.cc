@@ -37,6 +37,19 @@ void LayoutValidationVisitor::VisitStartTag(const std::u16string& name) {
     message_ = "Fragment tags are not supported";
     can_compile_ = false;
   }
+  // LayoutInflater handles these itself instead of creating a view for them.
+  if (0 == name.compare(u"requestFocus")) {
+    message_ = "RequestFocus tags are not supported";
+    can_compile_ = false;
+  }
+  if (0 == name.compare(u"tag")) {
+    message_ = "Tag tags are not supported";
+    can_compile_ = false;
+  }
+  if (0 == name.compare(u"blink")) {
+    message_ = "Blink tags are not supported";
+    can_compile_ = false;
+  }
 }
 
 }  // namespace startop
\ No newline at end of file
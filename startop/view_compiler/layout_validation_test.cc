@@ -161,3 +161,37 @@ TEST(LayoutValidationTest, FragmentNode) {
 </LinearLayout>)";
   ValidateXmlText(xml, /*expected=*/false);
 }
+
+TEST(LayoutValidationTest, RequestFocusNode) {
+  const string xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<EditText xmlns:android="http://schemas.android.com/apk/res/android"
+    android:layout_width="match_parent"
+    android:layout_height="wrap_content">
+    <requestFocus />
+</EditText>)";
+  ValidateXmlText(xml, /*expected=*/false);
+}
+
+TEST(LayoutValidationTest, TagNode) {
+  const string xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<Button xmlns:android="http://schemas.android.com/apk/res/android"
+    android:layout_width="wrap_content"
+    android:layout_height="wrap_content">
+    <tag android:id="@+id/button_tag" android:value="primary" />
+</Button>)";
+  ValidateXmlText(xml, /*expected=*/false);
+}
+
+TEST(LayoutValidationTest, ViewStubNode) {
+  const string xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<LinearLayout xmlns:android="http://schemas.android.com/apk/res/android"
+    android:layout_width="match_parent"
+    android:layout_height="match_parent">
+    <ViewStub
+        android:id="@+id/stub"
+        android:layout="@layout/single_button_layout"
+        android:layout_width="wrap_content"
+        android:layout_height="wrap_content" />
+</LinearLayout>)";
+  ValidateXmlText(xml, /*expected=*/true);
+}
@@ -20,6 +20,10 @@
 
 #include <algorithm>
 
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
 // STATUST: mingw does seem to redefine UNKNOWN_ERROR from our enum value, so a cast is necessary.
 
 #if !defined(_WIN32)
@@ -31,8 +35,21 @@
 // Set to true for noisy debug output.
 static const bool kIsDebug = false;
 
-// Number of threads to use for preprocessing images.
-static const size_t MAX_THREADS = 4;
+// Minimum number of threads to use for preprocessing images.
+static const size_t MIN_THREADS = 4;
+
+// Crunching is CPU bound and every image is written to its own AaptFile, so the output does not
+// depend on how many threads do the work.
+static size_t getPreProcessThreadCount()
+{
+#if !defined(_WIN32)
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0) {
+        return std::max(MIN_THREADS, static_cast<size_t>(cores));
+    }
+#endif
+    return MIN_THREADS;
+}
 
 // ==========================================================================
 // ==========================================================================
@@ -367,7 +384,7 @@ static status_t preProcessImages(const Bundle* bundle, const sp<AaptAssets>& ass
     volatile bool hasErrors = false;
     ssize_t res = NO_ERROR;
     if (bundle->getUseCrunchCache() == false) {
-        WorkQueue wq(MAX_THREADS, false);
+        WorkQueue wq(getPreProcessThreadCount(), false);
         ResourceDirIterator it(set, String8(type));
         while ((res=it.next()) == NO_ERROR) {
             PreProcessImageWorkUnit* w = new PreProcessImageWorkUnit(
@@ -20,6 +20,8 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "androidfw/StringPiece.h"
@@ -150,6 +152,29 @@ class SourcePathDiagnostics : public IDiagnostics {
   DISALLOW_COPY_AND_ASSIGN(SourcePathDiagnostics);
 };
 
+// Keeps the messages logged by work done on another thread, so that they can be logged in the
+// order the work would have been done in serially.
+class BufferedDiagnostics : public IDiagnostics {
+ public:
+  BufferedDiagnostics() = default;
+
+  void Log(Level level, DiagMessageActual& actual_msg) override {
+    messages_.emplace_back(level, actual_msg);
+  }
+
+  // Logs every message kept to diag.
+  void Replay(IDiagnostics* diag) {
+    for (auto& [level, actual_msg] : messages_) {
+      diag->Log(level, actual_msg);
+    }
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BufferedDiagnostics);
+
+  std::vector<std::pair<Level, DiagMessageActual>> messages_;
+};
+
 }  // namespace aapt
 
 #endif /* AAPT_DIAGNOSTICS_H */
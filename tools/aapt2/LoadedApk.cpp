@@ -16,6 +16,9 @@
 
 #include "LoadedApk.h"
 
+#include <algorithm>
+#include <thread>
+
 #include "ResourceValues.h"
 #include "ValueVisitor.h"
 #include "format/Archive.h"
@@ -72,7 +75,8 @@ static ApkFormat DetermineApkFormat(io::IFileCollection* apk) {
   }
 }
 
-std::unique_ptr<LoadedApk> LoadedApk::LoadApkFromPath(const StringPiece& path, IDiagnostics* diag) {
+std::unique_ptr<LoadedApk> LoadedApk::LoadApkFromPath(const StringPiece& path, IDiagnostics* diag,
+                                                      bool load_table) {
   Source source(path);
   std::string error;
   std::unique_ptr<io::ZipFileCollection> apk = io::ZipFileCollection::Create(path, &error);
@@ -84,9 +88,9 @@ std::unique_ptr<LoadedApk> LoadedApk::LoadApkFromPath(const StringPiece& path, I
   ApkFormat apkFormat = DetermineApkFormat(apk.get());
   switch (apkFormat) {
     case ApkFormat::kBinary:
-      return LoadBinaryApkFromFileCollection(source, std::move(apk), diag);
+      return LoadBinaryApkFromFileCollection(source, std::move(apk), diag, load_table);
     case ApkFormat::kProto:
-      return LoadProtoApkFromFileCollection(source, std::move(apk), diag);
+      return LoadProtoApkFromFileCollection(source, std::move(apk), diag, load_table);
     default:
       diag->Error(DiagMessage(path) << "could not identify format of APK");
       return {};
@@ -94,27 +98,24 @@ std::unique_ptr<LoadedApk> LoadedApk::LoadApkFromPath(const StringPiece& path, I
 }
 
 std::unique_ptr<LoadedApk> LoadedApk::LoadProtoApkFromFileCollection(
-    const Source& source, unique_ptr<io::IFileCollection> collection, IDiagnostics* diag) {
+    const Source& source, unique_ptr<io::IFileCollection> collection, IDiagnostics* diag,
+    bool load_table) {
   std::unique_ptr<ResourceTable> table;
 
-  io::IFile* table_file = collection->FindFile(kProtoResourceTablePath);
+  io::IFile* table_file = load_table ? collection->FindFile(kProtoResourceTablePath) : nullptr;
   if (table_file != nullptr) {
-    pb::ResourceTable pb_table;
-    std::unique_ptr<io::InputStream> in = table_file->OpenInputStream();
-    if (in == nullptr) {
+    // The table is deserialized straight from the file's data a type at a time, which for large
+    // tables takes much less memory than parsing all of it into a pb::ResourceTable first.
+    std::unique_ptr<io::IData> data = table_file->OpenAsData();
+    if (data == nullptr) {
       diag->Error(DiagMessage(source) << "failed to open " << kProtoResourceTablePath);
       return {};
     }
 
-    io::ProtoInputStreamReader proto_reader(in.get());
-    if (!proto_reader.ReadMessage(&pb_table)) {
-      diag->Error(DiagMessage(source) << "failed to read " << kProtoResourceTablePath);
-      return {};
-    }
-
     std::string error;
     table = util::make_unique<ResourceTable>(ResourceTable::Validation::kDisabled);
-    if (!DeserializeTableFromPb(pb_table, collection.get(), table.get(), &error)) {
+    const StringPiece pb_table_data(static_cast<const char*>(data->data()), data->size());
+    if (!DeserializeTableFromPb(pb_table_data, collection.get(), table.get(), &error)) {
       diag->Error(DiagMessage(source)
                   << "failed to deserialize " << kProtoResourceTablePath << ": " << error);
       return {};
@@ -152,10 +153,11 @@ std::unique_ptr<LoadedApk> LoadedApk::LoadProtoApkFromFileCollection(
 }
 
 std::unique_ptr<LoadedApk> LoadedApk::LoadBinaryApkFromFileCollection(
-    const Source& source, unique_ptr<io::IFileCollection> collection, IDiagnostics* diag) {
+    const Source& source, unique_ptr<io::IFileCollection> collection, IDiagnostics* diag,
+    bool load_table) {
   std::unique_ptr<ResourceTable> table;
 
-  io::IFile* table_file = collection->FindFile(kApkResourceTablePath);
+  io::IFile* table_file = load_table ? collection->FindFile(kApkResourceTablePath) : nullptr;
   if (table_file != nullptr) {
     table = util::make_unique<ResourceTable>(ResourceTable::Validation::kDisabled);
     std::unique_ptr<io::IData> data = table_file->OpenAsData();
@@ -218,6 +220,7 @@ bool LoadedApk::WriteToArchive(IAaptContext* context, ResourceTable* split_table
     }
   }
 
+  std::vector<std::pair<io::IFile*, std::string>> files_to_write;
   std::unique_ptr<io::IFileCollectionIterator> iterator = apk_->Iterator();
   while (iterator->HasNext()) {
     io::IFile* file = iterator->Next();
@@ -247,6 +250,29 @@ bool LoadedApk::WriteToArchive(IAaptContext* context, ResourceTable* split_table
       }
       continue;
     }
+    files_to_write.emplace_back(file, std::move(output_path));
+  }
+
+  // Most files are copied as they are, which for compressed files means inflating them one after
+  // another. Read them ahead in batches instead, inflating a batch concurrently.
+  constexpr size_t kPrefetchBatchSize = 64;
+  const size_t prefetch_jobs = std::thread::hardware_concurrency();
+  for (size_t i = 0; i < files_to_write.size(); i++) {
+    if (i % kPrefetchBatchSize == 0) {
+      std::vector<io::IFile*> batch;
+      for (size_t j = i; j < std::min(i + kPrefetchBatchSize, files_to_write.size()); j++) {
+        const std::string& path = files_to_write[j].first->GetSource().path;
+        if (path != kApkResourceTablePath && path != kProtoResourceTablePath &&
+            (manifest == nullptr || path != kAndroidManifestPath)) {
+          batch.push_back(files_to_write[j].first);
+        }
+      }
+      apk_->Prefetch(batch, prefetch_jobs);
+    }
+
+    io::IFile* file = files_to_write[i].first;
+    const std::string& path = file->GetSource().path;
+    const std::string& output_path = files_to_write[i].second;
 
     // The resource table needs to be re-serialized since it might have changed.
     if (format_ == ApkFormat::kBinary && path == kApkResourceTablePath) {
@@ -272,13 +298,13 @@ bool LoadedApk::WriteToArchive(IAaptContext* context, ResourceTable* split_table
           options.collapse_key_stringpool;
       proto_serialize_options.name_collapse_exemptions =
           options.name_collapse_exemptions;
-      pb::ResourceTable pb_table;
-      SerializeTableToPb(*split_table, &pb_table, context->GetDiagnostics(),
-                         proto_serialize_options);
-      if (!io::CopyProtoToArchive(context,
-                                  &pb_table,
-                                  path,
-                                  ArchiveEntry::kAlign, writer)) {
+      if (!io::CopyProtoStreamToArchive(
+              context,
+              [&](::google::protobuf::io::ZeroCopyOutputStream* out) {
+                return SerializeTableToPb(*split_table, out, context->GetDiagnostics(),
+                                          proto_serialize_options);
+              },
+              path, ArchiveEntry::kAlign, writer)) {
         return false;
       }
     } else if (manifest != nullptr && path == "AndroidManifest.xml") {
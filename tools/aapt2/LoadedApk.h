@@ -44,17 +44,21 @@ class LoadedApk {
  public:
   virtual ~LoadedApk() = default;
 
-  // Loads both binary and proto APKs from disk.
+  // Loads both binary and proto APKs from disk. If load_table is false, the resource table is not
+  // parsed and GetResourceTable() returns nullptr, which saves most of the time and memory of
+  // loading an APK for callers that only need its manifest or files.
   static std::unique_ptr<LoadedApk> LoadApkFromPath(const ::android::StringPiece& path,
-                                                    IDiagnostics* diag);
+                                                    IDiagnostics* diag, bool load_table = true);
 
   // Loads a proto APK from the given file collection.
   static std::unique_ptr<LoadedApk> LoadProtoApkFromFileCollection(
-      const Source& source, std::unique_ptr<io::IFileCollection> collection, IDiagnostics* diag);
+      const Source& source, std::unique_ptr<io::IFileCollection> collection, IDiagnostics* diag,
+      bool load_table = true);
 
   // Loads a binary APK from the given file collection.
   static std::unique_ptr<LoadedApk> LoadBinaryApkFromFileCollection(
-      const Source& source, std::unique_ptr<io::IFileCollection> collection, IDiagnostics* diag);
+      const Source& source, std::unique_ptr<io::IFileCollection> collection, IDiagnostics* diag,
+      bool load_table = true);
 
   LoadedApk(const Source& source, std::unique_ptr<io::IFileCollection> apk,
             std::unique_ptr<ResourceTable> table, std::unique_ptr<xml::XmlResource> manifest,
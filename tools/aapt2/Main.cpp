@@ -24,6 +24,7 @@
 #include <iostream>
 #include <vector>
 
+#include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
 #include "android-base/utf8.h"
 #include "androidfw/StringPiece.h"
@@ -36,7 +37,9 @@
 #include "cmd/Dump.h"
 #include "cmd/Link.h"
 #include "cmd/Optimize.h"
+#include "cmd/TraceReport.h"
 #include "io/FileStream.h"
+#include "process/ApkAssetsCache.h"
 #include "trace/TraceBuffer.h"
 #include "util/Files.h"
 #include "util/Util.h"
@@ -63,14 +66,16 @@ class VersionCommand : public Command {
 /** The main entry point of AAPT. */
 class MainCommand : public Command {
  public:
-  explicit MainCommand(text::Printer* printer, IDiagnostics* diagnostics)
+  explicit MainCommand(text::Printer* printer, IDiagnostics* diagnostics,
+                       ApkAssetsCache* apk_assets_cache = nullptr)
       : Command("aapt2"), diagnostics_(diagnostics) {
     AddOptionalSubcommand(util::make_unique<CompileCommand>(diagnostics));
-    AddOptionalSubcommand(util::make_unique<LinkCommand>(diagnostics));
+    AddOptionalSubcommand(util::make_unique<LinkCommand>(diagnostics, apk_assets_cache));
     AddOptionalSubcommand(util::make_unique<DumpCommand>(printer, diagnostics));
     AddOptionalSubcommand(util::make_unique<DiffCommand>());
     AddOptionalSubcommand(util::make_unique<OptimizeCommand>());
     AddOptionalSubcommand(util::make_unique<ConvertCommand>());
+    AddOptionalSubcommand(util::make_unique<TraceReportCommand>(printer, diagnostics));
     AddOptionalSubcommand(util::make_unique<VersionCommand>());
   }
 
@@ -103,10 +108,29 @@ class DaemonCommand : public Command {
         "command. The end of an invocation is signaled by providing an empty line.");
     AddOptionalFlag("--trace_folder", "Generate systrace json trace fragment to specified folder.",
                     &trace_folder_);
+    AddOptionalFlag("--include-cache-size",
+        "Size in MiB of the APKs included by links (-I) that are kept loaded for the next\n"
+            "links. 0 loads them again for every link. Defaults to 256.",
+        &include_cache_size_);
   }
 
   int Action(const std::vector<std::string>& arguments) override {
     TRACE_FLUSH_ARGS(trace_folder_ ? trace_folder_.value() : "", "daemon", arguments);
+    size_t include_cache_size = 256;
+    if (include_cache_size_ &&
+        !android::base::ParseUint(include_cache_size_.value(), &include_cache_size)) {
+      diagnostics_->Error(DiagMessage() << "--include-cache-size must be a number of MiB, got '"
+                                        << include_cache_size_.value() << "'");
+      return 1;
+    }
+
+    // The includes, android.jar in particular, are usually the same for every link, so keep them
+    // loaded instead of parsing them again for each one.
+    std::unique_ptr<ApkAssetsCache> apk_assets_cache;
+    if (include_cache_size > 0) {
+      apk_assets_cache = util::make_unique<ApkAssetsCache>(include_cache_size * 1024 * 1024);
+    }
+
     text::Printer printer(out_);
     std::cout << "Ready" << std::endl;
 
@@ -132,7 +156,8 @@ class DaemonCommand : public Command {
 
       std::vector<StringPiece> args;
       args.insert(args.end(), raw_args.begin(), raw_args.end());
-      int result = MainCommand(&printer, diagnostics_).Execute(args, &std::cerr);
+      int result =
+          MainCommand(&printer, diagnostics_, apk_assets_cache.get()).Execute(args, &std::cerr);
       out_->Flush();
       if (result != 0) {
         std::cerr << "Error" << std::endl;
@@ -148,6 +173,7 @@ class DaemonCommand : public Command {
   io::FileOutputStream* out_;
   IDiagnostics* diagnostics_;
   std::optional<std::string> trace_folder_;
+  std::optional<std::string> include_cache_size_;
 };
 
 }  // namespace aapt
@@ -133,20 +133,48 @@ ResourceTableType* ResourceTablePackage::FindOrCreateType(ResourceType type) {
 }
 
 ResourceEntry* ResourceTableType::CreateEntry(const android::StringPiece& name) {
-  return FindElementsRunAction<ResourceEntry>(name, entries, [&](bool found, auto& iter) {
-    return entries.emplace(iter, new ResourceEntry(name))->get();
-  });
+  ResourceEntry* entry = FindElementsRunAction<ResourceEntry>(
+      name, entries, [&](bool found, auto& iter) {
+        return entries.emplace(iter, new ResourceEntry(name))->get();
+      });
+  IndexInsertedEntry(entry);
+  return entry;
 }
 
 ResourceEntry* ResourceTableType::FindEntry(const android::StringPiece& name) const {
-  return FindElementsRunAction<ResourceEntry>(
-      name, entries, [&](bool found, auto& iter) { return found ? iter->get() : nullptr; });
+  const auto& index = GetEntryIndex();
+  auto iter = index.find(name);
+  return iter != index.end() ? iter->second : nullptr;
 }
 
 ResourceEntry* ResourceTableType::FindOrCreateEntry(const android::StringPiece& name) {
-  return FindElementsRunAction<ResourceEntry>(name, entries, [&](bool found, auto& iter) {
-    return found ? iter->get() : entries.emplace(iter, new ResourceEntry(name))->get();
-  });
+  if (ResourceEntry* entry = FindEntry(name)) {
+    return entry;
+  }
+  return CreateEntry(name);
+}
+
+const std::unordered_map<StringPiece, ResourceEntry*>& ResourceTableType::GetEntryIndex() const {
+  if (!entry_index_built_) {
+    entry_index_.clear();
+    entry_index_.reserve(entries.size());
+    for (const auto& entry : entries) {
+      // Entries are sorted, so the first with a name is found first.
+      entry_index_.emplace(entry->name, entry.get());
+    }
+    entry_index_built_ = true;
+  }
+  return entry_index_;
+}
+
+void ResourceTableType::IndexInsertedEntry(ResourceEntry* entry) {
+  if (!entry_index_built_) {
+    return;
+  }
+
+  // The new entry goes before any others of the same name, and takes over the name.
+  entry_index_.erase(entry->name);
+  entry_index_.emplace(entry->name, entry);
 }
 
 ResourceConfigValue* ResourceEntry::FindValue(const ConfigDescription& config,
@@ -474,8 +502,11 @@ bool ResourceTable::AddResource(NewResource&& res, IDiagnostics* diag) {
 
   auto package = FindOrCreatePackage(res.name.package);
   auto type = package->FindOrCreateType(res.name.type.type);
-  auto entry_it = std::equal_range(type->entries.begin(), type->entries.end(), res.name.entry,
-                                   NameEqualRange<ResourceEntry>{});
+  auto entry_it = std::make_pair(type->entries.end(), type->entries.end());
+  if (type->FindEntry(res.name.entry) != nullptr) {
+    entry_it = std::equal_range(type->entries.begin(), type->entries.end(), res.name.entry,
+                                NameEqualRange<ResourceEntry>{});
+  }
   const size_t entry_count = std::distance(entry_it.first, entry_it.second);
 
   ResourceEntry* entry;
@@ -617,6 +648,10 @@ std::optional<ResourceTable::SearchResult> ResourceTable::FindResource(const Res
     return {};
   }
 
+  if (type->FindEntry(name.entry) == nullptr) {
+    return {};
+  }
+
   auto entry_it = std::equal_range(type->entries.begin(), type->entries.end(), name.entry,
                                    NameEqualRange<ResourceEntry>{});
   for (auto it = entry_it.first; it != entry_it.second; ++it) {
@@ -638,11 +673,16 @@ bool ResourceTable::RemoveResource(const ResourceNameRef& name, ResourceId id) c
     return {};
   }
 
+  if (type->FindEntry(name.entry) == nullptr) {
+    return {};
+  }
+
   auto entry_it = std::equal_range(type->entries.begin(), type->entries.end(), name.entry,
                                    NameEqualRange<ResourceEntry>{});
   for (auto it = entry_it.first; it != entry_it.second; ++it) {
     if ((*it)->id == id) {
       type->entries.erase(it);
+      type->InvalidateEntryIndex();
       return true;
     }
   }
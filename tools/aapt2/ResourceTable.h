@@ -173,17 +173,36 @@ class ResourceTableType {
   // Whether this type is public (and must maintain the same type ID across builds).
   Visibility::Level visibility_level = Visibility::Level::kUndefined;
 
-  // List of resources for this type.
+  // List of resources for this type, sorted by name.
   std::vector<std::unique_ptr<ResourceEntry>> entries;
 
   explicit ResourceTableType(const ResourceType type) : type(type) {}
 
+  // Like FindEntry(), these keep the index of entries by name up to date.
   ResourceEntry* CreateEntry(const android::StringPiece& name);
-  ResourceEntry* FindEntry(const android::StringPiece& name) const;
   ResourceEntry* FindOrCreateEntry(const android::StringPiece& name);
 
+  // Returns the first entry with the given name, if any, without searching entries.
+  ResourceEntry* FindEntry(const android::StringPiece& name) const;
+
+  // Must be called after entries are added, removed, reordered or renamed other than through
+  // CreateEntry() or FindOrCreateEntry(), so that the next lookup rebuilds the index.
+  void InvalidateEntryIndex() {
+    entry_index_built_ = false;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(ResourceTableType);
+
+  // Returns the index of entries by name, rebuilding it if it was invalidated.
+  const std::unordered_map<android::StringPiece, ResourceEntry*>& GetEntryIndex() const;
+
+  // Updates the index, if it is built, with an entry just inserted before any others of its name.
+  void IndexInsertedEntry(ResourceEntry* entry);
+
+  // Maps each name to the first of the entries with that name.
+  mutable std::unordered_map<android::StringPiece, ResourceEntry*> entry_index_;
+  mutable bool entry_index_built_ = false;
 };
 
 class ResourceTablePackage {
@@ -384,4 +384,37 @@ TEST(ResourceTableTest, ConflictingIdsCreateEntry) {
       test::GetDiagnostics()));
 }
 
+TEST(ResourceTableTest, FindEntryAfterEntriesChange) {
+  ResourceTableType type(ResourceType::kString);
+  ResourceEntry* foo = type.CreateEntry("foo");
+  ResourceEntry* bar = type.FindOrCreateEntry("bar");
+  EXPECT_THAT(type.FindEntry("foo"), Eq(foo));
+  EXPECT_THAT(type.FindEntry("bar"), Eq(bar));
+  EXPECT_THAT(type.FindEntry("baz"), Eq(nullptr));
+
+  // A duplicate entry goes first.
+  ResourceEntry* other_foo = type.CreateEntry("foo");
+  EXPECT_THAT(type.FindEntry("foo"), Eq(other_foo));
+  EXPECT_THAT(type.FindOrCreateEntry("foo"), Eq(other_foo));
+
+  // Entries removed directly, even if as many are then added again.
+  type.entries.erase(type.entries.begin());
+  type.InvalidateEntryIndex();
+  EXPECT_THAT(type.FindEntry("bar"), Eq(nullptr));
+  EXPECT_THAT(type.FindEntry("foo"), Eq(other_foo));
+  type.entries.erase(type.entries.begin());
+  type.InvalidateEntryIndex();
+  ResourceEntry* baz = type.CreateEntry("baz");
+  EXPECT_THAT(type.FindEntry("foo"), Eq(foo));
+  EXPECT_THAT(type.FindEntry("baz"), Eq(baz));
+
+  // Entries replaced directly.
+  std::vector<std::unique_ptr<ResourceEntry>> entries;
+  entries.push_back(util::make_unique<ResourceEntry>("qux"));
+  type.entries = std::move(entries);
+  type.InvalidateEntryIndex();
+  EXPECT_THAT(type.FindEntry("foo"), Eq(nullptr));
+  EXPECT_THAT(type.FindEntry("qux"), NotNull());
+}
+
 }  // namespace aapt
@@ -19,8 +19,10 @@
 #include <algorithm>
 #include <cinttypes>
 #include <limits>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <unordered_set>
 
 #include "android-base/stringprintf.h"
 #include "androidfw/ResourceTypes.h"
@@ -36,6 +38,56 @@ using ::android::base::StringPrintf;
 
 namespace aapt {
 
+// Returns the one copy of str kept for the sources of all values. These are never freed, as values
+// anywhere may point at them, but there are only as many as there are files and archives.
+static const std::string* InternSourceString(const std::string& str) {
+  // Values are mostly given the source of the value before them.
+  thread_local const std::string* last = nullptr;
+  if (last != nullptr && *last == str) {
+    return last;
+  }
+
+  static std::mutex lock;
+  static std::unordered_set<std::string>* strings = new std::unordered_set<std::string>();
+  std::lock_guard<std::mutex> guard(lock);
+  last = &*strings->insert(str).first;
+  return last;
+}
+
+Source Value::GetSource() const {
+  Source source;
+  if (source_path_ != nullptr) {
+    source.path = *source_path_;
+  }
+  if (has_source_line_) {
+    source.line = source_line_;
+  }
+  if (source_archive_ != nullptr) {
+    source.archive = *source_archive_;
+  }
+  return source;
+}
+
+void Value::SetSource(const Source& source) {
+  source_path_ = source.path.empty() ? nullptr : InternSourceString(source.path);
+  source_archive_ = source.archive ? InternSourceString(source.archive.value()) : nullptr;
+  has_source_line_ = source.line.has_value();
+  source_line_ = static_cast<uint32_t>(source.line.value_or(0));
+}
+
+const std::string& Value::GetComment() const {
+  static const std::string* empty = new std::string();
+  return comment_ != nullptr ? *comment_ : *empty;
+}
+
+void Value::SetComment(const android::StringPiece& str) {
+  comment_ = str.empty() ? nullptr : std::make_shared<const std::string>(str.to_string());
+}
+
+void Value::SetComment(std::string&& str) {
+  comment_ = str.empty() ? nullptr : std::make_shared<const std::string>(std::move(str));
+}
+
 void Value::PrettyPrint(Printer* printer) const {
   std::ostringstream str_stream;
   Print(&str_stream);
@@ -19,6 +19,7 @@
 
 #include <array>
 #include <limits>
+#include <memory>
 #include <ostream>
 #include <vector>
 
@@ -67,30 +68,15 @@ class Value {
   }
 
   // Returns the source where this value was defined.
-  const Source& GetSource() const {
-    return source_;
-  }
-
-  void SetSource(const Source& source) {
-    source_ = source;
-  }
+  Source GetSource() const;
 
-  void SetSource(Source&& source) {
-    source_ = std::move(source);
-  }
+  void SetSource(const Source& source);
 
   // Returns the comment that was associated with this resource.
-  const std::string& GetComment() const {
-    return comment_;
-  }
-
-  void SetComment(const android::StringPiece& str) {
-    comment_ = str.to_string();
-  }
+  const std::string& GetComment() const;
 
-  void SetComment(std::string&& str) {
-    comment_ = std::move(str);
-  }
+  void SetComment(const android::StringPiece& str);
+  void SetComment(std::string&& str);
 
   virtual bool Equals(const Value* value) const = 0;
 
@@ -113,8 +99,13 @@ class Value {
   friend std::ostream& operator<<(std::ostream& out, const Value& value);
 
  protected:
-  Source source_;
-  std::string comment_;
+  // A table holds millions of values, most of which share their source's path with many others, and
+  // have no comment. So the path and archive are interned, and the comment is shared by copies.
+  const std::string* source_path_ = nullptr;
+  const std::string* source_archive_ = nullptr;
+  std::shared_ptr<const std::string> comment_;
+  uint32_t source_line_ = 0;
+  bool has_source_line_ = false;
   bool weak_ = false;
   bool translatable_ = true;
 
@@ -18,6 +18,7 @@
 
 #include "test/Test.h"
 
+using ::android::StringPiece;
 using ::testing::Eq;
 using ::testing::SizeIs;
 using ::testing::StrEq;
@@ -292,4 +293,30 @@ TEST(ResourcesValuesTest, AttributeIsCompatible) {
   EXPECT_FALSE(attr_three.IsCompatibleWith(attr_four));
 }
 
+TEST(ResourceValuesTest, KeepsSourceAndComment) {
+  Id id;
+  EXPECT_THAT(id.GetSource(), Eq(Source()));
+  EXPECT_THAT(id.GetComment(), StrEq(""));
+
+  id.SetSource(Source("res/values/ids.xml", 12));
+  id.SetComment(StringPiece("A comment"));
+  EXPECT_THAT(id.GetSource().path, StrEq("res/values/ids.xml"));
+  EXPECT_THAT(id.GetSource().line, Eq(std::optional<size_t>(12)));
+  EXPECT_FALSE(id.GetSource().archive);
+
+  Id other_id;
+  other_id.SetSource(Source("res/values/ids.xml", "lib.aar"));
+  EXPECT_THAT(other_id.GetSource().archive, Eq(std::optional<std::string>("lib.aar")));
+  EXPECT_FALSE(other_id.GetSource().line);
+
+  // Copies keep the source and comment, which later changes to the original don't affect.
+  Id copy = id;
+  id.SetSource(Source("res/values-en/ids.xml"));
+  id.SetComment(StringPiece());
+  EXPECT_THAT(copy.GetSource(), Eq(Source("res/values/ids.xml", 12)));
+  EXPECT_THAT(copy.GetComment(), StrEq("A comment"));
+  EXPECT_THAT(id.GetSource(), Eq(Source("res/values-en/ids.xml")));
+  EXPECT_THAT(id.GetComment(), StrEq(""));
+}
+
 } // namespace aapt
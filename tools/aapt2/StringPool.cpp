@@ -23,6 +23,7 @@
 #include "android-base/logging.h"
 #include "androidfw/ResourceTypes.h"
 #include "androidfw/StringPiece.h"
+#include "utils/Unicode.h"
 
 #include "util/BigBuffer.h"
 #include "util/Util.h"
@@ -171,28 +172,72 @@ StringPool::Ref StringPool::MakeRef(const StringPiece& str, const Context& conte
 
 StringPool::Ref StringPool::MakeRefImpl(const StringPiece& str, const Context& context,
                                         bool unique) {
+  const size_t hash = std::hash<StringPiece>{}(str);
   if (unique) {
-    auto range = indexed_strings_.equal_range(str);
-    for (auto iter = range.first; iter != range.second; ++iter) {
-      if (context.priority == iter->second->context.priority) {
-        return Ref(iter->second);
-      }
+    if (Entry* entry = FindIndexed(str, hash, context.priority)) {
+      return Ref(entry);
     }
   }
 
+  ReserveIndex(strings_.size() + 1);
+
   std::unique_ptr<Entry> entry(new Entry());
   entry->value = str.to_string();
   entry->context = context;
   entry->index_ = strings_.size();
   entry->ref_ = 0;
   entry->pool_ = this;
+  entry->hash_ = hash;
 
   Entry* borrow = entry.get();
   strings_.emplace_back(std::move(entry));
-  indexed_strings_.insert(std::make_pair(StringPiece(borrow->value), borrow));
+  AddToIndex(borrow);
   return Ref(borrow);
 }
 
+StringPool::Entry* StringPool::FindIndexed(const StringPiece& str, size_t hash,
+                                           uint32_t priority) const {
+  if (index_.empty()) {
+    return nullptr;
+  }
+
+  const size_t mask = index_.size() - 1;
+  for (size_t slot = hash & mask; index_[slot] != nullptr; slot = (slot + 1) & mask) {
+    Entry* entry = index_[slot];
+    if (entry->hash_ == hash && entry->context.priority == priority && entry->value == str) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+void StringPool::ReserveIndex(size_t string_count) {
+  // Keep the index at most 3/4 full, so that probing stays short.
+  size_t slot_count = std::max<size_t>(index_.size(), 16);
+  while (string_count * 4 > slot_count * 3) {
+    slot_count *= 2;
+  }
+  if (slot_count != index_.size()) {
+    RebuildIndex(slot_count);
+  }
+}
+
+void StringPool::AddToIndex(Entry* entry) {
+  const size_t mask = index_.size() - 1;
+  size_t slot = entry->hash_ & mask;
+  while (index_[slot] != nullptr) {
+    slot = (slot + 1) & mask;
+  }
+  index_[slot] = entry;
+}
+
+void StringPool::RebuildIndex(size_t slot_count) {
+  index_.assign(slot_count, nullptr);
+  for (const std::unique_ptr<Entry>& entry : strings_) {
+    AddToIndex(entry.get());
+  }
+}
+
 StringPool::Ref StringPool::MakeRef(const Ref& ref) {
   if (ref.entry_->pool_ == this) {
     return ref;
@@ -257,10 +302,14 @@ void StringPool::Merge(StringPool&& pool) {
   // Now move the styles, strings, and indices over.
   std::move(pool.styles_.begin(), pool.styles_.end(), std::back_inserter(styles_));
   pool.styles_.clear();
+  const size_t first_merged = strings_.size();
+  ReserveIndex(strings_.size() + pool.strings_.size());
   std::move(pool.strings_.begin(), pool.strings_.end(), std::back_inserter(strings_));
   pool.strings_.clear();
-  indexed_strings_.insert(pool.indexed_strings_.begin(), pool.indexed_strings_.end());
-  pool.indexed_strings_.clear();
+  pool.index_.clear();
+  for (size_t i = first_merged; i < strings_.size(); i++) {
+    AddToIndex(strings_[i].get());
+  }
 
   ReAssignIndices();
 }
@@ -268,19 +317,10 @@ void StringPool::Merge(StringPool&& pool) {
 void StringPool::HintWillAdd(size_t string_count, size_t style_count) {
   strings_.reserve(strings_.size() + string_count);
   styles_.reserve(styles_.size() + style_count);
+  ReserveIndex(strings_.size() + string_count);
 }
 
 void StringPool::Prune() {
-  const auto iter_end = indexed_strings_.end();
-  auto index_iter = indexed_strings_.begin();
-  while (index_iter != iter_end) {
-    if (index_iter->second->ref_ <= 0) {
-      index_iter = indexed_strings_.erase(index_iter);
-    } else {
-      ++index_iter;
-    }
-  }
-
   auto end_iter2 =
       std::remove_if(strings_.begin(), strings_.end(),
                      [](const std::unique_ptr<Entry>& entry) -> bool { return entry->ref_ <= 0; });
@@ -292,6 +332,11 @@ void StringPool::Prune() {
   strings_.erase(end_iter2, strings_.end());
   styles_.erase(end_iter3, styles_.end());
 
+  // Removing entries would break the probe sequences of others, so index the remaining ones anew.
+  if (!index_.empty()) {
+    RebuildIndex(index_.size());
+  }
+
   ReAssignIndices();
 }
 
@@ -367,7 +412,16 @@ const std::string kStringTooLarge = "STRING_TOO_LARGE";
 static bool EncodeString(const std::string& str, const bool utf8, BigBuffer* out,
                          IDiagnostics* diag) {
   if (utf8) {
-    const std::string& encoded = util::Utf8ToModifiedUtf8(str);
+    // Only strings with 4 byte code points need converting to Modified UTF-8, so write the others
+    // straight from the pool instead of copying them first.
+    const bool needs_modified_utf8 = std::any_of(str.begin(), str.end(), [](char c) -> bool {
+      return (static_cast<uint8_t>(c) >> 4) == 0xF;
+    });
+    std::string modified_utf8;
+    if (needs_modified_utf8) {
+      modified_utf8 = util::Utf8ToModifiedUtf8(str);
+    }
+    const std::string& encoded = needs_modified_utf8 ? modified_utf8 : str;
     const ssize_t utf16_length = utf8_to_utf16_length(
         reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size());
     CHECK(utf16_length >= 0);
@@ -397,8 +451,9 @@ static bool EncodeString(const std::string& str, const bool utf8, BigBuffer* out
     strncpy(data, encoded.data(), encoded.size());
 
   } else {
-    const std::u16string encoded = util::Utf8ToUtf16(str);
-    const ssize_t utf16_length = encoded.size();
+    // Invalid UTF-8 is written as an empty string.
+    const ssize_t utf16_length = std::max<ssize_t>(
+        utf8_to_utf16_length(reinterpret_cast<const uint8_t*>(str.data()), str.size()), 0);
 
     // Make sure the length to be encoded does not exceed the maximum possible
     // length that can be encoded
@@ -412,20 +467,19 @@ static bool EncodeString(const std::string& str, const bool utf8, BigBuffer* out
 
     // Total number of 16-bit words to write.
     const size_t total_size = EncodedLengthUnits<char16_t>(utf16_length)
-        + encoded.size() + 1;
+        + utf16_length + 1;
 
     char16_t* data = out->NextBlock<char16_t>(total_size);
 
     // Encode the actual UTF16 string length.
     data = EncodeLength(data, utf16_length);
-    const size_t byte_length = encoded.size() * sizeof(char16_t);
-
-    // NOTE: For some reason, strncpy16(data, entry->value.data(),
-    // entry->value.size()) truncates the string.
-    memcpy(data, encoded.data(), byte_length);
 
-    // The null-terminating character is already here due to the block of data
-    // being set to 0s on allocation.
+    // Convert straight into the block rather than through a temporary std::u16string. The
+    // null-terminating character is written too.
+    if (utf16_length > 0) {
+      utf8_to_utf16(reinterpret_cast<const uint8_t*>(str.data()), str.size(), data,
+                    utf16_length + 1);
+    }
   }
 
   return true;
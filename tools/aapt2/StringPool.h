@@ -20,7 +20,6 @@
 #include <functional>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "android-base/macros.h"
@@ -135,6 +134,9 @@ class StringPool {
     size_t index_;
     int ref_;
     const StringPool* pool_;
+
+    // The hash of value, kept so that the index can grow without hashing every string again.
+    size_t hash_;
   };
 
   struct Span {
@@ -217,9 +219,24 @@ class StringPool {
   Ref MakeRefImpl(const android::StringPiece& str, const Context& context, bool unique);
   void ReAssignIndices();
 
+  // Returns the string with the given value, hash and priority, or nullptr if there is none.
+  Entry* FindIndexed(const android::StringPiece& str, size_t hash, uint32_t priority) const;
+
+  // Makes room in the index for string_count strings in total, rebuilding it if it grows.
+  void ReserveIndex(size_t string_count);
+
+  // Adds entry to the index, which must have room for it.
+  void AddToIndex(Entry* entry);
+
+  // Rebuilds the index from strings_ with the given number of slots, a power of two.
+  void RebuildIndex(size_t slot_count);
+
   std::vector<std::unique_ptr<Entry>> strings_;
   std::vector<std::unique_ptr<StyleEntry>> styles_;
-  std::unordered_multimap<android::StringPiece, Entry*> indexed_strings_;
+
+  // An open addressing hash table of every entry of strings_, probed linearly. Empty slots are
+  // nullptr. Strings equal in value but not in priority have a slot each.
+  std::vector<Entry*> index_;
 };
 
 }  // namespace aapt
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StringPool.h"
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "Diagnostics.h"
+#include "util/BigBuffer.h"
+
+namespace aapt {
+
+// Returns count strings shaped like resource names and values, each repeated `repeat` times.
+static std::vector<std::string> MakeStrings(size_t count, size_t repeat) {
+  std::vector<std::string> strings;
+  strings.reserve(count * repeat);
+  for (size_t r = 0; r < repeat; r++) {
+    for (size_t i = 0; i < count; i++) {
+      strings.push_back("res/layout/activity_main_" + std::to_string(i) + ".xml");
+    }
+  }
+  return strings;
+}
+
+// Adds strings where every unique one is referenced several times, as with the values of a large
+// table.
+static void BM_StringPoolMakeRef(benchmark::State& state) {
+  const std::vector<std::string> strings = MakeStrings(state.range(0), 4);
+  for (auto _ : state) {
+    StringPool pool;
+    std::vector<StringPool::Ref> refs;
+    refs.reserve(strings.size());
+    for (const std::string& str : strings) {
+      refs.push_back(pool.MakeRef(str));
+    }
+    benchmark::DoNotOptimize(refs.data());
+  }
+  state.SetItemsProcessed(state.iterations() * strings.size());
+}
+BENCHMARK(BM_StringPoolMakeRef)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+// Drops the unreferenced half of a pool, then looks up every string again.
+static void BM_StringPoolPrune(benchmark::State& state) {
+  const std::vector<std::string> strings = MakeStrings(state.range(0), 1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    StringPool pool;
+    std::vector<StringPool::Ref> refs;
+    for (size_t i = 0; i < strings.size(); i++) {
+      StringPool::Ref ref = pool.MakeRef(strings[i]);
+      if (i % 2 == 0) {
+        refs.push_back(ref);
+      }
+    }
+    state.ResumeTiming();
+
+    pool.Prune();
+    for (const std::string& str : strings) {
+      benchmark::DoNotOptimize(pool.MakeRef(str));
+    }
+  }
+}
+BENCHMARK(BM_StringPoolPrune)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_StringPoolFlatten(benchmark::State& state, bool utf8) {
+  const std::vector<std::string> strings = MakeStrings(state.range(0), 1);
+  StringPool pool;
+  std::vector<StringPool::Ref> refs;
+  for (const std::string& str : strings) {
+    refs.push_back(pool.MakeRef(str));
+  }
+
+  StdErrDiagnostics diag;
+  for (auto _ : state) {
+    BigBuffer buffer(1024);
+    if (utf8) {
+      StringPool::FlattenUtf8(&buffer, pool, &diag);
+    } else {
+      StringPool::FlattenUtf16(&buffer, pool, &diag);
+    }
+    benchmark::DoNotOptimize(buffer.size());
+  }
+  state.SetItemsProcessed(state.iterations() * strings.size());
+}
+BENCHMARK_CAPTURE(BM_StringPoolFlatten, utf8, true)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_CAPTURE(BM_StringPoolFlatten, utf16, false)->Arg(1 << 10)->Arg(1 << 16);
+
+}  // namespace aapt
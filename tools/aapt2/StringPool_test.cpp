@@ -111,6 +111,32 @@ TEST(StringPoolTest, PruneStringsWithNoReferences) {
   EXPECT_THAT(pool.size(), Eq(1u));
 }
 
+TEST(StringPoolTest, DedupeManyStringsAfterPruneAndMerge) {
+  StringPool pool;
+  std::vector<StringPool::Ref> refs;
+  for (size_t i = 0; i < 1000; i++) {
+    StringPool::Ref ref = pool.MakeRef(std::to_string(i));
+    if (i % 2 == 0) {
+      refs.push_back(ref);
+    }
+  }
+  EXPECT_THAT(pool.size(), Eq(1000u));
+
+  pool.Prune();
+  EXPECT_THAT(pool.size(), Eq(500u));
+  for (size_t i = 0; i < 1000; i += 2) {
+    EXPECT_THAT(pool.MakeRef(std::to_string(i)).index(), Eq(i / 2));
+  }
+  EXPECT_THAT(pool.size(), Eq(500u));
+
+  StringPool other;
+  StringPool::Ref other_ref = other.MakeRef("other");
+  pool.Merge(std::move(other));
+  EXPECT_THAT(pool.size(), Eq(501u));
+  EXPECT_THAT(pool.MakeRef("other").index(), Eq(500u));
+  EXPECT_THAT(pool.MakeRef("998").index(), Eq(499u));
+}
+
 TEST(StringPoolTest, SortAndMaintainIndexesInStringReferences) {
   StringPool pool;
 
@@ -17,7 +17,12 @@
 #include "Compile.h"
 
 #include <dirent.h>
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "android-base/errors.h"
 #include "android-base/file.h"
@@ -30,10 +35,12 @@
 #include "Diagnostics.h"
 #include "ResourceParser.h"
 #include "ResourceTable.h"
+#include "ResourceUtils.h"
 #include "cmd/Util.h"
 #include "compile/IdAssigner.h"
 #include "compile/InlineXmlFormatParser.h"
 #include "compile/Png.h"
+#include "compile/PngCrunchCache.h"
 #include "compile/PseudolocaleGenerator.h"
 #include "compile/XmlIdCollector.h"
 #include "format/Archive.h"
@@ -472,9 +479,28 @@ static bool CompilePng(IAaptContext* context, const CompileOptions& options,
     BigBuffer crunched_png_buffer(4096);
     io::BigBufferOutputStream crunched_png_buffer_out(&crunched_png_buffer);
 
+    // Crunching depends on nothing but the PNG, whether it is a 9-patch, and the cruncher itself.
+    const StringPiece content(reinterpret_cast<const char*>(data->data()), data->size());
+    const std::string crunch_options =
+        util::GetToolFingerprint() + (path_data.extension == "9.png" ? " 9-patch" : " png");
+    std::unique_ptr<PngCrunchCache> png_cache;
+    if (options.png_cache_dir) {
+      png_cache = util::make_unique<PngCrunchCache>(options.png_cache_dir.value());
+      std::string cached_png;
+      if (png_cache->Find(content, crunch_options, &cached_png)) {
+        if (context->IsVerbose()) {
+          context->GetDiagnostics()->Note(DiagMessage(path_data.source)
+                                          << "reusing crunched PNG from the cache");
+        }
+        memcpy(buffer.NextBlock<char>(cached_png.size()), cached_png.data(), cached_png.size());
+        io::BigBufferInputStream buffer_in(&buffer);
+        return WriteHeaderAndDataToWriter(output_path, res_file, &buffer_in, writer,
+                                          context->GetDiagnostics());
+      }
+    }
+
     // Ensure that we only keep the chunks we care about if we end up
     // using the original PNG instead of the crunched one.
-    const StringPiece content(reinterpret_cast<const char*>(data->data()), data->size());
     PngChunkFilter png_chunk_filter(content);
     std::unique_ptr<Image> image = ReadPng(context, path_data.source, &png_chunk_filter);
     if (!image) {
@@ -534,6 +560,10 @@ static bool CompilePng(IAaptContext* context, const CompileOptions& options,
       buffer.AppendBuffer(std::move(filtered_png_buffer));
     }
 
+    if (png_cache != nullptr) {
+      png_cache->Store(content, crunch_options, buffer, context->GetDiagnostics());
+    }
+
     if (context->IsVerbose()) {
       // For debugging only, use the legacy PNG cruncher and compare the resulting file sizes.
       // This will help catch exotic cases where the new code may generate larger PNGs.
@@ -637,81 +667,288 @@ class CompileContext : public IAaptContext {
   bool verbose_ = false;
 };
 
-int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter* output_writer,
-             CompileOptions& options) {
-  TRACE_CALL();
-  bool error = false;
+// The size of an input file for the trace, or 0 for files within a zip or when not tracing.
+static uint64_t GetInputSize(const std::string& path, const CompileOptions& options) {
+  struct stat sb;
+  if (!options.trace_input_sizes || options.res_zip || stat(path.c_str(), &sb) != 0) {
+    return 0;
+  }
+  return sb.st_size;
+}
 
-  // Iterate over the input files in a stable, platform-independent manner
-  auto file_iterator  = inputs->Iterator();
-  while (file_iterator->HasNext()) {
-    auto file = file_iterator->Next();
-    std::string path = file->GetSource().path;
+// Compiles one file of the input collection. Returns false if it failed.
+static bool CompileInput(IAaptContext* context, io::IFileCollection* inputs, io::IFile* file,
+                         IArchiveWriter* output_writer, const CompileOptions& options) {
+  std::string path = file->GetSource().path;
+
+  // Skip hidden input files
+  if (file::IsHidden(path)) {
+    return true;
+  }
+
+  if (!options.res_zip && !IsValidFile(context, path)) {
+    return false;
+  }
+
+  // Extract resource type information from the full path
+  std::string err_str;
+  ResourcePathData path_data;
+  if (auto maybe_path_data = ExtractResourcePathData(
+      path, inputs->GetDirSeparator(), &err_str, options)) {
+    path_data = maybe_path_data.value();
+  } else {
+    context->GetDiagnostics()->Error(DiagMessage(file->GetSource()) << err_str);
+    return false;
+  }
 
-    // Skip hidden input files
-    if (file::IsHidden(path)) {
-      continue;
+  // Determine how to compile the file based on its type.
+  auto compile_func = &CompileFile;
+  if (path_data.resource_dir == "values" && path_data.extension == "xml") {
+    compile_func = &CompileTable;
+    // We use a different extension (not necessary anymore, but avoids altering the existing
+    // build system logic).
+    path_data.extension = "arsc";
+
+  } else if (const ResourceType* type = ParseResourceType(path_data.resource_dir)) {
+    if (*type != ResourceType::kRaw) {
+      if (*type == ResourceType::kXml || path_data.extension == "xml") {
+        compile_func = &CompileXml;
+      } else if ((!options.no_png_crunch && path_data.extension == "png")
+                 || path_data.extension == "9.png") {
+        compile_func = &CompilePng;
+      }
     }
+  } else {
+    context->GetDiagnostics()->Error(DiagMessage()
+        << "invalid file path '" << path_data.source << "'");
+    return false;
+  }
 
-    if (!options.res_zip && !IsValidFile(context, path)) {
-      error = true;
-      continue;
+  // Treat periods as a reserved character that should not be present in a file name
+  // Legacy support for AAPT which did not reserve periods
+  if (compile_func != &CompileFile && !options.legacy_mode
+      && std::count(path_data.name.begin(), path_data.name.end(), '.') != 0) {
+    context->GetDiagnostics()->Error(DiagMessage(file->GetSource())
+                                                  << "file name cannot contain '.' other than for"
+                                                  << " specifying the extension");
+    return false;
+  }
+
+  const std::string out_path = BuildIntermediateContainerFilename(path_data);
+  FileTrace trace("Compile", path, path_data.extension, GetInputSize(path, options));
+  if (!compile_func(context, options, path_data, file, output_writer, out_path)) {
+    context->GetDiagnostics()->Error(DiagMessage(file->GetSource()) << "file failed to compile");
+    return false;
+  }
+  return true;
+}
+
+// Keeps the entries a file compiled on a worker thread writes, so that they can be written to the
+// archive in the order, and with the bytes, a serial compile would write them.
+class BufferedArchiveWriter : public IArchiveWriter {
+ public:
+  BufferedArchiveWriter() = default;
+
+  bool WriteFile(const StringPiece& path, uint32_t flags, io::InputStream* in) override {
+    entries_.emplace_back(path, flags, /* whole_file */ true);
+    const void* data = nullptr;
+    size_t len = 0;
+    while (in->Next(&data, &len)) {
+      Append(data, len);
     }
+    if (in->HadError()) {
+      error_ = in->GetError();
+      return false;
+    }
+    entries_.back().finished = true;
+    return true;
+  }
 
-    // Extract resource type information from the full path
-    std::string err_str;
-    ResourcePathData path_data;
-    if (auto maybe_path_data = ExtractResourcePathData(
-        path, inputs->GetDirSeparator(), &err_str, options)) {
-      path_data = maybe_path_data.value();
-    } else {
-      context->GetDiagnostics()->Error(DiagMessage(file->GetSource()) << err_str);
-      error = true;
-      continue;
-    }
-
-    // Determine how to compile the file based on its type.
-    auto compile_func = &CompileFile;
-    if (path_data.resource_dir == "values" && path_data.extension == "xml") {
-      compile_func = &CompileTable;
-      // We use a different extension (not necessary anymore, but avoids altering the existing
-      // build system logic).
-      path_data.extension = "arsc";
-
-    } else if (const ResourceType* type = ParseResourceType(path_data.resource_dir)) {
-      if (*type != ResourceType::kRaw) {
-        if (*type == ResourceType::kXml || path_data.extension == "xml") {
-          compile_func = &CompileXml;
-        } else if ((!options.no_png_crunch && path_data.extension == "png")
-                   || path_data.extension == "9.png") {
-          compile_func = &CompilePng;
+  bool StartEntry(const StringPiece& path, uint32_t flags) override {
+    entries_.emplace_back(path, flags, /* whole_file */ false);
+    return true;
+  }
+
+  bool Write(const void* data, int len) override {
+    if (entries_.empty() || entries_.back().finished) {
+      error_ = "no entry started";
+      return false;
+    }
+    Append(data, len);
+    return true;
+  }
+
+  bool FinishEntry() override {
+    if (entries_.empty() || entries_.back().finished) {
+      error_ = "no entry started";
+      return false;
+    }
+    entries_.back().finished = true;
+    return true;
+  }
+
+  bool HadError() const override {
+    return !error_.empty();
+  }
+
+  std::string GetError() const override {
+    return error_;
+  }
+
+  // Writes the entries to writer, including one that was started but never finished.
+  bool Replay(IArchiveWriter* writer, IDiagnostics* diag) {
+    for (const Entry& entry : entries_) {
+      bool success;
+      if (entry.whole_file) {
+        io::BigBufferInputStream in(&entry.data);
+        success = writer->WriteFile(entry.path, entry.flags, &in);
+      } else {
+        success = writer->StartEntry(entry.path, entry.flags);
+        for (auto iter = entry.data.begin(); success && iter != entry.data.end(); ++iter) {
+          success = writer->Write(iter->buffer.get(), static_cast<int>(iter->size));
+        }
+        if (success && entry.finished) {
+          success = writer->FinishEntry();
         }
       }
-    } else {
-      context->GetDiagnostics()->Error(DiagMessage()
-          << "invalid file path '" << path_data.source << "'");
-      error = true;
-      continue;
+      if (!success) {
+        diag->Error(DiagMessage(entry.path) << "failed to write: " << writer->GetError());
+        return false;
+      }
     }
+    return true;
+  }
 
-    // Treat periods as a reserved character that should not be present in a file name
-    // Legacy support for AAPT which did not reserve periods
-    if (compile_func != &CompileFile && !options.legacy_mode
-        && std::count(path_data.name.begin(), path_data.name.end(), '.') != 0) {
-      error = true;
-      context->GetDiagnostics()->Error(DiagMessage(file->GetSource())
-                                                    << "file name cannot contain '.' other than for"
-                                                    << " specifying the extension");
-      continue;
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BufferedArchiveWriter);
+
+  struct Entry {
+    Entry(const StringPiece& path, uint32_t flags, bool whole_file)
+        : path(path.to_string()), flags(flags), whole_file(whole_file) {
+    }
+
+    std::string path;
+    uint32_t flags;
+    bool whole_file;
+    bool finished = false;
+    BigBuffer data = BigBuffer(4096);
+  };
+
+  void Append(const void* data, size_t len) {
+    if (len > 0) {
+      memcpy(entries_.back().data.NextBlock<uint8_t>(len), data, len);
+    }
+  }
+
+  std::vector<Entry> entries_;
+  std::string error_;
+};
+
+// Compiles the files on options.jobs worker threads. Each file is compiled into its own buffers,
+// which are handed to the real diagnostics and archive in input order, so that the output is the
+// same as a serial compile's. Returns false if any file failed.
+static bool CompileConcurrently(IAaptContext* context, io::IFileCollection* inputs,
+                                const std::vector<io::IFile*>& files,
+                                IArchiveWriter* output_writer, const CompileOptions& options) {
+  struct Task {
+    BufferedDiagnostics diagnostics;
+    BufferedArchiveWriter writer;
+    bool success = false;
+    bool done = false;
+  };
+
+  // Bounds how far the workers get ahead of the files written out, and so the memory held by the
+  // buffers of compiled files.
+  const size_t max_pending = options.jobs * 4;
+
+  std::mutex lock;
+  std::condition_variable cond;
+  std::vector<std::unique_ptr<Task>> tasks(files.size());
+  size_t next_task = 0;
+  size_t next_to_write = 0;
+
+  auto worker = [&]() {
+    while (true) {
+      size_t index;
+      Task* task;
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [&]() {
+          return next_task == files.size() || next_task < next_to_write + max_pending;
+        });
+        if (next_task == files.size()) {
+          return;
+        }
+        index = next_task++;
+        tasks[index] = util::make_unique<Task>();
+        task = tasks[index].get();
+      }
+
+      TaskContext task_context(context, &task->diagnostics);
+      const bool success =
+          CompileInput(&task_context, inputs, files[index], &task->writer, options);
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        task->success = success;
+        task->done = true;
+      }
+      cond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < options.jobs; i++) {
+    threads.emplace_back(worker);
+  }
+
+  bool error = false;
+  for (size_t i = 0; i < files.size(); i++) {
+    std::unique_ptr<Task> task;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      cond.wait(guard, [&]() { return tasks[i] && tasks[i]->done; });
+      task = std::move(tasks[i]);
+      next_to_write = i + 1;
     }
+    cond.notify_all();
 
-    const std::string out_path = BuildIntermediateContainerFilename(path_data);
-    if (!compile_func(context, options, path_data, file, output_writer, out_path)) {
-      context->GetDiagnostics()->Error(DiagMessage(file->GetSource()) << "file failed to compile");
+    task->diagnostics.Replay(context->GetDiagnostics());
+    if (!task->writer.Replay(output_writer, context->GetDiagnostics()) || !task->success) {
       error = true;
     }
   }
 
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return !error;
+}
+
+int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter* output_writer,
+             CompileOptions& options) {
+  TRACE_CALL();
+  bool error = false;
+
+  // Iterate over the input files in a stable, platform-independent manner
+  std::vector<io::IFile*> files;
+  auto file_iterator  = inputs->Iterator();
+  while (file_iterator->HasNext()) {
+    files.push_back(file_iterator->Next());
+  }
+
+  // Files in a zip are all read through the one archive handle, and every file writes its text
+  // symbols to the same path, so these are only compiled one at a time.
+  if (options.jobs > 1 && files.size() > 1 && !options.res_zip &&
+      !options.generate_text_symbols_path) {
+    error = !CompileConcurrently(context, inputs, files, output_writer, options);
+  } else {
+    for (io::IFile* file : files) {
+      if (!CompileInput(context, inputs, file, output_writer, options)) {
+        error = true;
+      }
+    }
+  }
+
   return error ? 1 : 0;
 }
 
@@ -719,6 +956,24 @@ int CompileCommand::Action(const std::vector<std::string>& args) {
   TRACE_FLUSH(trace_folder_? trace_folder_.value() : "", "CompileCommand::Action");
   CompileContext context(diagnostic_);
   context.SetVerbose(options_.verbose);
+  options_.trace_input_sizes = trace_folder_.has_value();
+
+  if (jobs_) {
+    std::optional<uint32_t> maybe_jobs = ResourceUtils::ParseInt(jobs_.value());
+    if (!maybe_jobs || maybe_jobs.value() == 0) {
+      context.GetDiagnostics()->Error(DiagMessage()
+                                      << "--jobs must be a positive integer, got '"
+                                      << jobs_.value() << "'");
+      return 1;
+    }
+    options_.jobs = maybe_jobs.value();
+  }
+
+  if (options_.png_cache_dir && !file::mkdirs(options_.png_cache_dir.value())) {
+    context.GetDiagnostics()->Error(DiagMessage() << "failed to create directory '"
+                                                  << options_.png_cache_dir.value() << "'");
+    return 1;
+  }
 
   if (visibility_) {
     if (visibility_.value() == "public") {
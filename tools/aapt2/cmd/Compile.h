@@ -42,6 +42,12 @@ struct CompileOptions {
   // See comments on aapt::ResourceParserOptions.
   bool preserve_visibility_of_styleables = false;
   bool verbose = false;
+  // The number of files compiled at the same time. Ignored for --zip and --output-text-symbols.
+  size_t jobs = 1;
+  // Directory in which crunched PNGs are kept for later compiles, possibly on other machines.
+  std::optional<std::string> png_cache_dir;
+  // Whether the trace is written out, and so whether the input sizes are worth looking up.
+  bool trace_input_sizes = false;
 };
 
 /** Parses flags and compiles resources to be used in linking.  */
@@ -71,6 +77,15 @@ class CompileCommand : public Command {
         "Sets the visibility of the compiled resources to the specified\n"
             "level. Accepted levels: public, private, default", &visibility_);
     AddOptionalSwitch("-v", "Enables verbose logging", &options_.verbose);
+    AddOptionalFlag("--jobs",
+        "Number of files to compile in parallel. The output is the same as\n"
+            "compiling them one at a time. Ignored with --zip and\n"
+            "--output-text-symbols. Defaults to 1.", &jobs_);
+    AddOptionalFlag("--png-cache",
+        "Directory in which crunched PNGs are kept, and looked up by their contents\n"
+            "instead of crunching them again. It can be shared by several compiles,\n"
+            "and between machines running the same aapt2.",
+        &options_.png_cache_dir, Command::kPath);
     AddOptionalFlag("--trace-folder", "Generate systrace json trace fragment to specified folder.",
                     &trace_folder_);
     AddOptionalFlag("--source-path",
@@ -85,6 +100,7 @@ class CompileCommand : public Command {
   CompileOptions options_;
   std::optional<std::string> visibility_;
   std::optional<std::string> trace_folder_;
+  std::optional<std::string> jobs_;
 };
 
 int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter* output_writer,
@@ -168,6 +168,39 @@ TEST_F(CompilerTest, ZipInput) {
   ASSERT_EQ(::android::base::utf8::unlink(kOutputFlata.c_str()), 0);
 }
 
+TEST_F(CompilerTest, DirInputWithJobs) {
+  StdErrDiagnostics diag;
+  const std::string kResDir = BuildPath({android::base::Dirname(android::base::GetExecutablePath()),
+                                         "integration-tests", "CompileTest", "DirInput", "res"});
+  const std::string kSerialFlata = BuildPath({testing::TempDir(), "serial.flata"});
+  const std::string kParallelFlata = BuildPath({testing::TempDir(), "parallel.flata"});
+  ::android::base::utf8::unlink(kSerialFlata.c_str());
+  ::android::base::utf8::unlink(kParallelFlata.c_str());
+
+  ASSERT_EQ(CompileCommand(&diag).Execute({"--dir", kResDir, "-o", kSerialFlata}, &std::cerr), 0);
+  ASSERT_EQ(CompileCommand(&diag).Execute({"--dir", kResDir, "-o", kParallelFlata, "--jobs", "4"},
+                                          &std::cerr),
+            0);
+
+  // Compiling in parallel must not change a single byte of the output.
+  std::string serial;
+  std::string parallel;
+  ASSERT_TRUE(android::base::ReadFileToString(kSerialFlata, &serial));
+  ASSERT_TRUE(android::base::ReadFileToString(kParallelFlata, &parallel));
+  EXPECT_FALSE(serial.empty());
+  EXPECT_EQ(serial, parallel);
+
+  ASSERT_EQ(::android::base::utf8::unlink(kSerialFlata.c_str()), 0);
+  ASSERT_EQ(::android::base::utf8::unlink(kParallelFlata.c_str()), 0);
+}
+
+TEST_F(CompilerTest, InvalidJobs) {
+  StdErrDiagnostics diag;
+  const std::string kOutputFlata = BuildPath({testing::TempDir(), "compiled.flata"});
+  ASSERT_NE(CompileCommand(&diag).Execute({"--jobs", "0", "-o", kOutputFlata}, &std::cerr), 0);
+  ASSERT_NE(CompileCommand(&diag).Execute({"--jobs", "many", "-o", kOutputFlata}, &std::cerr), 0);
+}
+
 /*
  * This tests the "protection" from pseudo-translation of
  * non-translatable files (starting with 'donotranslate')
@@ -157,10 +157,12 @@ class ProtoApkSerializer : public IApkSerializer {
   }
 
   bool SerializeTable(ResourceTable* table, IArchiveWriter* writer) override {
-    pb::ResourceTable pb_table;
-    SerializeTableToPb(*table, &pb_table, context_->GetDiagnostics());
-    return io::CopyProtoToArchive(context_, &pb_table, kProtoResourceTablePath,
-                                  ArchiveEntry::kCompress, writer);
+    return io::CopyProtoStreamToArchive(
+        context_,
+        [&](::google::protobuf::io::ZeroCopyOutputStream* out) {
+          return SerializeTableToPb(*table, out, context_->GetDiagnostics());
+        },
+        kProtoResourceTablePath, ArchiveEntry::kCompress, writer);
   }
 
   bool SerializeFile(FileReference* file, IArchiveWriter* writer) override {
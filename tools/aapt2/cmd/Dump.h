@@ -64,6 +64,14 @@ class DumpApkCommand : public Command {
   /** Perform the dump operation on the apk. */
   virtual int Dump(LoadedApk* apk) = 0;
 
+  /**
+   * Whether Dump() uses the resource table of the apk. Parsing the table is most of the cost of
+   * loading an apk, so commands that only read the manifest or files of the apk skip it.
+   */
+  virtual bool NeedsResourceTable() const {
+    return true;
+  }
+
   int Action(const std::vector<std::string>& args) final {
     if (args.size() < 1) {
       diag_->Error(DiagMessage() << "No dump apk specified.");
@@ -72,7 +80,7 @@ class DumpApkCommand : public Command {
 
     bool error = false;
     for (auto apk : args) {
-      auto loaded_apk = LoadedApk::LoadApkFromPath(apk, diag_);
+      auto loaded_apk = LoadedApk::LoadApkFromPath(apk, diag_, NeedsResourceTable());
       if (!loaded_apk) {
         error = true;
         continue;
@@ -157,6 +165,10 @@ class DumpPackageNameCommand : public DumpApkCommand {
   }
 
   int Dump(LoadedApk* apk) override;
+
+  bool NeedsResourceTable() const override {
+    return false;
+  }
 };
 
 class DumpPermissionsCommand : public DumpApkCommand {
@@ -225,6 +237,10 @@ class DumpXmlStringsCommand : public DumpApkCommand {
 
   int Dump(LoadedApk* apk) override;
 
+  bool NeedsResourceTable() const override {
+    return false;
+  }
+
  private:
   std::vector<std::string> files_;
 };
@@ -236,6 +252,11 @@ class DumpChunks : public DumpApkCommand {
   }
 
   int Dump(LoadedApk* apk) override;
+
+  // The chunks are read straight from resources.arsc.
+  bool NeedsResourceTable() const override {
+    return false;
+  }
 };
 
 /** Prints the tree of a compiled xml in an APK. */
@@ -249,6 +270,10 @@ class DumpXmlTreeCommand : public DumpApkCommand {
 
   int Dump(LoadedApk* apk) override;
 
+  bool NeedsResourceTable() const override {
+    return false;
+  }
+
  private:
   std::vector<std::string> files_;
 };
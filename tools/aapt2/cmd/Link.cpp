@@ -20,7 +20,10 @@
 #include <cinttypes>
 
 #include <algorithm>
+#include <atomic>
 #include <queue>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -63,6 +66,7 @@
 #include "link/ResourceExcluder.h"
 #include "link/TableMerger.h"
 #include "link/XmlCompatVersioner.h"
+#include "link/XmlLinkCache.h"
 #include "optimize/ResourceDeduper.h"
 #include "optimize/VersionCollapser.h"
 #include "process/IResourceTableConsumer.h"
@@ -238,24 +242,33 @@ class FeatureSplitSymbolTableDelegate : public DefaultSymbolTableDelegate {
   IAaptContext* context_;
 };
 
-static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res,
-                       const StringPiece& path, bool keep_raw_values, bool utf16,
-                       OutputFormat format, IArchiveWriter* writer) {
-  TRACE_CALL();
+static void NoteWritingXml(IAaptContext* context, const StringPiece& path, bool keep_raw_values) {
   if (context->IsVerbose()) {
     context->GetDiagnostics()->Note(DiagMessage(path) << "writing to archive (keep_raw_values="
                                                       << (keep_raw_values ? "true" : "false")
                                                       << ")");
   }
+}
+
+static bool FlattenXmlToBuffer(IAaptContext* context, const xml::XmlResource& xml_res,
+                               bool keep_raw_values, bool utf16, BigBuffer* buffer) {
+  XmlFlattenerOptions options = {};
+  options.keep_raw_values = keep_raw_values;
+  options.use_utf16 = utf16;
+  XmlFlattener flattener(buffer, options);
+  return flattener.Consume(context, &xml_res);
+}
+
+static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res,
+                       const StringPiece& path, bool keep_raw_values, bool utf16,
+                       OutputFormat format, IArchiveWriter* writer) {
+  TRACE_CALL();
+  NoteWritingXml(context, path, keep_raw_values);
 
   switch (format) {
     case OutputFormat::kApk: {
       BigBuffer buffer(1024);
-      XmlFlattenerOptions options = {};
-      options.keep_raw_values = keep_raw_values;
-      options.use_utf16 = utf16;
-      XmlFlattener flattener(&buffer, options);
-      if (!flattener.Consume(context, &xml_res)) {
+      if (!FlattenXmlToBuffer(context, xml_res, keep_raw_values, utf16, &buffer)) {
         return false;
       }
 
@@ -300,6 +313,14 @@ struct ResourceFileFlattenerOptions {
   OutputFormat output_format = OutputFormat::kApk;
   std::unordered_set<std::string> extensions_to_not_compress;
   std::optional<std::regex> regex_to_not_compress;
+
+  // The number of threads the binary XML files of a type are flattened on.
+  size_t jobs = 1;
+
+  // Where the binary XML files of earlier links are kept, if anywhere, and the digest of what
+  // linking XML depends on for the table being flattened.
+  XmlLinkCache* xml_cache = nullptr;
+  std::string xml_cache_link_digest;
 };
 
 // A sampling of public framework resource IDs.
@@ -366,11 +387,51 @@ class ResourceFileFlattener {
 
     // The destination to write this file to.
     std::string dst_path;
+
+    // The digest of the compiled XML, if its outputs can be kept in the XML cache.
+    std::string xml_digest;
+  };
+
+  // A file of a type flattened on worker threads, or kept in the XML cache, held until the whole
+  // type is flattened so that the files are still written to the archive in order.
+  struct PendingFile {
+    // The file to copy as-is, if not an XML file.
+    io::IFile* file_to_copy = nullptr;
+
+    // The linked and versioned XML to flatten. Not set if the flattened XML came from the cache.
+    std::unique_ptr<xml::XmlResource> doc;
+
+    // The destination to write this file to.
+    std::string dst_path;
+
+    // The flattened XML, and what flattening it logged.
+    BigBuffer buffer = BigBuffer(1024);
+    BufferedDiagnostics diagnostics;
+    bool success = false;
+
+    // The flags to write the flattened XML with. Compression is dropped ahead of time for XML
+    // that doesn't deflate well, when there are worker threads to find that out.
+    uint32_t compression_flags = ArchiveEntry::kCompress;
+
+    // The key the flattened XML is kept in the XML cache under once written, if it is to be kept,
+    // and the sdkVersion of its config.
+    std::string cache_key;
+    uint16_t sdk_version = 0;
   };
 
   std::vector<std::unique_ptr<xml::XmlResource>> LinkAndVersionXmlFile(ResourceTable* table,
                                                                        FileOperation* file_op);
 
+  std::optional<std::string> AddVersionedXmlFile(ResourceTable* table, const ResourceFile& file,
+                                                 const ConfigDescription& from_config);
+
+  bool FindCachedXmlFile(ResourceTable* table, FileOperation* file_op,
+                         const std::string& cache_key,
+                         std::vector<std::unique_ptr<PendingFile>>* pending_files, bool* out_error);
+
+  bool FlattenAndWritePendingFiles(std::vector<std::unique_ptr<PendingFile>>* pending_files,
+                                   IArchiveWriter* archive_writer);
+
   ResourceFileFlattenerOptions options_;
   IAaptContext* context_;
   proguard::KeepSet* keep_set_;
@@ -513,6 +574,86 @@ ResourceFile::Type XmlFileTypeForOutputFormat(OutputFormat format) {
   return ResourceFile::Type::kUnknown;
 }
 
+// Adds file, versioned from the XML file of from_config, to the table. Returns the path to write
+// it to.
+std::optional<std::string> ResourceFileFlattener::AddVersionedXmlFile(
+    ResourceTable* table, const ResourceFile& file, const ConfigDescription& from_config) {
+  if (context_->IsVerbose()) {
+    context_->GetDiagnostics()->Note(DiagMessage(file.source)
+                                     << "auto-versioning resource from config '" << from_config
+                                     << "' -> '" << file.config << "'");
+  }
+
+  std::string dst_path = ResourceUtils::BuildResourceFileName(file, context_->GetNameMangler());
+
+  auto file_ref = util::make_unique<FileReference>(table->string_pool.MakeRef(dst_path));
+  file_ref->SetSource(file.source);
+
+  // Update the output format of this XML file.
+  file_ref->type = XmlFileTypeForOutputFormat(options_.output_format);
+  bool result = table->AddResource(NewResourceBuilder(file.name)
+                                       .SetValue(std::move(file_ref), file.config)
+                                       .SetAllowMangled(true)
+                                       .Build(),
+                                   context_->GetDiagnostics());
+  if (!result) {
+    return {};
+  }
+  return dst_path;
+}
+
+// Queues the flattened files kept in the XML cache for the XML of file_op, doing what linking and
+// versioning it would have done to the table and the proguard rules. Returns false if nothing is
+// kept for cache_key.
+bool ResourceFileFlattener::FindCachedXmlFile(
+    ResourceTable* table, FileOperation* file_op, const std::string& cache_key,
+    std::vector<std::unique_ptr<PendingFile>>* pending_files, bool* out_error) {
+  std::vector<XmlLinkCache::Output> outputs;
+  if (!options_.xml_cache->Find(cache_key, &outputs)) {
+    return false;
+  }
+
+  xml::XmlResource* doc = file_op->xml_to_flatten.get();
+  if (context_->IsVerbose()) {
+    context_->GetDiagnostics()->Note(DiagMessage(doc->file.source)
+                                     << "reusing linked " << doc->file.name << " from the cache");
+  }
+
+  // The rules are collected from the references as compiled, which linking doesn't change for
+  // cacheable XML.
+  if (options_.update_proguard_spec) {
+    xml::StripAndroidStudioAttributes(doc->root.get());
+    if (!proguard::CollectProguardRules(context_, doc, keep_set_)) {
+      *out_error = true;
+      return true;
+    }
+  }
+
+  for (XmlLinkCache::Output& output : outputs) {
+    auto pending_file = util::make_unique<PendingFile>();
+    pending_file->dst_path = file_op->dst_path;
+    if (output.sdk_version != file_op->config.sdkVersion) {
+      ResourceFile file = doc->file;
+      file.config.sdkVersion = output.sdk_version;
+      std::optional<std::string> versioned_path =
+          AddVersionedXmlFile(table, file, file_op->config);
+      if (!versioned_path) {
+        *out_error = true;
+        return true;
+      }
+      pending_file->dst_path = std::move(versioned_path.value());
+    }
+
+    if (!output.data.empty()) {
+      memcpy(pending_file->buffer.NextBlock<char>(output.data.size()), output.data.data(),
+             output.data.size());
+    }
+    pending_file->success = true;
+    pending_files->push_back(std::move(pending_file));
+  }
+  return true;
+}
+
 static auto kDrawableVersions = std::map<std::string, ApiVersion>{
     { "adaptive-icon" , SDK_O },
 };
@@ -524,6 +665,14 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
 
   proguard::CollectResourceReferences(context_, table, keep_set_);
 
+  // Linking and versioning touch the table and the symbol tables, so stay on this thread. Only
+  // flattening the resulting binary XML, which reads nothing but the XML itself, is handed to
+  // worker threads. Files are also held back while using the XML cache, which keeps what was
+  // flattened once it is written.
+  const bool defer_writes = options_.output_format == OutputFormat::kApk &&
+                            (options_.jobs > 1 || options_.xml_cache != nullptr);
+  std::vector<std::unique_ptr<PendingFile>> pending_files;
+
   for (auto& pkg : table->packages) {
     CHECK(!pkg->name.empty()) << "Packages must have names when being linked";
 
@@ -597,6 +746,12 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
             file_op.xml_to_flatten->file.config = config_value->config;
             file_op.xml_to_flatten->file.source = file_ref->GetSource();
             file_op.xml_to_flatten->file.name = ResourceName(pkg->name, type->type, entry->name);
+
+            if (defer_writes && options_.xml_cache != nullptr &&
+                XmlLinkCache::IsCacheable(*file_op.xml_to_flatten)) {
+              file_op.xml_digest = XmlLinkCache::Digest(
+                  StringPiece(reinterpret_cast<const char*>(data->data()), data->size()));
+            }
           }
 
           // NOTE(adamlesinski): Explicitly construct a StringPiece here, or
@@ -629,8 +784,26 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
             }
           }
 
-          std::vector<std::unique_ptr<xml::XmlResource>> versioned_docs =
-              LinkAndVersionXmlFile(table, &file_op);
+          std::string cache_key;
+          if (!file_op.xml_digest.empty()) {
+            const std::string extra = StringPrintf(
+                "%s\n%s\n%s\n%d", file_op.xml_to_flatten->file.name.to_string().c_str(),
+                config.to_string().c_str(), file_op.dst_path.c_str(),
+                static_cast<int>(FindNextApiVersionForConfig(file_op.entry, config)));
+            cache_key = XmlLinkCache::MakeKey(options_.xml_cache_link_digest, extra,
+                                              file_op.xml_digest);
+            bool cache_error = false;
+            if (FindCachedXmlFile(table, &file_op, cache_key, &pending_files, &cache_error)) {
+              error |= cache_error;
+              continue;
+            }
+          }
+
+          std::vector<std::unique_ptr<xml::XmlResource>> versioned_docs;
+          {
+            FileTrace trace("LinkXml", file_op.xml_to_flatten->file.source.path, "xml");
+            versioned_docs = LinkAndVersionXmlFile(table, &file_op);
+          }
           if (versioned_docs.empty()) {
             error = true;
             continue;
@@ -640,42 +813,138 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
             std::string dst_path = file_op.dst_path;
             if (doc->file.config != file_op.config) {
               // Only add the new versioned configurations.
-              if (context_->IsVerbose()) {
-                context_->GetDiagnostics()->Note(DiagMessage(doc->file.source)
-                                                 << "auto-versioning resource from config '"
-                                                 << config << "' -> '" << doc->file.config << "'");
-              }
-
-              const ResourceFile& file = doc->file;
-              dst_path = ResourceUtils::BuildResourceFileName(file, context_->GetNameMangler());
-
-              auto file_ref =
-                  util::make_unique<FileReference>(table->string_pool.MakeRef(dst_path));
-              file_ref->SetSource(doc->file.source);
-
-              // Update the output format of this XML file.
-              file_ref->type = XmlFileTypeForOutputFormat(options_.output_format);
-              bool result = table->AddResource(NewResourceBuilder(file.name)
-                                                   .SetValue(std::move(file_ref), file.config)
-                                                   .SetAllowMangled(true)
-                                                   .Build(),
-                                               context_->GetDiagnostics());
-              if (!result) {
+              std::optional<std::string> versioned_path =
+                  AddVersionedXmlFile(table, doc->file, config);
+              if (!versioned_path) {
                 return false;
               }
+              dst_path = std::move(versioned_path.value());
+            }
+
+            if (defer_writes) {
+              auto pending_file = util::make_unique<PendingFile>();
+              pending_file->cache_key = cache_key;
+              pending_file->sdk_version = doc->file.config.sdkVersion;
+              pending_file->doc = std::move(doc);
+              pending_file->dst_path = std::move(dst_path);
+              pending_files.push_back(std::move(pending_file));
+              continue;
             }
 
             error |= !FlattenXml(context_, *doc, dst_path, options_.keep_raw_values,
                                  false /*utf16*/, options_.output_format, archive_writer);
           }
+        } else if (defer_writes) {
+          auto pending_file = util::make_unique<PendingFile>();
+          pending_file->file_to_copy = file_op.file_to_copy;
+          pending_file->dst_path = file_op.dst_path;
+          pending_files.push_back(std::move(pending_file));
         } else {
           error |= !io::CopyFileToArchive(context_, file_op.file_to_copy, file_op.dst_path,
                                           GetCompressionFlags(file_op.dst_path, options_),
                                           archive_writer);
         }
       }
+
+      if (defer_writes) {
+        error |= !FlattenAndWritePendingFiles(&pending_files, archive_writer);
+      }
+    }
+  }
+  return !error;
+}
+
+bool ResourceFileFlattener::FlattenAndWritePendingFiles(
+    std::vector<std::unique_ptr<PendingFile>>* pending_files, IArchiveWriter* archive_writer) {
+  TRACE_CALL();
+  std::atomic<size_t> next_file(0);
+  auto worker = [&]() {
+    for (size_t i = next_file++; i < pending_files->size(); i = next_file++) {
+      PendingFile* pending_file = (*pending_files)[i].get();
+      if (pending_file->file_to_copy != nullptr) {
+        continue;
+      }
+      if (pending_file->doc) {
+        FileTrace trace("FlattenXml", pending_file->dst_path, "xml");
+        TaskContext task_context(context_, &pending_file->diagnostics);
+        NoteWritingXml(&task_context, pending_file->dst_path, options_.keep_raw_values);
+        pending_file->success = FlattenXmlToBuffer(&task_context, *pending_file->doc,
+                                                   options_.keep_raw_values, false /*utf16*/,
+                                                   &pending_file->buffer);
+        trace.SetSize(pending_file->buffer.size());
+      }
+
+      // The zip writer deflates on the writing thread, and only then finds out which files don't
+      // compress well enough and writes them again stored. Finding those here saves it that.
+      if (pending_file->success && options_.jobs > 1) {
+        io::BigBufferInputStream input_stream(&pending_file->buffer);
+        if (!IsWorthCompressing(&input_stream)) {
+          pending_file->compression_flags &= ~ArchiveEntry::kCompress;
+        }
+      }
+    }
+  };
+
+  if (options_.jobs > 1) {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::min(options_.jobs, pending_files->size()); i++) {
+      threads.emplace_back(worker);
     }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  } else {
+    worker();
   }
+
+  // The outputs of one XML file are next to each other. They are kept in the XML cache once all
+  // of them are written.
+  std::string cache_key;
+  std::vector<XmlLinkCache::Output> cache_outputs;
+  bool cache_outputs_complete = false;
+  auto store_cache_outputs = [&]() {
+    if (!cache_key.empty() && cache_outputs_complete) {
+      options_.xml_cache->Store(cache_key, cache_outputs, context_->GetDiagnostics());
+    }
+    cache_key.clear();
+    cache_outputs.clear();
+  };
+
+  bool error = false;
+  for (std::unique_ptr<PendingFile>& pending_file : *pending_files) {
+    if (pending_file->cache_key != cache_key) {
+      store_cache_outputs();
+      cache_key = pending_file->cache_key;
+      cache_outputs_complete = true;
+    }
+
+    if (pending_file->file_to_copy != nullptr) {
+      error |= !io::CopyFileToArchive(context_, pending_file->file_to_copy,
+                                      pending_file->dst_path,
+                                      GetCompressionFlags(pending_file->dst_path, options_),
+                                      archive_writer);
+      continue;
+    }
+
+    pending_file->diagnostics.Replay(context_->GetDiagnostics());
+    if (!pending_file->success) {
+      cache_outputs_complete = false;
+      error = true;
+      continue;
+    }
+    io::BigBufferInputStream input_stream(&pending_file->buffer);
+    if (!io::CopyInputStreamToArchive(context_, &input_stream, pending_file->dst_path,
+                                      pending_file->compression_flags, archive_writer)) {
+      cache_outputs_complete = false;
+      error = true;
+      continue;
+    }
+    if (!cache_key.empty()) {
+      cache_outputs.push_back({pending_file->sdk_version, pending_file->buffer.to_string()});
+    }
+  }
+  store_cache_outputs();
+  pending_files->clear();
   return !error;
 }
 
@@ -753,6 +1022,42 @@ static bool LoadStableIdMap(IDiagnostics* diag, const std::string& path,
   return true;
 }
 
+// Drops the comments of values. Only R.java, R.txt and the proto formats have a use for them, and
+// those of a large table take a lot of memory.
+class CommentDropper : public DescendingValueVisitor {
+ public:
+  using DescendingValueVisitor::Visit;
+
+  void VisitAny(Value* value) override {
+    value->SetComment(StringPiece());
+  }
+
+  void Visit(Attribute* value) override {
+    VisitAny(value);
+    VisitSubValues(value);
+  }
+
+  void Visit(Style* value) override {
+    VisitAny(value);
+    VisitSubValues(value);
+  }
+
+  void Visit(Array* value) override {
+    VisitAny(value);
+    VisitSubValues(value);
+  }
+
+  void Visit(Plural* value) override {
+    VisitAny(value);
+    VisitSubValues(value);
+  }
+
+  void Visit(Styleable* value) override {
+    VisitAny(value);
+    VisitSubValues(value);
+  }
+};
+
 class Linker {
  public:
   Linker(LinkContext* context, const LinkOptions& options)
@@ -831,12 +1136,17 @@ class Linker {
   // Pre-condition: context_->GetCompilationPackage() needs to be set.
   bool LoadSymbolsFromIncludePaths() {
     TRACE_NAME("LoadSymbolsFromIncludePaths: #" + std::to_string(options_.include_paths.size()));
-    auto asset_source = util::make_unique<AssetManagerSymbolSource>();
+    auto asset_source = util::make_unique<AssetManagerSymbolSource>(options_.apk_assets_cache);
     for (const std::string& path : options_.include_paths) {
       if (context_->IsVerbose()) {
         context_->GetDiagnostics()->Note(DiagMessage() << "including " << path);
       }
 
+      // Only APKs with a binary table are cached, so one found needs no further checks.
+      if (asset_source->AddCachedAssetPath(path)) {
+        continue;
+      }
+
       std::string error;
       auto zip_collection = io::ZipFileCollection::Create(path, &error);
       if (zip_collection == nullptr) {
@@ -886,6 +1196,13 @@ class Linker {
       }
     }
 
+    if (options_.symbol_index_dir &&
+        !asset_source->UseSymbolIndex(options_.symbol_index_dir.value(),
+                                      context_->GetDiagnostics()) &&
+        context_->IsVerbose()) {
+      context_->GetDiagnostics()->Note(DiagMessage() << "not indexing symbols of include paths");
+    }
+
     // Capture the shared libraries so that the final resource table can be properly flattened
     // with support for shared libraries.
     for (auto& entry : asset_source->GetAssignedPackageIds()) {
@@ -1082,11 +1399,13 @@ class Linker {
       } break;
 
       case OutputFormat::kProto: {
-        pb::ResourceTable pb_table;
-        SerializeTableToPb(*table, &pb_table, context_->GetDiagnostics(),
-                           options_.proto_table_flattener_options);
-        return io::CopyProtoToArchive(context_, &pb_table, kProtoResourceTablePath,
-                                      ArchiveEntry::kCompress, writer);
+        return io::CopyProtoStreamToArchive(
+            context_,
+            [&](::google::protobuf::io::ZeroCopyOutputStream* out) {
+              return SerializeTableToPb(*table, out, context_->GetDiagnostics(),
+                                        options_.proto_table_flattener_options);
+            },
+            kProtoResourceTablePath, ArchiveEntry::kCompress, writer);
       } break;
     }
     return false;
@@ -1500,7 +1819,7 @@ class Linker {
 
     while ((entry = reader.Next()) != nullptr) {
       if (entry->Type() == ContainerEntryType::kResTable) {
-        TRACE_NAME(std::string("Process ResTable:") + file->GetSource().path);
+        FileTrace trace("MergeTable", file->GetSource().path, "arsc", input_stream->TotalSize());
         pb::ResourceTable pb_table;
         if (!entry->GetResTable(&pb_table)) {
           context_->GetDiagnostics()->Error(DiagMessage(src) << "failed to read resource table: "
@@ -1516,12 +1835,17 @@ class Linker {
           return false;
         }
 
+        if (!NeedsComments()) {
+          CommentDropper dropper;
+          VisitAllValuesInTable(&table, &dropper);
+        }
+
         if (!table_merger_->Merge(src, &table, override)) {
           context_->GetDiagnostics()->Error(DiagMessage(src) << "failed to merge resource table");
           return false;
         }
       } else if (entry->Type() == ContainerEntryType::kResFile) {
-        TRACE_NAME(std::string("Process ResFile") + file->GetSource().path);
+        FileTrace trace("MergeFile", file->GetSource().path, "flat");
         pb::internal::CompiledFile pb_compiled_file;
         off64_t offset;
         size_t len;
@@ -1530,6 +1854,7 @@ class Linker {
                                                              << entry->GetError());
           return false;
         }
+        trace.SetSize(len);
 
         ResourceFile resource_file;
         std::string error;
@@ -1714,6 +2039,41 @@ class Linker {
     return validate(attr->value);
   }
 
+  // Opens the XML cache kept in dir, creating the directory if needed.
+  bool OpenXmlLinkCache(const std::string& dir) {
+    if (!file::mkdirs(dir)) {
+      context_->GetDiagnostics()->Error(DiagMessage(dir) << "failed to create directory");
+      return false;
+    }
+
+    // Linking XML depends on the symbols of the included APKs.
+    for (const std::string& path : options_.include_paths) {
+      std::string contents;
+      if (!android::base::ReadFileToString(path, &contents)) {
+        context_->GetDiagnostics()->Error(DiagMessage(path) << "failed to read");
+        return false;
+      }
+      include_digests_ += XmlLinkCache::Digest(contents);
+    }
+    xml_link_cache_ = util::make_unique<XmlLinkCache>(dir);
+    return true;
+  }
+
+  // Digests what linking the XML files of table depends on besides the XML itself.
+  std::string DigestXmlLinkInputs(const ResourceTable& table, bool keep_raw_values) {
+    std::ostringstream out;
+    out << util::GetToolFingerprint() << "\n"
+        << context_->GetCompilationPackage() << " " << static_cast<int>(context_->GetPackageId())
+        << " " << static_cast<int>(context_->GetPackageType()) << " "
+        << context_->GetMinSdkVersion() << "\n"
+        << keep_raw_values << options_.no_auto_version << options_.no_version_vectors
+        << options_.no_version_transitions << options_.no_xml_namespaces << options_.merge_only
+        << "\n"
+        << include_digests_ << "\n"
+        << XmlLinkCache::DigestTable(table);
+    return XmlLinkCache::Digest(out.str());
+  }
+
   // Writes the AndroidManifest, ResourceTable, and all XML files referenced by the ResourceTable
   // to the IArchiveWriter.
   bool WriteApk(IArchiveWriter* writer, proguard::KeepSet* keep_set, xml::XmlResource* manifest,
@@ -1753,6 +2113,11 @@ class Linker {
         static_cast<bool>(options_.generate_proguard_rules_path);
     file_flattener_options.output_format = options_.output_format;
     file_flattener_options.do_not_fail_on_missing_resources = options_.merge_only;
+    file_flattener_options.jobs = options_.jobs;
+    if (xml_link_cache_ != nullptr) {
+      file_flattener_options.xml_cache = xml_link_cache_.get();
+      file_flattener_options.xml_cache_link_digest = DigestXmlLinkInputs(*table, keep_raw_values);
+    }
 
     ResourceFileFlattener file_flattener(file_flattener_options, context_, keep_set);
     if (!file_flattener.Flatten(table, writer)) {
@@ -1845,6 +2210,13 @@ class Linker {
       return 1;
     }
 
+    if (options_.incremental_cache_dir && context_->GetPackageType() != PackageType::kStaticLib &&
+        options_.output_format == OutputFormat::kApk) {
+      if (!OpenXmlLinkCache(options_.incremental_cache_dir.value())) {
+        return 1;
+      }
+    }
+
     ManifestFixer manifest_fixer(options_.manifest_fixer_options);
     if (!manifest_fixer.Consume(context_, manifest_xml.get())) {
       return 1;
@@ -2202,10 +2574,20 @@ class Linker {
                            proguard_main_dex_keep_set)) {
       return 1;
     }
+
+    if (xml_link_cache_ != nullptr) {
+      xml_link_cache_->RemoveUnused(context_->GetDiagnostics());
+    }
     return 0;
   }
 
  private:
+  // Whether any of the outputs keeps the comments of values.
+  bool NeedsComments() const {
+    return options_.generate_java_class_path || options_.generate_text_symbols_path ||
+           options_.output_format == OutputFormat::kProto;
+  }
+
   LinkOptions options_;
   LinkContext* context_;
   ResourceTable final_table_;
@@ -2214,6 +2596,11 @@ class Linker {
 
   std::unique_ptr<TableMerger> table_merger_;
 
+  // The binary XML files of earlier links, if --incremental-cache is given, and the digests of the
+  // included APKs that linking them depended on.
+  std::unique_ptr<XmlLinkCache> xml_link_cache_;
+  std::string include_digests_;
+
   // A pointer to the FileCollection representing the filesystem (not archives).
   std::unique_ptr<io::FileCollection> file_collection_;
 
@@ -2335,6 +2722,17 @@ int LinkCommand::Action(const std::vector<std::string>& args) {
     context.SetPackageId(static_cast<uint8_t>(package_id_int));
   }
 
+  if (jobs_) {
+    const std::optional<uint32_t> maybe_jobs = ResourceUtils::ParseInt(jobs_.value());
+    if (!maybe_jobs || maybe_jobs.value() == 0) {
+      context.GetDiagnostics()->Error(DiagMessage()
+                                      << "--jobs must be a positive integer, got '"
+                                      << jobs_.value() << "'");
+      return 1;
+    }
+    options_.jobs = maybe_jobs.value();
+  }
+
   // Populate the set of extra packages for which to generate R.java.
   for (std::string& extra_package : extra_java_packages_) {
     // A given package can actually be a colon separated list of packages.
@@ -26,6 +26,7 @@
 #include "format/binary/TableFlattener.h"
 #include "format/proto/ProtoSerialize.h"
 #include "link/ManifestFixer.h"
+#include "process/ApkAssetsCache.h"
 #include "trace/TraceBuffer.h"
 
 namespace aapt {
@@ -107,12 +108,25 @@ struct LinkOptions {
 
   // Whether we should fail on definitions of a resource with conflicting visibility.
   bool strict_visibility = false;
+
+  // The number of threads binary XML files are flattened on.
+  size_t jobs = 1;
+
+  // Directory in which the binary XML files of this link are kept for the next one.
+  std::optional<std::string> incremental_cache_dir;
+
+  // Directory in which the symbols of the included APKs are indexed for later links.
+  std::optional<std::string> symbol_index_dir;
+
+  // Keeps the included APKs loaded for later links, if set.
+  ApkAssetsCache* apk_assets_cache = nullptr;
 };
 
 class LinkCommand : public Command {
  public:
-  explicit LinkCommand(IDiagnostics* diag) : Command("link", "l"),
-                                             diag_(diag) {
+  explicit LinkCommand(IDiagnostics* diag, ApkAssetsCache* apk_assets_cache = nullptr)
+      : Command("link", "l"), diag_(diag) {
+    options_.apk_assets_cache = apk_assets_cache;
     SetDescription("Links resources into an apk.");
     AddRequiredFlag("-o", "Output path.", &options_.output_path, Command::kPath);
     AddRequiredFlag("--manifest", "Path to the Android manifest to build.",
@@ -310,6 +324,19 @@ class LinkCommand : public Command {
         "Only merge the resources, without verifying resource references. This flag\n"
             "should only be used together with the --static-lib flag.",
         &options_.merge_only);
+    AddOptionalFlag("--incremental-cache",
+        "Directory in which to keep the linked XML files, so that the next link of\n"
+            "this module writes out those whose inputs are unchanged as they are. Ignored\n"
+            "with --static-lib and --proto-format.",
+        &options_.incremental_cache_dir, Command::kPath);
+    AddOptionalFlag("--symbol-index",
+        "Directory in which to keep an index of the symbols of the -I APKs, so that\n"
+            "later links against the same APKs look symbols up in it rather than in the\n"
+            "resource tables. The index is written again once the APKs change.",
+        &options_.symbol_index_dir, Command::kPath);
+    AddOptionalFlag("--jobs",
+        "Number of threads to flatten XML files on. The output is the same as\n"
+            "flattening them one at a time. Defaults to 1.", &jobs_);
     AddOptionalSwitch("-v", "Enables verbose logging.", &verbose_);
   }
 
@@ -322,6 +349,7 @@ class LinkCommand : public Command {
   std::vector<std::string> overlay_arg_list_;
   std::vector<std::string> extra_java_packages_;
   std::optional<std::string> package_id_;
+  std::optional<std::string> jobs_;
   std::vector<std::string> configs_;
   std::optional<std::string> preferred_density_;
   std::optional<std::string> product_list_;
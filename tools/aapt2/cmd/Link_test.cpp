@@ -21,6 +21,7 @@
 #include "AppInfo.h"
 #include "LoadedApk.h"
 #include "test/Test.h"
+#include "util/Files.h"
 
 using testing::Eq;
 using testing::HasSubstr;
@@ -32,6 +33,33 @@ namespace aapt {
 
 using LinkTest = CommandTestFixture;
 
+// Expects the APKs to have the same files, in the same order and with the same contents.
+static void ExpectSameFiles(const std::string& expected_apk_path, const std::string& apk_path,
+                            IDiagnostics* diag) {
+  std::unique_ptr<LoadedApk> expected_apk = LoadedApk::LoadApkFromPath(expected_apk_path, diag);
+  ASSERT_THAT(expected_apk, Ne(nullptr));
+  std::unique_ptr<LoadedApk> apk = LoadedApk::LoadApkFromPath(apk_path, diag);
+  ASSERT_THAT(apk, Ne(nullptr));
+
+  auto expected_iter = expected_apk->GetFileCollection()->Iterator();
+  auto iter = apk->GetFileCollection()->Iterator();
+  while (expected_iter->HasNext()) {
+    ASSERT_TRUE(iter->HasNext());
+    io::IFile* expected_file = expected_iter->Next();
+    io::IFile* file = iter->Next();
+    ASSERT_THAT(file->GetSource().path, Eq(expected_file->GetSource().path));
+
+    std::unique_ptr<io::IData> expected_data = expected_file->OpenAsData();
+    std::unique_ptr<io::IData> data = file->OpenAsData();
+    ASSERT_THAT(expected_data, NotNull());
+    ASSERT_THAT(data, NotNull());
+    ASSERT_THAT(data->size(), Eq(expected_data->size()));
+    EXPECT_EQ(0, memcmp(expected_data->data(), data->data(), expected_data->size()))
+        << expected_file->GetSource().path;
+  }
+  EXPECT_FALSE(iter->HasNext());
+}
+
 TEST_F(LinkTest, RemoveRawXmlStrings) {
   StdErrDiagnostics diag;
   const std::string compiled_files_dir = GetTestPath("compiled");
@@ -181,6 +209,87 @@ TEST_F(LinkTest, NoCompressResources) {
   EXPECT_FALSE(file->WasCompressed());
 }
 
+TEST_F(LinkTest, ConcurrentXmlFlatteningMatchesSerial) {
+  StdErrDiagnostics diag;
+  const std::string compiled_files_dir = GetTestPath("compiled");
+  for (const std::string name : {"a", "b", "c", "d", "e"}) {
+    ASSERT_TRUE(CompileFile(GetTestPath("res/xml/" + name + ".xml"),
+                            R"(<Item name=")" + name + R"(" value="@string/hello"/>)",
+                            compiled_files_dir, &diag));
+    ASSERT_TRUE(CompileFile(GetTestPath("res/raw/" + name + ".txt"), name, compiled_files_dir,
+                            &diag));
+  }
+  ASSERT_TRUE(CompileFile(GetTestPath("res/values/values.xml"),
+                          R"(<resources><string name="hello">hello</string></resources>)",
+                          compiled_files_dir, &diag));
+
+  const std::string serial_apk = GetTestPath("serial.apk");
+  ASSERT_TRUE(Link({"--manifest", GetDefaultManifest(), "-o", serial_apk}, compiled_files_dir,
+                   &diag));
+  const std::string concurrent_apk = GetTestPath("concurrent.apk");
+  ASSERT_TRUE(Link({"--manifest", GetDefaultManifest(), "-o", concurrent_apk, "--jobs", "4"},
+                   compiled_files_dir, &diag));
+
+  ExpectSameFiles(serial_apk, concurrent_apk, &diag);
+}
+
+TEST_F(LinkTest, IncrementalCacheMatchesFullLink) {
+  StdErrDiagnostics diag;
+  const std::string compiled_files_dir = GetTestPath("compiled");
+  for (const std::string name : {"a", "b", "c"}) {
+    ASSERT_TRUE(CompileFile(GetTestPath("res/xml/" + name + ".xml"),
+                            R"(<Item name=")" + name + R"(" value="@string/hello"/>)",
+                            compiled_files_dir, &diag));
+  }
+  ASSERT_TRUE(CompileFile(GetTestPath("res/values/values.xml"),
+                          R"(<resources><string name="hello">hello</string></resources>)",
+                          compiled_files_dir, &diag));
+
+  const std::string cache_dir = GetTestPath("cache");
+  const std::string first_apk = GetTestPath("first.apk");
+  ASSERT_TRUE(Link({"--manifest", GetDefaultManifest(), "-o", first_apk, "--incremental-cache",
+                    cache_dir}, compiled_files_dir, &diag));
+  std::optional<std::vector<std::string>> entries = file::FindFiles(cache_dir, &diag);
+  ASSERT_TRUE(entries);
+  EXPECT_THAT(entries.value().size(), Eq(3u));
+
+  // Nothing changed, so every XML file comes from the cache.
+  const std::string cached_apk = GetTestPath("cached.apk");
+  ASSERT_TRUE(Link({"--manifest", GetDefaultManifest(), "-o", cached_apk, "--incremental-cache",
+                    cache_dir}, compiled_files_dir, &diag));
+  ExpectSameFiles(first_apk, cached_apk, &diag);
+
+  // Changing a file and a string value relinks only that file, and drops its old entry.
+  ASSERT_TRUE(CompileFile(GetTestPath("res/xml/b.xml"),
+                          R"(<Item name="changed" value="@string/hello"/>)", compiled_files_dir,
+                          &diag));
+  ASSERT_TRUE(CompileFile(GetTestPath("res/values/values.xml"),
+                          R"(<resources><string name="hello">goodbye</string></resources>)",
+                          compiled_files_dir, &diag));
+  const std::string incremental_apk = GetTestPath("incremental.apk");
+  ASSERT_TRUE(Link({"--manifest", GetDefaultManifest(), "-o", incremental_apk,
+                    "--incremental-cache", cache_dir}, compiled_files_dir, &diag));
+  const std::string full_apk = GetTestPath("full.apk");
+  ASSERT_TRUE(Link({"--manifest", GetDefaultManifest(), "-o", full_apk}, compiled_files_dir,
+                   &diag));
+  ExpectSameFiles(full_apk, incremental_apk, &diag);
+
+  entries = file::FindFiles(cache_dir, &diag);
+  ASSERT_TRUE(entries);
+  EXPECT_THAT(entries.value().size(), Eq(3u));
+}
+
+TEST_F(LinkTest, InvalidJobs) {
+  StdErrDiagnostics diag;
+  const std::string compiled_files_dir = GetTestPath("compiled");
+  ASSERT_TRUE(CompileFile(GetTestPath("res/xml/test.xml"), R"(<Item AgentCode="007"/>)",
+                          compiled_files_dir, &diag));
+
+  const std::string out_apk = GetTestPath("out.apk");
+  EXPECT_FALSE(Link({"--manifest", GetDefaultManifest(), "-o", out_apk, "--jobs", "0"},
+                    compiled_files_dir, &diag));
+}
+
 TEST_F(LinkTest, OverlayStyles) {
   StdErrDiagnostics diag;
   const std::string compiled_files_dir = GetTestPath("compiled");
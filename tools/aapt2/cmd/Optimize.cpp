@@ -40,6 +40,7 @@
 #include "io/Util.h"
 #include "optimize/MultiApkGenerator.h"
 #include "optimize/ResourceDeduper.h"
+#include "optimize/ResourceFileDeduper.h"
 #include "optimize/ResourceFilter.h"
 #include "optimize/ResourcePathShortener.h"
 #include "optimize/VersionCollapser.h"
@@ -151,6 +152,14 @@ class Optimizer {
       return 1;
     }
 
+    if (options_.deduplicate_resource_files) {
+      ResourceFileDeduper file_deduper(options_.jobs);
+      if (!file_deduper.Consume(context_, apk->GetResourceTable())) {
+        context_->GetDiagnostics()->Error(DiagMessage() << "failed deduping resource files");
+        return 1;
+      }
+    }
+
     if (options_.shorten_resource_paths) {
       ResourcePathShortener shortener(options_.table_flattener_options.shortened_path_map);
       if (!shortener.Consume(context_, apk->GetResourceTable())) {
@@ -179,37 +188,22 @@ class Optimizer {
     }
     splitter.SplitTable(apk->GetResourceTable());
 
-    auto path_iter = options_.split_paths.begin();
-    auto split_constraints_iter = options_.split_constraints.begin();
-    for (std::unique_ptr<ResourceTable>& split_table : splitter.splits()) {
-      if (context_->IsVerbose()) {
-        context_->GetDiagnostics()->Note(
-            DiagMessage(*path_iter) << "generating split with configurations '"
-                                    << util::Joiner(split_constraints_iter->configs, ", ") << "'");
-      }
-
-      // Generate an AndroidManifest.xml for each split.
-      std::unique_ptr<xml::XmlResource> split_manifest =
-          GenerateSplitManifest(options_.app_info, *split_constraints_iter);
-      std::unique_ptr<IArchiveWriter> split_writer =
-          CreateZipFileArchiveWriter(context_->GetDiagnostics(), *path_iter);
-      if (!split_writer) {
-        return 1;
-      }
-
-      if (!WriteSplitApk(split_table.get(), split_manifest.get(), split_writer.get())) {
-        return 1;
-      }
-
-      ++path_iter;
-      ++split_constraints_iter;
+    // Each split has a table of its own, and only reads the files of the APK.
+    std::vector<std::unique_ptr<ResourceTable>>& split_tables = splitter.splits();
+    if (!RunTasksConcurrently(context_, split_tables.size(), options_.jobs,
+                              [&](IAaptContext* context, size_t i) {
+                                return WriteSplit(context, split_tables[i].get(),
+                                                  options_.split_paths[i],
+                                                  options_.split_constraints[i]);
+                              })) {
+      return 1;
     }
 
     if (options_.apk_artifacts && options_.output_dir) {
       MultiApkGenerator generator{apk.get(), context_};
       MultiApkGeneratorOptions generator_options = {
           options_.output_dir.value(), options_.apk_artifacts.value(),
-          options_.table_flattener_options, options_.kept_artifacts};
+          options_.table_flattener_options, options_.kept_artifacts, options_.jobs};
       if (!generator.FromBaseApk(generator_options)) {
         return 1;
       }
@@ -227,15 +221,35 @@ class Optimizer {
   }
 
  private:
-  bool WriteSplitApk(ResourceTable* table, xml::XmlResource* manifest, IArchiveWriter* writer) {
+  bool WriteSplit(IAaptContext* context, ResourceTable* table, const std::string& path,
+                  const SplitConstraints& constraints) {
+    if (context->IsVerbose()) {
+      context->GetDiagnostics()->Note(DiagMessage(path)
+                                      << "generating split with configurations '"
+                                      << util::Joiner(constraints.configs, ", ") << "'");
+    }
+
+    // Generate an AndroidManifest.xml for each split.
+    std::unique_ptr<xml::XmlResource> split_manifest =
+        GenerateSplitManifest(options_.app_info, constraints);
+    std::unique_ptr<IArchiveWriter> split_writer =
+        CreateZipFileArchiveWriter(context->GetDiagnostics(), path);
+    if (!split_writer) {
+      return false;
+    }
+    return WriteSplitApk(context, table, split_manifest.get(), split_writer.get());
+  }
+
+  bool WriteSplitApk(IAaptContext* context, ResourceTable* table, xml::XmlResource* manifest,
+                     IArchiveWriter* writer) {
     BigBuffer manifest_buffer(4096);
     XmlFlattener xml_flattener(&manifest_buffer, {});
-    if (!xml_flattener.Consume(context_, manifest)) {
+    if (!xml_flattener.Consume(context, manifest)) {
       return false;
     }
 
     io::BigBufferInputStream manifest_buffer_in(&manifest_buffer);
-    if (!io::CopyInputStreamToArchive(context_, &manifest_buffer_in, "AndroidManifest.xml",
+    if (!io::CopyInputStreamToArchive(context, &manifest_buffer_in, "AndroidManifest.xml",
                                       ArchiveEntry::kCompress, writer)) {
       return false;
     }
@@ -255,7 +269,7 @@ class Optimizer {
 
             if (file_ref->file == nullptr) {
               ResourceNameRef name(pkg->name, type->type, entry->name);
-              context_->GetDiagnostics()->Warn(DiagMessage(file_ref->GetSource())
+              context->GetDiagnostics()->Warn(DiagMessage(file_ref->GetSource())
                                                << "file for resource " << name << " with config '"
                                                << config_value->config << "' not found");
               continue;
@@ -268,7 +282,7 @@ class Optimizer {
 
         for (auto& entry : config_sorted_files) {
           FileReference* file_ref = entry.second;
-          if (!io::CopyFileToArchivePreserveCompression(context_, file_ref->file, *file_ref->path,
+          if (!io::CopyFileToArchivePreserveCompression(context, file_ref->file, *file_ref->path,
                                                         writer)) {
             return false;
           }
@@ -278,12 +292,12 @@ class Optimizer {
 
     BigBuffer table_buffer(4096);
     TableFlattener table_flattener(options_.table_flattener_options, &table_buffer);
-    if (!table_flattener.Consume(context_, table)) {
+    if (!table_flattener.Consume(context, table)) {
       return false;
     }
 
     io::BigBufferInputStream table_buffer_in(&table_buffer);
-    return io::CopyInputStreamToArchive(context_, &table_buffer_in, "resources.arsc",
+    return io::CopyInputStreamToArchive(context, &table_buffer_in, "resources.arsc",
                                         ArchiveEntry::kAlign, writer);
   }
 
@@ -378,6 +392,16 @@ int OptimizeCommand::Action(const std::vector<std::string>& args) {
   context.SetVerbose(verbose_);
   IDiagnostics* diag = context.GetDiagnostics();
 
+  if (jobs_) {
+    const std::optional<uint32_t> maybe_jobs = ResourceUtils::ParseInt(jobs_.value());
+    if (!maybe_jobs || maybe_jobs.value() == 0) {
+      diag->Error(DiagMessage() << "--jobs must be a positive integer, got '" << jobs_.value()
+                                << "'");
+      return 1;
+    }
+    options_.jobs = maybe_jobs.value();
+  }
+
   if (config_path_) {
     std::string& path = config_path_.value();
     std::optional<ConfigurationParser> for_path = ConfigurationParser::ForPath(path);
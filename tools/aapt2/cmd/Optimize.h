@@ -61,6 +61,12 @@ struct OptimizeOptions {
 
   // Path to the output map of original resource paths to shortened paths.
   std::optional<std::string> shortened_paths_map_path;
+
+  // Whether to keep only one of the files of a resource type that have the same contents.
+  bool deduplicate_resource_files = false;
+
+  // The number of splits and artifacts written at once.
+  size_t jobs = 1;
 };
 
 class OptimizeCommand : public Command {
@@ -111,6 +117,17 @@ class OptimizeCommand : public Command {
     AddOptionalFlag("--resource-path-shortening-map",
         "Path to output the map of old resource paths to shortened paths.",
         &options_.shortened_paths_map_path);
+    AddOptionalSwitch("--deduplicate-resource-files",
+        "Keeps only one of the files of a resource type that have the same contents,\n"
+            "such as the same PNG in several densities, and points all of their\n"
+            "resources at it.",
+        &options_.deduplicate_resource_files);
+    AddOptionalFlag("--jobs",
+        "Number of splits and artifacts to write in parallel. Each one being written\n"
+            "holds a copy of its part of the resource table, so this also bounds the\n"
+            "memory used. The output is the same as writing them one at a time.\n"
+            "Also the number of resource types whose files are compared at once by\n"
+            "--deduplicate-resource-files. Defaults to 1.", &jobs_);
     AddOptionalSwitch("-v", "Enables verbose logging", &verbose_);
   }
 
@@ -128,6 +145,7 @@ class OptimizeCommand : public Command {
   std::vector<std::string> configs_;
   std::vector<std::string> split_args_;
   std::unordered_set<std::string> kept_artifacts_;
+  std::optional<std::string> jobs_;
   bool print_only_ = false;
   bool verbose_ = false;
 };
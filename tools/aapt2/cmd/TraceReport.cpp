@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TraceReport.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <sstream>
+
+#include "android-base/file.h"
+#include "android-base/parseint.h"
+#include "android-base/stringprintf.h"
+
+#include "util/Files.h"
+#include "util/Util.h"
+
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+// Returns the value of key in a line of the trace, with the escapes of strings undone.
+static std::optional<std::string> FindTraceValue(const std::string& line, const char* key) {
+  const std::string prefix = StringPrintf("\"%s\" : ", key);
+  size_t pos = line.find(prefix);
+  if (pos == std::string::npos) {
+    return {};
+  }
+  pos += prefix.size();
+
+  std::string value;
+  if (pos < line.size() && line[pos] == '"') {
+    for (pos++; pos < line.size() && line[pos] != '"'; pos++) {
+      if (line[pos] == '\\' && pos + 1 < line.size()) {
+        pos++;
+        if (line[pos] == 'u' && pos + 4 < line.size()) {
+          value += static_cast<char>(strtol(line.substr(pos + 1, 4).c_str(), nullptr, 16));
+          pos += 4;
+          continue;
+        }
+      }
+      value += line[pos];
+    }
+    return value;
+  }
+
+  while (pos < line.size() && isdigit(line[pos])) {
+    value += line[pos++];
+  }
+  return value;
+}
+
+bool ReadTracedFileCosts(const std::string& contents, std::vector<TracedFileCost>* out_costs) {
+  bool found = false;
+  std::istringstream stream(contents);
+  for (std::string line; std::getline(stream, line);) {
+    if (line.find("\"ph\" : \"X\"") == std::string::npos) {
+      continue;
+    }
+
+    std::optional<std::string> file = FindTraceValue(line, "file");
+    std::optional<std::string> duration = FindTraceValue(line, "dur");
+    if (!file || !duration) {
+      continue;
+    }
+
+    TracedFileCost cost;
+    cost.tag = FindTraceValue(line, "name").value_or("");
+    cost.file = file.value();
+    cost.type = FindTraceValue(line, "type").value_or("");
+    android::base::ParseUint(FindTraceValue(line, "size").value_or("0"), &cost.size);
+    android::base::ParseInt(duration.value(), &cost.duration);
+    cost.count = 1;
+    out_costs->push_back(std::move(cost));
+    found = true;
+  }
+  return found;
+}
+
+int TraceReportCommand::Action(const std::vector<std::string>& args) {
+  size_t top = 20;
+  if (top_ && !android::base::ParseUint(top_.value(), &top)) {
+    diag_->Error(DiagMessage() << "--top must be a number, got '" << top_.value() << "'");
+    return 1;
+  }
+
+  if (args.empty()) {
+    diag_->Error(DiagMessage() << "no trace files specified");
+    return 1;
+  }
+
+  std::vector<std::string> paths;
+  for (const std::string& arg : args) {
+    if (file::GetFileType(arg) != file::FileType::kDirectory) {
+      paths.push_back(arg);
+      continue;
+    }
+
+    std::optional<std::vector<std::string>> files = file::FindFiles(arg, diag_);
+    if (!files) {
+      return 1;
+    }
+    for (const std::string& name : files.value()) {
+      if (util::StartsWith(file::GetFilename(name), "report_aapt2_") &&
+          util::EndsWith(name, ".json")) {
+        std::string path = arg;
+        file::AppendPath(&path, name);
+        paths.push_back(std::move(path));
+      }
+    }
+  }
+
+  std::vector<TracedFileCost> events;
+  for (const std::string& path : paths) {
+    std::string contents;
+    if (!android::base::ReadFileToString(path, &contents)) {
+      diag_->Error(DiagMessage(path) << "failed to read trace");
+      return 1;
+    }
+    if (!ReadTracedFileCosts(contents, &events)) {
+      diag_->Warn(DiagMessage(path) << "trace has no file events");
+    }
+  }
+
+  // A file goes through several steps, and a daemon may do each step more than once.
+  std::map<std::pair<std::string, std::string>, TracedFileCost> costs_by_file;
+  std::map<std::pair<std::string, std::string>, TracedFileCost> costs_by_type;
+  auto add = [](const TracedFileCost& event, TracedFileCost* cost) {
+    cost->count += event.count;
+    cost->duration += event.duration;
+    cost->size = std::max(cost->size, event.size);
+  };
+  for (const TracedFileCost& event : events) {
+    TracedFileCost* by_file = &costs_by_file[{event.tag, event.file}];
+    if (by_file->count == 0) {
+      *by_file = TracedFileCost{event.tag, event.file, event.type};
+    }
+    add(event, by_file);
+
+    TracedFileCost* by_type = &costs_by_type[{event.tag, event.type}];
+    if (by_type->count == 0) {
+      *by_type = TracedFileCost{event.tag, {}, event.type};
+    }
+    add(event, by_type);
+  }
+
+  auto sorted_by_duration = [](const auto& costs) {
+    std::vector<const TracedFileCost*> sorted;
+    for (const auto& entry : costs) {
+      sorted.push_back(&entry.second);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const TracedFileCost* a, const TracedFileCost* b) {
+                       return a->duration > b->duration;
+                     });
+    return sorted;
+  };
+
+  const std::vector<const TracedFileCost*> files = sorted_by_duration(costs_by_file);
+  printer_->Println(StringPrintf("Slowest files (%zu of %zu):", std::min(top, files.size()),
+                                 files.size()));
+  printer_->Indent();
+  for (size_t i = 0; i < files.size() && i < top; i++) {
+    const TracedFileCost* cost = files[i];
+    printer_->Println(StringPrintf("%10.1f ms %12" PRIu64 " bytes  %-16s %s",
+                                   cost->duration / 1000.0, cost->size, cost->tag.c_str(),
+                                   cost->file.c_str()));
+  }
+  printer_->Undent();
+
+  printer_->Println("By type:");
+  printer_->Indent();
+  for (const TracedFileCost* cost : sorted_by_duration(costs_by_type)) {
+    printer_->Println(StringPrintf("%10.1f ms %8zu files  %-16s %s", cost->duration / 1000.0,
+                                   cost->count, cost->tag.c_str(), cost->type.c_str()));
+  }
+  printer_->Undent();
+  return 0;
+}
+
+}  // namespace aapt
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT2_TRACEREPORT_H
+#define AAPT2_TRACEREPORT_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Command.h"
+#include "Diagnostics.h"
+#include "text/Printer.h"
+
+namespace aapt {
+
+// The time spent on one input file in one step, summed over the traces read.
+struct TracedFileCost {
+  // The name of the step, such as "Compile".
+  std::string tag;
+  std::string file;
+  std::string type;
+  uint64_t size = 0;
+
+  // How many times the file went through the step, and how long that took in microseconds.
+  size_t count = 0;
+  int64_t duration = 0;
+};
+
+// Appends a cost for each file event of the trace in contents, as written to a --trace-folder.
+// Returns false if contents has no file events.
+bool ReadTracedFileCosts(const std::string& contents, std::vector<TracedFileCost>* out_costs);
+
+class TraceReportCommand : public Command {
+ public:
+  explicit TraceReportCommand(text::Printer* printer, IDiagnostics* diag)
+      : Command("trace-report"), printer_(printer), diag_(diag) {
+    SetDescription("Prints the input files that took longest in the traces written to a\n"
+        "--trace-folder. Arguments are trace files, or folders of them.");
+    AddOptionalFlag("--top", "How many files to print. Defaults to 20.", &top_);
+  }
+
+  int Action(const std::vector<std::string>& args) override;
+
+ private:
+  text::Printer* printer_;
+  IDiagnostics* diag_;
+  std::optional<std::string> top_;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT2_TRACEREPORT_H
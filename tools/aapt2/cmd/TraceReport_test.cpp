@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TraceReport.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "android-base/file.h"
+#include "io/StringStream.h"
+#include "test/Test.h"
+#include "trace/TraceBuffer.h"
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+
+namespace aapt {
+
+using TraceReportTest = TestDirectoryFixture;
+
+TEST_F(TraceReportTest, ReadsFileEventsOfTrace) {
+  const std::string trace_dir = GetTestDirectory().to_string();
+  {
+    FlushTrace flush(trace_dir, "TraceReportTest");
+    FileTrace trace("Compile", "res/drawable/\"icon\".png", "png", 1234u);
+  }
+
+  std::string contents;
+  ASSERT_TRUE(android::base::ReadFileToString(
+      GetTestPath("report_aapt2_" + std::to_string(getpid()) + ".json"), &contents));
+  EXPECT_THAT(contents.substr(0, 2), Eq("[\n"));
+
+  // Events recorded earlier by other tests are flushed along with this one.
+  std::vector<TracedFileCost> costs;
+  ASSERT_TRUE(ReadTracedFileCosts(contents, &costs));
+  auto iter = std::find_if(costs.begin(), costs.end(), [](const TracedFileCost& cost) {
+    return cost.file == "res/drawable/\"icon\".png";
+  });
+  ASSERT_TRUE(iter != costs.end());
+  EXPECT_THAT(iter->tag, Eq("Compile"));
+  EXPECT_THAT(iter->type, Eq("png"));
+  EXPECT_THAT(iter->size, Eq(1234u));
+  EXPECT_THAT(iter->count, Eq(1u));
+}
+
+TEST_F(TraceReportTest, PrintsSlowestFiles) {
+  const std::string trace_path = GetTestPath("report_aapt2_1.json");
+  ASSERT_TRUE(android::base::WriteStringToFile(
+      "[\n"
+      "{\"ts\" : \"1\", \"ph\" : \"B\", \"tid\" : \"0\" , \"pid\" : \"1\", \"name\" : \"Link\" },\n"
+      "{\"ts\" : \"2\", \"ph\" : \"X\", \"dur\" : \"3000\", \"tid\" : \"0\" , \"pid\" : \"1\", "
+      "\"name\" : \"LinkXml\", \"args\" : {\"file\" : \"fast.xml\", \"size\" : 10, "
+      "\"type\" : \"xml\"} },\n"
+      "{\"ts\" : \"2\", \"ph\" : \"X\", \"dur\" : \"5000\", \"tid\" : \"1\" , \"pid\" : \"1\", "
+      "\"name\" : \"LinkXml\", \"args\" : {\"file\" : \"slow.xml\", \"size\" : 20, "
+      "\"type\" : \"xml\"} },\n"
+      "{\"ts\" : \"9\", \"ph\" : \"X\", \"dur\" : \"4000\", \"tid\" : \"0\" , \"pid\" : \"1\", "
+      "\"name\" : \"LinkXml\", \"args\" : {\"file\" : \"fast.xml\", \"size\" : 10, "
+      "\"type\" : \"xml\"} },\n"
+      "{\"ts\" : \"9\", \"ph\" : \"E\", \"tid\" : \"0\" , \"pid\" : \"1\", \"name\" : \"\" },\n",
+      trace_path));
+
+  std::string output;
+  {
+    io::StringOutputStream out(&output);
+    text::Printer printer(&out);
+    TraceReportCommand command(&printer, test::GetDiagnostics());
+    ASSERT_THAT(command.Execute({"--top", "1", GetTestDirectory()}, &std::cerr), Eq(0));
+  }
+
+  // fast.xml took longer in total.
+  EXPECT_THAT(output, HasSubstr("Slowest files (1 of 2):"));
+  EXPECT_THAT(output, HasSubstr("7.0 ms"));
+  EXPECT_THAT(output, HasSubstr("fast.xml"));
+  EXPECT_THAT(output.find("slow.xml"), Eq(std::string::npos));
+  EXPECT_THAT(output, HasSubstr("12.0 ms        3 files  LinkXml"));
+}
+
+}  // namespace aapt
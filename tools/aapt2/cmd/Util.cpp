@@ -16,6 +16,9 @@
 
 #include "cmd/Util.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 #include "android-base/logging.h"
@@ -34,6 +37,53 @@ using ::android::base::StringPrintf;
 
 namespace aapt {
 
+bool RunTasksConcurrently(IAaptContext* context, size_t count, size_t jobs,
+                          const std::function<bool(IAaptContext* context, size_t index)>& task) {
+  if (jobs <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      if (!task(context, i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  struct Result {
+    BufferedDiagnostics diagnostics;
+    bool success = false;
+  };
+  std::vector<Result> results(count);
+
+  // Tasks are started in index order, so every task before one that failed has run.
+  std::atomic<size_t> next_task(0);
+  std::atomic<bool> failed(false);
+  auto worker = [&]() {
+    for (size_t i = next_task++; i < count && !failed; i = next_task++) {
+      TaskContext task_context(context, &results[i].diagnostics);
+      results[i].success = task(&task_context, i);
+      if (!results[i].success) {
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::min(jobs, count); i++) {
+    threads.emplace_back(worker);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (Result& result : results) {
+    result.diagnostics.Replay(context->GetDiagnostics());
+    if (!result.success) {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::optional<uint16_t> ParseTargetDensityParameter(const StringPiece& arg, IDiagnostics* diag) {
   ConfigDescription preferred_density_config;
   if (!ConfigDescription::Parse(arg, &preferred_density_config)) {
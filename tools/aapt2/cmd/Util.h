@@ -17,6 +17,7 @@
 #ifndef AAPT_SPLIT_UTIL_H
 #define AAPT_SPLIT_UTIL_H
 
+#include <functional>
 #include <regex>
 
 #include "androidfw/StringPiece.h"
@@ -25,11 +26,70 @@
 #include "Diagnostics.h"
 #include "SdkConstants.h"
 #include "filter/ConfigFilter.h"
+#include "process/IResourceTableConsumer.h"
 #include "split/TableSplitter.h"
 #include "xml/XmlDom.h"
 
 namespace aapt {
 
+// The context of work done on a worker thread. It forwards everything to the context of the whole
+// command, but logs to diagnostics of its own, e.g. a BufferedDiagnostics.
+class TaskContext : public IAaptContext {
+ public:
+  TaskContext(IAaptContext* context, IDiagnostics* diagnostics)
+      : context_(context), diagnostics_(diagnostics) {
+  }
+
+  PackageType GetPackageType() override {
+    return context_->GetPackageType();
+  }
+
+  bool IsVerbose() override {
+    return context_->IsVerbose();
+  }
+
+  IDiagnostics* GetDiagnostics() override {
+    return diagnostics_;
+  }
+
+  NameMangler* GetNameMangler() override {
+    return context_->GetNameMangler();
+  }
+
+  const std::string& GetCompilationPackage() override {
+    return context_->GetCompilationPackage();
+  }
+
+  uint8_t GetPackageId() override {
+    return context_->GetPackageId();
+  }
+
+  SymbolTable* GetExternalSymbols() override {
+    return context_->GetExternalSymbols();
+  }
+
+  int GetMinSdkVersion() override {
+    return context_->GetMinSdkVersion();
+  }
+
+  const std::set<std::string>& GetSplitNameDependencies() override {
+    return context_->GetSplitNameDependencies();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TaskContext);
+
+  IAaptContext* context_;
+  IDiagnostics* diagnostics_;
+};
+
+// Runs task for each index in [0, count) on up to jobs threads, handing each a TaskContext of its
+// own. Their diagnostics are logged to context once all are done, in index order and up to the
+// first task that failed, as if they had run one after another. No more tasks are started once one
+// fails. Returns whether all of them succeeded.
+bool RunTasksConcurrently(IAaptContext* context, size_t count, size_t jobs,
+                          const std::function<bool(IAaptContext* context, size_t index)>& task);
+
 // Parses a configuration density (ex. hdpi, xxhdpi, 234dpi, anydpi, etc).
 // Returns Nothing and logs a human friendly error message if the string was not legal.
 std::optional<uint16_t> ParseTargetDensityParameter(const android::StringPiece& arg,
@@ -16,6 +16,8 @@
 
 #include "Util.h"
 
+#include <atomic>
+
 #include "android-base/stringprintf.h"
 
 #include "AppInfo.h"
@@ -411,4 +413,54 @@ TEST (UtilTest, RegularExpressionNonEnglish) {
   EXPECT_FALSE(std::regex_search("file.koncowka", expression));
 }
 
+// Keeps the messages logged, so that their order can be checked.
+class RecordingDiagnostics : public IDiagnostics {
+ public:
+  void Log(Level level, DiagMessageActual& actual_msg) override {
+    messages.push_back(actual_msg.message);
+  }
+
+  std::vector<std::string> messages;
+};
+
+TEST (UtilTest, RunTasksConcurrentlyLogsInOrder) {
+  std::unique_ptr<IAaptContext> test_context = test::ContextBuilder().Build();
+  for (size_t jobs : {1, 4}) {
+    RecordingDiagnostics diag;
+    TaskContext context(test_context.get(), &diag);
+    std::vector<std::atomic<bool>> ran(16);
+    EXPECT_TRUE(RunTasksConcurrently(&context, ran.size(), jobs,
+                                     [&](IAaptContext* task_context, size_t i) {
+                                       task_context->GetDiagnostics()->Note(
+                                           DiagMessage() << "task " << i);
+                                       ran[i] = true;
+                                       return true;
+                                     }));
+
+    ASSERT_EQ(diag.messages.size(), ran.size());
+    for (size_t i = 0; i < ran.size(); i++) {
+      EXPECT_TRUE(ran[i]);
+      EXPECT_EQ(diag.messages[i], "task " + std::to_string(i));
+    }
+  }
+}
+
+TEST (UtilTest, RunTasksConcurrentlyStopsAtFailure) {
+  std::unique_ptr<IAaptContext> test_context = test::ContextBuilder().Build();
+  for (size_t jobs : {1, 4}) {
+    RecordingDiagnostics diag;
+    TaskContext context(test_context.get(), &diag);
+    EXPECT_FALSE(RunTasksConcurrently(&context, 16, jobs,
+                                      [&](IAaptContext* task_context, size_t i) {
+                                        task_context->GetDiagnostics()->Error(
+                                            DiagMessage() << "task " << i);
+                                        return i != 5;
+                                      }));
+
+    // Messages of the tasks after the one that failed are dropped, as if they had never run.
+    ASSERT_EQ(diag.messages.size(), 6u);
+    EXPECT_EQ(diag.messages.back(), "task 5");
+  }
+}
+
 }  // namespace aapt
@@ -16,6 +16,7 @@
 
 #include "compile/Image.h"
 
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -301,25 +302,35 @@ static int32_t CalculateSegmentCount(const std::vector<Range>& stretch_regions,
 
 static uint32_t GetRegionColor(uint8_t** rows, const Bounds& region) {
   // Sample the first pixel to compare against.
-  const uint32_t expected_color =
-      NinePatch::PackRGBA(rows[region.top] + region.left * 4);
+  const uint8_t* first_pixel = rows[region.top] + region.left * 4;
+  const uint32_t expected_color = NinePatch::PackRGBA(first_pixel);
+  const bool expected_transparent = get_alpha(expected_color) == 0;
+
+  // A transparent region has every pixel transparent, whatever their color. Any other has every
+  // pixel the same color as the first one. Mismatches are collected over a whole row rather than
+  // returned on the first one, which lets the compiler vectorize the loops.
+  uint32_t expected_pixel;
+  memcpy(&expected_pixel, first_pixel, sizeof(expected_pixel));
   for (int32_t y = region.top; y < region.bottom; y++) {
     const uint8_t* row = rows[y];
-    for (int32_t x = region.left; x < region.right; x++) {
-      const uint32_t color = NinePatch::PackRGBA(row + x * 4);
-      if (get_alpha(color) == 0) {
-        // The color is transparent.
-        // If the expectedColor is not transparent, NO_COLOR.
-        if (get_alpha(expected_color) != 0) {
-          return android::Res_png_9patch::NO_COLOR;
-        }
-      } else if (color != expected_color) {
-        return android::Res_png_9patch::NO_COLOR;
+    uint32_t mismatch = 0;
+    if (expected_transparent) {
+      for (int32_t x = region.left; x < region.right; x++) {
+        mismatch |= row[x * 4 + 3];
+      }
+    } else {
+      for (int32_t x = region.left; x < region.right; x++) {
+        uint32_t pixel;
+        memcpy(&pixel, row + x * 4, sizeof(pixel));
+        mismatch |= pixel ^ expected_pixel;
       }
     }
+    if (mismatch != 0) {
+      return android::Res_png_9patch::NO_COLOR;
+    }
   }
 
-  if (get_alpha(expected_color) == 0) {
+  if (expected_transparent) {
     return android::Res_png_9patch::TRANSPARENT_COLOR;
   }
   return expected_color;
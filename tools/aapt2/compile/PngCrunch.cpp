@@ -525,59 +525,87 @@ bool WritePng(IAaptContext* context, const Image* image,
   // 1. Every pixel has R == G == B (grayscale)
   // 2. Every pixel has A == 255 (opaque)
   // 3. There are no more than 256 distinct RGBA colors (palette).
-  std::unordered_map<uint32_t, int> color_palette;
-  std::unordered_set<uint32_t> alpha_palette;
+  //
+  // The first two are found in a loop over plain arrays of bytes, which the compiler can
+  // vectorize. The palette is only built while it can still fit 256 colors.
   bool needs_to_zero_rgb_channels_of_transparent_pixels = false;
-  bool grayscale = true;
+  bool opaque = true;
   int max_gray_deviation = 0;
 
   for (int32_t y = 0; y < image->height; y++) {
     const uint8_t* row = image->rows[y];
+    uint8_t any_transparent_rgb = 0;
+    uint8_t min_alpha = 0xff;
+    int row_gray_deviation = 0;
     for (int32_t x = 0; x < image->width; x++) {
-      int red = *row++;
-      int green = *row++;
-      int blue = *row++;
-      int alpha = *row++;
-
-      if (alpha == 0) {
-        // The color is completely transparent.
-        // For purposes of palettes and grayscale optimization,
-        // treat all channels as 0x00.
-        needs_to_zero_rgb_channels_of_transparent_pixels =
-            needs_to_zero_rgb_channels_of_transparent_pixels ||
-            (red != 0 || green != 0 || blue != 0);
-        red = green = blue = 0;
+      const uint8_t* pixel = row + x * 4;
+      // The color is completely transparent, for purposes of palettes and grayscale optimization,
+      // treat all channels as 0x00.
+      const uint8_t mask = pixel[3] == 0 ? 0x00 : 0xff;
+      any_transparent_rgb |= (pixel[0] | pixel[1] | pixel[2]) & ~mask;
+      const int red = pixel[0] & mask;
+      const int green = pixel[1] & mask;
+      const int blue = pixel[2] & mask;
+      min_alpha = std::min(min_alpha, pixel[3]);
+
+      // Calculate the gray scale deviation so that it can be compared
+      // with the threshold.
+      row_gray_deviation = std::max(std::abs(red - green), row_gray_deviation);
+      row_gray_deviation = std::max(std::abs(green - blue), row_gray_deviation);
+      row_gray_deviation = std::max(std::abs(blue - red), row_gray_deviation);
+    }
+    needs_to_zero_rgb_channels_of_transparent_pixels |= any_transparent_rgb != 0;
+    opaque = opaque && min_alpha == 0xff;
+    max_gray_deviation = std::max(row_gray_deviation, max_gray_deviation);
+  }
+
+  // The image is indeed grayscale if no pixel deviates at all.
+  const bool grayscale = max_gray_deviation == 0;
+
+  // Insert the colors into the color palette, and those with non-opaque alpha into the alpha
+  // palette as well. The palettes are filled in the same order as by looking at every pixel, as
+  // their order decides the indices of the colors, but repeats of the previous pixel make no
+  // difference and are skipped. Past 256 colors no palette can be used, so stop there.
+  constexpr size_t kMaxPaletteSize = 256;
+  std::unordered_map<uint32_t, int> color_palette;
+  std::unordered_set<uint32_t> alpha_palette;
+  for (int32_t y = 0; y < image->height && color_palette.size() <= kMaxPaletteSize; y++) {
+    const uint8_t* row = image->rows[y];
+    uint32_t last_pixel = 0;
+    for (int32_t x = 0; x < image->width; x++) {
+      const uint8_t* pixel = row + x * 4;
+      uint32_t raw_pixel;
+      memcpy(&raw_pixel, pixel, sizeof(raw_pixel));
+      if (x > 0 && raw_pixel == last_pixel) {
+        continue;
       }
+      last_pixel = raw_pixel;
 
-      // Insert the color into the color palette.
-      const uint32_t color = red << 24 | green << 16 | blue << 8 | alpha;
+      const int alpha = pixel[3];
+      const uint32_t color =
+          alpha == 0 ? 0u
+                     : (static_cast<uint32_t>(pixel[0]) << 24 | pixel[1] << 16 | pixel[2] << 8 |
+                        alpha);
       color_palette[color] = -1;
-
-      // If the pixel has non-opaque alpha, insert it into the
-      // alpha palette.
       if (alpha != 0xff) {
         alpha_palette.insert(color);
       }
-
-      // Check if the image is indeed grayscale.
-      if (grayscale) {
-        if (red != green || red != blue) {
-          grayscale = false;
-        }
+      if (color_palette.size() > kMaxPaletteSize) {
+        break;
       }
-
-      // Calculate the gray scale deviation so that it can be compared
-      // with the threshold.
-      max_gray_deviation = std::max(std::abs(red - green), max_gray_deviation);
-      max_gray_deviation = std::max(std::abs(green - blue), max_gray_deviation);
-      max_gray_deviation = std::max(std::abs(blue - red), max_gray_deviation);
     }
   }
+  const bool fits_palette = color_palette.size() <= kMaxPaletteSize;
+
+  // Only whether there is alpha matters once the colors don't fit a palette.
+  const size_t alpha_palette_size =
+      opaque ? 0u : std::max<size_t>(alpha_palette.size(), 1u);
 
   if (context->IsVerbose()) {
     DiagMessage msg;
-    msg << " paletteSize=" << color_palette.size()
-        << " alphaPaletteSize=" << alpha_palette.size()
+    msg << " paletteSize=" << (fits_palette ? std::to_string(color_palette.size()) : ">256")
+        << " alphaPaletteSize="
+        << (fits_palette ? std::to_string(alpha_palette.size()) : opaque ? "0" : ">0")
         << " maxGrayDeviation=" << max_gray_deviation
         << " grayScale=" << (grayscale ? "true" : "false");
     context->GetDiagnostics()->Note(msg);
@@ -587,7 +615,7 @@ bool WritePng(IAaptContext* context, const Image* image,
 
   const int new_color_type = PickColorType(
       image->width, image->height, grayscale, convertible_to_grayscale,
-      nine_patch != nullptr, color_palette.size(), alpha_palette.size());
+      nine_patch != nullptr, color_palette.size(), alpha_palette_size);
 
   if (context->IsVerbose()) {
     DiagMessage msg;
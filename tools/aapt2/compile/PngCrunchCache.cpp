@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compile/PngCrunchCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+#include "android-base/file.h"
+#include "android-base/stringprintf.h"
+#include "android-base/threads.h"
+
+#include "util/Files.h"
+
+using ::android::StringPiece;
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+namespace {
+
+constexpr const char* kEntryHeader = "aapt2-png-crunch-cache\n";
+
+// Returns the start of an entry, everything up to the crunched PNG.
+std::string MakeEntryPrefix(const StringPiece& source, const StringPiece& options) {
+  std::string prefix = kEntryHeader;
+  prefix.append(options.data(), options.size());
+  prefix += "\n" + std::to_string(source.size()) + "\n";
+  prefix.append(source.data(), source.size());
+  return prefix;
+}
+
+}  // namespace
+
+PngCrunchCache::PngCrunchCache(const std::string& dir) : dir_(dir) {
+}
+
+std::string PngCrunchCache::GetEntryPath(const StringPiece& source,
+                                         const StringPiece& options) const {
+  const std::hash<std::string_view> hash;
+  const std::string name =
+      StringPrintf("%016zx%016zx%08zx.png", hash(std::string_view(source.data(), source.size())),
+                   hash(std::string_view(options.data(), options.size())), source.size());
+  std::string path = dir_;
+  file::AppendPath(&path, name);
+  return path;
+}
+
+bool PngCrunchCache::Find(const StringPiece& source, const StringPiece& options,
+                          std::string* out_png) const {
+  std::string data;
+  if (!android::base::ReadFileToString(GetEntryPath(source, options), &data)) {
+    return false;
+  }
+
+  // The entry must be of this very source and options, not just share their address.
+  const std::string prefix = MakeEntryPrefix(source, options);
+  if (data.size() <= prefix.size() || data.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  *out_png = data.substr(prefix.size());
+  return true;
+}
+
+bool PngCrunchCache::Store(const StringPiece& source, const StringPiece& options,
+                           const BigBuffer& png, IDiagnostics* diag) const {
+  std::string data = MakeEntryPrefix(source, options);
+  data += png.to_string();
+
+  // Write the entry next to where it goes and move it there, so that nobody ever reads half an
+  // entry. The thread ID tells apart the compiles writing the same entry at the same time.
+  const std::string path = GetEntryPath(source, options);
+  const std::string temp_path = path + "." + std::to_string(android::base::GetThreadId()) + ".tmp";
+  if (!android::base::WriteStringToFile(data, temp_path) ||
+      std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    diag->Warn(DiagMessage(path) << "failed to write PNG crunch cache entry");
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace aapt
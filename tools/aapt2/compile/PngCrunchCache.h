@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_COMPILE_PNGCRUNCHCACHE_H
+#define AAPT_COMPILE_PNGCRUNCHCACHE_H
+
+#include <string>
+
+#include "android-base/macros.h"
+#include "androidfw/StringPiece.h"
+
+#include "Diagnostics.h"
+#include "util/BigBuffer.h"
+
+namespace aapt {
+
+// Keeps the PNGs produced by crunching in a directory, addressed by the source PNG and the options
+// crunching it depends on, so that compiling the same PNG again, on this machine or on any other
+// sharing the directory, reuses the crunched PNG instead of decoding and encoding it again.
+//
+// An entry holds its source PNG and options, which are compared on lookup, so entries whose
+// addresses collide are misses rather than wrong PNGs. Entries are written in place atomically, so
+// the directory can be used by several compiles at once. Nothing is ever removed from it.
+class PngCrunchCache {
+ public:
+  // Uses the entries kept in dir, which must exist.
+  explicit PngCrunchCache(const std::string& dir);
+
+  // Reads the crunched PNG kept for source and options. Returns false if there is none or it
+  // can't be read.
+  bool Find(const android::StringPiece& source, const android::StringPiece& options,
+            std::string* out_png) const;
+
+  // Keeps png as the crunched PNG of source and options, replacing any kept already.
+  bool Store(const android::StringPiece& source, const android::StringPiece& options,
+             const BigBuffer& png, IDiagnostics* diag) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PngCrunchCache);
+
+  std::string GetEntryPath(const android::StringPiece& source,
+                           const android::StringPiece& options) const;
+
+  std::string dir_;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_COMPILE_PNGCRUNCHCACHE_H
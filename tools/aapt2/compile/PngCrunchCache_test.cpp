@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compile/PngCrunchCache.h"
+
+#include <dirent.h>
+
+#include <cstring>
+
+#include "android-base/file.h"
+
+#include "test/Test.h"
+
+using ::testing::Eq;
+
+namespace aapt {
+
+class PngCrunchCacheTest : public TestDirectoryFixture {
+ public:
+  static BigBuffer MakePng(const std::string& contents) {
+    BigBuffer buffer(1024);
+    memcpy(buffer.NextBlock<char>(contents.size()), contents.data(), contents.size());
+    return buffer;
+  }
+
+  // Returns the path of the only entry in the cache directory.
+  std::string GetOnlyEntryPath() {
+    std::string path;
+    const std::string dir_path = GetTestDirectory().to_string();
+    std::unique_ptr<DIR, decltype(closedir)*> dir(opendir(dir_path.c_str()), closedir);
+    while (struct dirent* entry = readdir(dir.get())) {
+      if (entry->d_name[0] != '.') {
+        EXPECT_TRUE(path.empty());
+        path = GetTestPath(entry->d_name);
+      }
+    }
+    return path;
+  }
+};
+
+TEST_F(PngCrunchCacheTest, FindsStoredPng) {
+  StdErrDiagnostics diag;
+  PngCrunchCache cache(GetTestDirectory().to_string());
+
+  std::string png;
+  EXPECT_FALSE(cache.Find("source", "options", &png));
+
+  ASSERT_TRUE(cache.Store("source", "options", MakePng("crunched"), &diag));
+  ASSERT_TRUE(cache.Find("source", "options", &png));
+  EXPECT_THAT(png, Eq("crunched"));
+
+  // Another cache reading the same directory finds the PNG too.
+  PngCrunchCache other_cache(GetTestDirectory().to_string());
+  png.clear();
+  ASSERT_TRUE(other_cache.Find("source", "options", &png));
+  EXPECT_THAT(png, Eq("crunched"));
+
+  ASSERT_TRUE(cache.Store("source", "options", MakePng("crunched again"), &diag));
+  ASSERT_TRUE(cache.Find("source", "options", &png));
+  EXPECT_THAT(png, Eq("crunched again"));
+}
+
+TEST_F(PngCrunchCacheTest, MissesOtherSourceOrOptions) {
+  StdErrDiagnostics diag;
+  PngCrunchCache cache(GetTestDirectory().to_string());
+  ASSERT_TRUE(cache.Store("source", "options", MakePng("crunched"), &diag));
+
+  std::string png;
+  EXPECT_FALSE(cache.Find("sourcf", "options", &png));
+  EXPECT_FALSE(cache.Find("source", "optionz", &png));
+  EXPECT_FALSE(cache.Find("sourc", "options", &png));
+}
+
+TEST_F(PngCrunchCacheTest, MissesCorruptEntry) {
+  StdErrDiagnostics diag;
+  PngCrunchCache cache(GetTestDirectory().to_string());
+  ASSERT_TRUE(cache.Store("source", "options", MakePng("crunched"), &diag));
+
+  const std::string entry_path = GetOnlyEntryPath();
+  std::string entry;
+  ASSERT_TRUE(android::base::ReadFileToString(entry_path, &entry));
+
+  // An entry cut short before its PNG is a miss.
+  ASSERT_TRUE(android::base::WriteStringToFile(entry.substr(0, entry.size() - 8), entry_path));
+  std::string png;
+  EXPECT_FALSE(cache.Find("source", "options", &png));
+
+  // So is one whose source doesn't match, as if another source had the same address.
+  entry[entry.size() - 9] ^= 1;
+  ASSERT_TRUE(android::base::WriteStringToFile(entry, entry_path));
+  EXPECT_FALSE(cache.Find("source", "options", &png));
+}
+
+}  // namespace aapt
@@ -26,6 +26,7 @@
 #include "android-base/utf8.h"
 #include "androidfw/StringPiece.h"
 #include "ziparchive/zip_writer.h"
+#include "zlib.h"
 
 #include "util/Files.h"
 
@@ -36,6 +37,12 @@ namespace aapt {
 
 namespace {
 
+// Whether data deflated to compressed_size from uncompressed_size is worth storing compressed.
+// This is preserving behavior of AAPT.
+bool CompressedEnough(size_t compressed_size, size_t uncompressed_size) {
+  return compressed_size + (compressed_size / 10) <= uncompressed_size;
+}
+
 class DirectoryWriter : public IArchiveWriter {
  public:
   DirectoryWriter() = default;
@@ -205,13 +212,12 @@ class ZipFileWriter : public IArchiveWriter {
         return false;
       }
 
-      // Check to see if the file was compressed enough. This is preserving behavior of AAPT.
+      // Check to see if the file was compressed enough.
       if ((flags & ArchiveEntry::kCompress) != 0 && in->CanRewind()) {
         ZipWriter::FileEntry last_entry;
         int32_t result = writer_->GetLastEntry(&last_entry);
         CHECK(result == 0);
-        if (last_entry.compressed_size + (last_entry.compressed_size / 10) >
-            last_entry.uncompressed_size) {
+        if (!CompressedEnough(last_entry.compressed_size, last_entry.uncompressed_size)) {
           // The file was not compressed enough, rewind and store it uncompressed.
           if (!in->Rewind()) {
             // Well we tried, may as well keep what we had.
@@ -256,6 +262,54 @@ class ZipFileWriter : public IArchiveWriter {
 
 }  // namespace
 
+bool IsWorthCompressing(io::InputStream* in) {
+  // Deflate the way ZipWriter does: raw, at the best compression.
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    return true;
+  }
+
+  // Only the size of the compressed data is needed, so it is written over the same buffer.
+  uint8_t out[32 * 1024];
+  size_t compressed_size = 0;
+  size_t uncompressed_size = 0;
+  const void* data = nullptr;
+  size_t len = 0;
+  int flush = Z_NO_FLUSH;
+  while (flush != Z_FINISH) {
+    if (in->Next(&data, &len)) {
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<void*>(data));
+      stream.avail_in = static_cast<uInt>(len);
+      uncompressed_size += len;
+    } else {
+      stream.next_in = nullptr;
+      stream.avail_in = 0;
+      flush = Z_FINISH;
+    }
+
+    int result;
+    do {
+      stream.next_out = out;
+      stream.avail_out = sizeof(out);
+      result = deflate(&stream, flush);
+      compressed_size += sizeof(out) - stream.avail_out;
+    } while (result == Z_OK && (stream.avail_in != 0 || stream.avail_out == 0));
+
+    if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+      // Leave it to the writer to find out.
+      compressed_size = 0;
+      break;
+    }
+  }
+  deflateEnd(&stream);
+
+  if (in->CanRewind()) {
+    in->Rewind();
+  }
+  return in->HadError() || CompressedEnough(compressed_size, uncompressed_size);
+}
+
 std::unique_ptr<IArchiveWriter> CreateDirectoryArchiveWriter(IDiagnostics* diag,
                                                              const StringPiece& path) {
   std::unique_ptr<DirectoryWriter> writer = util::make_unique<DirectoryWriter>();
@@ -70,6 +70,12 @@ class IArchiveWriter : public ::google::protobuf::io::CopyingOutputStream {
   virtual std::string GetError() const = 0;
 };
 
+// Returns whether the data of in deflates well enough to be kept compressed by a zip archive
+// writer. Entries written with ArchiveEntry::kCompress that don't are stored instead, after being
+// compressed once for nothing. This lets the check run ahead of time, e.g. on another thread, so
+// that entries not worth compressing are written with no flags. Rewinds in if it can be.
+bool IsWorthCompressing(io::InputStream* in);
+
 std::unique_ptr<IArchiveWriter> CreateDirectoryArchiveWriter(IDiagnostics* diag,
                                                              const android::StringPiece& path);
 
@@ -206,4 +206,21 @@ TEST_F(ArchiveTest, ZipFileWriteFileError) {
   ASSERT_EQ("ZipFileWriteFileError", writer->GetError());
 }
 
+TEST_F(ArchiveTest, IsWorthCompressing) {
+  std::unique_ptr<uint8_t[]> random = MakeTestArray();
+  TestData random_input(random, kTestDataLength);
+  EXPECT_FALSE(IsWorthCompressing(&random_input));
+
+  auto repeated = std::make_unique<uint8_t[]>(kTestDataLength);
+  std::fill(repeated.get(), repeated.get() + kTestDataLength, 'a');
+  TestData repeated_input(repeated, kTestDataLength);
+  EXPECT_TRUE(IsWorthCompressing(&repeated_input));
+
+  // The input is rewound for writing.
+  const void* data = nullptr;
+  size_t len = 0;
+  ASSERT_TRUE(repeated_input.Next(&data, &len));
+  EXPECT_EQ(kTestDataLength, len);
+}
+
 }  // namespace aapt
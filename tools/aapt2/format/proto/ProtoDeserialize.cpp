@@ -16,10 +16,14 @@
 
 #include "format/proto/ProtoDeserialize.h"
 
+#include <limits>
+
 #include "android-base/logging.h"
 #include "android-base/macros.h"
 #include "androidfw/ResourceTypes.h"
 #include "androidfw/Locale.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
 
 #include "ResourceTable.h"
 #include "ResourceUtils.h"
@@ -29,6 +33,7 @@
 using ::android::ConfigDescription;
 using ::android::LocaleValue;
 using ::android::ResStringPool;
+using ::android::StringPiece;
 
 using PolicyFlags = android::ResTable_overlayable_policy_header::PolicyFlags;
 
@@ -421,141 +426,157 @@ bool DeserializeOverlayableItemFromPb(const pb::OverlayableItem& pb_overlayable,
   return true;
 }
 
-static bool DeserializePackageFromPb(const pb::Package& pb_package, const ResStringPool& src_pool,
-                                     io::IFileCollection* files,
-                                     const std::vector<std::shared_ptr<Overlayable>>& overlayables,
-                                     ResourceTable* out_table, std::string* out_error) {
-  std::map<ResourceId, ResourceNameRef> id_index;
+// Deserializes a type of pb_package into pkg. The IDs of its entries are added to id_index.
+static bool DeserializeTypeFromPb(const pb::Package& pb_package, const pb::Type& pb_type,
+                                  const ResStringPool& src_pool, io::IFileCollection* files,
+                                  const std::vector<std::shared_ptr<Overlayable>>& overlayables,
+                                  ResourceTablePackage* pkg,
+                                  std::map<ResourceId, ResourceNameRef>* id_index,
+                                  ResourceTable* out_table, std::string* out_error) {
+  const ResourceType* res_type = ParseResourceType(pb_type.name());
+  if (res_type == nullptr) {
+    std::ostringstream error;
+    error << "unknown type '" << pb_type.name() << "'";
+    *out_error = error.str();
+    return false;
+  }
 
-  ResourceTablePackage* pkg = out_table->FindOrCreatePackage(pb_package.package_name());
-  for (const pb::Type& pb_type : pb_package.type()) {
-    const ResourceType* res_type = ParseResourceType(pb_type.name());
-    if (res_type == nullptr) {
-      std::ostringstream error;
-      error << "unknown type '" << pb_type.name() << "'";
-      *out_error = error.str();
-      return false;
-    }
+  ResourceTableType* type = pkg->FindOrCreateType(*res_type);
 
-    ResourceTableType* type = pkg->FindOrCreateType(*res_type);
+  for (const pb::Entry& pb_entry : pb_type.entry()) {
+    ResourceEntry* entry = type->CreateEntry(pb_entry.name());
+    const ResourceId resource_id(
+        pb_package.has_package_id() ? static_cast<uint8_t>(pb_package.package_id().id()) : 0u,
+        pb_type.has_type_id() ? static_cast<uint8_t>(pb_type.type_id().id()) : 0u,
+        pb_entry.has_entry_id() ? static_cast<uint16_t>(pb_entry.entry_id().id()) : 0u);
+    if (resource_id.id != 0u) {
+      entry->id = resource_id;
+    }
 
-    for (const pb::Entry& pb_entry : pb_type.entry()) {
-      ResourceEntry* entry = type->CreateEntry(pb_entry.name());
-      const ResourceId resource_id(
-          pb_package.has_package_id() ? static_cast<uint8_t>(pb_package.package_id().id()) : 0u,
-          pb_type.has_type_id() ? static_cast<uint8_t>(pb_type.type_id().id()) : 0u,
-          pb_entry.has_entry_id() ? static_cast<uint16_t>(pb_entry.entry_id().id()) : 0u);
-      if (resource_id.id != 0u) {
-        entry->id = resource_id;
+    // Deserialize the symbol status (public/private with source and comments).
+    if (pb_entry.has_visibility()) {
+      const pb::Visibility& pb_visibility = pb_entry.visibility();
+      if (pb_visibility.has_source()) {
+        DeserializeSourceFromPb(pb_visibility.source(), src_pool, &entry->visibility.source);
       }
-
-      // Deserialize the symbol status (public/private with source and comments).
-      if (pb_entry.has_visibility()) {
-        const pb::Visibility& pb_visibility = pb_entry.visibility();
-        if (pb_visibility.has_source()) {
-          DeserializeSourceFromPb(pb_visibility.source(), src_pool, &entry->visibility.source);
-        }
-        entry->visibility.comment = pb_visibility.comment();
-        entry->visibility.staged_api = pb_visibility.staged_api();
-
-        const Visibility::Level level = DeserializeVisibilityFromPb(pb_visibility.level());
-        entry->visibility.level = level;
-        if (level == Visibility::Level::kPublic) {
-          // Propagate the public visibility up to the Type.
-          type->visibility_level = Visibility::Level::kPublic;
-        } else if (level == Visibility::Level::kPrivate) {
-          // Only propagate if no previous state was assigned.
-          if (type->visibility_level == Visibility::Level::kUndefined) {
-            type->visibility_level = Visibility::Level::kPrivate;
-          }
+      entry->visibility.comment = pb_visibility.comment();
+      entry->visibility.staged_api = pb_visibility.staged_api();
+
+      const Visibility::Level level = DeserializeVisibilityFromPb(pb_visibility.level());
+      entry->visibility.level = level;
+      if (level == Visibility::Level::kPublic) {
+        // Propagate the public visibility up to the Type.
+        type->visibility_level = Visibility::Level::kPublic;
+      } else if (level == Visibility::Level::kPrivate) {
+        // Only propagate if no previous state was assigned.
+        if (type->visibility_level == Visibility::Level::kUndefined) {
+          type->visibility_level = Visibility::Level::kPrivate;
         }
       }
+    }
 
-      if (pb_entry.has_allow_new()) {
-        const pb::AllowNew& pb_allow_new = pb_entry.allow_new();
+    if (pb_entry.has_allow_new()) {
+      const pb::AllowNew& pb_allow_new = pb_entry.allow_new();
 
-        AllowNew allow_new;
-        if (pb_allow_new.has_source()) {
-          DeserializeSourceFromPb(pb_allow_new.source(), src_pool, &allow_new.source);
-        }
-        allow_new.comment = pb_allow_new.comment();
-        entry->allow_new = std::move(allow_new);
+      AllowNew allow_new;
+      if (pb_allow_new.has_source()) {
+        DeserializeSourceFromPb(pb_allow_new.source(), src_pool, &allow_new.source);
       }
+      allow_new.comment = pb_allow_new.comment();
+      entry->allow_new = std::move(allow_new);
+    }
 
-      if (pb_entry.has_overlayable_item()) {
-        // Find the overlayable to which this item belongs
-        pb::OverlayableItem pb_overlayable_item = pb_entry.overlayable_item();
-        if (pb_overlayable_item.overlayable_idx() >= overlayables.size()) {
-          *out_error =
-              android::base::StringPrintf("invalid overlayable_idx value %d for entry %s/%s",
-                                          pb_overlayable_item.overlayable_idx(),
-                                          pb_type.name().c_str(), pb_entry.name().c_str());
-          return false;
-        }
+    if (pb_entry.has_overlayable_item()) {
+      // Find the overlayable to which this item belongs
+      pb::OverlayableItem pb_overlayable_item = pb_entry.overlayable_item();
+      if (pb_overlayable_item.overlayable_idx() >= overlayables.size()) {
+        *out_error =
+            android::base::StringPrintf("invalid overlayable_idx value %d for entry %s/%s",
+                                        pb_overlayable_item.overlayable_idx(),
+                                        pb_type.name().c_str(), pb_entry.name().c_str());
+        return false;
+      }
 
-        OverlayableItem overlayable_item(overlayables[pb_overlayable_item.overlayable_idx()]);
-        if (!DeserializeOverlayableItemFromPb(pb_overlayable_item, src_pool, &overlayable_item,
-                                              out_error)) {
-          return false;
-        }
-        entry->overlayable_item = std::move(overlayable_item);
+      OverlayableItem overlayable_item(overlayables[pb_overlayable_item.overlayable_idx()]);
+      if (!DeserializeOverlayableItemFromPb(pb_overlayable_item, src_pool, &overlayable_item,
+                                            out_error)) {
+        return false;
       }
+      entry->overlayable_item = std::move(overlayable_item);
+    }
 
-      if (pb_entry.has_staged_id()) {
-        const pb::StagedId& pb_staged_id = pb_entry.staged_id();
+    if (pb_entry.has_staged_id()) {
+      const pb::StagedId& pb_staged_id = pb_entry.staged_id();
 
-        StagedId staged_id;
-        if (pb_staged_id.has_source()) {
-          DeserializeSourceFromPb(pb_staged_id.source(), src_pool, &staged_id.source);
-        }
-        staged_id.id = pb_staged_id.staged_id();
-        entry->staged_id = std::move(staged_id);
+      StagedId staged_id;
+      if (pb_staged_id.has_source()) {
+        DeserializeSourceFromPb(pb_staged_id.source(), src_pool, &staged_id.source);
       }
+      staged_id.id = pb_staged_id.staged_id();
+      entry->staged_id = std::move(staged_id);
+    }
 
-      ResourceId resid(pb_package.package_id().id(), pb_type.type_id().id(),
-                       pb_entry.entry_id().id());
-      if (resid.is_valid()) {
-        id_index[resid] = ResourceNameRef(pkg->name, type->type, entry->name);
-      }
+    ResourceId resid(pb_package.package_id().id(), pb_type.type_id().id(),
+                     pb_entry.entry_id().id());
+    if (resid.is_valid()) {
+      (*id_index)[resid] = ResourceNameRef(pkg->name, type->type, entry->name);
+    }
 
-      for (const pb::ConfigValue& pb_config_value : pb_entry.config_value()) {
-        const pb::Configuration& pb_config = pb_config_value.config();
+    for (const pb::ConfigValue& pb_config_value : pb_entry.config_value()) {
+      const pb::Configuration& pb_config = pb_config_value.config();
 
-        ConfigDescription config;
-        if (!DeserializeConfigFromPb(pb_config, &config, out_error)) {
-          return false;
-        }
+      ConfigDescription config;
+      if (!DeserializeConfigFromPb(pb_config, &config, out_error)) {
+        return false;
+      }
 
-        ResourceConfigValue* config_value = entry->FindOrCreateValue(config, pb_config.product());
-        if (config_value->value != nullptr) {
-          *out_error = "duplicate configuration in resource table";
-          return false;
-        }
+      ResourceConfigValue* config_value = entry->FindOrCreateValue(config, pb_config.product());
+      if (config_value->value != nullptr) {
+        *out_error = "duplicate configuration in resource table";
+        return false;
+      }
 
-        config_value->value = DeserializeValueFromPb(pb_config_value.value(), src_pool, config,
-                                                     &out_table->string_pool, files, out_error);
-        if (config_value->value == nullptr) {
-          return false;
-        }
+      config_value->value = DeserializeValueFromPb(pb_config_value.value(), src_pool, config,
+                                                   &out_table->string_pool, files, out_error);
+      if (config_value->value == nullptr) {
+        return false;
       }
     }
   }
+  return true;
+}
+
+static bool DeserializePackageFromPb(const pb::Package& pb_package, const ResStringPool& src_pool,
+                                     io::IFileCollection* files,
+                                     const std::vector<std::shared_ptr<Overlayable>>& overlayables,
+                                     ResourceTable* out_table, std::string* out_error) {
+  std::map<ResourceId, ResourceNameRef> id_index;
+
+  ResourceTablePackage* pkg = out_table->FindOrCreatePackage(pb_package.package_name());
+  for (const pb::Type& pb_type : pb_package.type()) {
+    if (!DeserializeTypeFromPb(pb_package, pb_type, src_pool, files, overlayables, pkg, &id_index,
+                               out_table, out_error)) {
+      return false;
+    }
+  }
 
   ReferenceIdToNameVisitor visitor(&id_index);
   VisitAllValuesInPackage(pkg, &visitor);
   return true;
 }
 
-bool DeserializeTableFromPb(const pb::ResourceTable& pb_table, io::IFileCollection* files,
-                            ResourceTable* out_table, std::string* out_error) {
+// Deserializes what the packages of pb_table share. The out_source_pool refers to the data of
+// pb_table.
+static bool DeserializeTableHeaderFromPb(
+    const pb::ResourceTable& pb_table, ResStringPool* out_source_pool,
+    std::vector<std::shared_ptr<Overlayable>>* out_overlayables, std::string* out_error) {
   // We import the android namespace because on Windows NO_ERROR is a macro, not an enum, which
   // causes errors when qualifying it with android::
   using namespace android;
 
-  ResStringPool source_pool;
   if (pb_table.has_source_pool()) {
-    status_t result = source_pool.setTo(pb_table.source_pool().data().data(),
-                                        pb_table.source_pool().data().size());
+    status_t result = out_source_pool->setTo(pb_table.source_pool().data().data(),
+                                             pb_table.source_pool().data().size());
     if (result != NO_ERROR) {
       *out_error = "invalid source pool";
       return false;
@@ -563,13 +584,22 @@ bool DeserializeTableFromPb(const pb::ResourceTable& pb_table, io::IFileCollecti
   }
 
   // Deserialize the overlayable groups of the table
-  std::vector<std::shared_ptr<Overlayable>> overlayables;
   for (const pb::Overlayable& pb_overlayable : pb_table.overlayable()) {
     auto group = std::make_shared<Overlayable>(pb_overlayable.name(), pb_overlayable.actor());
     if (pb_overlayable.has_source()) {
-      DeserializeSourceFromPb(pb_overlayable.source(), source_pool, &group->source);
+      DeserializeSourceFromPb(pb_overlayable.source(), *out_source_pool, &group->source);
     }
-    overlayables.push_back(group);
+    out_overlayables->push_back(group);
+  }
+  return true;
+}
+
+bool DeserializeTableFromPb(const pb::ResourceTable& pb_table, io::IFileCollection* files,
+                            ResourceTable* out_table, std::string* out_error) {
+  ResStringPool source_pool;
+  std::vector<std::shared_ptr<Overlayable>> overlayables;
+  if (!DeserializeTableHeaderFromPb(pb_table, &source_pool, &overlayables, out_error)) {
+    return false;
   }
 
   for (const pb::Package& pb_package : pb_table.package()) {
@@ -581,6 +611,97 @@ bool DeserializeTableFromPb(const pb::ResourceTable& pb_table, io::IFileCollecti
   return true;
 }
 
+// Splits the serialized message in data into the values of its field_number fields, which must be
+// length delimited, and the serialization of all of its other fields. This lets the other fields be
+// parsed on their own, and the values of the field one at a time, in the order they appear.
+static bool SplitFieldFromPb(const StringPiece& data, int field_number,
+                             std::vector<StringPiece>* out_values, std::string* out_rest) {
+  using ::google::protobuf::io::CodedInputStream;
+  using ::google::protobuf::internal::WireFormatLite;
+
+  if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    return false;
+  }
+
+  const auto bytes = reinterpret_cast<const uint8_t*>(data.data());
+  CodedInputStream in(bytes, static_cast<int>(data.size()));
+  in.SetTotalBytesLimit(std::numeric_limits<int32_t>::max(), in.BytesUntilTotalBytesLimit());
+  while (true) {
+    const int start = in.CurrentPosition();
+    const uint32_t tag = in.ReadTag();
+    if (tag == 0) {
+      return static_cast<size_t>(start) == data.size();
+    }
+
+    if (WireFormatLite::GetTagFieldNumber(tag) == field_number &&
+        WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      uint32_t length;
+      if (!in.ReadVarint32(&length)) {
+        return false;
+      }
+      const int offset = in.CurrentPosition();
+      if (!in.Skip(static_cast<int>(length))) {
+        return false;
+      }
+      out_values->push_back(data.substr(offset, length));
+    } else {
+      if (!WireFormatLite::SkipField(&in, tag)) {
+        return false;
+      }
+      out_rest->append(data.data() + start, in.CurrentPosition() - start);
+    }
+  }
+}
+
+bool DeserializeTableFromPb(const StringPiece& data, io::IFileCollection* files,
+                            ResourceTable* out_table, std::string* out_error) {
+  std::vector<StringPiece> pb_packages;
+  std::string serialized_table;
+  pb::ResourceTable pb_table;
+  if (!SplitFieldFromPb(data, pb::ResourceTable::kPackageFieldNumber, &pb_packages,
+                        &serialized_table) ||
+      !pb_table.ParseFromString(serialized_table)) {
+    *out_error = "invalid resource table";
+    return false;
+  }
+
+  ResStringPool source_pool;
+  std::vector<std::shared_ptr<Overlayable>> overlayables;
+  if (!DeserializeTableHeaderFromPb(pb_table, &source_pool, &overlayables, out_error)) {
+    return false;
+  }
+
+  for (const StringPiece& pb_package_data : pb_packages) {
+    std::vector<StringPiece> pb_types;
+    std::string serialized_package;
+    pb::Package pb_package;
+    if (!SplitFieldFromPb(pb_package_data, pb::Package::kTypeFieldNumber, &pb_types,
+                          &serialized_package) ||
+        !pb_package.ParseFromString(serialized_package)) {
+      *out_error = "invalid package";
+      return false;
+    }
+
+    std::map<ResourceId, ResourceNameRef> id_index;
+    ResourceTablePackage* pkg = out_table->FindOrCreatePackage(pb_package.package_name());
+    for (const StringPiece& pb_type_data : pb_types) {
+      pb::Type pb_type;
+      if (!pb_type.ParseFromArray(pb_type_data.data(), static_cast<int>(pb_type_data.size()))) {
+        *out_error = "invalid type";
+        return false;
+      }
+      if (!DeserializeTypeFromPb(pb_package, pb_type, source_pool, files, overlayables, pkg,
+                                 &id_index, out_table, out_error)) {
+        return false;
+      }
+    }
+
+    ReferenceIdToNameVisitor visitor(&id_index);
+    VisitAllValuesInPackage(pkg, &visitor);
+  }
+  return true;
+}
+
 static ResourceFile::Type DeserializeFileReferenceTypeFromPb(const pb::FileReference::Type& type) {
   switch (type) {
     case pb::FileReference::BINARY_XML:
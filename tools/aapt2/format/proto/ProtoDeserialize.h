@@ -20,6 +20,7 @@
 #include "android-base/macros.h"
 #include "androidfw/ConfigDescription.h"
 #include "androidfw/ResourceTypes.h"
+#include "androidfw/StringPiece.h"
 
 #include "Configuration.pb.h"
 #include "ResourceTable.h"
@@ -57,6 +58,11 @@ bool DeserializeConfigFromPb(const pb::Configuration& pb_config,
 bool DeserializeTableFromPb(const pb::ResourceTable& pb_table, io::IFileCollection* files,
                             ResourceTable* out_table, std::string* out_error);
 
+// Deserializes the serialized pb::ResourceTable in data a type at a time, so that the whole
+// pb::ResourceTable is never held in memory.
+bool DeserializeTableFromPb(const android::StringPiece& data, io::IFileCollection* files,
+                            ResourceTable* out_table, std::string* out_error);
+
 bool DeserializeCompiledFileFromPb(const pb::internal::CompiledFile& pb_file,
                                    ResourceFile* out_file, std::string* out_error);
 
@@ -16,6 +16,9 @@
 
 #include "format/proto/ProtoSerialize.h"
 
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+
 #include "ValueVisitor.h"
 #include "util/BigBuffer.h"
 
@@ -336,93 +339,153 @@ static void SerializeOverlayableItemToPb(const OverlayableItem& overlayable_item
   pb_overlayable_item->set_comment(overlayable_item.comment);
 }
 
-void SerializeTableToPb(const ResourceTable& table, pb::ResourceTable* out_table,
-                        IDiagnostics* diag, SerializeTableOptions options) {
-  auto source_pool = (options.exclude_sources) ? nullptr : util::make_unique<StringPool>();
+// Serializes a type of the table. The overlayables its entries belong to are added to pb_table.
+static void SerializeTypeToPb(const ResourceTableTypeView& type,
+                              const SerializeTableOptions& options,
+                              std::vector<Overlayable*>& overlayables, StringPool* source_pool,
+                              pb::Type* pb_type, pb::ResourceTable* pb_table) {
+  if (type.id) {
+    pb_type->mutable_type_id()->set_id(type.id.value());
+  }
+  pb_type->set_name(to_string(type.type).to_string());
+
+  // hardcoded string uses characters which make it an invalid resource name
+  static const char* obfuscated_resource_name = "0_resource_name_obfuscated";
+  for (const auto& entry : type.entries) {
+    pb::Entry* pb_entry = pb_type->add_entry();
+    if (entry.id) {
+      pb_entry->mutable_entry_id()->set_id(entry.id.value());
+    }
+    ResourceName resource_name({}, type.type, entry.name);
+    if (options.collapse_key_stringpool &&
+        options.name_collapse_exemptions.find(resource_name) ==
+        options.name_collapse_exemptions.end()) {
+      pb_entry->set_name(obfuscated_resource_name);
+    } else {
+      pb_entry->set_name(entry.name);
+    }
+
+    // Write the Visibility struct.
+    pb::Visibility* pb_visibility = pb_entry->mutable_visibility();
+    pb_visibility->set_staged_api(entry.visibility.staged_api);
+    pb_visibility->set_level(SerializeVisibilityToPb(entry.visibility.level));
+    if (source_pool != nullptr) {
+      SerializeSourceToPb(entry.visibility.source, source_pool, pb_visibility->mutable_source());
+    }
+    pb_visibility->set_comment(entry.visibility.comment);
+
+    if (entry.allow_new) {
+      pb::AllowNew* pb_allow_new = pb_entry->mutable_allow_new();
+      if (source_pool != nullptr) {
+        SerializeSourceToPb(entry.allow_new.value().source, source_pool,
+                            pb_allow_new->mutable_source());
+      }
+      pb_allow_new->set_comment(entry.allow_new.value().comment);
+    }
+
+    if (entry.overlayable_item) {
+      SerializeOverlayableItemToPb(entry.overlayable_item.value(), overlayables, source_pool,
+                                   pb_entry, pb_table);
+    }
+
+    if (entry.staged_id) {
+      pb::StagedId* pb_staged_id = pb_entry->mutable_staged_id();
+      if (source_pool != nullptr) {
+        SerializeSourceToPb(entry.staged_id.value().source, source_pool,
+                            pb_staged_id->mutable_source());
+      }
+      pb_staged_id->set_staged_id(entry.staged_id.value().id.id);
+    }
+
+    for (const ResourceConfigValue* config_value : entry.values) {
+      pb::ConfigValue* pb_config_value = pb_entry->add_config_value();
+      SerializeConfig(config_value->config, pb_config_value->mutable_config());
+      pb_config_value->mutable_config()->set_product(config_value->product);
+      SerializeValueToPb(*config_value->value, pb_config_value->mutable_value(), source_pool);
+    }
+  }
+}
+
+static void SerializePackageHeaderToPb(const ResourceTablePackageView& package,
+                                       pb::Package* pb_package) {
+  if (package.id) {
+    pb_package->mutable_package_id()->set_id(package.id.value());
+  }
+  pb_package->set_package_name(package.name);
+}
 
-  pb::ToolFingerprint* pb_fingerprint = out_table->add_tool_fingerprint();
+static void SerializeToolFingerprintToPb(pb::ResourceTable* pb_table) {
+  pb::ToolFingerprint* pb_fingerprint = pb_table->add_tool_fingerprint();
   pb_fingerprint->set_tool(util::GetToolName());
   pb_fingerprint->set_version(util::GetToolFingerprint());
+}
+
+void SerializeTableToPb(const ResourceTable& table, pb::ResourceTable* out_table,
+                        IDiagnostics* diag, SerializeTableOptions options) {
+  auto source_pool = (options.exclude_sources) ? nullptr : util::make_unique<StringPool>();
+  SerializeToolFingerprintToPb(out_table);
 
   std::vector<Overlayable*> overlayables;
   auto table_view = table.GetPartitionedView();
   for (const auto& package : table_view.packages) {
     pb::Package* pb_package = out_table->add_package();
-    if (package.id) {
-      pb_package->mutable_package_id()->set_id(package.id.value());
+    SerializePackageHeaderToPb(package, pb_package);
+    for (const auto& type : package.types) {
+      SerializeTypeToPb(type, options, overlayables, source_pool.get(), pb_package->add_type(),
+                        out_table);
     }
-    pb_package->set_package_name(package.name);
+  }
 
-    for (const auto& type : package.types) {
-      pb::Type* pb_type = pb_package->add_type();
-      if (type.id) {
-        pb_type->mutable_type_id()->set_id(type.id.value());
-      }
-      pb_type->set_name(to_string(type.type).to_string());
-
-      // hardcoded string uses characters which make it an invalid resource name
-      static const char* obfuscated_resource_name = "0_resource_name_obfuscated";
-      for (const auto& entry : type.entries) {
-        pb::Entry* pb_entry = pb_type->add_entry();
-        if (entry.id) {
-          pb_entry->mutable_entry_id()->set_id(entry.id.value());
-        }
-        ResourceName resource_name({}, type.type, entry.name);
-        if (options.collapse_key_stringpool &&
-            options.name_collapse_exemptions.find(resource_name) ==
-            options.name_collapse_exemptions.end()) {
-          pb_entry->set_name(obfuscated_resource_name);
-        } else {
-          pb_entry->set_name(entry.name);
-        }
+  if (source_pool != nullptr) {
+    SerializeStringPoolToPb(*source_pool, out_table->mutable_source_pool(), diag);
+  }
+}
 
-        // Write the Visibility struct.
-        pb::Visibility* pb_visibility = pb_entry->mutable_visibility();
-        pb_visibility->set_staged_api(entry.visibility.staged_api);
-        pb_visibility->set_level(SerializeVisibilityToPb(entry.visibility.level));
-        if (source_pool != nullptr) {
-          SerializeSourceToPb(entry.visibility.source, source_pool.get(),
-                              pb_visibility->mutable_source());
-        }
-        pb_visibility->set_comment(entry.visibility.comment);
-
-        if (entry.allow_new) {
-          pb::AllowNew* pb_allow_new = pb_entry->mutable_allow_new();
-          if (source_pool != nullptr) {
-            SerializeSourceToPb(entry.allow_new.value().source, source_pool.get(),
-                                pb_allow_new->mutable_source());
-          }
-          pb_allow_new->set_comment(entry.allow_new.value().comment);
-        }
+bool SerializeTableToPb(const ResourceTable& table,
+                        ::google::protobuf::io::ZeroCopyOutputStream* out, IDiagnostics* diag,
+                        SerializeTableOptions options) {
+  using ::google::protobuf::io::CodedOutputStream;
+  using ::google::protobuf::internal::WireFormatLite;
 
-        if (entry.overlayable_item) {
-          SerializeOverlayableItemToPb(entry.overlayable_item.value(), overlayables,
-                                       source_pool.get(), pb_entry, out_table);
-        }
+  auto source_pool = (options.exclude_sources) ? nullptr : util::make_unique<StringPool>();
 
-        if (entry.staged_id) {
-          pb::StagedId* pb_staged_id = pb_entry->mutable_staged_id();
-          if (source_pool != nullptr) {
-            SerializeSourceToPb(entry.staged_id.value().source, source_pool.get(),
-                                pb_staged_id->mutable_source());
-          }
-          pb_staged_id->set_staged_id(entry.staged_id.value().id.id);
-        }
+  // Holds all but the packages, which is written after them once the source pool is complete.
+  pb::ResourceTable pb_table;
+  SerializeToolFingerprintToPb(&pb_table);
 
-        for (const ResourceConfigValue* config_value : entry.values) {
-          pb::ConfigValue* pb_config_value = pb_entry->add_config_value();
-          SerializeConfig(config_value->config, pb_config_value->mutable_config());
-          pb_config_value->mutable_config()->set_product(config_value->product);
-          SerializeValueToPb(*config_value->value, pb_config_value->mutable_value(),
-                             source_pool.get());
-        }
-      }
+  CodedOutputStream coded_out(out);
+  std::vector<Overlayable*> overlayables;
+  auto table_view = table.GetPartitionedView();
+  for (const auto& package : table_view.packages) {
+    pb::Package pb_package;
+    SerializePackageHeaderToPb(package, &pb_package);
+
+    // Only one type is held as a message at a time. The serialized types of the package are kept
+    // until its size, which precedes it, is known, so the peak is the serialized package.
+    std::vector<std::string> serialized_types;
+    size_t package_size = pb_package.ByteSizeLong();
+    for (const auto& type : package.types) {
+      pb::Type pb_type;
+      SerializeTypeToPb(type, options, overlayables, source_pool.get(), &pb_type, &pb_table);
+      serialized_types.push_back(pb_type.SerializeAsString());
+      package_size += WireFormatLite::TagSize(pb::Package::kTypeFieldNumber,
+                                              WireFormatLite::TYPE_BYTES) +
+                      WireFormatLite::LengthDelimitedSize(serialized_types.back().size());
+    }
+
+    coded_out.WriteTag(WireFormatLite::MakeTag(pb::ResourceTable::kPackageFieldNumber,
+                                               WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    coded_out.WriteVarint64(package_size);
+    pb_package.SerializeWithCachedSizes(&coded_out);
+    for (const std::string& serialized_type : serialized_types) {
+      WireFormatLite::WriteBytes(pb::Package::kTypeFieldNumber, serialized_type, &coded_out);
     }
   }
 
   if (source_pool != nullptr) {
-    SerializeStringPoolToPb(*source_pool, out_table->mutable_source_pool(), diag);
+    SerializeStringPoolToPb(*source_pool, pb_table.mutable_source_pool(), diag);
   }
+  return pb_table.SerializeToCodedStream(&coded_out) && !coded_out.HadError();
 }
 
 static pb::Reference_Type SerializeReferenceTypeToPb(Reference::Type type) {
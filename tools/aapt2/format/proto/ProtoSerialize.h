@@ -19,6 +19,7 @@
 
 #include "android-base/macros.h"
 #include "androidfw/ConfigDescription.h"
+#include "google/protobuf/io/zero_copy_stream.h"
 
 #include "Configuration.pb.h"
 #include "ResourceTable.h"
@@ -76,6 +77,15 @@ void SerializeConfig(const android::ConfigDescription& config, pb::Configuration
 void SerializeTableToPb(const ResourceTable& table, pb::ResourceTable* out_table,
                         IDiagnostics* diag, SerializeTableOptions options = {});
 
+// Writes the protobuf representation of a ResourceTable to out a package at a time. Only one type
+// is held as a message at a time, but the serialized types of a package are held until the package
+// is written, as its size precedes them. So memory still grows with the largest package, by its
+// serialized size. The output parses to the same pb::ResourceTable, though its fields are in a
+// different order. Returns false if writing to out failed.
+bool SerializeTableToPb(const ResourceTable& table,
+                        ::google::protobuf::io::ZeroCopyOutputStream* out, IDiagnostics* diag,
+                        SerializeTableOptions options = {});
+
 // Serializes a ResourceFile into its protobuf representation.
 void SerializeCompiledFileToPb(const ResourceFile& file, pb::internal::CompiledFile* out_file);
 
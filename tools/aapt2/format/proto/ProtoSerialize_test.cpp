@@ -16,6 +16,8 @@
 
 #include "format/proto/ProtoSerialize.h"
 
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+
 #include "ResourceUtils.h"
 #include "format/proto/ProtoDeserialize.h"
 #include "test/Test.h"
@@ -951,4 +953,67 @@ TEST(ProtoSerializeTest, StagedId) {
   EXPECT_THAT(result.value().entry->staged_id.value().id, Eq(ResourceId(0x01ff0001)));
 }
 
+TEST(ProtoSerializeTest, SerializeAndDeserializeTableStream) {
+  OverlayableItem overlayable_item(std::make_shared<Overlayable>(
+      "OverlayableName", "overlay://theme", Source("res/values/overlayable.xml", 40)));
+  overlayable_item.policies |= PolicyFlags::PUBLIC;
+
+  // A reference with only an ID gets its name from the table once it is deserialized.
+  auto reference = util::make_unique<Reference>();
+  reference->id = ResourceId(0x7f020000);
+
+  std::unique_ptr<IAaptContext> context = test::ContextBuilder().Build();
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddSimple("com.app.a:bool/foo", ResourceId(0x7f020000))
+          .AddValue("com.app.a:integer/bar", ResourceId(0x7f030000), std::move(reference))
+          .AddString("com.app.a:string/text", ResourceId(0x7f040000), "hi")
+          .SetOverlayable("com.app.a:bool/foo", overlayable_item)
+          .AddString("com.app.b:string/text", ResourceId(0x80040000), "hello")
+          .Build();
+
+  pb::ResourceTable pb_table;
+  SerializeTableToPb(*table, &pb_table, context->GetDiagnostics());
+
+  std::string streamed_table;
+  {
+    ::google::protobuf::io::StringOutputStream out(&streamed_table);
+    ASSERT_TRUE(SerializeTableToPb(*table, &out, context->GetDiagnostics()));
+  }
+
+  // The fields are written in another order, but they are the same.
+  pb::ResourceTable pb_streamed_table;
+  ASSERT_TRUE(pb_streamed_table.ParseFromString(streamed_table));
+  EXPECT_THAT(pb_streamed_table.SerializeAsString(), Eq(pb_table.SerializeAsString()));
+
+  // Either order deserializes the same.
+  for (const std::string& data : {streamed_table, pb_table.SerializeAsString()}) {
+    ResourceTable new_table;
+    std::string error;
+    ASSERT_TRUE(DeserializeTableFromPb(data, nullptr /*files*/, &new_table, &error)) << error;
+    EXPECT_THAT(error, IsEmpty());
+
+    String* str = test::GetValue<String>(&new_table, "com.app.b:string/text");
+    ASSERT_THAT(str, NotNull());
+    EXPECT_THAT(*str->value, Eq("hello"));
+
+    Reference* ref = test::GetValue<Reference>(&new_table, "com.app.a:integer/bar");
+    ASSERT_THAT(ref, NotNull());
+    ASSERT_TRUE(ref->name);
+    EXPECT_THAT(ref->name.value(), Eq(test::ParseNameOrDie("com.app.a:bool/foo")));
+
+    ResourceEntry* entry = GetEntry(&new_table, test::ParseNameOrDie("com.app.a:bool/foo"));
+    ASSERT_THAT(entry, NotNull());
+    ASSERT_TRUE(entry->overlayable_item);
+    EXPECT_THAT(entry->overlayable_item.value().overlayable->name, Eq("OverlayableName"));
+    EXPECT_THAT(entry->overlayable_item.value().overlayable->source.path,
+                Eq("res/values/overlayable.xml"));
+  }
+
+  ResourceTable new_table;
+  std::string error;
+  EXPECT_FALSE(DeserializeTableFromPb(streamed_table.substr(0, streamed_table.size() - 1),
+                                      nullptr /*files*/, &new_table, &error));
+}
+
 }  // namespace aapt
@@ -40,9 +40,10 @@ class IData : public KnownSizeInputStream {
   }
 };
 
+// A view of part of another IData. Several segments can share the data they view.
 class DataSegment : public IData {
  public:
-  explicit DataSegment(std::unique_ptr<IData> data, size_t offset, size_t len)
+  explicit DataSegment(std::shared_ptr<const IData> data, size_t offset, size_t len)
       : data_(std::move(data)), offset_(offset), len_(len), next_read_(offset) {}
   virtual ~DataSegment() = default;
 
@@ -84,7 +85,7 @@ class DataSegment : public IData {
  private:
   DISALLOW_COPY_AND_ASSIGN(DataSegment);
 
-  std::unique_ptr<IData> data_;
+  std::shared_ptr<const IData> data_;
   size_t offset_;
   size_t len_;
   size_t next_read_;
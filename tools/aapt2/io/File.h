@@ -105,6 +105,11 @@ class IFileCollection {
   virtual IFile* FindFile(const android::StringPiece& path) = 0;
   virtual std::unique_ptr<IFileCollectionIterator> Iterator() = 0;
   virtual char GetDirSeparator() = 0;
+
+  // Reads files of this collection ahead of their next OpenAsData(), using up to jobs threads.
+  // Only worth doing for collections whose files are costly to open, so it does nothing by default.
+  virtual void Prefetch(const std::vector<IFile*>& files, size_t jobs) {
+  }
 };
 
 }  // namespace io
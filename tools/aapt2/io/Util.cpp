@@ -61,6 +61,16 @@ bool CopyFileToArchivePreserveCompression(IAaptContext* context, io::IFile* file
 bool CopyProtoToArchive(IAaptContext* context, ::google::protobuf::Message* proto_msg,
                         const std::string& out_path, uint32_t compression_flags,
                         IArchiveWriter* writer) {
+  return CopyProtoStreamToArchive(
+      context,
+      [&](ZeroCopyOutputStream* out) { return proto_msg->SerializeToZeroCopyStream(out); },
+      out_path, compression_flags, writer);
+}
+
+bool CopyProtoStreamToArchive(IAaptContext* context,
+                              const std::function<bool(ZeroCopyOutputStream*)>& serialize,
+                              const std::string& out_path, uint32_t compression_flags,
+                              IArchiveWriter* writer) {
   TRACE_CALL();
   if (context->IsVerbose()) {
     context->GetDiagnostics()->Note(DiagMessage() << "writing " << out_path << " to archive");
@@ -71,7 +81,7 @@ bool CopyProtoToArchive(IAaptContext* context, ::google::protobuf::Message* prot
     {
       // Wrap our IArchiveWriter with an adaptor that implements the ZeroCopyOutputStream interface.
       ::google::protobuf::io::CopyingOutputStreamAdaptor adaptor(writer);
-      if (!proto_msg->SerializeToZeroCopyStream(&adaptor)) {
+      if (!serialize(&adaptor)) {
         context->GetDiagnostics()->Error(DiagMessage() << "failed to write " << out_path
                                                        << " to archive");
         return false;
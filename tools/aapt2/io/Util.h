@@ -17,6 +17,7 @@
 #ifndef AAPT_IO_UTIL_H
 #define AAPT_IO_UTIL_H
 
+#include <functional>
 #include <string>
 
 #include "google/protobuf/message.h"
@@ -43,6 +44,13 @@ bool CopyProtoToArchive(IAaptContext* context, ::google::protobuf::Message* prot
                         const std::string& out_path, uint32_t compression_flags,
                         IArchiveWriter* writer);
 
+// Writes whatever serialize writes to the stream it is given to out_path, so that protobuf data can
+// be written a part at a time rather than as a single message. serialize returns false on error.
+bool CopyProtoStreamToArchive(
+    IAaptContext* context,
+    const std::function<bool(::google::protobuf::io::ZeroCopyOutputStream*)>& serialize,
+    const std::string& out_path, uint32_t compression_flags, IArchiveWriter* writer);
+
 // Copies the data from in to out. Returns false if there was an error.
 // If there was an error, check the individual streams' HadError/GetError methods.
 bool Copy(OutputStream* out, InputStream* in);
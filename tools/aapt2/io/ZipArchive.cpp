@@ -16,8 +16,15 @@
 
 #include "io/ZipArchive.h"
 
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "utils/FileMap.h"
 #include "ziparchive/zip_archive.h"
+#include "zlib.h"
 
 #include "Source.h"
 #include "trace/TraceBuffer.h"
@@ -30,15 +37,66 @@ namespace aapt {
 namespace io {
 
 ZipFile::ZipFile(ZipArchiveHandle handle, const ZipEntry& entry,
-                 const Source& source)
-    : zip_handle_(handle), zip_entry_(entry), source_(source) {}
+                 const Source& source, std::shared_ptr<const IData> archive_data)
+    : zip_handle_(handle), zip_entry_(entry), source_(source),
+      archive_data_(std::move(archive_data)) {}
+
+bool ZipFile::IsInArchiveData() const {
+  if (archive_data_ == nullptr || zip_entry_.offset < 0) {
+    return false;
+  }
+  const size_t length = zip_entry_.method == kCompressStored ? zip_entry_.uncompressed_length
+                                                             : zip_entry_.compressed_length;
+  const size_t offset = static_cast<size_t>(zip_entry_.offset);
+  return offset <= archive_data_->size() && length <= archive_data_->size() - offset;
+}
+
+std::unique_ptr<IData> ZipFile::InflateFromArchiveData() const {
+  const size_t length = zip_entry_.uncompressed_length;
+  std::unique_ptr<uint8_t[]> data = std::unique_ptr<uint8_t[]>(new uint8_t[length]);
+
+  z_stream stream = {};
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+    return {};
+  }
+  stream.next_in = const_cast<Bytef*>(
+      static_cast<const Bytef*>(archive_data_->data()) + zip_entry_.offset);
+  stream.avail_in = zip_entry_.compressed_length;
+  stream.next_out = data.get();
+  stream.avail_out = length;
+  const int result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+
+  // Check the data as ExtractToMemory() would.
+  if (result != Z_STREAM_END || stream.total_out != length ||
+      crc32(0, data.get(), length) != zip_entry_.crc32) {
+    return {};
+  }
+  return util::make_unique<MallocData>(std::move(data), length);
+}
 
 std::unique_ptr<IData> ZipFile::OpenAsData() {
+  {
+    std::lock_guard<std::mutex> guard(prefetch_lock_);
+    if (prefetched_data_ != nullptr) {
+      return std::move(prefetched_data_);
+    }
+  }
+
   // The file will fail to be mmaped if it is empty
   if (zip_entry_.uncompressed_length == 0) {
     return util::make_unique<EmptyData>();
   }
 
+  if (IsInArchiveData()) {
+    if (zip_entry_.method == kCompressStored) {
+      return util::make_unique<DataSegment>(archive_data_, zip_entry_.offset,
+                                            zip_entry_.uncompressed_length);
+    } else if (zip_entry_.method == kCompressDeflated) {
+      return InflateFromArchiveData();
+    }
+  }
+
   if (zip_entry_.method == kCompressStored) {
     int fd = GetFileDescriptor(zip_handle_);
 
@@ -53,6 +111,10 @@ std::unique_ptr<IData> ZipFile::OpenAsData() {
   } else {
     std::unique_ptr<uint8_t[]> data =
         std::unique_ptr<uint8_t[]>(new uint8_t[zip_entry_.uncompressed_length]);
+
+    // Entries are extracted through a handle one at a time.
+    static std::mutex extract_lock;
+    std::lock_guard<std::mutex> guard(extract_lock);
     int32_t result =
         ExtractToMemory(zip_handle_, &zip_entry_, data.get(),
                         static_cast<uint32_t>(zip_entry_.uncompressed_length));
@@ -113,6 +175,16 @@ std::unique_ptr<ZipFileCollection> ZipFileCollection::Create(
     return {};
   }
 
+  // Map the whole archive once, rather than each stored file on its own when opened.
+  const int fd = GetFileDescriptor(collection->handle_);
+  struct stat sb;
+  if (fstat(fd, &sb) == 0 && sb.st_size > 0) {
+    android::FileMap file_map;
+    if (file_map.create(nullptr, fd, 0, static_cast<size_t>(sb.st_size), true)) {
+      collection->archive_data_ = std::make_shared<MmappedData>(std::move(file_map));
+    }
+  }
+
   void* cookie = nullptr;
   result = StartIteration(collection->handle_, &cookie);
   if (result != 0) {
@@ -132,7 +204,7 @@ std::unique_ptr<ZipFileCollection> ZipFileCollection::Create(
     }
 
     std::unique_ptr<IFile> file = util::make_unique<ZipFile>(collection->handle_, zip_data,
-        Source(zip_entry_path, path.to_string()));
+        Source(zip_entry_path, path.to_string()), collection->archive_data_);
     collection->files_by_name_[zip_entry_path] = file.get();
     collection->files_.push_back(std::move(file));
   }
@@ -164,6 +236,51 @@ char ZipFileCollection::GetDirSeparator() {
   return '/';
 }
 
+void ZipFileCollection::Prefetch(const std::vector<IFile*>& files, size_t jobs) {
+  TRACE_CALL();
+  if (archive_data_ == nullptr || jobs <= 1) {
+    return;
+  }
+
+  std::vector<ZipFile*> to_inflate;
+  for (IFile* file : files) {
+    // Only the files of this collection are ZipFiles that can be inflated from archive_data_.
+    if (file == nullptr || FindFile(file->GetSource().path) != file) {
+      continue;
+    }
+    ZipFile* zip_file = static_cast<ZipFile*>(file);
+    if (zip_file->zip_entry_.uncompressed_length != 0 &&
+        zip_file->zip_entry_.method == kCompressDeflated && zip_file->IsInArchiveData()) {
+      to_inflate.push_back(zip_file);
+    }
+  }
+
+  // Each file is inflated by one thread only. Any that fail are extracted again when opened.
+  std::atomic<size_t> next_file(0);
+  auto worker = [&]() {
+    for (size_t i = next_file++; i < to_inflate.size(); i = next_file++) {
+      ZipFile* zip_file = to_inflate[i];
+      {
+        // Another thread may have prefetched the file already, e.g. for an APK of its own.
+        std::lock_guard<std::mutex> guard(zip_file->prefetch_lock_);
+        if (zip_file->prefetched_data_ != nullptr) {
+          continue;
+        }
+      }
+      std::unique_ptr<IData> data = zip_file->InflateFromArchiveData();
+      std::lock_guard<std::mutex> guard(zip_file->prefetch_lock_);
+      zip_file->prefetched_data_ = std::move(data);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::min(jobs, to_inflate.size()); i++) {
+    threads.emplace_back(worker);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 ZipFileCollection::~ZipFileCollection() {
   if (handle_) {
     CloseArchive(handle_);
@@ -20,6 +20,9 @@
 #include "ziparchive/zip_archive.h"
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "androidfw/StringPiece.h"
 
@@ -30,9 +33,14 @@ namespace io {
 
 // An IFile representing a file within a ZIP archive. If the file is compressed, it is uncompressed
 // and copied into memory when opened. Otherwise it is mmapped from the ZIP archive.
+//
+// When archive_data is the whole archive mmapped, stored files are views into it, and compressed
+// files are inflated straight from it, which unlike extracting them through the handle can be done
+// for several files at once. Either way, files may be opened from several threads at once.
 class ZipFile : public IFile {
  public:
-  ZipFile(::ZipArchiveHandle handle, const ::ZipEntry& entry, const Source& source);
+  ZipFile(::ZipArchiveHandle handle, const ::ZipEntry& entry, const Source& source,
+          std::shared_ptr<const IData> archive_data = {});
 
   std::unique_ptr<IData> OpenAsData() override;
   std::unique_ptr<io::InputStream> OpenInputStream() override;
@@ -40,9 +48,22 @@ class ZipFile : public IFile {
   bool WasCompressed() override;
 
  private:
+  friend class ZipFileCollection;
+
+  // Whether the data of the entry lies within archive_data_.
+  bool IsInArchiveData() const;
+
+  // Inflates the compressed entry from archive_data_.
+  std::unique_ptr<IData> InflateFromArchiveData() const;
+
   ::ZipArchiveHandle zip_handle_;
   ::ZipEntry zip_entry_;
   Source source_;
+  std::shared_ptr<const IData> archive_data_;
+
+  // The data inflated by ZipFileCollection::Prefetch(), handed to the next OpenAsData().
+  std::mutex prefetch_lock_;
+  std::unique_ptr<IData> prefetched_data_;
 };
 
 class ZipFileCollection;
@@ -68,6 +89,10 @@ class ZipFileCollection : public IFileCollection {
   std::unique_ptr<IFileCollectionIterator> Iterator() override;
   char GetDirSeparator() override;
 
+  // Inflates the compressed files among files concurrently. Does nothing if the archive couldn't
+  // be mmapped, as libziparchive can't extract several entries at once.
+  void Prefetch(const std::vector<IFile*>& files, size_t jobs) override;
+
   ~ZipFileCollection() override;
 
  private:
@@ -75,6 +100,7 @@ class ZipFileCollection : public IFileCollection {
   ZipFileCollection();
 
   ZipArchiveHandle handle_;
+  std::shared_ptr<const IData> archive_data_;
   std::vector<std::unique_ptr<IFile>> files_;
   std::map<std::string, IFile*> files_by_name_;
 };
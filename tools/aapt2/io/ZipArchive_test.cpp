@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/ZipArchive.h"
+
+#include "format/Archive.h"
+#include "io/StringStream.h"
+#include "test/Test.h"
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+namespace aapt {
+namespace io {
+
+class ZipFileCollectionTest : public TestDirectoryFixture {
+ public:
+  void SetUp() override {
+    TestDirectoryFixture::SetUp();
+    zip_path_ = GetTestPath("test.zip");
+
+    StdErrDiagnostics diag;
+    std::unique_ptr<IArchiveWriter> writer = CreateZipFileArchiveWriter(&diag, zip_path_);
+    ASSERT_THAT(writer, NotNull());
+    for (size_t i = 0; i < 8; i++) {
+      const std::string stored_contents = StoredContents(i);
+      StringInputStream stored(stored_contents);
+      ASSERT_TRUE(writer->WriteFile("stored" + std::to_string(i), 0u, &stored));
+      const std::string compressed_contents = CompressedContents(i);
+      StringInputStream compressed(compressed_contents);
+      ASSERT_TRUE(writer->WriteFile("compressed" + std::to_string(i), ArchiveEntry::kCompress,
+                                    &compressed));
+    }
+  }
+
+  static std::string StoredContents(size_t i) {
+    return "stored file " + std::to_string(i);
+  }
+
+  static std::string CompressedContents(size_t i) {
+    return std::string(4096, static_cast<char>('a' + i));
+  }
+
+  static std::string ReadData(IFile* file) {
+    std::unique_ptr<IData> data = file->OpenAsData();
+    if (data == nullptr) {
+      return "<failed to open>";
+    }
+    return std::string(static_cast<const char*>(data->data()), data->size());
+  }
+
+ protected:
+  std::string zip_path_;
+};
+
+TEST_F(ZipFileCollectionTest, OpensStoredAndCompressedFiles) {
+  std::string error;
+  std::unique_ptr<ZipFileCollection> zip = ZipFileCollection::Create(zip_path_, &error);
+  ASSERT_THAT(zip, NotNull()) << error;
+
+  IFile* stored = zip->FindFile("stored3");
+  ASSERT_THAT(stored, NotNull());
+  EXPECT_FALSE(stored->WasCompressed());
+  EXPECT_THAT(ReadData(stored), Eq(StoredContents(3)));
+
+  IFile* compressed = zip->FindFile("compressed5");
+  ASSERT_THAT(compressed, NotNull());
+  EXPECT_TRUE(compressed->WasCompressed());
+  EXPECT_THAT(ReadData(compressed), Eq(CompressedContents(5)));
+
+  // Data opened stays valid once the collection is gone.
+  std::unique_ptr<IData> data = stored->OpenAsData();
+  ASSERT_THAT(data, NotNull());
+  zip.reset();
+  EXPECT_THAT(std::string(static_cast<const char*>(data->data()), data->size()),
+              Eq(StoredContents(3)));
+}
+
+TEST_F(ZipFileCollectionTest, PrefetchesCompressedFiles) {
+  std::unique_ptr<ZipFileCollection> zip = ZipFileCollection::Create(zip_path_, nullptr);
+  ASSERT_THAT(zip, NotNull());
+
+  std::vector<IFile*> files;
+  for (auto iter = zip->Iterator(); iter->HasNext();) {
+    files.push_back(iter->Next());
+  }
+  zip->Prefetch(files, 4);
+
+  for (size_t i = 0; i < 8; i++) {
+    IFile* compressed = zip->FindFile("compressed" + std::to_string(i));
+    ASSERT_THAT(compressed, NotNull());
+
+    // The prefetched data is handed out once, after which the file is inflated again.
+    EXPECT_THAT(ReadData(compressed), Eq(CompressedContents(i)));
+    EXPECT_THAT(ReadData(compressed), Eq(CompressedContents(i)));
+    EXPECT_THAT(ReadData(zip->FindFile("stored" + std::to_string(i))), Eq(StoredContents(i)));
+  }
+  EXPECT_THAT(zip->FindFile("missing"), IsNull());
+}
+
+}  // namespace io
+}  // namespace aapt
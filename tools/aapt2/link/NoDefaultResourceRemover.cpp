@@ -91,6 +91,7 @@ bool NoDefaultResourceRemover::Consume(IAaptContext* context, ResourceTable* tab
       }
 
       type->entries.erase(remove_iter, end_iter);
+      type->InvalidateEntryIndex();
     }
   }
   return true;
@@ -74,6 +74,7 @@ bool PrivateAttributeMover::Consume(IAaptContext* context, ResourceTable* table)
             [](const std::unique_ptr<ResourceEntry>& entry) -> bool {
               return entry->visibility.level != Visibility::Level::kPublic;
             });
+    type->InvalidateEntryIndex();
 
     if (private_attr_entries.empty()) {
       // No private attributes.
@@ -83,6 +84,7 @@ bool PrivateAttributeMover::Consume(IAaptContext* context, ResourceTable* table)
     ResourceTableType* priv_attr_type = package->FindOrCreateType(ResourceType::kAttrPrivate);
     CHECK(priv_attr_type->entries.empty());
     priv_attr_type->entries = std::move(private_attr_entries);
+    priv_attr_type->InvalidateEntryIndex();
   }
   return true;
 }
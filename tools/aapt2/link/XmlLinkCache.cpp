@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "link/XmlLinkCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "android-base/file.h"
+#include "android-base/parseint.h"
+#include "android-base/stringprintf.h"
+#include "openssl/sha.h"
+
+#include "ResourceValues.h"
+#include "ValueVisitor.h"
+#include "util/Files.h"
+#include "util/Util.h"
+
+using ::android::StringPiece;
+using ::android::base::StringPrintf;
+
+namespace aapt {
+
+namespace {
+
+constexpr const char* kEntryExtension = ".cache";
+constexpr const char* kEntryHeader = "aapt2-xml-link-cache\n";
+
+// Returns the line of data at *offset, up to but excluding the newline, and moves past it.
+bool ReadLine(const std::string& data, size_t* offset, std::string* out_line) {
+  const size_t end = data.find('\n', *offset);
+  if (end == std::string::npos) {
+    return false;
+  }
+  *out_line = data.substr(*offset, end - *offset);
+  *offset = end + 1;
+  return true;
+}
+
+class MacroReferenceFinder : public xml::ConstVisitor {
+ public:
+  using xml::ConstVisitor::Visit;
+
+  MacroReferenceFinder() = default;
+
+  void Visit(const xml::Element* el) override {
+    for (const xml::Attribute& attr : el->attributes) {
+      const Reference* ref = ValueCast<Reference>(attr.compiled_value.get());
+      if (ref != nullptr && ref->name && ref->name.value().type.type == ResourceType::kMacro) {
+        found = true;
+      }
+    }
+    if (!found) {
+      VisitChildren(el);
+    }
+  }
+
+  bool found = false;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MacroReferenceFinder);
+};
+
+}  // namespace
+
+XmlLinkCache::XmlLinkCache(const std::string& dir) : dir_(dir) {
+}
+
+std::string XmlLinkCache::MakeKey(const StringPiece& link_digest, const StringPiece& extra,
+                                  const StringPiece& xml_digest) {
+  std::string key_inputs = link_digest.to_string();
+  key_inputs += '\n';
+  key_inputs.append(extra.data(), extra.size());
+  return Digest(key_inputs) + xml_digest.to_string();
+}
+
+std::string XmlLinkCache::GetEntryPath(const std::string& key) const {
+  std::string path = dir_;
+  file::AppendPath(&path, key + kEntryExtension);
+  return path;
+}
+
+bool XmlLinkCache::Find(const std::string& key, std::vector<Output>* out_outputs) {
+  std::string data;
+  if (!android::base::ReadFileToString(GetEntryPath(key), &data)) {
+    return false;
+  }
+
+  // Anything unexpected, e.g. an entry written by an older aapt2, is a miss.
+  if (!util::StartsWith(data, kEntryHeader)) {
+    return false;
+  }
+  size_t offset = strlen(kEntryHeader);
+  std::string line;
+  size_t count;
+  if (!ReadLine(data, &offset, &line) || !android::base::ParseUint(line, &count)) {
+    return false;
+  }
+
+  std::vector<Output> outputs;
+  for (size_t i = 0; i < count; i++) {
+    std::string sdk_version;
+    std::string size;
+    Output output;
+    size_t data_size;
+    if (!ReadLine(data, &offset, &sdk_version) ||
+        !android::base::ParseUint(sdk_version, &output.sdk_version) ||
+        !ReadLine(data, &offset, &size) || !android::base::ParseUint(size, &data_size) ||
+        data_size > data.size() - offset) {
+      return false;
+    }
+    output.data = data.substr(offset, data_size);
+    offset += data_size;
+    outputs.push_back(std::move(output));
+  }
+  if (offset != data.size()) {
+    return false;
+  }
+
+  used_keys_.insert(key);
+  *out_outputs = std::move(outputs);
+  return true;
+}
+
+bool XmlLinkCache::Store(const std::string& key, const std::vector<Output>& outputs,
+                         IDiagnostics* diag) {
+  used_keys_.insert(key);
+
+  std::string data = kEntryHeader;
+  data += std::to_string(outputs.size()) + "\n";
+  for (const Output& output : outputs) {
+    data += std::to_string(output.sdk_version) + "\n";
+    data += std::to_string(output.data.size()) + "\n";
+    data += output.data;
+  }
+
+  // Write the entry next to where it goes and move it there, so that a link that is interrupted
+  // never leaves half an entry behind.
+  const std::string path = GetEntryPath(key);
+  const std::string temp_path = path + ".tmp";
+  if (!android::base::WriteStringToFile(data, temp_path) ||
+      std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    diag->Warn(DiagMessage(path) << "failed to write XML link cache entry");
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void XmlLinkCache::RemoveUnused(IDiagnostics* diag) {
+  std::optional<std::vector<std::string>> files = file::FindFiles(dir_, diag);
+  if (!files) {
+    return;
+  }
+
+  for (const std::string& file : files.value()) {
+    if (!util::EndsWith(file, kEntryExtension) && !util::EndsWith(file, ".tmp")) {
+      continue;
+    }
+    const std::string key = file.substr(0, file.find('.'));
+    if (util::EndsWith(file, kEntryExtension) && used_keys_.find(key) != used_keys_.end()) {
+      continue;
+    }
+    std::string path = dir_;
+    file::AppendPath(&path, file);
+    std::remove(path.c_str());
+  }
+}
+
+std::string XmlLinkCache::Digest(const StringPiece& data) {
+  // A collision would make a link silently write the outputs of another XML file, so the digest
+  // must be collision-resistant.
+  uint8_t hash[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), hash);
+  std::string digest;
+  for (uint8_t byte : hash) {
+    digest += StringPrintf("%02x", byte);
+  }
+  return digest;
+}
+
+std::string XmlLinkCache::DigestTable(const ResourceTable& table) {
+  std::ostringstream out;
+  for (const auto& package : table.packages) {
+    for (const auto& type : package->types) {
+      for (const auto& entry : type->entries) {
+        out << package->name << ":" << type->type << "/" << entry->name << " "
+            << entry->id.value_or(ResourceId()) << " "
+            << static_cast<int>(entry->visibility.level) << "\n";
+
+        for (const auto& config_value : entry->values) {
+          if (const Attribute* attr = ValueCast<Attribute>(config_value->value.get())) {
+            out << config_value->config << " " << *attr << "\n";
+          } else if (const Macro* macro = ValueCast<Macro>(config_value->value.get())) {
+            out << config_value->config << " (macro) " << macro->raw_value;
+            for (const Macro::Namespace& alias : macro->alias_namespaces) {
+              out << " " << alias.alias << "=" << alias.package_name
+                  << (alias.is_private ? "*" : "");
+            }
+            out << "\n";
+          }
+        }
+      }
+    }
+  }
+  return Digest(out.str());
+}
+
+bool XmlLinkCache::IsCacheable(const xml::XmlResource& doc) {
+  if (doc.root == nullptr) {
+    return false;
+  }
+  MacroReferenceFinder finder;
+  doc.root->Accept(&finder);
+  return !finder.found;
+}
+
+}  // namespace aapt
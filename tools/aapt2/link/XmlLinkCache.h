@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_LINK_XMLLINKCACHE_H
+#define AAPT_LINK_XMLLINKCACHE_H
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "androidfw/StringPiece.h"
+
+#include "Diagnostics.h"
+#include "ResourceTable.h"
+#include "xml/XmlDom.h"
+
+namespace aapt {
+
+// Keeps the binary XML files produced by a link in a directory, so that the next link of the same
+// module can write out the files of compiled XML it has seen before instead of linking, versioning
+// and flattening it again.
+//
+// An entry is keyed on the compiled XML and on a digest of everything else linking it depends on,
+// so a change to any of these simply misses the cache. Entries may be shared by the APK and the
+// splits of a link, which link against different tables and so get different keys.
+class XmlLinkCache {
+ public:
+  // A file produced from one compiled XML file. Versioning the XML can produce several.
+  struct Output {
+    // The sdkVersion of the config of the file.
+    uint16_t sdk_version;
+
+    // The flattened binary XML.
+    std::string data;
+  };
+
+  // Uses the entries kept in dir, which must exist.
+  explicit XmlLinkCache(const std::string& dir);
+
+  // Returns the key of an XML file. link_digest identifies what linking any XML file depends on
+  // besides the XML itself, e.g. the options, the included APKs and DigestTable(). extra is what
+  // only the outputs of this file depend on, such as its name and config, and xml_digest is the
+  // Digest() of its compiled XML.
+  static std::string MakeKey(const android::StringPiece& link_digest,
+                             const android::StringPiece& extra,
+                             const android::StringPiece& xml_digest);
+
+  // Reads the outputs kept for key. Returns false if there are none or they can't be read.
+  bool Find(const std::string& key, std::vector<Output>* out_outputs);
+
+  // Keeps the outputs for key, replacing any kept already.
+  bool Store(const std::string& key, const std::vector<Output>& outputs, IDiagnostics* diag);
+
+  // Deletes the entries neither found nor stored since the cache was opened. These are of files
+  // no longer linked, or of older versions of them.
+  void RemoveUnused(IDiagnostics* diag);
+
+  // Returns the SHA-256 digest of data, in hex.
+  static std::string Digest(const android::StringPiece& data);
+
+  // Digests what linking an XML file depends on in the table: the name, ID and visibility of every
+  // resource, and the attributes and macros that XML values are checked against or replaced by.
+  static std::string DigestTable(const ResourceTable& table);
+
+  // Whether the outputs of linking doc can be kept. XML referencing macros can't, as the macro
+  // references are replaced by their values while linking, and the references that the
+  // proguard rules are collected from would differ between a linked and a cached file.
+  static bool IsCacheable(const xml::XmlResource& doc);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(XmlLinkCache);
+
+  std::string GetEntryPath(const std::string& key) const;
+
+  std::string dir_;
+  std::unordered_set<std::string> used_keys_;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_LINK_XMLLINKCACHE_H
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "link/XmlLinkCache.h"
+
+#include "android-base/file.h"
+
+#include "test/Test.h"
+#include "util/Files.h"
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+namespace aapt {
+
+using XmlLinkCacheTest = TestDirectoryFixture;
+
+TEST_F(XmlLinkCacheTest, FindsStoredOutputs) {
+  StdErrDiagnostics diag;
+  const std::string key = XmlLinkCache::MakeKey("link", "layout/main", XmlLinkCache::Digest("xml"));
+  {
+    XmlLinkCache cache(GetTestDirectory().to_string());
+    std::vector<XmlLinkCache::Output> outputs;
+    EXPECT_FALSE(cache.Find(key, &outputs));
+    ASSERT_TRUE(cache.Store(key, {{0, "base"}, {21, std::string("v21\n\0", 5)}}, &diag));
+  }
+
+  XmlLinkCache cache(GetTestDirectory().to_string());
+  std::vector<XmlLinkCache::Output> outputs;
+  ASSERT_TRUE(cache.Find(key, &outputs));
+  ASSERT_THAT(outputs.size(), Eq(2u));
+  EXPECT_THAT(outputs[0].sdk_version, Eq(0u));
+  EXPECT_THAT(outputs[0].data, Eq("base"));
+  EXPECT_THAT(outputs[1].sdk_version, Eq(21u));
+  EXPECT_THAT(outputs[1].data, Eq(std::string("v21\n\0", 5)));
+}
+
+TEST_F(XmlLinkCacheTest, KeyDependsOnEveryInput) {
+  const std::string xml_digest = XmlLinkCache::Digest("xml");
+  const std::string key = XmlLinkCache::MakeKey("link", "layout/main", xml_digest);
+  EXPECT_THAT(XmlLinkCache::MakeKey("link2", "layout/main", xml_digest), Ne(key));
+  EXPECT_THAT(XmlLinkCache::MakeKey("link", "layout/other", xml_digest), Ne(key));
+  EXPECT_THAT(XmlLinkCache::MakeKey("link", "layout/main", XmlLinkCache::Digest("xml2")), Ne(key));
+}
+
+TEST_F(XmlLinkCacheTest, MissesTruncatedEntry) {
+  StdErrDiagnostics diag;
+  const std::string key = XmlLinkCache::MakeKey("link", "layout/main", XmlLinkCache::Digest("xml"));
+  {
+    XmlLinkCache cache(GetTestDirectory().to_string());
+    ASSERT_TRUE(cache.Store(key, {{0, "contents"}}, &diag));
+  }
+
+  std::optional<std::vector<std::string>> files = file::FindFiles(GetTestDirectory(), &diag);
+  ASSERT_TRUE(files);
+  ASSERT_THAT(files.value().size(), Eq(1u));
+  const std::string path = GetTestPath(files.value()[0]);
+  std::string contents;
+  ASSERT_TRUE(android::base::ReadFileToString(path, &contents));
+  WriteFile(path, contents.substr(0, contents.size() - 1));
+
+  XmlLinkCache cache(GetTestDirectory().to_string());
+  std::vector<XmlLinkCache::Output> outputs;
+  EXPECT_FALSE(cache.Find(key, &outputs));
+}
+
+TEST_F(XmlLinkCacheTest, RemovesUnusedEntries) {
+  StdErrDiagnostics diag;
+  const std::string used_key =
+      XmlLinkCache::MakeKey("link", "layout/used", XmlLinkCache::Digest("xml"));
+  const std::string unused_key =
+      XmlLinkCache::MakeKey("link", "layout/unused", XmlLinkCache::Digest("xml"));
+  {
+    XmlLinkCache cache(GetTestDirectory().to_string());
+    ASSERT_TRUE(cache.Store(used_key, {{0, "used"}}, &diag));
+    ASSERT_TRUE(cache.Store(unused_key, {{0, "unused"}}, &diag));
+  }
+
+  {
+    XmlLinkCache cache(GetTestDirectory().to_string());
+    std::vector<XmlLinkCache::Output> outputs;
+    ASSERT_TRUE(cache.Find(used_key, &outputs));
+    cache.RemoveUnused(&diag);
+  }
+
+  XmlLinkCache cache(GetTestDirectory().to_string());
+  std::vector<XmlLinkCache::Output> outputs;
+  EXPECT_TRUE(cache.Find(used_key, &outputs));
+  EXPECT_FALSE(cache.Find(unused_key, &outputs));
+}
+
+TEST(XmlLinkCacheDigestTest, TableDigestIgnoresPlainValues) {
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddString("com.app:string/hello", ResourceId(0x7f010000), "hello")
+          .Build();
+  std::unique_ptr<ResourceTable> changed_value =
+      test::ResourceTableBuilder()
+          .AddString("com.app:string/hello", ResourceId(0x7f010000), "goodbye")
+          .Build();
+  std::unique_ptr<ResourceTable> changed_id =
+      test::ResourceTableBuilder()
+          .AddString("com.app:string/hello", ResourceId(0x7f010001), "hello")
+          .Build();
+
+  const std::string digest = XmlLinkCache::DigestTable(*table);
+  EXPECT_THAT(XmlLinkCache::DigestTable(*changed_value), Eq(digest));
+  EXPECT_THAT(XmlLinkCache::DigestTable(*changed_id), Ne(digest));
+}
+
+TEST(XmlLinkCacheDigestTest, XmlReferencingMacrosIsNotCacheable) {
+  std::unique_ptr<xml::XmlResource> doc = test::BuildXmlDom(R"(<View text="@macro/text"/>)");
+  EXPECT_TRUE(XmlLinkCache::IsCacheable(*doc));
+
+  doc->root->attributes[0].compiled_value = test::BuildReference("macro/text");
+  EXPECT_FALSE(XmlLinkCache::IsCacheable(*doc));
+}
+
+}  // namespace aapt
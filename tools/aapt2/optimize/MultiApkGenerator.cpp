@@ -131,13 +131,8 @@ bool MultiApkGenerator::FromBaseApk(const MultiApkGeneratorOptions& options) {
   std::unordered_set<std::string> filtered_artifacts;
   std::unordered_set<std::string> kept_artifacts;
 
-  // For now, just write out the stripped APK since ABI splitting doesn't modify anything else.
+  std::vector<const OutputArtifact*> artifacts;
   for (const OutputArtifact& artifact : options.apk_artifacts) {
-    FilterChain filters;
-
-    ContextWrapper wrapped_context{context_};
-    wrapped_context.SetSource(artifact.name);
-
     if (!options.kept_artifacts.empty()) {
       const auto& it = artifacts_to_keep.find(artifact.name);
       if (it == artifacts_to_keep.end()) {
@@ -151,42 +146,15 @@ bool MultiApkGenerator::FromBaseApk(const MultiApkGeneratorOptions& options) {
         kept_artifacts.insert(artifact.name);
       }
     }
+    artifacts.push_back(&artifact);
+  }
 
-    std::unique_ptr<ResourceTable> table =
-        FilterTable(context_, artifact, *apk_->GetResourceTable(), &filters);
-    if (!table) {
-      return false;
-    }
-
-    IDiagnostics* diag = wrapped_context.GetDiagnostics();
-
-    std::unique_ptr<XmlResource> manifest;
-    if (!UpdateManifest(artifact, &manifest, diag)) {
-      diag->Error(DiagMessage() << "could not update AndroidManifest.xml for output artifact");
-      return false;
-    }
-
-    std::string out = options.out_dir;
-    if (!file::mkdirs(out)) {
-      diag->Warn(DiagMessage() << "could not create out dir: " << out);
-    }
-    file::AppendPath(&out, artifact.name);
-
-    if (context_->IsVerbose()) {
-      diag->Note(DiagMessage() << "Generating split: " << out);
-    }
-
-    std::unique_ptr<IArchiveWriter> writer = CreateZipFileArchiveWriter(diag, out);
-
-    if (context_->IsVerbose()) {
-      diag->Note(DiagMessage() << "Writing output: " << out);
-    }
-
-    filters.AddFilter(util::make_unique<SignatureFilter>());
-    if (!apk_->WriteToArchive(&wrapped_context, table.get(), options.table_flattener_options,
-                              &filters, writer.get(), manifest.get())) {
-      return false;
-    }
+  // The artifacts only read the base APK and its table, so they can be generated concurrently.
+  if (!RunTasksConcurrently(context_, artifacts.size(), options.jobs,
+                            [&](IAaptContext* context, size_t i) {
+                              return GenerateArtifact(context, *artifacts[i], options);
+                            })) {
+    return false;
   }
 
   // Make sure all of the requested artifacts were valid. If there are any kept artifacts left,
@@ -216,6 +184,49 @@ bool MultiApkGenerator::FromBaseApk(const MultiApkGeneratorOptions& options) {
   return true;
 }
 
+bool MultiApkGenerator::GenerateArtifact(IAaptContext* context, const OutputArtifact& artifact,
+                                         const MultiApkGeneratorOptions& options) {
+  // For now, just write out the stripped APK since ABI splitting doesn't modify anything else.
+  FilterChain filters;
+
+  ContextWrapper wrapped_context{context};
+  wrapped_context.SetSource(artifact.name);
+
+  std::unique_ptr<ResourceTable> table =
+      FilterTable(context, artifact, *apk_->GetResourceTable(), &filters);
+  if (!table) {
+    return false;
+  }
+
+  IDiagnostics* diag = wrapped_context.GetDiagnostics();
+
+  std::unique_ptr<XmlResource> manifest;
+  if (!UpdateManifest(artifact, &manifest, diag)) {
+    diag->Error(DiagMessage() << "could not update AndroidManifest.xml for output artifact");
+    return false;
+  }
+
+  std::string out = options.out_dir;
+  if (!file::mkdirs(out)) {
+    diag->Warn(DiagMessage() << "could not create out dir: " << out);
+  }
+  file::AppendPath(&out, artifact.name);
+
+  if (context->IsVerbose()) {
+    diag->Note(DiagMessage() << "Generating split: " << out);
+  }
+
+  std::unique_ptr<IArchiveWriter> writer = CreateZipFileArchiveWriter(diag, out);
+
+  if (context->IsVerbose()) {
+    diag->Note(DiagMessage() << "Writing output: " << out);
+  }
+
+  filters.AddFilter(util::make_unique<SignatureFilter>());
+  return apk_->WriteToArchive(&wrapped_context, table.get(), options.table_flattener_options,
+                              &filters, writer.get(), manifest.get());
+}
+
 std::unique_ptr<ResourceTable> MultiApkGenerator::FilterTable(IAaptContext* context,
                                                               const OutputArtifact& artifact,
                                                               const ResourceTable& old_table,
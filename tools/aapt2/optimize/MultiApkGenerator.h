@@ -35,6 +35,9 @@ struct MultiApkGeneratorOptions {
   std::vector<configuration::OutputArtifact> apk_artifacts;
   TableFlattenerOptions table_flattener_options;
   std::unordered_set<std::string> kept_artifacts;
+
+  // The number of artifacts generated at once. Each one being generated holds a copy of the table.
+  size_t jobs = 1;
 };
 
 /**
@@ -62,6 +65,10 @@ class MultiApkGenerator {
     return context_->GetDiagnostics();
   }
 
+  // Filters the table for the artifact and writes its APK to the output directory.
+  bool GenerateArtifact(IAaptContext* context, const configuration::OutputArtifact& artifact,
+                        const MultiApkGeneratorOptions& options);
+
   bool UpdateManifest(const configuration::OutputArtifact& artifact,
                       std::unique_ptr<xml::XmlResource>* updated_manifest, IDiagnostics* diag);
 
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimize/ResourceFileDeduper.h"
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ResourceTable.h"
+#include "ResourceValues.h"
+#include "ValueVisitor.h"
+#include "cmd/Util.h"
+#include "trace/TraceBuffer.h"
+
+namespace aapt {
+
+namespace {
+
+// The file references of one type, and which of their files turned out to be the same.
+struct TypeFiles {
+  // Sorted, so that the first path of those with the same contents is the one kept.
+  std::map<std::string, std::vector<FileReference*>> refs_by_path;
+
+  // The path kept instead of each path whose file has the same contents as that of another.
+  std::map<std::string, std::string> replacements;
+  uint64_t bytes_saved = 0;
+};
+
+std::unique_ptr<io::IData> OpenFile(const std::vector<FileReference*>& refs) {
+  io::IFile* file = refs.front()->file;
+  return file != nullptr ? file->OpenAsData() : nullptr;
+}
+
+void FindSameFiles(TypeFiles* type_files) {
+  // Only the size and hash of the contents are kept while going through the files, so that they
+  // aren't all held in memory at once.
+  std::map<std::pair<size_t, size_t>, std::vector<const std::string*>> paths_by_contents;
+  for (const auto& entry : type_files->refs_by_path) {
+    std::unique_ptr<io::IData> data = OpenFile(entry.second);
+    if (data == nullptr) {
+      continue;
+    }
+    const size_t hash = std::hash<std::string_view>{}(
+        std::string_view(static_cast<const char*>(data->data()), data->size()));
+    paths_by_contents[{data->size(), hash}].push_back(&entry.first);
+  }
+
+  for (const auto& entry : paths_by_contents) {
+    const std::vector<const std::string*>& paths = entry.second;
+    if (paths.size() < 2) {
+      continue;
+    }
+
+    // The hashes may collide, so compare the contents with those of each file kept.
+    std::vector<std::pair<const std::string*, std::unique_ptr<io::IData>>> kept;
+    for (const std::string* path : paths) {
+      std::unique_ptr<io::IData> data = OpenFile(type_files->refs_by_path[*path]);
+      if (data == nullptr) {
+        continue;
+      }
+
+      bool replaced = false;
+      for (const auto& kept_file : kept) {
+        if (kept_file.second->size() == data->size() &&
+            memcmp(kept_file.second->data(), data->data(), data->size()) == 0) {
+          type_files->replacements[*path] = *kept_file.first;
+          type_files->bytes_saved += data->size();
+          replaced = true;
+          break;
+        }
+      }
+      if (!replaced) {
+        kept.emplace_back(path, std::move(data));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+bool ResourceFileDeduper::Consume(IAaptContext* context, ResourceTable* table) {
+  TRACE_CALL();
+  std::vector<TypeFiles> types;
+  for (auto& package : table->packages) {
+    for (auto& type : package->types) {
+      TypeFiles type_files;
+      for (auto& entry : type->entries) {
+        for (auto& config_value : entry->values) {
+          if (FileReference* file_ref = ValueCast<FileReference>(config_value->value.get())) {
+            type_files.refs_by_path[*file_ref->path].push_back(file_ref);
+          }
+        }
+      }
+      if (type_files.refs_by_path.size() > 1) {
+        types.push_back(std::move(type_files));
+      }
+    }
+  }
+
+  // Reading the files, which may mean inflating them, is what takes the time. The string pool is
+  // only changed afterwards, here, since it can't be changed from several threads.
+  RunTasksConcurrently(context, types.size(), jobs_, [&](IAaptContext* task_context, size_t i) {
+    FindSameFiles(&types[i]);
+    return true;
+  });
+
+  for (TypeFiles& type_files : types) {
+    for (const auto& replacement : type_files.replacements) {
+      const std::vector<FileReference*>& kept_refs = type_files.refs_by_path[replacement.second];
+      for (FileReference* file_ref : type_files.refs_by_path[replacement.first]) {
+        file_ref->path =
+            table->string_pool.MakeRef(replacement.second, file_ref->path.GetContext());
+        file_ref->file = kept_refs.front()->file;
+      }
+    }
+    files_removed_ += type_files.replacements.size();
+    bytes_saved_ += type_files.bytes_saved;
+  }
+
+  if (context->IsVerbose()) {
+    context->GetDiagnostics()->Note(DiagMessage() << "removed " << files_removed_
+                                                  << " duplicate files, saving " << bytes_saved_
+                                                  << " bytes");
+  }
+  return true;
+}
+
+}  // namespace aapt
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_OPTIMIZE_RESOURCEFILEDEDUPER_H
+#define AAPT_OPTIMIZE_RESOURCEFILEDEDUPER_H
+
+#include <cstdint>
+
+#include "android-base/macros.h"
+
+#include "process/IResourceTableConsumer.h"
+
+namespace aapt {
+
+class ResourceTable;
+
+// Points the file references of a resource type whose files have the same contents, such as the
+// same PNG in several density buckets, at the first of those files by path. The other files are
+// then no longer referenced, and left out of the APK. The files of several types are compared at
+// once, but which files are kept doesn't depend on that.
+class ResourceFileDeduper : public IResourceTableConsumer {
+ public:
+  explicit ResourceFileDeduper(size_t jobs = 1) : jobs_(jobs) {
+  }
+
+  bool Consume(IAaptContext* context, ResourceTable* table) override;
+
+  // The number and uncompressed size of the files no longer referenced.
+  size_t GetFilesRemoved() const {
+    return files_removed_;
+  }
+  uint64_t GetBytesSaved() const {
+    return bytes_saved_;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ResourceFileDeduper);
+
+  const size_t jobs_;
+  size_t files_removed_ = 0;
+  uint64_t bytes_saved_ = 0;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_OPTIMIZE_RESOURCEFILEDEDUPER_H
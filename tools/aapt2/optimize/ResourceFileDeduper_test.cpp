@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimize/ResourceFileDeduper.h"
+
+#include "ResourceTable.h"
+#include "io/FileSystem.h"
+#include "optimize/ResourcePathShortener.h"
+#include "test/Test.h"
+
+using ::android::ConfigDescription;
+using ::testing::Eq;
+using ::testing::NotNull;
+
+namespace aapt {
+
+class ResourceFileDeduperTest : public TestDirectoryFixture {
+ public:
+  io::IFile* AddFile(const std::string& path, const std::string& contents) {
+    WriteFile(GetTestPath(path), contents);
+    files_.push_back(util::make_unique<io::RegularFile>(Source(GetTestPath(path))));
+    return files_.back().get();
+  }
+
+  std::string GetPath(ResourceTable* table, const char* name,
+                      const ConfigDescription& config = {}) {
+    FileReference* file_ref = test::GetValueForConfig<FileReference>(table, name, config);
+    return file_ref != nullptr ? *file_ref->path : "<missing>";
+  }
+
+ private:
+  std::vector<std::unique_ptr<io::IFile>> files_;
+};
+
+TEST_F(ResourceFileDeduperTest, KeepsFirstOfSameFilesOfType) {
+  std::unique_ptr<IAaptContext> context = test::ContextBuilder().Build();
+  const ConfigDescription hdpi = test::ParseConfigOrDie("hdpi");
+  const ConfigDescription xhdpi = test::ParseConfigOrDie("xhdpi");
+
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddFileReference("android:drawable/icon", "res/drawable-xhdpi/icon.png", xhdpi,
+                            AddFile("res/drawable-xhdpi/icon.png", "icon"))
+          .AddFileReference("android:drawable/icon", "res/drawable-hdpi/icon.png", hdpi,
+                            AddFile("res/drawable-hdpi/icon.png", "icon"))
+          .AddFileReference("android:drawable/copy", "res/drawable/copy.png",
+                            AddFile("res/drawable/copy.png", "icon"))
+          .AddFileReference("android:drawable/other", "res/drawable/other.png",
+                            AddFile("res/drawable/other.png", "other"))
+          .AddFileReference("android:mipmap/icon", "res/mipmap/icon.png",
+                            AddFile("res/mipmap/icon.png", "icon"))
+          .Build();
+
+  ResourceFileDeduper deduper(4);
+  ASSERT_TRUE(deduper.Consume(context.get(), table.get()));
+
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/icon", hdpi),
+              Eq("res/drawable-hdpi/icon.png"));
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/icon", xhdpi),
+              Eq("res/drawable-hdpi/icon.png"));
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/copy"), Eq("res/drawable-hdpi/icon.png"));
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/other"), Eq("res/drawable/other.png"));
+
+  // Files of other types are left alone.
+  EXPECT_THAT(GetPath(table.get(), "android:mipmap/icon"), Eq("res/mipmap/icon.png"));
+
+  EXPECT_THAT(deduper.GetFilesRemoved(), Eq(2u));
+  EXPECT_THAT(deduper.GetBytesSaved(), Eq(8u));
+
+  FileReference* file_ref = test::GetValue<FileReference>(table.get(), "android:drawable/copy");
+  ASSERT_THAT(file_ref, NotNull());
+  EXPECT_THAT(file_ref->file->GetSource().path, Eq(GetTestPath("res/drawable-hdpi/icon.png")));
+}
+
+TEST_F(ResourceFileDeduperTest, PathShortenerMovesEveryReferenceToKeptFile) {
+  std::unique_ptr<IAaptContext> context = test::ContextBuilder().Build();
+  const ConfigDescription hdpi = test::ParseConfigOrDie("hdpi");
+  const ConfigDescription xhdpi = test::ParseConfigOrDie("xhdpi");
+
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .AddFileReference("android:drawable/icon", "res/drawable-xhdpi/icon.png", xhdpi,
+                            AddFile("res/drawable-xhdpi/icon.png", "icon"))
+          .AddFileReference("android:drawable/icon", "res/drawable-hdpi/icon.png", hdpi,
+                            AddFile("res/drawable-hdpi/icon.png", "icon"))
+          .AddFileReference("android:drawable/copy", "res/drawable/copy.png",
+                            AddFile("res/drawable/copy.png", "icon"))
+          .Build();
+
+  // As with --deduplicate-resource-files --shorten-resource-paths.
+  ASSERT_TRUE(ResourceFileDeduper().Consume(context.get(), table.get()));
+  std::map<std::string, std::string> path_map;
+  ASSERT_TRUE(ResourcePathShortener(path_map).Consume(context.get(), table.get()));
+
+  ASSERT_THAT(path_map.size(), Eq(1u));
+  const std::string& shortened_path = path_map.at("res/drawable-hdpi/icon.png");
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/icon", hdpi), Eq(shortened_path));
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/icon", xhdpi), Eq(shortened_path));
+  EXPECT_THAT(GetPath(table.get(), "android:drawable/copy"), Eq(shortened_path));
+}
+
+}  // namespace aapt
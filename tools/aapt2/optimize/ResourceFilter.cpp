@@ -35,6 +35,7 @@ bool ResourceFilter::Consume(IAaptContext* context, ResourceTable* table) {
           ++it;
         }
       }
+      type->InvalidateEntryIndex();
     }
   }
   return true;
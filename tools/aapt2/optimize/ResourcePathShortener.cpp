@@ -16,8 +16,9 @@
 
 #include "optimize/ResourcePathShortener.h"
 
-#include <set>
+#include <map>
 #include <unordered_set>
+#include <vector>
 
 #include "androidfw/StringPiece.h"
 
@@ -72,41 +73,35 @@ std::string GetShortenedPath(const android::StringPiece& shortened_filename,
   return shortened_path;
 }
 
-// implement custom comparator of FileReference pointers so as to use the
-// underlying filepath as key rather than the integer address. This is to ensure
-// determinism of output for colliding files.
-struct PathComparator {
-    bool operator() (const FileReference* lhs, const FileReference* rhs) const {
-        return lhs->path->compare(*rhs->path);
-    }
-};
-
 bool ResourcePathShortener::Consume(IAaptContext* context, ResourceTable* table) {
   // used to detect collisions
   std::unordered_set<std::string> shortened_paths;
-  std::set<FileReference*, PathComparator> file_refs;
+  // Keyed by the underlying file path rather than the FileReference address, both to ensure
+  // determinism of output for colliding files and so that every reference to the same file, such
+  // as those left by ResourceFileDeduper, is moved to the same shortened path.
+  std::map<std::string, std::vector<FileReference*>> file_refs;
   for (auto& package : table->packages) {
     for (auto& type : package->types) {
       for (auto& entry : type->entries) {
         for (auto& config_value : entry->values) {
           FileReference* file_ref = ValueCast<FileReference>(config_value->value.get());
           if (file_ref) {
-            file_refs.insert(file_ref);
+            file_refs[*file_ref->path].push_back(file_ref);
           }
         }
       }
     }
   }
   int num_chars = OptimalShortenedLength(file_refs.size());
-  for (auto& file_ref : file_refs) {
+  for (auto& [path, refs] : file_refs) {
     android::StringPiece res_subdir, actual_filename, extension;
-    util::ExtractResFilePathParts(*file_ref->path, &res_subdir, &actual_filename, &extension);
+    util::ExtractResFilePathParts(path, &res_subdir, &actual_filename, &extension);
 
     // Android detects ColorStateLists via pathname, skip res/color*
     if (util::StartsWith(res_subdir, "res/color"))
       continue;
 
-    std::string shortened_filename = ShortenFileName(*file_ref->path, num_chars);
+    std::string shortened_filename = ShortenFileName(path, num_chars);
     int collision_count = 0;
     std::string shortened_path = GetShortenedPath(shortened_filename, extension, collision_count);
     while (shortened_paths.find(shortened_path) != shortened_paths.end()) {
@@ -114,8 +109,10 @@ bool ResourcePathShortener::Consume(IAaptContext* context, ResourceTable* table)
       shortened_path = GetShortenedPath(shortened_filename, extension, collision_count);
     }
     shortened_paths.insert(shortened_path);
-    path_map_.insert({*file_ref->path, shortened_path});
-    file_ref->path = table->string_pool.MakeRef(shortened_path, file_ref->path.GetContext());
+    path_map_.insert({path, shortened_path});
+    for (FileReference* file_ref : refs) {
+      file_ref->path = table->string_pool.MakeRef(shortened_path, file_ref->path.GetContext());
+    }
   }
   return true;
 }
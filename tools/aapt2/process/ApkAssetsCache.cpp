@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "process/ApkAssetsCache.h"
+
+#include <sys/stat.h>
+
+#include "trace/TraceBuffer.h"
+
+using ::android::ApkAssets;
+
+namespace aapt {
+
+ApkAssetsCache::ApkAssetsCache(size_t max_bytes) : max_bytes_(max_bytes) {
+}
+
+bool ApkAssetsCache::GetFileStamp(const std::string& path, FileStamp* out_stamp) {
+  struct stat sb;
+  if (stat(path.c_str(), &sb) != 0) {
+    return false;
+  }
+  out_stamp->size = sb.st_size;
+#if defined(_WIN32)
+  out_stamp->modification_time_ns = static_cast<int64_t>(sb.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+  out_stamp->modification_time_ns =
+      static_cast<int64_t>(sb.st_mtimespec.tv_sec) * 1000000000 + sb.st_mtimespec.tv_nsec;
+#else
+  out_stamp->modification_time_ns =
+      static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+  out_stamp->inode = sb.st_ino;
+  return true;
+}
+
+const ApkAssetsCache::Entry* ApkAssetsCache::FindLocked(const std::string& path,
+                                                      const FileStamp& stamp) {
+  auto iter = entries_.find(path);
+  if (iter == entries_.end() || !(iter->second.stamp == stamp)) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, iter->second.lru_iter);
+  return &iter->second;
+}
+
+std::shared_ptr<const ApkAssets> ApkAssetsCache::Find(const std::string& path) {
+  FileStamp stamp;
+  if (!GetFileStamp(path, &stamp)) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  const Entry* entry = FindLocked(path, stamp);
+  return entry != nullptr ? entry->apk : nullptr;
+}
+
+std::shared_ptr<const ApkAssets> ApkAssetsCache::Load(const std::string& path) {
+  TRACE_CALL();
+  FileStamp stamp;
+  if (!GetFileStamp(path, &stamp)) {
+    return {};
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (const Entry* entry = FindLocked(path, stamp)) {
+      return entry->apk;
+    }
+  }
+
+  // Load without holding the lock, so that APKs kept already can be found in the meantime. If
+  // another thread loaded the same APK meanwhile, the one loaded last is kept.
+  std::shared_ptr<const ApkAssets> apk = ApkAssets::Load(path);
+  if (apk == nullptr) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  auto iter = entries_.find(path);
+  if (iter != entries_.end()) {
+    size_ -= iter->second.stamp.size;
+    lru_.erase(iter->second.lru_iter);
+    entries_.erase(iter);
+  }
+
+  lru_.push_front(path);
+  entries_[path] = Entry{apk, stamp, lru_.begin()};
+  size_ += stamp.size;
+
+  // Drop the least recently used APKs, including this one if it alone is too large.
+  while (size_ > max_bytes_ && !lru_.empty()) {
+    auto evicted = entries_.find(lru_.back());
+    size_ -= evicted->second.stamp.size;
+    entries_.erase(evicted);
+    lru_.pop_back();
+  }
+  return apk;
+}
+
+size_t ApkAssetsCache::GetSize() {
+  std::lock_guard<std::mutex> guard(lock_);
+  return size_;
+}
+
+}  // namespace aapt
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_PROCESS_APKASSETSCACHE_H
+#define AAPT_PROCESS_APKASSETSCACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "android-base/macros.h"
+#include "androidfw/ApkAssets.h"
+
+namespace aapt {
+
+// Keeps the APKs loaded to link against, so that the commands run by a daemon don't load and parse
+// the same android.jar again. An APK is loaded again once the file's size or modification time
+// changes.
+//
+// The least recently used APKs are dropped once the files of those kept add up to more than the
+// given size. It is safe to use from several threads.
+class ApkAssetsCache {
+ public:
+  explicit ApkAssetsCache(size_t max_bytes);
+
+  // Returns the APK at path, loading it unless it is kept and unchanged. Returns nullptr if it
+  // can't be loaded.
+  std::shared_ptr<const android::ApkAssets> Load(const std::string& path);
+
+  // Returns the APK at path if it is kept and unchanged, without loading it otherwise.
+  std::shared_ptr<const android::ApkAssets> Find(const std::string& path);
+
+  // The sum of the sizes of the files of the APKs kept.
+  size_t GetSize();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ApkAssetsCache);
+
+  // Identifies a version of a file. APKs can be rewritten several times a second during a build,
+  // so the modification time is in nanoseconds where the platform has them, and the inode
+  // catches files replaced by a rename.
+  struct FileStamp {
+    int64_t size = 0;
+    int64_t modification_time_ns = 0;
+    uint64_t inode = 0;
+
+    bool operator==(const FileStamp& other) const {
+      return size == other.size && modification_time_ns == other.modification_time_ns &&
+             inode == other.inode;
+    }
+  };
+
+  struct Entry {
+    std::shared_ptr<const android::ApkAssets> apk;
+    FileStamp stamp;
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  static bool GetFileStamp(const std::string& path, FileStamp* out_stamp);
+
+  // Returns the entry of path if it has stamp, moving it to the front. Requires lock_.
+  const Entry* FindLocked(const std::string& path, const FileStamp& stamp);
+
+  const size_t max_bytes_;
+
+  std::mutex lock_;
+  std::unordered_map<std::string, Entry> entries_;
+
+  // The paths of the entries, the most recently used first.
+  std::list<std::string> lru_;
+  size_t size_ = 0;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_PROCESS_APKASSETSCACHE_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "process/ApkAssetsCache.h"
+
+#include <sys/stat.h>
+
+#include "test/Test.h"
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::Ne;
+using ::testing::NotNull;
+
+namespace aapt {
+
+class ApkAssetsCacheTest : public CommandTestFixture {
+ public:
+  // Links an APK with the given values to path and returns its size.
+  size_t LinkApk(const std::string& path, const std::string& values) {
+    StdErrDiagnostics diag;
+    const std::string compiled_files_dir = GetTestPath("compiled");
+    EXPECT_TRUE(CompileFile(GetTestPath("res/values/values.xml"),
+                            "<resources>" + values + "</resources>", compiled_files_dir, &diag));
+    EXPECT_TRUE(Link({"-o", path, "--manifest", GetDefaultManifest()}, compiled_files_dir, &diag));
+
+    struct stat sb;
+    EXPECT_THAT(stat(path.c_str(), &sb), Eq(0));
+    return sb.st_size;
+  }
+};
+
+TEST_F(ApkAssetsCacheTest, KeepsLoadedApk) {
+  const std::string apk_path = GetTestPath("app.apk");
+  LinkApk(apk_path, R"(<string name="foo">foo</string>)");
+
+  ApkAssetsCache cache(100 * 1024 * 1024);
+  EXPECT_THAT(cache.Find(apk_path), IsNull());
+
+  std::shared_ptr<const android::ApkAssets> apk = cache.Load(apk_path);
+  ASSERT_THAT(apk, NotNull());
+  EXPECT_THAT(cache.Load(apk_path), Eq(apk));
+  EXPECT_THAT(cache.Find(apk_path), Eq(apk));
+
+  EXPECT_THAT(cache.Load(GetTestPath("missing.apk")), IsNull());
+}
+
+TEST_F(ApkAssetsCacheTest, ReloadsChangedApk) {
+  const std::string apk_path = GetTestPath("app.apk");
+  LinkApk(apk_path, R"(<string name="foo">foo</string>)");
+
+  ApkAssetsCache cache(100 * 1024 * 1024);
+  std::shared_ptr<const android::ApkAssets> apk = cache.Load(apk_path);
+  ASSERT_THAT(apk, NotNull());
+
+  // The APK grows, so it differs even if linked within the same second.
+  LinkApk(apk_path, R"(<string name="foo">foo</string><string name="bar">bar</string>)");
+  EXPECT_THAT(cache.Find(apk_path), IsNull());
+
+  std::shared_ptr<const android::ApkAssets> reloaded = cache.Load(apk_path);
+  ASSERT_THAT(reloaded, NotNull());
+  EXPECT_THAT(reloaded, Ne(apk));
+}
+
+TEST_F(ApkAssetsCacheTest, ReloadsApkRewrittenWithSameSize) {
+  const std::string apk_path = GetTestPath("app.apk");
+  const size_t size = LinkApk(apk_path, R"(<string name="foo">foo</string>)");
+
+  ApkAssetsCache cache(100 * 1024 * 1024);
+  std::shared_ptr<const android::ApkAssets> apk = cache.Load(apk_path);
+  ASSERT_THAT(apk, NotNull());
+
+  // Relinked to the same size, usually within the same second, so only the sub-second
+  // modification time or the inode tells the files apart.
+  ASSERT_THAT(LinkApk(apk_path, R"(<string name="foo">bar</string>)"), Eq(size));
+  EXPECT_THAT(cache.Find(apk_path), IsNull());
+}
+
+TEST_F(ApkAssetsCacheTest, DropsLeastRecentlyUsedApks) {
+  const std::string first_path = GetTestPath("first.apk");
+  const std::string second_path = GetTestPath("second.apk");
+  const size_t first_size = LinkApk(first_path, R"(<string name="foo">foo</string>)");
+  const size_t second_size = LinkApk(second_path, R"(<string name="bar">bar</string>)");
+
+  ApkAssetsCache cache(first_size + second_size - 1);
+  ASSERT_THAT(cache.Load(first_path), NotNull());
+  ASSERT_THAT(cache.Load(second_path), NotNull());
+
+  EXPECT_THAT(cache.Find(first_path), IsNull());
+  EXPECT_THAT(cache.Find(second_path), NotNull());
+  EXPECT_THAT(cache.GetSize(), Eq(second_size));
+}
+
+}  // namespace aapt
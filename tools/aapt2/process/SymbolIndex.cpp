@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "process/SymbolIndex.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+
+#include "android-base/file.h"
+#include "android-base/logging.h"
+#include "android-base/stringprintf.h"
+#include "ziparchive/zip_archive.h"
+
+#include "ResourceUtils.h"
+#include "trace/TraceBuffer.h"
+#include "util/Files.h"
+#include "util/Util.h"
+
+using ::android::StringPiece;
+
+namespace aapt {
+
+// The index is laid out as the header, the digest padded to 4 bytes, the resource entries
+// sorted by ID, the indices of the entries sorted by name, the attribute symbols and the strings.
+// Values are in the byte order of the machine that wrote the index.
+struct SymbolIndex::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t digest_size;
+  uint32_t resource_count;
+  uint32_t symbol_count;
+  uint32_t strings_size;
+};
+
+struct SymbolIndex::ResourceEntry {
+  uint32_t name_offset;
+  uint32_t name_size;
+  uint32_t id;
+  uint32_t type_spec_flags;
+
+  // The attribute, if has_attribute is set, and its symbols symbols_[first_symbol...].
+  uint32_t has_attribute;
+  uint32_t type_mask;
+  int32_t min_int;
+  int32_t max_int;
+  uint32_t first_symbol;
+  uint32_t symbol_count;
+};
+
+struct SymbolIndex::SymbolEntry {
+  uint32_t name_offset;
+  uint32_t name_size;
+  uint32_t id;
+  uint32_t value;
+  uint32_t type;
+};
+
+constexpr static const uint32_t kMagic = 0x49534141u;  // AASI
+constexpr static const uint32_t kVersion = 1u;
+
+static uint64_t Align4(uint64_t size) {
+  return (size + 3u) & ~static_cast<uint64_t>(3u);
+}
+
+bool SymbolIndex::AppendApkDigest(const std::string& path, std::string* out_digest) {
+  ZipArchiveHandle handle;
+  if (OpenArchive(path.c_str(), &handle) != 0) {
+    CloseArchive(handle);
+    return false;
+  }
+
+  // The index only depends on the table, and the archive records its checksum.
+  ZipEntry entry;
+  const bool found = FindEntry(handle, "resources.arsc", &entry) == 0;
+  CloseArchive(handle);
+  if (!found) {
+    return false;
+  }
+  *out_digest += android::base::StringPrintf("%s %08x %u\n", path.c_str(), entry.crc32,
+                                             static_cast<uint32_t>(entry.uncompressed_length));
+  return true;
+}
+
+std::unique_ptr<SymbolIndex> SymbolIndex::Create(const StringPiece& digest,
+                                                 std::vector<Resource> resources) {
+  TRACE_CALL();
+  std::vector<std::pair<const Resource*, std::string>> kept;
+  std::unordered_set<uint32_t> seen_ids;
+  std::unordered_set<std::string> seen_names;
+  for (const Resource& resource : resources) {
+    std::string name = resource.name.to_string();
+    if (seen_ids.insert(resource.id.id).second && seen_names.insert(name).second) {
+      kept.emplace_back(&resource, std::move(name));
+    }
+  }
+  std::sort(kept.begin(), kept.end(), [](const auto& a, const auto& b) {
+    return a.first->id.id < b.first->id.id;
+  });
+
+  std::string strings;
+  auto add_string = [&](const std::string& str, uint32_t* out_offset, uint32_t* out_size) {
+    *out_offset = static_cast<uint32_t>(strings.size());
+    *out_size = static_cast<uint32_t>(str.size());
+    strings += str;
+  };
+
+  std::vector<ResourceEntry> entries;
+  std::vector<SymbolEntry> symbols;
+  for (const auto& resource_and_name : kept) {
+    const Resource& resource = *resource_and_name.first;
+    ResourceEntry entry = {};
+    add_string(resource_and_name.second, &entry.name_offset, &entry.name_size);
+    entry.id = resource.id.id;
+    entry.type_spec_flags = resource.type_spec_flags;
+    if (const Attribute* attr = resource.attribute.get()) {
+      entry.has_attribute = 1u;
+      entry.type_mask = attr->type_mask;
+      entry.min_int = attr->min_int;
+      entry.max_int = attr->max_int;
+      entry.first_symbol = static_cast<uint32_t>(symbols.size());
+      entry.symbol_count = static_cast<uint32_t>(attr->symbols.size());
+      for (const Attribute::Symbol& symbol : attr->symbols) {
+        SymbolEntry symbol_entry = {};
+        add_string(symbol.symbol.name.value().to_string(), &symbol_entry.name_offset,
+                   &symbol_entry.name_size);
+        symbol_entry.id = symbol.symbol.id.value_or(ResourceId()).id;
+        symbol_entry.value = symbol.value;
+        symbol_entry.type = symbol.type;
+        symbols.push_back(symbol_entry);
+      }
+    }
+    entries.push_back(entry);
+  }
+
+  std::vector<uint32_t> entries_by_name(kept.size());
+  for (size_t i = 0; i < entries_by_name.size(); i++) {
+    entries_by_name[i] = static_cast<uint32_t>(i);
+  }
+  std::sort(entries_by_name.begin(), entries_by_name.end(), [&](uint32_t a, uint32_t b) {
+    return kept[a].second < kept[b].second;
+  });
+
+  Header header = {};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.digest_size = static_cast<uint32_t>(digest.size());
+  header.resource_count = static_cast<uint32_t>(entries.size());
+  header.symbol_count = static_cast<uint32_t>(symbols.size());
+  header.strings_size = static_cast<uint32_t>(strings.size());
+
+  std::unique_ptr<SymbolIndex> index(new SymbolIndex());
+  std::string& data = index->owned_data_;
+  data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  data.append(digest.data(), digest.size());
+  data.resize(Align4(data.size()), '\0');
+  data.append(reinterpret_cast<const char*>(entries.data()),
+              entries.size() * sizeof(ResourceEntry));
+  data.append(reinterpret_cast<const char*>(entries_by_name.data()),
+              entries_by_name.size() * sizeof(uint32_t));
+  data.append(reinterpret_cast<const char*>(symbols.data()), symbols.size() * sizeof(SymbolEntry));
+  data += strings;
+
+  const bool valid = index->Init(data.data(), data.size());
+  CHECK(valid) << "created a malformed symbol index";
+  return index;
+}
+
+std::unique_ptr<SymbolIndex> SymbolIndex::Load(const std::string& path, const StringPiece& digest) {
+  TRACE_CALL();
+  std::optional<android::FileMap> file_map = file::MmapPath(path, nullptr);
+  if (!file_map) {
+    return {};
+  }
+
+  std::unique_ptr<SymbolIndex> index(new SymbolIndex());
+  index->file_map_ = std::move(file_map);
+  if (!index->Init(index->file_map_->getDataPtr(), index->file_map_->getDataLength())) {
+    return {};
+  }
+
+  const StringPiece index_digest(reinterpret_cast<const char*>(index->header_ + 1),
+                                 index->header_->digest_size);
+  if (index_digest != digest) {
+    return {};
+  }
+  return index;
+}
+
+bool SymbolIndex::Init(const void* data, size_t size) {
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = size;
+  if (data_ == nullptr || size_ < sizeof(Header)) {
+    return false;
+  }
+
+  header_ = reinterpret_cast<const Header*>(data_);
+  if (header_->magic != kMagic || header_->version != kVersion) {
+    return false;
+  }
+
+  // Computed in 64 bits so that a corrupt header can't overflow the expected size.
+  const uint64_t entries_offset = Align4(sizeof(Header) + static_cast<uint64_t>(
+      header_->digest_size));
+  const uint64_t entries_by_name_offset =
+      entries_offset + static_cast<uint64_t>(header_->resource_count) * sizeof(ResourceEntry);
+  const uint64_t symbols_offset =
+      entries_by_name_offset + static_cast<uint64_t>(header_->resource_count) * sizeof(uint32_t);
+  const uint64_t strings_offset =
+      symbols_offset + static_cast<uint64_t>(header_->symbol_count) * sizeof(SymbolEntry);
+  if (strings_offset + header_->strings_size != size_) {
+    return false;
+  }
+
+  entries_ = reinterpret_cast<const ResourceEntry*>(data_ + entries_offset);
+  entries_by_name_ = reinterpret_cast<const uint32_t*>(data_ + entries_by_name_offset);
+  symbols_ = reinterpret_cast<const SymbolEntry*>(data_ + symbols_offset);
+  strings_ = reinterpret_cast<const char*>(data_ + strings_offset);
+
+  auto is_valid_string = [&](uint32_t offset, uint32_t string_size) {
+    return static_cast<uint64_t>(offset) + string_size <= header_->strings_size;
+  };
+  for (uint32_t i = 0; i < header_->resource_count; i++) {
+    const ResourceEntry& entry = entries_[i];
+    if (!is_valid_string(entry.name_offset, entry.name_size) ||
+        static_cast<uint64_t>(entry.first_symbol) + entry.symbol_count > header_->symbol_count ||
+        entries_by_name_[i] >= header_->resource_count) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header_->symbol_count; i++) {
+    if (!is_valid_string(symbols_[i].name_offset, symbols_[i].name_size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SymbolIndex::WriteToFile(const std::string& path, std::string* out_error) const {
+  // Links against the same APKs may write the index at the same time, so each writes its own file
+  // and moves it into place.
+  const std::string temp_path = path + "." + std::to_string(getpid()) + ".tmp";
+  const std::string data(reinterpret_cast<const char*>(data_), size_);
+  if (!android::base::WriteStringToFile(data, temp_path) ||
+      std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    if (out_error) {
+      *out_error = strerror(errno);
+    }
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+StringPiece SymbolIndex::GetString(uint32_t offset, uint32_t size) const {
+  return StringPiece(strings_ + offset, size);
+}
+
+const SymbolIndex::ResourceEntry* SymbolIndex::FindEntryByName(const StringPiece& name) const {
+  const uint32_t* begin = entries_by_name_;
+  const uint32_t* end = entries_by_name_ + header_->resource_count;
+  const uint32_t* iter = std::lower_bound(begin, end, name, [&](uint32_t i, const StringPiece& n) {
+    return GetString(entries_[i].name_offset, entries_[i].name_size) < n;
+  });
+  if (iter == end) {
+    return nullptr;
+  }
+  const ResourceEntry* entry = &entries_[*iter];
+  return GetString(entry->name_offset, entry->name_size) == name ? entry : nullptr;
+}
+
+const SymbolIndex::ResourceEntry* SymbolIndex::FindEntryById(ResourceId id) const {
+  const ResourceEntry* end = entries_ + header_->resource_count;
+  const ResourceEntry* iter = std::lower_bound(
+      entries_, end, id.id, [](const ResourceEntry& entry, uint32_t i) { return entry.id < i; });
+  return iter != end && iter->id == id.id ? iter : nullptr;
+}
+
+bool SymbolIndex::FindId(const StringPiece& name, ResourceId* out_id,
+                         uint32_t* out_type_spec_flags) const {
+  const ResourceEntry* entry = FindEntryByName(name);
+  if (entry == nullptr) {
+    // Private attributes of libraries such as the framework may be under ^attr-private, which
+    // AssetManager2 looks in for attributes it doesn't find.
+    ResourceNameRef name_ref;
+    if (ResourceUtils::ParseResourceName(name, &name_ref) &&
+        name_ref.type.type == ResourceType::kAttr) {
+      entry = FindEntryByName(ResourceName(name_ref.package, ResourceType::kAttrPrivate,
+                                           name_ref.entry).to_string());
+    }
+  }
+  if (entry == nullptr) {
+    return false;
+  }
+  *out_id = ResourceId(entry->id);
+  *out_type_spec_flags = entry->type_spec_flags;
+  return true;
+}
+
+bool SymbolIndex::FindName(ResourceId id, ResourceName* out_name,
+                           uint32_t* out_type_spec_flags) const {
+  const ResourceEntry* entry = FindEntryById(id);
+  ResourceNameRef name_ref;
+  if (entry == nullptr ||
+      !ResourceUtils::ParseResourceName(GetString(entry->name_offset, entry->name_size),
+                                        &name_ref)) {
+    return false;
+  }
+  *out_name = name_ref.ToResourceName();
+  *out_type_spec_flags = entry->type_spec_flags;
+  return true;
+}
+
+std::unique_ptr<Attribute> SymbolIndex::FindAttribute(ResourceId id) const {
+  const ResourceEntry* entry = FindEntryById(id);
+  if (entry == nullptr || !entry->has_attribute) {
+    return {};
+  }
+
+  auto attr = util::make_unique<Attribute>(entry->type_mask);
+  attr->min_int = entry->min_int;
+  attr->max_int = entry->max_int;
+  for (uint32_t i = 0; i < entry->symbol_count; i++) {
+    const SymbolEntry& symbol_entry = symbols_[entry->first_symbol + i];
+    ResourceNameRef name_ref;
+    if (!ResourceUtils::ParseResourceName(
+            GetString(symbol_entry.name_offset, symbol_entry.name_size), &name_ref)) {
+      return {};
+    }
+
+    Attribute::Symbol symbol;
+    symbol.symbol.name = name_ref.ToResourceName();
+    symbol.symbol.id = ResourceId(symbol_entry.id);
+    symbol.value = symbol_entry.value;
+    symbol.type = static_cast<uint8_t>(symbol_entry.type);
+    attr->symbols.push_back(std::move(symbol));
+  }
+  return attr;
+}
+
+size_t SymbolIndex::GetResourceCount() const {
+  return header_->resource_count;
+}
+
+}  // namespace aapt
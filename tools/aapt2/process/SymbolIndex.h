@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_PROCESS_SYMBOLINDEX_H
+#define AAPT_PROCESS_SYMBOLINDEX_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "android-base/macros.h"
+#include "androidfw/StringPiece.h"
+#include "utils/FileMap.h"
+
+#include "Resource.h"
+#include "ResourceValues.h"
+
+namespace aapt {
+
+// The names, IDs and attributes of the resources of a set of APKs, in a flat file that is mapped
+// rather than parsed. Looking up a symbol in it is a binary search, where looking it up in the
+// APKs goes through the type and key string pools and resolves the bag of each attribute.
+//
+// An index is written for APKs whose tables have a digest, and is only read for APKs with the same
+// digest. The file is meant to be kept on the machine that wrote it.
+class SymbolIndex {
+ public:
+  struct Resource {
+    ResourceName name;
+    ResourceId id;
+    uint32_t type_spec_flags = 0;
+
+    // Set for attributes.
+    std::shared_ptr<Attribute> attribute;
+  };
+
+  // Appends the digest of the table of the APK at path to out_digest. Returns false if the APK
+  // can't be opened or has no binary table.
+  static bool AppendApkDigest(const std::string& path, std::string* out_digest);
+
+  // Creates the index of resources. Of resources sharing a name or an ID, the first is kept.
+  static std::unique_ptr<SymbolIndex> Create(const android::StringPiece& digest,
+                                             std::vector<Resource> resources);
+
+  // Maps the index at path. Returns nullptr if there is none, if it is malformed, or if it was
+  // written for a different digest.
+  static std::unique_ptr<SymbolIndex> Load(const std::string& path,
+                                           const android::StringPiece& digest);
+
+  bool WriteToFile(const std::string& path, std::string* out_error) const;
+
+  // Finds the ID and type spec flags of the resource named name, such as "android:attr/id", the
+  // way AssetManager2::GetResourceId() and GetResourceTypeSpecFlags() would. A name of type attr
+  // also matches a ^attr-private resource.
+  bool FindId(const android::StringPiece& name, ResourceId* out_id,
+              uint32_t* out_type_spec_flags) const;
+
+  // Finds the name and type spec flags of the resource with ID id.
+  bool FindName(ResourceId id, ResourceName* out_name, uint32_t* out_type_spec_flags) const;
+
+  // Returns the attribute with ID id, or nullptr if id is not an attribute.
+  std::unique_ptr<Attribute> FindAttribute(ResourceId id) const;
+
+  size_t GetResourceCount() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SymbolIndex);
+
+  struct Header;
+  struct ResourceEntry;
+  struct SymbolEntry;
+
+  SymbolIndex() = default;
+
+  // Points the tables at the data. Returns false if the data is not a well formed index.
+  bool Init(const void* data, size_t size);
+
+  android::StringPiece GetString(uint32_t offset, uint32_t size) const;
+  const ResourceEntry* FindEntryByName(const android::StringPiece& name) const;
+  const ResourceEntry* FindEntryById(ResourceId id) const;
+
+  // The data is either built in memory or mapped from a file.
+  std::string owned_data_;
+  std::optional<android::FileMap> file_map_;
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  const Header* header_ = nullptr;
+  const ResourceEntry* entries_ = nullptr;
+  const uint32_t* entries_by_name_ = nullptr;
+  const SymbolEntry* symbols_ = nullptr;
+  const char* strings_ = nullptr;
+};
+
+}  // namespace aapt
+
+#endif  // AAPT_PROCESS_SYMBOLINDEX_H
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "process/SymbolIndex.h"
+
+#include "process/SymbolTable.h"
+#include "test/Test.h"
+#include "util/Files.h"
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::SizeIs;
+
+namespace aapt {
+
+using SymbolIndexTest = CommandTestFixture;
+
+static std::vector<SymbolIndex::Resource> MakeResources() {
+  std::vector<SymbolIndex::Resource> resources;
+  SymbolIndex::Resource string;
+  string.name = test::ParseNameOrDie("android:string/foo");
+  string.id = ResourceId(0x01040000);
+  string.type_spec_flags = android::ResTable_typeSpec::SPEC_PUBLIC;
+  resources.push_back(string);
+
+  SymbolIndex::Resource attr;
+  attr.name = test::ParseNameOrDie("android:^attr-private/bar");
+  attr.id = ResourceId(0x01020000);
+  attr.attribute = test::AttributeBuilder()
+                       .SetTypeMask(android::ResTable_map::TYPE_ENUM)
+                       .AddItem("one", 1u)
+                       .Build();
+  resources.push_back(attr);
+
+  // Drops a second resource with the same ID.
+  SymbolIndex::Resource duplicate;
+  duplicate.name = test::ParseNameOrDie("android:string/duplicate");
+  duplicate.id = ResourceId(0x01040000);
+  resources.push_back(duplicate);
+  return resources;
+}
+
+TEST_F(SymbolIndexTest, FindsResourcesOfWrittenIndex) {
+  const std::string path = GetTestPath("symbols.idx");
+  std::string error;
+  ASSERT_TRUE(SymbolIndex::Create("digest", MakeResources())->WriteToFile(path, &error)) << error;
+  EXPECT_THAT(SymbolIndex::Load(path, "other digest"), IsNull());
+
+  std::unique_ptr<SymbolIndex> index = SymbolIndex::Load(path, "digest");
+  ASSERT_THAT(index, NotNull());
+  EXPECT_THAT(index->GetResourceCount(), Eq(2u));
+
+  ResourceId id;
+  uint32_t flags = 0;
+  ASSERT_TRUE(index->FindId("android:string/foo", &id, &flags));
+  EXPECT_THAT(id, Eq(ResourceId(0x01040000)));
+  EXPECT_THAT(flags, Eq(android::ResTable_typeSpec::SPEC_PUBLIC));
+  EXPECT_FALSE(index->FindId("android:string/duplicate", &id, &flags));
+
+  // Attributes are also found under ^attr-private.
+  ASSERT_TRUE(index->FindId("android:attr/bar", &id, &flags));
+  EXPECT_THAT(id, Eq(ResourceId(0x01020000)));
+
+  ResourceName name;
+  ASSERT_TRUE(index->FindName(ResourceId(0x01020000), &name, &flags));
+  EXPECT_THAT(name, Eq(test::ParseNameOrDie("android:^attr-private/bar")));
+  EXPECT_FALSE(index->FindName(ResourceId(0x01030000), &name, &flags));
+
+  std::unique_ptr<Attribute> attr = index->FindAttribute(ResourceId(0x01020000));
+  ASSERT_THAT(attr, NotNull());
+  EXPECT_THAT(attr->type_mask, Eq(android::ResTable_map::TYPE_ENUM));
+  ASSERT_THAT(attr->symbols, SizeIs(1u));
+  EXPECT_THAT(attr->symbols[0].symbol.name.value(), Eq(test::ParseNameOrDie("id/one")));
+  EXPECT_THAT(attr->symbols[0].value, Eq(1u));
+  EXPECT_THAT(index->FindAttribute(ResourceId(0x01040000)), IsNull());
+}
+
+TEST_F(SymbolIndexTest, IgnoresMalformedIndex) {
+  const std::string path = GetTestPath("symbols.idx");
+  WriteFile(path, "not an index");
+  EXPECT_THAT(SymbolIndex::Load(path, "digest"), IsNull());
+  EXPECT_THAT(SymbolIndex::Load(GetTestPath("missing.idx"), "digest"), IsNull());
+}
+
+TEST_F(SymbolIndexTest, AssetManagerSymbolSourceFindsSymbolsInIndex) {
+  StdErrDiagnostics diag;
+  const std::string compiled_files_dir = GetTestPath("compiled");
+  ASSERT_TRUE(CompileFile(GetTestPath("res/values/values.xml"),
+                          R"(<resources>
+                               <public type="attr" name="color" />
+                               <attr name="color" format="color" />
+                               <attr name="mode">
+                                 <enum name="fast" value="1" />
+                               </attr>
+                               <string name="name">name</string>
+                             </resources>)",
+                          compiled_files_dir, &diag));
+  const std::string apk_path = GetTestPath("lib.apk");
+  ASSERT_TRUE(Link({"-o", apk_path, "--manifest", GetDefaultManifest("com.lib")},
+                   compiled_files_dir, &diag));
+
+  const std::string index_dir = GetTestPath("index");
+  for (int i = 0; i < 2; i++) {
+    // The first source writes the index that the second reads.
+    AssetManagerSymbolSource source;
+    ASSERT_TRUE(source.AddAssetPath(apk_path));
+    ASSERT_TRUE(source.UseSymbolIndex(index_dir, &diag));
+    std::optional<std::vector<std::string>> files = file::FindFiles(index_dir, &diag);
+    ASSERT_TRUE(files);
+    EXPECT_THAT(files.value(), SizeIs(1u));
+
+    std::unique_ptr<SymbolTable::Symbol> color =
+        source.FindByName(test::ParseNameOrDie("com.lib:attr/color"));
+    ASSERT_THAT(color, NotNull());
+    EXPECT_TRUE(color->is_public);
+    ASSERT_THAT(color->attribute, NotNull());
+    EXPECT_THAT(color->attribute->type_mask, Eq(android::ResTable_map::TYPE_COLOR));
+
+    ASSERT_TRUE(color->id);
+    std::unique_ptr<SymbolTable::Symbol> color_by_id = source.FindById(color->id.value());
+    ASSERT_THAT(color_by_id, NotNull());
+    ASSERT_THAT(color_by_id->attribute, NotNull());
+
+    std::unique_ptr<SymbolTable::Symbol> mode =
+        source.FindByName(test::ParseNameOrDie("com.lib:attr/mode"));
+    ASSERT_THAT(mode, NotNull());
+    EXPECT_FALSE(mode->is_public);
+    ASSERT_THAT(mode->attribute, NotNull());
+    ASSERT_THAT(mode->attribute->symbols, SizeIs(1u));
+    EXPECT_THAT(mode->attribute->symbols[0].symbol.name.value(),
+                Eq(test::ParseNameOrDie("com.lib:id/fast")));
+
+    EXPECT_THAT(source.FindByName(test::ParseNameOrDie("com.lib:string/name")), NotNull());
+    EXPECT_THAT(source.FindByName(test::ParseNameOrDie("com.lib:string/missing")), IsNull());
+  }
+}
+
+}  // namespace aapt
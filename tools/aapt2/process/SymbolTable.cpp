@@ -16,7 +16,9 @@
 
 #include "process/SymbolTable.h"
 
+#include <functional>
 #include <iostream>
+#include <unordered_map>
 
 #include "android-base/logging.h"
 #include "android-base/stringprintf.h"
@@ -31,6 +33,7 @@
 #include "ResourceUtils.h"
 #include "ValueVisitor.h"
 #include "trace/TraceBuffer.h"
+#include "util/Files.h"
 #include "util/Util.h"
 
 using ::android::ApkAssets;
@@ -218,20 +221,42 @@ std::unique_ptr<SymbolTable::Symbol> ResourceTableSymbolSource::FindByName(
   return symbol;
 }
 
+void AssetManagerSymbolSource::AddApkAssets(std::shared_ptr<const ApkAssets> apk) {
+  apk_assets_.push_back(std::move(apk));
+
+  std::vector<const ApkAssets*> apk_assets;
+  for (const std::shared_ptr<const ApkAssets>& apk_asset : apk_assets_) {
+    apk_assets.push_back(apk_asset.get());
+  }
+
+  asset_manager_.SetApkAssets(apk_assets);
+}
+
 bool AssetManagerSymbolSource::AddAssetPath(const StringPiece& path) {
   TRACE_CALL();
-  if (std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(path.data())) {
-    apk_assets_.push_back(std::move(apk));
-
-    std::vector<const ApkAssets*> apk_assets;
-    for (const std::unique_ptr<const ApkAssets>& apk_asset : apk_assets_) {
-      apk_assets.push_back(apk_asset.get());
-    }
+  std::shared_ptr<const ApkAssets> apk;
+  if (cache_ != nullptr) {
+    apk = cache_->Load(path.to_string());
+  } else {
+    apk = ApkAssets::Load(path.to_string());
+  }
+  if (apk == nullptr) {
+    return false;
+  }
+  AddApkAssets(std::move(apk));
+  return true;
+}
 
-    asset_manager_.SetApkAssets(apk_assets);
-    return true;
+bool AssetManagerSymbolSource::AddCachedAssetPath(const StringPiece& path) {
+  if (cache_ == nullptr) {
+    return false;
   }
-  return false;
+  std::shared_ptr<const ApkAssets> apk = cache_->Find(path.to_string());
+  if (apk == nullptr) {
+    return false;
+  }
+  AddApkAssets(std::move(apk));
+  return true;
 }
 
 std::map<size_t, std::string> AssetManagerSymbolSource::GetAssignedPackageIds() const {
@@ -251,7 +276,7 @@ bool AssetManagerSymbolSource::IsPackageDynamic(uint32_t packageId,
     return true;
   }
 
-  for (const std::unique_ptr<const ApkAssets>& assets : apk_assets_) {
+  for (const std::shared_ptr<const ApkAssets>& assets : apk_assets_) {
     for (const std::unique_ptr<const android::LoadedPackage>& loaded_package
          : assets->GetLoadedArsc()->GetPackages()) {
       if (package_name == loaded_package->GetPackageName() && loaded_package->IsDynamic()) {
@@ -323,6 +348,20 @@ static std::unique_ptr<SymbolTable::Symbol> LookupAttributeInTable(
   return s;
 }
 
+std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::LookupAttribute(ResourceId id) {
+  if (symbol_index_ != nullptr) {
+    if (std::unique_ptr<Attribute> attr = symbol_index_->FindAttribute(id)) {
+      auto s = util::make_unique<SymbolTable::Symbol>(id);
+      s->attribute = std::move(attr);
+      return s;
+    }
+  }
+
+  // Attributes the index has none for are looked up the slow way, so that those without a type
+  // come out the same.
+  return LookupAttributeInTable(asset_manager_, id);
+}
+
 std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByName(
     const ResourceName& name) {
   const std::string mangled_entry = NameMangler::MangleEntry(name.package, name.entry);
@@ -341,6 +380,15 @@ std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByName(
       real_name.package = package_name;
     }
 
+    if (symbol_index_ != nullptr) {
+      if (!symbol_index_->FindId(real_name.to_string(), &res_id, &type_spec_flags) ||
+          !res_id.is_valid_static()) {
+        return true;
+      }
+      found = true;
+      return false;
+    }
+
     auto real_res_id = asset_manager_.GetResourceId(real_name.to_string());
     if (!real_res_id.has_value()) {
       return true;
@@ -367,7 +415,7 @@ std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByName(
 
   std::unique_ptr<SymbolTable::Symbol> s;
   if (real_name.type.type == ResourceType::kAttr) {
-    s = LookupAttributeInTable(asset_manager_, res_id);
+    s = LookupAttribute(res_id);
   } else {
     s = util::make_unique<SymbolTable::Symbol>();
     s->id = res_id;
@@ -401,34 +449,125 @@ std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindById(
     return {};
   }
 
-  std::optional<ResourceName> maybe_name = GetResourceName(asset_manager_, id);
-  if (!maybe_name) {
-    return {};
-  }
+  ResourceName name;
+  uint32_t type_spec_flags = 0;
+  if (symbol_index_ != nullptr) {
+    if (!symbol_index_->FindName(id, &name, &type_spec_flags)) {
+      return {};
+    }
+  } else {
+    std::optional<ResourceName> maybe_name = GetResourceName(asset_manager_, id);
+    if (!maybe_name) {
+      return {};
+    }
 
-  auto flags = asset_manager_.GetResourceTypeSpecFlags(id.id);
-  if (!flags.has_value()) {
-    return {};
+    auto flags = asset_manager_.GetResourceTypeSpecFlags(id.id);
+    if (!flags.has_value()) {
+      return {};
+    }
+    name = std::move(maybe_name.value());
+    type_spec_flags = *flags;
   }
 
-  ResourceName& name = maybe_name.value();
   std::unique_ptr<SymbolTable::Symbol> s;
   if (name.type.type == ResourceType::kAttr) {
-    s = LookupAttributeInTable(asset_manager_, id);
+    s = LookupAttribute(id);
   } else {
     s = util::make_unique<SymbolTable::Symbol>();
     s->id = id;
   }
 
   if (s) {
-    s->is_public = (*flags & android::ResTable_typeSpec::SPEC_PUBLIC) != 0;
+    s->is_public = (type_spec_flags & android::ResTable_typeSpec::SPEC_PUBLIC) != 0;
     s->is_dynamic = IsPackageDynamic(ResourceId(id).package_id(), name.package) ||
-                    (*flags & android::ResTable_typeSpec::SPEC_STAGED_API) != 0;
+                    (type_spec_flags & android::ResTable_typeSpec::SPEC_STAGED_API) != 0;
     return s;
   }
   return {};
 }
 
+std::vector<SymbolIndex::Resource> AssetManagerSymbolSource::CollectResources() {
+  TRACE_CALL();
+  std::unordered_map<std::string, uint8_t> assigned_ids;
+  asset_manager_.ForEachPackage([&](const std::string& name, uint8_t id) -> bool {
+    assigned_ids.emplace(name, id);
+    return true;
+  });
+
+  std::vector<SymbolIndex::Resource> resources;
+  for (const std::shared_ptr<const ApkAssets>& assets : apk_assets_) {
+    for (const std::unique_ptr<const android::LoadedPackage>& loaded_package
+         : assets->GetLoadedArsc()->GetPackages()) {
+      auto id_iter = assigned_ids.find(loaded_package->GetPackageName());
+      if (id_iter == assigned_ids.end()) {
+        continue;
+      }
+
+      loaded_package->ForEachTypeSpec([&](const android::TypeSpec& type_spec, uint8_t) {
+        const uint8_t type_id = type_spec.type_spec->id;
+        const uint32_t entry_count =
+            std::min<uint32_t>(android::dtohl(type_spec.type_spec->entryCount), 0x10000u);
+        for (uint32_t entry_id = 0; entry_id < entry_count; entry_id++) {
+          const ResourceId id(id_iter->second, type_id, static_cast<uint16_t>(entry_id));
+          std::optional<ResourceName> name = GetResourceName(asset_manager_, id);
+          auto flags = asset_manager_.GetResourceTypeSpecFlags(id.id);
+          if (!name || !flags.has_value()) {
+            continue;
+          }
+
+          SymbolIndex::Resource resource;
+          resource.name = std::move(name.value());
+          resource.id = id;
+          resource.type_spec_flags = *flags;
+          if (resource.name.type.type == ResourceType::kAttr ||
+              resource.name.type.type == ResourceType::kAttrPrivate) {
+            if (std::unique_ptr<SymbolTable::Symbol> s =
+                    LookupAttributeInTable(asset_manager_, id)) {
+              resource.attribute = std::move(s->attribute);
+            }
+          }
+          resources.push_back(std::move(resource));
+        }
+      });
+    }
+  }
+  return resources;
+}
+
+bool AssetManagerSymbolSource::UseSymbolIndex(const std::string& dir, IDiagnostics* diag) {
+  TRACE_CALL();
+  if (apk_assets_.empty()) {
+    return false;
+  }
+
+  std::string digest = util::GetToolFingerprint() + "\n";
+  std::string paths;
+  for (const std::shared_ptr<const ApkAssets>& assets : apk_assets_) {
+    std::optional<std::string_view> path = assets->GetPath();
+    if (!path || !SymbolIndex::AppendApkDigest(std::string(*path), &digest)) {
+      return false;
+    }
+    paths.append(path->data(), path->size()).append("\n");
+  }
+
+  // The index is named after the APKs, so that linking against a new version of them replaces
+  // the index of the old.
+  std::string index_path = dir;
+  file::AppendPath(&index_path, android::base::StringPrintf(
+                                    "symbols_%zx.idx", std::hash<std::string>()(paths)));
+  symbol_index_ = SymbolIndex::Load(index_path, digest);
+  if (symbol_index_ != nullptr) {
+    return true;
+  }
+
+  symbol_index_ = SymbolIndex::Create(digest, CollectResources());
+  std::string error;
+  if (!file::mkdirs(dir) || !symbol_index_->WriteToFile(index_path, &error)) {
+    diag->Warn(DiagMessage(index_path) << "failed to write symbol index: " << error);
+  }
+  return true;
+}
+
 std::unique_ptr<SymbolTable::Symbol> AssetManagerSymbolSource::FindByReference(
     const Reference& ref) {
   // AssetManager always prefers IDs.
@@ -27,9 +27,12 @@
 #include "utils/JenkinsHash.h"
 #include "utils/LruCache.h"
 
+#include "Diagnostics.h"
 #include "Resource.h"
 #include "ResourceTable.h"
 #include "ResourceValues.h"
+#include "process/ApkAssetsCache.h"
+#include "process/SymbolIndex.h"
 #include "util/Util.h"
 
 namespace aapt {
@@ -190,9 +193,21 @@ class ResourceTableSymbolSource : public ISymbolSource {
 
 class AssetManagerSymbolSource : public ISymbolSource {
  public:
-  AssetManagerSymbolSource() = default;
+  // Loads the APKs added through cache, if set, so that they can be shared with other links.
+  explicit AssetManagerSymbolSource(ApkAssetsCache* cache = nullptr) : cache_(cache) {
+  }
 
   bool AddAssetPath(const android::StringPiece& path);
+
+  // Adds the APK at path if the cache holds it unchanged. Returns false otherwise, without
+  // loading it.
+  bool AddCachedAssetPath(const android::StringPiece& path);
+
+  // Looks up symbols in the index of the APKs added kept in dir, writing it there first if there
+  // is none for APKs with the same tables. Returns false if the APKs can't be digested, in which
+  // case symbols are looked up in the APKs themselves. Call once all the APKs are added.
+  bool UseSymbolIndex(const std::string& dir, IDiagnostics* diag);
+
   std::map<size_t, std::string> GetAssignedPackageIds() const;
   bool IsPackageDynamic(uint32_t packageId, const std::string& package_name) const;
 
@@ -207,8 +222,18 @@ class AssetManagerSymbolSource : public ISymbolSource {
   }
 
  private:
+  void AddApkAssets(std::shared_ptr<const android::ApkAssets> apk);
+
+  // Looks up the attribute with ID id in the index if there is one, and in the APKs otherwise.
+  std::unique_ptr<SymbolTable::Symbol> LookupAttribute(ResourceId id);
+
+  // Returns every resource of the APKs added, as the asset manager resolves it.
+  std::vector<SymbolIndex::Resource> CollectResources();
+
+  ApkAssetsCache* cache_;
   android::AssetManager2 asset_manager_;
-  std::vector<std::unique_ptr<const android::ApkAssets>> apk_assets_;
+  std::vector<std::shared_ptr<const android::ApkAssets>> apk_assets_;
+  std::unique_ptr<SymbolIndex> symbol_index_;
 
   DISALLOW_COPY_AND_ASSIGN(AssetManagerSymbolSource);
 };
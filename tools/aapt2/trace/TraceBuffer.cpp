@@ -16,7 +16,9 @@
 
 #include "TraceBuffer.h"
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <sstream>
 #include <unistd.h>
 #include <vector>
@@ -34,16 +36,31 @@ namespace {
 
 constexpr char kBegin = 'B';
 constexpr char kEnd = 'E';
+constexpr char kComplete = 'X';
 
 struct TracePoint {
-  pid_t tid;
+  pid_t pid;
+  int tid;
   int64_t time;
   std::string tag;
   char type;
+
+  // Only for complete events.
+  int64_t duration = 0;
+  std::string args;
 };
 
+// Compile can run on several threads, see CompileOptions::jobs.
+std::mutex traces_lock;
 std::vector<TracePoint> traces;
 
+// A small id per thread, so that the begin and end events of each thread pair up in the viewer.
+int GetThreadId() noexcept {
+  static std::atomic_int next_id{0};
+  thread_local int id = next_id++;
+  return id;
+}
+
 int64_t GetTime() noexcept {
   auto now = std::chrono::steady_clock::now();
   return std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
@@ -52,7 +69,8 @@ int64_t GetTime() noexcept {
 } // namespace anonymous
 
 void AddWithTime(const std::string& tag, char type, int64_t time) noexcept {
-  TracePoint t = {getpid(), time, tag, type};
+  TracePoint t = {getpid(), GetThreadId(), time, tag, type};
+  std::lock_guard<std::mutex> lock(traces_lock);
   traces.emplace_back(t);
 }
 
@@ -60,8 +78,32 @@ void Add(const std::string& tag, char type) noexcept {
   AddWithTime(tag, type, GetTime());
 }
 
+void AddComplete(const std::string& tag, int64_t start, std::string args) noexcept {
+  TracePoint t = {getpid(), GetThreadId(), start, tag, kComplete};
+  t.duration = GetTime() - start;
+  t.args = std::move(args);
+  std::lock_guard<std::mutex> lock(traces_lock);
+  traces.emplace_back(std::move(t));
+}
 
-
+// Escapes str to be written within the quotes of a json string.
+static std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      escaped += buf;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
 
 void Flush(const std::string& basePath) {
   TRACE_CALL();
@@ -76,9 +118,25 @@ void Flush(const std::string& basePath) {
     return;
   }
 
+  // The json array format leaves out the closing bracket, so that every flush can append to the
+  // file. Perfetto and chrome://tracing both open it as is.
+  fseek(f, 0, SEEK_END);
+  if (ftell(f) == 0) {
+    fprintf(f, "[\n");
+  }
+
+  std::lock_guard<std::mutex> lock(traces_lock);
   for(const TracePoint& trace : traces) {
+    if (trace.type == kComplete) {
+      fprintf(f, "{\"ts\" : \"%" PRIi64 "\", \"ph\" : \"%c\", \"dur\" : \"%" PRIi64 "\", "
+              "\"tid\" : \"%d\" , \"pid\" : \"%d\", \"name\" : \"%s\", \"args\" : {%s} },\n",
+              trace.time, trace.type, trace.duration, trace.tid, trace.pid,
+              EscapeJson(trace.tag).c_str(), trace.args.c_str());
+      continue;
+    }
     fprintf(f, "{\"ts\" : \"%" PRIu64 "\", \"ph\" : \"%c\", \"tid\" : \"%d\" , \"pid\" : \"%d\", "
-            "\"name\" : \"%s\" },\n", trace.time, trace.type, 0, trace.tid, trace.tag.c_str());
+            "\"name\" : \"%s\" },\n", trace.time, trace.type, trace.tid, trace.pid,
+            EscapeJson(trace.tag).c_str());
   }
   fclose(f);
   traces.clear();
@@ -113,6 +171,18 @@ Trace::~Trace() {
   tracebuffer::Add("", tracebuffer::kEnd);
 }
 
+FileTrace::FileTrace(const std::string& tag, const std::string& path, const std::string& type,
+                     uint64_t size)
+    : tag_(tag), path_(path), type_(type), size_(size), start_(tracebuffer::GetTime()) {
+}
+
+FileTrace::~FileTrace() {
+  std::stringstream args;
+  args << "\"file\" : \"" << tracebuffer::EscapeJson(path_) << "\", \"size\" : " << size_
+       << ", \"type\" : \"" << tracebuffer::EscapeJson(type_) << "\"";
+  tracebuffer::AddComplete(tag_, start_, args.str());
+}
+
 FlushTrace::FlushTrace(const std::string& basepath, const std::string& tag)
     : basepath_(basepath)  {
   tracebuffer::Add(tag, tracebuffer::kBegin);
@@ -17,6 +17,7 @@
 #ifndef AAPT_TRACEBUFFER_H
 #define AAPT_TRACEBUFFER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -26,7 +27,7 @@ namespace aapt {
 
 // Record timestamps for beginning and end of a task and generate systrace json fragments.
 // This is an in-process ftrace which has the advantage of being platform independent.
-// These methods are NOT thread-safe since aapt2 is not multi-threaded.
+// Events are recorded with the thread they happened on, and may be recorded from several threads.
 
 // Convenience RIAA object to automatically finish an event when object goes out of scope.
 class Trace {
@@ -36,6 +37,27 @@ public:
   ~Trace();
 };
 
+// Records the processing of one input file as a single event, with the file's path, size and type
+// as arguments. `aapt2 trace-report` sums these up to find the files that take longest.
+class FileTrace {
+public:
+  FileTrace(const std::string& tag, const std::string& path, const std::string& type,
+            uint64_t size = 0);
+  ~FileTrace();
+
+  // For when the size is only known once the file is processed.
+  void SetSize(uint64_t size) {
+    size_ = size;
+  }
+
+private:
+  std::string tag_;
+  std::string path_;
+  std::string type_;
+  uint64_t size_;
+  int64_t start_;
+};
+
 // Manual markers.
 void BeginTrace(const std::string& tag);
 void EndTrace();
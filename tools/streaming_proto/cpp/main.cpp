@@ -11,6 +11,7 @@ using namespace google::protobuf::io;
 using namespace std;
 
 const bool GENERATE_MAPPING = true;
+const bool GENERATE_TYPED_WRITERS = true;
 
 static string
 make_filename(const FileDescriptorProto& file_descriptor)
@@ -70,6 +71,30 @@ write_field(stringstream& text, const FieldDescriptorProto& field, const string&
 
     text << "LL;" << endl;
 
+    if (GENERATE_TYPED_WRITERS) {
+        // Templates on the stream type, so the header doesn't need to include ProtoOutputStream.h.
+        const string constant = make_constant_name(field.name());
+        const FieldDescriptorProto::Type type = field.type();
+        if (type == FieldDescriptorProto::TYPE_BYTES || type == FieldDescriptorProto::TYPE_STRING
+                || type == FieldDescriptorProto::TYPE_MESSAGE) {
+            text << indent << "template <typename Stream>" << endl;
+            text << indent << "inline bool write_" << field.name()
+                    << "(Stream* proto, const char* val, size_t size) {" << endl;
+            text << indent << INDENT << "return proto->template write<" << constant
+                    << ">(val, size);" << endl;
+            text << indent << "}" << endl;
+        }
+        if (type != FieldDescriptorProto::TYPE_BYTES && type != FieldDescriptorProto::TYPE_MESSAGE
+                && type != FieldDescriptorProto::TYPE_GROUP) {
+            text << indent << "template <typename Stream, typename T>" << endl;
+            text << indent << "inline bool write_" << field.name()
+                    << "(Stream* proto, const T& val) {" << endl;
+            text << indent << INDENT << "return proto->template write<" << constant
+                    << ">(val);" << endl;
+            text << indent << "}" << endl;
+        }
+    }
+
     text << endl;
 }
 